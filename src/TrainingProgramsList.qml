@@ -128,6 +128,16 @@ ColumnLayout {
                                 }
                             }
                         }
+                        Text {
+                            id: summaryTextBox
+                            anchors.right: parent.right
+                            anchors.rightMargin: 5
+                            anchors.verticalCenter: parent.verticalCenter
+                            z: 2
+                            color: Material.color(Material.Grey)
+                            font.pixelSize: Qt.application.font.pixelSize
+                            text: (!folderModel.isFolder(index) && rootItem.workout_library_version >= 0) ? rootItem.trainprogram_summary(fileURL) : ""
+                        }
                         MouseArea {
                             anchors.fill: parent
                             z: 100
@@ -171,9 +181,11 @@ ColumnLayout {
                         console.log(fileUrl + ' selected');
                         trainprogram_preview(fileUrl)
                         powerSeries.clear();
-                        for(var i=0;i<rootItem.preview_workout_points;i+=10)
+                        // the profile of the library: a fixed number of points over the whole workout
+                        var watts = rootItem.preview_workout_watt
+                        for(var i=0;i<watts.length;i++)
                         {
-                            powerSeries.append(i * 1000, rootItem.preview_workout_watt[i]);
+                            powerSeries.append(i * rootItem.preview_workout_points * 1000 / watts.length, watts[i]);
                         }
                         rootItem.update_chart_power(powerChart);
                         //trainprogram_open_clicked(fileUrl);
@@ -0,0 +1,150 @@
+#include "characteristicnotificationscheduler.h"
+#include "metric.h"
+#include "qzsettingssnapshot.h"
+
+#include <QDebug>
+
+CharacteristicNotificationScheduler::CharacteristicNotificationScheduler(bluetoothdevice *device, QObject *parent)
+    : QObject(parent), device(device), timer(this) {
+    raceMode = QZSettingsSnapshot::get().race_mode;
+    m_tickMs = raceMode ? 100 : 250;
+    // the pace of the timers of the virtual devices
+    m_heartbeatMs = raceMode ? 100 : 1000;
+    timer.setTimerType(Qt::PreciseTimer);
+    connect(&timer, &QTimer::timeout, this, &CharacteristicNotificationScheduler::tick);
+}
+
+void CharacteristicNotificationScheduler::defaultRate(quint16 uuid, bool raceMode, int *intervalMs,
+                                                      int *keepAliveMs) {
+    *keepAliveMs = 1000;
+    switch (uuid) {
+    case 0x2ACC: // fitness machine feature
+        *intervalMs = 1000;
+        break;
+    default:
+        *intervalMs = raceMode ? 100 : 250;
+        break;
+    }
+}
+
+int CharacteristicNotificationScheduler::indexOf(quint16 uuid) const {
+    for (int i = 0; i < entries.count(); i++)
+        if (entries.at(i).notifier->uuid() == uuid)
+            return i;
+    return -1;
+}
+
+void CharacteristicNotificationScheduler::add(CharacteristicNotifier *notifier) {
+    if (contains(notifier->uuid())) {
+        delete notifier;
+        return;
+    }
+    notifier->setParent(this);
+    Entry entry;
+    entry.notifier = notifier;
+    defaultRate(notifier->uuid(), raceMode, &entry.intervalMs, &entry.keepAliveMs);
+    // the payloads are at most 20 bytes: no allocation at the ticks
+    entry.payload.reserve(64);
+    entry.scratch.reserve(64);
+    entries.append(entry);
+    batch.uuids.reserve(entries.count());
+    batch.values.reserve(entries.count());
+}
+
+void CharacteristicNotificationScheduler::setRate(quint16 uuid, int intervalMs, int keepAliveMs) {
+    const int i = indexOf(uuid);
+    if (i < 0)
+        return;
+    entries[i].intervalMs = intervalMs;
+    entries[i].keepAliveMs = keepAliveMs;
+}
+
+void CharacteristicNotificationScheduler::start() {
+    if (!timer.isActive())
+        timer.start(m_tickMs);
+}
+
+void CharacteristicNotificationScheduler::stop() { timer.stop(); }
+
+const CharacteristicNotificationBatch &CharacteristicNotificationScheduler::process(qint64 nowMs) {
+    // a tick late by less than half a tick is on time
+    const qint64 slack = m_tickMs / 2;
+    const quint32 version = device ? device->telemetryVersion() : 0;
+
+    batch.uuids.clear();
+    batch.values.clear();
+    batch.m_heartbeat = !heartbeatDone || nowMs - heartbeatAtMs >= m_heartbeatMs - slack;
+    if (batch.m_heartbeat) {
+        heartbeatAtMs = nowMs;
+        heartbeatDone = true;
+    }
+
+    for (Entry &e : entries) {
+        const bool keepAlive = !e.everSent || nowMs - e.sentMs >= e.keepAliveMs - slack;
+        if (!keepAlive) {
+            if (e.invalid || nowMs - e.encodedMs < e.intervalMs - slack)
+                continue;
+            // version 0: a device that never publishes its values, encoded at every interval
+            if (version != 0 && e.version == version) {
+                e.stats.idle++;
+                continue;
+            }
+        }
+
+        e.scratch.resize(0);
+        e.stats.encodes++;
+        e.encodedMs = nowMs;
+        e.version = version;
+        e.invalid = e.notifier->notify(e.scratch) != CN_OK;
+        if (e.invalid) {
+            // nothing for this device: tried again at the keep alive
+            e.sentMs = nowMs;
+            e.everSent = true;
+            continue;
+        }
+        if (!keepAlive && e.scratch == e.payload) {
+            e.stats.unchanged++;
+            continue;
+        }
+        e.payload.swap(e.scratch);
+        e.sentMs = nowMs;
+        e.everSent = true;
+        e.stats.sent++;
+        batch.uuids.append(e.notifier->uuid());
+        batch.values.append(&e.payload);
+    }
+    return batch;
+}
+
+void CharacteristicNotificationScheduler::tick() {
+    const qint64 nowMs = metric::monotonicNs() / 1000000;
+    emit notificationsReady(process(nowMs));
+    logStats(nowMs);
+}
+
+void CharacteristicNotificationScheduler::delivered(const QString &client, int notifications, int bytes) {
+    NotificationClientStats &stats = m_clients[client];
+    stats.notifications += notifications;
+    stats.bytes += bytes;
+    stats.lastNs = metric::monotonicNs();
+}
+
+CharacteristicNotificationStats CharacteristicNotificationScheduler::stats(quint16 uuid) const {
+    const int i = indexOf(uuid);
+    return i < 0 ? CharacteristicNotificationStats() : entries.at(i).stats;
+}
+
+void CharacteristicNotificationScheduler::logStats(qint64 nowMs) {
+    if (loggedAtMs == 0)
+        loggedAtMs = nowMs;
+    if (nowMs - loggedAtMs < 60000)
+        return;
+    loggedAtMs = nowMs;
+    for (const Entry &e : qAsConst(entries))
+        qDebug() << QStringLiteral("notifications") << QString::number(e.notifier->uuid(), 16)
+                 << QStringLiteral("encodes") << e.stats.encodes << QStringLiteral("sent") << e.stats.sent
+                 << QStringLiteral("unchanged") << e.stats.unchanged << QStringLiteral("idle") << e.stats.idle;
+    for (auto i = m_clients.constBegin(); i != m_clients.constEnd(); ++i)
+        qDebug() << QStringLiteral("notifications to") << i.key() << i.value().notifications
+                 << QStringLiteral("bytes") << i.value().bytes;
+}
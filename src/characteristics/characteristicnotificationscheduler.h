@@ -0,0 +1,148 @@
+#ifndef CHARACTERISTICNOTIFICATIONSCHEDULER_H
+#define CHARACTERISTICNOTIFICATIONSCHEDULER_H
+
+#include "characteristicnotifier.h"
+#include "devices/bluetoothdevice.h"
+#include <QByteArray>
+#include <QHash>
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+
+/**
+ * @brief The payloads due at a tick of the scheduler, encoded once for all the transports of a virtual device.
+ */
+class CharacteristicNotificationBatch {
+  public:
+    int count() const { return uuids.count(); }
+    quint16 uuid(int i) const { return uuids.at(i); }
+    const QByteArray &value(int i) const { return *values.at(i); }
+
+    /**
+     * @brief The payload of a characteristic, nullptr if it isn't due at this tick.
+     */
+    const QByteArray *find(quint16 uuid) const {
+        const int i = uuids.indexOf(uuid);
+        return i < 0 ? nullptr : values.at(i);
+    }
+
+    /**
+     * @brief True once for each heartbeat period: the pace the virtual devices used to have, for what isn't a
+     * notification (connection checks, battery, logs).
+     */
+    bool heartbeat() const { return m_heartbeat; }
+
+  private:
+    friend class CharacteristicNotificationScheduler;
+    QVector<quint16> uuids;
+    QVector<const QByteArray *> values;
+    bool m_heartbeat = false;
+};
+
+/**
+ * @brief The work of the scheduler for a characteristic.
+ */
+struct CharacteristicNotificationStats {
+    quint64 encodes = 0;   // notify() called
+    quint64 sent = 0;      // in a batch
+    quint64 unchanged = 0; // encoded, the same as the last one sent
+    quint64 idle = 0;      // not encoded, no new values from the device
+};
+
+/**
+ * @brief What a client of a virtual device received.
+ */
+struct NotificationClientStats {
+    quint64 notifications = 0;
+    quint64 bytes = 0;
+    qint64 lastNs = 0; // metric::monotonicNs()
+};
+
+/**
+ * @brief The only timer of the notifications of a virtual device, shared by its bluetooth peripheral and by Dircon.
+ * Every characteristic has a rate: a payload is encoded at most every intervalMs and only when the device published
+ * new values (bluetoothdevice::telemetryVersion()), and sent only when it changed, or every keepAliveMs anyway. The
+ * payloads due at a tick are encoded once into buffers allocated up front and handed to every transport by
+ * notificationsReady().
+ */
+class CharacteristicNotificationScheduler : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit CharacteristicNotificationScheduler(bluetoothdevice *device, QObject *parent = nullptr);
+
+    /**
+     * @brief Schedules a characteristic at its default rate. The scheduler owns the notifier; the first notifier of a
+     * characteristic encodes it for all the transports, the next ones are deleted.
+     */
+    void add(CharacteristicNotifier *notifier);
+    bool contains(quint16 uuid) const { return indexOf(uuid) >= 0; }
+
+    void setRate(quint16 uuid, int intervalMs, int keepAliveMs);
+
+    /**
+     * @brief The rate of a characteristic: the measurements at every tick, the static ones at the keep alive.
+     */
+    static void defaultRate(quint16 uuid, bool raceMode, int *intervalMs, int *keepAliveMs);
+
+    /**
+     * @brief The tick: 250 ms, 4 notifications per second for a changing power, 100 ms in race mode.
+     */
+    int tickMs() const { return m_tickMs; }
+    int heartbeatMs() const { return m_heartbeatMs; }
+
+    void start();
+    void stop();
+
+    /**
+     * @brief Encodes the characteristics due at nowMs, a monotonic time; the timer calls it before
+     * notificationsReady().
+     */
+    const CharacteristicNotificationBatch &process(qint64 nowMs);
+
+    /**
+     * @brief Counts the notifications a transport sent to one of its clients.
+     */
+    void delivered(const QString &client, int notifications, int bytes);
+
+    CharacteristicNotificationStats stats(quint16 uuid) const;
+    const QHash<QString, NotificationClientStats> &clients() const { return m_clients; }
+
+  signals:
+    void notificationsReady(const CharacteristicNotificationBatch &batch);
+
+  private slots:
+    void tick();
+
+  private:
+    struct Entry {
+        CharacteristicNotifier *notifier = nullptr;
+        int intervalMs = 0;
+        int keepAliveMs = 0;
+        qint64 encodedMs = 0;
+        qint64 sentMs = 0;
+        quint32 version = 0;
+        bool everSent = false;
+        bool invalid = false; // CN_INVALID at the last encode
+        QByteArray payload; // the last one sent
+        QByteArray scratch; // the one being encoded
+        CharacteristicNotificationStats stats;
+    };
+
+    int indexOf(quint16 uuid) const;
+    void logStats(qint64 nowMs);
+
+    bluetoothdevice *device;
+    QVector<Entry> entries;
+    CharacteristicNotificationBatch batch;
+    QHash<QString, NotificationClientStats> m_clients;
+    QTimer timer;
+    int m_tickMs = 250;
+    int m_heartbeatMs = 1000;
+    bool raceMode = false;
+    qint64 heartbeatAtMs = 0;
+    bool heartbeatDone = false;
+    qint64 loggedAtMs = 0;
+};
+
+#endif // CHARACTERISTICNOTIFICATIONSCHEDULER_H
@@ -0,0 +1,42 @@
+#include "characteristicnotifier2ad1.h"
+#include "devices/rower.h"
+
+CharacteristicNotifier2AD1::CharacteristicNotifier2AD1(bluetoothdevice *Rower, QObject *parent)
+    : CharacteristicNotifier(0x2ad1, parent), Rower(Rower) {}
+
+int CharacteristicNotifier2AD1::notify(QByteArray &value) {
+    rower *r = (rower *)Rower;
+    const uint16_t strokes = (uint16_t)(r->currentStrokesCount().value());
+    const uint16_t distance = (uint16_t)(r->odometer() * 1000.0);
+    const uint16_t pace = (uint16_t)QTime(0, 0, 0).secsTo(r->currentPace());
+    const uint16_t watts = (uint16_t)Rower->wattsMetric().value();
+    const uint16_t calories = (uint16_t)(Rower->calories().value());
+
+    value.append((char)0x2C);
+    value.append((char)0x03);
+
+    value.append((char)((uint8_t)(Rower->currentCadence().value() * 2) & 0xFF)); // Stroke Rate
+
+    value.append((char)(strokes & 0xFF));        // Stroke Count
+    value.append((char)((strokes >> 8) & 0xFF)); // Stroke Count
+
+    value.append((char)(distance & 0xFF));         // Distance
+    value.append((char)((distance >> 8) & 0xFF));  // Distance
+    value.append((char)((distance >> 16) & 0xFF)); // Distance
+
+    value.append((char)(pace & 0xFF));        // pace
+    value.append((char)((pace >> 8) & 0xFF)); // pace
+
+    value.append((char)(watts & 0xFF));        // watts
+    value.append((char)((watts >> 8) & 0xFF)); // watts
+
+    value.append((char)(calories & 0xFF));        // calories
+    value.append((char)((calories >> 8) & 0xFF)); // calories
+    value.append((char)(calories & 0xFF));        // calories
+    value.append((char)((calories >> 8) & 0xFF)); // calories
+    value.append((char)(calories & 0xFF));        // calories
+
+    value.append(char(Rower->currentHeart().value())); // Actual value.
+    value.append((char)0);                             // Bkool FTMS protocol HRM offset 1280 fix
+    return CN_OK;
+}
@@ -0,0 +1,15 @@
+#ifndef CHARACTERISTICNOTIFIER2AD1_H
+#define CHARACTERISTICNOTIFIER2AD1_H
+
+#include "devices/bluetoothdevice.h"
+#include "characteristicnotifier.h"
+
+class CharacteristicNotifier2AD1 : public CharacteristicNotifier {
+    bluetoothdevice *Rower;
+
+  public:
+    explicit CharacteristicNotifier2AD1(bluetoothdevice *Rower, QObject *parent = nullptr);
+    int notify(QByteArray &out) override;
+};
+
+#endif // CHARACTERISTICNOTIFIER2AD1_H
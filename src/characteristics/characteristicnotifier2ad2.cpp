@@ -2,7 +2,7 @@
 #include "devices/elliptical.h"
 #include "devices/rower.h"
 #include "devices/treadmill.h"
-#include <QSettings>
+#include "qzsettingssnapshot.h"
 
 CharacteristicNotifier2AD2::CharacteristicNotifier2AD2(bluetoothdevice *Bike, QObject *parent)
     : CharacteristicNotifier(0x2ad2, parent), Bike(Bike) {}
@@ -10,9 +10,8 @@ CharacteristicNotifier2AD2::CharacteristicNotifier2AD2(bluetoothdevice *Bike, QO
 int CharacteristicNotifier2AD2::notify(QByteArray &value) {
     bluetoothdevice::BLUETOOTH_TYPE dt = Bike->deviceType();
 
-    QSettings settings;
-    bool virtual_device_rower =
-        settings.value(QZSettings::virtual_device_rower, QZSettings::default_virtual_device_rower).toBool();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool virtual_device_rower = settings.virtual_device_rower;
     bool rowerAsABike = !virtual_device_rower && dt == bluetoothdevice::ROWING;
 
     double normalizeWattage = Bike->wattsMetric().value();
@@ -40,8 +39,7 @@ int CharacteristicNotifier2AD2::notify(QByteArray &value) {
         value.append((char)0);                            // Bkool FTMS protocol HRM offset 1280 fix
         return CN_OK;
     } else if (dt == bluetoothdevice::TREADMILL || dt == bluetoothdevice::ELLIPTICAL || dt == bluetoothdevice::ROWING) {
-        QSettings settings;
-        bool double_cadence = settings.value(QZSettings::powr_sensor_running_cadence_double, QZSettings::default_powr_sensor_running_cadence_double).toBool();
+        bool double_cadence = settings.powr_sensor_running_cadence_double;
         double cadence_multiplier = 2.0;
         if (double_cadence)
             cadence_multiplier = 1.0;
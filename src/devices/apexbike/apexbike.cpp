@@ -160,7 +160,7 @@ void apexbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     if (watts())
         KCal +=
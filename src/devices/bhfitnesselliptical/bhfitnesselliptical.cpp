@@ -192,7 +192,7 @@ void bhfitnesselliptical::characteristicChanged(const QLowEnergyCharacteristic &
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0),
+                Speed.secondsSinceLastChanged(),
                 0 /* not useful for elliptical*/);
         }
         index += 2;
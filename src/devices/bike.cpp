@@ -1,9 +1,17 @@
 
 #include "devices/bike.h"
 #include "qdebugfixup.h"
+#include "qzsettingssnapshot.h"
 #include <QSettings>
 
-bike::bike() { elapsed.setType(metric::METRIC_ELAPSED); }
+bike::bike() {
+    elapsed.setType(metric::METRIC_ELAPSED);
+    // gains, offsets and models are read from the settings when the tables are built
+    connect(QZSettingsSnapshot::instance(), &QZSettingsSnapshot::changed, this, [this]() {
+        m_powerSurface.clear();
+        m_pelotonMap.clear();
+    });
+}
 
 virtualbike *bike::VirtualBike() { return dynamic_cast<virtualbike*>(this->VirtualDevice()); }
 
@@ -93,17 +101,57 @@ void bike::setGears(double gears) {
 
 double bike::currentCrankRevolutions() { return CrankRevs; }
 uint16_t bike::lastCrankEventTime() { return LastCrankEventTime; }
-metric bike::lastRequestedResistance() { return RequestedResistance; }
-metric bike::lastRequestedPelotonResistance() { return RequestedPelotonResistance; }
-metric bike::lastRequestedCadence() { return RequestedCadence; }
-metric bike::lastRequestedPower() { return RequestedPower; }
-metric bike::currentResistance() { return Resistance; }
+const metric &bike::lastRequestedResistance() { return RequestedResistance; }
+const metric &bike::lastRequestedPelotonResistance() { return RequestedPelotonResistance; }
+const metric &bike::lastRequestedCadence() { return RequestedCadence; }
+const metric &bike::lastRequestedPower() { return RequestedPower; }
+const metric &bike::currentResistance() { return Resistance; }
 uint8_t bike::fanSpeed() { return FanSpeed; }
 bool bike::connected() { return false; }
 uint16_t bike::watts() { return 0; }
-metric bike::pelotonResistance() { return m_pelotonResistance; }
+const metric &bike::pelotonResistance() { return m_pelotonResistance; }
+void bike::fillTelemetry(devicetelemetry &telemetry) {
+    bluetoothdevice::fillTelemetry(telemetry);
+    telemetry.pelotonResistance = pelotonResistance().value();
+}
 resistance_t bike::pelotonToBikeResistance(int pelotonResistance) { return pelotonResistance; }
 resistance_t bike::resistanceFromPowerRequest(uint16_t power) { return power / 10; } // in order to have something
+double bike::wattsFromResistance(double resistance, double cadence) {
+    Q_UNUSED(resistance)
+    Q_UNUSED(cadence)
+    return -1;
+}
+double bike::bikeResistanceToPeloton(double resistance) { return resistance; }
+
+const powersurface &bike::powerSurface() {
+    if (m_powerSurface.isEmpty() || powerSurfaceMaxResistance != maxResistance()) {
+        powerSurfaceMaxResistance = maxResistance();
+        buildPowerSurface(m_powerSurface);
+        const QString calibration = QZSettingsSnapshot::get().power_calibration_file;
+        if (!calibration.isEmpty()) {
+            qDebug() << QStringLiteral("power calibration") << calibration
+                     << m_powerSurface.importCalibration(calibration) << QStringLiteral("measures");
+        }
+    }
+    return m_powerSurface;
+}
+
+const pelotonmap &bike::pelotonMap() {
+    if (m_pelotonMap.isEmpty() || pelotonMapMaxResistance != maxResistance()) {
+        pelotonMapMaxResistance = maxResistance();
+        buildPelotonMap(m_pelotonMap);
+    }
+    return m_pelotonMap;
+}
+
+void bike::buildPowerSurface(powersurface &surface) {
+    surface.build(1, maxResistance(),
+                  [this](double resistance, double cadence) { return wattsFromResistance(resistance, cadence); });
+}
+
+void bike::buildPelotonMap(pelotonmap &map) {
+    map.build(1, maxResistance(), [this](double resistance) { return bikeResistanceToPeloton(resistance); });
+}
 void bike::cadenceSensor(uint8_t cadence) { Cadence.setValue(cadence); }
 void bike::powerSensor(uint16_t power) { m_watt.setValue(power, false); }
 
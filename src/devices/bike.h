@@ -2,6 +2,7 @@
 #define BIKE_H
 
 #include "devices/bluetoothdevice.h"
+#include "devices/powersurface.h"
 #include "virtualdevices/virtualbike.h"
 #include <QObject>
 
@@ -14,11 +15,11 @@ class bike : public bluetoothdevice {
 
     virtualbike *VirtualBike();
 
-    metric lastRequestedResistance();
-    metric lastRequestedPelotonResistance();
-    metric lastRequestedCadence();
-    metric lastRequestedPower();
-    metric currentResistance() override;
+    const metric &lastRequestedResistance();
+    const metric &lastRequestedPelotonResistance();
+    const metric &lastRequestedCadence();
+    const metric &lastRequestedPower();
+    const metric &currentResistance() override;
     uint8_t fanSpeed() override;
     double currentCrankRevolutions() override;
     uint16_t lastCrankEventTime() override;
@@ -27,9 +28,26 @@ class bike : public bluetoothdevice {
     virtual resistance_t pelotonToBikeResistance(int pelotonResistance);
     virtual resistance_t resistanceFromPowerRequest(uint16_t power);
     virtual uint16_t powerFromResistanceRequest(resistance_t requestResistance);
+    /**
+     * @brief The power model of the driver: the watts at a resistance and a cadence, -1 without a model.
+     */
+    virtual double wattsFromResistance(double resistance, double cadence);
+    /**
+     * @brief The Peloton resistance of a resistance level of the driver.
+     */
+    virtual double bikeResistanceToPeloton(double resistance);
+    /**
+     * @brief wattsFromResistance(resistance, cadence) tabulated the first time it's needed, with the calibration of
+     * the user if any. Built again when the settings or maxResistance() change.
+     */
+    const powersurface &powerSurface();
+    /**
+     * @brief bikeResistanceToPeloton() tabulated the same way.
+     */
+    const pelotonmap &pelotonMap();
     virtual bool ergManagedBySS2K() { return false; }
     bluetoothdevice::BLUETOOTH_TYPE deviceType() override;
-    metric pelotonResistance();
+    const metric &pelotonResistance();
     void clearStats() override;
     void setLap() override;
     void setPaused(bool p) override;
@@ -44,7 +62,7 @@ class bike : public bluetoothdevice {
      * for the Elite Sterzo or emulating device. Expected range -45 to +45 degrees.
      * @return A metric object.
      */
-    metric currentSteeringAngle() { return m_steeringAngle; }
+    const metric &currentSteeringAngle() { return m_steeringAngle; }
     virtual bool inclinationAvailableByHardware();
     bool ergModeSupportedAvailableByHardware() { return ergModeSupported; }
 
@@ -70,6 +88,8 @@ class bike : public bluetoothdevice {
     void steeringAngleChanged(double angle);
 
   protected:
+    void fillTelemetry(devicetelemetry &telemetry) override;
+
     metric RequestedResistance;
     metric RequestedPelotonResistance;
     metric RequestedCadence;
@@ -94,6 +114,19 @@ class bike : public bluetoothdevice {
     double m_speedLimit = 0;
 
     uint16_t wattFromHR(bool useSpeedAndCadence);
+
+    /**
+     * @brief Fill the tables over the resistances from 1 to maxResistance(): the drivers override them for another
+     * range or another model.
+     */
+    virtual void buildPowerSurface(powersurface &surface);
+    virtual void buildPelotonMap(pelotonmap &map);
+
+  private:
+    powersurface m_powerSurface;
+    pelotonmap m_pelotonMap;
+    resistance_t powerSurfaceMaxResistance = -1;
+    resistance_t pelotonMapMaxResistance = -1;
 };
 
 #endif // BIKE_H
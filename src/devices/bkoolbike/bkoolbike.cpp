@@ -1,4 +1,5 @@
 #include "bkoolbike.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -404,7 +405,7 @@ void bkoolbike::characteristicChanged(const QLowEnergyCharacteristic &characteri
             } else {
                 Speed = metric::calculateSpeedFromPower(
                     watts(), Inclination.value(), Speed.value(),
-                    fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                    Speed.secondsSinceLastChanged(), this->speedLimit());
             }
             emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
 
@@ -733,25 +734,18 @@ void bkoolbike::controllerStateChanged(QLowEnergyController::ControllerState sta
 }
 
 resistance_t bkoolbike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 0; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 0;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
-double bkoolbike::bikeResistanceToPeloton(double resistance) {
-    QSettings settings;
-    bool tacx_neo2_peloton =
-        settings.value(QZSettings::tacx_neo2_peloton, QZSettings::default_tacx_neo2_peloton).toBool();
+void bkoolbike::buildPelotonMap(pelotonmap &map) {
+    // the levels start from 0
+    map.build(0, max_resistance, [this](double resistance) { return bikeResistanceToPeloton(resistance); });
+}
 
-    if (tacx_neo2_peloton) {
-        return (resistance * settings.value(QZSettings::peloton_gain, QZSettings::default_peloton_gain).toDouble()) +
-               settings.value(QZSettings::peloton_offset, QZSettings::default_peloton_offset).toDouble();
+double bkoolbike::bikeResistanceToPeloton(double resistance) {
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    if (settings.tacx_neo2_peloton) {
+        return (resistance * settings.peloton_gain) + settings.peloton_offset;
     } else {
         return resistance;
     }
@@ -38,15 +38,18 @@ class bkoolbike : public bike {
     bkoolbike(bool noWriteResistance, bool noHeartService);
     void changePower(int32_t power) override;
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
     resistance_t pelotonToBikeResistance(int pelotonResistance);
 
+  protected:
+    void buildPelotonMap(pelotonmap &map) override;
+
   private:
     void writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool disable_log = false,
                              bool wait_for_response = false);
     void startDiscover();
     void forceInclination(double inclination);
     uint16_t watts() override;
-    double bikeResistanceToPeloton(double resistance);
 
     QTimer *refresh;
 
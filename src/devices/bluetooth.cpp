@@ -1,9 +1,11 @@
 #include "bluetooth.h"
+#include "bluetoothdevicematcher.h"
 #include "homeform.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
 #include <QFile>
 #include <QMetaEnum>
+#include <cmath>
 
 #include <QtXml>
 #ifdef Q_OS_ANDROID
@@ -590,8 +592,14 @@ void bluetooth::deviceDiscovered(const QBluetoothDeviceInfo &device) {
                          forceHeartBeltOffForTimeout;
 
     if (searchDevices) {
+        const bluetoothdevicematcher::settingsRules matcherSettings =
+            bluetoothdevicematcher::settingsRules::fromSettings(settings);
         for (const QBluetoothDeviceInfo &b : qAsConst(devices)) {
 
+            // one pass over the name: the chain below only sees the devices it may recognise
+            if (!bluetoothdevicematcher::isCandidate(b, matcherSettings))
+                continue;
+
             bool filter = true;
             if (!filterDevice.isEmpty() && !filterDevice.startsWith(QStringLiteral("Disabled"))) {
 
@@ -2164,13 +2172,13 @@ void bluetooth::connectedAndDiscovered() {
     // only at the first very connection, setting the user default resistance
     if (device() && firstConnected && device()->deviceType() == bluetoothdevice::BIKE &&
         settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt() != 1) {
-        qobject_cast<bike *>(device())->changeResistance(
-            settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt());
+        device()->requestControl(devicecommand::resistance(
+            settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt()));
     } else if (device() && firstConnected && device()->deviceType() == bluetoothdevice::ELLIPTICAL &&
                settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt() !=
                    1) {
-        qobject_cast<elliptical *>(device())->changeResistance(
-            settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt());
+        device()->requestControl(devicecommand::resistance(
+            settings.value(QZSettings::bike_resistance_start, QZSettings::default_bike_resistance_start).toUInt()));
     }
 
     if (heartRateBeltName.startsWith(QStringLiteral("Disabled"))) {
@@ -3244,89 +3252,102 @@ bool bluetooth::handleSignal(int signal) {
     if (signal == SIGNALS::SIG_INT) {
         qDebug() << QStringLiteral("SIGINT");
         QFile::remove(QStringLiteral("status.xml"));
+        telemetry.close();
+        QFile::remove(QStringLiteral(QZ_TELEMETRY_FILE));
         exit(EXIT_SUCCESS);
     }
     // Let the signal propagate as though we had not been there
     return false;
 }
 
+// the segment has its own constants: readers in other languages don't know BLUETOOTH_TYPE
+static uint32_t telemetryDeviceType(bluetoothdevice::BLUETOOTH_TYPE type) {
+    switch (type) {
+    case bluetoothdevice::TREADMILL:
+        return QZ_TELEMETRY_TREADMILL;
+    case bluetoothdevice::BIKE:
+        return QZ_TELEMETRY_BIKE;
+    case bluetoothdevice::ROWING:
+        return QZ_TELEMETRY_ROWING;
+    case bluetoothdevice::ELLIPTICAL:
+        return QZ_TELEMETRY_ELLIPTICAL;
+    default:
+        return QZ_TELEMETRY_UNKNOWN;
+    }
+}
+
+// the live values of the device, as laid out in the telemetry segment
+static qz_telemetry telemetryValues(bluetoothdevice *device) {
+    // a snapshot when the device runs on another thread
+    const devicetelemetry t = device->telemetry();
+    qz_telemetry values;
+    memset(&values, 0, sizeof(values));
+    values.device_type = telemetryDeviceType(device->deviceType());
+    values.flags = (t.connected ? QZ_TELEMETRY_CONNECTED : 0) | (t.paused ? QZ_TELEMETRY_PAUSED : 0);
+    values.speed_kmh = t.speed;
+    values.inclination_pct = t.inclination;
+    values.heart_bpm = t.heart;
+    values.cadence_rpm = t.cadence;
+    values.watts = t.watts;
+    values.resistance = t.resistance;
+    values.peloton_resistance = t.pelotonResistance;
+    values.distance_km = t.distance;
+    values.calories_kcal = t.calories;
+    values.elevation_gain_m = t.elevationGain;
+    values.elapsed_s = t.elapsed;
+    values.moving_s = t.moving;
+    values.latitude = t.latitude;
+    values.longitude = t.longitude;
+    values.altitude_m = t.altitude;
+    return values;
+}
+
 void bluetooth::stateFileRead() {
     if (!device()) {
         return;
     }
 
-    QFile *log;
-    QDomDocument xmlBOM;
-    log = new QFile(QStringLiteral("status.xml"));
-    if (!log->open(QIODevice::ReadOnly | QIODevice::Text)) {
-        qDebug() << QStringLiteral("Open status.xml for writing failed");
+    if (!telemetry.isOpen() && !telemetryOpenFailed) {
+        telemetryOpenFailed = !telemetry.open();
+    }
 
+    // the last values of the previous run, the ones of status.xml if the segment has none
+    double speed = 0;
+    double inclination = 0;
+    qz_telemetry last;
+    if (telemetry.last(&last) && last.device_type == QZ_TELEMETRY_TREADMILL) {
+        speed = last.speed_kmh;
+        inclination = last.inclination_pct;
+    } else if (!telemetrysegment::readStatusFile(QStringLiteral("status.xml"), &speed, &inclination)) {
+        qDebug() << QStringLiteral("Open status.xml for reading failed");
         return;
     }
-    xmlBOM.setContent(log);
-    QDomElement root = xmlBOM.documentElement();
-
-    // Get root names and attributes
-    // QString Type = root.tagName(); //unused
-    // QString lastUpdated = root.attribute(QStringLiteral("Updated"), QDateTime::currentDateTime().toString());
-
-    QDomElement machine = root.firstChild().toElement();
-    // Loop while there is a child
-    while (!machine.isNull()) {
-
-        // Check if the child tag name is COMPONENT
-        if (machine.tagName() == QStringLiteral("Treadmill")) {
 
-            // Read and display the component ID
-            double speed = machine.attribute(QStringLiteral("Speed"), QStringLiteral("0.0")).toDouble();
-            double inclination = machine.attribute(QStringLiteral("Incline"), QStringLiteral("0.0")).toDouble();
-
-            qobject_cast<treadmill *>(device())->setLastSpeed(speed);
-            qobject_cast<treadmill *>(device())->setLastInclination(inclination);
-        }
-
-        // Next component
-        machine = machine.nextSibling().toElement();
+    // on the thread of the device
+    treadmill *t = qobject_cast<treadmill *>(device());
+    if (!t) {
+        return;
     }
-
-    log->close();
+    QMetaObject::invokeMethod(t, [t, speed, inclination]() {
+        t->setLastSpeed(speed);
+        t->setLastInclination(inclination);
+    });
 }
 
 void bluetooth::stateFileUpdate() {
     if (!device()) {
         return;
     }
-    if (device()->deviceType() != bluetoothdevice::TREADMILL) {
-        return;
-    }
 
-    QFile *log;
-    QDomDocument docStatus;
-    QDomElement docRoot;
-    QDomElement docTreadmill;
-    QDomElement docHeart;
-    log = new QFile(QStringLiteral("status.xml"));
-    if (!log->open(QIODevice::WriteOnly | QIODevice::Text)) {
-        qDebug() << QStringLiteral("Open status.xml for writing failed");
+    if (!telemetry.isOpen() && !telemetryOpenFailed) {
+        telemetryOpenFailed = !telemetry.open();
+    }
 
-        return;
+    const qz_telemetry values = telemetryValues(device());
+    telemetry.publish(values);
+    if (device()->deviceType() == bluetoothdevice::TREADMILL) {
+        telemetry.writeStatusFile(QStringLiteral("status.xml"), values);
     }
-    docRoot = docStatus.createElement(QStringLiteral("Gym"));
-    docStatus.appendChild(docRoot);
-    docTreadmill = docStatus.createElement(QStringLiteral("Treadmill"));
-    docTreadmill.setAttribute(QStringLiteral("Speed"), QString::number(device()->currentSpeed().value(), 'f', 1));
-    docTreadmill.setAttribute(
-        QStringLiteral("Incline"),
-        QString::number(qobject_cast<treadmill *>(device())->currentInclination().value(), 'f', 1));
-    docRoot.appendChild(docTreadmill);
-    // docHeart = docStatus.createElement("Heart");
-    // docHeart.setAttribute("Rate", QString::number(currentHeart));
-    // docRoot.appendChild(docHeart);
-    docRoot.setAttribute(QStringLiteral("Updated"), QDateTime::currentDateTime().toString());
-    QTextStream stream(log);
-    stream << docStatus.toString();
-    log->flush();
-    log->close();
 }
 
 void bluetooth::speedChanged(double speed) {
@@ -19,6 +19,7 @@
 
 #include "devices/discoveryoptions.h"
 #include "qzsettings.h"
+#include "telemetrysegment.h"
 
 #include "devices/activiotreadmill/activiotreadmill.h"
 #include "devices/apexbike/apexbike.h"
@@ -152,8 +153,15 @@ class bluetooth : public QObject, public SignalHandler {
     bool onlyDiscover = false;
     volatile bool homeformLoaded = false;
 
+    /**
+     * @brief Publish the live values of the device to the telemetry segment, and to status.xml for a treadmill.
+     */
+    void stateFileUpdate();
+
   private:
     bool useDiscovery = false;
+    telemetrysegment telemetry;
+    bool telemetryOpenFailed = false;
     QFile *debugCommsLog = nullptr;
     QBluetoothDeviceDiscoveryAgent *discoveryAgent = nullptr;
     apexbike *apexBike = nullptr;
@@ -284,7 +292,6 @@ class bluetooth : public QObject, public SignalHandler {
 
     bool handleSignal(int signal) override;
     bool deviceHasService(const QBluetoothDeviceInfo &device, QBluetoothUuid service);
-    void stateFileUpdate();
     void stateFileRead();
     bool heartRateBeltAvaiable();
     bool ftmsAccessoryAvaiable();
@@ -1,7 +1,9 @@
 #include "devices/bluetoothdevice.h"
+#include "qzsettingssnapshot.h"
 
 #include <QFile>
 #include <QSettings>
+#include <QThread>
 #include <QTime>
 
 #ifdef Q_OS_ANDROID
@@ -11,6 +13,9 @@
 #include "ios/lockscreen.h"
 #endif
 
+static const int MetersByInclinationTypeId = qRegisterMetaType<QVector<MetersByInclination>>();
+static const int WorkoutEventStateTypeId = qRegisterMetaType<bluetoothdevice::WORKOUT_EVENT_STATE>();
+
 bluetoothdevice::bluetoothdevice() {}
 
 bluetoothdevice::~bluetoothdevice() {
@@ -27,9 +32,9 @@ void bluetoothdevice::stop(bool pause) {
     if (pause)
         requestPause = 1;
 }
-metric bluetoothdevice::currentHeart() { return Heart; }
-metric bluetoothdevice::currentSpeed() { return Speed; }
-metric bluetoothdevice::currentInclination() { return Inclination; }
+const metric &bluetoothdevice::currentHeart() { return Heart; }
+const metric &bluetoothdevice::currentSpeed() { return Speed; }
+const metric &bluetoothdevice::currentInclination() { return Inclination; }
 QTime bluetoothdevice::movingTime() {
     int hours = (int)(moving.value() / 3600.0);
     return QTime(hours, (int)(moving.value() - ((double)hours * 3600.0)) / 60.0, ((uint32_t)moving.value()) % 60, 0);
@@ -44,8 +49,8 @@ QTime bluetoothdevice::lapElapsedTime() {
                  ((uint32_t)elapsed.lapValue()) % 60, 0);
 }
 
-metric bluetoothdevice::currentResistance() { return Resistance; }
-metric bluetoothdevice::currentCadence() { return Cadence; }
+const metric &bluetoothdevice::currentResistance() { return Resistance; }
+const metric &bluetoothdevice::currentCadence() { return Cadence; }
 double bluetoothdevice::currentCrankRevolutions() { return 0; }
 uint16_t bluetoothdevice::lastCrankEventTime() { return 0; }
 
@@ -108,8 +113,8 @@ QTime bluetoothdevice::maxPace() {
 
 double bluetoothdevice::odometerFromStartup() { return Distance.valueRaw(); }
 double bluetoothdevice::odometer() { return Distance.value(); }
-metric bluetoothdevice::calories() { return KCal; }
-metric bluetoothdevice::jouls() { return m_jouls; }
+const metric &bluetoothdevice::calories() { return KCal; }
+const metric &bluetoothdevice::jouls() { return m_jouls; }
 uint8_t bluetoothdevice::fanSpeed() { return FanSpeed; };
 bool bluetoothdevice::changeFanSpeed(uint8_t speed) {
     // managing underflow
@@ -130,14 +135,14 @@ bool bluetoothdevice::changeFanSpeed(uint8_t speed) {
     return false;
 }
 bool bluetoothdevice::connected() { return false; }
-metric bluetoothdevice::elevationGain() { return elevationAcc; }
+const metric &bluetoothdevice::elevationGain() { return elevationAcc; }
 void bluetoothdevice::heartRate(uint8_t heart) { Heart.setValue(heart); }
 void bluetoothdevice::disconnectBluetooth() {
     if (m_control) {
         m_control->disconnectFromDevice();
     }
 }
-metric bluetoothdevice::wattsMetric() { return m_watt; }
+const metric &bluetoothdevice::wattsMetric() { return m_watt; }
 void bluetoothdevice::setDifficult(double d) { m_difficult = d; }
 double bluetoothdevice::difficult() { return m_difficult; }
 void bluetoothdevice::setInclinationDifficult(double d) { m_inclination_difficult = d; }
@@ -173,22 +178,15 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
 
     QDateTime current = QDateTime::currentDateTime();
     double deltaTime = (((double)_lastTimeUpdate.msecsTo(current)) / ((double)1000.0));
-    QSettings settings;
-    QString heartRateBeltName =
-        settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
-    bool power_as_bike =
-        settings.value(QZSettings::power_sensor_as_bike, QZSettings::default_power_sensor_as_bike).toBool();
-    bool power_as_treadmill =
-        settings.value(QZSettings::power_sensor_as_treadmill, QZSettings::default_power_sensor_as_treadmill).toBool();
-
-    if (settings.value(QZSettings::power_sensor_name, QZSettings::default_power_sensor_name)
-                .toString()
-                .startsWith(QStringLiteral("Disabled")) == false &&
-        !power_as_bike && !power_as_treadmill)
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool power_as_bike = settings.power_sensor_as_bike;
+    bool power_as_treadmill = settings.power_sensor_as_treadmill;
+
+    if (settings.power_sensor_disabled == false && !power_as_bike && !power_as_treadmill)
         watt_calc = false;
 
     if (!_firstUpdate && !paused) {
-        if (currentSpeed().value() > 0.0 || settings.value(QZSettings::continuous_moving, true).toBool()) {
+        if (currentSpeed().value() > 0.0 || settings.continuous_moving) {
 
             elapsed += deltaTime;
         }
@@ -200,7 +198,7 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
             if (watt_calc) {
                 m_watt = watts;
             }
-            WattKg = m_watt.value() / settings.value(QZSettings::weight, QZSettings::default_weight).toFloat();
+            WattKg = m_watt.value() / settings.weight;
         } else if (m_watt.value() > 0) {
 
             if (watt_calc) {
@@ -208,13 +206,12 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
             }
             WattKg = 0;
         }
-    } else if (paused && settings.value(QZSettings::instant_power_on_pause, QZSettings::default_instant_power_on_pause)
-                             .toBool()) {
+    } else if (paused && settings.instant_power_on_pause) {
         // useful for FTP test
         if (watt_calc) {
             m_watt = watts;
         }
-        WattKg = m_watt.value() / settings.value(QZSettings::weight, QZSettings::default_weight).toFloat();
+        WattKg = m_watt.value() / settings.weight;
     } else if (m_watt.value() > 0) {
 
         m_watt = 0;
@@ -226,6 +223,87 @@ void bluetoothdevice::update_metrics(bool watt_calc, const double watts) {
 
     _lastTimeUpdate = current;
     _firstUpdate = false;
+    publishTelemetry();
+}
+
+void bluetoothdevice::fillTelemetry(devicetelemetry &telemetry) {
+    telemetry.deviceType = deviceType();
+    telemetry.connected = connected();
+    telemetry.paused = isPaused();
+    telemetry.speed = currentSpeed().value();
+    telemetry.inclination = currentInclination().value();
+    telemetry.heart = currentHeart().value();
+    telemetry.cadence = currentCadence().value();
+    telemetry.watts = wattsMetric().value();
+    telemetry.resistance = currentResistance().value();
+    telemetry.distance = odometer();
+    telemetry.calories = calories().value();
+    telemetry.elevationGain = elevationGain().value();
+    telemetry.elapsed = elapsedTime().msecsSinceStartOfDay() / 1000.0;
+    telemetry.moving = movingTime().msecsSinceStartOfDay() / 1000.0;
+    const QGeoCoordinate coordinate = currentCordinate();
+    if (coordinate.isValid()) {
+        telemetry.latitude = coordinate.latitude();
+        telemetry.longitude = coordinate.longitude();
+        telemetry.altitude = coordinate.altitude();
+    }
+}
+
+devicetelemetry bluetoothdevice::telemetry() {
+    if (QThread::currentThread() != thread())
+        return m_telemetry.load();
+    devicetelemetry telemetry;
+    fillTelemetry(telemetry);
+    telemetry.publishedNs = metric::monotonicNs();
+    return telemetry;
+}
+
+void bluetoothdevice::publishTelemetry() { m_telemetry.store(telemetry()); }
+
+void bluetoothdevice::telemetryForwarded() {
+    // the last notification of the values a virtual device forwards
+    const qint64 notified = qMax(qMax(Speed.lastChangedNs(), Cadence.lastChangedNs()), m_watt.lastChangedNs());
+    if (notified == lastForwardedNs)
+        return;
+    lastForwardedNs = notified;
+
+    // values resent while the device is silent aren't a latency
+    const qint64 now = metric::monotonicNs();
+    if (now - notified > 5000000000LL)
+        return;
+    m_forwardingLatency.record((now - notified) / 1000);
+    if (now - lastLatencyLogNs > 60000000000LL) {
+        lastLatencyLogNs = now;
+        qDebug() << QStringLiteral("forwarding latency") << m_forwardingLatency.toString();
+    }
+}
+
+void bluetoothdevice::requestControl(const devicecommand &command) {
+    const bool wake = m_controlQueue.push(command);
+    if (QThread::currentThread() == thread())
+        drainControl();
+    else if (wake)
+        QMetaObject::invokeMethod(this, "drainControl", Qt::QueuedConnection);
+}
+
+void bluetoothdevice::drainControl() {
+    devicecommand commands[devicecommand::KINDS];
+    const int count = m_controlQueue.take(commands);
+    for (int i = 0; i < count; i++) {
+        switch (commands[i].kind) {
+        case devicecommand::RESISTANCE:
+            changeResistance((resistance_t)commands[i].value);
+            break;
+        case devicecommand::POWER:
+            changePower((int32_t)commands[i].value);
+            break;
+        case devicecommand::INCLINATION:
+            changeInclination(commands[i].value, commands[i].percentage);
+            break;
+        default:
+            break;
+        }
+    }
 }
 
 void bluetoothdevice::update_hr_from_external() {
@@ -428,6 +506,16 @@ uint8_t bluetoothdevice::metrics_override_heartrate() {
     return currentHeart().value();
 }
 
+QVector<MetersByInclination> bluetoothdevice::nextInclination300Meters() {
+    QMutexLocker locker(&nextInclination300MetersMutex);
+    return NextInclination300Meters;
+}
+
+void bluetoothdevice::changeNextInclination300Meters(const QVector<MetersByInclination> &i) {
+    QMutexLocker locker(&nextInclination300MetersMutex);
+    NextInclination300Meters = i;
+}
+
 void bluetoothdevice::changeGeoPosition(QGeoCoordinate p, double azimuth, double avgAzimuthNext300Meters) {
     coordinateTS = QDateTime::currentMSecsSinceEpoch();
     coordinateOdometer = odometer();
@@ -2,15 +2,21 @@
 #define BLUETOOTHDEVICE_H
 
 #include "definitions.h"
+#include "devices/devicecontrolqueue.h"
+#include "devices/devicetelemetry.h"
+#include "latencyhistogram.h"
 #include "metric.h"
 #include "qzsettings.h"
+#include "seqlock.h"
 
 #include <QBluetoothDeviceDiscoveryAgent>
 #include <QBluetoothDeviceInfo>
 #include <QDateTime>
 #include <QGeoCoordinate>
+#include <QMutex>
 #include <QObject>
 #include <QTimer>
+#include <QVector>
 
 #include <QtBluetooth/qlowenergyadvertisingdata.h>
 #include <QtBluetooth/qlowenergyadvertisingparameters.h>
@@ -59,12 +65,12 @@ class bluetoothdevice : public QObject {
     /**
      * @brief currentHeart Gets a metric object for getting and setting the current heart rate. Units: beats per minute
      */
-    virtual metric currentHeart();
+    virtual const metric &currentHeart();
 
     /**
      * @brief currentSpeed Gets a metric object for getting and setting the speed. Units: km/h
      */
-    virtual metric currentSpeed();
+    virtual const metric &currentSpeed();
 
     /**
      * @brief currentPace Gets the current pace. Units: time per km
@@ -76,7 +82,7 @@ class bluetoothdevice : public QObject {
      * Units: Percentage vertical to horizontal
      * Expected range: Depends on device.
      */
-    virtual metric currentInclination();
+    virtual const metric &currentInclination();
 
     /**
      * @brief setInclination Set the protected Inclination metric, which could be different from that
@@ -101,8 +107,8 @@ class bluetoothdevice : public QObject {
      */
     virtual double odometer();
     virtual double odometerFromStartup();
-    virtual metric currentDistance() {return Distance;}
-    virtual metric currentDistance1s() {return Distance1s;}
+    virtual const metric &currentDistance() {return Distance;}
+    virtual const metric &currentDistance1s() {return Distance1s;}
     void addCurrentDistance1s(double distance) { Distance1s += distance; }
 
     /**
@@ -111,12 +117,12 @@ class bluetoothdevice : public QObject {
      * Other implementations could have different units.
      * @return
      */
-    virtual metric calories();
+    virtual const metric &calories();
 
     /**
      * @brief jouls Gets a metric object to get and set the number of joules expended. Units: joules
      */
-    metric jouls();
+    const metric &jouls();
 
     /**
      * @brief fanSpeed Gets the current fan speed. Units: depends on device
@@ -154,12 +160,12 @@ class bluetoothdevice : public QObject {
      * @brief currentResistance Gets a metric object to get or set the currently requested resistance.
      * Expected range: 0 to maxResistance()
      */
-    virtual metric currentResistance();
+    virtual const metric &currentResistance();
 
     /**
      * @brief currentCadence Gets a metric object to get and set the current cadence. Units: revolutions per minute
      */
-    virtual metric currentCadence();
+    virtual const metric &currentCadence();
 
     /**
      * @brief currentCrankRevolutions Gets the current total number of crank revolutions.
@@ -175,7 +181,7 @@ class bluetoothdevice : public QObject {
      * @brief nextInclination300Meters The next 300m of track sections: length and inclination
      * @return A list of MetersByInclination objects
      */
-    virtual QList<MetersByInclination> nextInclination300Meters() { return NextInclination300Meters; }
+    virtual QVector<MetersByInclination> nextInclination300Meters();
 
     /**
      * @brief currentAzimuth Gets the current azimuth. Units: degrees (? = North)
@@ -213,7 +219,7 @@ class bluetoothdevice : public QObject {
     /**
      * @brief wattsMetric Gets a metric object to get or set the amount of power used.  Units: watts
      */
-    metric wattsMetric();
+    const metric &wattsMetric();
 
     /**
      * @brief changeFanSpeed Tries to change the fan speed.
@@ -224,7 +230,7 @@ class bluetoothdevice : public QObject {
     /**
      * @brief elevationGain Gets a metric object to get and set the elevation gain. Units: ?
      */
-    virtual metric elevationGain();
+    virtual const metric &elevationGain();
 
     /**
      * @brief clearStats Clear the statistics.
@@ -326,33 +332,33 @@ class bluetoothdevice : public QObject {
      * @brief wattKg Gets a metric object to get and set the watt kg of something. Units: watt kg
      * @return
      */
-    metric wattKg() { return WattKg; }
+    const metric &wattKg() { return WattKg; }
 
     /**
      * @brief currentMETS Gets a metric object to get and set the current METS (Metabolic Equivalent of Tasks)
      * Units: METs (1 MET is approximately 3.5mL of Oxygen consumed per kg of body weight per minute)
      */
-    metric currentMETS() { return METS; }
+    const metric &currentMETS() { return METS; }
 
     /**
      * @brief currentHeartZone Gets a metric object to get or set the current heart zone. Units: depends on
      * implementation.
      */
-    metric currentHeartZone() { return HeartZone; }
+    const metric &currentHeartZone() { return HeartZone; }
 
     /**
      * @brief currentPowerZone Gets a metric object to get or set the current power zome. Units: depends on
      * implementation.
      * @return
      */
-    metric currentPowerZone() { return PowerZone; }
+    const metric &currentPowerZone() { return PowerZone; }
 
     /**
      * @brief currentPowerZone Gets a metric object to get or set the current power zome. Units: depends on
      * implementation.
      * @return
      */
-    metric targetPowerZone() { return TargetPowerZone; }
+    const metric &targetPowerZone() { return TargetPowerZone; }
 
     /**
      * @brief setGPXFile Sets the file for GPS data exchange.
@@ -413,6 +419,34 @@ class bluetoothdevice : public QObject {
      */
     virtual resistance_t maxResistance();
 
+    /**
+     * @brief The live values of the device. From another thread than the one of the device, the ones it published at
+     * its last update_metrics().
+     */
+    devicetelemetry telemetry();
+
+    /**
+     * @brief Changes at every publication of telemetry().
+     */
+    quint32 telemetryVersion() const { return m_telemetry.version(); }
+
+    /**
+     * @brief Sends a target to the device from any thread: applied at once on the thread of the device, queued for it
+     * from the other ones.
+     */
+    void requestControl(const devicecommand &command);
+
+    /**
+     * @brief Called by the virtual device when it sent the values of the device: records the time since the device
+     * received them, once for each notification of the device.
+     */
+    void telemetryForwarded();
+
+    /**
+     * @brief Time from a notification of the device to its values sent by the virtual device.
+     */
+    const latencyhistogram &forwardingLatency() const { return m_forwardingLatency; }
+
   public Q_SLOTS:
     virtual void start();
     virtual void stop(bool pause);
@@ -428,7 +462,7 @@ class bluetoothdevice : public QObject {
     virtual void instantaneousStrideLengthSensor(double length);
     virtual void groundContactSensor(double groundContact);
     virtual void verticalOscillationSensor(double verticalOscillation);
-    virtual void changeNextInclination300Meters(QList<MetersByInclination> i) { NextInclination300Meters = i; }
+    virtual void changeNextInclination300Meters(const QVector<MetersByInclination> &i);
 
   Q_SIGNALS:
     void connectedAndDiscovered();
@@ -619,7 +653,9 @@ class bluetoothdevice : public QObject {
     /**
      * @brief NextInclination300Meters A list of the length and inclination of track sections for the next 300m
      */
-    QList<MetersByInclination> NextInclination300Meters;
+    QVector<MetersByInclination> NextInclination300Meters;
+    // NextInclination300Meters, set on the thread of the device and read by the templates
+    mutable QMutex nextInclination300MetersMutex;
 
     /**
      * @brief Inclination A metric to get and set the currently requested inclinaton. Units: degrees (0 = horizontal)
@@ -670,6 +706,16 @@ class bluetoothdevice : public QObject {
      */
     void update_metrics(bool watt_calc, const double watts);
 
+    /**
+     * @brief Publishes telemetry(); update_metrics() calls it.
+     */
+    void publishTelemetry();
+
+    /**
+     * @brief Fills the values of telemetry() the device knows about. Subclasses add their own ones.
+     */
+    virtual void fillTelemetry(devicetelemetry &telemetry);
+
     /**
      * @brief update_hr_from_external Updates heart rate from Garmin Companion App or Apple Watch
      */
@@ -702,9 +748,22 @@ class bluetoothdevice : public QObject {
     VIRTUAL_DEVICE_MODE virtualDeviceMode = VIRTUAL_DEVICE_MODE::NONE;
     virtualdevice *virtualDevice = nullptr;
 
+    seqlock<devicetelemetry> m_telemetry;
+    devicecontrolqueue m_controlQueue;
+    latencyhistogram m_forwardingLatency;
+    qint64 lastForwardedNs = 0;
+    qint64 lastLatencyLogNs = 0;
+
+  private slots:
+    void drainControl();
+
   protected:
     // useful to understand if a power sensor device for treadmill, it's a real one like the stryd or it's a dumb one like the runpod from Zwift
     bool powerReceivedFromPowerSensor = false;
 };
 
+// the arguments of the queued connections to a device on another thread than the GUI one
+Q_DECLARE_METATYPE(QVector<MetersByInclination>)
+Q_DECLARE_METATYPE(bluetoothdevice::WORKOUT_EVENT_STATE)
+
 #endif // BLUETOOTHDEVICE_H
@@ -0,0 +1,393 @@
+#include "bluetoothdevicematcher.h"
+#include "qzsettings.h"
+#include "devices/yesoulbike/yesoulbike.h"
+
+const QVector<bluetoothdevicematcher::rule> &bluetoothdevicematcher::rules() {
+    // in the order of the discovery chain; negative conditions (e.g. "DomyosBridge") aren't listed, the chain
+    // applies them
+    static const QVector<rule> r = {
+        {"M3", StartsWith},
+        {"JOROTO-BK-", StartsWithIgnoreCase},
+        {"ZWIFT RUNPOD", StartsWithIgnoreCase},
+        {"DOMYOS-ROW", StartsWithIgnoreCase},
+        {"Domyos-Bike", StartsWith},
+        {"Domyos-EL", StartsWith},
+        {"YPOO-U3-", StartsWithIgnoreCase},
+        {"FS-", StartsWith},
+        {"NAUTILUS E", StartsWithIgnoreCase},
+        {"NAUTILUS M", StartsWithIgnoreCase},
+        {"NAUTILUS B", StartsWithIgnoreCase},
+        {"I_FS", StartsWithIgnoreCase},
+        {"I_EL", StartsWithIgnoreCase},
+        {"I_VE", StartsWithIgnoreCase},
+        {"I_RW", StartsWithIgnoreCase},
+        {"B01_", StartsWithIgnoreCase},
+        // sole elliptical
+        {"E95S", StartsWithIgnoreCase},
+        {"E25", StartsWithIgnoreCase},
+        {"E35", StartsWithIgnoreCase},
+        {"E55", StartsWithIgnoreCase},
+        {"E95", StartsWithIgnoreCase},
+        {"E98", StartsWithIgnoreCase},
+        {"XG400", StartsWithIgnoreCase},
+        {"E98S", StartsWithIgnoreCase},
+        // domyos treadmill
+        {"Domyos", StartsWith},
+        // kingsmith
+        {"KS-ST-K12PRO", StartsWithIgnoreCase},
+        {"KS-R1AC", StartsWithIgnoreCase},
+        {"KS-HC-R1AA", StartsWithIgnoreCase},
+        {"KS-HC-R1AC", StartsWithIgnoreCase},
+        {"KS-X21", StartsWithIgnoreCase},
+        {"KS-HDSC-X21C", StartsWithIgnoreCase},
+        {"KS-HDSY-X21C", StartsWithIgnoreCase},
+        {"KS-NACH-X21C", StartsWithIgnoreCase},
+        {"KS-NGCH-X21C", StartsWithIgnoreCase},
+        {"KS-NGCH-G1C", StartsWithIgnoreCase},
+        {"R1 PRO", StartsWithIgnoreCase},
+        {"KINGSMITH", StartsWithIgnoreCase},
+        {"DYNAMAX", StartsWithIgnoreCase},
+        {"WALKINGPAD", StartsWithIgnoreCase},
+        {"KS-ST-A1P", StartsWithIgnoreCase},
+        {"KS-SC-BLR2C", StartsWithIgnoreCase},
+        {"RE", ExactIgnoreCase},
+        {"KS-H", StartsWithIgnoreCase},
+        {"KS-BLC", StartsWithIgnoreCase},
+        {"KS-BLR", StartsWithIgnoreCase},
+        // shuaa5 treadmill
+        {"ZW-", StartsWithIgnoreCase},
+        // true treadmill
+        {"TRUE", StartsWithIgnoreCase},
+        {"ASSAULT TREADMILL ", StartsWithIgnoreCase},
+        {"WDWAY", StartsWithIgnoreCase},
+        {"TREADMILL", StartsWithIgnoreCase},
+        // sole treadmill
+        {"F80", StartsWithIgnoreCase},
+        {"F65", StartsWithIgnoreCase},
+        {"TT8", StartsWithIgnoreCase},
+        {"F63", StartsWithIgnoreCase},
+        {"ST90", StartsWithIgnoreCase},
+        {"TRX7.5", StartsWithIgnoreCase},
+        {"S77", StartsWithIgnoreCase},
+        {"F85", StartsWithIgnoreCase},
+        // life fitness treadmill
+        {"LF", StartsWithIgnoreCase},
+        // horizon treadmill
+        {"HORIZON", StartsWithIgnoreCase},
+        {"AFG SPORT", StartsWithIgnoreCase},
+        {"WLT2541", StartsWithIgnoreCase},
+        {"T318_", StartsWithIgnoreCase},
+        {"DK", StartsWithIgnoreCase},
+        {"T218_", StartsWithIgnoreCase},
+        {"TRX3500", StartsWithIgnoreCase},
+        {"JFTMPARAGON", StartsWithIgnoreCase},
+        {"PARAGON X", StartsWithIgnoreCase},
+        {"MX-TM ", StartsWithIgnoreCase},
+        {"JFTM", StartsWithIgnoreCase},
+        {"CT800", StartsWithIgnoreCase},
+        {"TRX4500", StartsWithIgnoreCase},
+        {"MATRIXTF50", StartsWithIgnoreCase},
+        {"T01_", StartsWithIgnoreCase},
+        {"TF-", StartsWithIgnoreCase},
+        {"TOORX", StartsWithIgnoreCase},
+        {"I-CONSOLE+", StartsWithIgnoreCase},
+        {"DOMYOS-TC", StartsWithIgnoreCase},
+        {"XT685", StartsWithIgnoreCase},
+        {"T118_", StartsWithIgnoreCase},
+        {"FIT-", StartsWithIgnoreCase},
+        {"MOBVOI TM", StartsWithIgnoreCase},
+        {"TUNTURI T60-", StartsWithIgnoreCase},
+        {"KETTLER TREADMILL", StartsWithIgnoreCase},
+        {"ASSAULTRUNNER", StartsWithIgnoreCase},
+        {"CITYSPORTS-LINKER", StartsWithIgnoreCase},
+        {"CTM", StartsWithIgnoreCase},
+        {"ANPLUS-", StartsWithIgnoreCase},
+        {"ESANGLINKER", StartsWithIgnoreCase},
+        // technogym myrun
+        {"MYRUN ", StartsWithIgnoreCase},
+        {"MERACH-U3", StartsWithIgnoreCase},
+        // tacx neo 2
+        {"TACX ", StartsWithIgnoreCase},
+        {"THINK X", StartsWithIgnoreCase},
+        {"TACX SMART BIKE", StartsWithIgnoreCase},
+        // npe cable bike
+        {">CABLE", StartsWithIgnoreCase},
+        {"MD", StartsWithIgnoreCase},
+        {"BIKE", StartsWithIgnoreCase},
+        // ftms bike
+        {"ICONSOLE+", StartsWithIgnoreCase},
+        {"DI", StartsWithIgnoreCase},
+        {"DHZ-", StartsWithIgnoreCase},
+        {"MKSM", StartsWithIgnoreCase},
+        {"YS_C1_", StartsWithIgnoreCase},
+        {"YS_G1_", StartsWithIgnoreCase},
+        {"DS25-", StartsWithIgnoreCase},
+        {"SCHWINN 510T", StartsWithIgnoreCase},
+        {"ZWIFT HUB", StartsWithIgnoreCase},
+        {"MAGNUS ", StartsWithIgnoreCase},
+        {"HAMMER ", StartsWithIgnoreCase},
+        {"FLXCY-", StartsWithIgnoreCase},
+        {"QB-WC01", StartsWithIgnoreCase},
+        {"XBR55", StartsWithIgnoreCase},
+        {"ECHO_BIKE_", StartsWithIgnoreCase},
+        {"EW-JS-", StartsWithIgnoreCase},
+        {"DT-", StartsWithIgnoreCase},
+        {"URSB", StartsWithIgnoreCase},
+        {"DBF", StartsWithIgnoreCase},
+        {"KSU", StartsWithIgnoreCase},
+        {"KICKR CORE", StartsWithIgnoreCase},
+        {"MERACH-MR667-", StartsWithIgnoreCase},
+        {"DS60-", StartsWithIgnoreCase},
+        {"FAL-SPORTS", StartsWithIgnoreCase},
+        {"DOMYOS-BIKING-", StartsWithIgnoreCase},
+        {"ICSE", StartsWithIgnoreCase},
+        {"CSRB", StartsWithIgnoreCase},
+        {"DU30-", StartsWithIgnoreCase},
+        {"ZUMO", StartsWithIgnoreCase},
+        {"XS08-", StartsWithIgnoreCase},
+        {"B94", StartsWithIgnoreCase},
+        {"STAGES BIKE", StartsWithIgnoreCase},
+        {"SUITO", StartsWithIgnoreCase},
+        {"D2RIDE", StartsWithIgnoreCase},
+        {"DIRETO XR", StartsWithIgnoreCase},
+        {"MERACH-667-", StartsWithIgnoreCase},
+        {"SMB1", StartsWithIgnoreCase},
+        {"UBIKE FTMS", StartsWithIgnoreCase},
+        {"INRIDE", StartsWithIgnoreCase},
+        // wahoo kickr
+        {"KICKR SNAP", StartsWithIgnoreCase},
+        {"KICKR BIKE", StartsWithIgnoreCase},
+        {"KICKR ROLLR", StartsWithIgnoreCase},
+        {"WAHOO KICKR", StartsWithIgnoreCase},
+        // horizon gr7
+        {"JFIC", StartsWithIgnoreCase},
+        // stages bike
+        {"STAGES ", StartsWithIgnoreCase},
+        {"TACX SATORI", StartsWithIgnoreCase},
+        {"QD", StartsWithIgnoreCase},
+        {"ASSIOMA", StartsWithIgnoreCase},
+        {"SMARTROW", StartsWithIgnoreCase},
+        // concept2 skierg and ftms rower
+        {"PM5", StartsWithIgnoreCase},
+        {"CR 00", StartsWithIgnoreCase},
+        {"KAYAKPRO", StartsWithIgnoreCase},
+        {"WHIPR", StartsWithIgnoreCase},
+        {"S4 COMMS", StartsWithIgnoreCase},
+        {"KS-WLT", StartsWithIgnoreCase},
+        {"I-ROWER", StartsWithIgnoreCase},
+        {"SF-RW", StartsWithIgnoreCase},
+        {"DFIT-L-R", StartsWithIgnoreCase},
+        // echelon
+        {"ECH-STRIDE", StartsWithIgnoreCase},
+        {"ECH-UK-", StartsWithIgnoreCase},
+        {"ECH-FR-", StartsWithIgnoreCase},
+        {"ECH-SD-SPT", StartsWithIgnoreCase},
+        // octane, zipro
+        {"Q37", StartsWithIgnoreCase},
+        {"ZR7", StartsWithIgnoreCase},
+        {"ZR8", StartsWithIgnoreCase},
+        {"RZ_TREADMIL", StartsWithIgnoreCase},
+        // echelon rower and bike
+        {"ECH-ROW", StartsWith},
+        {"ROWSPORT-", StartsWithIgnoreCase},
+        {"ROW-S", StartsWith},
+        {"ECH", StartsWith},
+        {"WLT8266BM", StartsWithIgnoreCase},
+        {"BKOOLSMARTPRO", StartsWithIgnoreCase},
+        {"MEPANEL", StartsWithIgnoreCase},
+        // schwinn
+        {"SCHWINN 170/270", StartsWithIgnoreCase},
+        {"IC BIKE", StartsWithIgnoreCase},
+        {"C7-", StartsWithIgnoreCase},
+        {"C9/C10", StartsWithIgnoreCase},
+        {"EW-BK", StartsWithIgnoreCase},
+        // sports plus
+        {"CARDIOFIT", StartsWithIgnoreCase},
+        {"CARE", ContainsIgnoreCase},
+        {yesoulbike::bluetoothName, StartsWith},
+        // proform
+        {"I_EB", StartsWith},
+        {"I_SB", StartsWith},
+        {"I_TL", StartsWith},
+        {"I_IT", StartsWith},
+        {"ESLINKER", StartsWithIgnoreCase},
+        {"PAFERS_", StartsWithIgnoreCase},
+        {"BOWFLEX T", StartsWithIgnoreCase},
+        {"NAUTILUS T", StartsWithIgnoreCase},
+        {"Flywheel", StartsWith},
+        {"MCF-", StartsWithIgnoreCase},
+        // toorx
+        {"TRX ROUTE KEY", StartsWith},
+        {"BH-TR-", StartsWithIgnoreCase},
+        {"BH DUALKIT", StartsWithIgnoreCase},
+        // spirit, activio
+        {"XT385", StartsWithIgnoreCase},
+        {"XT485", StartsWithIgnoreCase},
+        {"XT800", StartsWithIgnoreCase},
+        {"XT900", StartsWithIgnoreCase},
+        {"RUNNERT", StartsWithIgnoreCase},
+        // trx app gate usb treadmill
+        {"V-RUN", StartsWith},
+        {"K80_", StartsWithIgnoreCase},
+        {"I-RUNNING", StartsWithIgnoreCase},
+        {"DKN RUN", StartsWithIgnoreCase},
+        {"ADIDAS ", StartsWithIgnoreCase},
+        {"REEBOK", StartsWithIgnoreCase},
+        // trx app gate usb bike
+        {"TUN ", StartsWithIgnoreCase},
+        {"FITHIWAY", StartsWithIgnoreCase},
+        {"FIT HI WAY", StartsWithIgnoreCase},
+        {"I-CONSOIE+", StartsWithIgnoreCase},
+        {"IBIKING+", StartsWithIgnoreCase},
+        {"VIFHTR2.1", StartsWithIgnoreCase},
+        {"CR011R", ContainsIgnoreCase},
+        {"DKN MOTION", StartsWithIgnoreCase},
+        {"X-BIKE", StartsWithIgnoreCase},
+        {"KEEP_BIKE_", StartsWithIgnoreCase},
+        // sole bike, skandika wiri
+        {"LCB", StartsWithIgnoreCase},
+        {"R92", StartsWithIgnoreCase},
+        {"BFCP", StartsWithIgnoreCase},
+        {"HT", StartsWithIgnoreCase},
+        // renpho
+        {"RQ", StartsWithIgnoreCase},
+        {"R-Q", StartsWithIgnoreCase},
+        {"SCH130", StartsWithIgnoreCase},
+        // fitplus, fitshow
+        {"MRK-", StartsWith},
+        {"NOBLEPRO CONNECT", StartsWithIgnoreCase},
+        {"SW", StartsWith},
+        {"WINFITA", StartsWithIgnoreCase},
+        {"BF70", StartsWith},
+        // inspire, chrono
+        {"IC", StartsWithIgnoreCase},
+        {"CHRONO ", StartsWithIgnoreCase},
+    };
+    return r;
+}
+
+bluetoothdevicematcher::index::index() {
+    const QVector<rule> &r = rules();
+    terminal.append(QVector<int>());
+    for (int i = 0; i < r.count(); i++) {
+        if (r.at(i).cmp == ContainsIgnoreCase) {
+            contains.append(i);
+            continue;
+        }
+        const QString name = QString::fromLatin1(r.at(i).name);
+        int node = 0;
+        for (const QChar c : name) {
+            const quint64 key = ((quint64)node << 16) | c.toUpper().unicode();
+            int child = edges.value(key, -1);
+            if (child < 0) {
+                child = terminal.count();
+                terminal.append(QVector<int>());
+                edges.insert(key, child);
+            }
+            node = child;
+        }
+        terminal[node].append(i);
+    }
+}
+
+const bluetoothdevicematcher::index &bluetoothdevicematcher::compiled() {
+    static const index i;
+    return i;
+}
+
+int bluetoothdevicematcher::match(const QString &name) {
+    const index &idx = compiled();
+    const QVector<rule> &r = rules();
+    const int length = name.length();
+    int node = 0;
+    for (int i = 0;; i++) {
+        // the rules ending here are prefixes of the name, long i
+        for (int ruleIndex : idx.terminal.at(node)) {
+            switch (r.at(ruleIndex).cmp) {
+            case StartsWithIgnoreCase:
+                return ruleIndex;
+            case StartsWith:
+                if (name.startsWith(QLatin1String(r.at(ruleIndex).name)))
+                    return ruleIndex;
+                break;
+            case ExactIgnoreCase:
+                if (i == length)
+                    return ruleIndex;
+                break;
+            case ContainsIgnoreCase:
+                break;
+            }
+        }
+        if (i == length)
+            break;
+        node = idx.edges.value(((quint64)node << 16) | name.at(i).toUpper().unicode(), -1);
+        if (node < 0)
+            break;
+    }
+    for (int ruleIndex : idx.contains) {
+        if (name.contains(QLatin1String(r.at(ruleIndex).name), Qt::CaseInsensitive))
+            return ruleIndex;
+    }
+    return -1;
+}
+
+bool bluetoothdevicematcher::isCandidate(const QBluetoothDeviceInfo &device, const settingsRules &settings) {
+    // specific TACX NEO 2 #1707, recognised by its address
+    static const QBluetoothAddress tacxNeo2(QStringLiteral("C1:14:D9:9C:FB:01"));
+    if (device.address() == tacxNeo2)
+        return true;
+    return isCandidate(device.name(), settings);
+}
+
+bool bluetoothdevicematcher::isCandidate(const QString &name, const settingsRules &settings) {
+    if (settings.anyDevice || match(name) >= 0)
+        return true;
+    for (const QString &prefix : settings.prefixes) {
+        if (name.startsWith(prefix))
+            return true;
+    }
+    for (const QString &prefix : settings.prefixesIgnoreCase) {
+        if (name.startsWith(prefix, Qt::CaseInsensitive))
+            return true;
+    }
+    for (const QString &n : settings.namesIgnoreCase) {
+        if (!name.compare(n, Qt::CaseInsensitive))
+            return true;
+    }
+    return false;
+}
+
+bluetoothdevicematcher::settingsRules bluetoothdevicematcher::settingsRules::fromSettings(const QSettings &settings) {
+    settingsRules s;
+    s.anyDevice =
+        settings.value(QZSettings::applewatch_fakedevice, QZSettings::default_applewatch_fakedevice).toBool() ||
+        settings.value(QZSettings::fakedevice_elliptical, QZSettings::default_fakedevice_elliptical).toBool() ||
+        settings.value(QZSettings::fakedevice_rower, QZSettings::default_fakedevice_rower).toBool() ||
+        settings.value(QZSettings::fakedevice_treadmill, QZSettings::default_fakedevice_treadmill).toBool() ||
+        !settings.value(QZSettings::proformtdf4ip, QZSettings::default_proformtdf4ip).toString().isEmpty() ||
+        !settings.value(QZSettings::proformtdf1ip, QZSettings::default_proformtdf1ip).toString().isEmpty() ||
+#ifndef Q_OS_IOS
+        !settings.value(QZSettings::computrainer_serialport, QZSettings::default_computrainer_serialport)
+             .toString()
+             .isEmpty() ||
+        !settings.value(QZSettings::csafe_rower, QZSettings::default_csafe_rower).toString().isEmpty() ||
+#endif
+        !settings.value(QZSettings::proformtreadmillip, QZSettings::default_proformtreadmillip).toString().isEmpty() ||
+        !settings.value(QZSettings::nordictrack_2950_ip, QZSettings::default_nordictrack_2950_ip).toString().isEmpty() ||
+        !settings.value(QZSettings::tdf_10_ip, QZSettings::default_tdf_10_ip).toString().isEmpty();
+
+    if (settings.value(QZSettings::cadence_sensor_as_bike, QZSettings::default_cadence_sensor_as_bike).toBool())
+        s.prefixes.append(
+            settings.value(QZSettings::cadence_sensor_name, QZSettings::default_cadence_sensor_name).toString());
+    if (settings.value(QZSettings::power_sensor_as_bike, QZSettings::default_power_sensor_as_bike).toBool() ||
+        settings.value(QZSettings::power_sensor_as_treadmill, QZSettings::default_power_sensor_as_treadmill).toBool())
+        s.prefixes.append(
+            settings.value(QZSettings::power_sensor_name, QZSettings::default_power_sensor_name).toString());
+    if (settings.value(QZSettings::ss2k_peloton, QZSettings::default_ss2k_peloton).toBool())
+        s.prefixesIgnoreCase.append(
+            settings.value(QZSettings::ftms_accessory_name, QZSettings::default_ftms_accessory_name).toString());
+    s.namesIgnoreCase.append(settings.value(QZSettings::ftms_treadmill, QZSettings::default_ftms_treadmill).toString());
+    s.namesIgnoreCase.append(settings.value(QZSettings::ftms_bike, QZSettings::default_ftms_bike).toString());
+    s.namesIgnoreCase.append(settings.value(QZSettings::ftms_rower, QZSettings::default_ftms_rower).toString());
+    return s;
+}
@@ -0,0 +1,80 @@
+#ifndef BLUETOOTHDEVICEMATCHER_H
+#define BLUETOOTHDEVICEMATCHER_H
+
+#include <QBluetoothDeviceInfo>
+#include <QHash>
+#include <QSettings>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief Pre-selection of the advertisements for bluetooth::deviceDiscovered.
+ * Every bluetooth name recognised by the discovery chain is declared once in the table of rules(), compiled on first
+ * use into a trie over the upper case name, with the edges in a hash index. isCandidate() walks the name once and
+ * only the devices it accepts go through the chain, which keeps the last word: settings, name lengths, exclusions
+ * and precedence are still evaluated there. A name missing from the table is never connected, so every name added
+ * to the chain must be added to rules() too; BluetoothDeviceMatcherBenchmark.TestRulesMatchChain checks they agree.
+ */
+class bluetoothdevicematcher {
+  public:
+    /**
+     * @brief Indicates how a bluetooth device name is compared to a rule.
+     */
+    enum comparison { StartsWith, StartsWithIgnoreCase, ExactIgnoreCase, ContainsIgnoreCase };
+
+    struct rule {
+        const char *name;
+        comparison cmp;
+    };
+
+    /**
+     * @brief The rules that depend on the settings: names entered by the user and devices configured without a
+     * bluetooth name at all.
+     */
+    struct settingsRules {
+        /**
+         * @brief A device that doesn't depend on the bluetooth name is enabled (fake devices, wifi, serial).
+         */
+        bool anyDevice = false;
+        QStringList prefixes;
+        QStringList prefixesIgnoreCase;
+        QStringList namesIgnoreCase;
+
+        /**
+         * @brief Reads the rules from the settings, with the same conditions used by the discovery chain.
+         */
+        static settingsRules fromSettings(const QSettings &settings);
+    };
+
+    /**
+     * @brief The bluetooth names recognised by bluetooth::deviceDiscovered.
+     */
+    static const QVector<rule> &rules();
+
+    /**
+     * @brief The index in rules() of a rule matching the name specified, -1 if none.
+     */
+    static int match(const QString &name);
+
+    /**
+     * @brief Indicates if the device may be recognised by the discovery chain with the settings specified.
+     */
+    static bool isCandidate(const QBluetoothDeviceInfo &device, const settingsRules &settings);
+    static bool isCandidate(const QString &name, const settingsRules &settings);
+
+  private:
+    struct index {
+        // edges of the trie: (node << 16) | upper case character -> child node, the root is 0
+        QHash<quint64, int> edges;
+        // rules ending at each node
+        QVector<QVector<int>> terminal;
+        // the ContainsIgnoreCase rules, checked apart
+        QVector<int> contains;
+
+        index();
+    };
+    static const index &compiled();
+};
+
+#endif // BLUETOOTHDEVICEMATCHER_H
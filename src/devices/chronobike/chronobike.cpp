@@ -154,7 +154,7 @@ void chronobike::characteristicChanged(const QLowEnergyCharacteristic &character
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     if (watts())
         KCal +=
@@ -58,18 +58,25 @@ const static uint8_t rrc_command[56] = {
  * ---------------------------------------------------------------------- */
 Computrainer::Computrainer(QObject *parent, QString devname) : QThread(parent) {
 
-    devicePower = deviceHeartRate = deviceCadence = deviceSpeed = deviceRRC = 0.00;
-    for (int i = 0; i < 24; spinScan[i++] = 0)
-        ;
-    mode = DEFAULT_MODE;
-    load = DEFAULT_LOAD;
-    gradient = DEFAULT_GRADIENT;
-    deviceCalibrated = false;
-    deviceHRConnected = false;
-    deviceCADConnected = false;
+    cttelemetry t;
+    memset(&t, 0, sizeof(t));
+    telemetry.store(t);
+    memset(spinScan, 0, sizeof(spinScan));
+    control.store({DEFAULT_MODE, DEFAULT_LOAD, DEFAULT_GRADIENT, 0});
+    deviceButtons = 0;
     setDevice(devname);
     deviceStatus = 0;
     this->parent = parent;
+    clock.start();
+
+#ifdef CT_POLL
+    if (pipe(wakePipe) == -1) {
+        wakePipe[0] = wakePipe[1] = -1;
+    } else {
+        fcntl(wakePipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(wakePipe[1], F_SETFL, O_NONBLOCK);
+    }
+#endif
 
     /* 56 byte control sequence, composed of 8 command packets
      * where the last packet sets the load. The first byte
@@ -81,10 +88,19 @@ Computrainer::Computrainer(QObject *parent, QString devname) : QThread(parent) {
     memcpy(SS_Command, ss_command, 56);
 }
 
-Computrainer::~Computrainer() {}
+Computrainer::~Computrainer() {
+#ifdef CT_POLL
+    if (wakePipe[0] != -1) {
+        close(wakePipe[0]);
+        close(wakePipe[1]);
+    }
+#endif
+}
 
 /* ----------------------------------------------------------------------
  * SET
+ *
+ * called by the GUI thread only: it is the one writer of control
  * ---------------------------------------------------------------------- */
 void Computrainer::setDevice(QString devname) {
     // if not null, replace existing if set, otherwise set
@@ -92,111 +108,83 @@ void Computrainer::setDevice(QString devname) {
 }
 
 void Computrainer::setMode(int mode, double load, double gradient) {
-    pvars.lock();
-    this->mode = mode;
-    this->load = load;
-    this->gradient = gradient;
-    pvars.unlock();
+    control.store({mode, load, gradient, clock.nsecsElapsed()});
+    wake();
 }
 
 void Computrainer::setLoad(double load) {
-    pvars.lock();
     if (load > 1500)
         load = 1500;
     if (load < 50)
         load = 50;
-    this->load = load;
-    pvars.unlock();
+    ctcontrol c = control.load();
+    if (c.load == load)
+        return;
+    c.load = load;
+    c.issued = clock.nsecsElapsed();
+    control.store(c);
+    wake();
 }
 
 void Computrainer::setGradient(double gradient) {
-    pvars.lock();
-    this->gradient = gradient;
-    pvars.unlock();
+    ctcontrol c = control.load();
+    if (c.gradient == gradient)
+        return;
+    c.gradient = gradient;
+    c.issued = clock.nsecsElapsed();
+    control.store(c);
+    wake();
+}
+
+void Computrainer::wake() {
+#ifdef CT_POLL
+    // a byte is enough, a full pipe already wakes it up
+    const char b = 0;
+    if (wakePipe[1] != -1 && write(wakePipe[1], &b, 1) == -1 && errno != EAGAIN)
+        qDebug() << "Computrainer: wake failed" << errno;
+#endif
 }
 
 /* ----------------------------------------------------------------------
  * GET
  * ---------------------------------------------------------------------- */
-bool Computrainer::isHRConnected() {
-    bool tmp;
-    pvars.lock();
-    tmp = deviceHRConnected;
-    pvars.unlock();
-
-    return tmp;
-}
-
-bool Computrainer::isCADConnected() {
-    bool tmp;
-    pvars.lock();
-    tmp = deviceCADConnected;
-    pvars.unlock();
-
-    return tmp;
-}
+bool Computrainer::isHRConnected() { return telemetry.load().hrConnected; }
 
-bool Computrainer::isCalibrated() {
-    bool tmp;
-    pvars.lock();
-    tmp = deviceCalibrated;
-    pvars.unlock();
+bool Computrainer::isCADConnected() { return telemetry.load().cadConnected; }
 
-    return tmp;
-}
+bool Computrainer::isCalibrated() { return telemetry.load().calibrated; }
 
 void Computrainer::getTelemetry(double &power, double &heartrate, double &cadence, double &speed, double &RRC,
                                 bool &calibration, int &buttons, uint8_t *ss, int &status) {
 
-    pvars.lock();
-    power = devicePower;
-    heartrate = deviceHeartRate;
-    cadence = deviceCadence;
-    speed = deviceSpeed;
-    RRC = deviceRRC;
-    calibration = deviceCalibrated;
-    buttons = deviceButtons;
+    const cttelemetry t = telemetry.load();
+    power = t.power;
+    heartrate = t.heartRate;
+    cadence = t.cadence;
+    speed = t.speed;
+    RRC = t.RRC;
+    calibration = t.calibrated;
     status = deviceStatus;
-    memcpy((void *)ss, (void *)spinScan, 24);
+    memcpy((void *)ss, (void *)t.spinScan, 24);
 
     // work around to ensure controller doesn't miss button press.
     // The run thread will only set the button bits, they don't get
     // reset until the ui reads the device state
     //  Borrowed from: Fortius.cpp
-    deviceButtons = 0;
-    pvars.unlock();
+    buttons = deviceButtons.exchange(0);
 }
 
 void Computrainer::getSpinScan(double spinData[]) {
-    pvars.lock();
-    for (int i = 0; i < 24; spinData[i] = this->spinScan[i])
-        ;
-    pvars.unlock();
+    const cttelemetry t = telemetry.load();
+    for (int i = 0; i < 24; i++)
+        spinData[i] = t.spinScan[i];
 }
 
-int Computrainer::getMode() {
-    int tmp;
-    pvars.lock();
-    tmp = mode;
-    pvars.unlock();
-    return tmp;
-}
+int Computrainer::getMode() { return control.load().mode; }
 
-double Computrainer::getLoad() {
-    double tmp;
-    pvars.lock();
-    tmp = load;
-    pvars.unlock();
-    return tmp;
-}
+double Computrainer::getLoad() { return control.load().load; }
 
-double Computrainer::getGradient() {
-    double tmp;
-    pvars.lock();
-    tmp = gradient;
-    pvars.unlock();
-    return tmp;
-}
+double Computrainer::getGradient() { return control.load().gradient; }
 
 /*----------------------------------------------------------------------
  * COMPUTRAINER PROTOCOL DECODE/ENCODE ROUTINES
@@ -388,15 +376,12 @@ int Computrainer::restart() {
     int status;
 
     // get current status
-    pvars.lock();
     status = this->deviceStatus;
-    pvars.unlock();
     // what state are we in anyway?
     if (status & CT_RUNNING && status & CT_PAUSED) {
         status &= ~CT_PAUSED;
-        pvars.lock();
         this->deviceStatus = status;
-        pvars.unlock();
+        wake();
         return 0; // ok its running again!
     }
     return 2;
@@ -404,9 +389,8 @@ int Computrainer::restart() {
 
 int Computrainer::stop() {
     // what state are we in anyway?
-    pvars.lock();
     deviceStatus = 0; // Terminate it!
-    pvars.unlock();
+    wake();
     return 0;
 }
 
@@ -414,9 +398,7 @@ int Computrainer::pause() {
     int status;
 
     // get current status
-    pvars.lock();
     status = this->deviceStatus;
-    pvars.unlock();
 
     if (status & CT_PAUSED)
         return 2; // already paused you muppet!
@@ -426,9 +408,8 @@ int Computrainer::pause() {
 
         // ok we're running and not paused so lets pause
         status |= CT_PAUSED;
-        pvars.lock();
         this->deviceStatus = status;
-        pvars.unlock();
+        wake();
 
         return 0;
     }
@@ -456,45 +437,33 @@ void Computrainer::run() {
     int ss1, ss2, ss3, buttons, type, value8, value12;
 
     // newly read values - compared against cached values
-    int newmode;
-    double newload, newgradient;
     double newspeed, newRRC;
     bool newhrconnected, newcadconnected;
     bool isDeviceOpen = false;
+    bool changed;
+    int rc;
 
     // Cached current values
     // when new values are received from the device
-    // if they differ from current values we update
+    // if they differ from current values we publish them
     // otherwise do nothing
-    int curmode, curstatus;
-    double curload, curgradient;
-    double curPower;      // current output power in Watts
-    double curHeartRate;  // current heartrate in BPM
-    double curCadence;    // current cadence in RPM
-    double curSpeed;      // current speed in KPH
-    double curRRC;        // calibrated Rolling Resistance
-    bool curhrconnected;  // is HR sensor connected?
-    bool curcadconnected; // is CAD sensor connected?
-    int curButtons;       // Button status
+    cttelemetry cur;
+    ctcontrol curcontrol;
+    quint32 controlVersion;
+    int curstatus;
+
+    // the load set last, until the power measured reaches it
+    double pendingLoad = 0;
+    qint64 pendingSince = 0;
 
     // initialise local cache & main vars
-    pvars.lock();
     this->deviceStatus = CT_RUNNING;
-    curmode = this->mode;
-    curload = this->load;
-    curgradient = this->gradient;
-    curPower = this->devicePower = 0;
-    curHeartRate = this->deviceHeartRate = 0;
-    curCadence = this->deviceCadence = 0;
-    curSpeed = this->deviceSpeed = 0;
-    curButtons = this->deviceButtons = 0;
-    curRRC = this->deviceRRC = 0;
-    this->deviceCalibrated = false;
-    curhrconnected = false;
-    this->deviceHRConnected = false;
-    curcadconnected = false;
-    this->deviceCADConnected = false;
-    pvars.unlock();
+    controlVersion = control.version();
+    curcontrol = control.load();
+    memset(&cur, 0, sizeof(cur));
+    memset(spinScan, 0, sizeof(spinScan));
+    telemetry.store(cur);
+    this->deviceButtons = 0;
 
     // open the device
     int o = openPort();
@@ -507,8 +476,8 @@ void Computrainer::run() {
     }
 
     // send first command to get computrainer ready
-    prepareCommand(curmode, curmode == CT_ERGOMODE ? curload : curgradient);
-    if (sendCommand(curmode) == -1) {
+    prepareCommand(curcontrol.mode, curcontrol.mode == CT_ERGOMODE ? curcontrol.load : curcontrol.gradient);
+    if (sendCommand(curcontrol.mode) == -1) {
         // send failed - ouch!
         closePort(); // need to release that file handle!!
         quit(4);
@@ -519,39 +488,41 @@ void Computrainer::run() {
 
         if (isDeviceOpen == true) {
 
-            if (readMessage() > 0) {
+            if ((rc = readMessage()) > 0) {
 
                 //----------------------------------------------------------------
                 // UPDATE BASIC TELEMETRY (HR, CAD, SPD et al)
                 //----------------------------------------------------------------
 
                 unpackTelemetry(ss1, ss2, ss3, buttons, type, value8, value12);
+                changed = false;
 
                 switch (type) {
                 case CT_HEARTRATE:
-                    if (value8 != curHeartRate) {
-                        curHeartRate = value8;
-                        pvars.lock();
-                        this->deviceHeartRate = curHeartRate;
-                        pvars.unlock();
+                    if (value8 != cur.heartRate) {
+                        cur.heartRate = value8;
+                        changed = true;
                     }
                     break;
 
                 case CT_POWER:
-                    if (value12 != curPower) {
-                        curPower = value12;
-                        pvars.lock();
-                        this->devicePower = curPower;
-                        pvars.unlock();
+                    if (value12 != cur.power) {
+                        cur.power = value12;
+                        changed = true;
+                    }
+
+                    // is the load reached?
+                    if (pendingLoad > 0 &&
+                        qAbs(cur.power - pendingLoad) <= qMax(5.0, pendingLoad * CT_LOAD_TOLERANCE / 100.0)) {
+                        latency.record((clock.nsecsElapsed() - pendingSince) / 1000);
+                        pendingLoad = 0;
                     }
                     break;
 
                 case CT_CADENCE:
-                    if (value8 != curCadence) {
-                        curCadence = value8;
-                        pvars.lock();
-                        this->deviceCadence = curCadence;
-                        pvars.unlock();
+                    if (value8 != cur.cadence) {
+                        cur.cadence = value8;
+                        changed = true;
                     }
                     break;
 
@@ -561,10 +532,9 @@ void Computrainer::run() {
                     value12 /= 10; // it seems that compcs takes off 10% ????
                     newspeed = value12;
                     newspeed /= 1000;
-                    if (newspeed != curSpeed) {
-                        pvars.lock();
-                        this->deviceSpeed = curSpeed = newspeed;
-                        pvars.unlock();
+                    if (newspeed != cur.speed) {
+                        cur.speed = newspeed;
+                        changed = true;
                     }
                     break;
 
@@ -573,10 +543,9 @@ void Computrainer::run() {
                     newRRC = value12 & ~2048; // only use 11bits
                     newRRC /= 256;
 
-                    if (newRRC != curRRC) {
-                        pvars.lock();
-                        this->deviceRRC = curRRC = newRRC;
-                        pvars.unlock();
+                    if (newRRC != cur.RRC) {
+                        cur.RRC = newRRC;
+                        changed = true;
                     }
                     break;
 
@@ -584,11 +553,10 @@ void Computrainer::run() {
                     newcadconnected = value12 & 2048 ? true : false;
                     newhrconnected = value12 & 1024 ? true : false;
 
-                    if (newhrconnected != curhrconnected || newcadconnected != curcadconnected) {
-                        pvars.lock();
-                        this->deviceHRConnected = curhrconnected = newhrconnected;
-                        this->deviceCADConnected = curcadconnected = newcadconnected;
-                        pvars.unlock();
+                    if (newhrconnected != cur.hrConnected || newcadconnected != cur.cadConnected) {
+                        cur.hrConnected = newhrconnected;
+                        cur.cadConnected = newcadconnected;
+                        changed = true;
                     }
                     break;
 
@@ -599,40 +567,43 @@ void Computrainer::run() {
                 //----------------------------------------------------------------
                 // UPDATE BUTTONS
                 //----------------------------------------------------------------
-                if (buttons != curButtons) {
+                if (buttons) {
                     // let the gui workout what the deal is with silly button values!
-                    pvars.lock();
                     this->deviceButtons |= buttons; // Borrowed from Fortius.cpp: workaround to ensure controller
                                                     // doesn't miss button pushes
-                    pvars.unlock();
                 }
 
                 //----------------------------------------------------------------
                 // UPDATE SSCAN
                 //----------------------------------------------------------------
-                /* not yet implemented */
+                if (memcmp(cur.spinScan, spinScan, sizeof(spinScan))) {
+                    memcpy(cur.spinScan, spinScan, sizeof(spinScan));
+                    changed = true;
+                }
 
-            } else {
+                if (changed)
+                    telemetry.store(cur);
+
+            } else if (rc < 0) {
                 // no data
                 // how long to sleep for ... mmm save CPU cycles vs
                 //                           data overflow ?
+                // with CT_POLL the read waited already, unless the port is gone
                 CTsleeper::msleep(10); // lets try a tenth of a second
             }
+            // 0: a control change woke the read up, send it
         }
 
         //----------------------------------------------------------------
         // LISTEN TO GUI CONTROL COMMANDS
         //----------------------------------------------------------------
-        pvars.lock();
         curstatus = this->deviceStatus;
-        newmode = this->mode;
-        newload = this->load;
-        curgradient = newgradient = this->gradient;
-        pvars.unlock();
+        const quint32 version = control.version();
 
         /* time to shut up shop */
         if (!(curstatus & CT_RUNNING)) {
             qDebug() << "time to shut up shop";
+            qDebug() << "Computrainer: load latency" << latency.toString();
             // time to stop!
             closePort(); // need to release that file handle!!
             quit(0);
@@ -643,6 +614,7 @@ void Computrainer::run() {
             qDebug() << "(curstatus & CT_PAUSED) && isDeviceOpen == true";
             closePort();
             isDeviceOpen = false;
+            pendingLoad = 0;
 
         } else if (!(curstatus & CT_PAUSED) && (curstatus & CT_RUNNING) && isDeviceOpen == false) {
             qDebug() << "!(curstatus & CT_PAUSED) && (curstatus & CT_RUNNING) && isDeviceOpen == false";
@@ -654,27 +626,39 @@ void Computrainer::run() {
             isDeviceOpen = true;
 
             // send first command to get computrainer ready
-            prepareCommand(curmode, curmode == CT_ERGOMODE ? curload : curgradient);
-            if (sendCommand(curmode) == -1) {
+            prepareCommand(curcontrol.mode, curcontrol.mode == CT_ERGOMODE ? curcontrol.load : curcontrol.gradient);
+            if (sendCommand(curcontrol.mode) == -1) {
                 qDebug() << "quit(4)";
                 // send failed - ouch!
                 closePort(); // need to release that file handle!!
                 quit(4);
                 return; // couldn't write to the device
             }
+        } else if (isDeviceOpen == false) {
+            // paused, don't spin
+            CTsleeper::msleep(10);
         }
 
         //----------------------------------------------------------------
         // KEEP THE COMPUTRAINER CONTROL ALIVE
         //----------------------------------------------------------------
-        if (isDeviceOpen == true && !(cmds % 10)) {
+        // a control change is sent at once, not at the next keep alive
+        if (isDeviceOpen == true && (version != controlVersion || !(cmds % 10))) {
             cmds = 1;
-            curmode = newmode;
-            curload = newload;
-            curgradient = newgradient;
+            if (version != controlVersion) {
+                const ctcontrol newcontrol = control.load();
+                controlVersion = version;
+                if (newcontrol.mode != CT_ERGOMODE) {
+                    pendingLoad = 0;
+                } else if (newcontrol.mode != curcontrol.mode || newcontrol.load != curcontrol.load) {
+                    pendingLoad = newcontrol.load;
+                    pendingSince = newcontrol.issued;
+                }
+                curcontrol = newcontrol;
+            }
 
-            prepareCommand(curmode, curmode == CT_ERGOMODE ? curload : curgradient);
-            if (sendCommand(curmode) == -1) {
+            prepareCommand(curcontrol.mode, curcontrol.mode == CT_ERGOMODE ? curcontrol.load : curcontrol.gradient);
+            if (sendCommand(curcontrol.mode) == -1) {
                 qDebug() << "quit(4)";
                 // send failed - ouch!
                 closePort(); // need to release that file handle!!
@@ -685,6 +669,10 @@ void Computrainer::run() {
         } else {
             cmds++;
         }
+
+        // a load never reached isn't a latency
+        if (pendingLoad > 0 && clock.nsecsElapsed() - pendingSince > CT_LOAD_TIMEOUT * Q_INT64_C(1000000))
+            pendingLoad = 0;
     }
 }
 
@@ -730,18 +718,21 @@ int Computrainer::sendCommand(int mode) // writes a command to the device
 int Computrainer::readMessage() {
     int rc;
 
-    if ((rc = rawRead(buf, 7)) > 0 && (buf[6] & 128) == 0) {
+    // woken up before a message: 0, the caller sends the control change
+    if ((rc = rawRead(buf, 7, true)) > 0 && (buf[6] & 128) == 0) {
 
-        // we got something but need to sync
+        // we got something but need to sync: slide the
+        // 7 bytes along the stream until the last one
+        // has the sync bit
         while ((buf[6] & 128) == 0 && rc > 0) {
+            memmove(buf, buf + 1, 6);
             rc = rawRead(&buf[6], 1);
         }
+        if (rc > 0)
+            rc = 7;
 
-        // at this point we are synced, we may have a dodgy
-        // record but that is fair enough if we were out of
-        // sync anyway - the alternative is to keep going
-        // until we get a good message and that will
-        // lead to bigger issues (plus we may have a hw
+        // at this point we are synced, a message lost while
+        // out of sync is fair enough (we may have a hw
         // problem anyway).
         //
         // From experience, the need to sync is quite rare
@@ -927,10 +918,11 @@ int Computrainer::rawWrite(uint8_t *bytes, int size) // unix!!
     return rc;
 }
 
-int Computrainer::rawRead(uint8_t bytes[], int size) {
+int Computrainer::rawRead(uint8_t bytes[], int size, bool wakeable) {
     int rc = 0;
 
 #ifdef Q_OS_ANDROID
+    Q_UNUSED(wakeable);
 
     int fullLen = 0;
     cleanFrame = false;
@@ -984,10 +976,10 @@ int Computrainer::rawRead(uint8_t bytes[], int size) {
 
     return fullLen;
 #elif defined(WIN32)
-    Q_UNUSED(size);
+    Q_UNUSED(wakeable);
     // Readfile deals with timeouts and readyread issues
     DWORD cBytes;
-    rc = ReadFile(devicePort, bytes, 7, &cBytes, NULL);
+    rc = ReadFile(devicePort, bytes, size, &cBytes, NULL);
     if (rc)
         return (int)cBytes;
     else
@@ -995,30 +987,59 @@ int Computrainer::rawRead(uint8_t bytes[], int size) {
 
 #else
 
-    int timeout = 0, i = 0;
-    uint8_t byte;
-
-    // read one byte at a time sleeping when no data ready
-    // until we timeout waiting then return error
-    for (i = 0; i < size; i++) {
-        timeout = 0;
-        rc = 0;
-        while (rc == 0 && timeout < CT_READTIMEOUT) {
-            rc = read(devicePort, &byte, 1);
-            if (rc == -1)
-                return -1; // error!
-            else if (rc == 0) {
-                msleep(50); // sleep for 1/20th of a second
-                timeout += 50;
-            } else {
-                bytes[i] = byte;
-            }
+    // wait for the port with poll(), the wake pipe too if wakeable: a control change must not wait for the
+    // next message. Whatever is there is read at once, up to size
+    struct pollfd fds[2];
+    QElapsedTimer waiting;
+    int i = 0;
+
+    waiting.start();
+    while (i < size) {
+        const int left = CT_READTIMEOUT - (int)waiting.elapsed();
+        if (left <= 0)
+            return -1; // we timed out!
+
+        const int nfds = wakeable && i == 0 && wakePipe[0] != -1 ? 2 : 1;
+        fds[0].fd = devicePort;
+        fds[0].events = POLLIN;
+        fds[0].revents = 0;
+        fds[1].fd = wakePipe[0];
+        fds[1].events = POLLIN;
+        fds[1].revents = 0;
+        rc = ::poll(fds, nfds, left);
+        if (rc == -1) {
+            if (errno == EINTR)
+                continue;
+            return -1; // error!
         }
-        if (timeout >= CT_READTIMEOUT)
+        if (rc == 0)
             return -1; // we timed out!
+
+        if (nfds == 2 && (fds[1].revents & POLLIN)) {
+            char drain[16];
+            while (read(wakePipe[0], drain, sizeof(drain)) > 0)
+                ;
+            if (!(fds[0].revents & POLLIN))
+                return 0;
+        }
+        if (!(fds[0].revents & POLLIN)) {
+            if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL))
+                return -1; // error!
+            continue;
+        }
+
+        rc = read(devicePort, bytes + i, size - i);
+        if (rc == -1) {
+            if (errno == EINTR || errno == EAGAIN)
+                continue;
+            return -1; // error!
+        }
+        if (rc == 0)
+            return -1; // hung up
+        i += rc;
     }
 
-    qDebug() << i << QString::fromLocal8Bit((const char *)bytes, i);
+    qDebug() << i << QByteArray((const char *)bytes, i).toHex(' ');
 
     return i;
 
@@ -31,16 +31,21 @@
 #define _Computrainer_h 1
 
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
-#include <QMutex>
 #include <QString>
 #include <QThread>
+#include <atomic>
+
+#include "latencyhistogram.h"
+#include "seqlock.h"
 
 #ifdef WIN32
 #include <windows.h>
 
 #include <winbase.h>
 #else
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <termios.h> // unix!!
 #include <unistd.h>  // unix!!
@@ -64,10 +69,20 @@
 
 /* Some CT Microcontroller / Protocol Constants */
 
-/* read timeouts in microseconds */
+/* read timeouts in milliseconds */
 #define CT_READTIMEOUT 1000
 #define CT_WRITETIMEOUT 2000
 
+// the reads wait for the port with poll(), and a control change wakes them up
+#if !defined(WIN32) && !defined(Q_OS_ANDROID)
+#define CT_POLL 1
+#endif
+
+// a load is reached when the power measured is this close to it, in percent (5 watts at least)
+#define CT_LOAD_TOLERANCE 5
+// a load not reached in this time is not measured, in milliseconds
+#define CT_LOAD_TIMEOUT 10000
+
 // message type
 #define CT_SPEED 0x01
 #define CT_POWER 0x02
@@ -104,6 +119,27 @@
 #define DEFAULT_LOAD 100.00
 #define DEFAULT_GRADIENT 2.00
 
+// the telemetry, published by the run() thread
+struct cttelemetry {
+    double power;      // current output power in Watts
+    double heartRate;  // current heartrate in BPM
+    double cadence;    // current cadence in RPM
+    double speed;      // current speed in KPH
+    double RRC;        // calibrated Rolling Resistance
+    bool calibrated;   // is it calibrated?
+    bool hrConnected;  // HR jack is connected
+    bool cadConnected; // Cadence jack is connected
+    uint8_t spinScan[24];
+};
+
+// the control, published by the GUI thread
+struct ctcontrol {
+    int mode;
+    double load;
+    double gradient;
+    qint64 issued; // when load or gradient changed, ns on the clock of the Computrainer
+};
+
 class Computrainer : public QThread {
 
   public:
@@ -141,6 +177,9 @@ class Computrainer : public QThread {
     double getGradient();
     double getLoad();
 
+    // time from a load set in ERGOMODE to the power measured reaching it
+    const latencyhistogram &loadLatency() const { return latency; }
+
   private:
     void run() override; // called by start to kick off the CT comtrol thread
 
@@ -161,26 +200,25 @@ class Computrainer : public QThread {
     int readMessage();
     void unpackTelemetry(int &b1, int &b2, int &b3, int &buttons, int &type, int &value8, int &value12);
 
-    // Mutex for controlling accessing private data
-    QMutex pvars;
-
-    // INBOUND TELEMETRY - all volatile since it is updated by the run() thread
-    volatile double devicePower;      // current output power in Watts
-    volatile double deviceHeartRate;  // current heartrate in BPM
-    volatile double deviceCadence;    // current cadence in RPM
-    volatile double deviceSpeed;      // current speed in KPH
-    volatile double deviceRRC;        // calibrated Rolling Resistance
-    volatile bool deviceCalibrated;   // is it calibrated?
-    volatile uint8_t spinScan[24];    // SS values only in SS_MODE
-    volatile int deviceButtons;       // Button status
-    volatile bool deviceHRConnected;  // HR jack is connected
-    volatile bool deviceCADConnected; // Cadence jack is connected
-    volatile int deviceStatus;        // Device status running, paused, disconnected
-
-    // OUTBOUND COMMANDS - all volatile since it is updated by the GUI thread
-    volatile int mode;
-    volatile double load;
-    volatile double gradient;
+    // the GUI thread and the run() thread exchange the telemetry and the control without a lock: each one has a
+    // single writer and the reader always gets a whole copy
+    seqlock<cttelemetry> telemetry;
+    seqlock<ctcontrol> control;
+    std::atomic<int> deviceButtons; // Button status, set by the run() thread, reset when read
+    std::atomic<int> deviceStatus;  // Device status running, paused, disconnected
+
+    // SS values only in SS_MODE, run() thread only
+    uint8_t spinScan[24];
+
+    // the clock of issued and of the latencies
+    QElapsedTimer clock;
+    latencyhistogram latency;
+
+    // wakes the run() thread up waiting for the port, to send a control change at once
+    void wake();
+#ifdef CT_POLL
+    int wakePipe[2];
+#endif
 
     // i/o message holder
     uint8_t buf[7];
@@ -196,7 +234,7 @@ class Computrainer : public QThread {
 #endif
     // raw device utils
     int rawWrite(uint8_t *bytes, int size); // unix!!
-    int rawRead(uint8_t *bytes, int size);  // unix!!
+    int rawRead(uint8_t *bytes, int size, bool wakeable = false); // unix!! 0 if woken up before any byte
 
 #ifdef Q_OS_ANDROID
     QList<jbyte> bufRX;
@@ -36,6 +36,7 @@ class computrainerbike : public bike {
                      double bikeResistanceGain);
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool inclinationAvailableByHardware() override;
     bool connected() override;
@@ -43,7 +44,6 @@ class computrainerbike : public bike {
   private:
     resistance_t max_resistance = 100;
     resistance_t min_resistance = -20;
-    uint16_t wattsFromResistance(resistance_t resistance);
     double GetDistanceFromPacket(QByteArray packet);
     QTime GetElapsedFromPacket(QByteArray packet);
     void btinit();
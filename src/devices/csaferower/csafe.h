@@ -1,42 +1,246 @@
 #ifndef CSAFE_H
 #define CSAFE_H
 
-#include <QVariant>
+#include <QtGlobal>
+#include <array>
 
-#include <QByteArray>
+/**
+ * @brief The CSAFE commands of the Concept2 PM3/PM5 and how they are framed. The command table is built at compile
+ * time: a poll frame is encoded once into a fixed buffer and sent as is, a response is decoded into a csaferesponse
+ * without allocating.
+ */
+class csafe {
+  public:
+    enum command : quint8 {
+        // short commands
+        GETSTATUS,
+        RESET,
+        GOIDLE,
+        GOHAVEID,
+        GOINUSE,
+        GOFINISHED,
+        GOREADY,
+        BADID,
+        GETVERSION,
+        GETID,
+        GETUNITS,
+        GETSERIAL,
+        GETODOMETER,
+        GETERRORCODE,
+        GETTWORK,
+        GETHORIZONTAL,
+        GETCALORIES,
+        GETPROGRAM,
+        GETPACE,
+        GETCADENCE,
+        GETUSERINFO,
+        GETHRCUR,
+        GETPOWER,
+        // long commands
+        AUTOUPLOAD,
+        IDDIGITS,
+        SETTIME,
+        SETDATE,
+        SETTIMEOUT,
+        SETUSERCFG1,
+        SETTWORK,
+        SETHORIZONTAL,
+        SETCALORIES,
+        SETPROGRAM,
+        SETPOWER,
+        GETCAPS,
+        // PM3 specific short commands, wrapped in SETUSERCFG1
+        PM_GET_WORKOUTTYPE,
+        PM_GET_DRAGFACTOR,
+        PM_GET_STROKESTATE,
+        PM_GET_WORKTIME,
+        PM_GET_WORKDISTANCE,
+        PM_GET_ERRORVALUE,
+        PM_GET_WORKOUTSTATE,
+        PM_GET_WORKOUTINTERVALCOUNT,
+        PM_GET_INTERVALTYPE,
+        PM_GET_RESTTIME,
+        // PM3 specific long commands, wrapped in SETUSERCFG1
+        PM_SET_SPLITDURATION,
+        PM_GET_FORCEPLOTDATA,
+        PM_SET_SCREENERRORMODE,
+        PM_GET_HEARTBEATDATA,
+        COMMAND_COUNT
+    };
 
-#include <QList>
-#include <QObject>
-#include <QString>
-#include <stdexcept>
+    static constexpr int MAX_ARGS = 3;
+    static constexpr int MAX_VALUES = 17;
 
-#include <QBuffer>
-#include <QMap>
+    struct commandinfo {
+        quint8 id;
+        // id of the wrapper command, 0 if none
+        quint8 wrapper;
+        // bytes of each argument of a long command
+        quint8 argCount;
+        quint8 args[MAX_ARGS];
+        // bytes of each value of the response, negative for bytes read as they are (ASCII text, capabilities)
+        quint8 valueCount;
+        qint8 values[MAX_VALUES];
+    };
 
-class csafe {
-  private:
-    QVector<quint8> int2bytes(int numbytes, int integer);
-    int bytes2int(const QVector<quint8> &raw_bytes);
-    QString bytes2ascii(const QVector<quint8> &raw_bytes);
+    static constexpr commandinfo commands[COMMAND_COUNT] = {
+        {0x80, 0, 0, {}, 0, {}},
+        {0x81, 0, 0, {}, 0, {}},
+        {0x82, 0, 0, {}, 0, {}},
+        {0x83, 0, 0, {}, 0, {}},
+        {0x85, 0, 0, {}, 0, {}},
+        {0x86, 0, 0, {}, 0, {}},
+        {0x87, 0, 0, {}, 0, {}},
+        {0x88, 0, 0, {}, 0, {}},
+        {0x91, 0, 0, {}, 5, {1, 1, 1, 2, 2}},
+        {0x92, 0, 0, {}, 1, {-5}},
+        {0x93, 0, 0, {}, 1, {1}},
+        {0x94, 0, 0, {}, 1, {-9}},
+        {0x9B, 0, 0, {}, 2, {4, 1}},
+        {0x9C, 0, 0, {}, 1, {3}},
+        {0xA0, 0, 0, {}, 3, {1, 1, 1}},
+        {0xA1, 0, 0, {}, 2, {2, 1}},
+        {0xA3, 0, 0, {}, 1, {2}},
+        {0xA4, 0, 0, {}, 1, {1}},
+        {0xA6, 0, 0, {}, 2, {2, 1}},
+        {0xA7, 0, 0, {}, 2, {2, 1}},
+        {0xAB, 0, 0, {}, 4, {2, 1, 1, 1}},
+        {0xB0, 0, 0, {}, 1, {1}},
+        {0xB4, 0, 0, {}, 2, {2, 1}},
+        {0x01, 0, 1, {1}, 0, {}},
+        {0x10, 0, 1, {1}, 0, {}},
+        {0x11, 0, 3, {1, 1, 1}, 0, {}},
+        {0x12, 0, 3, {1, 1, 1}, 0, {}},
+        {0x13, 0, 1, {1}, 0, {}},
+        {0x1A, 0, 0, {}, 0, {}},
+        {0x20, 0, 3, {1, 1, 1}, 0, {}},
+        {0x21, 0, 2, {2, 1}, 0, {}},
+        {0x23, 0, 1, {2}, 0, {}},
+        {0x24, 0, 2, {1, 1}, 0, {}},
+        {0x34, 0, 2, {2, 1}, 0, {}},
+        {0x70, 0, 1, {1}, 1, {-11}},
+        {0x89, 0x1A, 0, {}, 1, {1}},
+        {0xC1, 0x1A, 0, {}, 1, {1}},
+        {0xBF, 0x1A, 0, {}, 1, {1}},
+        {0xA0, 0x1A, 0, {}, 2, {4, 1}},
+        {0xA3, 0x1A, 0, {}, 2, {4, 1}},
+        {0xC9, 0x1A, 0, {}, 1, {2}},
+        {0x8D, 0x1A, 0, {}, 1, {1}},
+        {0x9F, 0x1A, 0, {}, 1, {1}},
+        {0x8E, 0x1A, 0, {}, 1, {1}},
+        {0xCF, 0x1A, 0, {}, 1, {2}},
+        {0x05, 0x1A, 2, {1, 4}, 0, {}},
+        {0x6B, 0x1A, 1, {1}, 17, {1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}},
+        {0x27, 0x1A, 1, {1}, 0, {}},
+        {0x6C, 0x1A, 1, {1}, 17, {1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2}},
+    };
+
+    // unique frame flags
+    static constexpr quint8 EXTENDED_FRAME_START_FLAG = 0xF0;
+    static constexpr quint8 STANDARD_FRAME_START_FLAG = 0xF1;
+    static constexpr quint8 STOP_FRAME_FLAG = 0xF2;
+    static constexpr quint8 BYTE_STUFFING_FLAG = 0xF3;
 
-    // Unique Frame Flags
-    const int Extended_Frame_Start_Flag = 0xF0;
-    const int Standard_Frame_Start_Flag = 0xF1;
-    const int Stop_Frame_Flag = 0xF2;
-    const int Byte_Stuffing_Flag = 0xF3;
+    // the HID reports of the PM: report id and frame, padded to 21, 63 or 121 bytes
+    static constexpr int MAX_REPORT = 121;
 
-    // cmds['COMMAND_NAME'] = [0xCmd_Id, [Bytes, ...]]
-    QMap<QString, QList<QList<int>>> cmds;
-    QMap<int, QPair<QString, QList<int>>> resp;
+    /**
+     * @brief The bytes of the response to a command, the sum of the absolute values.
+     */
+    static constexpr int responseBytes(command c) {
+        int sum = 0;
+        for (int i = 0; i < commands[c].valueCount; i++)
+            sum += commands[c].values[i] < 0 ? -commands[c].values[i] : commands[c].values[i];
+        return sum;
+    }
 
-    QList<QList<int>> populateCmd(int First, QList<int> Second, int Third);
-    QList<QList<int>> populateCmd(int First, QList<int> Second);
+    /**
+     * @brief The command answering id in a response, inside wrapper (0 if none). COMMAND_COUNT if unknown.
+     */
+    static command fromResponse(quint8 wrapper, quint8 id) {
+        return (command)(wrapper == commands[SETUSERCFG1].id ? wrappedIds : ids)[id];
+    }
+
+    typedef std::array<quint8, 256> idtable;
+    static constexpr idtable buildIds(bool wrapped) {
+        idtable t = {};
+        for (int i = 0; i < 256; i++)
+            t[i] = COMMAND_COUNT;
+        for (int c = 0; c < COMMAND_COUNT; c++) {
+            if ((commands[c].wrapper != 0) == wrapped)
+                t[commands[c].id] = c;
+        }
+        return t;
+    }
+
+  private:
+    // the commands by id, built at compile time
+    static const idtable ids;
+    static const idtable wrappedIds;
+};
 
+/**
+ * @brief Builds a CSAFE frame: append the commands, then encode() the HID report into a buffer of the caller.
+ * Consecutive PM commands share one SETUSERCFG1 wrapper. Nothing is allocated, a frame can be encoded once and sent
+ * every poll.
+ */
+class csafeframe {
   public:
-    csafe();
-    QByteArray write(const QStringList &arguments);
-    QVector<quint8> check_message(QVector<quint8> message);
-    QVariantMap read(const QVector<quint8> &transmission);
+    csafeframe &add(csafe::command c, quint32 arg0 = 0, quint32 arg1 = 0, quint32 arg2 = 0);
+    void clear();
+
+    /**
+     * @brief Encode the report: report id, start flag, the commands byte stuffed, checksum, stop flag and padding.
+     * @return its size, 0 if it doesn't fit in capacity or in a report.
+     */
+    int encode(quint8 *out, int capacity) const;
+
+    /**
+     * @brief The longest response the commands can get, stuffing included.
+     */
+    int maxResponse() const { return responseLength; }
+
+  private:
+    void closeWrapper();
+
+    // the commands, before stuffing
+    quint8 message[csafe::MAX_REPORT];
+    int length = 0;
+    bool overflow = false;
+    // where the byte count of the open wrapper is, -1 if none
+    int wrapperCount = -1;
+    quint8 wrapper = 0;
+    // start and stop flags and status
+    int responseLength = 3;
+};
+
+/**
+ * @brief A decoded response: the status, and where the values of each command answered are in data.
+ */
+struct csaferesponse {
+    quint8 status;
+    // bit c is set if command c was answered
+    quint64 received;
+    quint8 offset[csafe::COMMAND_COUNT];
+    quint8 length[csafe::COMMAND_COUNT];
+    // the unstuffed frame
+    quint8 data[csafe::MAX_REPORT];
+
+    bool has(csafe::command c) const { return received & (Q_UINT64_C(1) << c); }
+    /**
+     * @brief Value index of the response to c, little endian, 0 if the response is shorter or the value isn't a number.
+     */
+    quint32 value(csafe::command c, int index = 0) const;
+    /**
+     * @brief The bytes of value index of the response to c, in out (not terminated), and how many they are.
+     */
+    int text(csafe::command c, int index, char *out, int capacity) const;
+
+    /**
+     * @brief Decode a report (report id, then the frame), length bytes.
+     * @return false without a complete frame with a good checksum.
+     */
+    static bool read(const quint8 *report, int length, csaferesponse *response);
 };
 
 #endif // CSAFE_H
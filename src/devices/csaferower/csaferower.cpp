@@ -68,49 +68,55 @@ csaferowerThread::csaferowerThread() {}
 
 void csaferowerThread::run() {
     QSettings settings;
-    /*devicePort =
-        settings.value(QZSettings::computrainer_serialport, QZSettings::default_computrainer_serialport).toString();*/
+    deviceFilename = settings.value(QZSettings::csafe_rower, QZSettings::default_csafe_rower).toString();
 
     openPort();
-    csafe *aa = new csafe();
+
+    // the poll never changes: encoded once, sent as is
+    csafeframe poll;
+    poll.add(csafe::PM_GET_WORKTIME)
+        .add(csafe::PM_GET_WORKDISTANCE)
+        .add(csafe::GETCADENCE)
+        .add(csafe::GETPOWER)
+        .add(csafe::GETCALORIES)
+        .add(csafe::GETHRCUR);
+    uint8_t request[csafe::MAX_REPORT];
+    const int requestLength = poll.encode(request, sizeof(request));
+    qDebug() << " >> " << QByteArray::fromRawData((const char *)request, requestLength).toHex(' ');
+
+    uint8_t rx[csafe::MAX_REPORT];
+    csaferesponse response;
+    QElapsedTimer cycle;
     while (1) {
-        QStringList command;
-        command << "CSAFE_PM_GET_WORKTIME";
-        command << "CSAFE_PM_GET_WORKDISTANCE";
-        command << "CSAFE_GETCADENCE_CMD";
-        command << "CSAFE_GETPOWER_CMD";
-        command << "CSAFE_GETCALORIES_CMD";
-        command << "CSAFE_GETHRCUR_CMD";
-        QByteArray ret = aa->write(command);
-
-        qDebug() << " >> " << ret.toHex(' ');
-        rawWrite((uint8_t *)ret.data(), ret.length());
-        static uint8_t rx[100];
-        rawRead(rx, 100);
-        qDebug() << " << " << QByteArray::fromRawData((const char *)rx, 64).toHex(' ');
-
-        QVector<quint8> v;
-        for (int i = 0; i < 64; i++)
-            v.append(rx[i]);
-        QVariantMap f = aa->read(v);
-        if (f["CSAFE_GETCADENCE_CMD"].isValid()) {
-            emit onCadence(f["CSAFE_GETCADENCE_CMD"].value<QVariantList>()[0].toDouble());
-        }
-        if (f["CSAFE_GETPOWER_CMD"].isValid()) {
-            emit onPower(f["CSAFE_GETPOWER_CMD"].value<QVariantList>()[0].toDouble());
-        }
-        if (f["CSAFE_GETHRCUR_CMD"].isValid()) {
-            emit onHeart(f["CSAFE_GETHRCUR_CMD"].value<QVariantList>()[0].toDouble());
+        cycle.start();
+        rawWrite(request, requestLength);
+        const int rxLength = rawRead(rx, sizeof(rx));
+        if (rxLength > 0) {
+            qDebug() << " << " << QByteArray::fromRawData((const char *)rx, rxLength).toHex(' ');
         }
-        if (f["CSAFE_GETCALORIES_CMD"].isValid()) {
-            emit onCalories(f["CSAFE_GETCALORIES_CMD"].value<QVariantList>()[0].toDouble());
-        }
-        if (f["CSAFE_PM_GET_WORKDISTANCE"].isValid()) {
-            emit onDistance(f["CSAFE_PM_GET_WORKDISTANCE"].value<QVariantList>()[0].toDouble());
+
+        if (rxLength > 0 && csaferesponse::read(rx, rxLength, &response)) {
+            if (response.has(csafe::GETCADENCE)) {
+                emit onCadence(response.value(csafe::GETCADENCE));
+            }
+            if (response.has(csafe::GETPOWER)) {
+                emit onPower(response.value(csafe::GETPOWER));
+            }
+            if (response.has(csafe::GETHRCUR)) {
+                emit onHeart(response.value(csafe::GETHRCUR));
+            }
+            if (response.has(csafe::GETCALORIES)) {
+                emit onCalories(response.value(csafe::GETCALORIES));
+            }
+            if (response.has(csafe::PM_GET_WORKDISTANCE)) {
+                emit onDistance(response.value(csafe::PM_GET_WORKDISTANCE));
+            }
         }
 
-        memset(rx, 0x00, sizeof(rx));
-        QThread::msleep(50);
+        // the exchange is part of the period
+        const qint64 left = CSAFE_POLL_INTERVAL - cycle.elapsed();
+        if (left > 0)
+            QThread::msleep(left);
     }
     closePort();
 }
@@ -245,11 +251,13 @@ int csaferowerThread::rawRead(uint8_t bytes[], int size) {
         if (len > 0) {
             jbyteArray d = dd.object<jbyteArray>();
             jbyte *b = env->GetByteArrayElements(d, 0);
-            for (int i = 0; i < len; i++) {
+            for (int i = 0; i < len && i < size; i++) {
                 bytes[i] = b[i];
             }
             qDebug() << len << QByteArray((const char *)b, len).toHex(' ');
         }
+        if (len == 0)
+            msleep(1);
     } while (len == 0 && start + 2000 > QDateTime::currentMSecsSinceEpoch());
 
     return len;
@@ -265,27 +273,30 @@ int csaferowerThread::rawRead(uint8_t bytes[], int size) {
 
 #else
 
-    int timeout = 0, i = 0;
-    uint8_t byte;
-
-    // read one byte at a time sleeping when no data ready
-    // until we timeout waiting then return error
-    for (i = 0; i < size; i++) {
-        timeout = 0;
-        rc = 0;
-        while (rc == 0 && timeout < CT_READTIMEOUT) {
-            rc = read(devicePort, &byte, 1);
-            if (rc == -1)
-                return -1; // error!
-            else if (rc == 0) {
-                msleep(50); // sleep for 1/20th of a second
-                timeout += 50;
-            } else {
-                bytes[i] = byte;
-            }
-        }
-        if (timeout >= CT_READTIMEOUT)
+    // wait for the bytes with poll() and stop at the end of the frame, instead of sleeping between single bytes
+    QElapsedTimer timer;
+    timer.start();
+    int i = 0;
+    bool complete = false;
+    while (i < size && !complete) {
+        const int left = CT_READTIMEOUT - (int)timer.elapsed();
+        if (left <= 0)
             return -1; // we timed out!
+        struct pollfd fd = {devicePort, POLLIN, 0};
+        rc = ::poll(&fd, 1, left);
+        if (rc == -1 && errno == EINTR)
+            continue;
+        if (rc <= 0)
+            return -1; // error or timeout
+        rc = read(devicePort, bytes + i, size - i);
+        if (rc == -1 && (errno == EAGAIN || errno == EINTR))
+            continue;
+        if (rc <= 0)
+            return -1; // error!
+        // report id, start flag, then the frame up to the stop flag
+        for (int k = qMax(i, 2); k < i + rc && !complete; k++)
+            complete = bytes[k] == csafe::STOP_FRAME_FLAG;
+        i += rc;
     }
 
     qDebug() << i << QString::fromLocal8Bit((const char *)bytes, i);
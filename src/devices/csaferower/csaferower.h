@@ -31,6 +31,7 @@
 #include "virtualdevices/virtualbike.h"
 #include "virtualdevices/virtualrower.h"
 #include <QDebug>
+#include <QElapsedTimer>
 #include <QFile>
 #include <QMutex>
 #include <QSettings>
@@ -41,6 +42,7 @@
 
 #include <winbase.h>
 #else
+#include <poll.h>
 #include <sys/ioctl.h>
 #include <termios.h> // unix!!
 #include <unistd.h>  // unix!!
@@ -70,6 +72,9 @@
 #define CT_READTIMEOUT 1000
 #define CT_WRITETIMEOUT 2000
 
+/* ms from a poll to the next one, the exchange included: 40 Hz, for the stroke phase */
+#define CSAFE_POLL_INTERVAL 25
+
 class csaferowerThread : public QThread {
     Q_OBJECT
 
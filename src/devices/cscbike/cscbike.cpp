@@ -229,7 +229,7 @@ void cscbike::characteristicChanged(const QLowEnergyCharacteristic &characterist
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
 
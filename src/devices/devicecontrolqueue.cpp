@@ -0,0 +1,34 @@
+#include "devices/devicecontrolqueue.h"
+
+bool devicecontrolqueue::push(const devicecommand &command) {
+    QMutexLocker locker(&mutex);
+    for (int i = 0; i < count; i++) {
+        if (pending[i].kind == command.kind) {
+            pending[i] = command;
+            supersededCount++;
+            return false;
+        }
+    }
+    // one slot for each kind, never full
+    pending[count++] = command;
+    return count == 1;
+}
+
+int devicecontrolqueue::take(devicecommand *out) {
+    QMutexLocker locker(&mutex);
+    const int n = count;
+    for (int i = 0; i < n; i++)
+        out[i] = pending[i];
+    count = 0;
+    return n;
+}
+
+int devicecontrolqueue::size() const {
+    QMutexLocker locker(&mutex);
+    return count;
+}
+
+quint64 devicecontrolqueue::superseded() const {
+    QMutexLocker locker(&mutex);
+    return supersededCount;
+}
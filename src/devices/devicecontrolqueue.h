@@ -0,0 +1,63 @@
+#ifndef DEVICECONTROLQUEUE_H
+#define DEVICECONTROLQUEUE_H
+
+#include <QMutex>
+#include <QtGlobal>
+
+/**
+ * @brief A target for a device: a resistance level, a power or an inclination.
+ */
+struct devicecommand {
+    enum kind_t : quint8 { RESISTANCE, POWER, INCLINATION, KINDS };
+
+    kind_t kind = RESISTANCE;
+    double value = 0;      // the level, the watts or the grade
+    double percentage = 0; // the percentage of an inclination
+
+    static devicecommand resistance(double level) { return devicecommand(RESISTANCE, level); }
+    static devicecommand power(double watts) { return devicecommand(POWER, watts); }
+    static devicecommand inclination(double grade, double percentage) {
+        return devicecommand(INCLINATION, grade, percentage);
+    }
+
+    devicecommand() {}
+
+  private:
+    devicecommand(kind_t kind, double value, double percentage = 0)
+        : kind(kind), value(value), percentage(percentage) {}
+};
+
+/**
+ * @brief The commands sent to a device from other threads, until the thread of the device takes them. Bounded to one
+ * command of each kind: a trainer only needs the last target, so a new command replaces the pending one of its kind,
+ * keeping its place in the queue. The producers never wait for the device.
+ */
+class devicecontrolqueue {
+  public:
+    /**
+     * @brief Queue a command.
+     * @return true if the queue was empty, so the consumer has to be woken up.
+     */
+    bool push(const devicecommand &command);
+
+    /**
+     * @brief Moves the pending commands, in order, to out (room for devicecommand::KINDS).
+     * @return the number of commands.
+     */
+    int take(devicecommand *out);
+
+    int size() const;
+
+    /**
+     * @brief The commands replaced by a newer one of their kind before the device took them.
+     */
+    quint64 superseded() const;
+
+  private:
+    mutable QMutex mutex;
+    devicecommand pending[devicecommand::KINDS];
+    int count = 0;
+    quint64 supersededCount = 0;
+};
+
+#endif // DEVICECONTROLQUEUE_H
@@ -0,0 +1,38 @@
+#ifndef DEVICETELEMETRY_H
+#define DEVICETELEMETRY_H
+
+#include <QtGlobal>
+#include <cmath>
+
+/**
+ * @brief The live values of a device, published whole by the thread of the device every time it updates its metrics.
+ * Plain values only, so the GUI, the templates and the recorders copy it through a seqlock instead of reading the
+ * metrics the device thread is writing.
+ */
+struct devicetelemetry {
+    /**
+     * @brief When the values were published, metric::monotonicNs(); 0 before the first update of the device.
+     */
+    qint64 publishedNs = 0;
+    quint32 deviceType = 0;
+    bool connected = false;
+    bool paused = false;
+    double speed = 0;       // km/h
+    double inclination = 0; // %
+    double heart = 0;
+    double cadence = 0;
+    double watts = 0;
+    double resistance = 0;
+    double pelotonResistance = 0;
+    double distance = 0; // km
+    double calories = 0;
+    double elevationGain = 0; // m
+    double elapsed = 0;       // s
+    double moving = 0;        // s
+    // NaN without a position
+    double latitude = NAN;
+    double longitude = NAN;
+    double altitude = NAN;
+};
+
+#endif // DEVICETELEMETRY_H
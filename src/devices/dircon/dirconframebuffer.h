@@ -0,0 +1,57 @@
+#ifndef DIRCONFRAMEBUFFER_H
+#define DIRCONFRAMEBUFFER_H
+
+#include <QByteArray>
+#include <cstring>
+
+/**
+ * @brief The bytes received from a Dircon client and not parsed yet.
+ * The socket reads straight into the free space at the tail and the frames are parsed in place at the head:
+ * consuming a frame only moves the head, and the pending bytes are moved back to the front only when the tail
+ * runs out of space, instead of reslicing the whole buffer for every frame.
+ */
+class DirconFrameBuffer {
+  public:
+    explicit DirconFrameBuffer(int capacity = 1024) { buf.resize(capacity); }
+
+    const char *data() const { return buf.constData() + head; }
+    int size() const { return tail - head; }
+    bool isEmpty() const { return tail == head; }
+
+    /**
+     * @brief Room for len more bytes at the tail; commit() the ones actually written.
+     */
+    char *reserve(int len) {
+        if (tail + len > buf.size()) {
+            if (head > 0) {
+                memmove(buf.data(), buf.constData() + head, tail - head);
+                tail -= head;
+                head = 0;
+            }
+            if (tail + len > buf.size())
+                buf.resize(qMax(buf.size() * 2, tail + len));
+        }
+        return buf.data() + tail;
+    }
+    void commit(int len) { tail += len; }
+
+    void append(const char *bytes, int len) {
+        memcpy(reserve(len), bytes, len);
+        commit(len);
+    }
+
+    void consume(int len) {
+        head += qMin(len, size());
+        if (head == tail)
+            head = tail = 0;
+    }
+
+    void clear() { head = tail = 0; }
+
+  private:
+    QByteArray buf;
+    int head = 0;
+    int tail = 0;
+};
+
+#endif // DIRCONFRAMEBUFFER_H
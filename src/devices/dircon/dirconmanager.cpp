@@ -1,9 +1,6 @@
 #include "devices/dircon/dirconmanager.h"
 #include <QNetworkInterface>
 #include <QSettings>
-#include <chrono>
-
-using namespace std::chrono_literals;
 
 #define DM_MACHINE_TYPE_BIKE 1
 #define DM_MACHINE_TYPE_TREADMILL 2
@@ -141,11 +138,20 @@ QString DirconManager::getMacAddress() {
     return QString(QStringLiteral("00:11:22:33:44"));
 }
 
-#define DM_CHAR_NOTIF_BUILD_OP(UUID, P1, P2, P3) notif##UUID = new CharacteristicNotifier##UUID(P1, this);
+#define DM_CHAR_NOTIF_BUILD_OP(UUID, P1, P2, P3) P2->add(new CharacteristicNotifier##UUID(P1));
+
+#define DM_CHAR_NOTIF_SERVED_OP(UUID, P1, P2, P3)                                                                      \
+    if (P1 == 0x##UUID)                                                                                                \
+        return true;
+
+bool DirconManager::served(quint16 uuid) {
+    DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_SERVED_OP, uuid, 0, 0)
+    return false;
+}
 
 DirconManager::DirconManager(bluetoothdevice *Bike, uint8_t bikeResistanceOffset, double bikeResistanceGain,
-                             QObject *parent)
-    : QObject(parent) {
+                             CharacteristicNotificationScheduler *notifications, QObject *parent)
+    : QObject(parent), notifications(notifications) {
     QSettings settings;
     DirconProcessorService *service;
     QList<DirconProcessorService *> services, proc_services;
@@ -156,7 +162,11 @@ DirconManager::DirconManager(bluetoothdevice *Bike, uint8_t bikeResistanceOffset
     uint16_t server_base_port =
         settings.value(QZSettings::dircon_server_base_port, QZSettings::default_dircon_server_base_port).toUInt();
     bool bike_wheel_revs = settings.value(QZSettings::bike_wheel_revs, QZSettings::default_bike_wheel_revs).toBool();
-    DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_BUILD_OP, Bike, 0, 0)
+    if (!this->notifications)
+        this->notifications = new CharacteristicNotificationScheduler(Bike, this);
+    // the notifiers already scheduled for the bluetooth peripheral are kept
+    DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_BUILD_OP, Bike, this->notifications, 0)
+    notif2AD9 = new CharacteristicNotifier2AD9(Bike, this);
     writeP2AD9 = new CharacteristicWriteProcessor2AD9(bikeResistanceGain, bikeResistanceOffset, Bike, notif2AD9, this);
     writePE005 = new CharacteristicWriteProcessorE005(bikeResistanceGain, bikeResistanceOffset, Bike, this);
     DM_CHAR_OP(DM_CHAR_INIT_OP, services, service, 0)
@@ -166,24 +176,30 @@ DirconManager::DirconManager(bluetoothdevice *Bike, uint8_t bikeResistanceOffset
     connect(writePE005, SIGNAL(changeInclination(double, double)), this, SIGNAL(changeInclination(double, double)));
     connect(writePE005, SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)), this,
             SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)));
-    QObject::connect(&bikeTimer, &QTimer::timeout, this, &DirconManager::bikeProvider);
+    notificationValue.reserve(64);
+    connect(this->notifications, &CharacteristicNotificationScheduler::notificationsReady, this,
+            &DirconManager::bikeProvider);
     QString mac = getMacAddress();
     DM_MACHINE_OP(DM_MACHINE_INIT_OP, services, proc_services, type)
-    if (settings.value(QZSettings::race_mode, QZSettings::default_race_mode).toBool())
-        bikeTimer.start(100ms);
-    else
-        bikeTimer.start(1s);
+    this->notifications->start();
 }
 
-#define DM_CHAR_NOTIF_NOTIF1_OP(UUID, P1, P2, P3)                                                                      \
-    QByteArray all##UUID;                                                                                              \
-    int rv##UUID = notif##UUID->notify(all##UUID);
-
-#define DM_CHAR_NOTIF_NOTIF2_OP(UUID, P1, P2, P3)                                                                      \
-    if (rv##UUID == CN_OK)                                                                                             \
-        P1->sendCharacteristicNotification(0x##UUID, all##UUID);
-
-void DirconManager::bikeProvider() {
-    DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_NOTIF1_OP, 0, 0, 0)
-    foreach (DirconProcessor *processor, processors) { DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_NOTIF2_OP, processor, 0, 0) }
+void DirconManager::bikeProvider(const CharacteristicNotificationBatch &batch) {
+    // encoded once per tick by the scheduler, whatever the number of transports, processors and clients
+    notificationFrames.clear();
+    for (int i = 0; i < batch.count(); i++)
+        if (served(batch.uuid(i)))
+            notificationFrames.add(batch.uuid(i), batch.value(i));
+    // the control point answer: at the heartbeat, as before, and as soon as there is a new one
+    notificationValue.resize(0);
+    if (notif2AD9->notify(notificationValue) == CN_OK &&
+        (batch.heartbeat() || notificationValue != lastAnswer2AD9)) {
+        notificationFrames.add(0x2AD9, notificationValue);
+        lastAnswer2AD9 = notificationValue;
+    }
+    if (!notificationFrames.count())
+        return;
+    foreach (DirconProcessor *processor, processors) {
+        processor->sendCharacteristicNotifications(notificationFrames, notifications);
+    }
 }
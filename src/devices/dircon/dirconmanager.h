@@ -2,6 +2,7 @@
 #define DIRCONMANAGER_H
 
 #include "devices/bluetoothdevice.h"
+#include "characteristics/characteristicnotificationscheduler.h"
 #include "characteristics/characteristicnotifier2a37.h"
 #include "characteristics/characteristicnotifier2a53.h"
 #include "characteristics/characteristicnotifier2a5b.h"
@@ -16,28 +17,35 @@
 #include "devices/dircon/dirconprocessor.h"
 #include <QObject>
 
+// the notifications of the scheduler served by Dircon
 #define DM_CHAR_NOTIF_OP(OP, P1, P2, P3)                                                                               \
     OP(2AD2, P1, P2, P3)                                                                                               \
     OP(2A63, P1, P2, P3)                                                                                               \
-    OP(2A37, P1, P2, P3) OP(2A5B, P1, P2, P3) OP(2A53, P1, P2, P3) OP(2ACD, P1, P2, P3) OP(2ACC, P1, P2, P3)           \
-        OP(2AD9, P1, P2, P3)
-
-#define DM_CHAR_NOTIF_DEFINE_OP(UUID, P1, P2, P3) CharacteristicNotifier##UUID *notif##UUID = 0;
+    OP(2A37, P1, P2, P3) OP(2A5B, P1, P2, P3) OP(2A53, P1, P2, P3) OP(2ACD, P1, P2, P3) OP(2ACC, P1, P2, P3)
 
 class DirconManager : public QObject {
     Q_OBJECT
-    QTimer bikeTimer;
+    CharacteristicNotificationScheduler *notifications = 0;
     CharacteristicWriteProcessor2AD9 *writeP2AD9 = 0;
     CharacteristicWriteProcessorE005 *writePE005 = 0;
-    DM_CHAR_NOTIF_OP(DM_CHAR_NOTIF_DEFINE_OP, 0, 0, 0)
+    // the answer to the control point writes of the Dircon clients
+    CharacteristicNotifier2AD9 *notif2AD9 = 0;
     QList<DirconProcessor *> processors;
+    DirconNotificationFrames notificationFrames;
+    QByteArray notificationValue;
+    QByteArray lastAnswer2AD9;
     static QString getMacAddress();
+    static bool served(quint16 uuid);
 
   public:
+    /**
+     * @brief The notifications are those of the scheduler of the virtual device, shared with its bluetooth
+     * peripheral; without one the manager has a scheduler of its own.
+     */
     explicit DirconManager(bluetoothdevice *t, uint8_t bikeResistanceOffset = 4, double bikeResistanceGain = 1.0,
-                           QObject *parent = nullptr);
+                           CharacteristicNotificationScheduler *notifications = nullptr, QObject *parent = nullptr);
   private slots:
-    void bikeProvider();
+    void bikeProvider(const CharacteristicNotificationBatch &batch);
   signals:
     void changeInclination(double grade, double percentage);
     void ftmsCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
@@ -1,7 +1,61 @@
 #include "dirconpacket.h"
 
+#include <cstring>
+
+static const quint8 base_uuid_bytes[16] = {0x00, 0x00, 0x18, 0x26, 0x00, 0x00, 0x10, 0x00,
+                                           0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+
 DirconPacket::DirconPacket() {}
 
+void DirconPacket::reset() {
+    MessageVersion = 1;
+    Identifier = DPKT_MSGID_ERROR;
+    SequenceNumber = 0;
+    ResponseCode = DPKT_RESPCODE_SUCCESS_REQUEST;
+    Length = 0;
+    uuid = 0;
+    if (!uuids.isEmpty())
+        uuids.clear();
+    // resize keeps the allocation when the capacity was reserved
+    additional_data.resize(0);
+    isRequest = false;
+}
+
+void DirconPacket::setData(const char *data, int size) {
+    additional_data.resize(size);
+    if (size > 0)
+        memcpy(additional_data.data(), data, size);
+}
+
+void DirconPacket::appendUuid(quint16 uuid, QByteArray &out) {
+    const int pos = out.size();
+    out.append((const char *)base_uuid_bytes, 16);
+    out[pos + DPKT_POS_SH8] = (char)(uuid >> 8);
+    out[pos + DPKT_POS_SH0] = (char)(uuid);
+}
+
+void DirconPacket::encodeNotification(quint16 uuid, const QByteArray &data, QByteArray &out) {
+    const int length = 16 + data.size();
+    const char header[DPKT_MESSAGE_HEADER_LENGTH] = {
+        1, (char)DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION, 0, (char)DPKT_RESPCODE_SUCCESS_REQUEST,
+        (char)(length >> 8), (char)length};
+    out.append(header, DPKT_MESSAGE_HEADER_LENGTH);
+    appendUuid(uuid, out);
+    out.append(data);
+}
+
+void DirconNotificationFrames::clear() {
+    frames.resize(0);
+    uuids.clear();
+    offsets.clear();
+}
+
+void DirconNotificationFrames::add(quint16 uuid, const QByteArray &value) {
+    uuids.append(uuid);
+    offsets.append(frames.size());
+    DirconPacket::encodeNotification(uuid, value, frames);
+}
+
 DirconPacket::operator QString() const {
     QString us = QString();
     foreach (quint16 u, uuids) { us += QString(QStringLiteral("%1,")).arg(u, 4, 16, QLatin1Char('0')); }
@@ -18,14 +72,23 @@ DirconPacket::operator QString() const {
 }
 
 int DirconPacket::parse(const QByteArray &buf, int last_seq_number) {
-    if (buf.size() >= DPKT_MESSAGE_HEADER_LENGTH) {
-        this->MessageVersion = ((quint8)buf.at(0));
-        this->Identifier = ((quint8)buf.at(1));
-        this->SequenceNumber = ((quint8)buf.at(2));
-        this->ResponseCode = ((quint8)buf.at(3));
-        this->Length = (((quint8)buf.at(4)) << 8) | ((quint8)buf.at(5));
+    return parse(buf.constData(), buf.size(), last_seq_number);
+}
+
+int DirconPacket::parse(const char *buf, int size, int last_seq_number) {
+    if (size >= DPKT_MESSAGE_HEADER_LENGTH) {
+        this->MessageVersion = ((quint8)buf[0]);
+        this->Identifier = ((quint8)buf[1]);
+        this->SequenceNumber = ((quint8)buf[2]);
+        this->ResponseCode = ((quint8)buf[3]);
+        this->Length = (((quint8)buf[4]) << 8) | ((quint8)buf[5]);
         this->isRequest = false;
-        int difflen = buf.size() - DPKT_MESSAGE_HEADER_LENGTH;
+        // a pooled packet may hold the data of the previous frame
+        this->uuid = 0;
+        this->additional_data.resize(0);
+        if (!this->uuids.isEmpty())
+            this->uuids.clear();
+        int difflen = size - DPKT_MESSAGE_HEADER_LENGTH;
         int rembuf = DPKT_MESSAGE_HEADER_LENGTH + this->Length;
         if (difflen < this->Length)
             return DPKT_PARSE_WAIT;
@@ -39,8 +102,8 @@ int DirconPacket::parse(const QByteArray &buf, int last_seq_number) {
                 int idx = 0;
                 this->uuids.clear();
                 while (this->Length >= idx + 16) {
-                    quint16 uuid = (((quint16)buf.at(idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8);
-                    uuid |= ((quint16)buf.at(idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                    quint16 uuid = (((quint16)(quint8)buf[idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8);
+                    uuid |= ((quint16)(quint8)buf[idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                     this->uuids.append(uuid);
                     idx += 16;
                 }
@@ -49,21 +112,21 @@ int DirconPacket::parse(const QByteArray &buf, int last_seq_number) {
                 return DPKT_PARSE_ERROR - rembuf;
         } else if (this->Identifier == DPKT_MSGID_DISCOVER_CHARACTERISTICS) {
             if (this->Length >= 16) {
-                quint16 uuid = ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8;
-                uuid |= ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                quint16 uuid = ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8;
+                uuid |= ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                 this->uuid = uuid;
                 if (this->Length == 16) {
                     this->isRequest = this->checkIsRequest(last_seq_number);
                     return rembuf;
                 } else if ((this->Length - 16) % 17 == 0) {
                     this->uuids.clear();
-                    this->additional_data.clear();
+                    this->additional_data.resize(0);
                     int idx = 16;
                     while (this->Length >= idx + 17) {
-                        quint16 uuid = (((quint16)buf.at(idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8);
-                        uuid |= ((quint16)buf.at(idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                        quint16 uuid = (((quint16)(quint8)buf[idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8);
+                        uuid |= ((quint16)(quint8)buf[idx + DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                         this->uuids.append(uuid);
-                        this->additional_data.append(((quint8)buf.at(idx + DPKT_MESSAGE_HEADER_LENGTH + 16)));
+                        this->additional_data.append(((quint8)buf[idx + DPKT_MESSAGE_HEADER_LENGTH + 16]));
                         idx += 17;
                     }
                     return rembuf;
@@ -73,47 +136,44 @@ int DirconPacket::parse(const QByteArray &buf, int last_seq_number) {
                 return DPKT_PARSE_ERROR - rembuf;
         } else if (this->Identifier == DPKT_MSGID_READ_CHARACTERISTIC) {
             if (this->Length >= 16) {
-                quint16 uuid = ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8;
-                uuid |= ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                quint16 uuid = ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8;
+                uuid |= ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                 this->uuid = uuid;
                 if (this->Length == 16)
                     this->isRequest = this->checkIsRequest(last_seq_number);
                 else
-                    this->additional_data =
-                        buf.mid(DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
+                    this->setData(buf + DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
                 return rembuf;
             } else
                 return DPKT_PARSE_ERROR - rembuf;
         } else if (this->Identifier == DPKT_MSGID_WRITE_CHARACTERISTIC) {
             if (this->Length > 16) {
-                quint16 uuid = ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8;
-                uuid |= ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                quint16 uuid = ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8;
+                uuid |= ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                 this->uuid = uuid;
-                this->additional_data =
-                    buf.mid(DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
+                this->setData(buf + DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
                 this->isRequest = this->checkIsRequest(last_seq_number);
                 return rembuf;
             } else
                 return DPKT_PARSE_ERROR - rembuf;
         } else if (this->Identifier == DPKT_MSGID_ENABLE_CHARACTERISTIC_NOTIFICATIONS) {
             if (this->Length == 16 || this->Length == 17) {
-                quint16 uuid = ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8;
-                uuid |= ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                quint16 uuid = ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8;
+                uuid |= ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                 this->uuid = uuid;
                 if (this->Length == 17) {
                     this->isRequest = true;
-                    this->additional_data = buf.mid(DPKT_MESSAGE_HEADER_LENGTH + 16, 1);
+                    this->setData(buf + DPKT_MESSAGE_HEADER_LENGTH + 16, 1);
                 }
                 return rembuf;
             } else
                 return DPKT_PARSE_ERROR - rembuf;
         } else if (this->Identifier == DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION) {
             if (this->Length > 16) {
-                quint16 uuid = ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8)) << 8;
-                uuid |= ((quint16)buf.at(DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0)) & 0x00FF;
+                quint16 uuid = ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH8]) << 8;
+                uuid |= ((quint16)(quint8)buf[DPKT_MESSAGE_HEADER_LENGTH + DPKT_POS_SH0]) & 0x00FF;
                 this->uuid = uuid;
-                this->additional_data =
-                    buf.mid(DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
+                this->setData(buf + DPKT_MESSAGE_HEADER_LENGTH + 16, rembuf - (DPKT_MESSAGE_HEADER_LENGTH + 16));
                 return rembuf;
             } else
                 return DPKT_PARSE_ERROR - rembuf;
@@ -144,10 +204,17 @@ DirconPacket &DirconPacket::operator=(const DirconPacket &cp) {
 }
 
 QByteArray DirconPacket::encode(int last_seq_number) {
+    QByteArray byteout;
+    encode(last_seq_number, byteout);
+    return byteout;
+}
+
+int DirconPacket::encode(int last_seq_number, QByteArray &byteout) {
     quint16 u;
     int i = 0;
+    const int start = byteout.size();
     if (this->Identifier == DPKT_MSGID_ERROR)
-        return QByteArray();
+        return 0;
     else if (this->isRequest)
         this->SequenceNumber = last_seq_number & 0xFF;
     else if (this->Identifier == DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION)
@@ -155,7 +222,6 @@ QByteArray DirconPacket::encode(int last_seq_number) {
     else
         this->SequenceNumber = last_seq_number;
     this->MessageVersion = 1;
-    QByteArray byteout;
     byteout.append((char)this->MessageVersion);
     byteout.append((char)this->Identifier);
     byteout.append((char)this->SequenceNumber);
@@ -170,23 +236,15 @@ QByteArray DirconPacket::encode(int last_seq_number) {
         } else {
             this->Length = this->uuids.size() * 16;
             byteout.append((char)(this->Length >> 8)).append((char)(this->Length));
-            foreach (u, this->uuids) {
-                this->uuid_bytes[DPKT_POS_SH8] = (quint8)(u >> 8);
-                this->uuid_bytes[DPKT_POS_SH0] = (quint8)(u);
-                byteout.append((char *)this->uuid_bytes, 16);
-            }
+            foreach (u, this->uuids)
+                appendUuid(u, byteout);
         }
     } else if (this->Identifier == DPKT_MSGID_DISCOVER_CHARACTERISTICS && !this->isRequest) {
         this->Length = 16 + this->uuids.size() * 17;
         byteout.append((char)(this->Length >> 8)).append((char)(this->Length));
-        u = this->uuid;
-        this->uuid_bytes[DPKT_POS_SH8] = (quint8)(u >> 8);
-        this->uuid_bytes[DPKT_POS_SH0] = (quint8)(u);
-        byteout.append((char *)this->uuid_bytes, 16);
+        appendUuid(this->uuid, byteout);
         foreach (u, this->uuids) {
-            this->uuid_bytes[DPKT_POS_SH8] = (quint8)(u >> 8);
-            this->uuid_bytes[DPKT_POS_SH0] = (quint8)(u);
-            byteout.append((char *)this->uuid_bytes, 16);
+            appendUuid(u, byteout);
             byteout.append(this->additional_data.at(i++));
         }
     } else if (((this->Identifier == DPKT_MSGID_READ_CHARACTERISTIC ||
@@ -195,21 +253,15 @@ QByteArray DirconPacket::encode(int last_seq_number) {
                (this->Identifier == DPKT_MSGID_ENABLE_CHARACTERISTIC_NOTIFICATIONS && !this->isRequest)) {
         this->Length = 16;
         byteout.append((char)(this->Length >> 8)).append((char)(this->Length));
-        u = this->uuid;
-        this->uuid_bytes[DPKT_POS_SH8] = (quint8)(u >> 8);
-        this->uuid_bytes[DPKT_POS_SH0] = (quint8)(u);
-        byteout.append((char *)this->uuid_bytes, 16);
+        appendUuid(this->uuid, byteout);
     } else if (this->Identifier == DPKT_MSGID_WRITE_CHARACTERISTIC ||
                this->Identifier == DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION ||
                (this->Identifier == DPKT_MSGID_READ_CHARACTERISTIC && !this->isRequest) ||
                (this->Identifier == DPKT_MSGID_ENABLE_CHARACTERISTIC_NOTIFICATIONS && this->isRequest)) {
         this->Length = 16 + this->additional_data.size();
         byteout.append((char)(this->Length >> 8)).append((char)(this->Length));
-        u = this->uuid;
-        this->uuid_bytes[DPKT_POS_SH8] = (quint8)(u >> 8);
-        this->uuid_bytes[DPKT_POS_SH0] = (quint8)(u);
-        byteout.append((char *)this->uuid_bytes, 16);
+        appendUuid(this->uuid, byteout);
         byteout.append(this->additional_data);
     }
-    return byteout;
+    return byteout.size() - start;
 }
@@ -3,6 +3,7 @@
 #include <QByteArray>
 #include <QList>
 #include <QObject>
+#include <QVector>
 
 #define DPKT_MESSAGE_HEADER_LENGTH 6
 #define DPKT_CHAR_PROP_FLAG_READ 0x01
@@ -33,6 +34,11 @@
 class DirconPacket {
   public:
     DirconPacket();
+    /**
+     * @brief Back to the state of a new packet, keeping the memory of additional_data: a pooled packet can be reused
+     * for every frame of a connection.
+     */
+    void reset();
     quint8 MessageVersion = 1;
     quint8 Identifier = DPKT_MSGID_ERROR;
     quint8 SequenceNumber = 0;
@@ -45,13 +51,50 @@ class DirconPacket {
     DirconPacket(const DirconPacket &cp);
     DirconPacket &operator=(const DirconPacket &cp);
     QByteArray encode(int last_seq_number);
+    /**
+     * @brief Appends the encoded packet to out.
+     * @return the bytes appended.
+     */
+    int encode(int last_seq_number, QByteArray &out);
     int parse(const QByteArray &buf, int last_seq_number);
+    /**
+     * @brief Parses the frame at the start of buf, in place: only the payload is copied, into additional_data.
+     */
+    int parse(const char *buf, int size, int last_seq_number);
     operator QString() const;
 
+    /**
+     * @brief Appends an unsolicited notification of the characteristic uuid to out, as encode(0) would.
+     */
+    static void encodeNotification(quint16 uuid, const QByteArray &data, QByteArray &out);
+
   private:
-    quint8 uuid_bytes[16] = {0x00, 0x00, 0x18, 0x26, 0x00, 0x00, 0x10, 0x00,
-                             0x80, 0x00, 0x00, 0x80, 0x5F, 0x9B, 0x34, 0xFB};
+    static void appendUuid(quint16 uuid, QByteArray &out);
+    void setData(const char *data, int size);
     bool checkIsRequest(int last_seq_number);
 };
 
+/**
+ * @brief The notifications of a tick, encoded once, back to back, for all the clients of all the processors.
+ */
+class DirconNotificationFrames {
+  public:
+    DirconNotificationFrames() { frames.reserve(256); }
+    void clear();
+    void add(quint16 uuid, const QByteArray &value);
+    int count() const { return uuids.count(); }
+    quint16 uuid(int i) const { return uuids.at(i); }
+    const char *frame(int i) const { return frames.constData() + offsets.at(i); }
+    int frameSize(int i) const { return (i + 1 < offsets.count() ? offsets.at(i + 1) : frames.size()) - offsets.at(i); }
+    /**
+     * @brief All the frames, for the clients subscribed to every characteristic.
+     */
+    const QByteArray &data() const { return frames; }
+
+  private:
+    QByteArray frames;
+    QVector<quint16> uuids;
+    QVector<int> offsets;
+};
+
 #endif // DIRCONPACKET_H
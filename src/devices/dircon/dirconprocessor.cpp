@@ -1,6 +1,8 @@
 #include "dirconprocessor.h"
+#include "characteristics/characteristicnotificationscheduler.h"
 #include "dirconpacket.h"
 #include "qzsettings.h"
+#include "qzsettingssnapshot.h"
 #include <QSettings>
 #include <QHostInfo>
 
@@ -8,6 +10,9 @@ DirconProcessor::DirconProcessor(const QList<DirconProcessorService *> &my_servi
                                  quint16 serv_port, const QString &serv_sn, const QString &my_mac, QObject *parent)
     : QObject(parent), services(my_services), mac(my_mac), serverPort(serv_port), serialN(serv_sn),
       serverName(serv_name) {
+    QSettings settings;
+    // applied at restart
+    notifyAll = !settings.value(QZSettings::wahoo_rgt_dircon, QZSettings::default_wahoo_rgt_dircon).toBool();
     qDebug() << "In the constructor of dircon processor for" << serverName;
     foreach (DirconProcessorService *my_service, my_services) { my_service->setParent(this); }
 }
@@ -28,6 +33,8 @@ bool DirconProcessor::initServer() {
         return true;
 }
 
+quint16 DirconProcessor::port() const { return server ? server->serverPort() : serverPort; }
+
 void DirconProcessor::initAdvertising() {
     /*    if (!zeroConf) {
             qDebug() << "Dircon Adv init for" << service->uuid;
@@ -95,8 +102,8 @@ void DirconProcessor::tcpDisconnected() {
     socket->deleteLater();
 }
 
-DirconPacket DirconProcessor::processPacket(DirconProcessorClient *client, const DirconPacket &pkt) {
-    DirconPacket out;
+void DirconProcessor::processPacket(DirconProcessorClient *client, const DirconPacket &pkt, DirconPacket &out) {
+    out.reset();
     if (pkt.isRequest) {
         bool cfound = false;
         DirconProcessorCharacteristic *cc;
@@ -194,30 +201,54 @@ DirconPacket DirconProcessor::processPacket(DirconProcessorClient *client, const
                 out.ResponseCode = DPKT_RESPCODE_CHARACTERISTIC_NOT_FOUND;
         }
     }
-    return out;
 }
 
 bool DirconProcessor::sendCharacteristicNotification(quint16 uuid, const QByteArray &data) {
-    DirconPacket pkt;
+    DirconNotificationFrames frames;
+    frames.add(uuid, data);
+    return sendCharacteristicNotifications(frames);
+}
+
+bool DirconProcessor::sendCharacteristicNotifications(const DirconNotificationFrames &frames,
+                                                      CharacteristicNotificationScheduler *stats) {
     QTcpSocket *socket;
     DirconProcessorClient *client;
-    QSettings settings;
     bool rv = true, rvs;
-    pkt.additional_data = data;
-    pkt.Identifier = DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION;
-    pkt.ResponseCode = DPKT_RESPCODE_SUCCESS_REQUEST;
-    pkt.uuid = uuid;
+    const bool logDebug = QZSettingsSnapshot::get().log_debug;
+    if (!frames.count())
+        return true;
     for (QHash<QTcpSocket *, DirconProcessorClient *>::iterator i = clientsMap.begin(); i != clientsMap.end(); ++i) {
         client = i.value();
-        if (client->char_notify.indexOf(uuid) >= 0 || !settings.value(QZSettings::wahoo_rgt_dircon, QZSettings::default_wahoo_rgt_dircon).toBool()) {
-            socket = i.key();
-            rvs = socket->write(pkt.encode(0)) < 0;
-            if (rvs)
-                rv = false;
-            qDebug() << serverName << "sending to" << socket->peerAddress().toString() << ":" << socket->peerPort()
-                     << " notification for uuid = " << QString(QStringLiteral("%1")).arg(uuid, 4, 16, QLatin1Char('0'))
-                     << "rv=" << (!rvs) << data.toHex(' ');
+        socket = i.key();
+        int subscribed = frames.count();
+        if (!notifyAll) {
+            subscribed = 0;
+            for (int k = 0; k < frames.count(); k++)
+                if (client->char_notify.contains(frames.uuid(k)))
+                    subscribed++;
+        }
+        if (!subscribed)
+            continue;
+        int bytes;
+        if (subscribed == frames.count()) {
+            // the frames as encoded by the caller, shared by all the clients
+            bytes = frames.data().size();
+            rvs = socket->write(frames.data()) < 0;
+        } else {
+            client->out.resize(0);
+            for (int k = 0; k < frames.count(); k++)
+                if (client->char_notify.contains(frames.uuid(k)))
+                    client->out.append(frames.frame(k), frames.frameSize(k));
+            bytes = client->out.size();
+            rvs = socket->write(client->out) < 0;
         }
+        if (rvs)
+            rv = false;
+        else if (stats)
+            stats->delivered(client->name, subscribed, bytes);
+        if (logDebug)
+            qDebug() << serverName << "sending to" << socket->peerAddress().toString() << ":" << socket->peerPort()
+                     << subscribed << "notifications rv=" << (!rvs);
     }
     return rv;
 }
@@ -225,46 +256,60 @@ bool DirconProcessor::sendCharacteristicNotification(quint16 uuid, const QByteAr
 void DirconProcessor::tcpDataAvailable() {
     QTcpSocket *socket = qobject_cast<QTcpSocket *>(sender());
     DirconProcessorClient *client = clientsMap.value(socket);
-    QByteArray data = socket->readAll();
-    qDebug() << "Data available for uuid " << serverName << ":" << data.toHex();
-    if (client) {
-        int buflimit, rembuf;
-        client->buffer.append(data);
-        while (1) {
-            DirconPacket pkt;
-            buflimit = pkt.parse(client->buffer, client->seq);
+    const bool logDebug = QZSettingsSnapshot::get().log_debug;
+    if (!client) {
+        socket->readAll();
+        return;
+    }
+    qint64 available;
+    while ((available = socket->bytesAvailable()) > 0) {
+        char *tail = client->buffer.reserve((int)available);
+        qint64 n = socket->read(tail, available);
+        if (n <= 0)
+            break;
+        if (logDebug)
+            qDebug() << "Data available for uuid " << serverName << ":" << QByteArray(tail, (int)n).toHex();
+        client->buffer.commit((int)n);
+    }
+    int buflimit, rembuf;
+    DirconPacket &pkt = client->request;
+    DirconPacket &resp = client->response;
+    // the responses to all the frames received go out with a single write
+    client->out.resize(0);
+    while (1) {
+        buflimit = pkt.parse(client->buffer.data(), client->buffer.size(), client->seq);
+        if (logDebug)
             qDebug() << "Pkt for uuid" << serverName << "parsed rv=" << buflimit << " ->" << pkt;
-            if (buflimit > 0) {
-                rembuf = buflimit;
-                if (pkt.isRequest)
-                    client->seq = pkt.SequenceNumber;
-                else if (pkt.Identifier != DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION)
-                    client->seq += 1;
-            } else if (buflimit < DPKT_PARSE_ERROR) {
-                rembuf = -buflimit - DPKT_PARSE_ERROR;
-                qDebug() << "Unexpected packet" << client->buffer.mid(0, rembuf).toHex();
-            } else
-                rembuf = -1;
-            if (rembuf >= 0)
-                client->buffer = client->buffer.mid(rembuf);
-            if (buflimit > 0) {
-                DirconPacket resp = processPacket(client, pkt);
+        if (buflimit > 0) {
+            rembuf = buflimit;
+            if (pkt.isRequest)
+                client->seq = pkt.SequenceNumber;
+            else if (pkt.Identifier != DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION)
+                client->seq += 1;
+        } else if (buflimit < DPKT_PARSE_ERROR) {
+            rembuf = DPKT_PARSE_ERROR - buflimit;
+            qDebug() << "Unexpected packet"
+                     << QByteArray(client->buffer.data(), qMin(rembuf, client->buffer.size())).toHex();
+        } else
+            rembuf = -1;
+        if (buflimit > 0) {
+            processPacket(client, pkt, resp);
+            if (logDebug)
                 qDebug() << "Sending resp for uuid" << serverName << ":" << resp;
-                if (resp.Identifier != DPKT_MSGID_ERROR) {
-                    QByteArray byteout = resp.encode(pkt.SequenceNumber);
-                    if (byteout.size())
-                        client->sock->write(byteout);
-                }
-            } else if (rembuf >= 0) {
-                DirconPacket resp;
-                resp.isRequest = false;
-                resp.ResponseCode = DPKT_RESPCODE_UNEXPECTED_ERROR;
-                resp.Identifier = pkt.Identifier;
-                QByteArray byteout = resp.encode(pkt.SequenceNumber);
-                if (byteout.size())
-                    client->sock->write(byteout);
-            } else
-                break;
+            if (resp.Identifier != DPKT_MSGID_ERROR)
+                resp.encode(pkt.SequenceNumber, client->out);
+        } else if (rembuf >= 0) {
+            resp.reset();
+            resp.isRequest = false;
+            resp.ResponseCode = DPKT_RESPCODE_UNEXPECTED_ERROR;
+            resp.Identifier = pkt.Identifier;
+            resp.encode(pkt.SequenceNumber, client->out);
         }
+        if (rembuf >= 0)
+            client->buffer.consume(rembuf);
+        else
+            break;
     }
+    if (!client->out.isEmpty())
+        client->sock->write(client->out);
 }
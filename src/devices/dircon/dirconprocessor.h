@@ -2,6 +2,7 @@
 #define DIRCONPROCESSOR_H
 
 #include "characteristics/characteristicwriteprocessor.h"
+#include "dirconframebuffer.h"
 #include "dirconpacket.h"
 #include "qmdnsengine/hostname.h"
 #include "qmdnsengine/provider.h"
@@ -12,6 +13,8 @@
 #include <QTcpServer>
 #include <QTcpSocket>
 
+class CharacteristicNotificationScheduler;
+
 class DirconProcessorCharacteristic : public QObject {
   public:
     DirconProcessorCharacteristic(QObject *parent = nullptr) : QObject(parent), uuid(0), type(0), writeP(0) {}
@@ -62,11 +65,24 @@ class DirconProcessorService : public QObject {
 
 class DirconProcessorClient : public QObject {
   public:
-    DirconProcessorClient(QTcpSocket *sock) : QObject(sock), sock(sock) {}
+    DirconProcessorClient(QTcpSocket *sock) : QObject(sock), sock(sock) {
+        name = QStringLiteral("dircon ") + sock->peerAddress().toString() + QStringLiteral(":") +
+               QString::number(sock->peerPort());
+        request.additional_data.reserve(64);
+        response.additional_data.reserve(64);
+        out.reserve(512);
+    }
     quint8 seq = 0;
     QList<quint16> char_notify;
     QTcpSocket *sock;
-    QByteArray buffer;
+    // the client in the statistics of the notifications
+    QString name;
+    DirconFrameBuffer buffer;
+    // reused for every frame of the connection
+    DirconPacket request;
+    DirconPacket response;
+    // what is sent to the client by one write
+    QByteArray out;
 };
 
 class DirconProcessor : public QObject {
@@ -81,16 +97,29 @@ class DirconProcessor : public QObject {
     QMdnsEngine::Provider *mdnsProvider = 0;
     QMdnsEngine::Hostname *mdnsHostname = 0;
     QHash<QTcpSocket *, DirconProcessorClient *> clientsMap;
-    bool initServer();
+    // wahoo_rgt_dircon off: every client gets every notification
+    bool notifyAll;
     void initAdvertising();
-    DirconPacket processPacket(DirconProcessorClient *client, const DirconPacket &pkt);
+    void processPacket(DirconProcessorClient *client, const DirconPacket &pkt, DirconPacket &out);
 
   public:
     ~DirconProcessor();
     explicit DirconProcessor(const QList<DirconProcessorService *> &services, const QString &serv_name,
                              quint16 serv_port, const QString &serv_sn, const QString &mac, QObject *parent = nullptr);
     bool sendCharacteristicNotification(quint16 uuid, const QByteArray &data);
+    /**
+     * @brief Sends the notifications of a tick, encoded once by the caller: a single write per client. What every
+     * client received is counted by stats, if any.
+     */
+    bool sendCharacteristicNotifications(const DirconNotificationFrames &frames,
+                                         CharacteristicNotificationScheduler *stats = nullptr);
     bool init();
+    /**
+     * @brief Starts the TCP server only, without the mDNS advertising (init() does both).
+     */
+    bool initServer();
+    quint16 port() const;
+    int clientCount() const { return clientsMap.count(); }
   private slots:
     void tcpDataAvailable();
     void tcpDisconnected();
@@ -2,6 +2,7 @@
 #ifdef Q_OS_ANDROID
 #include "keepawakehelper.h"
 #endif
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -434,7 +435,7 @@ void domyosbike::characteristicChanged(const QLowEnergyCharacteristic &character
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     KCal = kcal;
     Distance = distance;
@@ -658,43 +659,32 @@ resistance_t domyosbike::pelotonToBikeResistance(int pelotonResistance) {
 resistance_t domyosbike::resistanceFromPowerRequest(uint16_t power) {
     qDebug() << QStringLiteral("resistanceFromPowerRequest") << currentCadence().value();
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, currentCadence().value());
 }
 
-uint16_t domyosbike::wattsFromResistance(double resistance) {
-    QSettings settings;
-    if (!settings.value(QZSettings::domyos_bike_500_profile_v1, QZSettings::default_domyos_bike_500_profile_v1)
-             .toBool() ||
-        resistance < 8)
-        return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (currentCadence().value()))));
+double domyosbike::wattsFromResistance(double resistance, double cadence) {
+    if (!QZSettingsSnapshot::get().domyos_bike_500_profile_v1 || resistance < 8)
+        return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (cadence))));
     else {
         switch ((int)resistance) {
         case 8:
-            return (13.6 * Cadence.value()) / 9.5488;
+            return (13.6 * cadence) / 9.5488;
         case 9:
-            return (15.3 * Cadence.value()) / 9.5488;
+            return (15.3 * cadence) / 9.5488;
         case 10:
-            return (17.3 * Cadence.value()) / 9.5488;
+            return (17.3 * cadence) / 9.5488;
         case 11:
-            return (19.8 * Cadence.value()) / 9.5488;
+            return (19.8 * cadence) / 9.5488;
         case 12:
-            return (22.5 * Cadence.value()) / 9.5488;
+            return (22.5 * cadence) / 9.5488;
         case 13:
-            return (25.6 * Cadence.value()) / 9.5488;
+            return (25.6 * cadence) / 9.5488;
         case 14:
-            return (28.4 * Cadence.value()) / 9.5488;
+            return (28.4 * cadence) / 9.5488;
         case 15:
-            return (35.9 * Cadence.value()) / 9.5488;
+            return (35.9 * cadence) / 9.5488;
         }
-        return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (currentCadence().value()))));
+        return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (cadence))));
     }
 }
 
@@ -707,7 +697,7 @@ uint16_t domyosbike::watts() {
     if (currentCadence().value() <= 0) {
         return 0;
     }
-    v = wattsFromResistance(currentResistance().value());
+    v = powerSurface().watts(currentResistance().value(), currentCadence().value());
     return v;
 }
 
@@ -41,6 +41,7 @@ class domyosbike : public bike {
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t maxResistance() override { return max_resistance; }
+    double wattsFromResistance(double resistance, double cadence) override;
     ~domyosbike() override;
     bool connected() override;
 
@@ -49,7 +50,6 @@ class domyosbike : public bike {
     double GetInclinationFromPacket(QByteArray packet);
     double GetKcalFromPacket(const QByteArray &packet);
     double GetDistanceFromPacket(const QByteArray &packet);
-    uint16_t wattsFromResistance(double resistance);
     void forceResistance(resistance_t requestResistance);
     void updateDisplay(uint16_t elapsed);
     void btinit_changyow(bool startTape);
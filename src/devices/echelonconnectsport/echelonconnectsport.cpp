@@ -2,6 +2,7 @@
 #ifdef Q_OS_ANDROID
 #include "keepawakehelper.h"
 #endif
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -157,15 +158,7 @@ void echelonconnectsport::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t echelonconnectsport::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) > pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance, true);
 }
 
 resistance_t echelonconnectsport::resistanceFromPowerRequest(uint16_t power) {
@@ -174,28 +167,17 @@ resistance_t echelonconnectsport::resistanceFromPowerRequest(uint16_t power) {
     if (Cadence.value() == 0)
         return 1;
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
 }
 
 double echelonconnectsport::bikeResistanceToPeloton(double resistance) {
-    QSettings settings;
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
     // 0,0097x3 - 0,4972x2 + 10,126x - 37,08
     double p = ((pow(resistance, 3) * 0.0097) - (0.4972 * pow(resistance, 2)) + (10.126 * resistance) - 37.08);
     if (p < 0) {
         p = 0;
     }
-    return (p * settings.value(QZSettings::peloton_gain, QZSettings::default_peloton_gain).toDouble()) +
-           settings.value(QZSettings::peloton_offset, QZSettings::default_peloton_offset).toDouble();
+    return (p * settings.peloton_gain) + settings.peloton_offset;
 }
 
 void echelonconnectsport::characteristicChanged(const QLowEnergyCharacteristic &characteristic,
@@ -260,7 +242,7 @@ void echelonconnectsport::characteristicChanged(const QLowEnergyCharacteristic &
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     if (watts())
         KCal +=
@@ -534,10 +516,10 @@ uint16_t echelonconnectsport::watts() {
     if (currentCadence().value() == 0) {
         return 0;
     }
-    return wattsFromResistance(Resistance.value());
+    return powerSurface().watts(Resistance.value(), currentCadence().value());
 }
 
-uint16_t echelonconnectsport::wattsFromResistance(double resistance) {
+double echelonconnectsport::wattsFromResistance(double resistance, double cadence) {
     // https://github.com/cagnulein/qdomyos-zwift/issues/62#issuecomment-736913564
     /*if(currentCadence().value() < 90)
         return (uint16_t)((3.59 * exp(0.0217 * (double)(currentCadence().value()))) * exp(0.095 *
@@ -625,19 +607,16 @@ uint16_t echelonconnectsport::wattsFromResistance(double resistance) {
         level = wattTableFirstDimension - 1;
     }
     double *watts_of_level;
-    QSettings settings;
-    if (!settings.value(QZSettings::echelon_watttable, QZSettings::default_echelon_watttable)
-             .toString()
-             .compare("mgarcea"))
+    if (!QZSettingsSnapshot::get().echelon_watttable.compare(QStringLiteral("mgarcea")))
         watts_of_level = wattTable_mgarcea[level];
     else
         watts_of_level = wattTable[level];
-    int watt_setp = (Cadence.value() / 10.0);
+    int watt_setp = (cadence / 10.0);
     if (watt_setp >= 10) {
-        return (((double)Cadence.value()) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
+        return (((double)cadence) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
     }
     double watt_base = watts_of_level[watt_setp];
-    return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(Cadence.value())) % 10))) +
+    return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(cadence)) % 10))) +
            watt_base;
 }
 
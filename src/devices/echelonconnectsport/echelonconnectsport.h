@@ -42,13 +42,13 @@ class echelonconnectsport : public bike {
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t maxResistance() override { return max_resistance; }
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
+    double bikeResistanceToPeloton(double resistance) override;
     bool connected() override;
 
   private:
     const resistance_t max_resistance = 32;
-    double bikeResistanceToPeloton(double resistance);
     double GetDistanceFromPacket(const QByteArray &packet);
-    uint16_t wattsFromResistance(double resistance);
     QTime GetElapsedFromPacket(const QByteArray &packet);
     void btinit();
     void writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool disable_log = false,
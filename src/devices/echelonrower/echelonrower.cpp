@@ -163,25 +163,21 @@ void echelonrower::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t echelonrower::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance - 1; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    return Resistance.value();
+    const pelotonmap &map = pelotonMap();
+    // out of the levels below the last one, the resistance doesn't change
+    if (pelotonResistance < map.peloton(1) || pelotonResistance > map.peloton(max_resistance - 1))
+        return Resistance.value();
+    return map.resistance(pelotonResistance);
 }
 
 resistance_t echelonrower::resistanceFromPowerRequest(uint16_t power) {
     qDebug() << QStringLiteral("resistanceFromPowerRequest") << Cadence.value();
 
-    for (resistance_t i = 1; i < max_resistance - 1; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    return Resistance.value();
+    const powersurface &surface = powerSurface();
+    // out of the levels below the last one, the resistance doesn't change
+    if (power < surface.watts(1, Cadence.value()) || power > surface.watts(max_resistance - 1, Cadence.value()))
+        return Resistance.value();
+    return surface.resistance(power, Cadence.value());
 }
 
 double echelonrower::bikeResistanceToPeloton(double resistance) {
@@ -512,10 +508,10 @@ uint16_t echelonrower::watts() {
     if (currentCadence().value() == 0) {
         return 0;
     }
-    return wattsFromResistance(Resistance.value());
+    return powerSurface().watts(Resistance.value(), currentCadence().value());
 }
 
-uint16_t echelonrower::wattsFromResistance(double resistance) {
+double echelonrower::wattsFromResistance(double resistance, double cadence) {
     // https://github.com/cagnulein/qdomyos-zwift/issues/62#issuecomment-736913564
     /*if(currentCadence().value() < 90)
         return (uint16_t)((3.59 * exp(0.0217 * (double)(currentCadence().value()))) * exp(0.095 *
@@ -569,12 +565,12 @@ uint16_t echelonrower::wattsFromResistance(double resistance) {
         level = wattTableFirstDimension - 1;
     }
     double *watts_of_level = wattTable[level];
-    int watt_setp = (Cadence.value() / 5.0);
+    int watt_setp = (cadence / 5.0);
     if (watt_setp >= 11) {
-        return (((double)Cadence.value()) / 55.0) * watts_of_level[wattTableSecondDimension - 1];
+        return (((double)cadence) / 55.0) * watts_of_level[wattTableSecondDimension - 1];
     }
     double watt_base = watts_of_level[watt_setp];
-    return (((watts_of_level[watt_setp + 1] - watt_base) / 5.0) * ((double)(((int)(Cadence.value())) % 5))) + watt_base;
+    return (((watts_of_level[watt_setp + 1] - watt_base) / 5.0) * ((double)(((int)(cadence)) % 5))) + watt_base;
 }
 
 void echelonrower::controllerStateChanged(QLowEnergyController::ControllerState state) {
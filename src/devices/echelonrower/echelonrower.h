@@ -38,14 +38,14 @@ class echelonrower : public rower {
     echelonrower(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset, double bikeResistanceGain);
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
+    double bikeResistanceToPeloton(double resistance) override;
     resistance_t maxResistance()  override{ return max_resistance; }
     bool connected() override;
 
   private:
     const resistance_t max_resistance = 32;
-    double bikeResistanceToPeloton(double resistance);
     double GetDistanceFromPacket(const QByteArray &packet);
-    uint16_t wattsFromResistance(double resistance);
     QTime GetElapsedFromPacket(const QByteArray &packet);
     void btinit();
     void writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool disable_log = false,
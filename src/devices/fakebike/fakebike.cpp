@@ -43,7 +43,7 @@ void fakebike::update() {
     else if (updcou > 6000)
         w = 80;
     Speed = metric::calculateSpeedFromPower(w, Inclination.value(),
-    Speed.value(),fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), speedLimit());
+    Speed.value(),Speed.secondsSinceLastChanged(), speedLimit());
     */
 
     if (requestPower != -1) {
@@ -56,9 +56,9 @@ void fakebike::update() {
         //         has a high inclination you have to give many power to get the desired playback speed,
         //         if inclination is very low little more power gives a quite high speed jump.
         // Speed = metric::calculateSpeedFromPower(m_watt.value(), Inclination.value(),
-        // Speed.value(),fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), speedLimit());
+        // Speed.value(),Speed.secondsSinceLastChanged(), speedLimit());
         Speed = metric::calculateSpeedFromPower(
-            m_watt.value(), 0, Speed.value(), fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0),
+            m_watt.value(), 0, Speed.value(), Speed.secondsSinceLastChanged(),
             speedLimit());
     }
     
@@ -429,7 +429,7 @@ void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characte
             } else {
                 Speed = metric::calculateSpeedFromPower(
                     watts(), Inclination.value(), Speed.value(),
-                    fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                    Speed.secondsSinceLastChanged(), this->speedLimit());
             }
             index += 2;
             qDebug() << QStringLiteral("Current Speed: ") + QString::number(Speed.value());
@@ -598,7 +598,7 @@ void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characte
             else*/
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
 
         } else if (newValue.length() == 13) {
 
@@ -626,7 +626,7 @@ void fitplusbike::characteristicChanged(const QLowEnergyCharacteristic &characte
         else
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
     }
 
     if (watts())
@@ -981,7 +981,7 @@ void fitplusbike::controllerStateChanged(QLowEnergyController::ControllerState s
     }
 }
 
-uint16_t fitplusbike::wattsFromResistance(double resistance) {
+double fitplusbike::wattsFromResistance(double resistance, double cadence) {
     // https://github.com/cagnulein/qdomyos-zwift/issues/62#issuecomment-736913564
     /*if(currentCadence().value() < 90)
         return (uint16_t)((3.59 * exp(0.0217 * (double)(currentCadence().value()))) * exp(0.095 *
@@ -1020,12 +1020,12 @@ uint16_t fitplusbike::wattsFromResistance(double resistance) {
             level = wattTableFirstDimension - 1;
         }
         double *watts_of_level = wattTable[level];
-        int watt_setp = (Cadence.value() / 10.0);
+        int watt_setp = (cadence / 10.0);
         if (watt_setp >= 10) {
-            return (((double)Cadence.value()) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
+            return (((double)cadence) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
         }
         double watt_base = watts_of_level[watt_setp];
-        return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(Cadence.value())) % 10))) +
+        return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(cadence)) % 10))) +
                watt_base;
     } else {
         // VirtuFit Etappe 2.0i Spinbike ERG Table #1526
@@ -1066,12 +1066,12 @@ uint16_t fitplusbike::wattsFromResistance(double resistance) {
             level = wattTableFirstDimension - 1;
         }
         double *watts_of_level = wattTable[level];
-        int watt_setp = (Cadence.value() / 10.0);
+        int watt_setp = (cadence / 10.0);
         if (watt_setp >= 10) {
-            return (((double)Cadence.value()) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
+            return (((double)cadence) / 100.0) * watts_of_level[wattTableSecondDimension - 1];
         }
         double watt_base = watts_of_level[watt_setp];
-        return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(Cadence.value())) % 10))) +
+        return (((watts_of_level[watt_setp + 1] - watt_base) / 10.0) * ((double)(((int)(cadence)) % 10))) +
                watt_base;
     }
 }
@@ -1082,15 +1082,5 @@ resistance_t fitplusbike::resistanceFromPowerRequest(uint16_t power) {
     if (Cadence.value() == 0)
         return 1;
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
 }
@@ -40,6 +40,7 @@ class fitplusbike : public bike {
     resistance_t maxResistance() override { return max_resistance; }
     bool connected() override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
 
   private:
     resistance_t max_resistance = 24;
@@ -50,7 +51,6 @@ class fitplusbike : public bike {
     void forceResistance(resistance_t requestResistance);
     void sendPoll();
     uint16_t watts() override;
-    uint16_t wattsFromResistance(double resistance);
 
     QTimer *refresh;
 
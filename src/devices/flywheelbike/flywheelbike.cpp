@@ -294,7 +294,7 @@ void flywheelbike::characteristicChanged(const QLowEnergyCharacteristic &charact
                 } else {
                     Speed = metric::calculateSpeedFromPower(
                         watts(), Inclination.value(), Speed.value(),
-                        fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                        Speed.secondsSinceLastChanged(), this->speedLimit());
                 }
 
                 // https://www.facebook.com/groups/149984563348738/permalink/174268944253633/?comment_id=174366620910532&reply_comment_id=174666314213896
@@ -1,4 +1,6 @@
 #include "ftmsbike.h"
+#include "devices/ftmsdecoder.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -96,9 +98,9 @@ void ftmsbike::forcePower(int16_t requestPower) {
     powerForced = true;
 }
 
-uint16_t ftmsbike::wattsFromResistance(double resistance) {
+double ftmsbike::wattsFromResistance(double resistance, double cadence) {
     if(DU30_bike) {
-        double y = 1.46193548 * Cadence.value() + 0.0000887836638 * Cadence.value() * resistance + 0.000625 * resistance * resistance + 0.0580645161 * Cadence.value() + 0.00292986091 * resistance + 6.48448135542904;
+        double y = 1.46193548 * cadence + 0.0000887836638 * cadence * resistance + 0.000625 * resistance * resistance + 0.0580645161 * cadence + 0.00292986091 * resistance + 6.48448135542904;
         return y;
     }
     return 1;
@@ -110,17 +112,7 @@ resistance_t ftmsbike::resistanceFromPowerRequest(uint16_t power) {
     if (Cadence.value() == 0)
         return 1;
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
 }
 
 void ftmsbike::forceResistance(resistance_t requestResistance) {
@@ -227,11 +219,8 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
     QDateTime now = QDateTime::currentDateTime();
     // qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
-    QSettings settings;
-    QString heartRateBeltName =
-        settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
-    bool disable_hr_frommachinery =
-        settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool disable_hr_frommachinery = settings.heart_ignore_builtin;
     bool heart = false;
 
     qDebug() << characteristic.uuid() << newValue.length() << QStringLiteral(" << ") << newValue.toHex(' ');
@@ -246,101 +235,35 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
         return;
     }
 
-    if (characteristic.uuid() == QBluetoothUuid((quint16)0x2AD2)) {
-
-        union flags {
-            struct {
-                uint16_t moreData : 1;
-                uint16_t avgSpeed : 1;
-                uint16_t instantCadence : 1;
-                uint16_t avgCadence : 1;
-                uint16_t totDistance : 1;
-                uint16_t resistanceLvl : 1;
-                uint16_t instantPower : 1;
-                uint16_t avgPower : 1;
-                uint16_t expEnergy : 1;
-                uint16_t heartRate : 1;
-                uint16_t metabolic : 1;
-                uint16_t elapsedTime : 1;
-                uint16_t remainingTime : 1;
-                uint16_t spare : 3;
-            };
-
-            uint16_t word_flags;
-        };
-
-        flags Flags;
-        int index = 0;
-        Flags.word_flags = (newValue.at(1) << 8) | newValue.at(0);
-        index += 2;
-
-        if (!Flags.moreData) {
-            if (!settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
-                Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                  (uint16_t)((uint8_t)newValue.at(index)))) /
-                        100.0;
+    ftmsdecoder::data ftms;
+    if (!ftmsdecoder::decode(characteristic.uuid(), newValue, ftms) ||
+        (ftms.type != ftmsdecoder::IndoorBikeData && ftms.type != ftmsdecoder::CrossTrainerData)) {
+        return;
+    }
+
+    if (ftms.type == ftmsdecoder::IndoorBikeData) {
+
+        if (ftms.has(ftmsdecoder::InstantSpeed)) {
+            if (!settings.speed_power_based) {
+                Speed = ftms.value(ftmsdecoder::InstantSpeed);
             } else {
                 Speed = metric::calculateSpeedFromPower(
                     watts(), Inclination.value(), Speed.value(),
-                    fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                    Speed.secondsSinceLastChanged(), this->speedLimit());
             }
-            index += 2;
-            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
-        }
-
-        if (Flags.avgSpeed) {
-            double avgSpeed;
-            avgSpeed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index)))) /
-                       100.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Average Speed: ") + QString::number(avgSpeed));
-        }
-
-        if (Flags.instantCadence) {
-            if (settings.value(QZSettings::cadence_sensor_name, QZSettings::default_cadence_sensor_name)
-                    .toString()
-                    .startsWith(QStringLiteral("Disabled"))) {
-                Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                    (uint16_t)((uint8_t)newValue.at(index)))) /
-                          2.0;
-            }
-            index += 2;
-            emit debug(QStringLiteral("Current Cadence: ") + QString::number(Cadence.value()));
-        }
-
-        if (Flags.avgCadence) {
-            double avgCadence;
-            avgCadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index)))) /
-                         2.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Average Cadence: ") + QString::number(avgCadence));
         }
 
-        if (Flags.totDistance) {
-
-            /*
-             * the distance sent from the most trainers is a total distance, so it's useless for QZ
-             *
-            Distance = ((double)((((uint32_t)((uint8_t)newValue.at(index + 2)) << 16) |
-                                  (uint32_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint32_t)((uint8_t)newValue.at(index)))) /
-                       1000.0;*/
-            index += 3;
+        if (ftms.has(ftmsdecoder::InstantCadence) && settings.cadence_sensor_disabled) {
+            Cadence = ftms.value(ftmsdecoder::InstantCadence);
         }
 
+        // the distance sent from the most trainers is a total distance, so it's useless for QZ
         Distance += ((Speed.value() / 3600000.0) *
                      ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
 
-        emit debug(QStringLiteral("Current Distance: ") + QString::number(Distance.value()));
-
-        if (Flags.resistanceLvl) {
-            Resistance = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
+        if (ftms.has(ftmsdecoder::ResistanceLevel)) {
+            Resistance = ftms.rawValue(ftmsdecoder::ResistanceLevel);
             emit resistanceRead(Resistance.value());
-            index += 2;
-            emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
             resistance_received = true;
         }
             double ac = 0.01243107769;
@@ -358,186 +281,70 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
                                                       (ac * pow(Cadence.value(), 2.0) + bc * Cadence.value() + cc)))) -
                        br) /
                       (2.0 * ar)) *
-                     settings.value(QZSettings::peloton_gain, QZSettings::default_peloton_gain).toDouble()) +
-                    settings.value(QZSettings::peloton_offset, QZSettings::default_peloton_offset).toDouble();
+                     settings.peloton_gain) +
+                    settings.peloton_offset;
                 if (!resistance_received && !DU30_bike) {
                     Resistance = m_pelotonResistance;
                     emit resistanceRead(Resistance.value());
-                    emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
                 }
             }
    
 
-        if (Flags.instantPower) {
+        if (ftms.has(ftmsdecoder::InstantPower)) {
             // power table from an user
             if(DU30_bike) {
-                m_watt = wattsFromResistance(Resistance.value());
-            } else if (settings.value(QZSettings::power_sensor_name, QZSettings::default_power_sensor_name)
-                    .toString()
-                    .startsWith(QStringLiteral("Disabled")))
-                m_watt = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-            emit debug(QStringLiteral("Current Watt: ") + QString::number(m_watt.value()));
+                m_watt = powerSurface().watts(Resistance.value(), Cadence.value());
+            } else if (settings.power_sensor_disabled)
+                m_watt = ftms.rawValue(ftmsdecoder::InstantPower);
         }
 
-        if (Flags.avgPower && newValue.length() > index + 1) {
-            double avgPower;
-            avgPower = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-            emit debug(QStringLiteral("Current Average Watt: ") + QString::number(avgPower));
-        }
-
-        if (Flags.expEnergy && newValue.length() > index + 1) {
-            KCal = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                             (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-
-            // energy per hour
-            index += 2;
-
-            // energy per minute
-            index += 1;
+        if (ftms.has(ftmsdecoder::TotalEnergy)) {
+            KCal = ftms.rawValue(ftmsdecoder::TotalEnergy);
         } else {
             if (watts())
-                KCal += ((((0.048 * ((double)watts()) + 1.19) *
-                           settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                          200.0) /
+                KCal += ((((0.048 * ((double)watts()) + 1.19) * settings.weight * 3.5) / 200.0) /
                          (60000.0 /
                           ((double)lastRefreshCharacteristicChanged.msecsTo(
                               now)))); //(( (0.048* Output in watts +1.19) * body weight in
                                                                 // kg * 3.5) / 200 ) / 60
         }
 
-        emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
-
 #ifdef Q_OS_ANDROID
-        if (settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool())
+        if (settings.ant_heart)
             Heart = (uint8_t)KeepAwakeHelper::heart();
         else
 #endif
         {
-            if (Flags.heartRate && !disable_hr_frommachinery && newValue.length() > index) {
-                Heart = ((double)(((uint8_t)newValue.at(index))));
-                // index += 1; // NOTE: clang-analyzer-deadcode.DeadStores
-                emit debug(QStringLiteral("Current Heart: ") + QString::number(Heart.value()));
-            } else {
-                Flags.heartRate = false;
+            heart = ftms.has(ftmsdecoder::HeartRate) && !disable_hr_frommachinery;
+            if (heart) {
+                Heart = ftms.rawValue(ftmsdecoder::HeartRate);
             }
-            heart = Flags.heartRate;
-        }
-
-        if (Flags.metabolic) {
-            // todo
-        }
-
-        if (Flags.elapsedTime) {
-            // todo
-        }
-
-        if (Flags.remainingTime) {
-            // todo
         }
-    } else if (characteristic.uuid() == QBluetoothUuid((quint16)0x2ACE)) {
-        union flags {
-            struct {
-                uint32_t moreData : 1;
-                uint32_t avgSpeed : 1;
-                uint32_t totDistance : 1;
-                uint32_t stepCount : 1;
-                uint32_t strideCount : 1;
-                uint32_t elevationGain : 1;
-                uint32_t rampAngle : 1;
-                uint32_t resistanceLvl : 1;
-                uint32_t instantPower : 1;
-                uint32_t avgPower : 1;
-                uint32_t expEnergy : 1;
-                uint32_t heartRate : 1;
-                uint32_t metabolicEq : 1;
-                uint32_t elapsedTime : 1;
-                uint32_t remainingTime : 1;
-                uint32_t movementDirection : 1;
-                uint32_t spare : 8;
-            };
-
-            uint32_t word_flags;
-        };
-
-        flags Flags;
-        int index = 0;
-        Flags.word_flags = (newValue.at(2) << 16) | (newValue.at(1) << 8) | newValue.at(0);
-        index += 3;
-
-        if (!Flags.moreData) {
-            if (!settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
-                Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                  (uint16_t)((uint8_t)newValue.at(index)))) /
-                        100.0;
+    } else {
+        if (ftms.has(ftmsdecoder::InstantSpeed)) {
+            if (!settings.speed_power_based) {
+                Speed = ftms.value(ftmsdecoder::InstantSpeed);
             } else {
                 Speed = metric::calculateSpeedFromPower(
                     watts(), Inclination.value(), Speed.value(),
-                    fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                    Speed.secondsSinceLastChanged(), this->speedLimit());
             }
-            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
-            index += 2;
-        }
-
-        if (Flags.avgSpeed) {
-            double avgSpeed;
-            avgSpeed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index)))) /
-                       100.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Average Speed: ") + QString::number(avgSpeed));
         }
 
-        if (Flags.totDistance) {
-            Distance = ((double)((((uint32_t)((uint8_t)newValue.at(index + 2)) << 16) |
-                                  (uint32_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint32_t)((uint8_t)newValue.at(index)))) /
-                       1000.0;
-            index += 3;
+        if (ftms.has(ftmsdecoder::TotalDistance)) {
+            Distance = ftms.rawValue(ftmsdecoder::TotalDistance) / 1000.0;
         } else {
             Distance += ((Speed.value() / 3600000.0) *
                          ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
         }
 
-        emit debug(QStringLiteral("Current Distance: ") + QString::number(Distance.value()));
-
-        if (Flags.stepCount) {
-            if (settings.value(QZSettings::cadence_sensor_name, QZSettings::default_cadence_sensor_name)
-                    .toString()
-                    .startsWith(QStringLiteral("Disabled"))) {
-                Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                    (uint16_t)((uint8_t)newValue.at(index))));
-            }
-            emit debug(QStringLiteral("Current Cadence: ") + QString::number(Cadence.value()));
-
-            index += 2;
-            index += 2;
-        }
-
-        if (Flags.strideCount) {
-            index += 2;
-        }
-
-        if (Flags.elevationGain) {
-            index += 2;
-            index += 2;
+        if (ftms.has(ftmsdecoder::StepRate) && settings.cadence_sensor_disabled) {
+            Cadence = ftms.rawValue(ftmsdecoder::StepRate);
         }
 
-        if (Flags.rampAngle) {
-            index += 2;
-            index += 2;
-        }
-
-        if (Flags.resistanceLvl) {
-            Resistance = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
+        if (ftms.has(ftmsdecoder::ResistanceLevel)) {
+            Resistance = ftms.rawValue(ftmsdecoder::ResistanceLevel);
             emit resistanceRead(Resistance.value());
-            index += 2;
-            emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
         } else if(!DU30_bike) {
             double ac = 0.01243107769;
             double bc = 1.145964912;
@@ -554,83 +361,50 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
                                                       (ac * pow(Cadence.value(), 2.0) + bc * Cadence.value() + cc)))) -
                        br) /
                       (2.0 * ar)) *
-                     settings.value(QZSettings::peloton_gain, QZSettings::default_peloton_gain).toDouble()) +
-                    settings.value(QZSettings::peloton_offset, QZSettings::default_peloton_offset).toDouble();
+                     settings.peloton_gain) +
+                    settings.peloton_offset;
                 Resistance = m_pelotonResistance;
                 emit resistanceRead(Resistance.value());
             }
         }
 
-        if (Flags.instantPower) {
-            if (settings.value(QZSettings::power_sensor_name, QZSettings::default_power_sensor_name)
-                    .toString()
-                    .startsWith(QStringLiteral("Disabled")))
-                m_watt = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
-            emit debug(QStringLiteral("Current Watt: ") + QString::number(m_watt.value()));
-            index += 2;
-        }
-
-        if (Flags.avgPower && newValue.length() > index + 1) {
-            double avgPower;
-            avgPower = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index))));
-            emit debug(QStringLiteral("Current Average Watt: ") + QString::number(avgPower));
-            index += 2;
+        if (ftms.has(ftmsdecoder::InstantPower) && settings.power_sensor_disabled) {
+            m_watt = ftms.rawValue(ftmsdecoder::InstantPower);
         }
 
-        if (Flags.expEnergy && newValue.length() > index + 1) {
-            KCal = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                             (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-
-            // energy per hour
-            index += 2;
-
-            // energy per minute
-            index += 1;
+        if (ftms.has(ftmsdecoder::TotalEnergy)) {
+            KCal = ftms.rawValue(ftmsdecoder::TotalEnergy);
         } else {
             if (watts())
-                KCal += ((((0.048 * ((double)watts()) + 1.19) *
-                           settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                          200.0) /
+                KCal += ((((0.048 * ((double)watts()) + 1.19) * settings.weight * 3.5) / 200.0) /
                          (60000.0 /
                           ((double)lastRefreshCharacteristicChanged.msecsTo(
                               now)))); //(( (0.048* Output in watts +1.19) * body weight in
                                                                 // kg * 3.5) / 200 ) / 60
         }
 
-        emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
-
 #ifdef Q_OS_ANDROID
-        if (settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool())
+        if (settings.ant_heart)
             Heart = (uint8_t)KeepAwakeHelper::heart();
         else
 #endif
         {
-            if (Flags.heartRate && !disable_hr_frommachinery && newValue.length() > index) {
-                Heart = ((double)(((uint8_t)newValue.at(index))));
-                // index += 1; // NOTE: clang-analyzer-deadcode.DeadStores
-                emit debug(QStringLiteral("Current Heart: ") + QString::number(Heart.value()));
-            } else {
-                Flags.heartRate = false;
+            heart = ftms.has(ftmsdecoder::HeartRate) && !disable_hr_frommachinery;
+            if (heart) {
+                Heart = ftms.rawValue(ftmsdecoder::HeartRate);
             }
-            heart = Flags.heartRate;
-        }
-
-        if (Flags.metabolicEq) {
-            // todo
-        }
-
-        if (Flags.elapsedTime) {
-            // todo
         }
+    }
 
-        if (Flags.remainingTime) {
-            // todo
-        }
-    } else {
-        return;
+    // the debug text is only built when it's going to be logged
+    if (settings.log_debug) {
+        emit debug(ftmsdecoder::toString(ftms));
+        emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()) +
+                   QStringLiteral(" Cadence: ") + QString::number(Cadence.value()) +
+                   QStringLiteral(" Resistance: ") + QString::number(Resistance.value()) +
+                   QStringLiteral(" Watt: ") + QString::number(m_watt.value()) + QStringLiteral(" Distance: ") +
+                   QString::number(Distance.value()) + QStringLiteral(" KCal: ") + QString::number(KCal.value()) +
+                   QStringLiteral(" Heart: ") + QString::number(Heart.value()));
     }
 
     if (Cadence.value() > 0) {
@@ -640,16 +414,14 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
 
     lastRefreshCharacteristicChanged = now;
 
-    if (heartRateBeltName.startsWith(QStringLiteral("Disabled")) &&
-        (!heart || Heart.value() == 0 || disable_hr_frommachinery)) {
+    if (settings.heart_rate_belt_disabled && (!heart || Heart.value() == 0 || disable_hr_frommachinery)) {
         update_hr_from_external();
     }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-    bool cadence = settings.value(QZSettings::bike_cadence_sensor, QZSettings::default_bike_cadence_sensor).toBool();
-    bool ios_peloton_workaround =
-        settings.value(QZSettings::ios_peloton_workaround, QZSettings::default_ios_peloton_workaround).toBool();
+    bool cadence = settings.bike_cadence_sensor;
+    bool ios_peloton_workaround = settings.ios_peloton_workaround;
     if (ios_peloton_workaround && cadence && h && firstStateChanged) {
         h->virtualbike_setCadence(currentCrankRevolutions(), lastCrankEventTime());
         h->virtualbike_setHeartRate((uint8_t)metrics_override_heartrate());
@@ -657,8 +429,10 @@ void ftmsbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
 #endif
 #endif
 
-    emit debug(QStringLiteral("Current CrankRevs: ") + QString::number(CrankRevs));
-    emit debug(QStringLiteral("Last CrankEventTime: ") + QString::number(LastCrankEventTime));
+    if (settings.log_debug) {
+        emit debug(QStringLiteral("Current CrankRevs: ") + QString::number(CrankRevs));
+        emit debug(QStringLiteral("Last CrankEventTime: ") + QString::number(LastCrankEventTime));
+    }
 
     if (m_control->error() != QLowEnergyController::NoError) {
         qDebug() << QStringLiteral("QLowEnergyController ERROR!!") << m_control->errorString();
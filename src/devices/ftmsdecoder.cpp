@@ -0,0 +1,237 @@
+#include "ftmsdecoder.h"
+
+#include <cstring>
+
+namespace {
+
+// one field of a characteristic: decoded when the flag bit is set (clear, for the "more data" bit)
+struct entry {
+    quint8 bit;
+    bool inverted;
+    ftmsdecoder::field field;
+    // bytes of the field, negative when the field is signed
+    qint8 size;
+    double resolution;
+};
+
+struct layout {
+    int flagBytes;
+    const entry *entries;
+    int count;
+};
+
+// the fields of each characteristic in the order of the FTMS specification
+const entry indoorBikeData[] = {
+    {0, true, ftmsdecoder::InstantSpeed, 2, 0.01},
+    {1, false, ftmsdecoder::AverageSpeed, 2, 0.01},
+    {2, false, ftmsdecoder::InstantCadence, 2, 0.5},
+    {3, false, ftmsdecoder::AverageCadence, 2, 0.5},
+    {4, false, ftmsdecoder::TotalDistance, 3, 1.0},
+    {5, false, ftmsdecoder::ResistanceLevel, -2, 1.0},
+    {6, false, ftmsdecoder::InstantPower, -2, 1.0},
+    {7, false, ftmsdecoder::AveragePower, -2, 1.0},
+    {8, false, ftmsdecoder::TotalEnergy, 2, 1.0},
+    {8, false, ftmsdecoder::EnergyPerHour, 2, 1.0},
+    {8, false, ftmsdecoder::EnergyPerMinute, 1, 1.0},
+    {9, false, ftmsdecoder::HeartRate, 1, 1.0},
+    {10, false, ftmsdecoder::MetabolicEquivalent, 1, 0.1},
+    {11, false, ftmsdecoder::ElapsedTime, 2, 1.0},
+    {12, false, ftmsdecoder::RemainingTime, 2, 1.0},
+};
+
+const entry treadmillData[] = {
+    {0, true, ftmsdecoder::InstantSpeed, 2, 0.01},
+    {1, false, ftmsdecoder::AverageSpeed, 2, 0.01},
+    {2, false, ftmsdecoder::TotalDistance, 3, 1.0},
+    {3, false, ftmsdecoder::Inclination, -2, 0.1},
+    {3, false, ftmsdecoder::RampAngle, -2, 0.1},
+    {4, false, ftmsdecoder::PositiveElevationGain, 2, 0.1},
+    {4, false, ftmsdecoder::NegativeElevationGain, 2, 0.1},
+    {5, false, ftmsdecoder::InstantPace, 1, 0.1},
+    {6, false, ftmsdecoder::AveragePace, 1, 0.1},
+    {7, false, ftmsdecoder::TotalEnergy, 2, 1.0},
+    {7, false, ftmsdecoder::EnergyPerHour, 2, 1.0},
+    {7, false, ftmsdecoder::EnergyPerMinute, 1, 1.0},
+    {8, false, ftmsdecoder::HeartRate, 1, 1.0},
+    {9, false, ftmsdecoder::MetabolicEquivalent, 1, 0.1},
+    {10, false, ftmsdecoder::ElapsedTime, 2, 1.0},
+    {11, false, ftmsdecoder::RemainingTime, 2, 1.0},
+    {12, false, ftmsdecoder::ForceOnBelt, -2, 1.0},
+    {12, false, ftmsdecoder::PowerOutput, -2, 1.0},
+};
+
+const entry rowerData[] = {
+    {0, true, ftmsdecoder::StrokeRate, 1, 0.5},
+    {0, true, ftmsdecoder::StrokeCount, 2, 1.0},
+    {1, false, ftmsdecoder::AverageStrokeRate, 1, 0.5},
+    {2, false, ftmsdecoder::TotalDistance, 3, 1.0},
+    {3, false, ftmsdecoder::InstantPace, 2, 1.0},
+    {4, false, ftmsdecoder::AveragePace, 2, 1.0},
+    {5, false, ftmsdecoder::InstantPower, -2, 1.0},
+    {6, false, ftmsdecoder::AveragePower, -2, 1.0},
+    {7, false, ftmsdecoder::ResistanceLevel, -2, 1.0},
+    {8, false, ftmsdecoder::TotalEnergy, 2, 1.0},
+    {8, false, ftmsdecoder::EnergyPerHour, 2, 1.0},
+    {8, false, ftmsdecoder::EnergyPerMinute, 1, 1.0},
+    {9, false, ftmsdecoder::HeartRate, 1, 1.0},
+    {10, false, ftmsdecoder::MetabolicEquivalent, 1, 0.1},
+    {11, false, ftmsdecoder::ElapsedTime, 2, 1.0},
+    {12, false, ftmsdecoder::RemainingTime, 2, 1.0},
+};
+
+// bit 15 (movement direction) has no field
+const entry crossTrainerData[] = {
+    {0, true, ftmsdecoder::InstantSpeed, 2, 0.01},
+    {1, false, ftmsdecoder::AverageSpeed, 2, 0.01},
+    {2, false, ftmsdecoder::TotalDistance, 3, 1.0},
+    {3, false, ftmsdecoder::StepRate, 2, 1.0},
+    {3, false, ftmsdecoder::AverageStepRate, 2, 1.0},
+    {4, false, ftmsdecoder::StrideCount, 2, 0.1},
+    {5, false, ftmsdecoder::PositiveElevationGain, 2, 1.0},
+    {5, false, ftmsdecoder::NegativeElevationGain, 2, 1.0},
+    {6, false, ftmsdecoder::Inclination, -2, 0.1},
+    {6, false, ftmsdecoder::RampAngle, -2, 0.1},
+    {7, false, ftmsdecoder::ResistanceLevel, -2, 0.1},
+    {8, false, ftmsdecoder::InstantPower, -2, 1.0},
+    {9, false, ftmsdecoder::AveragePower, -2, 1.0},
+    {10, false, ftmsdecoder::TotalEnergy, 2, 1.0},
+    {10, false, ftmsdecoder::EnergyPerHour, 2, 1.0},
+    {10, false, ftmsdecoder::EnergyPerMinute, 1, 1.0},
+    {11, false, ftmsdecoder::HeartRate, 1, 1.0},
+    {12, false, ftmsdecoder::MetabolicEquivalent, 1, 0.1},
+    {13, false, ftmsdecoder::ElapsedTime, 2, 1.0},
+    {14, false, ftmsdecoder::RemainingTime, 2, 1.0},
+};
+
+const layout layouts[ftmsdecoder::CharacteristicCount] = {
+    {2, indoorBikeData, sizeof(indoorBikeData) / sizeof(entry)},
+    {2, treadmillData, sizeof(treadmillData) / sizeof(entry)},
+    {2, rowerData, sizeof(rowerData) / sizeof(entry)},
+    {3, crossTrainerData, sizeof(crossTrainerData) / sizeof(entry)},
+};
+
+const char *const fieldNames[ftmsdecoder::FieldCount] = {
+    "Speed",
+    "Average Speed",
+    "Cadence",
+    "Average Cadence",
+    "Distance",
+    "Resistance",
+    "Watt",
+    "Average Watt",
+    "KCal",
+    "KCal per hour",
+    "KCal per minute",
+    "Heart",
+    "METs",
+    "Elapsed Time",
+    "Remaining Time",
+    "Inclination",
+    "Ramp Angle",
+    "Elevation Gain",
+    "Elevation Loss",
+    "Pace",
+    "Average Pace",
+    "Stroke Rate",
+    "Strokes Count",
+    "Average Stroke Rate",
+    "Step Rate",
+    "Average Step Rate",
+    "Stride Count",
+    "Force on Belt",
+    "Power Output",
+};
+
+} // namespace
+
+bool ftmsdecoder::decode(characteristic type, const char *bytes, int length, data &out) {
+    memset(&out, 0, sizeof(out));
+    out.type = type;
+    if (type >= CharacteristicCount)
+        return false;
+    const layout &l = layouts[type];
+    if (length < l.flagBytes)
+        return false;
+
+    const quint8 *p = reinterpret_cast<const quint8 *>(bytes);
+    quint32 flags = 0;
+    for (int i = 0; i < l.flagBytes; i++)
+        flags |= ((quint32)p[i]) << (8 * i);
+    out.flags = flags;
+
+    int index = l.flagBytes;
+    for (int i = 0; i < l.count; i++) {
+        const entry &e = l.entries[i];
+        if ((((flags >> e.bit) & 1) != 0) == e.inverted)
+            continue;
+        const int size = e.size < 0 ? -e.size : e.size;
+        if (index + size > length) {
+            out.truncated = true;
+            break;
+        }
+        quint32 v = 0;
+        for (int b = 0; b < size; b++)
+            v |= ((quint32)p[index + b]) << (8 * b);
+        if (e.size < 0 && (v & (1u << (8 * size - 1))))
+            v |= ~0u << (8 * size);
+        out.raw[e.field] = (qint32)v;
+        out.present |= 1u << e.field;
+        index += size;
+    }
+    out.length = (quint16)index;
+    return true;
+}
+
+ftmsdecoder::characteristic ftmsdecoder::fromUuid(const QBluetoothUuid &uuid) {
+    bool ok = false;
+    switch (uuid.toUInt16(&ok)) {
+    case 0x2AD2:
+        return ok ? IndoorBikeData : CharacteristicCount;
+    case 0x2ACD:
+        return ok ? TreadmillData : CharacteristicCount;
+    case 0x2AD1:
+        return ok ? RowerData : CharacteristicCount;
+    case 0x2ACE:
+        return ok ? CrossTrainerData : CharacteristicCount;
+    default:
+        return CharacteristicCount;
+    }
+}
+
+bool ftmsdecoder::decode(const QBluetoothUuid &uuid, const QByteArray &value, data &out) {
+    return decode(fromUuid(uuid), value.constData(), value.length(), out);
+}
+
+double ftmsdecoder::resolution(characteristic type, field f) {
+    // folded once from the tables above, so value() is a lookup
+    struct resolutions {
+        double v[CharacteristicCount][FieldCount];
+        resolutions() {
+            for (int t = 0; t < CharacteristicCount; t++) {
+                for (int k = 0; k < FieldCount; k++)
+                    v[t][k] = 1.0;
+                for (int i = 0; i < layouts[t].count; i++)
+                    v[t][layouts[t].entries[i].field] = layouts[t].entries[i].resolution;
+            }
+        }
+    };
+    static const resolutions table;
+    if (type >= CharacteristicCount || f >= FieldCount)
+        return 1.0;
+    return table.v[type][f];
+}
+
+const char *ftmsdecoder::fieldName(field f) { return f < FieldCount ? fieldNames[f] : ""; }
+
+QString ftmsdecoder::toString(const data &d) {
+    QString s = QStringLiteral("flags 0x") + QString::number(d.flags, 16);
+    for (int f = 0; f < FieldCount; f++) {
+        if (!d.has((field)f))
+            continue;
+        s += QStringLiteral(", ") + QLatin1String(fieldName((field)f)) + QStringLiteral(": ") +
+             QString::number(d.value((field)f));
+    }
+    if (d.truncated)
+        s += QStringLiteral(", truncated after ") + QString::number(d.length) + QStringLiteral(" bytes");
+    return s;
+}
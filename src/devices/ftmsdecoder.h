@@ -0,0 +1,105 @@
+#ifndef FTMSDECODER_H
+#define FTMSDECODER_H
+
+#include <QBluetoothUuid>
+#include <QByteArray>
+#include <QString>
+#include <QtGlobal>
+
+/**
+ * @brief Decoder of the FTMS data characteristics: Indoor Bike Data (0x2AD2), Treadmill Data (0x2ACD),
+ * Rower Data (0x2AD1) and Cross Trainer Data (0x2ACE).
+ * Each characteristic is described by a table of (flag bit, field, size) in the order of the specification, so a
+ * packet is decoded by a single walk of the table into a fixed size data struct: no allocation, no QVariant, no
+ * string. The text of the decoded packet, for the debug log, is only built by toString() when asked for.
+ * A field is present only if its flag is set and all its bytes are in the packet: a truncated packet keeps the
+ * fields decoded before the missing bytes.
+ */
+class ftmsdecoder {
+  public:
+    enum characteristic : quint8 { IndoorBikeData, TreadmillData, RowerData, CrossTrainerData, CharacteristicCount };
+
+    enum field : quint8 {
+        InstantSpeed,
+        AverageSpeed,
+        InstantCadence,
+        AverageCadence,
+        TotalDistance,
+        ResistanceLevel,
+        InstantPower,
+        AveragePower,
+        TotalEnergy,
+        EnergyPerHour,
+        EnergyPerMinute,
+        HeartRate,
+        MetabolicEquivalent,
+        ElapsedTime,
+        RemainingTime,
+        Inclination,
+        RampAngle,
+        PositiveElevationGain,
+        NegativeElevationGain,
+        InstantPace,
+        AveragePace,
+        StrokeRate,
+        StrokeCount,
+        AverageStrokeRate,
+        StepRate,
+        AverageStepRate,
+        StrideCount,
+        ForceOnBelt,
+        PowerOutput,
+        FieldCount
+    };
+
+    /**
+     * @brief A decoded packet. Plain data: it can live on the stack and be copied with memcpy.
+     */
+    struct data {
+        characteristic type;
+        // the flags of the packet, 16 bits (24 bits for the cross trainer)
+        quint32 flags;
+        // one bit per field (1 << field)
+        quint32 present;
+        // bytes of the packet used by the flags and the decoded fields
+        quint16 length;
+        // a flagged field didn't fit in the packet
+        bool truncated;
+        // the integer sent by the device, sign extended; 0 when the field isn't present
+        qint32 raw[FieldCount];
+
+        bool has(field f) const { return present & (1u << f); }
+        qint32 rawValue(field f) const { return raw[f]; }
+        /**
+         * @brief The value in the unit of the specification (km/h, rpm, m, W, kcal, bpm, s, %, ...).
+         */
+        double value(field f) const { return raw[f] * resolution(type, f); }
+    };
+
+    /**
+     * @brief Decodes a packet of the characteristic specified.
+     * @return false if the packet is too short for the flags.
+     */
+    static bool decode(characteristic type, const char *bytes, int length, data &out);
+
+    /**
+     * @brief Decodes the value of a FTMS data characteristic.
+     * @return false if the uuid isn't one of the FTMS data characteristics or the value is too short for the flags.
+     */
+    static bool decode(const QBluetoothUuid &uuid, const QByteArray &value, data &out);
+
+    /**
+     * @brief The characteristic of the uuid specified, CharacteristicCount if it isn't a FTMS data characteristic.
+     */
+    static characteristic fromUuid(const QBluetoothUuid &uuid);
+
+    static double resolution(characteristic type, field f);
+    static const char *fieldName(field f);
+
+    /**
+     * @brief The decoded fields as a single line for the debug log.
+     */
+    static QString toString(const data &d);
+};
+
+#endif // FTMSDECODER_H
@@ -1,5 +1,7 @@
 #include "devices/ftmsrower/ftmsrower.h"
 #include "devices/ftmsbike/ftmsbike.h"
+#include "devices/ftmsdecoder.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -140,51 +142,23 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
     // qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
-    QSettings settings;
-    bool disable_hr_frommachinery =
-        settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool();
-    QString heartRateBeltName =
-        settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool disable_hr_frommachinery = settings.heart_ignore_builtin;
 
     qDebug() << QStringLiteral(" << ") << characteristic.uuid() << " " << newValue.toHex(' ');
 
-    if (characteristic.uuid() != QBluetoothUuid((quint16)0x2AD1)) {
+    ftmsdecoder::data ftms;
+    if (!ftmsdecoder::decode(characteristic.uuid(), newValue, ftms) || ftms.type != ftmsdecoder::RowerData) {
         return;
     }
 
     lastPacket = newValue;
 
-    union flags {
-        struct {
-
-            uint16_t moreData : 1;
-            uint16_t avgStroke : 1;
-            uint16_t totDistance : 1;
-            uint16_t instantPace : 1;
-            uint16_t avgPace : 1;
-            uint16_t instantPower : 1;
-            uint16_t avgPower : 1;
-            uint16_t resistanceLvl : 1;
-            uint16_t expEnergy : 1;
-            uint16_t heartRate : 1;
-            uint16_t metabolic : 1;
-            uint16_t elapsedTime : 1;
-            uint16_t remainingTime : 1;
-            uint16_t spare : 3;
-        };
-
-        uint16_t word_flags;
-    };
-
-    flags Flags;
-    int index = 0;
     double cadence_divider = 2.0;
     if (WHIPR || KINGSMITH)
         cadence_divider = 1.0;
-    Flags.word_flags = (newValue.at(1) << 8) | newValue.at(0);
-    index += 2;
 
-    if (!Flags.moreData) {
+    if (ftms.has(ftmsdecoder::StrokeCount)) {
 
         if (lastStroke.secsTo(now) > 3) {
             qDebug() << "Resetting cadence!";
@@ -192,155 +166,74 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
             m_watt = 0;
             Speed = 0;
         } else {
-            Cadence = ((uint8_t)newValue.at(index)) / cadence_divider;
+            Cadence = ftms.rawValue(ftmsdecoder::StrokeRate) / cadence_divider;
         }
 
-        StrokesCount =
-            (((uint16_t)((uint8_t)newValue.at(index + 2)) << 8) | (uint16_t)((uint8_t)newValue.at(index + 1)));
+        StrokesCount = ftms.rawValue(ftmsdecoder::StrokeCount);
 
         if (lastStrokesCount != StrokesCount.value()) {
             lastStroke = now;
         }
         lastStrokesCount = StrokesCount.value();
 
-        index += 3;
-
         /*
          * the concept 2 sends the pace in 2 frames, so this condition will create a bogus speed
-        if (!Flags.instantPace) {
+        if (!ftms.has(ftmsdecoder::InstantPace)) {
             // eredited by echelon rower, probably we need to change this
             Speed = (0.37497622 * ((double)Cadence.value())) / 2.0;
-            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
         }*/
-        emit debug(QStringLiteral("Strokes Count: ") + QString::number(StrokesCount.value()));
-    }
-
-    if (Flags.avgStroke) {
-
-        double avgStroke;
-        avgStroke = ((double)(uint16_t)((uint8_t)newValue.at(index))) / cadence_divider;
-        index += 1;
-        emit debug(QStringLiteral("Current Average Stroke: ") + QString::number(avgStroke));
     }
 
-    if (Flags.totDistance) {
-        Distance = ((double)((((uint32_t)((uint8_t)newValue.at(index + 2)) << 16) |
-                              (uint32_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                             (uint32_t)((uint8_t)newValue.at(index)))) /
-                   1000.0;
-        index += 3;
+    if (ftms.has(ftmsdecoder::TotalDistance)) {
+        Distance = ftms.rawValue(ftmsdecoder::TotalDistance) / 1000.0;
     } else {
         Distance += ((Speed.value() / 3600000.0) *
                      ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
     }
 
-    emit debug(QStringLiteral("Current Distance: ") + QString::number(Distance.value()));
-
-    if (Flags.instantPace) {
-
-        double instantPace;
-        instantPace =
-            ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
-        index += 2;
-        emit debug(QStringLiteral("Current Pace: ") + QString::number(instantPace));
-
+    if (ftms.has(ftmsdecoder::InstantPace)) {
+        double instantPace = ftms.rawValue(ftmsdecoder::InstantPace);
         if((DFIT_L_R && Cadence.value() > 0) || !DFIT_L_R) {
             Speed = (60.0 / instantPace) *
                 30.0; // translating pace (min/500m) to km/h in order to match the pace function in the rower.cpp
         }
-        emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
     }
 
-    if (Flags.avgPace) {
-
-        double avgPace;
-        avgPace =
-            ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
-        index += 2;
-        emit debug(QStringLiteral("Current Average Pace: ") + QString::number(avgPace));
-    }
-
-    if (Flags.instantPower) {
-        double watt =
-            ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
-        index += 2;
+    if (ftms.has(ftmsdecoder::InstantPower)) {
+        double watt = ftms.rawValue(ftmsdecoder::InstantPower);
         if (!filterWattNull || watt != 0) {
             if((DFIT_L_R && Cadence.value() > 0) || !DFIT_L_R)
                 m_watt = watt;
         }
-        emit debug(QStringLiteral("Current Watt: ") + QString::number(m_watt.value()));
-    }
-
-    if (Flags.avgPower) {
-
-        double avgPower;
-        avgPower =
-            ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
-        index += 2;
-        emit debug(QStringLiteral("Current Average Watt: ") + QString::number(avgPower));
     }
 
-    if (Flags.resistanceLvl) {
-        Resistance =
-            ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
+    if (ftms.has(ftmsdecoder::ResistanceLevel)) {
+        Resistance = ftms.rawValue(ftmsdecoder::ResistanceLevel);
         emit resistanceRead(Resistance.value());
-        index += 2;
-        emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
     }
 
-    if (Flags.expEnergy && index + 1 < newValue.length()) {
-        KCal = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(index))));
-        index += 2;
-
-        // energy per hour
-        index += 2;
-
-        // energy per minute
-        index += 1;
+    if (ftms.has(ftmsdecoder::TotalEnergy)) {
+        KCal = ftms.rawValue(ftmsdecoder::TotalEnergy);
     } else {
         if (watts())
             KCal +=
-                ((((0.048 * ((double)watts()) + 1.19) *
-                   settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                  200.0) /
+                ((((0.048 * ((double)watts()) + 1.19) * settings.weight * 3.5) / 200.0) /
                  (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
                                 now)))); //(( (0.048* Output in watts +1.19) * body weight in
                                                                   // kg * 3.5) / 200 ) / 60
     }
 
-    emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
-
 #ifdef Q_OS_ANDROID
-    if (settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool())
+    if (settings.ant_heart)
         Heart = (uint8_t)KeepAwakeHelper::heart();
     else
 #endif
     {
-        if (Flags.heartRate && !disable_hr_frommachinery) {
-            if (index < newValue.length()) {
-                Heart = ((double)(((uint8_t)newValue.at(index))));
-                // index += 1; //NOTE: clang-analyzer-deadcode.DeadStores
-                emit debug(QStringLiteral("Current Heart: ") + QString::number(Heart.value()));
-            } else
-                emit debug(QStringLiteral("Error on parsing heart"));
+        if (ftms.has(ftmsdecoder::HeartRate) && !disable_hr_frommachinery) {
+            Heart = ftms.rawValue(ftmsdecoder::HeartRate);
         }
     }
 
-    if (Flags.metabolic) {
-
-        // todo
-    }
-
-    if (Flags.elapsedTime) {
-
-        // todo
-    }
-
-    if (Flags.remainingTime) {
-
-        // todo
-    }
-
     if (Cadence.value() > 0) {
 
         CrankRevs++;
@@ -349,15 +242,14 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
 
     lastRefreshCharacteristicChanged = now;
 
-    if (heartRateBeltName.startsWith(QStringLiteral("Disabled"))) {
+    if (settings.heart_rate_belt_disabled) {
         update_hr_from_external();
     }
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
-    bool cadence = settings.value(QZSettings::bike_cadence_sensor, QZSettings::default_bike_cadence_sensor).toBool();
-    bool ios_peloton_workaround =
-        settings.value(QZSettings::ios_peloton_workaround, QZSettings::default_ios_peloton_workaround).toBool();
+    bool cadence = settings.bike_cadence_sensor;
+    bool ios_peloton_workaround = settings.ios_peloton_workaround;
     if (ios_peloton_workaround && cadence && h && firstStateChanged) {
 
         h->virtualbike_setCadence(currentCrankRevolutions(), lastCrankEventTime());
@@ -366,8 +258,17 @@ void ftmsrower::characteristicChanged(const QLowEnergyCharacteristic &characteri
 #endif
 #endif
 
-    emit debug(QStringLiteral("Current CrankRevs: ") + QString::number(CrankRevs));
-    emit debug(QStringLiteral("Last CrankEventTime: ") + QString::number(LastCrankEventTime));
+    // the debug text is only built when it's going to be logged
+    if (settings.log_debug) {
+        emit debug(ftmsdecoder::toString(ftms));
+        emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()) +
+                   QStringLiteral(" Cadence: ") + QString::number(Cadence.value()) +
+                   QStringLiteral(" Watt: ") + QString::number(m_watt.value()) + QStringLiteral(" Distance: ") +
+                   QString::number(Distance.value()) + QStringLiteral(" KCal: ") + QString::number(KCal.value()) +
+                   QStringLiteral(" Heart: ") + QString::number(Heart.value()));
+        emit debug(QStringLiteral("Current CrankRevs: ") + QString::number(CrankRevs));
+        emit debug(QStringLiteral("Last CrankEventTime: ") + QString::number(LastCrankEventTime));
+    }
 
     if (m_control->error() != QLowEnergyController::NoError) {
         qDebug() << QStringLiteral("QLowEnergyController ERROR!!") << m_control->errorString();
@@ -207,7 +207,7 @@ void horizongr7bike::characteristicChanged(const QLowEnergyCharacteristic &chara
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
         emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
 
@@ -232,7 +232,7 @@ void horizongr7bike::characteristicChanged(const QLowEnergyCharacteristic &chara
             } else {
                 Speed = metric::calculateSpeedFromPower(
                     watts(), Inclination.value(), Speed.value(),
-                    fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                    Speed.secondsSinceLastChanged(), this->speedLimit());
             }
             index += 2;
             emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
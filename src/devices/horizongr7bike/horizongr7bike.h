@@ -39,6 +39,7 @@ class horizongr7bike : public bike {
     horizongr7bike(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset,
                    double bikeResistanceGain);
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
 
   private:
     void writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool disable_log = false,
@@ -57,7 +58,6 @@ class horizongr7bike : public bike {
     QLowEnergyService* customService = nullptr;
     QLowEnergyCharacteristic customWriteChar;
 
-    double bikeResistanceToPeloton(double resistance);
     const resistance_t max_resistance = 12;
     uint8_t sec1Update = 0;
     QByteArray lastPacket;
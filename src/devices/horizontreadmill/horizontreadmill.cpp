@@ -1,6 +1,8 @@
 #include "horizontreadmill.h"
 
 #include "devices/ftmsbike/ftmsbike.h"
+#include "devices/ftmsdecoder.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include "virtualdevices/virtualtreadmill.h"
 #include <QBluetoothLocalDevice>
@@ -1300,13 +1302,10 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
     // qDebug() << "characteristicChanged" << characteristic.uuid() << newValue << newValue.length();
     Q_UNUSED(characteristic);
     bool distanceEval = false;
-    QSettings settings;
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
     // bool horizon_paragon_x = settings.value(QZSettings::horizon_paragon_x,
     // QZSettings::default_horizon_paragon_x).toBool();
-    bool disable_hr_frommachinery =
-        settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool();
-    QString heartRateBeltName =
-        settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
+    bool disable_hr_frommachinery = settings.heart_ignore_builtin;
 
     QDateTime now = QDateTime::currentDateTime();
 
@@ -1331,10 +1330,7 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
         }
     }
 
-    if (isPaused() && settings
-                          .value(QZSettings::horizon_treadmill_suspend_stats_pause,
-                                 QZSettings::default_horizon_treadmill_suspend_stats_pause)
-                          .toBool()) {
+    if (isPaused() && settings.horizon_treadmill_suspend_stats_pause) {
         qDebug() << "treadmill paused so I'm ignoring the new metrics";
         return;
     }
@@ -1350,15 +1346,11 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
         Inclination = (double)((uint8_t)lastPacketComplete.at(30)) / 10.0;
         emit debug(QStringLiteral("Current Inclination: ") + QString::number(Inclination.value()));
 
-        if (firstDistanceCalculated && watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()))
-            KCal +=
-                ((((0.048 * ((double)watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat())) +
-                    1.19) *
-                   settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                  200.0) /
-                 (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
-                                now)))); //(( (0.048* Output in watts +1.19) * body weight in
-                                                                  // kg * 3.5) / 200 ) / 60
+        if (firstDistanceCalculated && watts(settings.weight))
+            KCal += ((((0.048 * ((double)watts(settings.weight)) + 1.19) * settings.weight * 3.5) / 200.0) /
+                     (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
+                                    now)))); //(( (0.048* Output in watts +1.19) * body weight in
+                                             // kg * 3.5) / 200 ) / 60
 
         emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
 
@@ -1377,15 +1369,11 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
         Inclination = (double)((uint8_t)newValue.at(63)) / 10.0;
         emit debug(QStringLiteral("Current Inclination: ") + QString::number(Inclination.value()));
 
-        if (firstDistanceCalculated && watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()))
-            KCal +=
-                ((((0.048 * ((double)watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat())) +
-                    1.19) *
-                   settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                  200.0) /
-                 (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
-                                now)))); //(( (0.048* Output in watts +1.19) * body weight in
-                                                                  // kg * 3.5) / 200 ) / 60
+        if (firstDistanceCalculated && watts(settings.weight))
+            KCal += ((((0.048 * ((double)watts(settings.weight)) + 1.19) * settings.weight * 3.5) / 200.0) /
+                     (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
+                                    now)))); //(( (0.048* Output in watts +1.19) * body weight in
+                                             // kg * 3.5) / 200 ) / 60
 
         emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
 
@@ -1401,15 +1389,11 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
 
         // Inclination = (double)((uint8_t)newValue.at(3)) / 10.0;
         // emit debug(QStringLiteral("Current Inclination: ") + QString::number(Inclination.value()));
-        if (firstDistanceCalculated && watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()))
-            KCal +=
-                ((((0.048 * ((double)watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat())) +
-                    1.19) *
-                   settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                  200.0) /
-                 (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
-                                now)))); //(( (0.048* Output in watts +1.19) * body weight in
-        // kg * 3.5) / 200 ) / 60
+        if (firstDistanceCalculated && watts(settings.weight))
+            KCal += ((((0.048 * ((double)watts(settings.weight)) + 1.19) * settings.weight * 3.5) / 200.0) /
+                     (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
+                                    now)))); //(( (0.048* Output in watts +1.19) * body weight in
+                                             // kg * 3.5) / 200 ) / 60
 
         emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
 
@@ -1431,202 +1415,64 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
         lastPacket = newValue;
 
         // default flags for this treadmill is 84 04
+        ftmsdecoder::data ftms;
+        ftmsdecoder::decode(characteristic.uuid(), newValue, ftms);
 
-        union flags {
-            struct {
-
-                uint16_t moreData : 1;
-                uint16_t avgSpeed : 1;
-                uint16_t totalDistance : 1;
-                uint16_t inclination : 1;
-                uint16_t elevation : 1;
-                uint16_t instantPace : 1;
-                uint16_t averagePace : 1;
-                uint16_t expEnergy : 1;
-                uint16_t heartRate : 1;
-                uint16_t metabolic : 1;
-                uint16_t elapsedTime : 1;
-                uint16_t remainingTime : 1;
-                uint16_t forceBelt : 1;
-                uint16_t spare : 3;
-            };
-
-            uint16_t word_flags;
-        };
-
-        flags Flags;
-        int index = 0;
-        Flags.word_flags = (newValue.at(1) << 8) | newValue.at(0);
-        index += 2;
-
-        if (!Flags.moreData) {
-            Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                              (uint16_t)((uint8_t)newValue.at(index)))) /
-                    100.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
-        }
-
-        if (Flags.avgSpeed) {
-            double avgSpeed;
-            avgSpeed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index)))) /
-                       100.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Average Speed: ") + QString::number(avgSpeed));
-        }
-
-        if (Flags.totalDistance) {
-            // ignoring the distance, because it's a total life odometer
-            // Distance = ((double)((((uint32_t)((uint8_t)newValue.at(index + 2)) << 16) |
-            // (uint32_t)((uint8_t)newValue.at(index + 1)) << 8) | (uint32_t)((uint8_t)newValue.at(index)))) / 1000.0;
-            index += 3;
-        }
-        // else
-        {
-            if (firstDistanceCalculated)
-                Distance += ((Speed.value() / 3600000.0) *
-                             ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
-            distanceEval = true;
-        }
-
-        emit debug(QStringLiteral("Current Distance: ") + QString::number(Distance.value()));
-
-        if (Flags.inclination) {
-            if(!tunturi_t60_treadmill)
-                Inclination = ((double)(((int16_t)((int16_t)newValue.at(index + 1)) << 8) |
-                                        (int16_t)((uint8_t)newValue.at(index)))) /
-                            10.0;
-            index += 4; // the ramo value is useless
-            emit debug(QStringLiteral("Current Inclination: ") + QString::number(Inclination.value()));
-        }
-
-        if (Flags.elevation) {
-            index += 4; // TODO
+        if (ftms.has(ftmsdecoder::InstantSpeed)) {
+            Speed = ftms.value(ftmsdecoder::InstantSpeed);
         }
 
-        if (Flags.instantPace) {
-            index += 1; // TODO
-        }
+        // ignoring the total distance, because it's a total life odometer
+        if (firstDistanceCalculated)
+            Distance += ((Speed.value() / 3600000.0) *
+                         ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
+        distanceEval = true;
 
-        if (Flags.averagePace) {
-            index += 1; // TODO
+        if (ftms.has(ftmsdecoder::Inclination) && !tunturi_t60_treadmill) {
+            // the ramp value is useless
+            Inclination = ftms.value(ftmsdecoder::Inclination);
         }
 
-        if (Flags.expEnergy) {
-            KCal = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                             (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-
-            // energy per hour
-            index += 2;
-
-            // energy per minute
-            index += 1;
+        if (ftms.has(ftmsdecoder::TotalEnergy)) {
+            KCal = ftms.rawValue(ftmsdecoder::TotalEnergy);
         } else {
-            if (firstDistanceCalculated &&
-                watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()))
-                KCal +=
-                    ((((0.048 *
-                            ((double)watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat())) +
-                        1.19) *
-                       settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                      200.0) /
-                     (60000.0 /
-                      ((double)lastRefreshCharacteristicChanged.msecsTo(
-                          now)))); //(( (0.048* Output in watts +1.19) * body weight in
-                                                            // kg * 3.5) / 200 ) / 60
+            if (firstDistanceCalculated && watts(settings.weight))
+                KCal += ((((0.048 * ((double)watts(settings.weight)) + 1.19) * settings.weight * 3.5) / 200.0) /
+                         (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
+                                        now)))); //(( (0.048* Output in watts +1.19) * body weight in
+                                                 // kg * 3.5) / 200 ) / 60
             distanceEval = true;
         }
 
-        emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
-
 #ifdef Q_OS_ANDROID
-        if (settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool())
+        if (settings.ant_heart)
             Heart = (uint8_t)KeepAwakeHelper::heart();
         else
 #endif
         {
-            if (Flags.heartRate) {
-                if (index < newValue.length()) {
-
-                    heart = ((double)(((uint8_t)newValue.at(index))));
-                    emit debug(QStringLiteral("Current Heart: ") + QString::number(heart));
-                } else {
-                    emit debug(QStringLiteral("Error on parsing heart!"));
-                }
-                // index += 1; //NOTE: clang-analyzer-deadcode.DeadStores
+            if (ftms.has(ftmsdecoder::HeartRate)) {
+                heart = ftms.rawValue(ftmsdecoder::HeartRate);
             }
         }
 
-        if (Flags.metabolic) {
-            // todo
-        }
-
-        if (Flags.elapsedTime) {
-            // todo
-        }
-
-        if (Flags.remainingTime) {
-            // todo
-        }
-
-        if (Flags.forceBelt) {
-            // todo
+        // the debug text is only built when it's going to be logged
+        if (settings.log_debug) {
+            emit debug(ftmsdecoder::toString(ftms));
+            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()) +
+                       QStringLiteral(" Inclination: ") + QString::number(Inclination.value()) +
+                       QStringLiteral(" Distance: ") + QString::number(Distance.value()) +
+                       QStringLiteral(" KCal: ") + QString::number(KCal.value()));
         }
     } else if (characteristic.uuid() == QBluetoothUuid((quint16)0x2ACE)) {
-        union flags {
-            struct {
-                uint32_t moreData : 1;
-                uint32_t avgSpeed : 1;
-                uint32_t totDistance : 1;
-                uint32_t stepCount : 1;
-                uint32_t strideCount : 1;
-                uint32_t elevationGain : 1;
-                uint32_t rampAngle : 1;
-                uint32_t resistanceLvl : 1;
-                uint32_t instantPower : 1;
-                uint32_t avgPower : 1;
-                uint32_t expEnergy : 1;
-                uint32_t heartRate : 1;
-                uint32_t metabolicEq : 1;
-                uint32_t elapsedTime : 1;
-                uint32_t remainingTime : 1;
-                uint32_t movementDirection : 1;
-                uint32_t spare : 8;
-            };
-
-            uint32_t word_flags;
-        };
-
-        flags Flags;
-        int index = 0;
-        Flags.word_flags = (newValue.at(2) << 16) | (newValue.at(1) << 8) | newValue.at(0);
-        index += 3;
-
-        if (!Flags.moreData && newValue.length() > index + 1) {
-            Speed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                              (uint16_t)((uint8_t)newValue.at(index)))) /
-                    100.0;
-            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
-            index += 2;
-        }
+        ftmsdecoder::data ftms;
+        ftmsdecoder::decode(characteristic.uuid(), newValue, ftms);
 
-        if (Flags.avgSpeed && newValue.length() > index + 1) {
-            double avgSpeed;
-            avgSpeed = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index)))) /
-                       100.0;
-            index += 2;
-            emit debug(QStringLiteral("Current Average Speed: ") + QString::number(avgSpeed));
+        if (ftms.has(ftmsdecoder::InstantSpeed)) {
+            Speed = ftms.value(ftmsdecoder::InstantSpeed);
         }
 
-        if (Flags.totDistance && newValue.length() > index + 2) {
-            Distance = ((double)((((uint32_t)((uint8_t)newValue.at(index + 2)) << 16) |
-                                  (uint32_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint32_t)((uint8_t)newValue.at(index)))) /
-                       1000.0;
-            index += 3;
+        if (ftms.has(ftmsdecoder::TotalDistance)) {
+            Distance = ftms.rawValue(ftmsdecoder::TotalDistance) / 1000.0;
         } else {
             if (firstDistanceCalculated)
                 Distance += ((Speed.value() / 3600000.0) *
@@ -1634,118 +1480,54 @@ void horizontreadmill::characteristicChanged(const QLowEnergyCharacteristic &cha
             distanceEval = true;
         }
 
-        emit debug(QStringLiteral("Current Distance: ") + QString::number(Distance.value()));
-
-        if (Flags.stepCount && newValue.length() > index + 1) {
-            if (settings.value(QZSettings::cadence_sensor_name, QZSettings::default_cadence_sensor_name)
-                    .toString()
-                    .startsWith(QStringLiteral("Disabled"))) {
-                Cadence = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                    (uint16_t)((uint8_t)newValue.at(index))));
-            }
-            emit debug(QStringLiteral("Current Cadence: ") + QString::number(Cadence.value()));
-
-            index += 2;
-            index += 2;
-        }
-
-        if (Flags.strideCount) {
-            index += 2;
+        if (ftms.has(ftmsdecoder::StepRate) && settings.cadence_sensor_disabled) {
+            Cadence = ftms.rawValue(ftmsdecoder::StepRate);
         }
 
-        if (Flags.elevationGain) {
-            index += 2;
-            index += 2;
+        if (ftms.has(ftmsdecoder::ResistanceLevel)) {
+            Resistance = ftms.rawValue(ftmsdecoder::ResistanceLevel);
         }
 
-        if (Flags.rampAngle) {
-            index += 2;
-            index += 2;
+        if (ftms.has(ftmsdecoder::InstantPower) && !powerReceivedFromPowerSensor) {
+            m_watt = ftms.rawValue(ftmsdecoder::InstantPower);
         }
 
-        if (Flags.resistanceLvl && newValue.length() > index + 1) {
-            Resistance = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-            emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
-        }
-
-        if (Flags.instantPower && newValue.length() > index + 1) {
-            if (!powerReceivedFromPowerSensor)
-                m_watt = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                   (uint16_t)((uint8_t)newValue.at(index))));
-            emit debug(QStringLiteral("Current Watt: ") + QString::number(m_watt.value()));
-            index += 2;
-        }
-
-        if (Flags.avgPower && newValue.length() > index + 1) {
-            double avgPower;
-            avgPower = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                                 (uint16_t)((uint8_t)newValue.at(index))));
-            emit debug(QStringLiteral("Current Average Watt: ") + QString::number(avgPower));
-            index += 2;
-        }
-
-        if (Flags.expEnergy && newValue.length() > index + 1) {
-            KCal = ((double)(((uint16_t)((uint8_t)newValue.at(index + 1)) << 8) |
-                             (uint16_t)((uint8_t)newValue.at(index))));
-            index += 2;
-
-            // energy per hour
-            index += 2;
-
-            // energy per minute
-            index += 1;
+        if (ftms.has(ftmsdecoder::TotalEnergy)) {
+            KCal = ftms.rawValue(ftmsdecoder::TotalEnergy);
         } else {
-            if (firstDistanceCalculated &&
-                watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()))
-                KCal +=
-                    ((((0.048 *
-                            ((double)watts(settings.value(QZSettings::weight, QZSettings::default_weight).toFloat())) +
-                        1.19) *
-                       settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() * 3.5) /
-                      200.0) /
-                     (60000.0 /
-                      ((double)lastRefreshCharacteristicChanged.msecsTo(
-                          now)))); //(( (0.048* Output in watts +1.19) * body weight in
-                                                            // kg * 3.5) / 200 ) / 60
+            if (firstDistanceCalculated && watts(settings.weight))
+                KCal += ((((0.048 * ((double)watts(settings.weight)) + 1.19) * settings.weight * 3.5) / 200.0) /
+                         (60000.0 / ((double)lastRefreshCharacteristicChanged.msecsTo(
+                                        now)))); //(( (0.048* Output in watts +1.19) * body weight in
+                                                 // kg * 3.5) / 200 ) / 60
             distanceEval = true;
         }
 
-        emit debug(QStringLiteral("Current KCal: ") + QString::number(KCal.value()));
-
 #ifdef Q_OS_ANDROID
-        if (settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool())
+        if (settings.ant_heart)
             Heart = (uint8_t)KeepAwakeHelper::heart();
         else
 #endif
         {
-            if (Flags.heartRate && !disable_hr_frommachinery && newValue.length() > index) {
-                Heart = ((double)(((uint8_t)newValue.at(index))));
-                // index += 1; // NOTE: clang-analyzer-deadcode.DeadStores
-                emit debug(QStringLiteral("Current Heart: ") + QString::number(Heart.value()));
-            } else {
-                Flags.heartRate = false;
+            if (ftms.has(ftmsdecoder::HeartRate) && !disable_hr_frommachinery) {
+                Heart = ftms.rawValue(ftmsdecoder::HeartRate);
+                heart = 1;
             }
-            heart = Flags.heartRate;
-        }
-
-        if (Flags.metabolicEq) {
-            // todo
-        }
-
-        if (Flags.elapsedTime) {
-            // todo
         }
 
-        if (Flags.remainingTime) {
-            // todo
+        // the debug text is only built when it's going to be logged
+        if (settings.log_debug) {
+            emit debug(ftmsdecoder::toString(ftms));
+            emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()) +
+                       QStringLiteral(" Cadence: ") + QString::number(Cadence.value()) +
+                       QStringLiteral(" Watt: ") + QString::number(m_watt.value()) +
+                       QStringLiteral(" Distance: ") + QString::number(Distance.value()) +
+                       QStringLiteral(" KCal: ") + QString::number(KCal.value()));
         }
     }
 
-    if (heartRateBeltName.startsWith(QStringLiteral("Disabled"))) {
-        if (heart == 0.0 ||
-            settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool()) {
+    if (settings.heart_rate_belt_disabled) {
+        if (heart == 0.0 || settings.heart_ignore_builtin) {
             update_hr_from_external();
         } else {
 
@@ -204,7 +204,7 @@ void iconceptbike::readSocket() {
                 } else {
                     Speed = metric::calculateSpeedFromPower(
                         watts(), Inclination.value(), Speed.value(),
-                        fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                        Speed.secondsSinceLastChanged(), this->speedLimit());
                 }
                 if (watts())
                     KCal +=
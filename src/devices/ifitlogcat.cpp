@@ -0,0 +1,239 @@
+#include "ifitlogcat.h"
+
+#include <cstring>
+
+namespace {
+
+// in the order of ifitlogcatparser::event
+const char *const keywords[ifitlogcatparser::EVENT_COUNT] = {
+    "Changed KPH",        "Changed Grade",      "Changed Watts",       "Changed RPM",
+    "Changed CurrentGear", "Changed Resistance", "HeartRateDataUpdate",
+};
+
+// the field of the heart rate in a HeartRateDataUpdate line, the separators being one or more spaces
+const int HEART_RATE_FIELD = 14;
+
+/**
+ * @brief Aho-Corasick automaton of the keywords: one transition for each character of a line, whatever the keyword.
+ * The characters outside ASCII are not in any keyword, they go back to the root.
+ */
+struct automaton {
+    static const int MAX_STATES = 128;
+
+    quint8 next[MAX_STATES][128];
+    // the event found reaching a state, + 1
+    quint8 match[MAX_STATES];
+
+    automaton() {
+        int trie[MAX_STATES][128];
+        memset(trie, -1, sizeof(trie));
+        memset(match, 0, sizeof(match));
+        int states = 1;
+        for (int e = 0; e < ifitlogcatparser::EVENT_COUNT; e++) {
+            int s = 0;
+            for (const char *c = keywords[e]; *c; c++) {
+                if (trie[s][(int)*c] == -1) {
+                    Q_ASSERT(states < MAX_STATES);
+                    trie[s][(int)*c] = states++;
+                }
+                s = trie[s][(int)*c];
+            }
+            match[s] = e + 1;
+        }
+
+        // breadth first, the failure of a state is known before its children
+        quint8 fail[MAX_STATES] = {};
+        quint8 queue[MAX_STATES];
+        int head = 0, tail = 0;
+        for (int c = 0; c < 128; c++) {
+            if (trie[0][c] != -1) {
+                next[0][c] = trie[0][c];
+                queue[tail++] = trie[0][c];
+            } else {
+                next[0][c] = 0;
+            }
+        }
+        while (head < tail) {
+            const int s = queue[head++];
+            if (!match[s])
+                match[s] = match[fail[s]];
+            for (int c = 0; c < 128; c++) {
+                if (trie[s][c] != -1) {
+                    fail[trie[s][c]] = next[fail[s]][c];
+                    next[s][c] = trie[s][c];
+                    queue[tail++] = trie[s][c];
+                } else {
+                    next[s][c] = next[fail[s]][c];
+                }
+            }
+        }
+    }
+};
+
+const automaton &keywordAutomaton() {
+    static const automaton a;
+    return a;
+}
+
+bool isSpace(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+bool toDouble(const char *begin, const char *end, double *value) {
+    if (begin == end)
+        return false;
+    bool ok = false;
+    // always in the C locale, like the console writes it
+    const double v = QByteArray::fromRawData(begin, end - begin).toDouble(&ok);
+    if (ok)
+        *value = v;
+    return ok;
+}
+
+} // namespace
+
+bool ifitlogcatparser::parseLine(const char *line, int size, event *e, double *value) {
+    const automaton &a = keywordAutomaton();
+    int state = 0;
+    int found = 0;
+    for (int i = 0; i < size && !found; i++) {
+        const unsigned char c = line[i];
+        state = c < 128 ? a.next[state][c] : 0;
+        found = a.match[state];
+    }
+    if (!found)
+        return false;
+    *e = (event)(found - 1);
+
+    const char *end = line + size;
+    while (end > line && isSpace(end[-1]))
+        end--;
+
+    if (*e == HEART_RATE) {
+        const char *p = line;
+        for (int field = 0; p < end; field++) {
+            while (p < end && *p == ' ')
+                p++;
+            const char *begin = p;
+            while (p < end && *p != ' ')
+                p++;
+            if (field == HEART_RATE_FIELD)
+                return p > begin && toDouble(begin, p, value);
+        }
+        return false;
+    }
+
+    // the value is the last field
+    const char *begin = end;
+    while (begin > line && begin[-1] != ' ')
+        begin--;
+    return toDouble(begin, end, value);
+}
+
+void ifitlogcatparser::parse(const char *line, int size) {
+    lineCount++;
+    event e;
+    double v;
+    if (parseLine(line, size, &e, &v)) {
+        values[e] = v;
+        found |= 1u << e;
+    }
+}
+
+void ifitlogcatparser::feed(const char *data, int size) {
+    const char *end = data + size;
+    while (data < end) {
+        const char *lf = (const char *)memchr(data, '\n', end - data);
+        const char *stop = lf ? lf : end;
+        const int length = stop - data;
+
+        if (skipping) {
+            // the rest of a line too long
+        } else if (partialSize + length > MAX_LINE) {
+            partialSize = 0;
+            skipping = true;
+        } else if (!partialSize && lf) {
+            // a whole line in the chunk, the common case: not copied
+            parse(data, length);
+        } else {
+            memcpy(partial + partialSize, data, length);
+            partialSize += length;
+            if (lf) {
+                parse(partial, partialSize);
+                partialSize = 0;
+            }
+        }
+
+        if (!lf)
+            return;
+        skipping = false;
+        data = lf + 1;
+    }
+}
+
+void ifitlogcatparser::finish() {
+    if (partialSize && !skipping)
+        parse(partial, partialSize);
+    partialSize = 0;
+    skipping = false;
+}
+
+void ifitlogcatparser::clear() {
+    partialSize = 0;
+    skipping = false;
+    found = 0;
+    lineCount = 0;
+    for (double &v : values)
+        v = 0;
+}
+
+#ifndef Q_OS_IOS
+ifitadbshell::ifitadbshell(const QString &program, const QStringList &arguments, QObject *parent)
+    : QObject(parent), program(program), arguments(arguments) {}
+
+ifitadbshell::~ifitadbshell() { close(); }
+
+bool ifitadbshell::ensureStarted() {
+    // without an event loop, the state is only updated waiting: adb may have exited since the last command
+    if (process && process->state() == QProcess::Running && !process->waitForFinished(0))
+        return true;
+
+    if (!process) {
+        process = new QProcess(this);
+        process->setProcessChannelMode(QProcess::MergedChannels);
+        // the output is only logged, but it must be read or adb blocks once the pipe is full
+        connect(process, &QProcess::readyReadStandardOutput, this,
+                [this]() { emit debug("adb shell << " + process->readAllStandardOutput()); });
+    }
+
+    emit debug("adb shell >> " + program + " " + arguments.join(' '));
+    process->start(program, arguments);
+    startCount++;
+    if (!process->waitForStarted(3000)) {
+        emit debug("adb shell << " + process->errorString());
+        return false;
+    }
+    return true;
+}
+
+bool ifitadbshell::send(const QString &command) {
+    if (!ensureStarted())
+        return false;
+    emit debug("adb shell >> " + command);
+    const QByteArray line = command.toUtf8() + '\n';
+    if (process->write(line) != line.size())
+        return false;
+    // the caller has no event loop: the command is written now, and what adb answered is read
+    const bool written = process->waitForBytesWritten(1000);
+    process->waitForReadyRead(0);
+    return written;
+}
+
+void ifitadbshell::close() {
+    if (!process || process->state() == QProcess::NotRunning)
+        return;
+    process->closeWriteChannel();
+    if (!process->waitForFinished(1000)) {
+        process->kill();
+        process->waitForFinished(1000);
+    }
+}
+#endif
@@ -0,0 +1,110 @@
+#ifndef IFITLOGCAT_H
+#define IFITLOGCAT_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+#ifndef Q_OS_IOS
+#include <QProcess>
+#endif
+
+/**
+ * @brief Incremental parser of the logcat of an iFit console (the nordictrackifitadb devices), as it comes from adb or
+ * from the companion app: chunks of any size, split anywhere. The lines are assembled across the chunks, and a
+ * single automaton, built once, finds the known events in each line in one pass, without splitting or copying it.
+ * Only the last value of each event is kept: the devices use the latest one.
+ */
+class ifitlogcatparser {
+  public:
+    enum event : quint8 {
+        KPH,          // "Changed KPH <value>"
+        GRADE,        // "Changed Grade <value>"
+        WATTS,        // "Changed Watts <value>"
+        RPM,          // "Changed RPM <value>"
+        CURRENT_GEAR, // "Changed CurrentGear <value>"
+        RESISTANCE,   // "Changed Resistance <value>"
+        HEART_RATE,   // "HeartRateDataUpdate", the 15th field
+        EVENT_COUNT
+    };
+
+    // a longer line is not an iFit event: it is dropped, not kept in memory
+    static constexpr int MAX_LINE = 4096;
+
+    /**
+     * @brief Parse the lines completed by data, keeping the last one if it's not complete yet.
+     */
+    void feed(const char *data, int size);
+    void feed(const QByteArray &data) { feed(data.constData(), data.size()); }
+    /**
+     * @brief Parse the line not completed yet, if any: a datagram of the companion app ends with a whole line.
+     */
+    void finish();
+    void clear();
+
+    /**
+     * @brief The events found since the last call, a bit for each one (1 << event).
+     */
+    quint32 take() {
+        const quint32 f = found;
+        found = 0;
+        return f;
+    }
+    static bool has(quint32 events, event e) { return events & (1u << e); }
+    double value(event e) const { return values[e]; }
+
+    quint64 lines() const { return lineCount; }
+
+    /**
+     * @brief The event of a line, without the line feed, and its value. false if the line has none.
+     */
+    static bool parseLine(const char *line, int size, event *e, double *value);
+
+  private:
+    void parse(const char *line, int size);
+
+    char partial[MAX_LINE];
+    int partialSize = 0;
+    // a line too long, until its line feed
+    bool skipping = false;
+    double values[EVENT_COUNT] = {};
+    quint32 found = 0;
+    quint64 lineCount = 0;
+};
+
+#ifndef Q_OS_IOS
+/**
+ * @brief A persistent "adb shell" session: the commands (e.g. "input swipe ...") are written to its standard input,
+ * one per line, instead of launching adb for each one. It is started by the first command and started again if adb
+ * exits. It must be used by the thread that created it.
+ */
+class ifitadbshell : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit ifitadbshell(const QString &program = QStringLiteral("adb/adb.exe"),
+                          const QStringList &arguments = QStringList() << QStringLiteral("shell"),
+                          QObject *parent = nullptr);
+    ~ifitadbshell() override;
+
+    bool send(const QString &command);
+    void close();
+
+    // how many times adb was launched
+    int starts() const { return startCount; }
+
+  signals:
+    void debug(QString message);
+
+  private:
+    bool ensureStarted();
+
+    QString program;
+    QStringList arguments;
+    QProcess *process = nullptr;
+    int startCount = 0;
+};
+#endif
+
+#endif // IFITLOGCAT_H
@@ -152,7 +152,7 @@ void inspirebike::characteristicChanged(const QLowEnergyCharacteristic &characte
     if (!settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
         Speed = 0.37497622 * ((double)Cadence.value());
     } else {
-        Speed = metric::calculateSpeedFromPower(watts(),  Inclination.value(), Speed.value(),fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+        Speed = metric::calculateSpeedFromPower(watts(),  Inclination.value(), Speed.value(),Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     if (watts())
         KCal +=
@@ -165,15 +165,7 @@ void keepbike::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t keepbike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
 double keepbike::bikeResistanceToPeloton(double resistance) {
@@ -221,7 +213,7 @@ void keepbike::characteristicChanged(const QLowEnergyCharacteristic &characteris
     {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
 
     m_watt = GetWattFromPacket(newValue);
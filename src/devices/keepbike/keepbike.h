@@ -40,10 +40,10 @@ class keepbike : public bike {
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
 
   private:
     const resistance_t max_resistance = 36;
-    double bikeResistanceToPeloton(double resistance);
     double GetDistanceFromPacket(const QByteArray &packet);
     double GetSpeedFromPacket(const QByteArray &packet);
     double GetWattFromPacket(const QByteArray &packet);
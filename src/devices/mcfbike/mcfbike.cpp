@@ -136,36 +136,18 @@ void mcfbike::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t mcfbike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
 resistance_t mcfbike::resistanceFromPowerRequest(uint16_t power) {
     qDebug() << QStringLiteral("resistanceFromPowerRequest") << Cadence.value();
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
 }
 
 // TO CHANGE
-uint16_t mcfbike::wattsFromResistance(double resistance) {
-    return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (currentCadence().value()))));
+double mcfbike::wattsFromResistance(double resistance, double cadence) {
+    return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (cadence))));
 }
 
 double mcfbike::bikeResistanceToPeloton(double resistance) {
@@ -211,7 +193,7 @@ void mcfbike::characteristicChanged(const QLowEnergyCharacteristic &characterist
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
 
         Distance += ((Speed.value() / 3600000.0) *
@@ -157,7 +157,7 @@ void mepanelbike::characteristicChanged(const QLowEnergyCharacteristic &characte
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
 
         break;
@@ -21,12 +21,15 @@ void nordictrackifitadbbikeLogcatAdbThread::run() {
     QString ip = settings.value(QZSettings::tdf_10_ip, QZSettings::default_tdf_10_ip).toString();
     runAdbCommand("connect " + ip);
 
+#ifdef Q_OS_WINDOWS
+    // one adb shell for all the commands, instead of one adb for each one
+    shell = new ifitadbshell();
+    connect(shell, &ifitadbshell::debug, this, &nordictrackifitadbbikeLogcatAdbThread::debug);
+#endif
+
     while (1) {
         runAdbTailCommand("logcat");
-        if(adbCommandPending.length() != 0) {
-            runAdbCommand(adbCommandPending);
-            adbCommandPending = "";
-        }
+        runPendingCommand();
         msleep(100);
     }
 }
@@ -50,6 +53,7 @@ QString nordictrackifitadbbikeLogcatAdbThread::runAdbCommand(QString command) {
 }
 
 bool nordictrackifitadbbikeLogcatAdbThread::runCommand(QString command) {
+    QMutexLocker locker(&adbCommandMutex);
     if(adbCommandPending.length() == 0) {
         adbCommandPending = command;
         return true;
@@ -57,48 +61,52 @@ bool nordictrackifitadbbikeLogcatAdbThread::runCommand(QString command) {
     return false;
 }
 
+void nordictrackifitadbbikeLogcatAdbThread::runPendingCommand() {
+    QString command;
+    {
+        QMutexLocker locker(&adbCommandMutex);
+        command = adbCommandPending;
+    }
+    if (command.length() == 0)
+        return;
+#ifdef Q_OS_WINDOWS
+    shell->send(command);
+#endif
+    QMutexLocker locker(&adbCommandMutex);
+    adbCommandPending = "";
+}
+
 void nordictrackifitadbbikeLogcatAdbThread::runAdbTailCommand(QString command) {
 #ifdef Q_OS_WINDOWS
-    auto process = new QProcess;
-    QObject::connect(process, &QProcess::readyReadStandardOutput, [process, this]() {
-        QString output = process->readAllStandardOutput();
-        // qDebug() << "adbLogCat STDOUT << " << output;
-        QStringList lines = output.split('\n', Qt::SplitBehaviorFlags::SkipEmptyParts);
-        bool wattFound = false;
-        bool hrmFound = false;
-        foreach (QString line, lines) {
-            if (line.contains("Changed KPH")) {
-                emit debug(line);
-                speed = line.split(' ').last().toDouble();
-            } else if (line.contains("Changed Grade")) {
-                emit debug(line);
-                inclination = line.split(' ').last().toDouble();
-            } else if (line.contains("Changed Watts")) {
-                emit debug(line);
-                watt = line.split(' ').last().toDouble();
-                wattFound = true;
-            } else if (line.contains("HeartRateDataUpdate")) {
-                emit debug(line);
-                QStringList splitted = line.split(' ', Qt::SkipEmptyParts);
-                if (splitted.length() > 14) {
-                    hrm = splitted[14].toInt();
-                    hrmFound = true;
-                }
-            }
-        }
+    QProcess process;
+    ifitlogcatparser parser;
+    QObject::connect(&process, &QProcess::readyReadStandardOutput, [&process, &parser, this]() {
+        // the lines are split anywhere between two reads
+        parser.feed(process.readAllStandardOutput());
+        const quint32 events = parser.take();
+        if (ifitlogcatparser::has(events, ifitlogcatparser::KPH))
+            speed = parser.value(ifitlogcatparser::KPH);
+        if (ifitlogcatparser::has(events, ifitlogcatparser::GRADE))
+            inclination = parser.value(ifitlogcatparser::GRADE);
         emit onSpeedInclination(speed, inclination);
-        if (wattFound)
+        if (ifitlogcatparser::has(events, ifitlogcatparser::WATTS)) {
+            watt = parser.value(ifitlogcatparser::WATTS);
             emit onWatt(watt);
-        if (hrmFound)
+        }
+        if (ifitlogcatparser::has(events, ifitlogcatparser::HEART_RATE)) {
+            hrm = (int)parser.value(ifitlogcatparser::HEART_RATE);
             emit onHRM(hrm);
+        }
     });
-    QObject::connect(process, &QProcess::readyReadStandardError, [process, this]() {
-        auto output = process->readAllStandardError();
+    QObject::connect(&process, &QProcess::readyReadStandardError, [&process, this]() {
+        auto output = process.readAllStandardError();
         emit debug("adbLogCat ERROR << " + output);
     });
     emit debug("adbLogCat >> " + command);
-    process->start("adb/adb.exe", QStringList(command.split(' ')));
-    process->waitForFinished(-1);
+    process.start("adb/adb.exe", QStringList(command.split(' ')));
+    // the commands are sent while logcat runs, at most 100ms after the device asked
+    while (process.state() != QProcess::NotRunning && !process.waitForFinished(100))
+        runPendingCommand();
 #endif
 }
 
@@ -189,14 +197,6 @@ bool nordictrackifitadbbike::inclinationAvailableByHardware() {
         return true; 
 }
 
-double nordictrackifitadbbike::getDouble(QString v) {
-    QChar d = QLocale().decimalPoint();
-    if (d == ',') {
-        v = v.replace('.', ',');
-    }
-    return QLocale().toDouble(v);
-}
-
 void nordictrackifitadbbike::processPendingDatagrams() {
     qDebug() << "in !";
     QHostAddress sender;
@@ -217,67 +217,15 @@ void nordictrackifitadbbike::processPendingDatagrams() {
             settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
         double weight = settings.value(QZSettings::weight, QZSettings::default_weight).toFloat();
 
-        double speed = 0;
-        double cadence = 0;
-        double resistance = 0;
-        double gear = 0;
-        double watt = 0;
-        double grade = 0;
-        QStringList lines = QString::fromLocal8Bit(datagram.data()).split("\n");
-        foreach (QString line, lines) {
-            qDebug() << line;
-
-            if (line.contains(QStringLiteral("Changed KPH")) && !settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    speed = getDouble(aValues.last());
-                    Speed = speed;
-                }
-            } else if (line.contains(QStringLiteral("Changed RPM"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    cadence = getDouble(aValues.last());
-                    Cadence = cadence;
-                }
-            } else if (line.contains(QStringLiteral("Changed CurrentGear"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    gear = getDouble(aValues.last());
-                    Resistance = gear;
-                    gearsAvailable = true;
-                }
-            } else if (line.contains(QStringLiteral("Changed Resistance"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    resistance = getDouble(aValues.last());
-                    if(freemotion_coachbike_b22_7)
-                        m_pelotonResistance = (100 / 24) * resistance;
-                    else
-                        m_pelotonResistance = (100 / 32) * resistance;
-                    qDebug() << QStringLiteral("Current Peloton Resistance: ") << m_pelotonResistance.value()
-                             << resistance;
-                    if(!gearsAvailable)
-                        Resistance = resistance;
-                }
-            } else if (line.contains(QStringLiteral("Changed Watts"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    watt = getDouble(aValues.last());
-                    m_watt = watt;
-                }
-            } else if (line.contains(QStringLiteral("Changed Grade"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    grade = getDouble(aValues.last());
-                    Inclination = grade;
-                }
-            }
-        }
+        // a datagram ends with a whole line, even without its line feed
+        logcatParser.feed(datagram);
+        logcatParser.finish();
+        applyLogcat();
 
         if (settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
 
         bool proform_studio_NTEX71021 =
@@ -305,7 +253,7 @@ void nordictrackifitadbbike::processPendingDatagrams() {
                                                                   command.object<jstring>());
 #elif defined(Q_OS_WIN)
                         if (logcatAdbThread)
-                            logcatAdbThread->runCommand("shell " + lastCommand);
+                            logcatAdbThread->runCommand(lastCommand);
 #elif defined Q_OS_IOS
 #ifndef IO_UNDER_QT
                         h->adb_sendcommand(lastCommand.toStdString().c_str());
@@ -355,7 +303,7 @@ void nordictrackifitadbbike::processPendingDatagrams() {
                                                                   command.object<jstring>());
 #elif defined(Q_OS_WIN)
                         if (logcatAdbThread)
-                            logcatAdbThread->runCommand("shell " + lastCommand);
+                            logcatAdbThread->runCommand(lastCommand);
 #elif defined Q_OS_IOS
 #ifndef IO_UNDER_QT
                         h->adb_sendcommand(lastCommand.toStdString().c_str());
@@ -379,7 +327,7 @@ void nordictrackifitadbbike::processPendingDatagrams() {
                                                                     command.object<jstring>());
     #elif defined(Q_OS_WIN)
                             if (logcatAdbThread)
-                                logcatAdbThread->runCommand("shell " + lastCommand);
+                                logcatAdbThread->runCommand(lastCommand);
     #elif defined Q_OS_IOS
     #ifndef IO_UNDER_QT
                             h->adb_sendcommand(lastCommand.toStdString().c_str());
@@ -442,7 +390,7 @@ void nordictrackifitadbbike::processPendingDatagrams() {
 
         emit debug(QStringLiteral("Current Watt: ") + QString::number(watts()));
         emit debug(QStringLiteral("Current Resistance: ") + QString::number(Resistance.value()));
-        emit debug(QStringLiteral("Current Gear: ") + QString::number(gear));
+        emit debug(QStringLiteral("Current Gear: ") + QString::number(logcatParser.value(ifitlogcatparser::CURRENT_GEAR)));
         emit debug(QStringLiteral("Current Cadence: ") + QString::number(Cadence.value()));
         emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
         emit debug(QStringLiteral("Current Inclination: ") + QString::number(Inclination.value()));
@@ -521,6 +469,47 @@ resistance_t nordictrackifitadbbike::pelotonToBikeResistance(int pelotonResistan
     return Resistance.value();
 }
 
+void nordictrackifitadbbike::logcat(const QByteArray &chunk) {
+    logcatParser.feed(chunk);
+    applyLogcat();
+}
+
+void nordictrackifitadbbike::applyLogcat() {
+    const quint32 events = logcatParser.take();
+    if (!events)
+        return;
+
+    QSettings settings;
+    bool freemotion_coachbike_b22_7 = settings.value(QZSettings::freemotion_coachbike_b22_7, QZSettings::default_freemotion_coachbike_b22_7).toBool();
+
+    if (ifitlogcatparser::has(events, ifitlogcatparser::KPH) &&
+        !settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
+        Speed = logcatParser.value(ifitlogcatparser::KPH);
+    }
+    if (ifitlogcatparser::has(events, ifitlogcatparser::RPM))
+        Cadence = logcatParser.value(ifitlogcatparser::RPM);
+    // the gear first: a bike with gears shows them as its resistance
+    if (ifitlogcatparser::has(events, ifitlogcatparser::CURRENT_GEAR)) {
+        Resistance = logcatParser.value(ifitlogcatparser::CURRENT_GEAR);
+        gearsAvailable = true;
+    }
+    if (ifitlogcatparser::has(events, ifitlogcatparser::RESISTANCE)) {
+        double resistance = logcatParser.value(ifitlogcatparser::RESISTANCE);
+        if(freemotion_coachbike_b22_7)
+            m_pelotonResistance = (100 / 24) * resistance;
+        else
+            m_pelotonResistance = (100 / 32) * resistance;
+        qDebug() << QStringLiteral("Current Peloton Resistance: ") << m_pelotonResistance.value()
+                 << resistance;
+        if(!gearsAvailable)
+            Resistance = resistance;
+    }
+    if (ifitlogcatparser::has(events, ifitlogcatparser::WATTS))
+        m_watt = logcatParser.value(ifitlogcatparser::WATTS);
+    if (ifitlogcatparser::has(events, ifitlogcatparser::GRADE))
+        Inclination = logcatParser.value(ifitlogcatparser::GRADE);
+}
+
 void nordictrackifitadbbike::forceResistance(double resistance) {}
 
 void nordictrackifitadbbike::update() {
@@ -570,20 +559,16 @@ resistance_t nordictrackifitadbbike::resistanceFromPowerRequest(uint16_t power)
     if (Cadence.value() == 0)
         return 0;
 
-    for (resistance_t i = 0; i < max_resistance; i++) {
-        if (wattsFromResistance(i, Cadence.value()) <= power && wattsFromResistance(i + 1, Cadence.value()) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i, Cadence.value())
-                     << wattsFromResistance(i + 1, Cadence.value()) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(0, Cadence.value()))
-        return 0;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
+}
+
+void nordictrackifitadbbike::buildPowerSurface(powersurface &surface) {
+    // the levels are the inclinations, from 0
+    surface.build(0, max_resistance,
+                  [this](double inclination, double cadence) { return wattsFromResistance(inclination, cadence); });
 }
 
-uint16_t nordictrackifitadbbike::wattsFromResistance(double inclination, double cadence) {
+double nordictrackifitadbbike::wattsFromResistance(double inclination, double cadence) {
     // this is for the s22i
     double power = 0.0;
 
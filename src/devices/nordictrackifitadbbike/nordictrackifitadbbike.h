@@ -20,6 +20,7 @@
 #include <QUdpSocket>
 
 #include "devices/bike.h"
+#include "devices/ifitlogcat.h"
 #include "virtualdevices/virtualbike.h"
 
 #ifdef Q_OS_IOS
@@ -42,6 +43,8 @@ class nordictrackifitadbbikeLogcatAdbThread : public QThread {
     void onHRM(int hrm);
 
   private:
+    // runCommand() is called by the device, the command is sent by this thread
+    QMutex adbCommandMutex;
     QString adbCommandPending = "";
     QString runAdbCommand(QString command);
     double speed = 0;
@@ -55,6 +58,11 @@ class nordictrackifitadbbikeLogcatAdbThread : public QThread {
     };
 
     void runAdbTailCommand(QString command);
+    void runPendingCommand();
+#ifdef Q_OS_WINDOWS
+    // created by run() on Windows, where adb runs as a process
+    ifitadbshell *shell = nullptr;
+#endif
 };
 
 class nordictrackifitadbbike : public bike {
@@ -66,13 +74,22 @@ class nordictrackifitadbbike : public bike {
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     bool inclinationAvailableByHardware() override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;    
+    double wattsFromResistance(double inclination, double cadence) override;
+
+    /**
+     * @brief Parses a chunk of the logcat of the console, split anywhere, as the UDP datagrams do with whole lines:
+     * a capture can be replayed through the device.
+     */
+    void logcat(const QByteArray &chunk);
+
+  protected:
+    void buildPowerSurface(powersurface &surface) override;
 
   private:
     const resistance_t max_resistance = 17; // max inclination for s22i
     void forceResistance(double resistance);
     uint16_t watts() override;
-    double getDouble(QString v);
-    uint16_t wattsFromResistance(double inclination, double cadence);
+    void applyLogcat();
 
     QTimer *refresh;
 
@@ -94,6 +111,7 @@ class nordictrackifitadbbike : public bike {
     QHostAddress lastSender;
 
     nordictrackifitadbbikeLogcatAdbThread *logcatAdbThread = nullptr;
+    ifitlogcatparser logcatParser;
 
     QString lastCommand;
 
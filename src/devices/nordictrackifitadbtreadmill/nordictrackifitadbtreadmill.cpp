@@ -22,18 +22,23 @@ void nordictrackifitadbtreadmillLogcatAdbThread::run() {
     QString ip = settings.value(QZSettings::nordictrack_2950_ip, QZSettings::default_nordictrack_2950_ip).toString();
     runAdbCommand("connect " + ip);
 
+#ifdef Q_OS_WINDOWS
+    // one adb shell for all the commands, instead of one adb for each one
+    shell = new ifitadbshell();
+    connect(shell, &ifitadbshell::debug, this, &nordictrackifitadbtreadmillLogcatAdbThread::debug);
+#endif
+
     while (!stop) 
     {
         runAdbTailCommand("logcat");
-#ifndef Q_OS_WINDOWS        
-        if(adbCommandPending.length() != 0) {
-            runAdbCommand(adbCommandPending);
-            adbCommandPending = "";
-        }
+        runPendingCommand();
         msleep(100);        
-#endif        
     }
 
+#ifdef Q_OS_WINDOWS
+    delete shell;
+    shell = nullptr;
+#endif
 }
 
 QString nordictrackifitadbtreadmillLogcatAdbThread::runAdbCommand(QString command) {
@@ -55,6 +60,7 @@ QString nordictrackifitadbtreadmillLogcatAdbThread::runAdbCommand(QString comman
 }
 
 bool nordictrackifitadbtreadmillLogcatAdbThread::runCommand(QString command) {
+    QMutexLocker locker(&adbCommandMutex);
     if(adbCommandPending.length() == 0) {
         adbCommandPending = command;
         return true;
@@ -62,57 +68,55 @@ bool nordictrackifitadbtreadmillLogcatAdbThread::runCommand(QString command) {
     return false;
 }
 
+void nordictrackifitadbtreadmillLogcatAdbThread::runPendingCommand() {
+    QString command;
+    {
+        QMutexLocker locker(&adbCommandMutex);
+        command = adbCommandPending;
+    }
+    if (command.length() == 0)
+        return;
+#ifdef Q_OS_WINDOWS
+    shell->send(command);
+#endif
+    QMutexLocker locker(&adbCommandMutex);
+    adbCommandPending = "";
+}
+
 void nordictrackifitadbtreadmillLogcatAdbThread::runAdbTailCommand(QString command) {
 #ifdef Q_OS_WINDOWS
-    auto process = new QProcess;
-    QObject::connect(process, &QProcess::readyReadStandardOutput, [process, this]() {
-        if(stop) {
-            process->close();
-            return;
-        }
-        QString output = process->readAllStandardOutput();
-        qDebug() << "adbLogCat STDOUT << " << output;
-        QStringList lines = output.split('\n', Qt::SplitBehaviorFlags::SkipEmptyParts);
-        bool wattFound = false;
-        foreach (QString line, lines) {
-            if (line.contains("Changed KPH")) {
-                emit debug(line);
-                speed = line.split(' ').last().toDouble();
-            } else if (line.contains("Changed Grade")) {
-                emit debug(line);
-                inclination = line.split(' ').last().toDouble();
-            } else if (line.contains("Changed Watts")) {
-                emit debug(line);
-                watt = line.split(' ').last().toDouble();
-                wattFound = true;
-            }
-        }
+    QProcess process;
+    ifitlogcatparser parser;
+    QObject::connect(&process, &QProcess::readyReadStandardOutput, [&process, &parser, this]() {
+        // the lines are split anywhere between two reads
+        parser.feed(process.readAllStandardOutput());
+        const quint32 events = parser.take();
+        if (ifitlogcatparser::has(events, ifitlogcatparser::KPH))
+            speed = parser.value(ifitlogcatparser::KPH);
+        if (ifitlogcatparser::has(events, ifitlogcatparser::GRADE))
+            inclination = parser.value(ifitlogcatparser::GRADE);
         emit onSpeedInclination(speed, inclination);
-        if (wattFound)
+        if (ifitlogcatparser::has(events, ifitlogcatparser::WATTS)) {
+            watt = parser.value(ifitlogcatparser::WATTS);
             emit onWatt(watt);
-#ifdef Q_OS_WINDOWS        
-        if(adbCommandPending.length() != 0) {
-            runAdbCommand(adbCommandPending);
-            adbCommandPending = "";
         }
-#endif                    
     });
-    QObject::connect(process, &QProcess::readyReadStandardError, [process, this]() {
-        auto output = process->readAllStandardError();
+    QObject::connect(&process, &QProcess::readyReadStandardError, [&process, this]() {
+        auto output = process.readAllStandardError();
         emit debug("adbLogCat ERROR << " + output);
     });
     emit debug("adbLogCat >> " + command);
-    process->start("adb/adb.exe", QStringList(command.split(' ')));
-    process->waitForFinished(-1);
-#endif
-}
-
-double nordictrackifitadbtreadmill::getDouble(QString v) {
-    QChar d = QLocale().decimalPoint();
-    if (d == ',') {
-        v = v.replace('.', ',');
+    process.start("adb/adb.exe", QStringList(command.split(' ')));
+    // the commands are sent while logcat runs, at most 100ms after the device asked
+    while (process.state() != QProcess::NotRunning && !process.waitForFinished(100)) {
+        if (stop) {
+            process.kill();
+            process.waitForFinished(1000);
+            break;
+        }
+        runPendingCommand();
     }
-    return QLocale().toDouble(v);
+#endif
 }
 
 nordictrackifitadbtreadmill::nordictrackifitadbtreadmill(bool noWriteResistance, bool noHeartService) {
@@ -213,40 +217,11 @@ void nordictrackifitadbtreadmill::processPendingDatagrams() {
         QString heartRateBeltName =
             settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
         double weight = settings.value(QZSettings::weight, QZSettings::default_weight).toFloat();
-        bool disable_hr_frommachinery =
-            settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool();
-
-        double speed = 0;
-        double incline = 0;
-        bool hrmFound = false;
-        QStringList lines = QString::fromLocal8Bit(datagram.data()).split("\n");
-        foreach (QString line, lines) {
-            qDebug() << line;
-            if (line.contains(QStringLiteral("Changed KPH"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    speed = getDouble(aValues.last());
-                    Speed = speed;
-                }
-            } else if (line.contains(QStringLiteral("Changed Grade"))) {
-                QStringList aValues = line.split(" ");
-                if (aValues.length()) {
-                    incline = getDouble(aValues.last());
-                    Inclination = incline;
-                }
-            } else if (line.contains("HeartRateDataUpdate") && 
-#ifdef Q_OS_ANDROID
-                        (!settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool()) &&
-#endif
-                        heartRateBeltName.startsWith(QStringLiteral("Disabled")) && !disable_hr_frommachinery
-            ) {                
-                QStringList splitted = line.split(' ', Qt::SkipEmptyParts);
-                if (splitted.length() > 14) {
-                    Heart = splitted[14].toInt();
-                    hrmFound = true;
-                }
-            }
-        }
+
+        // a datagram ends with a whole line, even without its line feed
+        logcatParser.feed(datagram);
+        logcatParser.finish();
+        applyLogcat();
 
         double inc = qRound(requestInclination / 0.5) * 0.5;
         if(inc == currentInclination().value()) {
@@ -295,7 +270,7 @@ void nordictrackifitadbtreadmill::processPendingDatagrams() {
                                                           "(Ljava/lang/String;)V", command.object<jstring>());
 #elif defined(Q_OS_WIN)
                         if (logcatAdbThread)
-                            logcatAdbThread->runCommand("shell " + lastCommand);                                                          
+                            logcatAdbThread->runCommand(lastCommand);                                                          
 #elif defined Q_OS_IOS
 #ifndef IO_UNDER_QT
                 h->adb_sendcommand(lastCommand.toStdString().c_str());
@@ -332,7 +307,7 @@ void nordictrackifitadbtreadmill::processPendingDatagrams() {
                                                         "(Ljava/lang/String;)V", command.object<jstring>());
 #elif defined(Q_OS_WIN)
                         if (logcatAdbThread)
-                            logcatAdbThread->runCommand("shell " + lastCommand);                                                        
+                            logcatAdbThread->runCommand(lastCommand);                                                        
 #elif defined Q_OS_IOS
 #ifndef IO_UNDER_QT
                 h->adb_sendcommand(lastCommand.toStdString().c_str());
@@ -386,6 +361,35 @@ void nordictrackifitadbtreadmill::processPendingDatagrams() {
     }
 }
 
+void nordictrackifitadbtreadmill::logcat(const QByteArray &chunk) {
+    logcatParser.feed(chunk);
+    applyLogcat();
+}
+
+void nordictrackifitadbtreadmill::applyLogcat() {
+    const quint32 events = logcatParser.take();
+    if (!events)
+        return;
+
+    QSettings settings;
+    QString heartRateBeltName =
+        settings.value(QZSettings::heart_rate_belt_name, QZSettings::default_heart_rate_belt_name).toString();
+    bool disable_hr_frommachinery =
+        settings.value(QZSettings::heart_ignore_builtin, QZSettings::default_heart_ignore_builtin).toBool();
+
+    if (ifitlogcatparser::has(events, ifitlogcatparser::KPH))
+        Speed = logcatParser.value(ifitlogcatparser::KPH);
+    if (ifitlogcatparser::has(events, ifitlogcatparser::GRADE))
+        Inclination = logcatParser.value(ifitlogcatparser::GRADE);
+    if (ifitlogcatparser::has(events, ifitlogcatparser::HEART_RATE) &&
+#ifdef Q_OS_ANDROID
+        (!settings.value(QZSettings::ant_heart, QZSettings::default_ant_heart).toBool()) &&
+#endif
+        heartRateBeltName.startsWith(QStringLiteral("Disabled")) && !disable_hr_frommachinery) {
+        Heart = (int)logcatParser.value(ifitlogcatparser::HEART_RATE);
+    }
+}
+
 /*
 void nordictrackifitadbtreadmill::writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool
 disable_log, bool wait_for_response) { QEventLoop loop; QTimer timeout; if (wait_for_response) {
@@ -19,6 +19,7 @@
 #include <QThread>
 #include <QUdpSocket>
 
+#include "devices/ifitlogcat.h"
 #include "treadmill.h"
 
 #ifdef Q_OS_IOS
@@ -41,6 +42,8 @@ class nordictrackifitadbtreadmillLogcatAdbThread : public QThread {
     void onWatt(double watt);
 
   private:
+    // runCommand() is called by the device, the command is sent by this thread
+    QMutex adbCommandMutex;
     QString adbCommandPending = "";
     double speed = 0;
     double inclination = 0;
@@ -53,6 +56,11 @@ class nordictrackifitadbtreadmillLogcatAdbThread : public QThread {
 
     QString runAdbCommand(QString command);
     void runAdbTailCommand(QString command);
+    void runPendingCommand();
+#ifdef Q_OS_WINDOWS
+    // created by run() on Windows, where adb runs as a process
+    ifitadbshell *shell = nullptr;
+#endif
 };
 
 class nordictrackifitadbtreadmill : public treadmill {
@@ -63,10 +71,15 @@ class nordictrackifitadbtreadmill : public treadmill {
     bool canStartStop() override { return false; }
     double minStepSpeed() override { return 0.1; }
 
+    /**
+     * @brief Parses a chunk of the logcat of the console, split anywhere, as the UDP datagrams do with whole lines:
+     * a capture can be replayed through the device.
+     */
+    void logcat(const QByteArray &chunk);
+
   private:
     void forceIncline(double incline);
     void forceSpeed(double speed);
-    double getDouble(QString v);
     void initiateThreadStop();
 
     QTimer *refresh;
@@ -90,6 +103,9 @@ class nordictrackifitadbtreadmill : public treadmill {
     nordictrackifitadbtreadmillLogcatAdbThread *logcatAdbThread = nullptr;
 
     int x14i_inclination_lookuptable(double reqInclination);
+    void applyLogcat();
+
+    ifitlogcatparser logcatParser;
 
 #ifdef Q_OS_IOS
     lockscreen *h = 0;
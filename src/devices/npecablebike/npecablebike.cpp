@@ -182,7 +182,7 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
         if (!settings.value(QZSettings::speed_power_based, QZSettings::default_speed_power_based).toBool()) {
             Speed = Cadence.value() * settings.value(QZSettings::cadence_sensor_speed_ratio, QZSettings::default_cadence_sensor_speed_ratio).toDouble();
         } else {
-            Speed = metric::calculateSpeedFromPower(watts(),  Inclination.value(), Speed.value(),fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed = metric::calculateSpeedFromPower(watts(),  Inclination.value(), Speed.value(),Speed.secondsSinceLastChanged(), this->speedLimit());
         }
         emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
 
@@ -251,7 +251,7 @@ void npecablebike::characteristicChanged(const QLowEnergyCharacteristic &charact
                                   (uint16_t)((uint8_t)newValue.at(index)))) /
                         100.0;
             } else {
-                Speed = metric::calculateSpeedFromPower(watts(), Inclination.value(), Speed.value(),fabs(now.msecsTo(Speed.lastChanged()) / 1000.0),  this->speedLimit());
+                Speed = metric::calculateSpeedFromPower(watts(), Inclination.value(), Speed.value(),Speed.secondsSinceLastChanged(),  this->speedLimit());
             }
             index += 2;
             emit debug(QStringLiteral("Current Speed: ") + QString::number(Speed.value()));
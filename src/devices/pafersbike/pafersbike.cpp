@@ -144,36 +144,18 @@ void pafersbike::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t pafersbike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
 resistance_t pafersbike::resistanceFromPowerRequest(uint16_t power) {
     qDebug() << QStringLiteral("resistanceFromPowerRequest") << Cadence.value();
 
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return max_resistance;
+    return powerSurface().resistance(power, Cadence.value());
 }
 
-uint16_t pafersbike::wattsFromResistance(double resistance) {
+double pafersbike::wattsFromResistance(double resistance, double cadence) {
     // to be changed
-    return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (currentCadence().value()))));
+    return ((10.39 + 1.45 * (resistance - 1.0)) * (exp(0.028 * (cadence))));
 }
 
 double pafersbike::bikeResistanceToPeloton(double resistance) {
@@ -217,7 +199,7 @@ void pafersbike::characteristicChanged(const QLowEnergyCharacteristic &character
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
 
     Resistance = ((uint8_t)newValue.at(5));
@@ -0,0 +1,180 @@
+#include "devices/powersurface.h"
+
+#include <QFile>
+#include <QMap>
+#include <QTextStream>
+#include <algorithm>
+#include <cmath>
+
+void powersurface::build(int minResistance, int maxResistance, const model &watts) {
+    minLevel = minResistance;
+    maxLevel = qMax(minResistance, maxResistance);
+    levels = maxLevel - minLevel + 1;
+    table.assign((size_t)levels * (maxCadence + 1), 0);
+    for (int c = 0; c <= maxCadence; c++) {
+        for (int l = 0; l < levels; l++) {
+            const double w = watts(minLevel + l, c);
+            table[(size_t)c * levels + l] = (std::isnan(w) || w < 0) ? 0 : w;
+        }
+    }
+    makeMonotone();
+}
+
+void powersurface::clear() {
+    table.clear();
+    maxLevel = -1;
+    levels = 0;
+}
+
+void powersurface::makeMonotone() {
+    // the fits can bend down at the ends of their range: a level never gives less power than the one below
+    for (int c = 0; c <= maxCadence; c++) {
+        double *column = table.data() + (size_t)c * levels;
+        for (int l = 1; l < levels; l++)
+            column[l] = qMax(column[l], column[l - 1]);
+    }
+}
+
+double powersurface::at(int level, double cadence) const {
+    const double c = qBound(0.0, cadence, (double)maxCadence);
+    const int c0 = (int)c;
+    const int c1 = qMin(c0 + 1, maxCadence);
+    const double t = c - c0;
+    return table[(size_t)c0 * levels + level] * (1 - t) + table[(size_t)c1 * levels + level] * t;
+}
+
+double powersurface::watts(double resistance, double cadence) const {
+    if (table.empty())
+        return 0;
+    const double r = qBound((double)minLevel, resistance, (double)maxLevel) - minLevel;
+    const int l0 = (int)r;
+    const int l1 = qMin(l0 + 1, levels - 1);
+    const double t = r - l0;
+    return at(l0, cadence) * (1 - t) + at(l1, cadence) * t;
+}
+
+int powersurface::firstReaching(double power, double cadence) const {
+    int lo = 0, hi = levels;
+    while (lo < hi) {
+        const int mid = (lo + hi) / 2;
+        if (at(mid, cadence) < power)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+int powersurface::resistance(double power, double cadence) const {
+    if (table.empty())
+        return minLevel;
+    const int lo = firstReaching(power, cadence);
+    if (lo == levels)
+        return maxLevel;
+    if (lo == 0)
+        return minLevel;
+    return minLevel + lo - 1;
+}
+
+double powersurface::exactResistance(double power, double cadence) const {
+    if (table.empty())
+        return minLevel;
+    const int lo = firstReaching(power, cadence);
+    if (lo == levels)
+        return maxLevel;
+    if (lo == 0)
+        return minLevel;
+    const double below = at(lo - 1, cadence);
+    const double above = at(lo, cadence);
+    return minLevel + lo - 1 + (above > below ? (power - below) / (above - below) : 0);
+}
+
+int powersurface::importCalibration(QIODevice *device) {
+    if (table.empty() || !device)
+        return 0;
+
+    // level -> cadence -> watts
+    QMap<int, QMap<double, double>> measures;
+    int count = 0;
+    QTextStream in(device);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split(',');
+        if (fields.size() < 3)
+            continue;
+        bool okCadence, okResistance, okWatts;
+        const double cadence = fields.at(0).trimmed().toDouble(&okCadence);
+        const double resistance = fields.at(1).trimmed().toDouble(&okResistance);
+        const double watts = fields.at(2).trimmed().toDouble(&okWatts);
+        if (!okCadence || !okResistance || !okWatts || cadence <= 0 || watts < 0)
+            continue;
+        const int level = qRound(resistance);
+        if (level < minLevel || level > maxLevel)
+            continue;
+        measures[level].insert(cadence, watts);
+        count++;
+    }
+    if (!count)
+        return 0;
+
+    for (auto level = measures.constBegin(); level != measures.constEnd(); ++level) {
+        const QList<double> cadences = level.value().keys();
+        const QList<double> watts = level.value().values();
+        const int l = level.key() - minLevel;
+        int segment = 0;
+        for (int c = 0; c <= maxCadence; c++) {
+            double w;
+            if (c <= cadences.first()) {
+                // no power without pedalling
+                w = watts.first() * c / cadences.first();
+            } else if (c >= cadences.last()) {
+                w = watts.last() * c / cadences.last();
+            } else {
+                while (cadences.at(segment + 1) < c)
+                    segment++;
+                const double t = (c - cadences.at(segment)) / (cadences.at(segment + 1) - cadences.at(segment));
+                w = watts.at(segment) + (watts.at(segment + 1) - watts.at(segment)) * t;
+            }
+            table[(size_t)c * levels + l] = w;
+        }
+    }
+    makeMonotone();
+    return count;
+}
+
+int powersurface::importCalibration(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return 0;
+    return importCalibration(&file);
+}
+
+void pelotonmap::build(int minResistance, int maxResistance,
+                       const std::function<double(double resistance)> &toPeloton) {
+    minLevel = minResistance;
+    table.resize(qMax(minResistance, maxResistance) - minResistance + 1);
+    for (size_t l = 0; l < table.size(); l++) {
+        const double p = toPeloton(minLevel + (int)l);
+        table[l] = std::isnan(p) ? 0 : p;
+        if (l)
+            table[l] = qMax(table[l], table[l - 1]);
+    }
+}
+
+double pelotonmap::peloton(int resistance) const {
+    if (table.empty())
+        return 0;
+    return table[qBound(0, resistance - minLevel, (int)table.size() - 1)];
+}
+
+int pelotonmap::resistance(double pelotonResistance, bool strict) const {
+    if (table.empty())
+        return minLevel;
+    // the first level above the Peloton resistance, or reaching it
+    const auto first = strict ? std::upper_bound(table.begin(), table.end(), pelotonResistance)
+                              : std::lower_bound(table.begin(), table.end(), pelotonResistance);
+    if (first == table.end())
+        return maxResistance();
+    if (first == table.begin())
+        return minLevel;
+    return minLevel + (int)(first - table.begin()) - 1;
+}
@@ -0,0 +1,97 @@
+#ifndef POWERSURFACE_H
+#define POWERSURFACE_H
+
+#include <QString>
+#include <functional>
+#include <vector>
+
+class QIODevice;
+
+/**
+ * @brief The power of a trainer over its resistance levels and the cadence, tabulated once from the model of the
+ * driver instead of evaluating its fit for every level at every power request. Each cadence column is made non
+ * decreasing with the resistance, so the resistance for a power is a binary search.
+ */
+class powersurface {
+  public:
+    typedef std::function<double(double resistance, double cadence)> model;
+
+    /**
+     * @brief The cadences tabulated, in steps of 1 rpm from 0. Beyond it the last column is used.
+     */
+    static constexpr int maxCadence = 200;
+
+    /**
+     * @brief Evaluates the model at every level from minResistance to maxResistance and every cadence. Negative or
+     * undefined watts are taken as 0.
+     */
+    void build(int minResistance, int maxResistance, const model &watts);
+    void clear();
+    bool isEmpty() const { return table.empty(); }
+    int minResistance() const { return minLevel; }
+    int maxResistance() const { return maxLevel; }
+
+    /**
+     * @brief The watts at a resistance and a cadence, interpolated between the levels and the cadences.
+     */
+    double watts(double resistance, double cadence) const;
+
+    /**
+     * @brief The resistance for a power at a cadence, as the linear scans of the drivers found it: the lowest level r
+     * where watts(r) <= power <= watts(r + 1), the minimum below the table and the maximum above it.
+     */
+    int resistance(double power, double cadence) const;
+
+    /**
+     * @brief The resistance giving the power, interpolated between the levels and clamped to the table.
+     */
+    double exactResistance(double power, double cadence) const;
+
+    /**
+     * @brief Replaces the model with measures, CSV lines of cadence,resistance,watts (a header line is skipped). The
+     * levels measured are interpolated along the cadence between their measures, the other levels keep the model.
+     * @return the number of measures used, 0 if none could be read.
+     */
+    int importCalibration(QIODevice *device);
+    int importCalibration(const QString &fileName);
+
+  private:
+    // cadence major: the levels of a cadence are contiguous for the binary search
+    std::vector<double> table;
+    int minLevel = 0;
+    int maxLevel = -1;
+    int levels = 0;
+
+    double at(int level, double cadence) const;
+    // the index of the first level reaching the power at the cadence, levels if none
+    int firstReaching(double power, double cadence) const;
+    void makeMonotone();
+};
+
+/**
+ * @brief The Peloton resistance of each resistance level of a bike, tabulated once with the gain and the offset of
+ * the user, for the inverse lookup by binary search.
+ */
+class pelotonmap {
+  public:
+    void build(int minResistance, int maxResistance, const std::function<double(double resistance)> &toPeloton);
+    void clear() { table.clear(); }
+    bool isEmpty() const { return table.empty(); }
+    int minResistance() const { return minLevel; }
+    int maxResistance() const { return minLevel + (int)table.size() - 1; }
+
+    double peloton(int resistance) const;
+
+    /**
+     * @brief The level for a Peloton resistance, as the linear scans of the drivers found it: the lowest level r where
+     * peloton(r) <= pelotonResistance <= peloton(r + 1) (< if strict), the minimum below the table and the maximum
+     * above it.
+     */
+    int resistance(double pelotonResistance, bool strict = false) const;
+
+  private:
+    std::vector<double> table;
+    int minLevel = 0;
+};
+
+#endif // POWERSURFACE_H
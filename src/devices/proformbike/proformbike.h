@@ -38,13 +38,13 @@ class proformbike : public bike {
     proformbike(bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset, double bikeResistanceGain);
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool inclinationAvailableByHardware() override;
     bool connected() override;
 
   private:
     resistance_t max_resistance = 16;
-    uint16_t wattsFromResistance(resistance_t resistance);
     double GetDistanceFromPacket(QByteArray packet);
     QTime GetElapsedFromPacket(QByteArray packet);
     void btinit();
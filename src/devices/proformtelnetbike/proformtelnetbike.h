@@ -49,6 +49,7 @@ class proformtelnetbike : public bike {
                     double bikeResistanceGain);
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool inclinationAvailableByHardware() override;
     bool connected() override;
@@ -59,7 +60,6 @@ class proformtelnetbike : public bike {
     resistance_t min_resistance = -20;
     double max_incline_supported = 20;
     void connectToDevice();
-    uint16_t wattsFromResistance(resistance_t resistance);
     double GetDistanceFromPacket(QByteArray packet);
     QTime GetElapsedFromPacket(QByteArray packet);
     void btinit();
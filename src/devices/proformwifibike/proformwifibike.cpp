@@ -2,6 +2,7 @@
 #ifdef Q_OS_ANDROID
 #include "keepawakehelper.h"
 #endif
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QDateTime>
 #include <QFile>
@@ -115,96 +116,84 @@ void proformwifibike::writeCharacteristic(uint8_t *data, uint8_t data_len, const
 resistance_t proformwifibike::resistanceFromPowerRequest(uint16_t power) {
     qDebug() << QStringLiteral("resistanceFromPowerRequest") << Cadence.value();
 
-    QSettings settings;
-
-    double watt_gain = settings.value(QZSettings::watt_gain, QZSettings::default_watt_gain).toDouble();
-    double watt_offset = settings.value(QZSettings::watt_offset, QZSettings::default_watt_offset).toDouble();
-
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (((wattsFromResistance(i) * watt_gain) + watt_offset) <= power &&
-            ((wattsFromResistance(i + 1) * watt_gain) + watt_offset) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest")
-                     << ((wattsFromResistance(i) * watt_gain) + watt_offset)
-                     << ((wattsFromResistance(i + 1) * watt_gain) + watt_offset) << power;
-            return i;
-        }
-    }
-    if (power < ((wattsFromResistance(1) * watt_gain) + watt_offset))
-        return 1;
-    else
-        return max_resistance;
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    // without a gain every level has the power of the offset
+    if (settings.watt_gain == 0)
+        return power <= settings.watt_offset ? 1 : max_resistance;
+    // the table holds the power of the model, before the gain and the offset of the user
+    return powerSurface().resistance((power - settings.watt_offset) / settings.watt_gain, Cadence.value());
 }
 
-uint16_t proformwifibike::wattsFromResistance(resistance_t resistance) {
+double proformwifibike::wattsFromResistance(double resistance, double cadence) {
 
-    if (currentCadence().value() == 0)
+    if (cadence == 0)
         return 0;
 
-    switch (resistance) {
+    switch ((int)resistance) {
     case 0:
     case 1:
         // -13.5 + 0.999x + 0.00993x²
-        return (-13.5 + (0.999 * currentCadence().value()) + (0.00993 * pow(currentCadence().value(), 2)));
+        return (-13.5 + (0.999 * cadence) + (0.00993 * pow(cadence, 2)));
     case 2:
         // -17.7 + 1.2x + 0.0116x²
-        return (-17.7 + (1.2 * currentCadence().value()) + (0.0116 * pow(currentCadence().value(), 2)));
+        return (-17.7 + (1.2 * cadence) + (0.0116 * pow(cadence, 2)));
 
     case 3:
         // -17.5 + 1.24x + 0.014x²
-        return (-17.5 + (1.24 * currentCadence().value()) + (0.014 * pow(currentCadence().value(), 2)));
+        return (-17.5 + (1.24 * cadence) + (0.014 * pow(cadence, 2)));
 
     case 4:
         // -20.9 + 1.43x + 0.016x²
-        return (-20.9 + (1.43 * currentCadence().value()) + (0.016 * pow(currentCadence().value(), 2)));
+        return (-20.9 + (1.43 * cadence) + (0.016 * pow(cadence, 2)));
 
     case 5:
         // -27.9 + 1.75x+0.0172x²
-        return (-27.9 + (1.75 * currentCadence().value()) + (0.0172 * pow(currentCadence().value(), 2)));
+        return (-27.9 + (1.75 * cadence) + (0.0172 * pow(cadence, 2)));
 
     case 6:
         // -26.7 + 1.9x + 0.0201x²
-        return (-26.7 + (1.9 * currentCadence().value()) + (0.0201 * pow(currentCadence().value(), 2)));
+        return (-26.7 + (1.9 * cadence) + (0.0201 * pow(cadence, 2)));
 
     case 7:
         // -33.5 + 2.23x + 0.0225x²
-        return (-33.5 + (2.23 * currentCadence().value()) + (0.0225 * pow(currentCadence().value(), 2)));
+        return (-33.5 + (2.23 * cadence) + (0.0225 * pow(cadence, 2)));
 
     case 8:
         // -36.5+2.5x+0.0262x²
-        return (-36.5 + (2.5 * currentCadence().value()) + (0.0262 * pow(currentCadence().value(), 2)));
+        return (-36.5 + (2.5 * cadence) + (0.0262 * pow(cadence, 2)));
 
     case 9:
         // -38+2.62x+0.0305x²
-        return (-38.0 + (2.62 * currentCadence().value()) + (0.0305 * pow(currentCadence().value(), 2)));
+        return (-38.0 + (2.62 * cadence) + (0.0305 * pow(cadence, 2)));
 
     case 10:
         // -41.2+2.85x+0.0327x²
-        return (-41.2 + (2.85 * currentCadence().value()) + (0.0327 * pow(currentCadence().value(), 2)));
+        return (-41.2 + (2.85 * cadence) + (0.0327 * pow(cadence, 2)));
 
     case 11:
         // -43.4+3.01x+0.0359x²
-        return (-43.4 + (3.01 * currentCadence().value()) + (0.0359 * pow(currentCadence().value(), 2)));
+        return (-43.4 + (3.01 * cadence) + (0.0359 * pow(cadence, 2)));
 
     case 12:
         // -46.8+3.23x+0.0364x²
-        return (-46.8 + (3.23 * currentCadence().value()) + (0.0364 * pow(currentCadence().value(), 2)));
+        return (-46.8 + (3.23 * cadence) + (0.0364 * pow(cadence, 2)));
 
     case 13:
         // -49+3.39x+0.0371x²
-        return (-49.0 + (3.39 * currentCadence().value()) + (0.0371 * pow(currentCadence().value(), 2)));
+        return (-49.0 + (3.39 * cadence) + (0.0371 * pow(cadence, 2)));
 
     case 14:
         // -53.4+3.55x+0.0383x²
-        return (-53.4 + (3.55 * currentCadence().value()) + (0.0383 * pow(currentCadence().value(), 2)));
+        return (-53.4 + (3.55 * cadence) + (0.0383 * pow(cadence, 2)));
 
     case 15:
         // -49.9+3.37x+0.0429x²
-        return (-49.9 + (3.37 * currentCadence().value()) + (0.0429 * pow(currentCadence().value(), 2)));
+        return (-49.9 + (3.37 * cadence) + (0.0429 * pow(cadence, 2)));
 
     case 16:
     default:
         // -47.1+3.25x+0.0464x²
-        return (-47.1 + (3.25 * currentCadence().value()) + (0.0464 * pow(currentCadence().value(), 2)));
+        return (-47.1 + (3.25 * cadence) + (0.0464 * pow(cadence, 2)));
     }
 }
 
@@ -446,7 +435,7 @@ void proformwifibike::characteristicChanged(const QString &newValue) {
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
 
         Distance += ((Speed.value() / 3600000.0) *
                     ((double)lastRefreshCharacteristicChanged.msecsTo(now)));
@@ -46,6 +46,7 @@ class proformwifibike : public bike {
                     double bikeResistanceGain);
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool inclinationAvailableByHardware() override;
     bool connected() override;
@@ -56,7 +57,6 @@ class proformwifibike : public bike {
     resistance_t min_resistance = -20;
     double max_incline_supported = 20;
     void connectToDevice();
-    uint16_t wattsFromResistance(resistance_t resistance);
     double GetDistanceFromPacket(QByteArray packet);
     QTime GetElapsedFromPacket(QByteArray packet);
     void btinit();
@@ -1,5 +1,6 @@
 #include "renphobike.h"
 #include "devices/ftmsbike/ftmsbike.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -226,7 +227,7 @@ void renphobike::characteristicChanged(const QLowEnergyCharacteristic &character
         else
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         index += 2;
         debug("Current Speed: " + QString::number(Speed.value()));
     }
@@ -688,11 +689,11 @@ void renphobike::deviceDiscovered(const QBluetoothDeviceInfo &device) {
 }
 
 resistance_t renphobike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance - 1; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance)
-            return i;
-    }
-    return Resistance.value();
+    const pelotonmap &map = pelotonMap();
+    // out of the levels below the last one, the resistance doesn't change
+    if (pelotonResistance < map.peloton(1) || pelotonResistance > map.peloton(max_resistance - 1))
+        return Resistance.value();
+    return map.resistance(pelotonResistance);
 }
 
 // todo, probably the best way is to use the SET_TARGET_POWER over FTMS
@@ -713,13 +714,9 @@ uint8_t renphobike::resistanceFromPowerRequest(uint16_t power)
 }*/
 
 double renphobike::bikeResistanceToPeloton(double resistance) {
-    QSettings settings;
-    bool renpho_peloton_conversion_v2 =
-        settings.value(QZSettings::renpho_peloton_conversion_v2, QZSettings::default_renpho_peloton_conversion_v2)
-            .toBool();
-    bool renpho_bike_double_resistance =
-        settings.value(QZSettings::renpho_bike_double_resistance, QZSettings::default_renpho_bike_double_resistance)
-            .toBool();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool renpho_peloton_conversion_v2 = settings.renpho_peloton_conversion_v2;
+    bool renpho_bike_double_resistance = settings.renpho_bike_double_resistance;
 
     if (renpho_bike_double_resistance)
         resistance = resistance / 2.0;
@@ -1,9 +1,15 @@
 
 #include "rower.h"
 #include "qdebugfixup.h"
+#include "qzsettingssnapshot.h"
 #include <QSettings>
 
-rower::rower() {}
+rower::rower() {
+    connect(QZSettingsSnapshot::instance(), &QZSettingsSnapshot::changed, this, [this]() {
+        m_powerSurface.clear();
+        m_pelotonMap.clear();
+    });
+}
 
 void rower::changeSpeed(double speed) {
     qDebug() << "changeSpeed" << speed;
@@ -39,19 +45,59 @@ void rower::changePower(int32_t power) {
 }
 double rower::currentCrankRevolutions() { return CrankRevs; }
 uint16_t rower::lastCrankEventTime() { return LastCrankEventTime; }
-metric rower::lastRequestedResistance() { return RequestedResistance; }
-metric rower::lastRequestedPelotonResistance() { return RequestedPelotonResistance; }
-metric rower::lastRequestedCadence() { return RequestedCadence; }
-metric rower::lastRequestedPower() { return RequestedPower; }
-metric rower::currentResistance() { return Resistance; }
-metric rower::currentStrokesCount() { return StrokesCount; }
-metric rower::currentStrokesLength() { return StrokesLength; }
+const metric &rower::lastRequestedResistance() { return RequestedResistance; }
+const metric &rower::lastRequestedPelotonResistance() { return RequestedPelotonResistance; }
+const metric &rower::lastRequestedCadence() { return RequestedCadence; }
+const metric &rower::lastRequestedPower() { return RequestedPower; }
+const metric &rower::currentResistance() { return Resistance; }
+const metric &rower::currentStrokesCount() { return StrokesCount; }
+const metric &rower::currentStrokesLength() { return StrokesLength; }
 uint8_t rower::fanSpeed() { return FanSpeed; }
 bool rower::connected() { return false; }
 uint16_t rower::watts() { return 0; }
-metric rower::pelotonResistance() { return m_pelotonResistance; }
+const metric &rower::pelotonResistance() { return m_pelotonResistance; }
+void rower::fillTelemetry(devicetelemetry &telemetry) {
+    bluetoothdevice::fillTelemetry(telemetry);
+    telemetry.pelotonResistance = pelotonResistance().value();
+}
 resistance_t rower::pelotonToBikeResistance(int pelotonResistance) { return pelotonResistance; }
 resistance_t rower::resistanceFromPowerRequest(uint16_t power) { return power / 10; } // in order to have something
+double rower::wattsFromResistance(double resistance, double cadence) {
+    Q_UNUSED(resistance)
+    Q_UNUSED(cadence)
+    return -1;
+}
+double rower::bikeResistanceToPeloton(double resistance) { return resistance; }
+
+const powersurface &rower::powerSurface() {
+    if (m_powerSurface.isEmpty() || powerSurfaceMaxResistance != maxResistance()) {
+        powerSurfaceMaxResistance = maxResistance();
+        buildPowerSurface(m_powerSurface);
+        const QString calibration = QZSettingsSnapshot::get().power_calibration_file;
+        if (!calibration.isEmpty()) {
+            qDebug() << QStringLiteral("power calibration") << calibration
+                     << m_powerSurface.importCalibration(calibration) << QStringLiteral("measures");
+        }
+    }
+    return m_powerSurface;
+}
+
+const pelotonmap &rower::pelotonMap() {
+    if (m_pelotonMap.isEmpty() || pelotonMapMaxResistance != maxResistance()) {
+        pelotonMapMaxResistance = maxResistance();
+        buildPelotonMap(m_pelotonMap);
+    }
+    return m_pelotonMap;
+}
+
+void rower::buildPowerSurface(powersurface &surface) {
+    surface.build(1, maxResistance(),
+                  [this](double resistance, double cadence) { return wattsFromResistance(resistance, cadence); });
+}
+
+void rower::buildPelotonMap(pelotonmap &map) {
+    map.build(1, maxResistance(), [this](double resistance) { return bikeResistanceToPeloton(resistance); });
+}
 void rower::cadenceSensor(uint8_t cadence) { Cadence.setValue(cadence); }
 void rower::powerSensor(uint16_t power) { m_watt.setValue(power, false); }
 double rower::requestedSpeed() { return requestSpeed; }
@@ -2,6 +2,7 @@
 #define ROWER_H
 
 #include "devices/bluetoothdevice.h"
+#include "devices/powersurface.h"
 #include <QObject>
 
 class rower : public bluetoothdevice {
@@ -9,16 +10,16 @@ class rower : public bluetoothdevice {
 
   public:
     rower();
-    metric lastRequestedResistance();
-    metric lastRequestedPelotonResistance();
-    metric lastRequestedCadence();
-    metric lastRequestedPower();
-    metric lastRequestedSpeed() { return RequestedSpeed; }
+    const metric &lastRequestedResistance();
+    const metric &lastRequestedPelotonResistance();
+    const metric &lastRequestedCadence();
+    const metric &lastRequestedPower();
+    const metric &lastRequestedSpeed() { return RequestedSpeed; }
     QTime lastRequestedPace();
     virtual QTime lastPace500m();
-    metric currentResistance() override;
-    virtual metric currentStrokesCount();
-    virtual metric currentStrokesLength();
+    const metric &currentResistance() override;
+    virtual const metric &currentStrokesCount();
+    virtual const metric &currentStrokesLength();
     QTime currentPace() override;
     QTime averagePace() override;
     QTime maxPace() override;
@@ -30,8 +31,25 @@ class rower : public bluetoothdevice {
     virtual uint16_t watts();
     virtual resistance_t pelotonToBikeResistance(int pelotonResistance);
     virtual resistance_t resistanceFromPowerRequest(uint16_t power);
+    /**
+     * @brief The power model of the driver: the watts at a resistance and a cadence, -1 without a model.
+     */
+    virtual double wattsFromResistance(double resistance, double cadence);
+    /**
+     * @brief The Peloton resistance of a resistance level of the driver.
+     */
+    virtual double bikeResistanceToPeloton(double resistance);
+    /**
+     * @brief wattsFromResistance(resistance, cadence) tabulated the first time it's needed, with the calibration of
+     * the user if any. Built again when the settings or maxResistance() change.
+     */
+    const powersurface &powerSurface();
+    /**
+     * @brief bikeResistanceToPeloton() tabulated the same way.
+     */
+    const pelotonmap &pelotonMap();
     bluetoothdevice::BLUETOOTH_TYPE deviceType() override;
-    metric pelotonResistance();
+    const metric &pelotonResistance();
     void clearStats() override;
     void setLap() override;
     void setPaused(bool p) override;
@@ -54,6 +72,8 @@ class rower : public bluetoothdevice {
     void resistanceRead(resistance_t resistance);
 
   protected:
+    void fillTelemetry(devicetelemetry &telemetry) override;
+
     metric Resistance;
     metric RequestedResistance;
     metric RequestedPelotonResistance;
@@ -83,6 +103,19 @@ class rower : public bluetoothdevice {
     };
 
     QList<rowerSpeedDistance *> speedLast500mValues;
+
+    /**
+     * @brief Fill the tables over the resistances from 1 to maxResistance(): the drivers override them for another
+     * range or another model.
+     */
+    virtual void buildPowerSurface(powersurface &surface);
+    virtual void buildPelotonMap(pelotonmap &map);
+
+  private:
+    powersurface m_powerSurface;
+    pelotonmap m_pelotonMap;
+    resistance_t powerSurfaceMaxResistance = -1;
+    resistance_t pelotonMapMaxResistance = -1;
 };
 
 #endif // ROWER_H
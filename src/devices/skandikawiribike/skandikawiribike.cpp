@@ -216,7 +216,7 @@ void skandikawiribike::characteristicChanged(const QLowEnergyCharacteristic &cha
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
     } else if ((newValue.at(1) == 0x10 && X2000 == false) || (newValue.at(1) == 0x30 && X2000 == true)) {
         if (settings.value(QZSettings::cadence_sensor_name, QZSettings::default_cadence_sensor_name)
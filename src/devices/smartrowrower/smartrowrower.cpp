@@ -154,12 +154,11 @@ void smartrowrower::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t smartrowrower::pelotonToBikeResistance(int pelotonResistance) {
-    for (int i = 1; i < max_resistance - 1; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    return Resistance.value();
+    const pelotonmap &map = pelotonMap();
+    // out of the levels below the last one, the resistance doesn't change
+    if (pelotonResistance < map.peloton(1) || pelotonResistance > map.peloton(max_resistance - 1))
+        return Resistance.value();
+    return map.resistance(pelotonResistance);
 }
 
 resistance_t smartrowrower::resistanceFromPowerRequest(uint16_t power) {
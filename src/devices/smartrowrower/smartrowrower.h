@@ -40,10 +40,10 @@ class smartrowrower : public rower {
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
 
   private:
     const resistance_t max_resistance = 32;
-    double bikeResistanceToPeloton(double resistance);
     double GetDistanceFromPacket(const QByteArray &packet);
     uint16_t wattsFromResistance(double resistance);
     QTime GetElapsedFromPacket(QByteArray packet);
@@ -199,15 +199,7 @@ void solebike::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t solebike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
 double solebike::bikeResistanceToPeloton(double resistance) {
@@ -261,7 +253,7 @@ void solebike::characteristicChanged(const QLowEnergyCharacteristic &characteris
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
 
     m_watt = GetWattFromPacket(newValue);
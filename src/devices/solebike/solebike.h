@@ -39,11 +39,11 @@ class solebike : public bike {
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
 
   private:
     bool r92 = false;
     const resistance_t max_resistance = 40;
-    double bikeResistanceToPeloton(double resistance);
     double GetDistanceFromPacket(const QByteArray &packet);
     double GetSpeedFromPacket(const QByteArray &packet);
     double GetWattFromPacket(const QByteArray &packet);
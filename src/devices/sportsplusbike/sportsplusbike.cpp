@@ -160,7 +160,7 @@ void sportsplusbike::characteristicChanged(const QLowEnergyCharacteristic &chara
                 m_watt = watt;
             Speed = metric::calculateSpeedFromPower(
                 watt, Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
             emit debug(QStringLiteral("Current speed: ") + QString::number(Speed.value()));
             // lastTimeWattChanged = QTime::currentTime();
         }
@@ -194,7 +194,7 @@ void sportsplusbike::characteristicChanged(const QLowEnergyCharacteristic &chara
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
         emit debug(QStringLiteral("Current speed: ") + QString::number(Speed.value()));
 
@@ -235,7 +235,7 @@ void sportsplusbike::characteristicChanged(const QLowEnergyCharacteristic &chara
         } else {
             Speed = metric::calculateSpeedFromPower(
                 watts(), Inclination.value(), Speed.value(),
-                fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+                Speed.secondsSinceLastChanged(), this->speedLimit());
         }
         lastTimeCharChanged = now;
         kcal = GetKcalFromPacket(newValue);
@@ -180,7 +180,7 @@ void sportstechbike::characteristicChanged(const QLowEnergyCharacteristic &chara
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     Resistance = requestResistance;
     emit resistanceRead(Resistance.value());
@@ -418,7 +418,7 @@ void sportstechbike::controllerStateChanged(QLowEnergyController::ControllerStat
     }
 }
 
-uint16_t sportstechbike::wattsFromResistance(double resistance) {
+double sportstechbike::wattsFromResistance(double resistance, double cadence) {
         // Coefficients from the polynomial regression
     double intercept = 14.4968;
     double b1 = -4.1878;
@@ -426,7 +426,6 @@ uint16_t sportstechbike::wattsFromResistance(double resistance) {
     double b3 = 0.00387;
     double b4 = 0.2392;
     double b5 = 0.01108;
-    double cadence = Cadence.value();
 
     // Calculate power using the polynomial equation
     double power = intercept +
@@ -445,15 +444,5 @@ resistance_t sportstechbike::resistanceFromPowerRequest(uint16_t power) {
     if (Cadence.value() == 0)
         return 1;
 
-    for (resistance_t i = 1; i < maxResistance(); i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return maxResistance();
+    return powerSurface().resistance(power, Cadence.value());
 }
\ No newline at end of file
@@ -34,6 +34,7 @@ class sportstechbike : public bike {
     bool connected() override;
     resistance_t maxResistance() override { return 24; }
     resistance_t resistanceFromPowerRequest(uint16_t power) override;    
+    double wattsFromResistance(double resistance, double cadence) override;
 
   private:
     double GetSpeedFromPacket(const QByteArray &packet);
@@ -41,7 +42,6 @@ class sportstechbike : public bike {
     double GetKcalFromPacket(const QByteArray &packet);
     double GetDistanceFromPacket(QByteArray packet);
     uint16_t GetElapsedFromPacket(const QByteArray &packet);
-    uint16_t wattsFromResistance(double resistance);
     void forceResistance(resistance_t requestResistance);
     void updateDisplay(uint16_t elapsed);
     void btinit(bool startTape);
@@ -1,4 +1,5 @@
 #include "tacxneo2.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualbike.h"
 #include <QBluetoothLocalDevice>
 #include <QDateTime>
@@ -578,25 +579,18 @@ void tacxneo2::controllerStateChanged(QLowEnergyController::ControllerState stat
 }
 
 resistance_t tacxneo2::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 0; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) > pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 0;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance, true);
 }
 
-double tacxneo2::bikeResistanceToPeloton(double resistance) {
-    QSettings settings;
-    bool tacx_neo2_peloton =
-        settings.value(QZSettings::tacx_neo2_peloton, QZSettings::default_tacx_neo2_peloton).toBool();
+void tacxneo2::buildPelotonMap(pelotonmap &map) {
+    // the levels start from 0
+    map.build(0, max_resistance, [this](double resistance) { return bikeResistanceToPeloton(resistance); });
+}
 
-    if (tacx_neo2_peloton) {
-        return (resistance * settings.value(QZSettings::peloton_gain, QZSettings::default_peloton_gain).toDouble()) +
-               settings.value(QZSettings::peloton_offset, QZSettings::default_peloton_offset).toDouble();
+double tacxneo2::bikeResistanceToPeloton(double resistance) {
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    if (settings.tacx_neo2_peloton) {
+        return (resistance * settings.peloton_gain) + settings.peloton_offset;
     } else {
         return resistance;
     }
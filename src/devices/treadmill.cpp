@@ -45,7 +45,7 @@ void treadmill::changeSpeedAndInclination(double speed, double inclination) {
     changeSpeed(speed);
     changeInclination(inclination, inclination);
 }
-metric treadmill::currentInclination() { return Inclination; }
+const metric &treadmill::currentInclination() { return Inclination; }
 bool treadmill::connected() { return false; }
 bluetoothdevice::BLUETOOTH_TYPE treadmill::deviceType() { return bluetoothdevice::TREADMILL; }
 
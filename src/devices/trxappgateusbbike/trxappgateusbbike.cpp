@@ -325,7 +325,7 @@ void trxappgateusbbike::characteristicChanged(const QLowEnergyCharacteristic &ch
     } else {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(QDateTime::currentDateTime().msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
     if (!firstCharChanged) {
         Distance += ((Speed.value() / 3600.0) / (1000.0 / (lastTimeCharChanged.msecsTo(QTime::currentTime()))));
@@ -1099,14 +1099,14 @@ void trxappgateusbbike::controllerStateChanged(QLowEnergyController::ControllerS
     }
 }
 
-uint16_t trxappgateusbbike::wattsFromResistance(double resistance) {
+double trxappgateusbbike::wattsFromResistance(double resistance, double cadence) {
     double P;
     // Toorx SRX 3500 #1999
     P = 37.069 
-        - 1.483 * Cadence.value() 
+        - 1.483 * cadence 
         - 4.942 * resistance 
-        + 0.023 * Cadence.value() * Cadence.value() 
-        + 0.336 * Cadence.value() * resistance 
+        + 0.023 * cadence * cadence 
+        + 0.336 * cadence * resistance 
         - 0.036 * resistance * resistance;
     return P;
 }
@@ -1117,15 +1117,5 @@ resistance_t trxappgateusbbike::resistanceFromPowerRequest(uint16_t power) {
     if (Cadence.value() == 0)
         return 1;
 
-    for (resistance_t i = 1; i < maxResistance(); i++) {
-        if (wattsFromResistance(i) <= power && wattsFromResistance(i + 1) >= power) {
-            qDebug() << QStringLiteral("resistanceFromPowerRequest") << wattsFromResistance(i)
-                     << wattsFromResistance(i + 1) << power;
-            return i;
-        }
-    }
-    if (power < wattsFromResistance(1))
-        return 1;
-    else
-        return maxResistance();
+    return powerSurface().resistance(power, Cadence.value());
 }
@@ -39,6 +39,7 @@ class trxappgateusbbike : public bike {
     bool connected() override;
     resistance_t maxResistance() override { return 32; }
     resistance_t resistanceFromPowerRequest(uint16_t power) override;
+    double wattsFromResistance(double resistance, double cadence) override;
 
   private:
     double GetSpeedFromPacket(const QByteArray &packet);
@@ -56,7 +57,6 @@ class trxappgateusbbike : public bike {
     double GetWattFromPacket(const QByteArray &packet);
     double GetWattFromPacketFytter(const QByteArray &packet);
     double GetCadenceFromPacket(const QByteArray &packet);
-    uint16_t wattsFromResistance(double resistance);
 
     QTimer *refresh;
 
@@ -138,15 +138,7 @@ void ultrasportbike::serviceDiscovered(const QBluetoothUuid &gatt) {
 }
 
 resistance_t ultrasportbike::pelotonToBikeResistance(int pelotonResistance) {
-    for (resistance_t i = 1; i < max_resistance; i++) {
-        if (bikeResistanceToPeloton(i) <= pelotonResistance && bikeResistanceToPeloton(i + 1) >= pelotonResistance) {
-            return i;
-        }
-    }
-    if (pelotonResistance < bikeResistanceToPeloton(1))
-        return 1;
-    else
-        return max_resistance;
+    return pelotonMap().resistance(pelotonResistance);
 }
 
 double ultrasportbike::bikeResistanceToPeloton(double resistance) {
@@ -190,7 +182,7 @@ void ultrasportbike::characteristicChanged(const QLowEnergyCharacteristic &chara
     {
         Speed = metric::calculateSpeedFromPower(
             watts(), Inclination.value(), Speed.value(),
-            fabs(now.msecsTo(Speed.lastChanged()) / 1000.0), this->speedLimit());
+            Speed.secondsSinceLastChanged(), this->speedLimit());
     }
 
     if (watts())
@@ -41,11 +41,11 @@ class ultrasportbike : public bike {
     resistance_t pelotonToBikeResistance(int pelotonResistance) override;
     resistance_t maxResistance() override { return max_resistance; }
     bool connected() override;
+    double bikeResistanceToPeloton(double resistance) override;
 
   private:
     bool r92 = false;
     const resistance_t max_resistance = 40;
-    double bikeResistanceToPeloton(double resistance);
     double GetWattFromPacket(const QByteArray &packet);
     void btinit();
     void writeCharacteristic(uint8_t *data, uint8_t data_len, const QString &info, bool disable_log = false,
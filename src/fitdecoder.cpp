@@ -0,0 +1,341 @@
+#include "fitdecoder.h"
+
+#include "fit.hpp"
+#include "fit_profile.hpp"
+#include "fit_record_mesg.hpp"
+#include "fit_session_mesg.hpp"
+#include "fit_sport_mesg.hpp"
+
+#include <QFile>
+#include <cmath>
+#include <cstring>
+
+// 1989-12-31 00:00 UTC, the FIT epoch, in seconds since 1970-01-01
+static const qint64 fitEpoch = 631065600;
+
+namespace {
+
+// a field of a message definition
+struct fitfield {
+    quint8 num;
+    quint8 size;
+    quint8 baseType;
+    quint16 offset;
+};
+
+struct fitdefinition {
+    bool defined = false;
+    bool bigEndian = false;
+    quint16 global = 0;
+    quint32 size = 0;
+    QVector<fitfield> fields;
+};
+
+quint64 readUnsigned(const uchar *p, int size, bool bigEndian) {
+    quint64 v = 0;
+    if (bigEndian) {
+        for (int i = 0; i < size; i++)
+            v = (v << 8) | p[i];
+    } else {
+        for (int i = size - 1; i >= 0; i--)
+            v = (v << 8) | p[i];
+    }
+    return v;
+}
+
+// the value of a field of the size of the FIT type, invalid otherwise (an array, or a field of another size)
+template <typename T> T fieldValue(const uchar *message, const fitfield &field, bool bigEndian, T invalid) {
+    if (field.size != sizeof(T))
+        return invalid;
+    return (T)readUnsigned(message + field.offset, sizeof(T), bigEndian);
+}
+
+void appendRecord(const uchar *message, const fitdefinition &definition, quint32 timestamp, fitrecords *records) {
+    using num = fit::RecordMesg::FieldDefNum;
+    quint32 altitude = 0xFFFFFFFF, enhancedAltitude = 0xFFFFFFFF;
+    quint32 speed = 0xFFFFFFFF, enhancedSpeed = 0xFFFFFFFF;
+    qint32 latitude = 0x7FFFFFFF, longitude = 0x7FFFFFFF;
+    quint32 distance = 0xFFFFFFFF;
+    quint16 power = 0xFFFF, calories = 0xFFFF, stepLength = 0xFFFF, verticalOscillation = 0xFFFF,
+            stanceTime = 0xFFFF;
+    quint8 heart = 0xFF, cadence = 0xFF, resistance = 0xFF;
+    const bool be = definition.bigEndian;
+    for (const fitfield &field : definition.fields) {
+        switch (field.num) {
+        case num::PositionLat:
+            latitude = fieldValue<qint32>(message, field, be, 0x7FFFFFFF);
+            break;
+        case num::PositionLong:
+            longitude = fieldValue<qint32>(message, field, be, 0x7FFFFFFF);
+            break;
+        case num::Altitude: {
+            const quint16 v = fieldValue<quint16>(message, field, be, 0xFFFF);
+            altitude = v == 0xFFFF ? 0xFFFFFFFF : v;
+            break;
+        }
+        case num::EnhancedAltitude:
+            enhancedAltitude = fieldValue<quint32>(message, field, be, 0xFFFFFFFF);
+            break;
+        case num::HeartRate:
+            heart = fieldValue<quint8>(message, field, be, 0xFF);
+            break;
+        case num::Cadence:
+            cadence = fieldValue<quint8>(message, field, be, 0xFF);
+            break;
+        case num::Distance:
+            distance = fieldValue<quint32>(message, field, be, 0xFFFFFFFF);
+            break;
+        case num::Speed: {
+            const quint16 v = fieldValue<quint16>(message, field, be, 0xFFFF);
+            speed = v == 0xFFFF ? 0xFFFFFFFF : v;
+            break;
+        }
+        case num::EnhancedSpeed:
+            enhancedSpeed = fieldValue<quint32>(message, field, be, 0xFFFFFFFF);
+            break;
+        case num::Power:
+            power = fieldValue<quint16>(message, field, be, 0xFFFF);
+            break;
+        case num::Resistance:
+            resistance = fieldValue<quint8>(message, field, be, 0xFF);
+            break;
+        case num::Calories:
+            calories = fieldValue<quint16>(message, field, be, 0xFFFF);
+            break;
+        case num::StepLength:
+            stepLength = fieldValue<quint16>(message, field, be, 0xFFFF);
+            break;
+        case num::VerticalOscillation:
+            verticalOscillation = fieldValue<quint16>(message, field, be, 0xFFFF);
+            break;
+        case num::StanceTime:
+            stanceTime = fieldValue<quint16>(message, field, be, 0xFFFF);
+            break;
+        default:
+            break;
+        }
+    }
+    records->timestamp.append(timestamp);
+    records->latitude.append(latitude);
+    records->longitude.append(longitude);
+    records->altitude.append(enhancedAltitude != 0xFFFFFFFF ? enhancedAltitude : altitude);
+    records->distance.append(distance);
+    records->speed.append(enhancedSpeed != 0xFFFFFFFF ? enhancedSpeed : speed);
+    records->power.append(power);
+    records->calories.append(calories);
+    records->stepLength.append(stepLength);
+    records->verticalOscillation.append(verticalOscillation);
+    records->stanceTime.append(stanceTime);
+    records->heart.append(heart);
+    records->cadence.append(cadence);
+    records->resistance.append(resistance);
+}
+
+// the messages of one FIT file, data is after the file header; false if a message is truncated
+bool decodeMessages(const uchar *data, quint32 length, fitrecords *records) {
+    fitdefinition definitions[FIT_MAX_LOCAL_MESGS];
+    quint32 lastTimestamp = 0;
+    quint32 pos = 0;
+    while (pos < length) {
+        const uchar h = data[pos];
+        if (!(h & FIT_HDR_TIME_REC_BIT) && (h & FIT_HDR_TYPE_DEF_BIT)) {
+            // header, reserved, architecture, global message number (2), number of fields, then 3 bytes per field
+            if (pos + 6 > length)
+                return false;
+            fitdefinition &definition = definitions[h & FIT_HDR_TYPE_MASK];
+            definition.bigEndian = data[pos + 2] == 1;
+            definition.global = (quint16)readUnsigned(data + pos + 3, 2, definition.bigEndian);
+            const int fields = data[pos + 5];
+            quint32 next = pos + 6 + 3 * fields;
+            if (next > length)
+                return false;
+            definition.fields.resize(fields);
+            quint32 size = 0;
+            for (int f = 0; f < fields; f++) {
+                fitfield &field = definition.fields[f];
+                field.num = data[pos + 6 + 3 * f];
+                field.size = data[pos + 6 + 3 * f + 1];
+                field.baseType = data[pos + 6 + 3 * f + 2];
+                field.offset = size;
+                size += field.size;
+            }
+            // the developer fields are only skipped
+            if (h & FIT_HDR_DEV_FIELD_BIT) {
+                if (next + 1 > length)
+                    return false;
+                const int devFields = data[next];
+                const quint32 devStart = next + 1;
+                next = devStart + 3 * devFields;
+                if (next > length)
+                    return false;
+                for (int f = 0; f < devFields; f++)
+                    size += data[devStart + 3 * f + 1];
+            }
+            definition.size = size;
+            definition.defined = true;
+            pos = next;
+            continue;
+        }
+
+        int local;
+        bool compressedTimestamp = false;
+        if (h & FIT_HDR_TIME_REC_BIT) {
+            local = (h & FIT_HDR_TIME_TYPE_MASK) >> FIT_HDR_TIME_TYPE_SHIFT;
+            const quint32 offset = h & FIT_HDR_TIME_OFFSET_MASK;
+            quint32 timestamp = (lastTimestamp & ~(quint32)FIT_HDR_TIME_OFFSET_MASK) + offset;
+            if (offset < (lastTimestamp & FIT_HDR_TIME_OFFSET_MASK))
+                timestamp += FIT_HDR_TIME_OFFSET_MASK + 1;
+            lastTimestamp = timestamp;
+            compressedTimestamp = true;
+        } else {
+            local = h & FIT_HDR_TYPE_MASK;
+        }
+        const fitdefinition &definition = definitions[local];
+        if (!definition.defined || pos + 1 + definition.size > length)
+            return false;
+        const uchar *message = data + pos + 1;
+        pos += 1 + definition.size;
+
+        if (!compressedTimestamp) {
+            for (const fitfield &field : definition.fields) {
+                if (field.num == fit::RecordMesg::FieldDefNum::Timestamp) {
+                    const quint32 timestamp = fieldValue<quint32>(message, field, definition.bigEndian, 0xFFFFFFFF);
+                    if (timestamp != 0xFFFFFFFF)
+                        lastTimestamp = timestamp;
+                    break;
+                }
+            }
+        }
+
+        if (definition.global == FIT_MESG_NUM_RECORD) {
+            appendRecord(message, definition, lastTimestamp, records);
+        } else if (definition.global == FIT_MESG_NUM_SESSION || definition.global == FIT_MESG_NUM_SPORT) {
+            const quint8 sportField = definition.global == FIT_MESG_NUM_SESSION ? fit::SessionMesg::FieldDefNum::Sport
+                                                                                : fit::SportMesg::FieldDefNum::Sport;
+            for (const fitfield &field : definition.fields) {
+                if (field.num == sportField) {
+                    const quint8 sport = fieldValue<quint8>(message, field, false, FIT_SPORT_INVALID);
+                    if (sport != FIT_SPORT_INVALID)
+                        records->sport = sport;
+                    break;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+void fitrecords::clear() {
+    timestamp.clear();
+    latitude.clear();
+    longitude.clear();
+    altitude.clear();
+    distance.clear();
+    speed.clear();
+    power.clear();
+    calories.clear();
+    stepLength.clear();
+    verticalOscillation.clear();
+    stanceTime.clear();
+    heart.clear();
+    cadence.clear();
+    resistance.clear();
+    sport = FIT_SPORT_INVALID;
+}
+
+void fitrecords::reserve(int records) {
+    timestamp.reserve(records);
+    latitude.reserve(records);
+    longitude.reserve(records);
+    altitude.reserve(records);
+    distance.reserve(records);
+    speed.reserve(records);
+    power.reserve(records);
+    calories.reserve(records);
+    stepLength.reserve(records);
+    verticalOscillation.reserve(records);
+    stanceTime.reserve(records);
+    heart.reserve(records);
+    cadence.reserve(records);
+    resistance.reserve(records);
+}
+
+qint64 fitrecords::timeMs(int i) const { return (fitEpoch + timestamp.at(i)) * 1000; }
+
+double fitrecords::speedKmh(int i) const { return speed.at(i) == 0xFFFFFFFF ? 0 : speed.at(i) / 1000.0 * 3.6; }
+
+double fitrecords::distanceKm(int i) const {
+    return distance.at(i) == 0xFFFFFFFF ? 0 : distance.at(i) / 100.0 / 1000.0;
+}
+
+double fitrecords::altitudeMeters(int i) const {
+    return altitude.at(i) == 0xFFFFFFFF ? 0 : altitude.at(i) / 5.0 - 500.0;
+}
+
+double fitrecords::latitudeDegrees(int i) const {
+    return latitude.at(i) == 0x7FFFFFFF ? NAN : latitude.at(i) * 180.0 / 2147483648.0;
+}
+
+double fitrecords::longitudeDegrees(int i) const {
+    return longitude.at(i) == 0x7FFFFFFF ? NAN : longitude.at(i) * 180.0 / 2147483648.0;
+}
+
+SessionLine fitrecords::line(int i) const {
+    SessionLine s;
+    s.heart = heartRate(i);
+    s.cadence = cadenceRpm(i);
+    s.distance = distanceKm(i);
+    s.speed = speedKmh(i);
+    s.watt = watt(i);
+    s.resistance = resistance.at(i) == 0xFF ? 0 : resistance.at(i);
+    s.calories = kcal(i);
+    s.instantaneousStrideLengthCM = stepLength.at(i) == 0xFFFF ? 0 : stepLength.at(i) / 10.0 / 10.0;
+    s.verticalOscillationMM = verticalOscillation.at(i) == 0xFFFF ? 0 : verticalOscillation.at(i) / 10.0;
+    s.groundContactMS = stanceTime.at(i) == 0xFFFF ? 0 : stanceTime.at(i) / 10.0;
+    s.coordinate.setAltitude(altitudeMeters(i));
+    s.coordinate.setLatitude(latitudeDegrees(i));
+    s.coordinate.setLongitude(longitudeDegrees(i));
+    if (!s.coordinate.isValid()) {
+        s.elevationGain = altitudeMeters(i);
+    }
+    s.time = QDateTime::fromMSecsSinceEpoch(timeMs(i));
+    return s;
+}
+
+bool fitdecoder::decode(const uchar *data, qint64 length, fitrecords *records) {
+    qint64 pos = 0;
+    bool fit = false;
+    // chained FIT files: a header, the messages and the CRC, then the next file
+    while (length - pos >= 12) {
+        const uchar *header = data + pos;
+        const int headerSize = header[0];
+        if (headerSize < 12 || length - pos < headerSize || memcmp(header + 8, ".FIT", 4) != 0)
+            break;
+        fit = true;
+        const quint32 dataSize = (quint32)readUnsigned(header + 4, 4, false);
+        const qint64 available = length - pos - headerSize;
+        const quint32 messages = (quint32)qMin<qint64>(dataSize ? dataSize : available, available);
+        if (records->count() == 0)
+            records->reserve(messages / 20);
+        if (!decodeMessages(header + headerSize, messages, records) || dataSize == 0 || dataSize > available)
+            break;
+        pos += headerSize + dataSize + 2;
+    }
+    return fit;
+}
+
+bool fitdecoder::decodeFile(const QString &path, fitrecords *records) {
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = file.size();
+    if (size == 0)
+        return false;
+    const uchar *map = file.map(0, size);
+    if (map)
+        return decode(map, size, records);
+    const QByteArray content = file.readAll();
+    return decode((const uchar *)content.constData(), content.size(), records);
+}
@@ -0,0 +1,90 @@
+#ifndef FITDECODER_H
+#define FITDECODER_H
+
+#include "sessionline.h"
+
+#include <QList>
+#include <QString>
+#include <QVector>
+
+/**
+ * @brief The record messages of a FIT file, one column per field, as stored in the file: the integers of the FIT
+ * profile, the FIT invalid value when the record has no such field. The accessors apply the scale and offset.
+ */
+class fitrecords {
+  public:
+    // seconds since 1989-12-31 00:00 UTC
+    QVector<quint32> timestamp;
+    // semicircles
+    QVector<qint32> latitude;
+    QVector<qint32> longitude;
+    // m * 5 + 500, the enhanced altitude if the record has it
+    QVector<quint32> altitude;
+    // cm
+    QVector<quint32> distance;
+    // mm/s, the enhanced speed if the record has it
+    QVector<quint32> speed;
+    QVector<quint16> power;
+    QVector<quint16> calories;
+    // mm * 10
+    QVector<quint16> stepLength;
+    QVector<quint16> verticalOscillation;
+    // ms * 10
+    QVector<quint16> stanceTime;
+    QVector<quint8> heart;
+    QVector<quint8> cadence;
+    QVector<quint8> resistance;
+
+    // of the session or sport message, FIT_SPORT_INVALID if none
+    quint8 sport = 0xFF;
+
+    int count() const { return timestamp.count(); }
+    void clear();
+    void reserve(int records);
+
+    /**
+     * @brief The time of the record in ms since epoch.
+     */
+    qint64 timeMs(int i) const;
+    double speedKmh(int i) const;
+    double distanceKm(int i) const;
+    double altitudeMeters(int i) const;
+    /**
+     * @brief The position in degrees, NaN if the record has none.
+     */
+    double latitudeDegrees(int i) const;
+    double longitudeDegrees(int i) const;
+    /**
+     * @brief The other fields, 0 if the record has none.
+     */
+    double watt(int i) const { return power.at(i) == 0xFFFF ? 0 : power.at(i); }
+    double heartRate(int i) const { return heart.at(i) == 0xFF ? 0 : heart.at(i); }
+    double cadenceRpm(int i) const { return cadence.at(i) == 0xFF ? 0 : cadence.at(i); }
+    double kcal(int i) const { return calories.at(i) == 0xFFFF ? 0 : calories.at(i); }
+
+    /**
+     * @brief The record as a session line, like the ones qfit::save wrote.
+     */
+    SessionLine line(int i) const;
+};
+
+/**
+ * @brief Decodes the record messages of a FIT file straight from the bytes of the file, without the message objects
+ * of the FIT SDK: the definitions are kept as byte offsets, the data messages of other types are skipped by their
+ * size. Compressed timestamp headers and developer fields are supported; chained FIT files are read one after the
+ * other. A truncated file returns the records before the truncation.
+ */
+class fitdecoder {
+  public:
+    /**
+     * @brief Decode data, length bytes, appending to records.
+     * @return false if data is not a FIT file.
+     */
+    static bool decode(const uchar *data, qint64 length, fitrecords *records);
+    /**
+     * @brief Decode the file at path, mapped in memory.
+     */
+    static bool decodeFile(const QString &path, fitrecords *records);
+};
+
+#endif // FITDECODER_H
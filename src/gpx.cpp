@@ -1,7 +1,6 @@
 #include "gpx.h"
 #include "math.h"
 #include "qdebugfixup.h"
-#include <QDomDocument>
 #include <QSettings>
 #include <QXmlStreamWriter>
 
@@ -17,58 +16,33 @@ QList<gpx_altitude_point_for_treadmill> gpx::open(const QString &gpx, bluetoothd
     if(device_type == bluetoothdevice::BIKE)
         treadmill_force_speed = false;
     
-    QFile input(gpx);
-    input.open(QIODevice::ReadOnly);
-    QDomDocument doc;
-    doc.setContent(&input);
-    QDomNodeList metadata = doc.elementsByTagName(QStringLiteral("metadata"));
-    if (metadata.size()) {
-        QDomNodeList list = metadata.at(0).childNodes();
-        for (int i = 0; i < list.count(); i++) {
-            if (list.at(i).nodeName().toLower() == "video") {
-                QString video = list.at(i).toElement().firstChild().nodeValue();
-                if (!video.isEmpty()) {
-                    videoUrl = video;
-                    qDebug() << "gpx::videoUrl " << videoUrl;
-                    break;
-                }
-            }
-        }
-    }
+    QList<gpx_altitude_point_for_treadmill> inclinationList;
 
-    QDomNodeList points = doc.elementsByTagName(QStringLiteral("trkpt"));
-    for (int i = 0; i < points.size(); i++) {
-        QDomNode point = points.item(i);
-        QDomNamedNodeMap att = point.attributes();
-        QString lat = att.namedItem(QStringLiteral("lat")).nodeValue();
-        QString lon = att.namedItem(QStringLiteral("lon")).nodeValue();
-        QDomElement ele = point.firstChildElement(QStringLiteral("ele"));
-        QDomElement time = point.firstChildElement(QStringLiteral("time"));
-        gpx_point g;
-        // 2020-10-10T10:54:45
-        g.time = QDateTime::fromString(time.text(), Qt::ISODate);
-        g.p.setAltitude(ele.text().toDouble());
-        g.p.setLatitude(lat.toDouble());
-        g.p.setLongitude(lon.toDouble());
-        this->points.append(g);
+    if (!route.open(gpx)) {
+        qDebug() << QStringLiteral("gpx::open error") << gpx;
+    }
+    if (!route.videoUrl().isEmpty()) {
+        videoUrl = route.videoUrl();
+        qDebug() << "gpx::videoUrl " << videoUrl;
+    }
+    if (route.count() == 0) {
+        return inclinationList;
     }
 
-    if (gpx_loop && this->points.size() > 2 &&
-        this->points.first().p.distanceTo(this->points.last().p) >= meter_limit_for_auto_loop) {
-        for (int i =
-                 this->points.size() - 2 /* -2 because otherwise the first point will be the same as the last point */;
+    // the route points in the order they are ridden: the way back of the loop is the route reversed
+    QVector<int> order;
+    order.reserve(route.count() * 2);
+    for (int i = 0; i < route.count(); i++) {
+        order.append(i);
+    }
+    if (gpx_loop && route.count() > 2 && distance(0, route.count() - 1) >= meter_limit_for_auto_loop) {
+        for (int i = route.count() - 2 /* -2 because otherwise the first point will be the same as the last point */;
              i >= 0; i--) {
-            this->points.append(this->points.at(i));
+            order.append(i);
         }
     }
 
-    QList<gpx_altitude_point_for_treadmill> inclinationList;
-
-    if (this->points.isEmpty()) {
-        return inclinationList;
-    }
-
-    gpx_point pP = this->points.constFirst();
+    const int first = order.constFirst();
 
     if (treadmill_force_speed) {
 
@@ -76,87 +50,115 @@ QList<gpx_altitude_point_for_treadmill> gpx::open(const QString &gpx, bluetoothd
         gpx_altitude_point_for_treadmill g;
         g.distance = 0;
         g.inclination = 0;
-        g.elevation = pP.p.altitude();
-        g.latitude = pP.p.latitude();
-        g.longitude = pP.p.longitude();
+        g.elevation = route.elevation(first);
+        g.latitude = route.latitude(first);
+        g.longitude = route.longitude(first);
         g.seconds = 0;
         inclinationList.append(g);
 
-        for (int32_t i = 1; i < this->points.count(); i++) {
-            qint64 dT = qAbs(pP.time.secsTo(this->points.at(i).time));
+        int pP = first;
+        for (int32_t k = 1; k < order.count(); k++) {
+            const int i = order.at(k);
+            qint64 dT = qAbs(route.secsTo(pP, i));
 
-            double distance = this->points.at(i).p.distanceTo(pP.p);
-            double elevation = this->points.at(i).p.altitude() - pP.p.altitude();
+            double distance = this->distance(pP, i);
 
             if (distance == 0 || dT == 0) {
                 continue;
             }
 
-            pP = this->points[i];
-
             gpx_altitude_point_for_treadmill g;
-            g.seconds = this->points.constFirst().time.secsTo(pP.time);
+            g.seconds = route.secsTo(first, i);
             g.distance = distance / 1000.0;
             g.speed = (distance / 1000.0) * (3600 / dT);
-            g.inclination = (elevation / distance) * 100;
-            g.elevation = this->points.at(i).p.altitude();
-            g.latitude = pP.p.latitude();
-            g.longitude = pP.p.longitude();
+            g.inclination = grade(pP, i, distance);
+            g.azimuth = azimuth(pP, i);
+            g.elevation = route.elevation(i);
+            g.latitude = route.latitude(i);
+            g.longitude = route.longitude(i);
             inclinationList.append(g);
+
+            pP = i;
         }
     }
     if (inclinationList.empty()) {
-        gpx_point pP = this->points.constFirst();
         double totDistance = 0;
-        if (!isnan(this->points.constFirst().p.latitude()) && !isnan(this->points.constFirst().p.longitude()) &&
-            QGeoCoordinate(this->points.first().p.latitude(), this->points.first().p.longitude())
-                    .distanceTo(QGeoCoordinate(this->points.constLast().p.latitude(),
-                                               this->points.constLast().p.longitude())) < meter_limit_for_auto_loop) {
+        // the time of the closing point of the circuit is the one of the last point
+        int closingTime = -1;
+        const int last = order.constLast();
+        if (!isnan(route.latitude(first)) && !isnan(route.longitude(first)) &&
+            distance(first, last) < meter_limit_for_auto_loop) {
             // to create the circuit
-            this->points.append(this->points.constFirst());
-            this->points.last().time = this->points.at(this->points.count() - 2).time;
+            order.append(first);
+            closingTime = last;
         }
 
         // starting point
         gpx_altitude_point_for_treadmill g;
         g.distance = 0;
         g.inclination = 0;
-        g.elevation = pP.p.altitude();
-        g.latitude = pP.p.latitude();
-        g.longitude = pP.p.longitude();
+        g.elevation = route.elevation(first);
+        g.latitude = route.latitude(first);
+        g.longitude = route.longitude(first);
         g.seconds = 0;
-        /*qDebug() << qSetRealNumberPrecision(10) << i << g.distance << g.inclination << g.elevation << g.latitude
-             << g.longitude << totDistance << pP.time;*/
         inclinationList.append(g);
 
-        for (int32_t i = 1; i < this->points.count(); i++) {
-            double distance = this->points.at(i).p.distanceTo(pP.p);
-            double elevation = this->points.at(i).p.altitude() - pP.p.altitude();
+        int pP = first;
+        for (int32_t k = 1; k < order.count(); k++) {
+            const int i = order.at(k);
+            double distance = this->distance(pP, i);
 
             if (distance == 0) {
                 continue;
             }
 
-            pP = this->points[i];
+            const int time = (closingTime != -1 && k == order.count() - 1) ? closingTime : i;
 
             gpx_altitude_point_for_treadmill g;
             g.distance = distance / 1000.0;
             totDistance += g.distance;
-            g.inclination = (elevation / distance) * 100;
-            g.elevation = this->points.at(i).p.altitude();
-            g.latitude = pP.p.latitude();
-            g.longitude = pP.p.longitude();
-            g.seconds = this->points.constFirst().time.secsTo(pP.time);
-            /*qDebug() << qSetRealNumberPrecision(10) << i << g.distance << g.inclination << g.elevation << g.latitude
-             << g.longitude << totDistance << pP.time;*/
+            g.inclination = grade(pP, i, distance);
+            g.azimuth = azimuth(pP, i);
+            g.elevation = route.elevation(i);
+            g.latitude = route.latitude(i);
+            g.longitude = route.longitude(i);
+            g.seconds = route.secsTo(first, time);
+            /*qDebug() << qSetRealNumberPrecision(10) << k << g.distance << g.inclination << g.elevation << g.latitude
+             << g.longitude << totDistance;*/
             inclinationList.append(g);
+
+            pP = i;
         }
     }
 
     return inclinationList;
 }
 
-void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type) {
+double gpx::distance(int from, int to) const {
+    // the geometry of the segments is computed once, when the route is loaded
+    if (to == from + 1) {
+        return route.segmentDistance(to);
+    }
+    return gpxroute::distanceBetween(route.latitude(from), route.longitude(from), route.latitude(to),
+                                     route.longitude(to));
+}
+
+double gpx::grade(int from, int to, double distance) const {
+    if (to == from + 1) {
+        return route.grade(to);
+    }
+    return ((double)route.elevation(to) - (double)route.elevation(from)) / distance * 100;
+}
+
+double gpx::azimuth(int from, int to) const {
+    if (to == from + 1) {
+        return route.azimuth(to);
+    }
+    return gpxroute::azimuthBetween(route.latitude(from), route.longitude(from), route.latitude(to),
+                                    route.longitude(to));
+}
+
+void gpx::save(const QString &filename, const SessionStore &session, bluetoothdevice::BLUETOOTH_TYPE type) {
     if (session.isEmpty()) {
         return;
     }
@@ -192,11 +194,11 @@ void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdev
 
     stream.writeStartElement(QStringLiteral("metadata"));
     stream.writeTextElement(QStringLiteral("time"),
-                            session.at(0).time.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ssZ")));
+                            session.time(0).toString(QStringLiteral("yyyy-MM-ddTHH:mm:ssZ")));
     stream.writeEndElement();
 
     stream.writeStartElement(QStringLiteral("trk"));
-    stream.writeTextElement(QStringLiteral("name"), session.at(0).time.toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")));
+    stream.writeTextElement(QStringLiteral("name"), session.time(0).toString(QStringLiteral("yyyy-MM-dd HH:mm:ss")));
 
     if (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL) {
         stream.writeTextElement(QStringLiteral("type"), QStringLiteral("0"));
@@ -205,8 +207,10 @@ void gpx::save(const QString &filename, QList<SessionLine> session, bluetoothdev
     }
 
     stream.writeStartElement(QStringLiteral("trkseg"));
-    for (const SessionLine &s : qAsConst(session)) {
-        if (s.speed > 0) {
+    const SessionStore::SessionColumn<double> speed = session.speed();
+    for (int i = 0; i < session.count(); i++) {
+        if (speed[i] > 0) {
+            const SessionLine s = session.at(i);
             stream.writeStartElement(QStringLiteral("trkpt"));
             stream.writeAttribute(QStringLiteral("lat"), QStringLiteral("0"));
             stream.writeAttribute(QStringLiteral("lon"), QStringLiteral("0"));
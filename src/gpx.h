@@ -2,7 +2,9 @@
 #define GPX_H
 
 #include "devices/bluetoothdevice.h"
+#include "gpxroute.h"
 #include "sessionline.h"
+#include "sessionstore.h"
 #include <QFile>
 #include <QGeoCoordinate>
 #include <QObject>
@@ -17,12 +19,7 @@ class gpx_altitude_point_for_treadmill {
     double distance = 0;
     double latitude = 0;
     double longitude = 0;
-};
-
-class gpx_point {
-  public:
-    QDateTime time;
-    QGeoCoordinate p;
+    double azimuth = 0;
 };
 
 class gpx : public QObject {
@@ -30,11 +27,15 @@ class gpx : public QObject {
   public:
     explicit gpx(QObject *parent = nullptr);
     QList<gpx_altitude_point_for_treadmill> open(const QString &gpx, bluetoothdevice::BLUETOOTH_TYPE device_type);
-    static void save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type);
+    static void save(const QString &filename, const SessionStore &session, bluetoothdevice::BLUETOOTH_TYPE type);
     QString getVideoURL() {return videoUrl;}
 
   private:
-    QList<gpx_point> points;
+    double distance(int from, int to) const;
+    double grade(int from, int to, double distance) const;
+    double azimuth(int from, int to) const;
+
+    gpxroute route;
     QString videoUrl = "";
 
   signals:
@@ -0,0 +1,376 @@
+#include "gpxroute.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QXmlStreamReader>
+#include <QtMath>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+const qint64 gpxroute::INVALID_TIME = std::numeric_limits<qint64>::min();
+
+namespace {
+
+// the same radius as QGeoCoordinate
+const double earthMeanRadius = 6371.0072;
+
+struct cacheHeader {
+    quint32 magic;
+    quint32 version;
+    qint64 sourceSize;
+    qint64 sourceModified;
+    qint32 count;
+    qint32 videoBytes;
+};
+
+qint64 cacheSize(qint64 count, qint64 videoBytes) {
+    return sizeof(cacheHeader) + count * (5 * sizeof(double) + 3 * sizeof(float)) + videoBytes;
+}
+
+bool validCoordinate(double lat, double lon) {
+    return !std::isnan(lat) && !std::isnan(lon) && lat >= -90 && lat <= 90 && lon >= -180 && lon <= 180;
+}
+
+qint64 daysFromCivil(int y, int m, int d) {
+    y -= m <= 2;
+    const qint64 era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = (int)(y - era * 400);
+    const int doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+int digits(const QChar *p, int n, bool &ok) {
+    int v = 0;
+    for (int i = 0; i < n; i++) {
+        if (!p[i].isDigit()) {
+            ok = false;
+            return 0;
+        }
+        v = v * 10 + p[i].digitValue();
+    }
+    return v;
+}
+
+} // namespace
+
+gpxroute::gpxroute() {}
+
+void gpxroute::clear() {
+    if (mapped) {
+        cacheFile.unmap(mapped);
+        mapped = nullptr;
+    }
+    cacheFile.close();
+    ownedLat.clear();
+    ownedLon.clear();
+    ownedTime.clear();
+    ownedCumulative.clear();
+    ownedSegment.clear();
+    ownedEle.clear();
+    ownedSlope.clear();
+    ownedBearing.clear();
+    video.clear();
+    points = 0;
+    bindOwned();
+}
+
+void gpxroute::bindOwned() {
+    points = ownedLat.count();
+    lat = ownedLat.constData();
+    lon = ownedLon.constData();
+    msecs = ownedTime.constData();
+    cumulative = ownedCumulative.constData();
+    segment = ownedSegment.constData();
+    ele = ownedEle.constData();
+    slope = ownedSlope.constData();
+    bearing = ownedBearing.constData();
+}
+
+double gpxroute::distanceBetween(double lat1, double lon1, double lat2, double lon2) {
+    if (!validCoordinate(lat1, lon1) || !validCoordinate(lat2, lon2))
+        return 0;
+    // haversine, as QGeoCoordinate::distanceTo
+    const double dlat = qDegreesToRadians(lat2 - lat1);
+    const double dlon = qDegreesToRadians(lon2 - lon1);
+    double haversine_dlat = sin(dlat / 2.0);
+    haversine_dlat *= haversine_dlat;
+    double haversine_dlon = sin(dlon / 2.0);
+    haversine_dlon *= haversine_dlon;
+    const double y =
+        haversine_dlat + cos(qDegreesToRadians(lat1)) * cos(qDegreesToRadians(lat2)) * haversine_dlon;
+    const double x = 2 * asin(sqrt(y));
+    return x * earthMeanRadius * 1000;
+}
+
+double gpxroute::azimuthBetween(double lat1, double lon1, double lat2, double lon2) {
+    if (!validCoordinate(lat1, lon1) || !validCoordinate(lat2, lon2))
+        return 0;
+    const double dlon = qDegreesToRadians(lon2 - lon1);
+    const double lat1Rad = qDegreesToRadians(lat1);
+    const double lat2Rad = qDegreesToRadians(lat2);
+    const double y = sin(dlon) * cos(lat2Rad);
+    const double x = cos(lat1Rad) * sin(lat2Rad) - sin(lat1Rad) * cos(lat2Rad) * cos(dlon);
+    const double azimuth = qRadiansToDegrees(atan2(y, x)) + 360.0;
+    double whole;
+    const double fraction = modf(azimuth, &whole);
+    return (int(whole + 360) % 360) + fraction;
+}
+
+qint64 gpxroute::parseTime(const QString &text) {
+    // the usual form of the track points, e.g. 2020-10-10T10:54:45Z or 2020-10-10T10:54:45.250+02:00
+    const QChar *p = text.constData();
+    const int n = text.size();
+    bool ok = n >= 20 && p[4] == QLatin1Char('-') && p[7] == QLatin1Char('-') && p[10] == QLatin1Char('T') &&
+              p[13] == QLatin1Char(':') && p[16] == QLatin1Char(':');
+    const int year = ok ? digits(p, 4, ok) : 0;
+    const int month = ok ? digits(p + 5, 2, ok) : 0;
+    const int day = ok ? digits(p + 8, 2, ok) : 0;
+    const int hour = ok ? digits(p + 11, 2, ok) : 0;
+    const int minute = ok ? digits(p + 14, 2, ok) : 0;
+    const int second = ok ? digits(p + 17, 2, ok) : 0;
+    int pos = 19;
+    int msec = 0;
+    if (ok && pos < n && (p[pos] == QLatin1Char('.') || p[pos] == QLatin1Char(','))) {
+        // the digits over a power of ten: the same double as the "0.ddd" Qt converts
+        qint64 fraction = 0;
+        double scale = 1;
+        pos++;
+        const int start = pos;
+        while (pos < n && p[pos].isDigit()) {
+            fraction = fraction * 10 + p[pos].digitValue();
+            scale *= 10;
+            pos++;
+        }
+        ok = pos > start && pos - start <= 15;
+        msec = qMin(qRound(fraction / scale * 1000.0), 999);
+    }
+    qint64 offset = 0;
+    if (ok && pos == n - 1 && p[pos] == QLatin1Char('Z')) {
+        offset = 0;
+    } else if (ok && (n - pos == 6 || n - pos == 5) && (p[pos] == QLatin1Char('+') || p[pos] == QLatin1Char('-'))) {
+        const bool colon = n - pos == 6;
+        ok = !colon || p[pos + 3] == QLatin1Char(':');
+        const int oh = ok ? digits(p + pos + 1, 2, ok) : 0;
+        const int om = ok ? digits(p + pos + (colon ? 4 : 3), 2, ok) : 0;
+        offset = (oh * 60 + om) * 60 * (p[pos] == QLatin1Char('-') ? -1 : 1);
+    } else {
+        // no time zone (local time) or another form: QDateTime knows better
+        ok = false;
+    }
+    if (ok && month >= 1 && month <= 12 && day >= 1 && day <= QDate(year, month, 1).daysInMonth() && hour <= 23 &&
+        minute <= 59 && second <= 59) {
+        const qint64 seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offset;
+        return seconds * 1000 + msec;
+    }
+
+    const QDateTime dt = QDateTime::fromString(text, Qt::ISODate);
+    return dt.isValid() ? dt.toMSecsSinceEpoch() : INVALID_TIME;
+}
+
+qint64 gpxroute::secsTo(int from, int to) const {
+    if (msecs[from] == INVALID_TIME || msecs[to] == INVALID_TIME)
+        return 0;
+    return (msecs[to] - msecs[from]) / 1000;
+}
+
+void gpxroute::appendPoint(double latitude, double longitude, double elevation, qint64 time) {
+    ownedLat.append(latitude);
+    ownedLon.append(longitude);
+    ownedEle.append((float)elevation);
+    ownedTime.append(time);
+}
+
+bool gpxroute::parse(QIODevice *device) {
+    clear();
+    QXmlStreamReader xml(device);
+    bool metadata = false;
+    while (!xml.atEnd()) {
+        if (xml.readNext() != QXmlStreamReader::StartElement)
+            continue;
+        const auto name = xml.name();
+        if (name == QLatin1String("trkpt")) {
+            const QXmlStreamAttributes att = xml.attributes();
+            const double latitude = att.value(QStringLiteral("lat")).toDouble();
+            const double longitude = att.value(QStringLiteral("lon")).toDouble();
+            double elevation = 0;
+            qint64 time = INVALID_TIME;
+            bool hasEle = false, hasTime = false;
+            while (xml.readNextStartElement()) {
+                if (!hasEle && xml.name() == QLatin1String("ele")) {
+                    elevation = xml.readElementText(QXmlStreamReader::IncludeChildElements).toDouble();
+                    hasEle = true;
+                } else if (!hasTime && xml.name() == QLatin1String("time")) {
+                    time = parseTime(xml.readElementText(QXmlStreamReader::IncludeChildElements));
+                    hasTime = true;
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+            appendPoint(latitude, longitude, elevation, time);
+        } else if (name == QLatin1String("Trackpoint")) {
+            double latitude = NAN, longitude = NAN, elevation = 0;
+            qint64 time = INVALID_TIME;
+            while (xml.readNextStartElement()) {
+                if (xml.name() == QLatin1String("Time")) {
+                    time = parseTime(xml.readElementText(QXmlStreamReader::IncludeChildElements));
+                } else if (xml.name() == QLatin1String("AltitudeMeters")) {
+                    elevation = xml.readElementText(QXmlStreamReader::IncludeChildElements).toDouble();
+                } else if (xml.name() == QLatin1String("Position")) {
+                    while (xml.readNextStartElement()) {
+                        if (xml.name() == QLatin1String("LatitudeDegrees"))
+                            latitude = xml.readElementText(QXmlStreamReader::IncludeChildElements).toDouble();
+                        else if (xml.name() == QLatin1String("LongitudeDegrees"))
+                            longitude = xml.readElementText(QXmlStreamReader::IncludeChildElements).toDouble();
+                        else
+                            xml.skipCurrentElement();
+                    }
+                } else {
+                    xml.skipCurrentElement();
+                }
+            }
+            // the points of an indoor activity have no position
+            if (!std::isnan(latitude) && !std::isnan(longitude))
+                appendPoint(latitude, longitude, elevation, time);
+        } else if (name == QLatin1String("metadata") && !metadata) {
+            metadata = true;
+            while (xml.readNextStartElement()) {
+                if (video.isEmpty() && xml.name().toString().toLower() == QLatin1String("video"))
+                    video = xml.readElementText(QXmlStreamReader::IncludeChildElements);
+                else
+                    xml.skipCurrentElement();
+            }
+            if (!video.isEmpty())
+                qDebug() << "gpxroute::videoUrl " << video;
+        }
+    }
+    if (xml.hasError())
+        qDebug() << QStringLiteral("gpxroute: parse error") << xml.errorString() << QStringLiteral("at line")
+                 << xml.lineNumber() << QStringLiteral("points") << ownedLat.count();
+    computeGeometry();
+    bindOwned();
+    return !xml.hasError() || !ownedLat.isEmpty();
+}
+
+void gpxroute::computeGeometry() {
+    const int n = ownedLat.count();
+    ownedCumulative.resize(n);
+    ownedSegment.resize(n);
+    ownedSlope.resize(n);
+    ownedBearing.resize(n);
+    double total = 0;
+    for (int i = 0; i < n; i++) {
+        double d = 0, grade = 0, azimuth = 0;
+        if (i > 0) {
+            d = distanceBetween(ownedLat.at(i - 1), ownedLon.at(i - 1), ownedLat.at(i), ownedLon.at(i));
+            azimuth = azimuthBetween(ownedLat.at(i - 1), ownedLon.at(i - 1), ownedLat.at(i), ownedLon.at(i));
+            if (d != 0)
+                grade = ((double)ownedEle.at(i) - (double)ownedEle.at(i - 1)) / d * 100;
+        }
+        total += d;
+        ownedSegment[i] = d;
+        ownedCumulative[i] = total;
+        ownedSlope[i] = (float)grade;
+        ownedBearing[i] = (float)azimuth;
+    }
+}
+
+QStringList gpxroute::cacheFileNames(const QString &fileName) {
+    const QFileInfo info(fileName);
+    const QByteArray key =
+        QCryptographicHash::hash(info.absoluteFilePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+    return QStringList() << fileName + QStringLiteral(".qzroute")
+                         << QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                                QStringLiteral("/routes/") + QString::fromLatin1(key) + QStringLiteral(".qzroute");
+}
+
+bool gpxroute::loadCache(const QString &cacheFileName, const QFileInfo &source) {
+    clear();
+    cacheFile.setFileName(cacheFileName);
+    if (!cacheFile.open(QIODevice::ReadOnly))
+        return false;
+    const qint64 size = cacheFile.size();
+    cacheHeader h;
+    if (size < (qint64)sizeof(h) || cacheFile.read(reinterpret_cast<char *>(&h), sizeof(h)) != (qint64)sizeof(h) ||
+        h.magic != CACHE_MAGIC || h.version != CACHE_VERSION || h.sourceSize != source.size() ||
+        h.sourceModified != source.lastModified().toMSecsSinceEpoch() || h.count < 0 || h.videoBytes < 0 ||
+        cacheSize(h.count, h.videoBytes) != size) {
+        cacheFile.close();
+        return false;
+    }
+    mapped = cacheFile.map(0, size);
+    if (!mapped) {
+        cacheFile.close();
+        return false;
+    }
+    const qint64 n = h.count;
+    const uchar *p = mapped + sizeof(h);
+    lat = reinterpret_cast<const double *>(p);
+    lon = lat + n;
+    msecs = reinterpret_cast<const qint64 *>(lon + n);
+    cumulative = reinterpret_cast<const double *>(msecs + n);
+    segment = cumulative + n;
+    ele = reinterpret_cast<const float *>(segment + n);
+    slope = ele + n;
+    bearing = slope + n;
+    video = QString::fromUtf8(reinterpret_cast<const char *>(bearing + n), h.videoBytes);
+    points = h.count;
+    return true;
+}
+
+bool gpxroute::saveCache(const QString &cacheFileName, const QFileInfo &source) const {
+    QDir().mkpath(QFileInfo(cacheFileName).absolutePath());
+    QSaveFile out(cacheFileName);
+    if (!out.open(QIODevice::WriteOnly))
+        return false;
+    const QByteArray videoUtf8 = video.toUtf8();
+    cacheHeader h;
+    memset(&h, 0, sizeof(h));
+    h.magic = CACHE_MAGIC;
+    h.version = CACHE_VERSION;
+    h.sourceSize = source.size();
+    h.sourceModified = source.lastModified().toMSecsSinceEpoch();
+    h.count = points;
+    h.videoBytes = videoUtf8.size();
+    out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+    out.write(reinterpret_cast<const char *>(lat), points * sizeof(double));
+    out.write(reinterpret_cast<const char *>(lon), points * sizeof(double));
+    out.write(reinterpret_cast<const char *>(msecs), points * sizeof(qint64));
+    out.write(reinterpret_cast<const char *>(cumulative), points * sizeof(double));
+    out.write(reinterpret_cast<const char *>(segment), points * sizeof(double));
+    out.write(reinterpret_cast<const char *>(ele), points * sizeof(float));
+    out.write(reinterpret_cast<const char *>(slope), points * sizeof(float));
+    out.write(reinterpret_cast<const char *>(bearing), points * sizeof(float));
+    out.write(videoUtf8);
+    return out.commit();
+}
+
+bool gpxroute::open(const QString &fileName, bool useCache) {
+    const QFileInfo source(fileName);
+    const QStringList caches = cacheFileNames(fileName);
+    if (useCache) {
+        for (const QString &cache : caches) {
+            if (loadCache(cache, source))
+                return true;
+        }
+    }
+
+    QFile input(fileName);
+    if (!input.open(QIODevice::ReadOnly)) {
+        clear();
+        return false;
+    }
+    const bool rv = parse(&input);
+    if (useCache && points) {
+        for (const QString &cache : caches) {
+            if (saveCache(cache, source))
+                break;
+        }
+    }
+    return rv;
+}
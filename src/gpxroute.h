@@ -0,0 +1,113 @@
+#ifndef GPXROUTE_H
+#define GPXROUTE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QIODevice;
+
+/**
+ * @brief The track points of a GPX or TCX route, one array per field, with the geometry of the segments computed
+ * once at load: the distance, grade and azimuth from the previous point and the cumulative distance.
+ * The file is read with a stream reader straight into the arrays, without a DOM or an object per point, and the arrays
+ * are saved to a cache file next to the route (in the cache directory if the folder isn't writable): the next open()
+ * of the same route maps the cache and doesn't parse the XML at all.
+ * The coordinates stay doubles, a float isn't precise enough for points a meter apart; the elevation and the derived
+ * values are floats. Times are ms since the epoch, INVALID_TIME when the point has none.
+ */
+class gpxroute {
+  public:
+    static const quint32 CACHE_MAGIC = 0x54525A51; // "QZRT"
+    static const quint32 CACHE_VERSION = 1;
+    static const qint64 INVALID_TIME;
+
+    gpxroute();
+    gpxroute(const gpxroute &) = delete;
+    gpxroute &operator=(const gpxroute &) = delete;
+
+    /**
+     * @brief Loads the route, from the cache if it's still the one of the file (same size and modification time),
+     * parsing the file and writing the cache otherwise.
+     */
+    bool open(const QString &fileName, bool useCache = true);
+    /**
+     * @brief Parses a GPX (trkpt) or TCX (Trackpoint) document.
+     */
+    bool parse(QIODevice *device);
+    void clear();
+
+    bool loadCache(const QString &cacheFileName, const QFileInfo &source);
+    bool saveCache(const QString &cacheFileName, const QFileInfo &source) const;
+    /**
+     * @brief Where the cache of a route is looked for: next to the file, then in the cache directory.
+     */
+    static QStringList cacheFileNames(const QString &fileName);
+    bool isFromCache() const { return mapped != nullptr; }
+
+    int count() const { return points; }
+    double latitude(int i) const { return lat[i]; }
+    double longitude(int i) const { return lon[i]; }
+    float elevation(int i) const { return ele[i]; }
+    qint64 time(int i) const { return msecs[i]; }
+    /**
+     * @brief Meters from the first point, along the track.
+     */
+    double distance(int i) const { return cumulative[i]; }
+    /**
+     * @brief Meters from the previous point, 0 for the first one.
+     */
+    double segmentDistance(int i) const { return segment[i]; }
+    /**
+     * @brief Percent grade from the previous point, 0 when the points are at the same position.
+     */
+    float grade(int i) const { return slope[i]; }
+    /**
+     * @brief Degrees from the previous point, 0 for the first one.
+     */
+    float azimuth(int i) const { return bearing[i]; }
+    /**
+     * @brief Seconds between the times of two points, with the semantic of QDateTime::secsTo (0 if one is missing).
+     */
+    qint64 secsTo(int from, int to) const;
+
+    QString videoUrl() const { return video; }
+
+    /**
+     * @brief Same results as QGeoCoordinate::distanceTo and azimuthTo, without building the coordinates.
+     */
+    static double distanceBetween(double lat1, double lon1, double lat2, double lon2);
+    static double azimuthBetween(double lat1, double lon1, double lat2, double lon2);
+    /**
+     * @brief ms since the epoch of an ISO 8601 date time, as QDateTime::fromString(text, Qt::ISODate) would.
+     */
+    static qint64 parseTime(const QString &text);
+
+  private:
+    void appendPoint(double latitude, double longitude, double elevation, qint64 time);
+    void computeGeometry();
+    void bindOwned();
+
+    int points = 0;
+    const double *lat = nullptr;
+    const double *lon = nullptr;
+    const qint64 *msecs = nullptr;
+    const double *cumulative = nullptr;
+    const double *segment = nullptr;
+    const float *ele = nullptr;
+    const float *slope = nullptr;
+    const float *bearing = nullptr;
+    QString video;
+
+    // the arrays when parsed; the cache mapping otherwise
+    QVector<double> ownedLat, ownedLon, ownedCumulative, ownedSegment;
+    QVector<qint64> ownedTime;
+    QVector<float> ownedEle, ownedSlope, ownedBearing;
+    QFile cacheFile;
+    uchar *mapped = nullptr;
+};
+
+#endif // GPXROUTE_H
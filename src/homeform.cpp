@@ -9,6 +9,7 @@
 #endif
 #include "material.h"
 #include "qfit.h"
+#include "qzsettingssnapshot.h"
 #include "simplecrypt.h"
 #include "templateinfosenderbuilder.h"
 #include "zwiftworkout.h"
@@ -38,6 +39,7 @@
 #include <QTime>
 #include <QUrlQuery>
 #include <chrono>
+#include <cmath>
 
 homeform *homeform::m_singleton = 0;
 using namespace std::chrono_literals;
@@ -86,38 +88,129 @@ DataObject::DataObject(const QString &name, const QString &icon, const QString &
 }
 
 void DataObject::setName(const QString &v) {
+    if (m_name == v)
+        return;
     m_name = v;
     emit nameChanged(m_name);
 }
 void DataObject::setValue(const QString &v) {
+    // the numbers shown are no longer the ones of setValueNumbers
+    m_shownNumbers[Value].decimals = -1;
+    if (m_value == v)
+        return;
     m_value = v;
     emit valueChanged(m_value);
 }
 void DataObject::setSecondLine(const QString &value) {
+    m_shownNumbers[SecondLine].decimals = -1;
+    if (m_secondLine == value)
+        return;
     m_secondLine = value;
     emit secondLineChanged(m_secondLine);
 }
 void DataObject::setValueFontSize(int value) {
+    if (m_valueFontSize == value)
+        return;
     m_valueFontSize = value;
     emit valueFontSizeChanged(m_valueFontSize);
 }
 void DataObject::setValueFontColor(const QString &value) {
+    if (m_valueFontColor == value)
+        return;
     m_valueFontColor = value;
     emit valueFontColorChanged(m_valueFontColor);
 }
 void DataObject::setLabelFontSize(int value) {
+    if (m_labelFontSize == value)
+        return;
     m_labelFontSize = value;
     emit labelFontSizeChanged(m_labelFontSize);
 }
 void DataObject::setGridId(int id) {
+    if (m_gridId == id)
+        return;
     m_gridId = id;
     emit gridIdChanged(m_gridId);
 }
 void DataObject::setVisible(bool visible) {
+    if (m_visible == visible)
+        return;
     m_visible = visible;
     emit visibleChanged(m_visible);
 }
 
+void DataObject::setShown(bool shown) {
+    if (shown && !m_shown)
+        m_dirty = true;
+    m_shown = shown;
+    if (!shown)
+        m_due = false;
+}
+
+void DataObject::beginRefresh(quint32 tick) {
+    m_due = m_shown && (m_dirty || tick - m_lastRefresh >= (quint32)m_refreshInterval);
+    if (m_due) {
+        m_dirty = false;
+        m_lastRefresh = tick;
+    }
+}
+
+// the number as shown with decimals digits: the text changes only if the key does. false when the key can't tell:
+// halfway between two texts, a negative zero, not finite or too large
+static bool displayKey(double number, int decimals, qint64 *key) {
+    static const double scales[] = {1, 10, 100, 1000, 10000, 100000, 1000000};
+    const double scaled = number * scales[qBound(0, decimals, 6)];
+    if (decimals < 0 || decimals > 6 || !(fabs(scaled) < 1e15))
+        return false;
+    const double rounded = std::nearbyint(scaled);
+    if (fabs(fabs(scaled - rounded) - 0.5) < 1e-6 || (rounded == 0 && std::signbit(number)))
+        return false;
+    *key = (qint64)rounded;
+    return true;
+}
+
+void DataObject::setValueNumber(double value, int decimals) {
+    if (!m_due)
+        return;
+    Shown &shown = m_shownNumbers[Value];
+    qint64 key;
+    const bool exact = displayKey(value, decimals, &key);
+    if (exact && shown.decimals == decimals && shown.format.isNull() && shown.keys.count() == 1 &&
+        shown.keys.at(0) == key)
+        return;
+    setValue(QString::number(value, 'f', decimals));
+    if (!exact)
+        return;
+    shown.format = QString();
+    shown.decimals = decimals;
+    shown.keys.resize(1);
+    shown.keys[0] = key;
+}
+
+void DataObject::setNumbers(Line line, const QString &format, int decimals, const double *numbers, int count) {
+    if (!m_due)
+        return;
+    Shown &shown = m_shownNumbers[line];
+    QVarLengthArray<qint64, 2> keys(count);
+    bool exact = true;
+    for (int i = 0; i < count && exact; i++)
+        exact = displayKey(numbers[i], decimals, &keys[i]);
+    if (exact && shown.decimals == decimals && shown.keys == keys && shown.format == format)
+        return;
+    QString text = format;
+    for (int i = 0; i < count; i++)
+        text = text.arg(numbers[i], 0, 'f', decimals);
+    if (line == Value)
+        setValue(text);
+    else
+        setSecondLine(text);
+    if (!exact)
+        return;
+    shown.format = format;
+    shown.decimals = decimals;
+    shown.keys = keys;
+}
+
 homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
     m_singleton = this;
     QSettings settings;
@@ -223,6 +316,18 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
                              false, QStringLiteral("avgWatt"), 48, labelFontSize);
     avgWattLap = new DataObject(QStringLiteral("AVG Watt Lap"), QStringLiteral("icons/icons/watt.png"),
                                 QStringLiteral("0"), false, QStringLiteral("avgWattLap"), 48, labelFontSize);
+    peakPower5s = new DataObject(QStringLiteral("Best Watt 5s"), QStringLiteral("icons/icons/watt.png"),
+                                 QStringLiteral("0"), false, QStringLiteral("peakPower5s"), 48, labelFontSize);
+    peakPower1m = new DataObject(QStringLiteral("Best Watt 1min"), QStringLiteral("icons/icons/watt.png"),
+                                 QStringLiteral("0"), false, QStringLiteral("peakPower1m"), 48, labelFontSize);
+    peakPower5m = new DataObject(QStringLiteral("Best Watt 5min"), QStringLiteral("icons/icons/watt.png"),
+                                 QStringLiteral("0"), false, QStringLiteral("peakPower5m"), 48, labelFontSize);
+    peakPower20m = new DataObject(QStringLiteral("Best Watt 20min"), QStringLiteral("icons/icons/watt.png"),
+                                  QStringLiteral("0"), false, QStringLiteral("peakPower20m"), 48, labelFontSize);
+    // the best power of the longer windows and the weight loss move slowly
+    peakPower5m->setRefreshInterval(5);
+    peakPower20m->setRefreshInterval(5);
+    weightLoss->setRefreshInterval(5);
     wattKg = new DataObject(QStringLiteral("Watt/Kg"), QStringLiteral("icons/icons/watt.png"), QStringLiteral("0"),
                             false, QStringLiteral("watt_kg"), 48, labelFontSize);
     ftp = new DataObject(QStringLiteral("FTP Zone"), QStringLiteral("icons/icons/watt.png"), QStringLiteral("0"), false,
@@ -466,7 +571,7 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
 
     backupTimer = new QTimer(this);
     connect(backupTimer, &QTimer::timeout, this, &homeform::backup);
-    backupTimer->start(1min);
+    backupTimer->start(5s);
 
     QObject *rootObject = engine->rootObjects().constFirst();
     QObject *home = rootObject->findChild<QObject *>(QStringLiteral("home"));
@@ -526,6 +631,14 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
     connect(pelotonHandler, &peloton::loginState, this, &homeform::pelotonLoginState);
     connect(pelotonHandler, &peloton::pzpLoginState, this, &homeform::pzpLoginState);
 
+    // fit backup journals left open by a crash
+    qfitjournal::repairInBackground(getWritableAppDir(), QStringLiteral("QZ-backup-*.fit"), backupFitFileName);
+
+    if (settings.value(QZSettings::session_spill_to_disk, QZSettings::default_session_spill_to_disk).toBool()) {
+        if (!Session.setSpillFile(getWritableAppDir() + QStringLiteral("session.spill")))
+            qDebug() << QStringLiteral("session spill file unavailable, keeping the session in memory");
+    }
+
     // copying bundles zwo files in the right path if necessary
     QDirIterator itZwo(":/zwo/");
     QDir().mkdir(getWritableAppDir() + "training/");
@@ -561,6 +674,16 @@ homeform::homeform(QQmlApplicationEngine *engine, bluetooth *bl) {
     }
 #endif
 
+    // the workout packs of the training folder, summarized off the GUI thread for the picker
+    trainingLibrary = new workoutlibrary(getWritableAppDir() + QStringLiteral("training"), QString(), this);
+    connect(trainingLibrary, &workoutlibrary::refreshed, this, &homeform::trainingLibraryRefreshed);
+    refreshTrainingLibrary();
+
+    // the FIT files saved in the writable dir, summarized off the GUI thread
+    workoutHistory = new workouthistory(getWritableAppDir(), QString(), this);
+    connect(workoutHistory, &workouthistory::refreshed, this, &homeform::workoutHistoryRefreshed);
+    refreshWorkoutHistory();
+
     m_speech.setLocale(QLocale::English);
 
 #if defined(Q_OS_LINUX) && !defined(Q_OS_ANDROID)
@@ -899,24 +1022,26 @@ QString homeform::getWritableAppDir() {
 
 void homeform::backup() {
 
-    static uint8_t index = 0;
-    qDebug() << QStringLiteral("saving fit file backup...");
-
-    QString path = getWritableAppDir();
     bluetoothdevice *dev = bluetoothManager->device();
-    if (dev) {
+    // after the workout is saved the journal is final until the session restarts
+    if (!dev || Session.isEmpty() || backupJournal.isFinalized()) {
+        return;
+    }
 
-        QString filename = path + QString::number(index) + backupFitFileName;
-        QFile::remove(filename);
-        qfit::save(filename, Session, dev->deviceType(),
-                   qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
-                   stravaPelotonWorkoutType, dev->bluetoothDevice.name());
+    if (backupJournal.isOpen() && backupJournal.samples() > Session.count()) {
+        backupJournal.close();
+    }
 
-        index++;
-        if (index > 1) {
-            index = 0;
+    if (!backupJournal.isOpen()) {
+        qDebug() << QStringLiteral("starting fit file backup journal...");
+        if (!backupJournal.open(getWritableAppDir() + backupFitFileName, dev->deviceType(), stravaPelotonWorkoutType,
+                                dev->bluetoothDevice.name())) {
+            return;
         }
     }
+
+    // only the samples recorded since the previous backup are encoded
+    backupJournal.append(Session);
 }
 
 QString homeform::stopColor() { return QStringLiteral("#00000000"); }
@@ -971,39 +1096,27 @@ void homeform::aboutToQuit() {
 void homeform::trainProgramSignals() {
     if (bluetoothManager->device()) {
         disconnect(trainProgram, &trainprogram::start, bluetoothManager->device(), &bluetoothdevice::start);
+        disconnect(trainProgram, &trainprogram::changeInclination, bluetoothManager->device(), nullptr);
+        disconnect(trainProgram, &trainprogram::changeResistance, bluetoothManager->device(), nullptr);
+        disconnect(trainProgram, &trainprogram::changePower, bluetoothManager->device(), nullptr);
         disconnect(trainProgram, &trainprogram::stop, bluetoothManager->device(), &bluetoothdevice::stop);
         disconnect(trainProgram, &trainprogram::lap, this, &homeform::Lap);
         disconnect(trainProgram, &trainprogram::changeSpeed, ((treadmill *)bluetoothManager->device()),
                    &treadmill::changeSpeed);
-        disconnect(trainProgram, &trainprogram::changeInclination, ((treadmill *)bluetoothManager->device()),
-                   &treadmill::changeInclination);
         disconnect(trainProgram, &trainprogram::changeNextInclination300Meters, bluetoothManager->device(),
                    &bluetoothdevice::changeNextInclination300Meters);
-        disconnect(trainProgram, &trainprogram::changeInclination, ((bike *)bluetoothManager->device()),
-                   &bike::changeInclination);
         disconnect(trainProgram, &trainprogram::changeFanSpeed, ((treadmill *)bluetoothManager->device()),
                    &treadmill::changeFanSpeed);
         disconnect(trainProgram, &trainprogram::changeSpeedAndInclination, ((treadmill *)bluetoothManager->device()),
                    &treadmill::changeSpeedAndInclination);
-        disconnect(trainProgram, &trainprogram::changeResistance, ((bike *)bluetoothManager->device()),
-                   &bike::changeResistance);
         disconnect(trainProgram, &trainprogram::changeRequestedPelotonResistance, ((bike *)bluetoothManager->device()),
                    &bike::changeRequestedPelotonResistance);
         disconnect(trainProgram, &trainprogram::changeCadence, ((bike *)bluetoothManager->device()),
                    &bike::changeCadence);
-        disconnect(trainProgram, &trainprogram::changePower, ((bike *)bluetoothManager->device()), &bike::changePower);
-        disconnect(trainProgram, &trainprogram::changePower, ((rower *)bluetoothManager->device()),
-                   &rower::changePower);
         disconnect(trainProgram, &trainprogram::changeSpeed, ((rower *)bluetoothManager->device()),
                    &rower::changeSpeed);
         disconnect(trainProgram, &trainprogram::changeCadence, ((elliptical *)bluetoothManager->device()),
                    &elliptical::changeCadence);
-        disconnect(trainProgram, &trainprogram::changePower, ((elliptical *)bluetoothManager->device()),
-                   &elliptical::changePower);
-        disconnect(trainProgram, &trainprogram::changeInclination, ((elliptical *)bluetoothManager->device()),
-                   &elliptical::changeInclination);
-        disconnect(trainProgram, &trainprogram::changeResistance, ((elliptical *)bluetoothManager->device()),
-                   &elliptical::changeResistance);
         disconnect(trainProgram, &trainprogram::changeRequestedPelotonResistance,
                    ((elliptical *)bluetoothManager->device()), &elliptical::changeRequestedPelotonResistance);
         disconnect(((treadmill *)bluetoothManager->device()), &treadmill::tapeStarted, trainProgram,
@@ -1027,8 +1140,6 @@ void homeform::trainProgramSignals() {
                     &treadmill::changeSpeed);
             connect(trainProgram, &trainprogram::changeFanSpeed, ((treadmill *)bluetoothManager->device()),
                     &treadmill::changeFanSpeed);
-            connect(trainProgram, &trainprogram::changeInclination, ((treadmill *)bluetoothManager->device()),
-                    &treadmill::changeInclination);
             connect(trainProgram, &trainprogram::changeSpeedAndInclination, ((treadmill *)bluetoothManager->device()),
                     &treadmill::changeSpeedAndInclination);
             connect(((treadmill *)bluetoothManager->device()), &treadmill::tapeStarted, trainProgram,
@@ -1036,11 +1147,6 @@ void homeform::trainProgramSignals() {
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
             connect(trainProgram, &trainprogram::changeCadence, ((bike *)bluetoothManager->device()),
                     &bike::changeCadence);
-            connect(trainProgram, &trainprogram::changePower, ((bike *)bluetoothManager->device()), &bike::changePower);
-            connect(trainProgram, &trainprogram::changeInclination, ((bike *)bluetoothManager->device()),
-                    &bike::changeInclination);
-            connect(trainProgram, &trainprogram::changeResistance, ((bike *)bluetoothManager->device()),
-                    &bike::changeResistance);
             connect(trainProgram, &trainprogram::changeRequestedPelotonResistance, ((bike *)bluetoothManager->device()),
                     &bike::changeRequestedPelotonResistance);
             connect(((bike *)bluetoothManager->device()), &bike::bikeStarted, trainProgram,
@@ -1048,24 +1154,37 @@ void homeform::trainProgramSignals() {
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
             connect(trainProgram, &trainprogram::changeCadence, ((elliptical *)bluetoothManager->device()),
                     &elliptical::changeCadence);
-            connect(trainProgram, &trainprogram::changePower, ((elliptical *)bluetoothManager->device()),
-                    &elliptical::changePower);
-            connect(trainProgram, &trainprogram::changeInclination, ((elliptical *)bluetoothManager->device()),
-                    &elliptical::changeInclination);
-            connect(trainProgram, &trainprogram::changeResistance, ((elliptical *)bluetoothManager->device()),
-                    &elliptical::changeResistance);
             connect(trainProgram, &trainprogram::changeRequestedPelotonResistance,
                     ((elliptical *)bluetoothManager->device()), &elliptical::changeRequestedPelotonResistance);
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-            connect(trainProgram, &trainprogram::changePower, ((rower *)bluetoothManager->device()),
-                    &rower::changePower);
-            connect(trainProgram, &trainprogram::changeResistance, ((rower *)bluetoothManager->device()),
-                    &rower::changeResistance);
             connect(trainProgram, &trainprogram::changeCadence, ((rower *)bluetoothManager->device()),
                     &rower::changeCadence);
             connect(trainProgram, &trainprogram::changeSpeed, ((rower *)bluetoothManager->device()),
                     &rower::changeSpeed);
         }
+        // the targets go through the control queue of the device, that keeps only the last one of each kind until the
+        // device takes them
+        bluetoothdevice *device = bluetoothManager->device();
+        const bluetoothdevice::BLUETOOTH_TYPE type = device->deviceType();
+        if (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::BIKE ||
+            type == bluetoothdevice::ELLIPTICAL) {
+            connect(
+                trainProgram, &trainprogram::changeInclination, device,
+                [device](double grade, double percentage) {
+                    device->requestControl(devicecommand::inclination(grade, percentage));
+                },
+                Qt::DirectConnection);
+        }
+        if (type == bluetoothdevice::BIKE || type == bluetoothdevice::ELLIPTICAL || type == bluetoothdevice::ROWING) {
+            connect(
+                trainProgram, &trainprogram::changeResistance, device,
+                [device](resistance_t resistance) { device->requestControl(devicecommand::resistance(resistance)); },
+                Qt::DirectConnection);
+            connect(
+                trainProgram, &trainprogram::changePower, device,
+                [device](int32_t power) { device->requestControl(devicecommand::power(power)); },
+                Qt::DirectConnection);
+        }
         connect(trainProgram, &trainprogram::changeNextInclination300Meters, bluetoothManager->device(),
                 &bluetoothdevice::changeNextInclination300Meters);
         connect(trainProgram, &trainprogram::changeGeoPosition, bluetoothManager->device(),
@@ -1101,9 +1220,10 @@ void homeform::onToastRequested(QString message) {
 
 QStringList homeform::tile_order() {
 
+    // positions the tiles can take in settings-tiles.qml: up to the best power tiles, 51 to 54 by default
     QStringList r;
-    r.reserve(43);
-    for (int i = 0; i < 43; i++) {
+    r.reserve(55);
+    for (int i = 0; i < 55; i++) {
         r.append(QString::number(i));
     }
     return r;
@@ -1128,6 +1248,9 @@ void homeform::ftmsAccessoryConnected(smartspin2k *d) {
 
 void homeform::sortTiles() {
 
+    // sortTiles is also called when the settings page is closed
+    QZSettingsSnapshot::instance()->reload();
+
     QSettings settings;
     bool pelotoncadence =
         settings.value(QZSettings::bike_cadence_sensor, QZSettings::default_bike_cadence_sensor).toBool();
@@ -1135,6 +1258,8 @@ void homeform::sortTiles() {
     if (!bluetoothManager || !bluetoothManager->device())
         return;
 
+    for (QObject *tile : qAsConst(dataList))
+        ((DataObject *)tile)->setShown(false);
     dataList.clear();
 
     if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
@@ -1224,6 +1349,38 @@ void homeform::sortTiles() {
                 dataList.append(avgWattLap);
             }
 
+            if (settings.value(QZSettings::tile_peak_power_5s_enabled, QZSettings::default_tile_peak_power_5s_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5s_order, QZSettings::default_tile_peak_power_5s_order)
+                        .toInt() == i) {
+                peakPower5s->setGridId(i);
+                dataList.append(peakPower5s);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_1m_enabled, QZSettings::default_tile_peak_power_1m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_1m_order, QZSettings::default_tile_peak_power_1m_order)
+                        .toInt() == i) {
+                peakPower1m->setGridId(i);
+                dataList.append(peakPower1m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_5m_enabled, QZSettings::default_tile_peak_power_5m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5m_order, QZSettings::default_tile_peak_power_5m_order)
+                        .toInt() == i) {
+                peakPower5m->setGridId(i);
+                dataList.append(peakPower5m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_20m_enabled, QZSettings::default_tile_peak_power_20m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_20m_order, QZSettings::default_tile_peak_power_20m_order)
+                        .toInt() == i) {
+                peakPower20m->setGridId(i);
+                dataList.append(peakPower20m);
+            }
+
             if (settings.value(QZSettings::tile_ftp_enabled, true).toBool() &&
                 settings.value(QZSettings::tile_ftp_order, 0).toInt() == i) {
                 ftp->setGridId(i);
@@ -1520,6 +1677,38 @@ void homeform::sortTiles() {
                 dataList.append(avgWattLap);
             }
 
+            if (settings.value(QZSettings::tile_peak_power_5s_enabled, QZSettings::default_tile_peak_power_5s_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5s_order, QZSettings::default_tile_peak_power_5s_order)
+                        .toInt() == i) {
+                peakPower5s->setGridId(i);
+                dataList.append(peakPower5s);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_1m_enabled, QZSettings::default_tile_peak_power_1m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_1m_order, QZSettings::default_tile_peak_power_1m_order)
+                        .toInt() == i) {
+                peakPower1m->setGridId(i);
+                dataList.append(peakPower1m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_5m_enabled, QZSettings::default_tile_peak_power_5m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5m_order, QZSettings::default_tile_peak_power_5m_order)
+                        .toInt() == i) {
+                peakPower5m->setGridId(i);
+                dataList.append(peakPower5m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_20m_enabled, QZSettings::default_tile_peak_power_20m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_20m_order, QZSettings::default_tile_peak_power_20m_order)
+                        .toInt() == i) {
+                peakPower20m->setGridId(i);
+                dataList.append(peakPower20m);
+            }
+
             if (settings.value(QZSettings::tile_ftp_enabled, true).toBool() &&
                 settings.value(QZSettings::tile_ftp_order, 0).toInt() == i) {
                 ftp->setGridId(i);
@@ -1849,6 +2038,38 @@ void homeform::sortTiles() {
                 dataList.append(avgWattLap);
             }
 
+            if (settings.value(QZSettings::tile_peak_power_5s_enabled, QZSettings::default_tile_peak_power_5s_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5s_order, QZSettings::default_tile_peak_power_5s_order)
+                        .toInt() == i) {
+                peakPower5s->setGridId(i);
+                dataList.append(peakPower5s);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_1m_enabled, QZSettings::default_tile_peak_power_1m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_1m_order, QZSettings::default_tile_peak_power_1m_order)
+                        .toInt() == i) {
+                peakPower1m->setGridId(i);
+                dataList.append(peakPower1m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_5m_enabled, QZSettings::default_tile_peak_power_5m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5m_order, QZSettings::default_tile_peak_power_5m_order)
+                        .toInt() == i) {
+                peakPower5m->setGridId(i);
+                dataList.append(peakPower5m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_20m_enabled, QZSettings::default_tile_peak_power_20m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_20m_order, QZSettings::default_tile_peak_power_20m_order)
+                        .toInt() == i) {
+                peakPower20m->setGridId(i);
+                dataList.append(peakPower20m);
+            }
+
             if (settings.value(QZSettings::tile_ftp_enabled, true).toBool() &&
                 settings.value(QZSettings::tile_ftp_order, 0).toInt() == i) {
                 ftp->setGridId(i);
@@ -2146,6 +2367,38 @@ void homeform::sortTiles() {
                 dataList.append(avgWattLap);
             }
 
+            if (settings.value(QZSettings::tile_peak_power_5s_enabled, QZSettings::default_tile_peak_power_5s_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5s_order, QZSettings::default_tile_peak_power_5s_order)
+                        .toInt() == i) {
+                peakPower5s->setGridId(i);
+                dataList.append(peakPower5s);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_1m_enabled, QZSettings::default_tile_peak_power_1m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_1m_order, QZSettings::default_tile_peak_power_1m_order)
+                        .toInt() == i) {
+                peakPower1m->setGridId(i);
+                dataList.append(peakPower1m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_5m_enabled, QZSettings::default_tile_peak_power_5m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_5m_order, QZSettings::default_tile_peak_power_5m_order)
+                        .toInt() == i) {
+                peakPower5m->setGridId(i);
+                dataList.append(peakPower5m);
+            }
+
+            if (settings.value(QZSettings::tile_peak_power_20m_enabled, QZSettings::default_tile_peak_power_20m_enabled)
+                    .toBool() &&
+                settings.value(QZSettings::tile_peak_power_20m_order, QZSettings::default_tile_peak_power_20m_order)
+                        .toInt() == i) {
+                peakPower20m->setGridId(i);
+                dataList.append(peakPower20m);
+            }
+
             if (settings.value(QZSettings::tile_ftp_enabled, true).toBool() &&
                 settings.value(QZSettings::tile_ftp_order, 0).toInt() == i) {
                 ftp->setGridId(i);
@@ -2357,6 +2610,9 @@ void homeform::sortTiles() {
         }
     }
 
+    // only the tiles of the layout are refreshed by update()
+    for (QObject *tile : qAsConst(dataList))
+        ((DataObject *)tile)->setShown(true);
     engine->rootContext()->setContextProperty(QStringLiteral("appModel"), QVariant::fromValue(dataList));
 }
 
@@ -2516,80 +2772,85 @@ void homeform::LargeButton(const QString &name) {
         bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL ||
         bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
         if (name.contains(QStringLiteral("preset_resistance_1"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_1_value,
-                                                                    QZSettings::default_tile_preset_resistance_1_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_1_value,
+                                                     QZSettings::default_tile_preset_resistance_1_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_2"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_2_value,
-                                                                    QZSettings::default_tile_preset_resistance_2_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_2_value,
+                                                     QZSettings::default_tile_preset_resistance_2_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_3"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_3_value,
-                                                                    QZSettings::default_tile_preset_resistance_3_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_3_value,
+                                                     QZSettings::default_tile_preset_resistance_3_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_4"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_4_value,
-                                                                    QZSettings::default_tile_preset_resistance_4_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_4_value,
+                                                     QZSettings::default_tile_preset_resistance_4_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_5"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_5_value,
-                                                                    QZSettings::default_tile_preset_resistance_5_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_5_value,
+                                                     QZSettings::default_tile_preset_resistance_5_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_1"))) {
-            ((bike *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_2"))) {
-            ((bike *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_3"))) {
-            ((bike *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_4"))) {
-            ((bike *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_5"))) {
-            ((bike *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble()));
         }
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
         if (name.contains(QStringLiteral("preset_speed_1"))) {
@@ -2618,132 +2879,137 @@ void homeform::LargeButton(const QString &name) {
                     settings.value(QZSettings::tile_preset_speed_5_value, QZSettings::default_tile_preset_speed_5_value)
                         .toDouble());
         } else if (name.contains(QStringLiteral("preset_inclination_1"))) {
-            ((treadmill *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_2"))) {
-            ((treadmill *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_3"))) {
-            ((treadmill *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_4"))) {
-            ((treadmill *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_5"))) {
-            ((treadmill *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble()));
         }
     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
         if (name.contains(QStringLiteral("preset_resistance_1"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_1_value,
-                                                                    QZSettings::default_tile_preset_resistance_1_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_1_value,
+                                                     QZSettings::default_tile_preset_resistance_1_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_2"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_2_value,
-                                                                    QZSettings::default_tile_preset_resistance_2_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_2_value,
+                                                     QZSettings::default_tile_preset_resistance_2_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_3"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_3_value,
-                                                                    QZSettings::default_tile_preset_resistance_3_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_3_value,
+                                                     QZSettings::default_tile_preset_resistance_3_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_4"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_4_value,
-                                                                    QZSettings::default_tile_preset_resistance_4_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_4_value,
+                                                     QZSettings::default_tile_preset_resistance_4_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_resistance_5"))) {
-            bluetoothManager->device()->changeResistance(settings
-                                                             .value(QZSettings::tile_preset_resistance_5_value,
-                                                                    QZSettings::default_tile_preset_resistance_5_value)
-                                                             .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::resistance(settings
+                                              .value(QZSettings::tile_preset_resistance_5_value,
+                                                     QZSettings::default_tile_preset_resistance_5_value)
+                                              .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_1"))) {
-            ((elliptical *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_1_value,
-                                               QZSettings::default_tile_preset_inclination_1_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_1_value,
+                                                      QZSettings::default_tile_preset_inclination_1_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_2"))) {
-            ((elliptical *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_2_value,
-                                               QZSettings::default_tile_preset_inclination_2_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_2_value,
+                                                      QZSettings::default_tile_preset_inclination_2_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_3"))) {
-            ((elliptical *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_3_value,
-                                               QZSettings::default_tile_preset_inclination_3_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_3_value,
+                                                      QZSettings::default_tile_preset_inclination_3_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_4"))) {
-            ((elliptical *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_4_value,
-                                               QZSettings::default_tile_preset_inclination_4_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_4_value,
+                                                      QZSettings::default_tile_preset_inclination_4_value)
+                                               .toDouble()));
         } else if (name.contains(QStringLiteral("preset_inclination_5"))) {
-            ((elliptical *)bluetoothManager->device())
-                ->changeInclination(settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble(),
-                                    settings
-                                        .value(QZSettings::tile_preset_inclination_5_value,
-                                               QZSettings::default_tile_preset_inclination_5_value)
-                                        .toDouble());
+            bluetoothManager->device()->requestControl(
+                devicecommand::inclination(settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble(),
+                                           settings
+                                               .value(QZSettings::tile_preset_inclination_5_value,
+                                                      QZSettings::default_tile_preset_inclination_5_value)
+                                               .toDouble()));
         }
     }
 }
@@ -2803,9 +3069,8 @@ void homeform::Plus(const QString &name) {
                     }
                 }
 
-                ((treadmill *)bluetoothManager->device())
-                    ->changeInclination(((treadmill *)bluetoothManager->device())->lastRawInclinationRequested(),
-                                        ((treadmill *)bluetoothManager->device())->lastRawInclinationRequested());
+                const double inclination = ((treadmill *)bluetoothManager->device())->lastRawInclinationRequested();
+                bluetoothManager->device()->requestControl(devicecommand::inclination(inclination, inclination));
             }
         }
     } else if (name.contains(QStringLiteral("speed"))) {
@@ -2851,7 +3116,7 @@ void homeform::Plus(const QString &name) {
                 if (step < ((treadmill *)bluetoothManager->device())->minStepInclination())
                     step = ((treadmill *)bluetoothManager->device())->minStepInclination();
                 double perc = ((treadmill *)bluetoothManager->device())->currentInclination().value() + step;
-                ((treadmill *)bluetoothManager->device())->changeInclination(perc, perc);
+                bluetoothManager->device()->requestControl(devicecommand::inclination(perc, perc));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
                 double step =
                     settings.value(QZSettings::treadmill_step_incline, QZSettings::default_treadmill_step_incline)
@@ -2859,11 +3124,11 @@ void homeform::Plus(const QString &name) {
                 if (step < ((elliptical *)bluetoothManager->device())->minStepInclination())
                     step = ((elliptical *)bluetoothManager->device())->minStepInclination();
                 double perc = ((elliptical *)bluetoothManager->device())->currentInclination().value() + step;
-                ((elliptical *)bluetoothManager->device())->changeInclination(perc, perc);
+                bluetoothManager->device()->requestControl(devicecommand::inclination(perc, perc));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                ((bike *)bluetoothManager->device())
-                    ->changeInclination(((bike *)bluetoothManager->device())->currentInclination().value() + 0.5,
-                                        ((bike *)bluetoothManager->device())->currentInclination().value() + 0.5);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::inclination(bluetoothManager->device()->telemetry().inclination + 0.5,
+                                               bluetoothManager->device()->telemetry().inclination + 0.5));
             }
         }
     } else if (name.contains(QStringLiteral("pid_hr"))) {
@@ -2914,36 +3179,36 @@ void homeform::Plus(const QString &name) {
                 }
 
                 if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                    ((bike *)bluetoothManager->device())
-                        ->changeResistance(((bike *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-                    ((rower *)bluetoothManager->device())
-                        ->changeResistance(((rower *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
-                    ((elliptical *)bluetoothManager->device())
-                        ->changeResistance(((elliptical *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 }
             }
         }
     } else if (name.contains(QStringLiteral("resistance")) || name.contains(QStringLiteral("peloton_resistance"))) {
         if (bluetoothManager->device()) {
             if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                ((bike *)bluetoothManager->device())
-                    ->changeResistance(((bike *)bluetoothManager->device())->currentResistance().value() + 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance + 1));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-                ((rower *)bluetoothManager->device())
-                    ->changeResistance(((rower *)bluetoothManager->device())->currentResistance().value() + 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance + 1));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
-                ((elliptical *)bluetoothManager->device())
-                    ->changeResistance(((elliptical *)bluetoothManager->device())->currentResistance().value() + 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance + 1));
             }
         }
     } else if (name.contains(QStringLiteral("target_power"))) {
         if (bluetoothManager->device()) {
             if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
                 m_overridePower = true;
-                ((bike *)bluetoothManager->device())
-                    ->changePower(((bike *)bluetoothManager->device())->lastRequestedPower().value() + 10);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::power(((bike *)bluetoothManager->device())->lastRequestedPower().value() + 10));
                 if (trainProgram) {
                     trainProgram->overridePowerForCurrentRow(
                         ((bike *)bluetoothManager->device())->lastRequestedPower().value());
@@ -3052,9 +3317,8 @@ void homeform::Minus(const QString &name) {
                     }
                 }
 
-                ((treadmill *)bluetoothManager->device())
-                    ->changeInclination(((treadmill *)bluetoothManager->device())->lastRawInclinationRequested(),
-                                        ((treadmill *)bluetoothManager->device())->lastRawInclinationRequested());
+                const double inclination = ((treadmill *)bluetoothManager->device())->lastRawInclinationRequested();
+                bluetoothManager->device()->requestControl(devicecommand::inclination(inclination, inclination));
             }
         }
     } else if (name.contains(QStringLiteral("speed"))) {
@@ -3102,7 +3366,7 @@ void homeform::Minus(const QString &name) {
                 if (step < ((treadmill *)bluetoothManager->device())->minStepInclination())
                     step = ((treadmill *)bluetoothManager->device())->minStepInclination();
                 double perc = ((treadmill *)bluetoothManager->device())->currentInclination().value() - step;
-                ((treadmill *)bluetoothManager->device())->changeInclination(perc, perc);
+                bluetoothManager->device()->requestControl(devicecommand::inclination(perc, perc));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
                 double step =
                     settings.value(QZSettings::treadmill_step_incline, QZSettings::default_treadmill_step_incline)
@@ -3110,11 +3374,11 @@ void homeform::Minus(const QString &name) {
                 if (step < ((elliptical *)bluetoothManager->device())->minStepInclination())
                     step = ((elliptical *)bluetoothManager->device())->minStepInclination();
                 double perc = ((elliptical *)bluetoothManager->device())->currentInclination().value() - step;
-                ((elliptical *)bluetoothManager->device())->changeInclination(perc, perc);
+                bluetoothManager->device()->requestControl(devicecommand::inclination(perc, perc));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                ((bike *)bluetoothManager->device())
-                    ->changeInclination(((bike *)bluetoothManager->device())->currentInclination().value() - 0.5,
-                                        ((bike *)bluetoothManager->device())->currentInclination().value() - 0.5);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::inclination(bluetoothManager->device()->telemetry().inclination - 0.5,
+                                               bluetoothManager->device()->telemetry().inclination - 0.5));
             }
         }
     } else if (name.contains(QStringLiteral("pid_hr"))) {
@@ -3160,36 +3424,36 @@ void homeform::Minus(const QString &name) {
                 }
 
                 if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                    ((bike *)bluetoothManager->device())
-                        ->changeResistance(((bike *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-                    ((rower *)bluetoothManager->device())
-                        ->changeResistance(((rower *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
-                    ((elliptical *)bluetoothManager->device())
-                        ->changeResistance(((elliptical *)bluetoothManager->device())->currentResistance().value());
+                    bluetoothManager->device()->requestControl(
+                        devicecommand::resistance(bluetoothManager->device()->telemetry().resistance));
                 }
             }
         }
     } else if (name.contains(QStringLiteral("resistance")) || name.contains(QStringLiteral("peloton_resistance"))) {
         if (bluetoothManager->device()) {
             if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
-                ((bike *)bluetoothManager->device())
-                    ->changeResistance(((bike *)bluetoothManager->device())->currentResistance().value() - 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance - 1));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
-                ((rower *)bluetoothManager->device())
-                    ->changeResistance(((rower *)bluetoothManager->device())->currentResistance().value() - 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance - 1));
             } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
-                ((elliptical *)bluetoothManager->device())
-                    ->changeResistance(((elliptical *)bluetoothManager->device())->currentResistance().value() - 1);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::resistance(bluetoothManager->device()->telemetry().resistance - 1));
             }
         }
     } else if (name.contains(QStringLiteral("target_power"))) {
         if (bluetoothManager->device()) {
             if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
                 m_overridePower = true;
-                ((bike *)bluetoothManager->device())
-                    ->changePower(((bike *)bluetoothManager->device())->lastRequestedPower().value() - 10);
+                bluetoothManager->device()->requestControl(
+                    devicecommand::power(((bike *)bluetoothManager->device())->lastRequestedPower().value() - 10));
                 if (trainProgram) {
                     trainProgram->overridePowerForCurrentRow(
                         ((bike *)bluetoothManager->device())->lastRequestedPower().value());
@@ -3266,6 +3530,7 @@ void homeform::Start_inner(bool send_event_to_device) {
                 bluetoothManager->device()->clearStats();
             }
             Session.clear();
+            backupJournal.close();
             chartImagesFilenames.clear();
 
 #ifdef Q_OS_IOS
@@ -3484,17 +3749,18 @@ void homeform::update() {
         qDebug() << "!!!!QSETTINGS ERROR!" << settings.status();
     }
 
+    // the icons and the texts of the top bar change only with the state, Start and Stop emit them: only the start
+    // button blinks while paused
     if ((paused || stopped) &&
         settings.value(QZSettings::top_bar_enabled, QZSettings::default_top_bar_enabled).toBool()) {
-
-        emit stopIconChanged(stopIcon());
-        emit stopTextChanged(stopText());
-        emit startIconChanged(startIcon());
-        emit startTextChanged(startText());
         emit startColorChanged(startColor());
-        emit stopColorChanged(stopColor());
     }
 
+    // the tiles of the layout refreshed in this update
+    tileTick++;
+    for (QObject *tile : qAsConst(dataList))
+        ((DataObject *)tile)->beginRefresh(tileTick);
+
     if (bluetoothManager->device()) {
 
         double inclination = 0;
@@ -3536,28 +3802,35 @@ void homeform::update() {
             cm_inches_conversion = 0.393701;
         }
 
-        emit signalChanged(signal());
+        // the overlays and the recording tools poll the telemetry segment
+        bluetoothManager->stateFileUpdate();
+
+        const QString currentSignal = signal();
+        if (currentSignal != lastSignal) {
+            lastSignal = currentSignal;
+            emit signalChanged(currentSignal);
+        }
         emit currentSpeedChanged(bluetoothManager->device()->currentSpeed().value());
-        speed->setValue(QString::number(bluetoothManager->device()->currentSpeed().value() * unit_conversion, 'f', 1));
-        speed->setSecondLine(
-            QStringLiteral("AVG: ") +
-            QString::number((bluetoothManager->device())->currentSpeed().average() * unit_conversion, 'f', 1) +
-            QStringLiteral(" MAX: ") +
-            QString::number((bluetoothManager->device())->currentSpeed().max() * unit_conversion, 'f', 1));
-        heart->setValue(QString::number(bluetoothManager->device()->currentHeart().value(), 'f', 0));
-
-        calories->setValue(QString::number(bluetoothManager->device()->calories().value(), 'f', 0));
-        calories->setSecondLine(QString::number(bluetoothManager->device()->calories().rate1s() * 60.0, 'f', 1) +
-                                " /min");
+        speed->setValueNumber(bluetoothManager->device()->currentSpeed().value() * unit_conversion, 1);
+        speed->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), 1,
+                                    (bluetoothManager->device())->currentSpeed().average() * unit_conversion,
+                                    (bluetoothManager->device())->currentSpeed().max() * unit_conversion);
+        heart->setValueNumber(bluetoothManager->device()->currentHeart().value(), 0);
+
+        calories->setValueNumber(bluetoothManager->device()->calories().value(), 0);
+        calories->setSecondLineNumbers(QStringLiteral("%1 /min"), 1,
+                                       bluetoothManager->device()->calories().rate1s() * 60.0);
         if (!settings.value(QZSettings::fitmetria_fanfit_enable, QZSettings::default_fitmetria_fanfit_enable).toBool())
-            fan->setValue(QString::number(bluetoothManager->device()->fanSpeed()));
+            fan->setValueNumber(bluetoothManager->device()->fanSpeed(), 0);
         else
-            fan->setValue(QString::number(qRound(((double)bluetoothManager->device()->fanSpeed()) / 10.0) * 10.0));
-        jouls->setValue(QString::number(bluetoothManager->device()->jouls().value() / 1000.0, 'f', 1));
-        jouls->setSecondLine(QString::number(bluetoothManager->device()->jouls().rate1s() / 1000.0 * 60.0, 'f', 1) +
-                             " /min");
-        elapsed->setValue(bluetoothManager->device()->elapsedTime().toString(QStringLiteral("h:mm:ss")));
-        moving_time->setValue(bluetoothManager->device()->movingTime().toString(QStringLiteral("h:mm:ss")));
+            fan->setValueNumber(qRound(((double)bluetoothManager->device()->fanSpeed()) / 10.0) * 10.0, 0);
+        jouls->setValueNumber(bluetoothManager->device()->jouls().value() / 1000.0, 1);
+        jouls->setSecondLineNumbers(QStringLiteral("%1 /min"), 1,
+                                    bluetoothManager->device()->jouls().rate1s() / 1000.0 * 60.0);
+        if (elapsed->due())
+            elapsed->setValue(bluetoothManager->device()->elapsedTime().toString(QStringLiteral("h:mm:ss")));
+        if (moving_time->due())
+            moving_time->setValue(bluetoothManager->device()->movingTime().toString(QStringLiteral("h:mm:ss")));
 
         if (trainProgram) {
             // sync the video with the zwo workout file
@@ -3575,143 +3848,168 @@ void homeform::update() {
                 }
             }
 
-            peloton_offset->setValue(QString::number(trainProgram->offsetElapsedTime()) + QStringLiteral(" sec."));
-            peloton_remaining->setValue(trainProgram->remainingTime().toString("h:mm:ss"));
-            peloton_remaining->setSecondLine(QString::number(trainProgram->offsetElapsedTime()) +
-                                             QStringLiteral(" sec."));
-            remaningTimeTrainingProgramCurrentRow->setValue(
-                trainProgram->currentRowRemainingTime().toString(QStringLiteral("h:mm:ss")));
-            remaningTimeTrainingProgramCurrentRow->setSecondLine(
-                trainProgram->currentRowElapsedTime().toString(QStringLiteral("h:mm:ss")));
-            targetMets->setValue(QString::number(trainProgram->currentTargetMets(), 'f', 1));
-            trainrow next = trainProgram->getRowFromCurrent(1);
-            trainrow next_1 = trainProgram->getRowFromCurrent(2);
-            if (next.duration.second() != 0 || next.duration.minute() != 0 || next.duration.hour() != 0) {
-                if (next.requested_peloton_resistance != -1)
-                    nextRows->setValue(QStringLiteral("PR") + QString::number(next.requested_peloton_resistance) +
-                                       QStringLiteral(" ") + next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.resistance != -1)
-                    nextRows->setValue(QStringLiteral("R") + QString::number(next.resistance) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.zoneHR != -1)
-                    nextRows->setValue(QStringLiteral("HR") + QString::number(next.zoneHR) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.HRmin != -1 && next.HRmax != -1)
-                    nextRows->setValue(QStringLiteral("HR") + QString::number(next.HRmin) + QStringLiteral("-") +
-                                       QString::number(next.HRmax) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.speed != -1 && next.inclination != -1)
-                    nextRows->setValue(QStringLiteral("S") + QString::number(next.speed) + QStringLiteral("I") +
-                                       QString::number(next.inclination) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.speed != -1)
-                    nextRows->setValue(QStringLiteral("S") + QString::number(next.speed) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.inclination != -200)
-                    nextRows->setValue(QStringLiteral("I") + QString::number(next.inclination) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                else if (next.power != -1) {
-                    double ftpPerc = (next.power / ftpSetting) * 100.0;
-                    uint8_t ftpZone = 1;
-                    if (ftpPerc < 56) {
-                        ftpZone = 1;
-                    } else if (ftpPerc < 76) {
-                        ftpZone = 2;
-                    } else if (ftpPerc < 91) {
-                        ftpZone = 3;
-                    } else if (ftpPerc < 106) {
-                        ftpZone = 4;
-                    } else if (ftpPerc < 121) {
-                        ftpZone = 5;
-                    } else if (ftpPerc < 151) {
-                        ftpZone = 6;
-                    } else {
-                        ftpZone = 7;
-                    }
-                    nextRows->setValue(QStringLiteral("Z") + QString::number(ftpZone) + QStringLiteral(" ") +
-                                       next.duration.toString(QStringLiteral("mm:ss")));
-                    if (next_1.duration.second() != 0 || next_1.duration.minute() != 0 || next_1.duration.hour() != 0) {
-                        if (next_1.requested_peloton_resistance != -1)
-                            nextRows->setSecondLine(
-                                QStringLiteral("PR") + QString::number(next_1.requested_peloton_resistance) +
-                                QStringLiteral(" ") + next_1.duration.toString(QStringLiteral("mm:ss")));
-                        else if (next_1.resistance != -1)
-                            nextRows->setSecondLine(QStringLiteral("R") + QString::number(next_1.resistance) +
-                                                    QStringLiteral(" ") +
-                                                    next_1.duration.toString(QStringLiteral("mm:ss")));
-                        else if (next_1.power != -1) {
-                            double ftpPerc = (next_1.power / ftpSetting) * 100.0;
-                            uint8_t ftpZone = 1;
-                            if (ftpPerc < 56) {
-                                ftpZone = 1;
-                            } else if (ftpPerc < 76) {
-                                ftpZone = 2;
-                            } else if (ftpPerc < 91) {
-                                ftpZone = 3;
-                            } else if (ftpPerc < 106) {
-                                ftpZone = 4;
-                            } else if (ftpPerc < 121) {
-                                ftpZone = 5;
-                            } else if (ftpPerc < 151) {
-                                ftpZone = 6;
-                            } else {
-                                ftpZone = 7;
+            peloton_offset->setValueNumbers(QStringLiteral("%1 sec."), 0, trainProgram->offsetElapsedTime());
+            if (peloton_remaining->due())
+                peloton_remaining->setValue(trainProgram->remainingTime().toString("h:mm:ss"));
+            peloton_remaining->setSecondLineNumbers(QStringLiteral("%1 sec."), 0, trainProgram->offsetElapsedTime());
+            if (remaningTimeTrainingProgramCurrentRow->due()) {
+                remaningTimeTrainingProgramCurrentRow->setValue(
+                    trainProgram->currentRowRemainingTime().toString(QStringLiteral("h:mm:ss")));
+                remaningTimeTrainingProgramCurrentRow->setSecondLine(
+                    trainProgram->currentRowElapsedTime().toString(QStringLiteral("h:mm:ss")));
+            }
+            targetMets->setValueNumber(trainProgram->currentTargetMets(), 1);
+            if (nextRows->due()) {
+                trainrow next = trainProgram->getRowFromCurrent(1);
+                trainrow next_1 = trainProgram->getRowFromCurrent(2);
+                if (next.duration.second() != 0 || next.duration.minute() != 0 || next.duration.hour() != 0) {
+                    if (next.requested_peloton_resistance != -1)
+                        nextRows->setValue(QStringLiteral("PR") + QString::number(next.requested_peloton_resistance) +
+                                           QStringLiteral(" ") + next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.resistance != -1)
+                        nextRows->setValue(QStringLiteral("R") + QString::number(next.resistance) +
+                                           QStringLiteral(" ") + next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.zoneHR != -1)
+                        nextRows->setValue(QStringLiteral("HR") + QString::number(next.zoneHR) + QStringLiteral(" ") +
+                                           next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.HRmin != -1 && next.HRmax != -1)
+                        nextRows->setValue(QStringLiteral("HR") + QString::number(next.HRmin) + QStringLiteral("-") +
+                                           QString::number(next.HRmax) + QStringLiteral(" ") +
+                                           next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.speed != -1 && next.inclination != -1)
+                        nextRows->setValue(QStringLiteral("S") + QString::number(next.speed) + QStringLiteral("I") +
+                                           QString::number(next.inclination) + QStringLiteral(" ") +
+                                           next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.speed != -1)
+                        nextRows->setValue(QStringLiteral("S") + QString::number(next.speed) + QStringLiteral(" ") +
+                                           next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.inclination != -200)
+                        nextRows->setValue(QStringLiteral("I") + QString::number(next.inclination) +
+                                           QStringLiteral(" ") + next.duration.toString(QStringLiteral("mm:ss")));
+                    else if (next.power != -1) {
+                        double ftpPerc = (next.power / ftpSetting) * 100.0;
+                        uint8_t ftpZone = 1;
+                        if (ftpPerc < 56) {
+                            ftpZone = 1;
+                        } else if (ftpPerc < 76) {
+                            ftpZone = 2;
+                        } else if (ftpPerc < 91) {
+                            ftpZone = 3;
+                        } else if (ftpPerc < 106) {
+                            ftpZone = 4;
+                        } else if (ftpPerc < 121) {
+                            ftpZone = 5;
+                        } else if (ftpPerc < 151) {
+                            ftpZone = 6;
+                        } else {
+                            ftpZone = 7;
+                        }
+                        nextRows->setValue(QStringLiteral("Z") + QString::number(ftpZone) + QStringLiteral(" ") +
+                                           next.duration.toString(QStringLiteral("mm:ss")));
+                        if (next_1.duration.second() != 0 || next_1.duration.minute() != 0 ||
+                            next_1.duration.hour() != 0) {
+                            if (next_1.requested_peloton_resistance != -1)
+                                nextRows->setSecondLine(
+                                    QStringLiteral("PR") + QString::number(next_1.requested_peloton_resistance) +
+                                    QStringLiteral(" ") + next_1.duration.toString(QStringLiteral("mm:ss")));
+                            else if (next_1.resistance != -1)
+                                nextRows->setSecondLine(QStringLiteral("R") + QString::number(next_1.resistance) +
+                                                        QStringLiteral(" ") +
+                                                        next_1.duration.toString(QStringLiteral("mm:ss")));
+                            else if (next_1.power != -1) {
+                                double ftpPerc = (next_1.power / ftpSetting) * 100.0;
+                                uint8_t ftpZone = 1;
+                                if (ftpPerc < 56) {
+                                    ftpZone = 1;
+                                } else if (ftpPerc < 76) {
+                                    ftpZone = 2;
+                                } else if (ftpPerc < 91) {
+                                    ftpZone = 3;
+                                } else if (ftpPerc < 106) {
+                                    ftpZone = 4;
+                                } else if (ftpPerc < 121) {
+                                    ftpZone = 5;
+                                } else if (ftpPerc < 151) {
+                                    ftpZone = 6;
+                                } else {
+                                    ftpZone = 7;
+                                }
+                                nextRows->setSecondLine(QStringLiteral("Z") + QString::number(ftpZone) +
+                                                        QStringLiteral(" ") +
+                                                        next_1.duration.toString(QStringLiteral("mm:ss")));
                             }
-                            nextRows->setSecondLine(QStringLiteral("Z") + QString::number(ftpZone) +
-                                                    QStringLiteral(" ") +
-                                                    next_1.duration.toString(QStringLiteral("mm:ss")));
+                        } else {
+                            nextRows->setSecondLine(QStringLiteral("N/A"));
                         }
-                    } else {
-                        nextRows->setSecondLine(QStringLiteral("N/A"));
                     }
+                } else {
+                    nextRows->setValue(QStringLiteral("N/A"));
                 }
-            } else {
-                nextRows->setValue(QStringLiteral("N/A"));
             }
         }
-        mets->setValue(QString::number(bluetoothManager->device()->currentMETS().value(), 'f', 1));
-        mets->setSecondLine(
-            QStringLiteral("AVG: ") + QString::number(bluetoothManager->device()->currentMETS().average(), 'f', 1) +
-            QStringLiteral("MAX: ") + QString::number(bluetoothManager->device()->currentMETS().max(), 'f', 1));
-        lapElapsed->setValue(bluetoothManager->device()->lapElapsedTime().toString(QStringLiteral("h:mm:ss")));
-        avgWatt->setValue(QString::number(bluetoothManager->device()->wattsMetric().average(), 'f', 0));
-        avgWattLap->setValue(QString::number(bluetoothManager->device()->wattsMetric().lapAverage(), 'f', 0));
-        wattKg->setValue(QString::number(bluetoothManager->device()->wattKg().value(), 'f', 1));
-        wattKg->setSecondLine(
-            QStringLiteral("AVG: ") + QString::number(bluetoothManager->device()->wattKg().average(), 'f', 1) +
-            QStringLiteral("MAX: ") + QString::number(bluetoothManager->device()->wattKg().max(), 'f', 1));
-        QLocale locale = QLocale::system();
-
-        // Format the time based on the locale
-        QString timeFormat = locale.timeFormat(QLocale::ShortFormat);
-        bool usesAMPMFormat = timeFormat.toUpper().contains("A");
-        QDateTime currentTime = QDateTime::currentDateTime();
-
-        QString formattedTime;
-        if (usesAMPMFormat) {
-            // The locale uses 12-hour format with AM/PM
-            formattedTime = currentTime.toString("h:mm:ss AP");
-        } else {
-            // The locale uses 24-hour format
-            formattedTime = currentTime.toString("H:mm:ss");
+        mets->setValueNumber(bluetoothManager->device()->currentMETS().value(), 1);
+        mets->setSecondLineNumbers(QStringLiteral("AVG: %1MAX: %2"), 1,
+                                   bluetoothManager->device()->currentMETS().average(),
+                                   bluetoothManager->device()->currentMETS().max());
+        if (lapElapsed->due())
+            lapElapsed->setValue(bluetoothManager->device()->lapElapsedTime().toString(QStringLiteral("h:mm:ss")));
+        avgWatt->setValueNumber(bluetoothManager->device()->wattsMetric().average(), 0);
+        avgWattLap->setValueNumber(bluetoothManager->device()->wattsMetric().lapAverage(), 0);
+        {
+            // O(1): the curve is updated when the sample is appended to the session
+            const PowerCurve &curve = Session.powerCurve();
+            DataObject *peaks[] = {peakPower5s, peakPower1m, peakPower5m, peakPower20m};
+            const int peakSeconds[] = {5, 60, 5 * 60, 20 * 60};
+            for (int p = 0; p < 4; p++) {
+                if (!peaks[p]->due())
+                    continue;
+                double peak = curve.best(peakSeconds[p]);
+                if (peak < 0) {
+                    peaks[p]->setValue(QStringLiteral("-"));
+                    peaks[p]->setSecondLine(QString());
+                } else {
+                    peaks[p]->setValueNumber(peak, 0);
+                    peaks[p]->setSecondLineNumbers(QStringLiteral("%1 W/Kg"), 1,
+                                                   peak / QZSettingsSnapshot::get().weight);
+                }
+            }
+        }
+        wattKg->setValueNumber(bluetoothManager->device()->wattKg().value(), 1);
+        wattKg->setSecondLineNumbers(QStringLiteral("AVG: %1MAX: %2"), 1,
+                                     bluetoothManager->device()->wattKg().average(),
+                                     bluetoothManager->device()->wattKg().max());
+        if (datetime->due()) {
+            QLocale locale = QLocale::system();
+
+            // Format the time based on the locale
+            QString timeFormat = locale.timeFormat(QLocale::ShortFormat);
+            bool usesAMPMFormat = timeFormat.toUpper().contains("A");
+            QDateTime currentTime = QDateTime::currentDateTime();
+
+            QString formattedTime;
+            if (usesAMPMFormat) {
+                // The locale uses 12-hour format with AM/PM
+                formattedTime = currentTime.toString("h:mm:ss AP");
+            } else {
+                // The locale uses 24-hour format
+                formattedTime = currentTime.toString("H:mm:ss");
+            }
+            datetime->setValue(formattedTime);
         }
-        datetime->setValue(formattedTime);
         if (power5s)
             watts = bluetoothManager->device()->wattsMetric().average5s();
         else
             watts = bluetoothManager->device()->wattsMetric().value();
-        watt->setValue(QString::number(watts, 'f', 0));
-        weightLoss->setValue(QString::number(miles ? bluetoothManager->device()->weightLoss() * 35.274
-                                                   : bluetoothManager->device()->weightLoss(),
-                                             'f', 2));
+        watt->setValueNumber(watts, 0);
+        weightLoss->setValueNumber(
+            miles ? bluetoothManager->device()->weightLoss() * 35.274 : bluetoothManager->device()->weightLoss(), 2);
 
         cadence = bluetoothManager->device()->currentCadence().value();
-        this->cadence->setValue(QString::number(cadence));
-        this->cadence->setSecondLine(
-            QStringLiteral("AVG: ") +
-            QString::number(((bike *)bluetoothManager->device())->currentCadence().average(), 'f', 0) +
-            QStringLiteral(" MAX: ") +
-            QString::number(((bike *)bluetoothManager->device())->currentCadence().max(), 'f', 0));
+        if (this->cadence->due())
+            this->cadence->setValue(QString::number(cadence));
+        this->cadence->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), 0,
+                                            ((bike *)bluetoothManager->device())->currentCadence().average(),
+                                            ((bike *)bluetoothManager->device())->currentCadence().max());
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
@@ -3738,7 +4036,7 @@ void homeform::update() {
 
         if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
 
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
+            odometer->setValueNumber(bluetoothManager->device()->odometer() * unit_conversion, 2);
             if (bluetoothManager->device()->currentSpeed().value()) {
                 pace = 10000 / (((treadmill *)bluetoothManager->device())->currentPace().second() +
                                 (((treadmill *)bluetoothManager->device())->currentPace().minute() * 60));
@@ -3755,51 +4053,46 @@ void homeform::update() {
             verticalOscillation = ((treadmill *)bluetoothManager->device())->currentVerticalOscillation().value();
             stepCount = ((treadmill *)bluetoothManager->device())->currentStepCount().value();
             inclination = ((treadmill *)bluetoothManager->device())->currentInclination().value();
-            if (((treadmill *)bluetoothManager->device())->currentSpeed().value() > 2)
-                this->pace->setValue(
-                    ((treadmill *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
-            else
-                this->pace->setValue("N/A");
-            this->pace->setSecondLine(
-                QStringLiteral("AVG: ") +
-                ((treadmill *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
-                QStringLiteral(" MAX: ") +
-                ((treadmill *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
-            this->inclination->setValue(QString::number(inclination, 'f', 1));
-            this->inclination->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentInclination().average(), 'f', 1) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentInclination().max(), 'f', 1));
-            elevation->setValue(QString::number(((treadmill *)bluetoothManager->device())->elevationGain().value() *
-                                                    meter_feet_conversion,
-                                                'f', (miles ? 0 : 1)));
-            elevation->setSecondLine(
-                QString::number(((treadmill *)bluetoothManager->device())->elevationGain().rate1s() * 60.0 *
-                                    meter_feet_conversion,
-                                'f', (miles ? 0 : 1)) +
-                " /min");
-            this->instantaneousStrideLengthCM->setValue(QString::number(strideLength, 'f', 0));
-            this->instantaneousStrideLengthCM->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentStrideLength().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentStrideLength().max(), 'f', 0));
-
-            this->groundContactMS->setValue(QString::number(groundContact, 'f', 0));
-            this->groundContactMS->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentGroundContact().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentGroundContact().max(), 'f', 0));
-
-            this->verticalOscillationMM->setValue(QString::number(verticalOscillation, 'f', 0));
-            this->verticalOscillationMM->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentVerticalOscillation().average(), 'f',
-                                0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((treadmill *)bluetoothManager->device())->currentVerticalOscillation().max(), 'f', 0));
+            if (this->pace->due()) {
+                if (((treadmill *)bluetoothManager->device())->currentSpeed().value() > 2)
+                    this->pace->setValue(
+                        ((treadmill *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
+                else
+                    this->pace->setValue("N/A");
+                this->pace->setSecondLine(
+                    QStringLiteral("AVG: ") +
+                    ((treadmill *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
+                    QStringLiteral(" MAX: ") +
+                    ((treadmill *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
+            }
+            this->inclination->setValueNumber(inclination, 1);
+            this->inclination->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 1,
+                ((treadmill *)bluetoothManager->device())->currentInclination().average(),
+                ((treadmill *)bluetoothManager->device())->currentInclination().max());
+            elevation->setValueNumber(((treadmill *)bluetoothManager->device())->elevationGain().value() *
+                                          meter_feet_conversion,
+                                      miles ? 0 : 1);
+            elevation->setSecondLineNumbers(
+                QStringLiteral("%1 /min"), miles ? 0 : 1,
+                ((treadmill *)bluetoothManager->device())->elevationGain().rate1s() * 60.0 * meter_feet_conversion);
+            this->instantaneousStrideLengthCM->setValueNumber(strideLength, 0);
+            this->instantaneousStrideLengthCM->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((treadmill *)bluetoothManager->device())->currentStrideLength().average(),
+                ((treadmill *)bluetoothManager->device())->currentStrideLength().max());
+
+            this->groundContactMS->setValueNumber(groundContact, 0);
+            this->groundContactMS->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((treadmill *)bluetoothManager->device())->currentGroundContact().average(),
+                ((treadmill *)bluetoothManager->device())->currentGroundContact().max());
+
+            this->verticalOscillationMM->setValueNumber(verticalOscillation, 0);
+            this->verticalOscillationMM->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((treadmill *)bluetoothManager->device())->currentVerticalOscillation().average(),
+                ((treadmill *)bluetoothManager->device())->currentVerticalOscillation().max());
 
             // if there is no training program, the color is based on presets
             if (!trainProgram || trainProgram->currentRow().speed == -1) {
@@ -3842,18 +4135,19 @@ void homeform::update() {
                 }
             }
 
-            this->target_pace->setValue(
-                ((treadmill *)bluetoothManager->device())->lastRequestedPace().toString(QStringLiteral("m:ss")));
-            this->target_speed->setValue(QString::number(
-                ((treadmill *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 'f', 1));
-            this->target_speed->setSecondLine(QString::number(bluetoothManager->device()->difficult() * 100.0, 'f', 0) +
-                                              QStringLiteral("% @0%=") +
-                                              QString::number(bluetoothManager->device()->difficult(), 'f', 0));
-            this->target_incline->setValue(
-                QString::number(((treadmill *)bluetoothManager->device())->lastRequestedInclination().value(), 'f', 1));
-            this->target_incline->setSecondLine(
-                QString::number(bluetoothManager->device()->inclinationDifficult() * 100.0, 'f', 0) +
-                QStringLiteral("% @0%=") + QString::number(bluetoothManager->device()->inclinationDifficult(), 'f', 0));
+            if (this->target_pace->due())
+                this->target_pace->setValue(
+                    ((treadmill *)bluetoothManager->device())->lastRequestedPace().toString(QStringLiteral("m:ss")));
+            this->target_speed->setValueNumber(
+                ((treadmill *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 1);
+            this->target_speed->setSecondLineNumbers(QStringLiteral("%1% @0%=%2"), 0,
+                                                     bluetoothManager->device()->difficult() * 100.0,
+                                                     bluetoothManager->device()->difficult());
+            this->target_incline->setValueNumber(
+                ((treadmill *)bluetoothManager->device())->lastRequestedInclination().value(), 1);
+            this->target_incline->setSecondLineNumbers(QStringLiteral("%1% @0%=%2"), 0,
+                                                       bluetoothManager->device()->inclinationDifficult() * 100.0,
+                                                       bluetoothManager->device()->inclinationDifficult());
 
             // originally born for #470. When the treadmill reaches the 0 speed it enters in the pause mode
             // so this logic should care about sync the treadmill state to the UI state
@@ -3874,74 +4168,65 @@ void homeform::update() {
 
             if (!pelotoncadence) {
                 inclination = ((bike *)bluetoothManager->device())->currentInclination().value();
-                this->inclination->setValue(QString::number(inclination, 'f', 1));
-                this->inclination->setSecondLine(
-                    QStringLiteral("AVG: ") +
-                    QString::number(((bike *)bluetoothManager->device())->currentInclination().average(), 'f', 1) +
-                    QStringLiteral(" MAX: ") +
-                    QString::number(((bike *)bluetoothManager->device())->currentInclination().max(), 'f', 1));
+                this->inclination->setValueNumber(inclination, 1);
+                this->inclination->setSecondLineNumbers(
+                    QStringLiteral("AVG: %1 MAX: %2"), 1,
+                    ((bike *)bluetoothManager->device())->currentInclination().average(),
+                    ((bike *)bluetoothManager->device())->currentInclination().max());
             }
             if (bluetoothManager->externalInclination())
-                extIncline->setValue(
-                    QString::number(bluetoothManager->externalInclination()->currentInclination().value(), 'f', 1));
+                extIncline->setValueNumber(bluetoothManager->externalInclination()->currentInclination().value(), 1);
             double elite_rizer_gain =
                 settings.value(QZSettings::elite_rizer_gain, QZSettings::default_elite_rizer_gain).toDouble();
-            extIncline->setSecondLine(QStringLiteral("Gain: ") + QString::number(elite_rizer_gain, 'f', 1));
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
+            extIncline->setSecondLineNumbers(QStringLiteral("Gain: %1"), 1, elite_rizer_gain);
+            odometer->setValueNumber(bluetoothManager->device()->odometer() * unit_conversion, 2);
             resistance = ((bike *)bluetoothManager->device())->currentResistance().value();
             peloton_resistance = ((bike *)bluetoothManager->device())->pelotonResistance().value();
-            this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
-            this->target_resistance->setValue(
-                QString::number(((bike *)bluetoothManager->device())->lastRequestedResistance().value(), 'f', 0));
-            this->target_peloton_resistance->setValue(QString::number(
-                ((bike *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 'f', 0));
-            this->target_cadence->setValue(
-                QString::number(((bike *)bluetoothManager->device())->lastRequestedCadence().value(), 'f', 0));
-            this->target_power->setValue(
-                QString::number(((bike *)bluetoothManager->device())->lastRequestedPower().value(), 'f', 0));
-            this->resistance->setValue(QString::number(resistance, 'f', 0));
+            this->peloton_resistance->setValueNumber(peloton_resistance, 0);
+            this->target_resistance->setValueNumber(
+                ((bike *)bluetoothManager->device())->lastRequestedResistance().value(), 0);
+            this->target_peloton_resistance->setValueNumber(
+                ((bike *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 0);
+            this->target_cadence->setValueNumber(((bike *)bluetoothManager->device())->lastRequestedCadence().value(),
+                                                 0);
+            this->target_power->setValueNumber(((bike *)bluetoothManager->device())->lastRequestedPower().value(), 0);
+            this->resistance->setValueNumber(resistance, 0);
             if (settings.value(QZSettings::gears_gain, QZSettings::default_gears_gain).toDouble() == 1.0)
-                this->gears->setValue(QString::number(((bike *)bluetoothManager->device())->gears()));
+                this->gears->setValueNumber(((bike *)bluetoothManager->device())->gears(), 0);
             else
-                this->gears->setValue(QString::number(((bike *)bluetoothManager->device())->gears(), 'f', 1));
-
-            this->resistance->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((bike *)bluetoothManager->device())->currentResistance().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((bike *)bluetoothManager->device())->currentResistance().max(), 'f', 0));
-            this->peloton_resistance->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((bike *)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((bike *)bluetoothManager->device())->pelotonResistance().max(), 'f', 0));
-            this->target_resistance->setSecondLine(
-                QString::number(bluetoothManager->device()->difficult() * 100.0, 'f', 0) + QStringLiteral("% @0%=") +
-                QString::number(
+                this->gears->setValueNumber(((bike *)bluetoothManager->device())->gears(), 1);
+
+            this->resistance->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), 0,
+                                                   ((bike *)bluetoothManager->device())->currentResistance().average(),
+                                                   ((bike *)bluetoothManager->device())->currentResistance().max());
+            this->peloton_resistance->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((bike *)bluetoothManager->device())->pelotonResistance().average(),
+                ((bike *)bluetoothManager->device())->pelotonResistance().max());
+            if (this->target_resistance->due())
+                this->target_resistance->setSecondLineNumbers(
+                    QStringLiteral("%1% @0%=%2"), 0, bluetoothManager->device()->difficult() * 100.0,
                     bluetoothManager->device()->difficult() *
                         settings.value(QZSettings::bike_resistance_gain_f, QZSettings::default_bike_resistance_gain_f)
                             .toDouble() *
                         settings.value(QZSettings::bike_resistance_offset, QZSettings::default_bike_resistance_offset)
-                            .toDouble(),
-                    'f', 0));
+                            .toDouble());
 
-            elevation->setValue(
-                QString::number(((bike *)bluetoothManager->device())->elevationGain().value() * meter_feet_conversion,
-                                'f', (miles ? 0 : 1)));
-            elevation->setSecondLine(QString::number(((bike *)bluetoothManager->device())->elevationGain().rate1s() *
-                                                         60.0 * meter_feet_conversion,
-                                                     'f', (miles ? 0 : 1)) +
-                                     " /min");
+            elevation->setValueNumber(
+                ((bike *)bluetoothManager->device())->elevationGain().value() * meter_feet_conversion, miles ? 0 : 1);
+            elevation->setSecondLineNumbers(
+                QStringLiteral("%1 /min"), miles ? 0 : 1,
+                ((bike *)bluetoothManager->device())->elevationGain().rate1s() * 60.0 * meter_feet_conversion);
 
-            this->steeringAngle->setValue(
-                QString::number(((bike *)bluetoothManager->device())->currentSteeringAngle().value(), 'f', 1));
+            this->steeringAngle->setValueNumber(((bike *)bluetoothManager->device())->currentSteeringAngle().value(),
+                                                1);
 
             if ((!trainProgram || (trainProgram && !trainProgram->isStarted())) &&
                 !((bike *)bluetoothManager->device())->ergModeSupportedAvailableByHardware() &&
                 ((bike *)bluetoothManager->device())->lastRequestedPower().value() > 0 && m_overridePower) {
                 qDebug() << QStringLiteral("using target power tile for ERG workout manually");
-                ((bike *)bluetoothManager->device())
-                    ->changePower(((bike *)bluetoothManager->device())->lastRequestedPower().value());
+                bluetoothManager->device()->requestControl(
+                    devicecommand::power(((bike *)bluetoothManager->device())->lastRequestedPower().value()));
             }
 
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
@@ -3956,26 +4241,33 @@ void homeform::update() {
                 pace = 0;
             }
 
-            this->gears->setValue(QString::number(((rower *)bluetoothManager->device())->gears()));
-            this->pace_last500m->setValue(
-                ((rower *)bluetoothManager->device())->lastPace500m().toString(QStringLiteral("m:ss")));
+            if (this->gears->due())
+                this->gears->setValue(QString::number(((rower *)bluetoothManager->device())->gears()));
+            if (this->pace_last500m->due())
+                this->pace_last500m->setValue(
+                    ((rower *)bluetoothManager->device())->lastPace500m().toString(QStringLiteral("m:ss")));
 
-            this->pace->setValue(((rower *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
-            this->pace->setSecondLine(
-                QStringLiteral("AVG: ") +
-                ((rower *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
-                QStringLiteral(" MAX: ") +
-                ((rower *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
-            this->target_pace->setValue(
-                ((rower *)bluetoothManager->device())->lastRequestedPace().toString(QStringLiteral("m:ss")));
+            if (this->pace->due()) {
+                this->pace->setValue(
+                    ((rower *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
+                this->pace->setSecondLine(
+                    QStringLiteral("AVG: ") +
+                    ((rower *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
+                    QStringLiteral(" MAX: ") +
+                    ((rower *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
+            }
+            if (this->target_pace->due())
+                this->target_pace->setValue(
+                    ((rower *)bluetoothManager->device())->lastRequestedPace().toString(QStringLiteral("m:ss")));
             if (trainProgram) {
-                this->target_pace->setSecondLine(((rower *)bluetoothManager->device())
-                                                     ->speedToPace(trainProgram->currentRow().lower_speed)
-                                                     .toString(QStringLiteral("m:ss")) +
-                                                 " - " +
-                                                 ((rower *)bluetoothManager->device())
-                                                     ->speedToPace(trainProgram->currentRow().upper_speed)
-                                                     .toString(QStringLiteral("m:ss")));
+                if (this->target_pace->due())
+                    this->target_pace->setSecondLine(((rower *)bluetoothManager->device())
+                                                         ->speedToPace(trainProgram->currentRow().lower_speed)
+                                                         .toString(QStringLiteral("m:ss")) +
+                                                     " - " +
+                                                     ((rower *)bluetoothManager->device())
+                                                         ->speedToPace(trainProgram->currentRow().upper_speed)
+                                                         .toString(QStringLiteral("m:ss")));
 
                 if (((rower *)bluetoothManager->device())->lastRequestedCadence().value() > 0) {
                     if (bluetoothManager->device()->currentSpeed().value() <= trainProgram->currentRow().upper_speed &&
@@ -4017,56 +4309,49 @@ void homeform::update() {
                     break;
                 }
             }
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * 1000.0, 'f', 0));
+            odometer->setValueNumber(bluetoothManager->device()->odometer() * 1000.0, 0);
             resistance = ((rower *)bluetoothManager->device())->currentResistance().value();
             peloton_resistance = ((rower *)bluetoothManager->device())->pelotonResistance().value();
             totalStrokes = ((rower *)bluetoothManager->device())->currentStrokesCount().value();
             avgStrokesRate = ((rower *)bluetoothManager->device())->currentCadence().average();
             maxStrokesRate = ((rower *)bluetoothManager->device())->currentCadence().max();
             avgStrokesLength = ((rower *)bluetoothManager->device())->currentStrokesLength().average();
-            this->strokesCount->setValue(
-                QString::number(((rower *)bluetoothManager->device())->currentStrokesCount().value(), 'f', 0));
-            this->strokesLength->setValue(
-                QString::number(((rower *)bluetoothManager->device())->currentStrokesLength().value(), 'f', 1));
-
-            this->target_speed->setValue(QString::number(
-                ((rower *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 'f', 1));
-
-            this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
-            this->target_resistance->setValue(
-                QString::number(((rower *)bluetoothManager->device())->lastRequestedResistance().value(), 'f', 0));
-            this->target_peloton_resistance->setValue(QString::number(
-                ((rower *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 'f', 0));
-            this->target_cadence->setValue(
-                QString::number(((rower *)bluetoothManager->device())->lastRequestedCadence().value(), 'f', 0));
-            this->target_power->setValue(
-                QString::number(((rower *)bluetoothManager->device())->lastRequestedPower().value(), 'f', 0));
-            this->resistance->setValue(QString::number(resistance, 'f', 0));
-
-            this->resistance->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((rower *)bluetoothManager->device())->currentResistance().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((rower *)bluetoothManager->device())->currentResistance().max(), 'f', 0));
-            this->peloton_resistance->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((rower *)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((rower *)bluetoothManager->device())->pelotonResistance().max(), 'f', 0));
-            this->target_resistance->setSecondLine(
-                QString::number(bluetoothManager->device()->difficult() * 100.0, 'f', 0) + QStringLiteral("% @0%=") +
-                QString::number(
+            this->strokesCount->setValueNumber(((rower *)bluetoothManager->device())->currentStrokesCount().value(), 0);
+            this->strokesLength->setValueNumber(((rower *)bluetoothManager->device())->currentStrokesLength().value(),
+                                                1);
+
+            this->target_speed->setValueNumber(
+                ((rower *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 1);
+
+            this->peloton_resistance->setValueNumber(peloton_resistance, 0);
+            this->target_resistance->setValueNumber(
+                ((rower *)bluetoothManager->device())->lastRequestedResistance().value(), 0);
+            this->target_peloton_resistance->setValueNumber(
+                ((rower *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 0);
+            this->target_cadence->setValueNumber(((rower *)bluetoothManager->device())->lastRequestedCadence().value(),
+                                                 0);
+            this->target_power->setValueNumber(((rower *)bluetoothManager->device())->lastRequestedPower().value(), 0);
+            this->resistance->setValueNumber(resistance, 0);
+
+            this->resistance->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), 0,
+                                                   ((rower *)bluetoothManager->device())->currentResistance().average(),
+                                                   ((rower *)bluetoothManager->device())->currentResistance().max());
+            this->peloton_resistance->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((rower *)bluetoothManager->device())->pelotonResistance().average(),
+                ((rower *)bluetoothManager->device())->pelotonResistance().max());
+            if (this->target_resistance->due())
+                this->target_resistance->setSecondLineNumbers(
+                    QStringLiteral("%1% @0%=%2"), 0, bluetoothManager->device()->difficult() * 100.0,
                     bluetoothManager->device()->difficult() *
                         settings.value(QZSettings::bike_resistance_gain_f, QZSettings::default_bike_resistance_gain_f)
                             .toDouble() *
                         settings.value(QZSettings::bike_resistance_offset, QZSettings::default_bike_resistance_offset)
-                            .toDouble(),
-                    'f', 0));
-            this->strokesLength->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((rower *)bluetoothManager->device())->currentStrokesLength().average(), 'f', 1) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((rower *)bluetoothManager->device())->currentStrokesLength().max(), 'f', 1));
+                            .toDouble());
+            this->strokesLength->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 1,
+                ((rower *)bluetoothManager->device())->currentStrokesLength().average(),
+                ((rower *)bluetoothManager->device())->currentStrokesLength().max());
 
             // if there is no training program, the color is based on presets
             if (!trainProgram || trainProgram->currentRow().speed == -1) {
@@ -4095,64 +4380,63 @@ void homeform::update() {
             }
         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) {
 
-            if (((elliptical *)bluetoothManager->device())->currentSpeed().value() > 2)
-                this->pace->setValue(
-                    ((elliptical *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
-            else
-                this->pace->setValue("N/A");
-            this->pace->setSecondLine(
-                QStringLiteral("AVG: ") +
-                ((elliptical *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
-                QStringLiteral(" MAX: ") +
-                ((elliptical *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
-            odometer->setValue(QString::number(bluetoothManager->device()->odometer() * unit_conversion, 'f', 2));
+            if (this->pace->due()) {
+                if (((elliptical *)bluetoothManager->device())->currentSpeed().value() > 2)
+                    this->pace->setValue(
+                        ((elliptical *)bluetoothManager->device())->currentPace().toString(QStringLiteral("m:ss")));
+                else
+                    this->pace->setValue("N/A");
+                this->pace->setSecondLine(
+                    QStringLiteral("AVG: ") +
+                    ((elliptical *)bluetoothManager->device())->averagePace().toString(QStringLiteral("m:ss")) +
+                    QStringLiteral(" MAX: ") +
+                    ((elliptical *)bluetoothManager->device())->maxPace().toString(QStringLiteral("m:ss")));
+            }
+            odometer->setValueNumber(bluetoothManager->device()->odometer() * unit_conversion, 2);
             resistance = ((elliptical *)bluetoothManager->device())->currentResistance().value();
             peloton_resistance = ((elliptical *)bluetoothManager->device())->pelotonResistance().value();
-            this->peloton_resistance->setValue(QString::number(peloton_resistance, 'f', 0));
-            this->target_resistance->setValue(
-                QString::number(((elliptical *)bluetoothManager->device())->lastRequestedResistance().value(), 'f', 0));
-            this->target_peloton_resistance->setValue(QString::number(
-                ((elliptical *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 'f', 0));
-            this->resistance->setValue(QString::number(resistance));
-            this->peloton_resistance->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((elliptical *)bluetoothManager->device())->pelotonResistance().average(), 'f', 0) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((elliptical *)bluetoothManager->device())->pelotonResistance().max(), 'f', 0));
-            this->target_resistance->setSecondLine(
-                QString::number(bluetoothManager->device()->difficult() * 100.0, 'f', 0) + QStringLiteral("% @0%=") +
-                QString::number(
+            this->peloton_resistance->setValueNumber(peloton_resistance, 0);
+            this->target_resistance->setValueNumber(
+                ((elliptical *)bluetoothManager->device())->lastRequestedResistance().value(), 0);
+            this->target_peloton_resistance->setValueNumber(
+                ((elliptical *)bluetoothManager->device())->lastRequestedPelotonResistance().value(), 0);
+            if (this->resistance->due())
+                this->resistance->setValue(QString::number(resistance));
+            this->peloton_resistance->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 0,
+                ((elliptical *)bluetoothManager->device())->pelotonResistance().average(),
+                ((elliptical *)bluetoothManager->device())->pelotonResistance().max());
+            if (this->target_resistance->due())
+                this->target_resistance->setSecondLineNumbers(
+                    QStringLiteral("%1% @0%=%2"), 0, bluetoothManager->device()->difficult() * 100.0,
                     bluetoothManager->device()->difficult() *
                         settings.value(QZSettings::bike_resistance_gain_f, QZSettings::default_bike_resistance_gain_f)
                             .toDouble() *
                         settings.value(QZSettings::bike_resistance_offset, QZSettings::default_bike_resistance_offset)
-                            .toDouble(),
-                    'f', 0));
+                            .toDouble());
             inclination = ((elliptical *)bluetoothManager->device())->currentInclination().value();
-            this->inclination->setValue(QString::number(inclination, 'f', 1));
-            this->inclination->setSecondLine(
-                QStringLiteral("AVG: ") +
-                QString::number(((elliptical *)bluetoothManager->device())->currentInclination().average(), 'f', 1) +
-                QStringLiteral(" MAX: ") +
-                QString::number(((elliptical *)bluetoothManager->device())->currentInclination().max(), 'f', 1));
-            elevation->setValue(QString::number(((elliptical *)bluetoothManager->device())->elevationGain().value() *
-                                                    meter_feet_conversion,
-                                                'f', (miles ? 0 : 1)));
-            elevation->setSecondLine(
-                QString::number(((elliptical *)bluetoothManager->device())->elevationGain().rate1s() * 60.0 *
-                                    meter_feet_conversion,
-                                'f', (miles ? 0 : 1)) +
-                " /min");
-            this->gears->setValue(QString::number(((elliptical *)bluetoothManager->device())->gears()));
-            this->target_speed->setValue(QString::number(
-                ((elliptical *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 'f', 1));
-
-            this->target_cadence->setValue(
-                QString::number(((elliptical *)bluetoothManager->device())->lastRequestedCadence().value(), 'f', 0));
+            this->inclination->setValueNumber(inclination, 1);
+            this->inclination->setSecondLineNumbers(
+                QStringLiteral("AVG: %1 MAX: %2"), 1,
+                ((elliptical *)bluetoothManager->device())->currentInclination().average(),
+                ((elliptical *)bluetoothManager->device())->currentInclination().max());
+            elevation->setValueNumber(((elliptical *)bluetoothManager->device())->elevationGain().value() *
+                                          meter_feet_conversion,
+                                      miles ? 0 : 1);
+            elevation->setSecondLineNumbers(
+                QStringLiteral("%1 /min"), miles ? 0 : 1,
+                ((elliptical *)bluetoothManager->device())->elevationGain().rate1s() * 60.0 * meter_feet_conversion);
+            if (this->gears->due())
+                this->gears->setValue(QString::number(((elliptical *)bluetoothManager->device())->gears()));
+            this->target_speed->setValueNumber(
+                ((elliptical *)bluetoothManager->device())->lastRequestedSpeed().value() * unit_conversion, 1);
+
+            this->target_cadence->setValueNumber(
+                ((elliptical *)bluetoothManager->device())->lastRequestedCadence().value(), 0);
         }
-        watt->setSecondLine(
-            QStringLiteral("AVG: ") + QString::number((bluetoothManager->device())->wattsMetric().average(), 'f', 0) +
-            QStringLiteral(" MAX: ") + QString::number((bluetoothManager->device())->wattsMetric().max(), 'f', 0));
+        watt->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), 0,
+                                   (bluetoothManager->device())->wattsMetric().average(),
+                                   (bluetoothManager->device())->wattsMetric().max());
 
         if (trainProgram) {
             int8_t lower_requested_peloton_resistance = trainProgram->currentRow().lower_requested_peloton_resistance;
@@ -4170,9 +4454,9 @@ void homeform::update() {
                         ->pelotonToEllipticalResistance(lower_requested_peloton_resistance);
 
             if (lower_requested_peloton_resistance != -1) {
-                this->target_peloton_resistance->setSecondLine(
-                    QStringLiteral("MIN: ") + QString::number(lower_requested_peloton_resistance, 'f', 0) +
-                    QStringLiteral(" MAX: ") + QString::number(upper_requested_peloton_resistance, 'f', 0));
+                this->target_peloton_resistance->setSecondLineNumbers(QStringLiteral("MIN: %1 MAX: %2"), 0,
+                                                                      lower_requested_peloton_resistance,
+                                                                      upper_requested_peloton_resistance);
             } else {
                 this->target_peloton_resistance->setSecondLine(QLatin1String(""));
             }
@@ -4198,8 +4482,8 @@ void homeform::update() {
             int16_t lower_cadence = trainProgram->currentRow().lower_cadence;
             int16_t upper_cadence = trainProgram->currentRow().upper_cadence;
             if (lower_cadence != -1) {
-                this->target_cadence->setSecondLine(QStringLiteral("MIN: ") + QString::number(lower_cadence, 'f', 0) +
-                                                    QStringLiteral(" MAX: ") + QString::number(upper_cadence, 'f', 0));
+                this->target_cadence->setSecondLineNumbers(QStringLiteral("MIN: %1 MAX: %2"), 0, lower_cadence,
+                                                           upper_cadence);
             } else {
                 this->target_cadence->setSecondLine(QLatin1String(""));
             }
@@ -4311,7 +4595,7 @@ void homeform::update() {
             watt->setValueFontColor(QStringLiteral("red"));
         }
         bluetoothManager->device()->setPowerZone(ftpZone);
-        ftp->setValue(QStringLiteral("Z") + QString::number(ftpZone, 'f', 1));
+        ftp->setValueNumbers(QStringLiteral("Z%1"), 1, ftpZone);
         ftp->setSecondLine(ftpMinW + QStringLiteral("-") + ftpMaxW + QStringLiteral("W ") +
                            QString::number(ftpPerc, 'f', 0) + QStringLiteral("%"));
 
@@ -4387,7 +4671,7 @@ void homeform::update() {
                 target_zone->setValueFontColor(QStringLiteral("red"));
             }
             bluetoothManager->device()->setTargetPowerZone(requestedZone);
-            target_zone->setValue(QStringLiteral("Z") + QString::number(requestedZone, 'f', 1));
+            target_zone->setValueNumbers(QStringLiteral("Z%1"), 1, requestedZone);
             target_zone->setSecondLine(requestedMinW + QStringLiteral("-") + requestedMaxW + QStringLiteral("W ") +
                                        QString::number(requestedPerc, 'f', 0) + QStringLiteral("%"));
         }
@@ -4484,8 +4768,10 @@ void homeform::update() {
                  maxHeartRate) /
                 100;
         }
-        pidHR->setValue(QString::number(treadmill_pid_heart_zone));
-        pidHR->setSecondLine(QString::number(hrCurrentZoneRangeMin) + "-" + QString::number(hrCurrentZoneRangeMax));
+        pidHR->setValueNumber(treadmill_pid_heart_zone, 0);
+        if (pidHR->due())
+            pidHR->setSecondLine(QString::number(hrCurrentZoneRangeMin) + "-" +
+                                 QString::number(hrCurrentZoneRangeMax));
         switch (treadmill_pid_heart_zone) {
         case 5:
             pidHR->setValueFontColor(QStringLiteral("red"));
@@ -4645,7 +4931,7 @@ void homeform::update() {
                                                                  QZSettings::default_trainprogram_resistance_max)
                                                           .toUInt());
                             }
-                            ((bike *)bluetoothManager->device())->changeResistance(resistance);
+                            bluetoothManager->device()->requestControl(devicecommand::resistance(resistance));
 
                             done = true;
                         } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
@@ -4670,7 +4956,7 @@ void homeform::update() {
                                                                  QZSettings::default_trainprogram_resistance_max)
                                                           .toUInt());
                             }
-                            ((rower *)bluetoothManager->device())->changeResistance(resistance);
+                            bluetoothManager->device()->requestControl(devicecommand::resistance(resistance));
 
                             done = true;
                         }
@@ -4692,10 +4978,10 @@ void homeform::update() {
                         ((treadmill *)bluetoothManager->device())->changeSpeedAndInclination(0, 0);
                     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::BIKE) {
 
-                        ((bike *)bluetoothManager->device())->changeResistance(1);
+                        bluetoothManager->device()->requestControl(devicecommand::resistance(1));
                     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
 
-                        ((rower *)bluetoothManager->device())->changeResistance(1);
+                        bluetoothManager->device()->requestControl(devicecommand::resistance(1));
                     }
                 }
             }
@@ -4780,10 +5066,12 @@ void homeform::update() {
                             ((bike *)bluetoothManager->device())->currentResistance().value();
                         if (zone < ((uint8_t)currentHRZone)) {
 
-                            ((bike *)bluetoothManager->device())->changeResistance(currentResistance - step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance - step));
                         } else if (zone > ((uint8_t)currentHRZone) && maxResistance >= currentResistance + step) {
 
-                            ((bike *)bluetoothManager->device())->changeResistance(currentResistance + step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance + step));
                         }
                     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
 
@@ -4792,10 +5080,12 @@ void homeform::update() {
                             ((rower *)bluetoothManager->device())->currentResistance().value();
                         if (zone < ((uint8_t)currentHRZone)) {
 
-                            ((rower *)bluetoothManager->device())->changeResistance(currentResistance - step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance - step));
                         } else if (zone > ((uint8_t)currentHRZone)) {
 
-                            ((rower *)bluetoothManager->device())->changeResistance(currentResistance + step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance + step));
                         }
                     }
                 }
@@ -4887,11 +5177,13 @@ void homeform::update() {
                             ((bike *)bluetoothManager->device())->currentResistance().value();
                         if (hrmax < bluetoothManager->device()->currentHeart().average5s()) {
 
-                            ((bike *)bluetoothManager->device())->changeResistance(currentResistance - step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance - step));
                         } else if (hrmin > bluetoothManager->device()->currentHeart().average5s() &&
                                    maxResistance >= currentResistance + step) {
 
-                            ((bike *)bluetoothManager->device())->changeResistance(currentResistance + step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance + step));
                         }
                     } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ROWING) {
 
@@ -4900,10 +5192,12 @@ void homeform::update() {
                             ((rower *)bluetoothManager->device())->currentResistance().value();
                         if (hrmax < bluetoothManager->device()->currentHeart().average5s()) {
 
-                            ((rower *)bluetoothManager->device())->changeResistance(currentResistance - step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance - step));
                         } else if (hrmin > bluetoothManager->device()->currentHeart().average5s()) {
 
-                            ((rower *)bluetoothManager->device())->changeResistance(currentResistance + step);
+                            bluetoothManager->device()->requestControl(
+                                devicecommand::resistance(currentResistance + step));
                         }
                     }
                 }
@@ -5343,10 +5637,6 @@ void homeform::trainprogram_open_clicked(const QUrl &fileName) {
 
     if (!file.fileName().isEmpty()) {
         {
-            if (previewTrainProgram) {
-                delete previewTrainProgram;
-                previewTrainProgram = 0;
-            }
             if (trainProgram) {
                 delete trainProgram;
             }
@@ -5392,11 +5682,12 @@ void homeform::trainprogram_preview(const QUrl &fileName) {
     qDebug() << fileNameLocal;
     if (!fileNameLocal.isEmpty()) {
         {
-            if (previewTrainProgram) {
-                delete previewTrainProgram;
-                previewTrainProgram = 0;
-            }
-            previewTrainProgram = trainprogram::load(file.fileName(), bluetoothManager, fileNameLocal.right(3).toUpper());
+            // from the index: the file is parsed only if it's new, changed or out of the training folder
+            QSettings settings;
+            trainingLibrary->setFtp(settings.value(QZSettings::ftp, QZSettings::default_ftp).toDouble());
+            previewSummary = trainingLibrary->summary(file.fileName(), fileNameLocal.right(3));
+            if (!trainingLibrary->find(previewSummary.fileName, nullptr))
+                refreshTrainingLibrary();
             emit previewWorkoutPointsChanged(preview_workout_points());
             emit previewWorkoutDescriptionChanged(previewWorkoutDescription());
             emit previewWorkoutTagsChanged(previewWorkoutTags());
@@ -5404,6 +5695,54 @@ void homeform::trainprogram_preview(const QUrl &fileName) {
     }
 }
 
+void homeform::refreshTrainingLibrary() {
+    QSettings settings;
+    trainingLibrary->setFtp(settings.value(QZSettings::ftp, QZSettings::default_ftp).toDouble());
+    trainingLibrary->refreshInBackground();
+}
+
+void homeform::refreshWorkoutHistory() {
+    QSettings settings;
+    const QVector<double> percentages =
+        QVector<double>()
+        << settings.value(QZSettings::heart_rate_zone1, QZSettings::default_heart_rate_zone1).toDouble()
+        << settings.value(QZSettings::heart_rate_zone2, QZSettings::default_heart_rate_zone2).toDouble()
+        << settings.value(QZSettings::heart_rate_zone3, QZSettings::default_heart_rate_zone3).toDouble()
+        << settings.value(QZSettings::heart_rate_zone4, QZSettings::default_heart_rate_zone4).toDouble();
+    workoutHistory->setHeartRateZones(workouthistory::heartRateZones(heartRateMax(), percentages));
+    workoutHistory->refreshInBackground();
+}
+
+void homeform::workoutHistoryRefreshed(int decoded) {
+    qDebug() << QStringLiteral("workout history refreshed") << decoded << QStringLiteral("files decoded")
+             << workoutHistory->workouts().count() << QStringLiteral("workouts");
+}
+
+void homeform::trainingLibraryRefreshed(int parsed) {
+    qDebug() << QStringLiteral("training library refreshed") << parsed << QStringLiteral("files parsed");
+    emit workoutLibraryChanged(++workoutLibraryVersion);
+}
+
+QString homeform::trainprogram_summary(const QUrl &fileName) {
+    if (!trainingLibrary)
+        return QString();
+    const QString path = QQmlFile::urlToLocalFileOrQrc(fileName);
+    const QString relative = QDir(trainingLibrary->directory()).relativeFilePath(path);
+    trainprogramsummary s;
+    if (!trainingLibrary->find(relative, &s) || !s.rows)
+        return QString();
+    QString text;
+    if (s.seconds > 0)
+        text = QTime(0, 0, 0).addSecs(s.seconds).toString(s.seconds >= 3600 ? QStringLiteral("h:mm:ss")
+                                                                             : QStringLiteral("m:ss"));
+    if (s.distance > 0 && (s.byDistance || s.seconds == 0))
+        text += (text.isEmpty() ? QString() : QStringLiteral(" ")) + QString::number(s.distance, 'f', 1) +
+                QStringLiteral(" km");
+    if (s.tss > 0)
+        text += QStringLiteral(" TSS ") + QString::number(qRound(s.tss));
+    return text;
+}
+
 void homeform::trainprogram_zwo_loaded(const QString &s) {
     qDebug() << QStringLiteral("trainprogram_zwo_loaded") << s;
     trainProgram = new trainprogram(zwiftworkout::loadJSON(s), bluetoothManager);
@@ -5457,6 +5796,10 @@ void homeform::fit_save_clicked() {
                    qobject_cast<m3ibike *>(dev) ? QFIT_PROCESS_DISTANCENOISE : QFIT_PROCESS_NONE,
                    stravaPelotonWorkoutType, workoutName, dev->bluetoothDevice.name());
         lastFitFileSaved = filename;
+        if (backupJournal.isOpen()) {
+            backupJournal.finalize(Session);
+        }
+        refreshWorkoutHistory();
 
         QSettings settings;
         if (!settings.value(QZSettings::strava_accesstoken, QZSettings::default_strava_accesstoken)
@@ -5497,9 +5840,7 @@ void homeform::gpx_open_clicked(const QUrl &fileName) {
             for (const auto &p : g_list) {
                 trainrow r;
                 if (p.speed > 0 && i > 0) {
-                    QGeoCoordinate p1(last.latitude, last.longitude);
-                    QGeoCoordinate p2(p.latitude, p.longitude, p.elevation);
-                    r.azimuth = p1.azimuthTo(p2);
+                    r.azimuth = p.azimuth;
                     r.speed = p.speed;
                     r.distance = p.distance;
                     r.duration = QTime(0, 0, 0, 0);
@@ -5516,9 +5857,7 @@ void homeform::gpx_open_clicked(const QUrl &fileName) {
 
                 } else {
                     if (i > 0) {
-                        QGeoCoordinate p1(last.latitude, last.longitude);
-                        QGeoCoordinate p2(p.latitude, p.longitude, p.elevation);
-                        r.azimuth = p1.azimuthTo(p2);
+                        r.azimuth = p.azimuth;
                         r.distance = p.distance;
                         r.altitude = last.elevation;
                         r.inclination = p.inclination;
@@ -5538,8 +5877,8 @@ void homeform::gpx_open_clicked(const QUrl &fileName) {
                 movieFileName = QUrl(g.getVideoURL());
                 emit videoPathChanged(movieFileName);
                 setVideoIconVisible(true);
-            } else if (QFile::exists(file.fileName().replace(".gpx", ".mp4"))) {
-                movieFileName = QUrl::fromLocalFile(file.fileName().replace(".gpx", ".mp4"));
+            } else if (QFile::exists(file.fileName().replace(".gpx", ".mp4").replace(".tcx", ".mp4"))) {
+                movieFileName = QUrl::fromLocalFile(file.fileName().replace(".gpx", ".mp4").replace(".tcx", ".mp4"));
                 emit videoPathChanged(movieFileName);
                 setVideoIconVisible(true);
             }
@@ -6136,7 +6475,7 @@ void homeform::sendMail() {
     message.addRecipient(new EmailAddress(settings.value(QZSettings::user_email, QLatin1String("")).toString(),
                                           settings.value(QZSettings::user_email, QLatin1String("")).toString()));
     if (!Session.isEmpty()) {
-        QString title = Session.constFirst().time.toString();
+        QString title = Session.time(0).toString();
         if (!stravaPelotonActivityName.isEmpty()) {
             title +=
                 QStringLiteral(" ") + stravaPelotonActivityName + QStringLiteral(" - ") + stravaPelotonInstructorName;
@@ -6494,6 +6833,7 @@ void homeform::loadSettings(const QUrl &filename) {
             }
         }
     }
+    QZSettingsSnapshot::instance()->reload();
 }
 
 void homeform::deleteSettings(const QUrl &filename) { QFile(filename.toLocalFile()).remove(); }
@@ -6558,13 +6898,7 @@ void homeform::clearFiles() {
     }
 }
 
-int homeform::preview_workout_points() {
-    if (previewTrainProgram) {
-        QTime d = previewTrainProgram->duration();
-        return (d.hour() * 3600) + (d.minute() * 60) + d.second();
-    }
-    return 0;
-}
+int homeform::preview_workout_points() { return previewSummary.seconds; }
 
 #if defined(Q_OS_WIN) || (defined(Q_OS_MAC) && !defined(Q_OS_IOS)) || (defined(Q_OS_ANDROID) && defined(LICENSE))
 void homeform::licenseReply(QNetworkReply *reply) {
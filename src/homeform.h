@@ -10,9 +10,12 @@
 #include "qmdnsengine/cache.h"
 #include "qmdnsengine/resolver.h"
 #include "screencapture.h"
-#include "sessionline.h"
+#include "qfitjournal.h"
+#include "sessionstore.h"
 #include "smtpclient/src/SmtpMime"
 #include "trainprogram.h"
+#include "workouthistory.h"
+#include "workoutlibrary.h"
 #include <QChart>
 #include <QColor>
 #include <QGraphicsScene>
@@ -23,6 +26,7 @@
 #include <QQuickItem>
 #include <QQuickItemGrabResult>
 #include <QTextToSpeech>
+#include <QVarLengthArray>
 
 #if __has_include("secret.h")
 #include "secret.h"
@@ -70,6 +74,40 @@ class DataObject : public QObject {
     void setLabelFontSize(int value);
     void setVisible(bool visible);
     void setGridId(int id);
+
+    /**
+     * @brief Whether the tile is in the current layout. A tile out of the layout is not refreshed; when it is added
+     * again it is refreshed on the next tick.
+     */
+    void setShown(bool shown);
+    bool shown() const { return m_shown; }
+    /**
+     * @brief Refresh the tile every ticks updates instead of every update.
+     */
+    void setRefreshInterval(int ticks) { m_refreshInterval = qMax(1, ticks); }
+    /**
+     * @brief Called once per update for the tiles of the layout: whether the tile is refreshed in this update.
+     */
+    void beginRefresh(quint32 tick);
+    bool due() const { return m_due; }
+    /**
+     * @brief The value as QString::number(value, 'f', decimals), formatted only when it changed at that precision
+     * and only when the tile is refreshed.
+     */
+    void setValueNumber(double value, int decimals);
+    /**
+     * @brief The value or the second line as format with %1, %2... replaced by the numbers with decimals digits,
+     * formatted only when a number changed at that precision and only when the tile is refreshed.
+     */
+    template <typename... Numbers> void setValueNumbers(const QString &format, int decimals, Numbers... numbers) {
+        const double n[] = {double(numbers)...};
+        setNumbers(Value, format, decimals, n, int(sizeof...(numbers)));
+    }
+    template <typename... Numbers> void setSecondLineNumbers(const QString &format, int decimals, Numbers... numbers) {
+        const double n[] = {double(numbers)...};
+        setNumbers(SecondLine, format, decimals, n, int(sizeof...(numbers)));
+    }
+
     QString name() { return m_name; }
     QString icon() { return m_icon; }
     QString value() { return m_value; }
@@ -102,6 +140,22 @@ class DataObject : public QObject {
     QString m_largeButtonLabel = QLatin1String("");
     QString m_largeButtonColor = QZSettings::default_tile_preset_resistance_1_color;
 
+  private:
+    enum Line { Value, SecondLine };
+    // the numbers last shown, rounded to the digits shown
+    struct Shown {
+        QString format;
+        int decimals = -1;
+        QVarLengthArray<qint64, 2> keys;
+    };
+    void setNumbers(Line line, const QString &format, int decimals, const double *numbers, int count);
+    Shown m_shownNumbers[2];
+    bool m_shown = false;
+    bool m_due = false;
+    bool m_dirty = true;
+    int m_refreshInterval = 1;
+    quint32 m_lastRefresh = 0;
+
   signals:
     void valueChanged(QString value);
     void secondLineChanged(QString value);
@@ -178,6 +232,7 @@ class homeform : public QObject {
     Q_PROPERTY(QList<double> preview_workout_watt READ preview_workout_watt)
     Q_PROPERTY(QString previewWorkoutDescription READ previewWorkoutDescription NOTIFY previewWorkoutDescriptionChanged)
     Q_PROPERTY(QString previewWorkoutTags READ previewWorkoutTags NOTIFY previewWorkoutTagsChanged)
+    Q_PROPERTY(int workout_library_version READ workout_library_version NOTIFY workoutLibraryChanged)
 
     Q_PROPERTY(bool currentCoordinateValid READ currentCoordinateValid)
     Q_PROPERTY(bool trainProgramLoadedWithVideo READ trainProgramLoadedWithVideo)
@@ -365,7 +420,7 @@ class homeform : public QObject {
     QString stopColor();
     QString workoutStartDate() {
         if (!Session.isEmpty()) {
-            return Session.constFirst().time.toString();
+            return Session.time(0).toString();
         } else {
             return QLatin1String("");
         }
@@ -450,6 +505,7 @@ class homeform : public QObject {
     void setToastRequested(QString value) { m_toastRequested = value; }
     void setGeneralPopupVisible(bool value);
     int workout_sample_points() { return Session.count(); }
+    const PowerCurve &powerCurve() const { return Session.powerCurve(); }
     int preview_workout_points();
 
 #if defined(Q_OS_ANDROID)
@@ -479,71 +535,53 @@ class homeform : public QObject {
     QList<double> workout_watt_points() {
         QList<double> l;
         l.reserve(Session.size() + 1);
-        for (const SessionLine &s : qAsConst(Session)) {
-            l.append(s.watt);
-        }
+        Session.watt().forEach([&l](double v) { l.append(v); });
         return l;
     }
     QList<double> workout_heart_points() {
         QList<double> l;
         l.reserve(Session.size() + 1);
-        for (const SessionLine &s : qAsConst(Session)) {
-            l.append(s.heart);
-        }
+        Session.heart().forEach([&l](double v) { l.append(v); });
         return l;
     }
     QList<double> workout_cadence_points() {
         QList<double> l;
         l.reserve(Session.size() + 1);
-        for (const SessionLine &s : qAsConst(Session)) {
-            l.append(s.cadence);
-        }
+        Session.cadence().forEach([&l](double v) { l.append(v); });
         return l;
     }
     QList<double> workout_resistance_points() {
         QList<double> l;
         l.reserve(Session.size() + 1);
-        for (const SessionLine &s : qAsConst(Session)) {
-            l.append(s.resistance);
-        }
+        Session.resistance().forEach([&l](double v) { l.append(v); });
         return l;
     }
     QList<double> workout_peloton_resistance_points() {
         QList<double> l;
         l.reserve(Session.size() + 1);
-        for (const SessionLine &s : qAsConst(Session)) {
-            l.append(s.peloton_resistance);
-        }
+        Session.peloton_resistance().forEach([&l](double v) { l.append(v); });
         return l;
     }
 
+    // the power profile of the previewed workout: trainprogramsummary::PROFILE_POINTS points over
+    // preview_workout_points seconds
     QList<double> preview_workout_watt() {
         QList<double> l;
-        if (!previewTrainProgram)
-            return l;
-        QTime d = previewTrainProgram->duration();
-        l.reserve((d.hour() * 3600) + (d.minute() * 60) + d.second() + 1);
-        foreach (trainrow r, previewTrainProgram->loadedRows) {
-            for (int i = 0; i < (r.duration.hour() * 3600) + (r.duration.minute() * 60) + r.duration.second(); i++) {
-                l.append(r.power);
-            }
-        }
+        l.reserve(previewSummary.power.count());
+        for (float watt : qAsConst(previewSummary.power))
+            l.append(watt);
         return l;
     }
 
-    QString previewWorkoutDescription() {
-        if (previewTrainProgram) {
-            return previewTrainProgram->description;
-        }
-        return "";
-    }
+    QString previewWorkoutDescription() { return previewSummary.description; }
 
-    QString previewWorkoutTags() {
-        if (previewTrainProgram) {
-            return previewTrainProgram->tags;
-        }
-        return "";
-    }
+    QString previewWorkoutTags() { return previewSummary.tags; }
+
+    int workout_library_version() { return workoutLibraryVersion; }
+    /**
+     * @brief The duration and the training stress of a workout of the library, empty if it isn't indexed yet.
+     */
+    Q_INVOKABLE QString trainprogram_summary(const QUrl &fileName);
 
     bool currentCoordinateValid() {
         if (bluetoothManager && bluetoothManager->device()) {
@@ -570,6 +608,10 @@ class homeform : public QObject {
     DataObject *watt;
     DataObject *avgWatt;
     DataObject *avgWattLap;
+    DataObject *peakPower5s;
+    DataObject *peakPower1m;
+    DataObject *peakPower5m;
+    DataObject *peakPower20m;
     DataObject *heart;
     DataObject *fan;
     DataObject *jouls;
@@ -625,11 +667,22 @@ class homeform : public QObject {
     TemplateInfoSenderBuilder *userTemplateManager = nullptr;
     TemplateInfoSenderBuilder *innerTemplateManager = nullptr;
     QList<QObject *> dataList;
-    QList<SessionLine> Session;
+    // the updates since the start, for the refresh interval of the tiles
+    quint32 tileTick = 0;
+    QString lastSignal;
+    SessionStore Session;
+    qfitjournal backupJournal;
     bluetooth *bluetoothManager;
     QQmlApplicationEngine *engine;
     trainprogram *trainProgram = nullptr;
-    trainprogram *previewTrainProgram = nullptr;
+    trainprogramsummary previewSummary;
+    // the summaries of the training folder, for the picker
+    workoutlibrary *trainingLibrary = nullptr;
+    int workoutLibraryVersion = 0;
+    void refreshTrainingLibrary();
+    // the summaries of the saved workouts
+    workouthistory *workoutHistory = nullptr;
+    void refreshWorkoutHistory();
     QString backupFitFileName =
         QStringLiteral("QZ-backup-") +
         QDateTime::currentDateTime().toString().replace(QStringLiteral(":"), QStringLiteral("_")) +
@@ -770,6 +823,8 @@ class homeform : public QObject {
     void profile_open_clicked(const QUrl &fileName);
     void trainprogram_preview(const QUrl &fileName);
     void gpxpreview_open_clicked(const QUrl &fileName);
+    void trainingLibraryRefreshed(int parsed);
+    void workoutHistoryRefreshed(int decoded);
     void trainprogram_zwo_loaded(const QString &comp);
     void gpx_open_clicked(const QUrl &fileName);
     void gpx_save_clicked();
@@ -856,6 +911,7 @@ class homeform : public QObject {
     void previewWorkoutPointsChanged(int value);
     void previewWorkoutDescriptionChanged(QString value);
     void previewWorkoutTagsChanged(QString value);
+    void workoutLibraryChanged(int version);
     void stravaAuthUrlChanged(QString value);
     void stravaWebVisibleChanged(bool value);
 
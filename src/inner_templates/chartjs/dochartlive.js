@@ -460,15 +460,7 @@ function dochart_init() {
             console.error('Error is ' + err);
     })
 
-    el = new MainWSQueueElement({
-        msg: 'getsessionarray'
-    }, function(msg) {
-        if (msg.msg === 'R_getsessionarray') {
-            return msg.content;
-        }
-        return null;
-    }, 15000, 3);
-    el.enqueue().then(process_arr).catch(function(err) {
+    main_ws_get_session_array().then(process_arr).catch(function(err) {
         console.error('Error is ' + err);
     });
 
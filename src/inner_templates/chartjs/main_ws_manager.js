@@ -130,3 +130,26 @@ function main_ws_connect() {
     };
 }
 main_ws_connect();
+
+// the rows of the session, requested a page at a time: a long workout doesn't block the socket with one huge message
+function main_ws_get_session_array(page_size) {
+    let rows = [];
+    function get_page(cursor) {
+        let el = new MainWSQueueElement({
+            msg: 'getsessionarray',
+            content: { cursor: cursor, limit: page_size || 600 }
+        }, function(msg) {
+            if (msg.msg === 'R_getsessionarray') {
+                return msg;
+            }
+            return null;
+        }, 15000, 3);
+        return el.enqueue().then(function(msg) {
+            rows = rows.concat(msg.content);
+            if (msg.more && msg.cursor > cursor)
+                return get_page(msg.cursor);
+            return rows;
+        });
+    }
+    return get_page(0);
+}
@@ -29,8 +29,6 @@ static AdbClient *_adb = 0;
 
 static ios_eliteariafan* ios_eliteAriaFan = nil;
 
-static zwift_protobuf_layer* zwiftProtobufLayer = nil;
-
 void lockscreen::setTimerDisabled() {
      [[UIApplication sharedApplication] setIdleTimerDisabled: YES];
 }
@@ -39,7 +37,6 @@ void lockscreen::request()
 {
     h = [[healthkit alloc] init];
     [h request];
-    zwiftProtobufLayer = [[zwift_protobuf_layer alloc] init];
     if (@available(iOS 13, *)) {
         Garmin = [[GarminConnect alloc] init];
     }
@@ -301,25 +298,4 @@ void lockscreen::eliteAriaFan_fanSpeedRequest(unsigned char speed) {
         [ios_eliteAriaFan fanSpeedRequest:speed];
     }
 }
-
-void lockscreen::zwift_api_decodemessage_player(const char* data, int len) {
-    NSData *d = [NSData dataWithBytes:data length:len];
-    [zwiftProtobufLayer getPlayerStateWithValue:d];
-}
-
-float lockscreen::zwift_api_getaltitude() {
-    return [zwiftProtobufLayer getAltitude];
-}
-
-int lockscreen::zwift_api_getdistance() {
-    return [zwiftProtobufLayer getDistance];
-}
-
-float lockscreen::zwift_api_getlatitude() {
-    return [zwiftProtobufLayer getLatitude];
-}
-
-float lockscreen::zwift_api_getlongitude() {
-    return [zwiftProtobufLayer getLongitude];
-}
 #endif
@@ -0,0 +1,71 @@
+#include "latencyhistogram.h"
+
+int latencyhistogram::bucket(qint64 us) {
+    if (us < 4)
+        return us < 0 ? 0 : (int)us;
+    int e = 63;
+    while (!(us >> e))
+        e--;
+    // the two bits after the most significant one
+    const int b = 4 * (e - 1) + (int)((us >> (e - 2)) & 3);
+    return qMin(b, BUCKETS - 1);
+}
+
+qint64 latencyhistogram::lowerBound(int bucket) {
+    if (bucket < 4)
+        return bucket;
+    const int e = bucket / 4 + 1;
+    return (qint64)(4 + bucket % 4) << (e - 2);
+}
+
+void latencyhistogram::record(qint64 us) {
+    us = qMax<qint64>(us, 0);
+    buckets[bucket(us)].fetch_add(1, std::memory_order_relaxed);
+    total.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(us, std::memory_order_relaxed);
+    qint64 m = maximum.load(std::memory_order_relaxed);
+    while (us > m && !maximum.compare_exchange_weak(m, us, std::memory_order_relaxed))
+        ;
+}
+
+void latencyhistogram::reset() {
+    for (auto &b : buckets)
+        b.store(0, std::memory_order_relaxed);
+    total.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    maximum.store(0, std::memory_order_relaxed);
+}
+
+double latencyhistogram::mean() const {
+    const quint64 n = count();
+    return n ? (double)sum.load(std::memory_order_relaxed) / n : 0;
+}
+
+qint64 latencyhistogram::percentile(double p) const {
+    quint64 n = 0;
+    quint64 counts[BUCKETS];
+    for (int i = 0; i < BUCKETS; i++) {
+        counts[i] = bucketCount(i);
+        n += counts[i];
+    }
+    if (!n)
+        return 0;
+    // the rank of the sample, 1 based
+    const quint64 rank = qMax<quint64>(1, (quint64)(p / 100.0 * n + 0.5));
+    quint64 seen = 0;
+    for (int i = 0; i < BUCKETS; i++) {
+        seen += counts[i];
+        if (seen >= rank)
+            return qMin(i + 1 < BUCKETS ? lowerBound(i + 1) - 1 : max(), max());
+    }
+    return max();
+}
+
+QString latencyhistogram::toString() const {
+    return QStringLiteral("n=%1 p50=%2ms p90=%3ms p99=%4ms max=%5ms")
+        .arg(count())
+        .arg(percentile(50) / 1000.0, 0, 'f', 1)
+        .arg(percentile(90) / 1000.0, 0, 'f', 1)
+        .arg(percentile(99) / 1000.0, 0, 'f', 1)
+        .arg(max() / 1000.0, 0, 'f', 1);
+}
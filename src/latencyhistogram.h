@@ -0,0 +1,49 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <QtGlobal>
+#include <atomic>
+
+/**
+ * @brief Histogram of latencies in microseconds, with 4 buckets for each power of two: a percentile is known within
+ * 25%, whatever the range. record() is lock free and may be called by a device thread while another thread reads.
+ */
+class latencyhistogram {
+  public:
+    static constexpr int BUCKETS = 128;
+
+    latencyhistogram() { reset(); }
+
+    void record(qint64 us);
+    void reset();
+
+    quint64 count() const { return total.load(std::memory_order_relaxed); }
+    qint64 max() const { return maximum.load(std::memory_order_relaxed); }
+    double mean() const;
+
+    /**
+     * @brief The latency p percent of the samples don't exceed (the upper bound of its bucket), 0 without samples.
+     */
+    qint64 percentile(double p) const;
+
+    quint64 bucketCount(int bucket) const { return buckets[bucket].load(std::memory_order_relaxed); }
+    static int bucket(qint64 us);
+    /**
+     * @brief The smallest latency of a bucket; the largest is lowerBound(bucket + 1) - 1.
+     */
+    static qint64 lowerBound(int bucket);
+
+    /**
+     * @brief "n=... p50=...ms p90=...ms p99=...ms max=...ms", for the log.
+     */
+    QString toString() const;
+
+  private:
+    std::atomic<quint64> buckets[BUCKETS];
+    std::atomic<quint64> total;
+    std::atomic<quint64> sum;
+    std::atomic<qint64> maximum;
+};
+
+#endif // LATENCYHISTOGRAM_H
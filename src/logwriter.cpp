@@ -0,0 +1,284 @@
+#include "logwriter.h"
+
+#include <QDateTime>
+#include <QMutexLocker>
+#include <cstdio>
+
+LogWriter *LogWriter::instance() {
+    // leaked on purpose: messages can be logged by static destructors after main() returns
+    static LogWriter *writer = new LogWriter();
+    return writer;
+}
+
+LogWriter::LogWriter() : m_stopped(1) {}
+
+LogWriter::~LogWriter() { stop(); }
+
+bool LogWriter::open(const QString &filename, const Options &options) {
+    if (isRunning() || m_file.isOpen())
+        return false;
+    m_options = options;
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+        return false;
+    m_buffer.reserve(FLUSH_BYTES * 2);
+    m_capacity = (quint64)qMax(1, options.capacity);
+    m_cells.reset(new Cell[m_capacity]);
+    for (quint64 i = 0; i < m_capacity; i++)
+        m_cells[i].sequence.storeRelease(i);
+    m_enqueuePos.storeRelease(0);
+    m_dequeuePos = 0;
+    m_stopping.storeRelease(0);
+    m_stopped.storeRelease(0);
+    start(QThread::LowPriority);
+    return true;
+}
+
+bool LogWriter::enqueue(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    if (m_stopped.loadAcquire()) {
+        QMutexLocker locker(&m_syncMutex);
+        // never warn from here: the warning would come back to the message handler
+        if (!m_file.isOpen())
+            return false;
+        drain();
+        m_buffer.append(format(type, QDateTime::currentMSecsSinceEpoch(), context.file, context.function, msg));
+        flush();
+        return true;
+    }
+
+    const int pending = m_pending.fetchAndAddRelaxed(1) + 1;
+    if (pending > m_options.capacity) {
+        m_pending.fetchAndAddRelaxed(-1);
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+
+    // claim the next position; the pending count keeps it free of an entry not written yet
+    Cell *cell;
+    quint64 pos = m_enqueuePos.loadAcquire();
+    for (;;) {
+        cell = &m_cells[pos % m_capacity];
+        const qint64 diff = (qint64)(cell->sequence.loadAcquire() - pos);
+        if (diff == 0) {
+            if (m_enqueuePos.testAndSetRelaxed(pos, pos + 1, pos))
+                break;
+        } else if (diff < 0) {
+            // the writer hasn't released the slot yet
+            m_pending.fetchAndAddRelaxed(-1);
+            m_dropped.fetchAndAddRelaxed(1);
+            return false;
+        } else {
+            pos = m_enqueuePos.loadAcquire();
+        }
+    }
+
+    Entry &e = cell->entry;
+    e.type = type;
+    e.msecs = QDateTime::currentMSecsSinceEpoch();
+    // the context strings aren't guaranteed to outlive the call (e.g. QML console messages)
+    e.file = context.file;
+    e.function = context.function;
+    e.msg = msg;
+    cell->sequence.storeRelease(pos + 1);
+
+    // the writer wakes up by itself every FLUSH_INTERVAL_MS; only a burst that fills half of the queue wakes it
+    // earlier, so the common path has no system call at all
+    if (pending == m_options.capacity / 2)
+        m_wake.release();
+    return true;
+}
+
+void LogWriter::stop() {
+    if (isRunning()) {
+        m_stopping.storeRelease(1);
+        m_wake.release();
+        wait();
+    }
+    QMutexLocker locker(&m_syncMutex);
+    m_stopped.storeRelease(1);
+    if (m_file.isOpen()) {
+        drain();
+        flush();
+    }
+}
+
+void LogWriter::drain() {
+    int count = 0;
+    // up to the first slot claimed but not written yet: the next round gets it
+    while (!m_cells.isNull()) {
+        Cell &cell = m_cells[m_dequeuePos % m_capacity];
+        if (cell.sequence.loadAcquire() != m_dequeuePos + 1)
+            break;
+        Entry &e = cell.entry;
+        m_buffer.append(format(e.type, e.msecs, e.file.constData(), e.function.constData(), e.msg));
+        e.msg.clear();
+        cell.sequence.storeRelease(m_dequeuePos + m_capacity);
+        m_dequeuePos++;
+        count++;
+        if (m_buffer.size() >= FLUSH_BYTES)
+            flush();
+    }
+    m_pending.fetchAndAddRelaxed(-count);
+    m_written.fetchAndAddRelaxed(count);
+
+    const quint64 dropped = m_dropped.loadAcquire();
+    if (dropped != m_droppedReported) {
+        m_buffer.append(format(QtWarningMsg, QDateTime::currentMSecsSinceEpoch(), "", "LogWriter",
+                               QStringLiteral("%1 log lines dropped, the log writer fell behind")
+                                   .arg(dropped - m_droppedReported)));
+        m_droppedReported = dropped;
+    }
+}
+
+void LogWriter::flush() {
+    if (m_buffer.isEmpty())
+        return;
+    if (m_options.maxFileSize > 0 && m_file.size() + m_buffer.size() > m_options.maxFileSize && m_file.size() > 0)
+        rotate();
+    write(m_buffer);
+    m_buffer.clear();
+    m_sinceFlush.restart();
+}
+
+void LogWriter::write(const QByteArray &data) {
+    if (m_options.echoToStderr) {
+        fwrite(data.constData(), 1, data.size(), stderr);
+    }
+    m_file.write(data);
+    m_file.flush();
+}
+
+void LogWriter::rotate() {
+    const QString filename = m_file.fileName();
+    m_file.close();
+
+    const QString gz = QStringLiteral(".gz");
+    const int last = qMax(0, m_options.maxRotatedFiles);
+    if (last > 0) {
+        QFile::remove(rotatedFileName(filename, last));
+        QFile::remove(rotatedFileName(filename, last) + gz);
+        for (int n = last - 1; n >= 1; n--) {
+            QFile::rename(rotatedFileName(filename, n), rotatedFileName(filename, n + 1));
+            QFile::rename(rotatedFileName(filename, n) + gz, rotatedFileName(filename, n + 1) + gz);
+        }
+        const QString first = rotatedFileName(filename, 1);
+        if (m_options.compressRotated) {
+            if (gzipFile(filename, first + gz)) {
+                QFile::remove(filename);
+            } else {
+                QFile::remove(first + gz);
+                QFile::rename(filename, first);
+            }
+        } else {
+            QFile::rename(filename, first);
+        }
+    }
+
+    m_file.setFileName(filename);
+    m_file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+}
+
+void LogWriter::run() {
+    m_sinceFlush.start();
+    while (!m_stopping.loadAcquire()) {
+        m_wake.tryAcquire(1, FLUSH_INTERVAL_MS);
+        // collapse the wake ups of the burst already handled by this round
+        m_wake.tryAcquire(m_wake.available());
+        drain();
+        if (m_buffer.size() >= FLUSH_BYTES || m_sinceFlush.elapsed() >= FLUSH_INTERVAL_MS)
+            flush();
+    }
+    drain();
+    flush();
+}
+
+QByteArray LogWriter::format(QtMsgType type, qint64 msecs, const char *file, const char *function,
+                             const QString &msg) {
+    if (!file)
+        file = "";
+    if (!function)
+        function = "";
+    QString txt = QDateTime::fromMSecsSinceEpoch(msecs).toString() + QStringLiteral(" ") + QString::number(msecs) +
+                  QStringLiteral(" ");
+    switch (type) {
+    case QtInfoMsg:
+        txt += QStringLiteral("Info: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+        break;
+    case QtDebugMsg:
+        txt += QStringLiteral("Debug: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+        break;
+    case QtWarningMsg:
+        txt += QStringLiteral("Warning: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+        break;
+    case QtCriticalMsg:
+        txt += QStringLiteral("Critical: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+        break;
+    case QtFatalMsg:
+        txt += QStringLiteral("Fatal: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+        break;
+    }
+    return txt.toLocal8Bit();
+}
+
+static quint32 crc32(const QByteArray &data) {
+    struct Table {
+        quint32 v[256];
+        Table() {
+            for (quint32 i = 0; i < 256; i++) {
+                quint32 c = i;
+                for (int k = 0; k < 8; k++)
+                    c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+                v[i] = c;
+            }
+        }
+    };
+    static const Table table;
+    quint32 crc = 0xFFFFFFFFu;
+    for (int i = 0; i < data.size(); i++)
+        crc = table.v[(crc ^ (quint8)data.at(i)) & 0xFF] ^ (crc >> 8);
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static void appendLE32(QByteArray &out, quint32 v) {
+    for (int i = 0; i < 4; i++)
+        out.append((char)((v >> (8 * i)) & 0xFF));
+}
+
+QByteArray LogWriter::gzip(const QByteArray &data) {
+    // qCompress: 4 bytes of length, then a zlib stream (2 bytes header, raw deflate, 4 bytes adler32)
+    const QByteArray zlib = qCompress(data, 6);
+    QByteArray out;
+    out.reserve(zlib.size() + 18);
+    static const char header[10] = {'\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, '\xff'};
+    out.append(header, sizeof(header));
+    out.append(zlib.constData() + 6, zlib.size() - 10);
+    appendLE32(out, crc32(data));
+    appendLE32(out, (quint32)data.size());
+    return out;
+}
+
+bool LogWriter::gzipFile(const QString &from, const QString &to, int chunkSize) {
+    QFile in(from);
+    QFile out(to);
+    if (!in.open(QIODevice::ReadOnly) || !out.open(QIODevice::WriteOnly))
+        return false;
+    QByteArray chunk(qMax(1, chunkSize), Qt::Uninitialized);
+    for (;;) {
+        const qint64 read = in.read(chunk.data(), chunk.size());
+        if (read < 0)
+            return false;
+        if (read == 0)
+            break;
+        const QByteArray member = gzip(read == chunk.size() ? chunk : chunk.left((int)read));
+        if (out.write(member) != member.size())
+            return false;
+    }
+    return out.flush();
+}
+
+QString LogWriter::rotatedFileName(const QString &filename, int n) {
+    const QString suffix = QStringLiteral(".log");
+    if (filename.endsWith(suffix))
+        return filename.left(filename.length() - suffix.length()) + QStringLiteral(".%1").arg(n) + suffix;
+    return filename + QStringLiteral(".%1").arg(n);
+}
@@ -0,0 +1,138 @@
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QAtomicInteger>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QMutex>
+#include <QScopedArrayPointer>
+#include <QSemaphore>
+#include <QString>
+#include <QThread>
+
+/**
+ * @brief Asynchronous sink for the debug log.
+ * The message handler only stamps the message and copies it in a slot of a ring allocated by open(): no formatting,
+ * no file access, no lock and no new entry on the calling thread. The writer thread takes the slots written since its
+ * last round, in order, formats the lines, and writes them through a file handle kept open for the whole run,
+ * flushing every FLUSH_INTERVAL_MS or FLUSH_BYTES.
+ * The queue is bounded: when the writer falls behind by more than the capacity the new messages are dropped and
+ * counted, and the number of dropped lines is written in the log as soon as the writer catches up.
+ * When the file grows over the maximum size it is rotated to <name>.1.log (optionally gzipped, GZIP_CHUNK at a time),
+ * <name>.1.log to <name>.2.log and so on.
+ */
+class LogWriter : public QThread {
+  public:
+    static constexpr int DEFAULT_CAPACITY = 50000;
+    static constexpr int FLUSH_INTERVAL_MS = 250;
+    static constexpr int FLUSH_BYTES = 64 * 1024;
+    static constexpr int GZIP_CHUNK = 1024 * 1024;
+
+    struct Options {
+        // 0 disables the rotation
+        qint64 maxFileSize = 0;
+        int maxRotatedFiles = 4;
+        bool compressRotated = false;
+        bool echoToStderr = false;
+        int capacity = DEFAULT_CAPACITY;
+    };
+
+    static LogWriter *instance();
+
+    LogWriter();
+    ~LogWriter() override;
+
+    /**
+     * @brief Opens (appending) the log file and starts the writer thread.
+     * @return false if the file can't be opened.
+     */
+    bool open(const QString &filename, const Options &options);
+
+    /**
+     * @brief Queues a message. Safe from any thread; never blocks and never touches the file, except before open() and
+     * after stop(), when the line is written synchronously.
+     * @return false if the message was dropped because the queue is full or the file isn't open.
+     */
+    bool enqueue(QtMsgType type, const QMessageLogContext &context, const QString &msg);
+
+    /**
+     * @brief Writes everything queued so far, flushes and stops the writer thread. The file stays open: the messages
+     * logged afterwards are written synchronously. Call it before the process exits or aborts.
+     */
+    void stop();
+
+    QString fileName() const { return m_file.fileName(); }
+    quint64 dropped() const { return m_dropped.loadAcquire(); }
+    quint64 written() const { return m_written.loadAcquire(); }
+
+    /**
+     * @brief A log line, in the format of the original message handler.
+     */
+    static QByteArray format(QtMsgType type, qint64 msecs, const char *file, const char *function, const QString &msg);
+
+    /**
+     * @brief Compresses data in the gzip file format.
+     */
+    static QByteArray gzip(const QByteArray &data);
+
+    /**
+     * @brief Compresses a file in the gzip file format, reading chunkSize bytes at a time: one gzip member per chunk,
+     * which gunzip reads back as a single file.
+     */
+    static bool gzipFile(const QString &from, const QString &to, int chunkSize = GZIP_CHUNK);
+
+    /**
+     * @brief Name of the n-th rotated file (1 = the most recent), without the .gz suffix.
+     */
+    static QString rotatedFileName(const QString &filename, int n);
+
+  protected:
+    void run() override;
+
+  private:
+    struct Entry {
+        QtMsgType type;
+        qint64 msecs;
+        // reassigned in place: their buffers are reused by the next messages of the slot
+        QByteArray file;
+        QByteArray function;
+        QString msg;
+    };
+
+    // a slot of the ring: its sequence is the position it can be written at, the position + 1 once written
+    struct Cell {
+        QAtomicInteger<quint64> sequence;
+        Entry entry;
+    };
+
+    void drain();
+    void write(const QByteArray &data);
+    void flush();
+    void rotate();
+
+    QFile m_file;
+    Options m_options;
+
+    // bounded lock-free ring of capacity slots: written by any thread, read in order by the writer
+    QScopedArrayPointer<Cell> m_cells;
+    quint64 m_capacity = 0;
+    QAtomicInteger<quint64> m_enqueuePos;
+    quint64 m_dequeuePos = 0;
+    QAtomicInt m_pending;
+    QAtomicInteger<quint64> m_dropped;
+    QAtomicInteger<quint64> m_written;
+    quint64 m_droppedReported = 0;
+    QAtomicInt m_stopping;
+    QSemaphore m_wake;
+
+    // writer side
+    QByteArray m_buffer;
+    QElapsedTimer m_sinceFlush;
+
+    // set by stop() once the thread is gone: from then on enqueue() writes synchronously under m_syncMutex
+    QAtomicInt m_stopped;
+    QMutex m_syncMutex;
+};
+
+#endif // LOGWRITER_H
@@ -12,8 +12,10 @@
 #include "bluetooth.h"
 #include "devices/domyostreadmill/domyostreadmill.h"
 #include "homeform.h"
+#include "logwriter.h"
 #include "mainwindow.h"
 #include "qfit.h"
+#include "qzsettingssnapshot.h"
 #include "virtualdevices/virtualtreadmill.h"
 #include <QDir>
 #include <QGuiApplication>
@@ -47,6 +49,7 @@ bool noConsole = false;
 bool onlyVirtualBike = false;
 bool onlyVirtualTreadmill = false;
 bool testPeloton = false;
+bool pelotonOffline = false;
 bool testHomeFitnessBudy = false;
 bool testPowerZonePack = false;
 QString peloton_username = "";
@@ -136,6 +139,11 @@ QCoreApplication *createApplication(int &argc, char *argv[]) {
             reebok_fr30_treadmill = true;
         if (!qstrcmp(argv[i], "-test-peloton"))
             testPeloton = true;
+        if (!qstrcmp(argv[i], "-peloton-offline")) {
+            // the last workout, from the cache
+            testPeloton = true;
+            pelotonOffline = true;
+        }
         if (!qstrcmp(argv[i], "-test-hfb"))
             testHomeFitnessBudy = true;
         if (!qstrcmp(argv[i], "-test-pzp"))
@@ -232,55 +240,30 @@ QCoreApplication *createApplication(int &argc, char *argv[]) {
     }
 }
 
-void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
-
-    QSettings settings;
-    static bool logdebug = settings.value(QZSettings::log_debug, QZSettings::default_log_debug).toBool();
+static bool logEnabled() {
+    static bool logdebug = QSettings().value(QZSettings::log_debug, QZSettings::default_log_debug).toBool();
 #if defined(Q_OS_LINUX) // Linux OS does not read settings file for now
-    if ((logs == false && !forceQml) || (logdebug == false && forceQml))
+    return !((logs == false && !forceQml) || (logdebug == false && forceQml));
 #else
-    if (logdebug == false)
+    return logdebug;
 #endif
+}
+
+// the file is written by the LogWriter thread: this only stamps and queues the message
+void myMessageOutput(QtMsgType type, const QMessageLogContext &context, const QString &msg) {
+    if (!logEnabled())
         return;
 
-    // QByteArray localMsg = msg.toLocal8Bit(); // NOTE: clazy-unused-non-trivial-variable
-    const char *file = context.file ? context.file : "";
-    const char *function = context.function ? context.function : "";
-    QString txt = QDateTime::currentDateTime().toString() + QStringLiteral(" ") +
-                  QString::number(QDateTime::currentMSecsSinceEpoch()) + QStringLiteral(" ");
-    switch (type) {
-    case QtInfoMsg:
-        txt += QStringLiteral("Info: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
-        break;
-    case QtDebugMsg:
-        txt += QStringLiteral("Debug: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
-        break;
-    case QtWarningMsg:
-        txt += QStringLiteral("Warning: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
-        break;
-    case QtCriticalMsg:
-        txt += QStringLiteral("Critical: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
-        break;
-    case QtFatalMsg:
-        txt += QStringLiteral("Fatal: %1 %2 %3\n").arg(file, function, msg); // NOTE: clazy-qstring-arg
+    LogWriter::instance()->enqueue(type, context, msg);
+    if (type == QtFatalMsg) {
+        LogWriter::instance()->stop();
         abort();
     }
-
-    if (logs == true || logdebug == true) {
-
-        QString path = homeform::getWritableAppDir();
-
-        // Linux log files are generated on binary location
-
-        QFile outFile(path + logfilename);
-        outFile.open(QIODevice::WriteOnly | QIODevice::Append);
-        QTextStream ts(&outFile);
-        ts << txt;
-        fprintf(stderr, "%s", txt.toLocal8Bit().constData());
-    }
     (*QT_DEFAULT_MESSAGE_HANDLER)(type, context, msg);
 }
 
+static void stopLogWriter() { LogWriter::instance()->stop(); }
+
 int main(int argc, char *argv[]) {
 #ifdef Q_OS_WIN32
     qputenv("QT_MULTIMEDIA_PREFERRED_PLUGINS", "windowsmediafoundation");
@@ -373,6 +356,23 @@ int main(int argc, char *argv[]) {
     }
 #endif
 
+    // build the hot path settings snapshot on the GUI thread, once the command line overrides are stored
+    QZSettingsSnapshot::instance();
+
+    if (logEnabled()) {
+        // Linux log files are generated on binary location
+        LogWriter::Options logOptions;
+        logOptions.maxFileSize =
+            (qint64)settings.value(QZSettings::log_max_file_size_mb, QZSettings::default_log_max_file_size_mb).toInt() *
+            1024 * 1024;
+        logOptions.maxRotatedFiles =
+            settings.value(QZSettings::log_rotated_files, QZSettings::default_log_rotated_files).toInt();
+        logOptions.compressRotated =
+            settings.value(QZSettings::log_compress_rotated, QZSettings::default_log_compress_rotated).toBool();
+        logOptions.echoToStderr = true;
+        LogWriter::instance()->open(homeform::getWritableAppDir() + logfilename, logOptions);
+        qAddPostRoutine(stopLogWriter);
+    }
     qInstallMessageHandler(myMessageOutput);
     qDebug() << QStringLiteral("version ") << app->applicationVersion();
     foreach (QString s, settings.allKeys()) {
@@ -390,7 +390,7 @@ int main(int argc, char *argv[]) {
 #endif
 
 #if 0 // test gpx or fit export
-    QList<SessionLine> l;
+    SessionStore l;
     for(int i =0; i< 500; i++)
     {
         QDateTime d = QDateTime::currentDateTime();
@@ -419,7 +419,8 @@ int main(int argc, char *argv[]) {
             settings.setValue(QZSettings::peloton_username, peloton_username);
             settings.setValue(QZSettings::peloton_password, peloton_password);
             peloton *p = new peloton(0, 0);
-            p->setTestMode(true);
+            p->setTestMode(!pelotonOffline);
+            p->setOfflineMode(pelotonOffline);
             QObject::connect(p, &peloton::loginState, [&](bool ok) {
                 if (ok) {
                 } else {
@@ -505,6 +505,7 @@ void MainWindow::on_difficulty_valueChanged(int value) {
         trainProgram->rows[i].inclination = trainProgram->loadedRows.at(i).inclination +
                                             (trainProgram->loadedRows.at(i).inclination * (0.02 * (value - 50)));
     }
+    trainProgram->rebuildTimeline();
 
     int countRow = 0;
     for (const auto &row : qAsConst(trainProgram->rows)) {
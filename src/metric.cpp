@@ -1,6 +1,7 @@
 #include "metric.h"
 #include "qdebugfixup.h"
 #include "qzsettings.h"
+#include "qzsettingssnapshot.h"
 #include <QSettings>
 
 #ifdef TEST
@@ -13,39 +14,37 @@ metric::metric() {}
 void metric::setType(_metric_type t) { m_type = t; }
 
 void metric::setValue(double v, bool applyGainAndOffset) {
-    QSettings settings;
     if (applyGainAndOffset) {
+        const QZSettingsValues &settings = QZSettingsSnapshot::get();
         if (m_type == METRIC_WATT) {
             if (v > 0) {
-                if (settings.value(QZSettings::watt_gain, QZSettings::default_watt_gain).toDouble() <= 2.00) {
-                    if (settings.value(QZSettings::watt_gain, QZSettings::default_watt_gain).toDouble() != 1.0) {
+                if (settings.watt_gain <= 2.00) {
+                    if (settings.watt_gain != 1.0) {
                         qDebug() << QStringLiteral("watt value was ") << v
-                                 << QStringLiteral("but it will be transformed to")
-                                 << v * settings.value(QZSettings::watt_gain, QZSettings::default_watt_gain).toDouble();
+                                 << QStringLiteral("but it will be transformed to") << v * settings.watt_gain;
                     }
-                    v *= settings.value(QZSettings::watt_gain, QZSettings::default_watt_gain).toDouble();
+                    v *= settings.watt_gain;
                 }
-                if (settings.value(QZSettings::watt_offset, QZSettings::default_watt_offset).toDouble() != 0.0) {
-                    qDebug()
-                        << QStringLiteral("watt value was ") << v << QStringLiteral("but it will be transformed to")
-                        << v + settings.value(QZSettings::watt_offset, QZSettings::default_watt_offset).toDouble();
-                    v += settings.value(QZSettings::watt_offset, QZSettings::default_watt_offset).toDouble();
+                if (settings.watt_offset != 0.0) {
+                    qDebug() << QStringLiteral("watt value was ") << v
+                             << QStringLiteral("but it will be transformed to") << v + settings.watt_offset;
+                    v += settings.watt_offset;
                 }
             }
         } else if (m_type == METRIC_SPEED) {
             if (v > 0) {
-                v *= settings.value(QZSettings::speed_gain, QZSettings::default_speed_gain).toDouble();
-                v += settings.value(QZSettings::speed_offset, QZSettings::default_speed_offset).toDouble();
+                v *= settings.speed_gain;
+                v += settings.speed_offset;
             }
         }
     }
 
-    QDateTime now = QDateTime::currentDateTime();
+    qint64 now = monotonicNs();
     if (v != m_value && v != INFINITY) {
-        m_valueChanged = now;
-        if (m_last5.count() > 1) {
+        m_valueChangedNs = now;
+        if (m_ringHead - m_ringTail > 1) {
             double diff = v - m_value;
-            double diffFromLastValue = qAbs(now.msecsTo(m_lastChanged));
+            double diffFromLastValue = (double)(now - m_lastChangedNs) / 1000000.0;
             if (diffFromLastValue > 0)
                 m_rateAtSec = diff * (1000.0 / diffFromLastValue);
             else
@@ -54,7 +53,7 @@ void metric::setValue(double v, bool applyGainAndOffset) {
     }
 
     // it has to be here, even if the value is the same, due to https://github.com/cagnulein/qdomyos-zwift/issues/1325
-    m_lastChanged = now;
+    m_lastChangedNs = now;
 
     m_value = v;
 
@@ -67,10 +66,7 @@ void metric::setValue(double v, bool applyGainAndOffset) {
         m_lapCountValue++;
         m_totValue += value();
         m_lapTotValue += value();
-        m_last5.append(value());
-
-        if (m_last5.count() > 5)
-            m_last5.removeAt(0);
+        pushSample(now, value());
 
         if (value() < m_min) {
             m_min = value();
@@ -90,6 +86,86 @@ void metric::setValue(double v, bool applyGainAndOffset) {
     }
 }
 
+void metric::pushSample(qint64 ns, double v) {
+    if (m_ring.isEmpty())
+        m_ring.resize(RING_CAPACITY);
+    sample *ring = m_ring.data();
+    if (m_ringHead - m_ringTail == RING_CAPACITY) {
+        // the ring is full: the oldest sample is overwritten, so every window still counting it has to drop it
+        const sample &oldest = ring[m_ringTail % RING_CAPACITY];
+        for (window &w : m_windows) {
+            if (w.tail == m_ringTail) {
+                w.sum -= oldest.value;
+                w.tail++;
+            }
+        }
+        m_ringTail++;
+    }
+
+    ring[m_ringHead % RING_CAPACITY] = {ns, v};
+    m_ringHead++;
+
+    m_last5Sum += v;
+    if (m_ringHead - m_ringTail > 5)
+        m_last5Sum -= ring[(m_ringHead - 6) % RING_CAPACITY].value;
+
+    for (window &w : m_windows) {
+        w.sum += v;
+        while (w.tail + 1 < m_ringHead && ns - ring[w.tail % RING_CAPACITY].ns > w.durationNs) {
+            w.sum -= ring[w.tail % RING_CAPACITY].value;
+            w.tail++;
+        }
+        // re-anchor the running sum whenever the window is down to one sample, so rounding errors can't pile up
+        if (w.tail + 1 == m_ringHead)
+            w.sum = v;
+    }
+}
+
+void metric::clearSamples() {
+    m_ringHead = 0;
+    m_ringTail = 0;
+    m_last5Sum = 0;
+    for (window &w : m_windows) {
+        w.tail = 0;
+        w.sum = 0;
+    }
+}
+
+void metric::setWindowDuration(_metric_window w, int msec) {
+    if (w < 0 || w >= WINDOW_COUNT || msec <= 0)
+        return;
+
+    window &win = m_windows[w];
+    win.durationNs = (qint64)msec * 1000000LL;
+    win.tail = m_ringTail;
+    win.sum = 0;
+    if (m_ringHead == m_ringTail)
+        return;
+
+    const sample *ring = m_ring.constData();
+    qint64 last = ring[(m_ringHead - 1) % RING_CAPACITY].ns;
+    for (quint64 i = m_ringTail; i < m_ringHead; i++) {
+        const sample &s = ring[i % RING_CAPACITY];
+        if (i + 1 < m_ringHead && last - s.ns > win.durationNs)
+            win.tail = i + 1;
+        else
+            win.sum += s.value;
+    }
+}
+
+double metric::averageWindow(_metric_window w) const {
+    if (w < 0 || w >= WINDOW_COUNT)
+        return 0;
+    quint64 c = m_ringHead - m_windows[w].tail;
+    if (c == 0)
+        return 0;
+    return m_windows[w].sum / c;
+}
+
+QDateTime metric::monotonicToDateTime(qint64 ns) {
+    return QDateTime::currentDateTime().addMSecs(-((monotonicNs() - ns) / 1000000LL));
+}
+
 void metric::clear(bool accumulator) {
     if (accumulator) {
         m_offset = m_value;
@@ -98,7 +174,7 @@ void metric::clear(bool accumulator) {
     m_totValue = 0;
     m_countValue = 0;
     m_min = 999999999;
-    m_last5.clear();
+    clearSamples();
     clearLap(accumulator);
 #ifdef TEST
     random_value_uint8 = 0;
@@ -106,11 +182,11 @@ void metric::clear(bool accumulator) {
 #endif
 }
 
-double metric::valueRaw() {
+double metric::valueRaw() const {
     return m_value;
 }
 
-double metric::value() {
+double metric::value() const {
 #ifdef TEST
     if (m_type != METRIC_ELAPSED) {
         return (double)(rand() % 256);
@@ -122,9 +198,9 @@ double metric::value() {
     return m_value - m_offset;
 }
 
-double metric::lapValue() { return m_value - m_lapOffset; }
+double metric::lapValue() const { return m_value - m_lapOffset; }
 
-double metric::average() {
+double metric::average() const {
     if (m_countValue == 0) {
         return 0;
     } else {
@@ -132,7 +208,7 @@ double metric::average() {
     }
 }
 
-double metric::lapAverage() {
+double metric::lapAverage() const {
     if (m_lapCountValue == 0) {
         return 0;
     } else {
@@ -140,37 +216,26 @@ double metric::lapAverage() {
     }
 }
 
-double metric::average5s() {
-    if (m_last5.count() == 0)
+double metric::average5s() const {
+    quint64 c = m_ringHead - m_ringTail;
+    if (c == 0)
         return 0;
-    else {
-        double sum = 0;
-        uint8_t c = 0;
-        QMutableListIterator<double> i(m_last5);
-        while (i.hasNext()) {
-            double b = i.next();
-            sum += b;
-            c++;
-        }
-
-        if (c > 0)
-            return (sum / c);
-        else
-            return 0;
-    }
+    if (c > 5)
+        c = 5;
+    return m_last5Sum / c;
 }
 
 void metric::operator=(double v) { setValue(v); }
 
 void metric::operator+=(double v) { setValue(m_value + v); }
 
-double metric::min() { return m_min; }
+double metric::min() const { return m_min; }
 
-double metric::max() { return m_max; }
+double metric::max() const { return m_max; }
 
-double metric::lapMin() { return m_lapMin; }
+double metric::lapMin() const { return m_lapMin; }
 
-double metric::lapMax() { return m_lapMax; }
+double metric::lapMax() const { return m_lapMax; }
 
 void metric::setPaused(bool p) { paused = p; }
 
@@ -187,11 +252,9 @@ void metric::clearLap(bool accumulator) {
 void metric::setLap(bool accumulator) { clearLap(accumulator); }
 
 double metric::calculateMaxSpeedFromPower(double power, double inclination) {
-    QSettings settings;
-    double rolling_resistance =
-        settings.value(QZSettings::rolling_resistance, QZSettings::default_rolling_resistance).toFloat();
-    double twt = 9.8 * (settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() +
-                        settings.value(QZSettings::bike_weight, QZSettings::default_bike_weight).toFloat());
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    double rolling_resistance = settings.rolling_resistance;
+    double twt = 9.8 * (settings.weight + settings.bike_weight);
     double aero = 0.22691607640851885;
     double hw = 0; // wind speed
     double tr = twt * ((inclination / 100.0) + rolling_resistance);
@@ -219,25 +282,23 @@ double metric::calculateMaxSpeedFromPower(double power, double inclination) {
 }
 
 double metric::calculatePowerFromSpeed(double speed, double inclination) {
-    QSettings settings;
-    double rolling_resistance =
-        settings.value(QZSettings::rolling_resistance, QZSettings::default_rolling_resistance).toFloat();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    double rolling_resistance = settings.rolling_resistance;
     double v = speed / 3.6; // converted to m/s;
     double tv = v + 0;
     double tran = 0.95;
     const double aero = 0.22691607640851885;
     double A2Eff = (tv > 0.0) ? aero : -aero; // wind in face, must reverse effect
-    double twt = 9.8 * (settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() +
-                        settings.value(QZSettings::bike_weight, QZSettings::default_bike_weight).toFloat());
+    double twt = 9.8 * (settings.weight + settings.bike_weight);
     double tr = twt * ((inclination / 100.0) + rolling_resistance);
     return (v * tr + v * tv * tv * A2Eff) / tran;
 }
 
 double metric::calculateSpeedFromPower(double power, double inclination, double speed, double deltaTimeSeconds,
                                        double speedLimit) {
-    QSettings settings;
-    double speed_gain = settings.value(QZSettings::speed_gain, QZSettings::default_speed_gain).toDouble();
-    double speed_offset = settings.value(QZSettings::speed_offset, QZSettings::default_speed_offset).toDouble();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    double speed_gain = settings.speed_gain;
+    double speed_offset = settings.speed_offset;
     if (inclination < -5)
         inclination = -5;
     if (speed_offset != QZSettings::default_speed_offset)
@@ -245,8 +306,7 @@ double metric::calculateSpeedFromPower(double power, double inclination, double
     if (speed_gain != QZSettings::default_speed_gain)
         speed /= speed_gain;
 
-    double fullWeight = (settings.value(QZSettings::weight, QZSettings::default_weight).toFloat() +
-                         settings.value(QZSettings::bike_weight, QZSettings::default_bike_weight).toFloat());
+    double fullWeight = (settings.weight + settings.bike_weight);
     double maxSpeed = calculateMaxSpeedFromPower(power, inclination);
     double maxPowerFromSpeed = calculatePowerFromSpeed(speed, inclination);
     double acceleration = (power - maxPowerFromSpeed) / fullWeight;
@@ -269,73 +329,11 @@ double metric::calculateWeightLoss(double kcal) {
     return kcal / 7716.1854; // comes from 1 lbs = 3500 kcal. Converted to kg
 }
 
-struct IntervalBest {
-    double avg = 0;
-    int64_t start = 0;
-    int64_t stop = 0;
-};
-
-struct CompareBests {
-    // Sort by decreasing power and increasing start time.
-    bool operator()(const IntervalBest &a, const IntervalBest &b) const {
-        if (a.avg > b.avg)
-            return true;
-        if (b.avg > a.avg)
-            return false;
-        return a.start < b.start;
-    }
-};
-
-double metric::powerPeak(QList<SessionLine> *session, int seconds) {
-    QList<IntervalBest> bests;
-    QList<IntervalBest> _results;
-
-    uint windowSize = seconds;
-    double total = 0.0;
-    QList<const SessionLine *> window;
-
-    if (session->count() == 0)
-        return -1;
-
-           // ride is shorter than the window size!
-    if (windowSize > session->last().elapsedTime)
-        return -1;
-
-    int i = 0;
-    // We're looking for intervals with durations in [windowSizeSecs, windowSizeSecs + secsDelta).
-    foreach (SessionLine point, *session) {
-
-        total += point.watt;
-        window.append(&session->at(i));
-        double duration = window.last()->elapsedTime - window.first()->elapsedTime;
-
-        if (duration >= windowSize) {
-            double start = window.first()->elapsedTime;
-            double stop = window.last()->elapsedTime;
-            double avg = total / duration;
-            IntervalBest b;
-            b.start = start;
-            b.stop = stop;
-            b.avg = avg;
-            bests.append(b);
-
-            total -= window.first()->watt;
-            window.removeFirst();
-        }
-        i++;
-    }
-
-    std::sort(bests.begin(), bests.end(), CompareBests());
-
-    if(bests.length() > 0)
-        return bests.first().avg;
-    else
-        return 0;
-}
+double metric::powerPeak(const SessionStore *session, int seconds) { return session->powerCurve().best(seconds); }
 
 // VO2 (L/min) = 0.0108 x power (W) + 0.007 x body mass (kg)
 // power = 5 min peak power for a specific ride
-double metric::calculateVO2Max(QList<SessionLine> *session) {       
+double metric::calculateVO2Max(const SessionStore *session) {
     double peak = powerPeak(session, 5*60);
     QSettings settings;
     return ((0.0108 * peak + 0.007 * settings.value(QZSettings::weight, QZSettings::default_weight).toFloat()) /
@@ -2,8 +2,10 @@
 #define METRIC_H
 
 #include "qdebugfixup.h"
-#include "sessionline.h"
+#include "sessionstore.h"
 #include <QDateTime>
+#include <QVector>
+#include <chrono>
 #include <math.h>
 
 class metric {
@@ -17,26 +19,51 @@ class metric {
         METRIC_ELAPSED = 3,
     } _metric_type;
 
+    /**
+     * @brief Rolling time windows kept by every metric. The durations can be changed with setWindowDuration().
+     */
+    typedef enum _metric_window {
+        WINDOW_3S = 0,
+        WINDOW_5S = 1,
+        WINDOW_10S = 2,
+        WINDOW_30S = 3,
+        WINDOW_COUNT = 4,
+    } _metric_window;
+
+    // samples kept for the rolling windows: 30s at 10Hz plus some margin. When a device sends faster than that the
+    // longest windows are limited to the last RING_CAPACITY samples.
+    static constexpr int RING_CAPACITY = 320;
+
     metric();
     void setType(_metric_type t);
     void setValue(double value, bool applyGainAndOffset = true);
-    double value();
-    double valueRaw();
-    QDateTime lastChanged() { return m_lastChanged; }
-    QDateTime valueChanged() { return m_valueChanged; }
-    double average();
-    double average5s();
+    double value() const;
+    double valueRaw() const;
+    QDateTime lastChanged() const { return monotonicToDateTime(m_lastChangedNs); }
+    QDateTime valueChanged() const { return monotonicToDateTime(m_valueChangedNs); }
+    // monotonic timestamps (see monotonicNs()) of the last setValue and of the last actual value change
+    qint64 lastChangedNs() const { return m_lastChangedNs; }
+    qint64 valueChangedNs() const { return m_valueChangedNs; }
+    double secondsSinceLastChanged() const { return (double)(monotonicNs() - m_lastChangedNs) / 1000000000.0; }
+    double average() const;
+    // average of the last 5 samples
+    double average5s() const;
+    // average of the samples received in the window ending at the last sample
+    double averageWindow(_metric_window w) const;
+    void setWindowDuration(_metric_window w, int msec);
+    // samples allocated for the rolling windows: none until the first sample
+    int allocatedSamples() const { return m_ring.count(); }
 
     // rate of the current metric in a second, useful to know how many Kcal i will burn in a
     // minute if i keep the current pace
-    double rate1s() { return m_rateAtSec; }
-
-    double min();
-    double max();
-    double lapValue();
-    double lapAverage();
-    double lapMin();
-    double lapMax();
+    double rate1s() const { return m_rateAtSec; }
+
+    double min() const;
+    double max() const;
+    double lapValue() const;
+    double lapAverage() const;
+    double lapMin() const;
+    double lapMax() const;
     void clearLap(bool accumulator);
     void clear(bool accumulator);
     void operator=(double);
@@ -49,19 +76,50 @@ class metric {
     static double calculateSpeedFromPower(double power, double inclination, double speed, double deltaTimeSeconds,
                                           double speedLimit);
     static double calculateWeightLoss(double kcal);
-    static double calculateVO2Max(QList<SessionLine> *session);
+    static double calculateVO2Max(const SessionStore *session);
     static double calculateKCalfromHR(double HR_AVG, double elapsed);
 
-    static double powerPeak(QList<SessionLine> *session, int seconds);
-    
+    static double powerPeak(const SessionStore *session, int seconds);
+
+    /**
+     * @brief Steady clock nanoseconds, not affected by wall clock changes.
+     */
+    static qint64 monotonicNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch())
+            .count();
+    }
+
   private:
+    struct sample {
+        qint64 ns;
+        double value;
+    };
+
+    struct window {
+        qint64 durationNs;
+        quint64 tail; // first sample counted in this window
+        double sum;
+    };
+
+    static QDateTime monotonicToDateTime(qint64 ns);
+    void pushSample(qint64 ns, double v);
+    void clearSamples();
+
     double m_value = 0;
     double m_totValue = 0;
     double m_countValue = 0;
     double m_min = 999999999;
     double m_max = 0;
     double m_offset = 0;
-    QList<double> m_last5;
+
+    // ring of the last samples, allocated at the first sample and shared by the copies of the metric until they
+    // change; m_ringHead and m_ringTail count samples since the last clear()
+    QVector<sample> m_ring;
+    quint64 m_ringHead = 0;
+    quint64 m_ringTail = 0;
+    double m_last5Sum = 0;
+    window m_windows[WINDOW_COUNT] = {{3000000000LL, 0, 0}, {5000000000LL, 0, 0}, {10000000000LL, 0, 0},
+                                      {30000000000LL, 0, 0}};
 
     double m_lapOffset = 0;
     double m_lapTotValue = 0;
@@ -69,8 +127,8 @@ class metric {
     double m_lapMin = 999999999;
     double m_lapMax = 0;
 
-    QDateTime m_lastChanged = QDateTime::currentDateTime();
-    QDateTime m_valueChanged = QDateTime::currentDateTime();
+    qint64 m_lastChangedNs = monotonicNs();
+    qint64 m_valueChangedNs = monotonicNs();
     double m_rateAtSec = 0;
 
     _metric_type m_type = METRIC_OTHER;
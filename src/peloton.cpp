@@ -1,9 +1,12 @@
 #include "peloton.h"
+#include <QNetworkCookieJar>
 #include <chrono>
 
 using namespace std::chrono_literals;
 
 const bool log_request = true;
+// the last workouts of the user whose classes are prefetched in the cache
+const int prefetch_workouts = 10;
 
 peloton::peloton(bluetooth *bl, QObject *parent) : QObject(parent) {
 
@@ -287,6 +290,12 @@ void peloton::startEngine() {
         return;
     }
 
+    if (offlineMode) {
+        timer->stop();
+        getWorkoutList(1);
+        return;
+    }
+
     QSettings settings;
     timer->stop();
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::login_onfinish);
@@ -336,12 +345,17 @@ void peloton::login_onfinish(QNetworkReply *reply) {
     emit loginState(!user_id.isEmpty());
 
     getWorkoutList(1);
+    prefetch();
 }
 
 void peloton::workoutlist_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::workoutlist_onfinish);
 
-    QByteArray payload = reply->readAll(); // JSON
+    // only read offline: the last workout of the user
+    workoutListReceived(readPayload(reply, QStringLiteral("workoutlist")));
+}
+
+void peloton::workoutListReceived(const QByteArray &payload) {
     QJsonParseError parseError;
     current_workout = QJsonDocument::fromJson(payload, &parseError);
     QJsonObject json = current_workout.object();
@@ -362,6 +376,7 @@ void peloton::workoutlist_onfinish(QNetworkReply *reply) {
                          Qt::CaseInsensitive) && // NOTE: removed toUpper because of qstring-insensitive-allocation
          !current_workout_status.contains(QStringLiteral("IN_PROGRESS"))) ||
         (status.contains(QStringLiteral("IN_PROGRESS"), Qt::CaseInsensitive) && id != current_workout_id) ||
+        (offlineMode && id != current_workout_id) ||
         testMode) { // NOTE: removed toUpper because of qstring-insensitive-allocation
 
         if (testMode)
@@ -371,7 +386,7 @@ void peloton::workoutlist_onfinish(QNetworkReply *reply) {
         // starting a workout
         qDebug() << QStringLiteral("peloton::workoutlist_onfinish workoutlist_onfinish IN PROGRESS!");
 
-        if ((bluetoothManager && bluetoothManager->device()) || testMode) {
+        if ((bluetoothManager && bluetoothManager->device()) || testMode || offlineMode) {
             getSummary(id);
             timer->start(1min); // timeout request
             current_workout_status = status;
@@ -397,7 +412,10 @@ void peloton::workoutlist_onfinish(QNetworkReply *reply) {
 void peloton::summary_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::summary_onfinish);
 
-    QByteArray payload = reply->readAll(); // JSON
+    summaryReceived(readPayload(reply, QStringLiteral("summary/") + current_workout_id));
+}
+
+void peloton::summaryReceived(const QByteArray &payload) {
     QJsonParseError parseError;
     current_workout_summary = QJsonDocument::fromJson(payload, &parseError);
 
@@ -413,8 +431,11 @@ void peloton::summary_onfinish(QNetworkReply *reply) {
 void peloton::instructor_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::instructor_onfinish);
 
+    instructorReceived(readPayload(reply, QStringLiteral("instructor/") + current_instructor_id));
+}
+
+void peloton::instructorReceived(const QByteArray &payload) {
     QSettings settings;
-    QByteArray payload = reply->readAll(); // JSON
     QJsonParseError parseError;
     instructor = QJsonDocument::fromJson(payload, &parseError);
     current_instructor_name = instructor.object()[QStringLiteral("name")].toString();
@@ -450,7 +471,10 @@ void peloton::instructor_onfinish(QNetworkReply *reply) {
 void peloton::workout_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::workout_onfinish);
 
-    QByteArray payload = reply->readAll(); // JSON
+    workoutReceived(readPayload(reply, QStringLiteral("workout/") + current_workout_id));
+}
+
+void peloton::workoutReceived(const QByteArray &payload) {
     QJsonParseError parseError;
     workout = QJsonDocument::fromJson(payload, &parseError);
     QJsonObject ride = workout.object()[QStringLiteral("ride")].toObject();
@@ -487,7 +511,18 @@ void peloton::workout_onfinish(QNetworkReply *reply) {
 void peloton::ride_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::ride_onfinish);
 
-    QByteArray payload = reply->readAll(); // JSON
+    rideReceived(readPayload(reply, QStringLiteral("ride/") + current_ride_id));
+}
+
+void peloton::rideReceived(const QByteArray &payload) {
+    // the same class, converted with the same settings for the same device: the rows of the last time
+    const QString key = QStringLiteral("ride/") + current_ride_id;
+    const QByteArray context = trainrowsContext();
+    if (cachedTrainrows(key, context)) {
+        timer->start(30s); // check for a status changed
+        return;
+    }
+
     QJsonParseError parseError;
     QJsonDocument document = QJsonDocument::fromJson(payload, &parseError);
     QJsonObject ride = document.object();
@@ -818,6 +853,8 @@ void peloton::ride_onfinish(QNetworkReply *reply) {
     }
 
     if (!trainrows.isEmpty()) {
+        // never empty for a rower: the ride is always read again for the paces, the rows come from the performance
+        cache.setTrainrows(key, context, trainrows);
         emit workoutStarted(current_workout_name, current_instructor_name);
         timer->start(30s); // check for a status changed
     } else {
@@ -829,14 +866,25 @@ void peloton::ride_onfinish(QNetworkReply *reply) {
 void peloton::performance_onfinish(QNetworkReply *reply) {
     disconnect(mgr, &QNetworkAccessManager::finished, this, &peloton::performance_onfinish);
 
+    // the targets are the ones of the class, whatever the workout
+    performanceReceived(readPayload(reply, QStringLiteral("performance/") + current_ride_id));
+}
+
+void peloton::performanceReceived(const QByteArray &payload) {
+    current_api = peloton_api;
+    const QString key = QStringLiteral("performance/") + current_ride_id;
+    const QByteArray context = trainrowsContext();
+    if (cachedTrainrows(key, context)) {
+        timer->start(30s); // check for a status changed
+        return;
+    }
+
     QSettings settings;
     QString difficulty =
         settings.value(QZSettings::peloton_difficulty, QZSettings::default_peloton_difficulty).toString();
 
-    QByteArray payload = reply->readAll(); // JSON
     QJsonParseError parseError;
     performance = QJsonDocument::fromJson(payload, &parseError);
-    current_api = peloton_api;
 
     QJsonObject json = performance.object();
     QJsonObject target_performance_metrics = json[QStringLiteral("target_performance_metrics")].toObject();
@@ -1023,6 +1071,7 @@ void peloton::performance_onfinish(QNetworkReply *reply) {
 
     if (!trainrows.isEmpty()) {
 
+        cache.setTrainrows(key, context, trainrows);
         emit workoutStarted(current_workout_name, current_instructor_name);
     } else {
 
@@ -1050,6 +1099,8 @@ double peloton::rowerpaceToSpeed(double pace) {
 }
 
 void peloton::getInstructor(const QString &instructor_id) {
+    if (fromCache(QStringLiteral("instructor/") + instructor_id, true, &peloton::instructorReceived))
+        return;
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::instructor_onfinish);
 
     QUrl url(QStringLiteral("https://api.onepeloton.com/api/instructor/") + instructor_id);
@@ -1063,6 +1114,8 @@ void peloton::getInstructor(const QString &instructor_id) {
 }
 
 void peloton::getRide(const QString &ride_id) {
+    if (fromCache(QStringLiteral("ride/") + ride_id, true, &peloton::rideReceived))
+        return;
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::ride_onfinish);
 
     QUrl url(QStringLiteral("https://api.onepeloton.com/api/ride/") + ride_id +
@@ -1077,6 +1130,8 @@ void peloton::getRide(const QString &ride_id) {
 }
 
 void peloton::getPerformance(const QString &workout) {
+    if (fromCache(QStringLiteral("performance/") + current_ride_id, true, &peloton::performanceReceived))
+        return;
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::performance_onfinish);
 
     QUrl url(QStringLiteral("https://api.onepeloton.com/api/workout/") + workout +
@@ -1091,6 +1146,9 @@ void peloton::getPerformance(const QString &workout) {
 }
 
 void peloton::getWorkout(const QString &workout) {
+    // the workout in progress changes, only read offline
+    if (fromCache(QStringLiteral("workout/") + workout, false, &peloton::workoutReceived))
+        return;
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::workout_onfinish);
 
     QUrl url(QStringLiteral("https://api.onepeloton.com/api/workout/") + workout);
@@ -1104,6 +1162,8 @@ void peloton::getWorkout(const QString &workout) {
 }
 
 void peloton::getSummary(const QString &workout) {
+    if (fromCache(QStringLiteral("summary/") + workout, false, &peloton::summaryReceived))
+        return;
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::summary_onfinish);
 
     QUrl url(QStringLiteral("https://api.onepeloton.com/api/workout/") + workout + QStringLiteral("/summary"));
@@ -1126,6 +1186,9 @@ void peloton::getWorkoutList(int num) {
     // int pages = num / limit; //NOTE: clang-analyzer-deadcode.DeadStores
     // int rem = num % limit; //NOTE: clang-analyzer-deadcode.DeadStores
 
+    if (fromCache(QStringLiteral("workoutlist"), false, &peloton::workoutListReceived))
+        return;
+
     connect(mgr, &QNetworkAccessManager::finished, this, &peloton::workoutlist_onfinish);
 
     int current_page = 0;
@@ -1143,3 +1206,149 @@ void peloton::getWorkoutList(int num) {
 }
 
 void peloton::setTestMode(bool test) { testMode = test; }
+
+void peloton::setOfflineMode(bool offline) {
+    offlineMode = offline;
+    if (!offline || !PZP)
+        return;
+    // the login sent by the constructor is ignored
+    disconnect(mgr, &QNetworkAccessManager::finished, this, nullptr);
+    startEngine();
+}
+
+bool peloton::fromCache(const QString &key, bool online, void (peloton::*received)(const QByteArray &)) {
+    if (!online && !offlineMode)
+        return false;
+    QByteArray payload;
+    if (cache.payload(key, &payload)) {
+        qDebug() << QStringLiteral("peloton::fromCache") << key;
+        (this->*received)(payload);
+        return true;
+    }
+    if (offlineMode) {
+        qDebug() << QStringLiteral("peloton::fromCache offline, not in the cache") << key;
+        emit loginState(false);
+        return true;
+    }
+    return false;
+}
+
+QByteArray peloton::readPayload(QNetworkReply *reply, const QString &key) {
+    QByteArray payload = reply->readAll(); // JSON
+    if (reply->error() == QNetworkReply::NoError && !payload.isEmpty())
+        cache.setPayload(key, payload);
+    return payload;
+}
+
+QByteArray peloton::trainrowsContext() {
+    // everything the conversion of a class depends on, but the class
+    QSettings settings;
+    QByteArray context;
+    QDataStream out(&context, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << settings.value(QZSettings::peloton_difficulty, QZSettings::default_peloton_difficulty).toString()
+        << settings.value(QZSettings::ftp, QZSettings::default_ftp).toDouble()
+        << settings.value(QZSettings::treadmill_force_speed, QZSettings::default_treadmill_force_speed).toBool()
+        << settings.value(QZSettings::zwift_inclination_offset, QZSettings::default_zwift_inclination_offset)
+               .toDouble()
+        << settings.value(QZSettings::zwift_inclination_gain, QZSettings::default_zwift_inclination_gain).toDouble()
+        << settings.value(QZSettings::peloton_rower_level, QZSettings::default_peloton_rower_level).toInt()
+        << settings
+               .value(QZSettings::peloton_spinups_autoresistance,
+                      QZSettings::default_peloton_spinups_autoresistance)
+               .toBool();
+
+    bluetoothdevice *device = bluetoothManager ? bluetoothManager->device() : nullptr;
+    out << qint32(device ? device->deviceType() : -1);
+    if (device && device->deviceType() == bluetoothdevice::BIKE) {
+        for (int i = 0; i <= 100; i++)
+            out << qint16(((bike *)device)->pelotonToBikeResistance(i));
+    } else if (device && device->deviceType() == bluetoothdevice::ELLIPTICAL) {
+        for (int i = 0; i <= 100; i++)
+            out << qint16(((elliptical *)device)->pelotonToEllipticalResistance(i));
+    } else if (device && device->deviceType() == bluetoothdevice::ROWING) {
+        // read from the ride just before
+        out << qint32(rower_pace_offset);
+        for (const _peloton_rower_pace_intensities &p : rower_pace)
+            for (const _peloton_rower_pace_intensities_level &l : p.levels)
+                out << l.fast_pace << l.slow_pace;
+    }
+    return context;
+}
+
+bool peloton::cachedTrainrows(const QString &key, const QByteArray &context) {
+    QList<trainrow> rows;
+    if (!cache.trainrows(key, context, &rows) || rows.isEmpty())
+        return false;
+    trainrows = rows;
+    qDebug() << QStringLiteral("peloton::cachedTrainrows") << key << trainrows.length();
+    emit workoutStarted(current_workout_name, current_instructor_name);
+    return true;
+}
+
+void peloton::prefetch() {
+    if (prefetched || offlineMode || user_id.isEmpty())
+        return;
+    prefetched = true;
+
+    if (!prefetchMgr) {
+        prefetchMgr = new QNetworkAccessManager(this);
+        // the session of the login
+        QNetworkCookieJar *jar = mgr->cookieJar();
+        prefetchMgr->setCookieJar(jar);
+        jar->setParent(mgr);
+    }
+
+    QUrl url(QStringLiteral("https://api.onepeloton.com/api/user/") + user_id +
+             QStringLiteral("/workouts?sort_by=-created&page=0&limit=") + QString::number(prefetch_workouts));
+    prefetchGet(url, QString(), [this](const QByteArray &payload) {
+        const QJsonArray data = QJsonDocument::fromJson(payload).object()[QStringLiteral("data")].toArray();
+        for (const QJsonValue &w : data) {
+            const QString workout_id = w[QStringLiteral("id")].toString();
+            if (workout_id.isEmpty() || cache.contains(QStringLiteral("workout/") + workout_id))
+                continue;
+            QUrl url(QStringLiteral("https://api.onepeloton.com/api/workout/") + workout_id);
+            prefetchGet(url, QStringLiteral("workout/") + workout_id, [this, workout_id](const QByteArray &payload) {
+                const QJsonObject ride = QJsonDocument::fromJson(payload).object()[QStringLiteral("ride")].toObject();
+                const QString ride_id = ride[QStringLiteral("id")].toString();
+                const QString instructor_id = ride[QStringLiteral("instructor_id")].toString();
+                if (!ride_id.isEmpty() && !cache.contains(QStringLiteral("ride/") + ride_id)) {
+                    prefetchGet(QUrl(QStringLiteral("https://api.onepeloton.com/api/ride/") + ride_id +
+                                     QStringLiteral("/details?stream_source=multichannel")),
+                                QStringLiteral("ride/") + ride_id);
+                }
+                if (!ride_id.isEmpty() && !cache.contains(QStringLiteral("performance/") + ride_id)) {
+                    prefetchGet(QUrl(QStringLiteral("https://api.onepeloton.com/api/workout/") + workout_id +
+                                     QStringLiteral("/performance_graph?every_n=") +
+                                     QString::number(peloton_workout_second_resolution)),
+                                QStringLiteral("performance/") + ride_id);
+                }
+                if (!instructor_id.isEmpty() && !cache.contains(QStringLiteral("instructor/") + instructor_id)) {
+                    prefetchGet(QUrl(QStringLiteral("https://api.onepeloton.com/api/instructor/") + instructor_id),
+                                QStringLiteral("instructor/") + instructor_id);
+                }
+            });
+        }
+    });
+}
+
+void peloton::prefetchGet(const QUrl &url, const QString &key,
+                          const std::function<void(const QByteArray &)> &received) {
+    qDebug() << "peloton::prefetchGet" << url;
+    QNetworkRequest request(url);
+
+    request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/json"));
+    request.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("qdomyos-zwift"));
+
+    QNetworkReply *reply = prefetchMgr->get(request);
+    connect(reply, &QNetworkReply::finished, this, [this, reply, key, received]() {
+        reply->deleteLater();
+        if (reply->error() != QNetworkReply::NoError)
+            return;
+        const QByteArray payload = reply->readAll();
+        if (!key.isEmpty())
+            cache.setPayload(key, payload);
+        if (received)
+            received(payload);
+    });
+}
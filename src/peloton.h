@@ -2,6 +2,7 @@
 #define PELOTON_H
 
 #include "bluetooth.h"
+#include "pelotoncache.h"
 #include "powerzonepack.h"
 #include "trainprogram.h"
 #include <QAbstractOAuth2>
@@ -20,6 +21,7 @@
 
 #include <QTimer>
 #include <QUrlQuery>
+#include <functional>
 
 #include "filedownloader.h"
 #include "homefitnessbuddy.h"
@@ -49,6 +51,10 @@ class peloton : public QObject {
     int current_pedaling_duration = 0;
 
     void setTestMode(bool test);
+    /**
+     * @brief Without the network: the workout list, the workout and the class are served from the cache.
+     */
+    void setOfflineMode(bool offline);
 
     bool isWorkoutInProgress() {
         return current_workout_status.contains(QStringLiteral("IN_PROGRESS"), Qt::CaseInsensitive);
@@ -81,6 +87,26 @@ class peloton : public QObject {
     void getPerformance(const QString &workout);
 
     bool testMode = false;
+    bool offlineMode = false;
+
+    // the answers of the API and the trainrows converted from them
+    pelotoncache cache;
+    QNetworkAccessManager *prefetchMgr = nullptr;
+    bool prefetched = false;
+    void prefetch();
+    void prefetchGet(const QUrl &url, const QString &key,
+                     const std::function<void(const QByteArray &)> &received = nullptr);
+    bool fromCache(const QString &key, bool online, void (peloton::*received)(const QByteArray &));
+    QByteArray readPayload(QNetworkReply *reply, const QString &key);
+    QByteArray trainrowsContext();
+    bool cachedTrainrows(const QString &key, const QByteArray &context);
+
+    void workoutListReceived(const QByteArray &payload);
+    void summaryReceived(const QByteArray &payload);
+    void workoutReceived(const QByteArray &payload);
+    void instructorReceived(const QByteArray &payload);
+    void rideReceived(const QByteArray &payload);
+    void performanceReceived(const QByteArray &payload);
 
     // rowers
     double rowerpaceToSpeed(double pace);
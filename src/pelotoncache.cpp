@@ -0,0 +1,301 @@
+#include "pelotoncache.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+#include <QVector>
+#include <algorithm>
+
+namespace {
+
+const quint32 INDEX_MAGIC = 0x50435a51; // "QZCP"
+const quint32 INDEX_VERSION = 1;
+const quint32 ROWS_MAGIC = 0x52545a51; // "QZTR"
+// to change when trainrow changes
+const quint32 ROWS_VERSION = 1;
+
+const char *const INDEX_FILE = "index.dat";
+const char *const OBJECTS_DIR = "objects";
+const char *const ROWS_DIR = "rows";
+
+void writeRow(QDataStream &out, const trainrow &r) {
+    out << r.duration << r.started << r.ended << r.distance << r.speed << r.lower_speed << r.average_speed
+        << r.upper_speed << r.fanspeed << r.inclination << r.lower_inclination << r.average_inclination
+        << r.upper_inclination << qint16(r.resistance) << qint16(r.lower_resistance) << qint16(r.average_resistance)
+        << qint16(r.upper_resistance) << qint8(r.requested_peloton_resistance)
+        << qint8(r.lower_requested_peloton_resistance) << qint8(r.average_requested_peloton_resistance)
+        << qint8(r.upper_requested_peloton_resistance) << qint8(r.pace_intensity) << qint16(r.cadence)
+        << qint16(r.lower_cadence) << qint16(r.average_cadence) << qint16(r.upper_cadence) << r.forcespeed
+        << qint8(r.loopTimeHR) << qint8(r.zoneHR) << qint16(r.HRmin) << qint16(r.HRmax) << r.maxSpeed << r.minSpeed
+        << qint8(r.maxResistance) << qint32(r.power) << qint32(r.mets) << r.rampDuration << r.rampElapsed
+        << r.gpxElapsed << r.latitude << r.longitude << r.altitude << r.azimuth;
+}
+
+void readRow(QDataStream &in, trainrow *r) {
+    qint16 resistance, lower_resistance, average_resistance, upper_resistance;
+    qint8 requested, lower_requested, average_requested, upper_requested, pace_intensity;
+    qint16 cadence, lower_cadence, average_cadence, upper_cadence;
+    qint8 loopTimeHR, zoneHR, maxResistance;
+    qint16 HRmin, HRmax;
+    qint32 power, mets;
+    in >> r->duration >> r->started >> r->ended >> r->distance >> r->speed >> r->lower_speed >> r->average_speed >>
+        r->upper_speed >> r->fanspeed >> r->inclination >> r->lower_inclination >> r->average_inclination >>
+        r->upper_inclination >> resistance >> lower_resistance >> average_resistance >> upper_resistance >>
+        requested >> lower_requested >> average_requested >> upper_requested >> pace_intensity >> cadence >>
+        lower_cadence >> average_cadence >> upper_cadence >> r->forcespeed >> loopTimeHR >> zoneHR >> HRmin >>
+        HRmax >> r->maxSpeed >> r->minSpeed >> maxResistance >> power >> mets >> r->rampDuration >>
+        r->rampElapsed >> r->gpxElapsed >> r->latitude >> r->longitude >> r->altitude >> r->azimuth;
+    r->resistance = resistance;
+    r->lower_resistance = lower_resistance;
+    r->average_resistance = average_resistance;
+    r->upper_resistance = upper_resistance;
+    r->requested_peloton_resistance = requested;
+    r->lower_requested_peloton_resistance = lower_requested;
+    r->average_requested_peloton_resistance = average_requested;
+    r->upper_requested_peloton_resistance = upper_requested;
+    r->pace_intensity = pace_intensity;
+    r->cadence = cadence;
+    r->lower_cadence = lower_cadence;
+    r->average_cadence = average_cadence;
+    r->upper_cadence = upper_cadence;
+    r->loopTimeHR = loopTimeHR;
+    r->zoneHR = zoneHR;
+    r->HRmin = HRmin;
+    r->HRmax = HRmax;
+    r->maxResistance = maxResistance;
+    r->power = power;
+    r->mets = mets;
+}
+
+} // namespace
+
+pelotoncache::pelotoncache(const QString &dir)
+    : dir(dir.isEmpty() ? QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/peloton")
+                        : dir) {}
+
+QByteArray pelotoncache::hash(const QByteArray &data) {
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+}
+
+QString pelotoncache::objectFile(const QByteArray &hash) const {
+    return dir + QLatin1Char('/') + OBJECTS_DIR + QLatin1Char('/') + QString::fromLatin1(hash) +
+           QStringLiteral(".json");
+}
+
+QString pelotoncache::rowsFile(const QByteArray &hash, const QByteArray &context) const {
+    return dir + QLatin1Char('/') + ROWS_DIR + QLatin1Char('/') + QString::fromLatin1(hash) + QLatin1Char('-') +
+           QString::fromLatin1(pelotoncache::hash(context)) + QStringLiteral(".qzrows");
+}
+
+bool pelotoncache::write(const QString &fileName, const QByteArray &data) const {
+    QDir().mkpath(QFileInfo(fileName).absolutePath());
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    if (file.write(data) != data.size()) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+void pelotoncache::load() {
+    if (loaded)
+        return;
+    loaded = true;
+
+    QFile file(dir + QLatin1Char('/') + INDEX_FILE);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != INDEX_MAGIC || version != INDEX_VERSION)
+        return;
+
+    QHash<QString, entry> read;
+    read.reserve(qMin<quint32>(count, 65536));
+    for (quint32 i = 0; i < count; i++) {
+        QString key;
+        entry e;
+        in >> key >> e.hash >> e.used;
+        if (in.status() != QDataStream::Ok)
+            return;
+        read.insert(key, e);
+    }
+    entries.swap(read);
+}
+
+bool pelotoncache::save() const {
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << INDEX_MAGIC << INDEX_VERSION << quint32(entries.count());
+    for (auto i = entries.constBegin(); i != entries.constEnd(); ++i)
+        out << i.key() << i.value().hash << i.value().used;
+    return write(dir + QLatin1Char('/') + INDEX_FILE, data);
+}
+
+bool pelotoncache::payload(const QString &key, QByteArray *data) {
+    load();
+    auto i = entries.find(key);
+    if (i == entries.end())
+        return false;
+
+    QFile file(objectFile(i.value().hash));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QByteArray read = file.readAll();
+    // a file damaged or changed by someone else isn't the payload anymore, the next one stored replaces it
+    if (hash(read) != i.value().hash) {
+        file.remove();
+        return false;
+    }
+
+    // only written with the next change: a read doesn't cost a write
+    i.value().used = QDateTime::currentMSecsSinceEpoch();
+    *data = read;
+    return true;
+}
+
+bool pelotoncache::setPayload(const QString &key, const QByteArray &data) {
+    load();
+    const QByteArray h = hash(data);
+    auto i = entries.find(key);
+    if (i != entries.end() && i.value().hash == h && QFileInfo::exists(objectFile(h))) {
+        i.value().used = QDateTime::currentMSecsSinceEpoch();
+        return true;
+    }
+
+    // the same content under another key is already there
+    if (!QFileInfo::exists(objectFile(h)) && !write(objectFile(h), data))
+        return false;
+
+    entry e;
+    e.hash = h;
+    e.used = QDateTime::currentMSecsSinceEpoch();
+    entries.insert(key, e);
+    if (entries.count() > maxEntries)
+        prune();
+    return save();
+}
+
+bool pelotoncache::contains(const QString &key) {
+    load();
+    auto i = entries.constFind(key);
+    return i != entries.constEnd() && QFileInfo::exists(objectFile(i.value().hash));
+}
+
+int pelotoncache::count() {
+    load();
+    return entries.count();
+}
+
+bool pelotoncache::trainrows(const QString &key, const QByteArray &context, QList<trainrow> *rows) {
+    load();
+    auto i = entries.constFind(key);
+    if (i == entries.constEnd())
+        return false;
+
+    QFile file(rowsFile(i.value().hash, context));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    QByteArray storedContext;
+    in >> storedContext;
+    // the file name is a hash of the context, the context itself tells a collision
+    if (in.status() != QDataStream::Ok || storedContext != context)
+        return false;
+    return readTrainrows(in, rows);
+}
+
+bool pelotoncache::setTrainrows(const QString &key, const QByteArray &context, const QList<trainrow> &rows) {
+    load();
+    auto i = entries.constFind(key);
+    if (i == entries.constEnd())
+        return false;
+
+    QByteArray data;
+    QDataStream out(&data, QIODevice::WriteOnly);
+    out.setVersion(QDataStream::Qt_5_9);
+    out << context;
+    if (!writeTrainrows(out, rows))
+        return false;
+    return write(rowsFile(i.value().hash, context), data);
+}
+
+bool pelotoncache::writeTrainrows(QDataStream &out, const QList<trainrow> &rows) {
+    out << ROWS_MAGIC << ROWS_VERSION << quint32(rows.count());
+    for (const trainrow &r : rows)
+        writeRow(out, r);
+    return out.status() == QDataStream::Ok;
+}
+
+bool pelotoncache::readTrainrows(QDataStream &in, QList<trainrow> *rows) {
+    quint32 magic, version, count;
+    in >> magic >> version >> count;
+    if (in.status() != QDataStream::Ok || magic != ROWS_MAGIC || version != ROWS_VERSION)
+        return false;
+
+    QList<trainrow> read;
+    read.reserve(qMin<quint32>(count, 65536));
+    for (quint32 i = 0; i < count; i++) {
+        trainrow r;
+        readRow(in, &r);
+        if (in.status() != QDataStream::Ok)
+            return false;
+        read.append(r);
+    }
+    rows->swap(read);
+    return true;
+}
+
+int pelotoncache::prune() {
+    load();
+    bool changed = false;
+    if (entries.count() > maxEntries) {
+        QVector<qint64> used;
+        used.reserve(entries.count());
+        for (const entry &e : qAsConst(entries))
+            used.append(e.used);
+        std::sort(used.begin(), used.end());
+        // the entries used before the oldest one to keep
+        const qint64 oldest = used.at(used.count() - maxEntries);
+        for (auto i = entries.begin(); i != entries.end();) {
+            if (i.value().used < oldest)
+                i = entries.erase(i);
+            else
+                ++i;
+        }
+        changed = true;
+    }
+
+    QSet<QString> referenced;
+    for (const entry &e : qAsConst(entries))
+        referenced.insert(QString::fromLatin1(e.hash));
+
+    int removed = 0;
+    const QFileInfoList objects = QDir(dir + QLatin1Char('/') + OBJECTS_DIR).entryInfoList(QDir::Files);
+    for (const QFileInfo &info : objects) {
+        if (!referenced.contains(info.completeBaseName()) && QFile::remove(info.absoluteFilePath()))
+            removed++;
+    }
+    const QFileInfoList rows = QDir(dir + QLatin1Char('/') + ROWS_DIR).entryInfoList(QDir::Files);
+    for (const QFileInfo &info : rows) {
+        if (!referenced.contains(info.completeBaseName().section(QLatin1Char('-'), 0, 0)) &&
+            QFile::remove(info.absoluteFilePath()))
+            removed++;
+    }
+
+    if (changed)
+        save();
+    return removed;
+}
@@ -0,0 +1,77 @@
+#ifndef PELOTONCACHE_H
+#define PELOTONCACHE_H
+
+#include "trainprogram.h"
+#include <QByteArray>
+#include <QHash>
+#include <QList>
+#include <QString>
+
+/**
+ * @brief On disk cache of the Peloton API answers, and of the trainrows converted from them.
+ * The payloads are content addressed: stored once by the hash of their content, whatever the number of keys
+ * ("ride/<id>", "instructor/<id>", ...) pointing at them, so a class seen again doesn't write anything.
+ * The trainrows are stored in binary next to the payload they come from, for a context: the settings and the device
+ * used to convert them. A payload changing or a context changing misses them, nothing has to be invalidated.
+ */
+class pelotoncache {
+  public:
+    /**
+     * @brief The cache in dir, by default in the cache location of the application.
+     */
+    explicit pelotoncache(const QString &dir = QString());
+
+    const QString &directory() const { return dir; }
+
+    /**
+     * @brief The payload stored for key, false when there isn't one or it can't be read.
+     */
+    bool payload(const QString &key, QByteArray *data);
+    /**
+     * @brief Stores the payload of key, nothing is written when it didn't change.
+     */
+    bool setPayload(const QString &key, const QByteArray &data);
+    bool contains(const QString &key);
+
+    /**
+     * @brief The trainrows converted from the payload of key in context, false when the payload changed since, or
+     * they were converted in another context.
+     */
+    bool trainrows(const QString &key, const QByteArray &context, QList<trainrow> *rows);
+    bool setTrainrows(const QString &key, const QByteArray &context, const QList<trainrow> &rows);
+
+    /**
+     * @brief Above this number of keys, the ones used the longest time ago are removed with their files.
+     */
+    void setMaxEntries(int max) { maxEntries = max; }
+    int count();
+
+    /**
+     * @brief Removes the keys above the maximum and the files no key points at anymore, returns the files removed.
+     */
+    int prune();
+
+    static QByteArray hash(const QByteArray &data);
+
+    static bool writeTrainrows(QDataStream &out, const QList<trainrow> &rows);
+    static bool readTrainrows(QDataStream &in, QList<trainrow> *rows);
+
+  private:
+    struct entry {
+        QByteArray hash;
+        qint64 used = 0;
+    };
+
+    QString dir;
+    QHash<QString, entry> entries;
+    bool loaded = false;
+    int maxEntries = 500;
+
+    void load();
+    bool save() const;
+    QString objectFile(const QByteArray &hash) const;
+    QString rowsFile(const QByteArray &hash, const QByteArray &context) const;
+    bool write(const QString &fileName, const QByteArray &data) const;
+};
+
+#endif // PELOTONCACHE_H
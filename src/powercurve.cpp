@@ -0,0 +1,85 @@
+#include "powercurve.h"
+
+namespace {
+
+QVector<int> buildDurations() {
+    QVector<int> d;
+    for (int s = 1; s <= 120; s++)
+        d.append(s);
+    for (int s = 125; s <= 600; s += 5)
+        d.append(s);
+    for (int s = 615; s <= 1200; s += 15)
+        d.append(s);
+    for (int s = 1230; s <= PowerCurve::MAX_DURATION; s += 30)
+        d.append(s);
+    return d;
+}
+
+// index in durations() of the longest grid duration <= seconds
+QVector<int> buildGridIndex(const QVector<int> &durations) {
+    QVector<int> index(PowerCurve::MAX_DURATION + 1, -1);
+    int g = -1;
+    for (int s = 1; s <= PowerCurve::MAX_DURATION; s++) {
+        if (g + 1 < durations.count() && durations.at(g + 1) == s)
+            g++;
+        index[s] = g;
+    }
+    return index;
+}
+
+const QVector<int> &gridIndex() {
+    static const QVector<int> index = buildGridIndex(PowerCurve::durations());
+    return index;
+}
+
+} // namespace
+
+PowerCurve::PowerCurve() { clear(); }
+
+const QVector<int> &PowerCurve::durations() {
+    static const QVector<int> durations = buildDurations();
+    return durations;
+}
+
+void PowerCurve::clear() {
+    m_prefix.fill(0, MAX_DURATION + 1);
+    m_best.fill(-1, durations().count());
+    m_count = 0;
+    m_version++;
+}
+
+void PowerCurve::append(double watt) {
+    const int ring = MAX_DURATION + 1;
+    const double total = m_prefix.at(m_count % ring) + watt;
+    m_count++;
+    m_prefix[m_count % ring] = total;
+
+    const QVector<int> &d = durations();
+    bool improved = false;
+    for (int i = 0; i < d.count(); i++) {
+        const int seconds = d.at(i);
+        if (seconds > m_count)
+            break;
+        const double avg = (total - m_prefix.at((m_count - seconds) % ring)) / seconds;
+        if (avg > m_best.at(i)) {
+            m_best[i] = avg;
+            improved = true;
+        }
+    }
+    if (improved)
+        m_version++;
+}
+
+double PowerCurve::best(int seconds) const {
+    if (seconds <= 0 || seconds > m_count)
+        return -1;
+    if (seconds > MAX_DURATION)
+        seconds = MAX_DURATION;
+    const int g = gridIndex().at(seconds);
+    const QVector<int> &d = durations();
+    if (d.at(g) == seconds || g + 1 >= d.count() || m_best.at(g + 1) < 0)
+        return m_best.at(g);
+    // the curve doesn't increase with the duration: the value is between the bests of the two grid points
+    const double t = (double)(seconds - d.at(g)) / (d.at(g + 1) - d.at(g));
+    return m_best.at(g) + (m_best.at(g + 1) - m_best.at(g)) * t;
+}
@@ -0,0 +1,59 @@
+#ifndef POWERCURVE_H
+#define POWERCURVE_H
+
+#include <QVector>
+#include <QtGlobal>
+
+/**
+ * @brief Mean maximal power curve of a workout, updated incrementally, one power sample per second.
+ * The last MAX_DURATION prefix sums are kept in a ring, so the average of the window of any duration ending at the
+ * newest sample is a single subtraction. append() checks every duration of a fixed grid (every second up to 2
+ * minutes, then coarser up to 60 minutes): its cost depends on the grid, not on the length of the workout, and
+ * best() is a lookup.
+ */
+class PowerCurve {
+  public:
+    static constexpr int MAX_DURATION = 3600;
+
+    PowerCurve();
+
+    void append(double watt);
+    void clear();
+
+    /**
+     * @brief Number of samples (seconds) appended so far.
+     */
+    int count() const { return m_count; }
+
+    /**
+     * @brief The best average power over the duration specified.
+     * Durations between two grid points are interpolated between their bests (the best of the shorter one while the
+     * workout is shorter than the longer one), and durations over MAX_DURATION return the best of MAX_DURATION.
+     * @return -1 if the workout is shorter than the duration, like metric::powerPeak.
+     */
+    double best(int seconds) const;
+
+    /**
+     * @brief The durations of the grid, in seconds, ascending.
+     */
+    static const QVector<int> &durations();
+
+    /**
+     * @brief The best average power for durations().at(index), -1 if the workout is shorter.
+     */
+    double bestAt(int index) const { return m_best.at(index); }
+
+    /**
+     * @brief Incremented whenever a value of the curve improves, to refresh consumers only when needed.
+     */
+    quint32 version() const { return m_version; }
+
+  private:
+    // m_prefix[k % (MAX_DURATION + 1)] is the sum of the first k samples
+    QVector<double> m_prefix;
+    QVector<double> m_best;
+    int m_count = 0;
+    quint32 m_version = 0;
+};
+
+#endif // POWERCURVE_H
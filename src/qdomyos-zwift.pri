@@ -86,6 +86,7 @@ devices/apexbike/apexbike.cpp \
 handleurl.cpp \
 devices/iconceptelliptical/iconceptelliptical.cpp \
 localipaddress.cpp \
+logwriter.cpp \
 devices/pelotonbike/pelotonbike.cpp \
 devices/schwinn170bike/schwinn170bike.cpp \
 devices/wahookickrheadwind/wahookickrheadwind.cpp \
@@ -93,12 +94,17 @@ windows_zwift_workout_paddleocr_thread.cpp \
 devices/ypooelliptical/ypooelliptical.cpp \
 devices/ziprotreadmill/ziprotreadmill.cpp \
 zwift_play/zwiftclickremote.cpp \
+zwift-api/ZwiftPlayerState.cpp \
+zwift-api/ZwiftRelay.cpp \
 devices/computrainerbike/Computrainer.cpp \
+latencyhistogram.cpp \
 PathController.cpp \
+characteristics/characteristicnotificationscheduler.cpp \
 characteristics/characteristicnotifier2a53.cpp \
 characteristics/characteristicnotifier2a5b.cpp \
 characteristics/characteristicnotifier2acc.cpp \
 characteristics/characteristicnotifier2acd.cpp \
+characteristics/characteristicnotifier2ad1.cpp \
 characteristics/characteristicnotifier2ad9.cpp \
 characteristics/characteristicwriteprocessor.cpp \
 characteristics/characteristicwriteprocessore005.cpp \
@@ -109,6 +115,7 @@ devices/lifefitnesstreadmill/lifefitnesstreadmill.cpp \
 devices/mepanelbike/mepanelbike.cpp \
 devices/nautilusbike/nautilusbike.cpp \
 devices/nordictrackelliptical/nordictrackelliptical.cpp \
+devices/ifitlogcat.cpp \
 devices/nordictrackifitadbbike/nordictrackifitadbbike.cpp \
 devices/nordictrackifitadbtreadmill/nordictrackifitadbtreadmill.cpp \
 devices/octaneelliptical/octaneelliptical.cpp \
@@ -135,8 +142,11 @@ qmdnsengine/src/src/service.cpp \
 devices/activiotreadmill/activiotreadmill.cpp \
 devices/bhfitnesselliptical/bhfitnesselliptical.cpp \
 devices/bike.cpp \
+devices/powersurface.cpp \
 devices/bluetooth.cpp \
+devices/bluetoothdevicematcher.cpp \
 devices/bluetoothdevice.cpp \
+devices/devicecontrolqueue.cpp \
 characteristics/characteristicnotifier2a37.cpp \
 characteristics/characteristicnotifier2a63.cpp \
 characteristics/characteristicnotifier2ad2.cpp \
@@ -190,8 +200,10 @@ fit-sdk/fit_protocol_validator.cpp \
 fit-sdk/fit_unicode.cpp \
 devices/flywheelbike/flywheelbike.cpp \
 devices/ftmsbike/ftmsbike.cpp \
+devices/ftmsdecoder.cpp \
 devices/ftmsrower/ftmsrower.cpp \
 gpx.cpp \
+gpxroute.cpp \
 devices/heartratebelt/heartratebelt.cpp \
 homefitnessbuddy.cpp \
 homeform.cpp \
@@ -212,17 +224,25 @@ devices/npecablebike/npecablebike.cpp \
 devices/pafersbike/pafersbike.cpp \
 devices/paferstreadmill/paferstreadmill.cpp \
 peloton.cpp \
+pelotoncache.cpp \
+powercurve.cpp \
 powerzonepack.cpp \
 devices/proformbike/proformbike.cpp \
 devices/proformelliptical/proformelliptical.cpp \
 devices/proformtreadmill/proformtreadmill.cpp \
 qfit.cpp \
+qfitjournal.cpp \
+fitdecoder.cpp \
+workouthistory.cpp \
+workoutlibrary.cpp \
 qzsettings.cpp \
+qzsettingssnapshot.cpp \
 devices/renphobike/renphobike.cpp \
 devices/rower.cpp \
 devices/schwinnic4bike/schwinnic4bike.cpp \
 screencapture.cpp \
 sessionline.cpp \
+sessionstore.cpp \
 devices/shuaa5treadmill/shuaa5treadmill.cpp \
 signalhandler.cpp \
 simplecrypt.cpp \
@@ -251,10 +271,12 @@ devices/sportstechbike/sportstechbike.cpp \
 devices/strydrunpowersensor/strydrunpowersensor.cpp \
 devices/tacxneo2/tacxneo2.cpp \
 tcpclientinfosender.cpp \
+telemetrysegment.cpp \
 devices/technogymmyruntreadmill/technogymmyruntreadmill.cpp \
 devices/technogymmyruntreadmillrfcomm/technogymmyruntreadmillrfcomm.cpp \
 templateinfosender.cpp \
 templateinfosenderbuilder.cpp \
+templatetelemetryfeed.cpp \
 devices/stagesbike/stagesbike.cpp \
 devices/toorxtreadmill/toorxtreadmill.cpp \
 devices/treadmill.cpp \
@@ -265,6 +287,8 @@ virtualdevices/virtualrower.cpp \
 devices/wahookickrsnapbike/wahookickrsnapbike.cpp \
 devices/yesoulbike/yesoulbike.cpp \
 trainprogram.cpp \
+trainprogramtimeline.cpp \
+trainprogramlookahead.cpp \
 devices/trxappgateusbtreadmill/trxappgateusbtreadmill.cpp \
 virtualdevices/virtualbike.cpp \
 virtualdevices/virtualtreadmill.cpp \
@@ -294,6 +318,8 @@ devices/proformtelnetbike/proformtelnetbike.h \
 windows_zwift_workout_paddleocr_thread.h \
 devices/fakerower/fakerower.h \
 zwift-api/PlayerStateWrapper.h \
+zwift-api/ZwiftPlayerState.h \
+zwift-api/ZwiftRelay.h \
 zwift-api/zwift_client_auth.h \
 zwift_play/abstractZapDevice.h \
 zwift_play/zapBleUuids.h \
@@ -308,17 +334,22 @@ devices/discoveryoptions.h \
 handleurl.h \
 devices/iconceptelliptical/iconceptelliptical.h \
 localipaddress.h \
+logwriter.h \
 devices/pelotonbike/pelotonbike.h \
 devices/schwinn170bike/schwinn170bike.h \
 devices/wahookickrheadwind/wahookickrheadwind.h \
 devices/ypooelliptical/ypooelliptical.h \
 devices/ziprotreadmill/ziprotreadmill.h \
 devices/computrainerbike/Computrainer.h \
+latencyhistogram.h \
+seqlock.h \
 PathController.h \
+characteristics/characteristicnotificationscheduler.h \
 characteristics/characteristicnotifier2a53.h \
 characteristics/characteristicnotifier2a5b.h \
 characteristics/characteristicnotifier2acc.h \
 characteristics/characteristicnotifier2acd.h \
+characteristics/characteristicnotifier2ad1.h \
 characteristics/characteristicnotifier2ad9.h \
 characteristics/characteristicwriteprocessore005.h \
 devices/computrainerbike/computrainerbike.h \
@@ -329,6 +360,7 @@ devices/lifefitnesstreadmill/lifefitnesstreadmill.h \
 devices/mepanelbike/mepanelbike.h \
 devices/nautilusbike/nautilusbike.h \
 devices/nordictrackelliptical/nordictrackelliptical.h \
+devices/ifitlogcat.h \
 devices/nordictrackifitadbbike/nordictrackifitadbbike.h \
 devices/nordictrackifitadbtreadmill/nordictrackifitadbtreadmill.h \
 devices/octaneelliptical/octaneelliptical.h \
@@ -367,8 +399,12 @@ qmdnsengine/src/src/service_p.h \
 devices/activiotreadmill/activiotreadmill.h \
 devices/bhfitnesselliptical/bhfitnesselliptical.h \
 devices/bike.h \
+devices/powersurface.h \
 devices/bluetooth.h \
+devices/bluetoothdevicematcher.h \
 devices/bluetoothdevice.h \
+devices/devicecontrolqueue.h \
+devices/devicetelemetry.h \
 characteristics/characteristicnotifier.h \
 characteristics/characteristicnotifier2a37.h \
 characteristics/characteristicnotifier2a63.h \
@@ -380,6 +416,7 @@ devices/bowflextreadmill/bowflextreadmill.h \
 devices/chronobike/chronobike.h \
 devices/concept2skierg/concept2skierg.h \
 devices/cscbike/cscbike.h \
+devices/dircon/dirconframebuffer.h \
 devices/dircon/dirconmanager.h \
 devices/dircon/dirconpacket.h \
 devices/dircon/dirconprocessor.h \
@@ -625,6 +662,7 @@ fit-sdk/fit_zones_target_mesg.hpp \
 fit-sdk/fit_zones_target_mesg_listener.hpp \
 devices/flywheelbike/flywheelbike.h \
 devices/ftmsbike/ftmsbike.h \
+devices/ftmsdecoder.h \
 devices/heartratebelt/heartratebelt.h \
 homeform.h \
 devices/horizontreadmill/horizontreadmill.h \
@@ -642,19 +680,28 @@ devices/npecablebike/npecablebike.h \
 devices/pafersbike/pafersbike.h \
 devices/paferstreadmill/paferstreadmill.h \
 peloton.h \
+pelotoncache.h \
+powercurve.h \
 powerzonepack.h \
 devices/proformbike/proformbike.h \
 devices/proformelliptical/proformelliptical.h \
 devices/proformtreadmill/proformtreadmill.h \
 qdebugfixup.h \
 qfit.h \
+qfitjournal.h \
+fitdecoder.h \
+workouthistory.h \
+workoutlibrary.h \
 qmdnsengine_export.h \
 qzsettings.h \
+qztelemetry.h \
+qzsettingssnapshot.h \
 devices/renphobike/renphobike.h \
 devices/rower.h \
 devices/schwinnic4bike/schwinnic4bike.h \
 screencapture.h \
 sessionline.h \
+sessionstore.h \
 devices/shuaa5treadmill/shuaa5treadmill.h \
 signalhandler.h \
 simplecrypt.h \
@@ -685,16 +732,21 @@ devices/sportstechbike/sportstechbike.h \
 devices/strydrunpowersensor/strydrunpowersensor.h \
 devices/tacxneo2/tacxneo2.h \
 tcpclientinfosender.h \
+telemetrysegment.h \
 devices/technogymmyruntreadmill/technogymmyruntreadmill.h \
 devices/technogymmyruntreadmillrfcomm/technogymmyruntreadmillrfcomm.h \
 templateinfosender.h \
 templateinfosenderbuilder.h \
+templatetelemetryfeed.h \
 devices/stagesbike/stagesbike.h \
 devices/toorxtreadmill/toorxtreadmill.h \
 gpx.h \
+gpxroute.h \
 devices/treadmill.h \
 mainwindow.h \
 trainprogram.h \
+trainprogramtimeline.h \
+trainprogramlookahead.h \
 devices/truetreadmill/truetreadmill.h \
 devices/trxappgateusbbike/trxappgateusbbike.h \
 devices/trxappgateusbtreadmill/trxappgateusbtreadmill.h \
@@ -740,7 +792,6 @@ DISTFILES += \
     $$PWD/android/src/WearableController.java \
     $$PWD/android/src/WearableMessageListenerService.java \
     $$PWD/android/src/ZapClickLayer.java \
-    $$PWD/android/src/ZwiftAPI.java \
     $$PWD/android/src/main/proto/zwift_messages.proto \
     .clang-format \
    AppxManifest.xml \
@@ -7,17 +7,15 @@
 #include "QSettings"
 
 #include "fit_date_time.hpp"
+#include "fit_developer_field.hpp"
 #include "fit_encode.hpp"
-
-#include "fit_decode.hpp"
-#include "fit_developer_field_description.hpp"
-#include "fit_mesg_broadcaster.hpp"
+#include "fitdecoder.h"
 
 using namespace std;
 
 qfit::qfit(QObject *parent) : QObject(parent) {}
 
-void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type,
+void qfit::save(const QString &filename, const SessionStore &session, bluetoothdevice::BLUETOOTH_TYPE type,
                 uint32_t processFlag, FIT_SPORT overrideSport, QString workoutName, QString bluetooth_device_name) {
     QSettings settings;
     bool strava_virtual_activity =
@@ -27,24 +25,27 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
             .value(QZSettings::powr_sensor_running_cadence_half_on_strava,
                    QZSettings::default_powr_sensor_running_cadence_half_on_strava)
             .toBool();
-    std::list<fit::RecordMesg> records;
     fit::Encode encode(fit::ProtocolVersion::V20);
     if (session.isEmpty()) {
         return;
     }
+    // the session is read in place, column by column
+    const SessionStore::SessionColumn<double> speed = session.speed();
+    const SessionStore::SessionColumn<uint8_t> cadence = session.cadence();
+    const SessionStore::SessionColumn<double> elevationGain = session.elevationGain();
+    const int lastIndex = session.length() - 1;
+    const SessionLine last = session.last();
     std::fstream file;
     uint32_t firstRealIndex = 0;
     for (int i = 0; i < session.length(); i++) {
-        if ((session.at(i).speed > 0 && (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL)) ||
-            (session.at(i).cadence > 0 && (type == bluetoothdevice::BIKE || type == bluetoothdevice::ROWING))) {
+        if ((speed[i] > 0 && (type == bluetoothdevice::TREADMILL || type == bluetoothdevice::ELLIPTICAL)) ||
+            (cadence[i] > 0 && (type == bluetoothdevice::BIKE || type == bluetoothdevice::ROWING))) {
             firstRealIndex = i;
             break;
         }
     }
-    double startingDistanceOffset = 0.0;
-    if (!session.isEmpty()) {
-        startingDistanceOffset = session.at(firstRealIndex).distance;
-    }
+    double startingDistanceOffset = session.distance()[firstRealIndex];
+    const qint64 firstRealTime = session.time(firstRealIndex).toSecsSinceEpoch();
 
     file.open(filename.toStdString(), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
 
@@ -65,7 +66,7 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
         fileIdMesg.SetManufacturer(FIT_MANUFACTURER_DEVELOPMENT);
     fileIdMesg.SetProduct(1);
     fileIdMesg.SetSerialNumber(12345);
-    fileIdMesg.SetTimeCreated(session.at(firstRealIndex).time.toSecsSinceEpoch() - 631065600L);
+    fileIdMesg.SetTimeCreated(firstRealTime - 631065600L);
 
     bool gps_data = false;
     double max_alt = 0;
@@ -74,28 +75,29 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     int speed_count = 0;
     double speed_avg = 0;
     for (int i = firstRealIndex; i < session.length(); i++) {
-        if (session.at(i).coordinate.isValid()) {
+        if (session.coordinate(i).isValid()) {
             gps_data = true;
             break;
         }
     }
     for (int i = firstRealIndex; i < session.length(); i++) {
         if (gps_data) {
-            if (session.at(i).coordinate.isValid()) {
-                if (min_alt > session.at(i).coordinate.altitude())
-                    min_alt = session.at(i).coordinate.altitude();
-                if (max_alt < session.at(i).coordinate.altitude())
-                    max_alt = session.at(i).coordinate.altitude();
+            QGeoCoordinate coordinate = session.coordinate(i);
+            if (coordinate.isValid()) {
+                if (min_alt > coordinate.altitude())
+                    min_alt = coordinate.altitude();
+                if (max_alt < coordinate.altitude())
+                    max_alt = coordinate.altitude();
             }
         } else {
             min_alt = 0;
-            if (max_alt < session.at(i).elevationGain)
-                max_alt = session.at(i).elevationGain;
+            if (max_alt < elevationGain[i])
+                max_alt = elevationGain[i];
         }
 
-        if (session.at(i).speed > 0) {
+        if (speed[i] > 0) {
             speed_count++;
-            speed_acc += session.at(i).speed;
+            speed_acc += speed[i];
         }
     }
 
@@ -105,14 +107,13 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     }
 
     fit::SessionMesg sessionMesg;
-    sessionMesg.SetTimestamp(session.at(firstRealIndex).time.toSecsSinceEpoch() - 631065600L);
-    sessionMesg.SetStartTime(session.at(firstRealIndex).time.toSecsSinceEpoch() - 631065600L);
-    sessionMesg.SetTotalElapsedTime(session.last().elapsedTime);
-    sessionMesg.SetTotalTimerTime(session.last().time.toSecsSinceEpoch() -
-                                  session.at(firstRealIndex).time.toSecsSinceEpoch());
-    sessionMesg.SetTotalDistance((session.last().distance - startingDistanceOffset) * 1000.0); // meters
-    sessionMesg.SetTotalCalories(session.last().calories);
-    sessionMesg.SetTotalMovingTime(session.last().elapsedTime);
+    sessionMesg.SetTimestamp(firstRealTime - 631065600L);
+    sessionMesg.SetStartTime(firstRealTime - 631065600L);
+    sessionMesg.SetTotalElapsedTime(last.elapsedTime);
+    sessionMesg.SetTotalTimerTime(last.time.toSecsSinceEpoch() - firstRealTime);
+    sessionMesg.SetTotalDistance((last.distance - startingDistanceOffset) * 1000.0); // meters
+    sessionMesg.SetTotalCalories(last.calories);
+    sessionMesg.SetTotalMovingTime(last.elapsedTime);
     sessionMesg.SetMinAltitude(min_alt);
     sessionMesg.SetMaxAltitude(max_alt);
     sessionMesg.SetEvent(FIT_EVENT_SESSION);
@@ -121,70 +122,20 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     sessionMesg.SetTrigger(FIT_SESSION_TRIGGER_ACTIVITY_END);
     sessionMesg.SetMessageIndex(FIT_MESSAGE_INDEX_RESERVED);
 
-    if (overrideSport != FIT_SPORT_INVALID) {
-        sessionMesg.SetSport(overrideSport);
-        sessionMesg.SetSubSport(FIT_SUB_SPORT_GENERIC);
-        qDebug() << "overriding FIT sport " << overrideSport;
-    } else if (type == bluetoothdevice::TREADMILL) {
-        sessionMesg.SetTotalStrides(session.last().stepCount);
-
-        if (speed_avg == 0 || speed_avg > 6.5)
-            sessionMesg.SetSport(FIT_SPORT_RUNNING);
-        else
-            sessionMesg.SetSport(FIT_SPORT_WALKING);
-
-        if (strava_virtual_activity) {
-            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
-        } else {
-            sessionMesg.SetSubSport(FIT_SUB_SPORT_TREADMILL);
-        }
-    } else if (type == bluetoothdevice::ELLIPTICAL) {
-
-        if (speed_avg == 0 || speed_avg > 6.5)
-            sessionMesg.SetSport(FIT_SPORT_RUNNING);
-        else
-            sessionMesg.SetSport(FIT_SPORT_WALKING);
-
-        if (strava_virtual_activity) {
-            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
-        } else {
-            sessionMesg.SetSubSport(FIT_SUB_SPORT_ELLIPTICAL);
-        }
-    } else if (type == bluetoothdevice::ROWING) {
+    setSessionSport(sessionMesg, last, type, overrideSport, speed_avg, strava_virtual_activity);
 
-        sessionMesg.SetSport(FIT_SPORT_ROWING);
-        sessionMesg.SetSubSport(FIT_SUB_SPORT_INDOOR_ROWING);
-        if (session.last().totalStrokes)
-            sessionMesg.SetTotalStrokes(session.last().totalStrokes);
-        if (session.last().avgStrokesRate)
-            sessionMesg.SetAvgStrokeCount(session.last().avgStrokesRate);
-        if (session.last().maxStrokesRate)
-            sessionMesg.SetMaxCadence(session.last().maxStrokesRate);
-        if (session.last().avgStrokesLength)
-            sessionMesg.SetAvgStrokeDistance(session.last().avgStrokesLength);
-    } else {
-
-        sessionMesg.SetSport(FIT_SPORT_CYCLING);
-        if (strava_virtual_activity) {
-            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
-        }
-    }
-
-    fit::DeveloperDataIdMesg devIdMesg;
-    for (FIT_UINT8 i = 0; i < 16; i++) {
-
-        devIdMesg.SetApplicationId(i, i);
-    }
-    devIdMesg.SetDeveloperDataIndex(0);
+    fit::DeveloperDataIdMesg devIdMesg = developerDataId();
+    std::vector<fit::FieldDescriptionMesg> powerCurveDescriptions = powerCurveFields();
+    setPowerCurve(sessionMesg, session.powerCurve(), devIdMesg, powerCurveDescriptions);
 
     fit::ActivityMesg activityMesg;
-    activityMesg.SetTimestamp(session.at(firstRealIndex).time.toSecsSinceEpoch() - 631065600L);
-    activityMesg.SetTotalTimerTime(session.last().elapsedTime);
+    activityMesg.SetTimestamp(firstRealTime - 631065600L);
+    activityMesg.SetTotalTimerTime(last.elapsedTime);
     activityMesg.SetNumSessions(1);
     activityMesg.SetType(FIT_ACTIVITY_MANUAL);
     activityMesg.SetEvent(FIT_EVENT_WORKOUT);
     activityMesg.SetEventType(FIT_EVENT_TYPE_START);
-    activityMesg.SetLocalTimestamp(fit::DateTime((time_t)session.last().time.toSecsSinceEpoch())
+    activityMesg.SetLocalTimestamp(fit::DateTime((time_t)last.time.toSecsSinceEpoch())
                                        .GetTimeStamp()); // seconds since 00:00 Dec d31 1989 in local time zone
     activityMesg.SetEvent(FIT_EVENT_ACTIVITY);
     activityMesg.SetEventType(FIT_EVENT_TYPE_STOP);
@@ -194,11 +145,14 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     eventMesg.SetEventType(FIT_EVENT_TYPE_START);
     eventMesg.SetData(0);
     eventMesg.SetEventGroup(0);
-    eventMesg.SetTimestamp(session.at(firstRealIndex).time.toSecsSinceEpoch() - 631065600L);
+    eventMesg.SetTimestamp(firstRealTime - 631065600L);
 
     encode.Open(file);
     encode.Write(fileIdMesg);
     encode.Write(devIdMesg);
+    for (const fit::FieldDescriptionMesg &description : powerCurveDescriptions) {
+        encode.Write(description);
+    }
 
     if (workoutName.length() > 0) {
         fit::TrainingFileMesg trainingFile;
@@ -228,7 +182,7 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
 
     encode.Write(eventMesg);
 
-    fit::DateTime date((time_t)session.first().time.toSecsSinceEpoch());
+    fit::DateTime date((time_t)session.time(0).toSecsSinceEpoch());
 
     fit::LapMesg lapMesg;
     lapMesg.SetIntensity(FIT_INTENSITY_ACTIVE);
@@ -239,37 +193,28 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_TIME);
     lapMesg.SetTotalElapsedTime(0);
     lapMesg.SetTotalTimerTime(0);
-    if (overrideSport != FIT_SPORT_INVALID) {
+    lapMesg.SetSport(lapSport(type, overrideSport));
 
-        lapMesg.SetSport(FIT_SPORT_GENERIC);
-    } else if (type == bluetoothdevice::TREADMILL) {
-
-        lapMesg.SetSport(FIT_SPORT_RUNNING);
-    } else if (type == bluetoothdevice::ELLIPTICAL) {
-
-        lapMesg.SetSport(FIT_SPORT_RUNNING);
-    } else {
-
-        lapMesg.SetSport(FIT_SPORT_CYCLING);
-    }
-
-    SessionLine sl;
+    // distances to export: the recorded ones, smoothed only if QFIT_PROCESS_DISTANCENOISE is requested
+    QVector<double> distances;
+    distances.reserve(session.length());
+    session.distance().forEach([&distances](double d) { distances.append(d); });
     if (processFlag & QFIT_PROCESS_DISTANCENOISE) {
         double distanceOld = -1.0;
         int startIdx = -1;
         for (int i = firstRealIndex; i < session.length(); i++) {
 
-            sl = session.at(i);
-            if (sl.distance != distanceOld || i == session.length() - 1) {
-                if (i == session.length() - 1 && sl.distance == distanceOld) {
+            double distance = session.distance()[i];
+            if (distance != distanceOld || i == lastIndex) {
+                if (i == lastIndex && distance == distanceOld) {
                     i++;
                 }
                 if (startIdx >= 0) {
                     for (int j = startIdx; j < i; j++) {
-                        session[j].distance += 0.1 * (j - startIdx) / (i - startIdx);
+                        distances[j] += 0.1 * (j - startIdx) / (i - startIdx);
                     }
                 }
-                distanceOld = sl.distance;
+                distanceOld = distance;
                 startIdx = i;
             }
         }
@@ -280,23 +225,10 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     for (int i = firstRealIndex; i < session.length(); i++) {
 
         fit::RecordMesg newRecord;
-        sl = session.at(i);
+        const SessionLine sl = session.at(i);
+        const double distance = distances.at(i);
         // fit::DateTime date((time_t)session.at(i).time.toSecsSinceEpoch());
-        newRecord.SetHeartRate(sl.heart);
-        uint8_t cad = sl.cadence;
-        if (powr_sensor_running_cadence_half_on_strava)
-            cad = cad / 2;
-        newRecord.SetCadence(cad);
-        newRecord.SetDistance((sl.distance - startingDistanceOffset) * 1000.0); // meters
-        newRecord.SetSpeed(sl.speed / 3.6);                                     // meter per second
-        newRecord.SetPower(sl.watt);
-        newRecord.SetResistance(sl.resistance);
-        newRecord.SetCalories(sl.calories);
-        if (type == bluetoothdevice::TREADMILL) {
-            newRecord.SetStepLength(sl.instantaneousStrideLengthCM * 10);
-            newRecord.SetVerticalOscillation(sl.verticalOscillationMM);
-            newRecord.SetStanceTime(sl.groundContactMS);
-        }
+        setRecord(newRecord, sl, distance - startingDistanceOffset, type, powr_sensor_running_cadence_half_on_strava);
 
         // if a gps track contains a point without the gps information, it has to be discarded, otherwise the database
         // structure is corrupted and 2 tracks are saved in the FIT file causing mapping issue.
@@ -304,14 +236,6 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
             continue;
         }
 
-        if (sl.coordinate.isValid()) {
-            newRecord.SetAltitude(sl.coordinate.altitude());
-            newRecord.SetPositionLat(pow(2, 31) * (sl.coordinate.latitude()) / 180.0);
-            newRecord.SetPositionLong(pow(2, 31) * (sl.coordinate.longitude()) / 180.0);
-        } else {
-            newRecord.SetAltitude(sl.elevationGain);
-        }
-
         // using just the start point as reference in order to avoid pause time
         // strava ignore the elapsed field
         // this workaround could leads an accuracy issue.
@@ -320,12 +244,12 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
 
         if (sl.lapTrigger) {
 
-            lapMesg.SetTotalDistance((sl.distance - lastLapOdometer) * 1000.0); // meters
+            lapMesg.SetTotalDistance((distance - lastLapOdometer) * 1000.0); // meters
             lapMesg.SetTotalElapsedTime(sl.elapsedTime - lastLapTimer);
             lapMesg.SetTotalTimerTime(sl.elapsedTime - lastLapTimer);
             lapMesg.SetEventType(FIT_EVENT_LAP);
             lastLapTimer = sl.elapsedTime;
-            lastLapOdometer = sl.distance;
+            lastLapOdometer = distance;
 
             encode.Write(lapMesg);
 
@@ -336,9 +260,9 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
         }
     }
 
-    lapMesg.SetTotalDistance((session.last().distance - lastLapOdometer) * 1000.0); // meters
-    lapMesg.SetTotalElapsedTime(session.last().elapsedTime - lastLapTimer);
-    lapMesg.SetTotalTimerTime(session.last().elapsedTime - lastLapTimer);
+    lapMesg.SetTotalDistance((distances.at(lastIndex) - lastLapOdometer) * 1000.0); // meters
+    lapMesg.SetTotalElapsedTime(last.elapsedTime - lastLapTimer);
+    lapMesg.SetTotalTimerTime(last.elapsedTime - lastLapTimer);
     lapMesg.SetEvent(FIT_EVENT_LAP);
     lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
     encode.Write(lapMesg);
@@ -356,260 +280,162 @@ void qfit::save(const QString &filename, QList<SessionLine> session, bluetoothde
     return;
 }
 
-class Listener : public fit::FileIdMesgListener,
-                 public fit::UserProfileMesgListener,
-                 public fit::MonitoringMesgListener,
-                 public fit::DeviceInfoMesgListener,
-                 public fit::MesgListener,
-                 public fit::DeveloperFieldDescriptionListener,
-                 public fit::RecordMesgListener {
-  public:
-    QList<SessionLine> *sessionOpening = nullptr;
-
-    static void PrintValues(const fit::FieldBase &field) {
-        for (FIT_UINT8 j = 0; j < (FIT_UINT8)field.GetNumValues(); j++) {
-            // std::wcout << L"       Val" << j << L": ";
-            switch (field.GetType()) {
-            // Get float 64 values for numeric types to receive values that have
-            // their scale and offset properly applied.
-            case FIT_BASE_TYPE_ENUM:
-            case FIT_BASE_TYPE_BYTE:
-            case FIT_BASE_TYPE_SINT8:
-            case FIT_BASE_TYPE_UINT8:
-            case FIT_BASE_TYPE_SINT16:
-            case FIT_BASE_TYPE_UINT16:
-            case FIT_BASE_TYPE_SINT32:
-            case FIT_BASE_TYPE_UINT32:
-            case FIT_BASE_TYPE_SINT64:
-            case FIT_BASE_TYPE_UINT64:
-            case FIT_BASE_TYPE_UINT8Z:
-            case FIT_BASE_TYPE_UINT16Z:
-            case FIT_BASE_TYPE_UINT32Z:
-            case FIT_BASE_TYPE_UINT64Z:
-            case FIT_BASE_TYPE_FLOAT32:
-            case FIT_BASE_TYPE_FLOAT64:
-                // std::wcout << field.GetFLOAT64Value(j);
-                break;
-            case FIT_BASE_TYPE_STRING:
-                // std::wcout << field.GetSTRINGValue(j);
-                break;
-            default:
-                break;
-            }
-            // std::wcout << L" " << field.GetUnits().c_str() << L"\n";;
-        }
-    }
-
-    void OnMesg(fit::Mesg &mesg) {
-        // printf("On Mesg:\n");
-        // std::wcout << L"   New Mesg: " << mesg.GetName().c_str() << L".  It has " << mesg.GetNumFields() << L"
-        // field(s) and " << mesg.GetNumDevFields() << " developer field(s).\n";
+namespace {
+// the peaks of the power curve written in the session message, as developer fields 0..n
+const struct {
+    int seconds;
+    const wchar_t *name;
+} powerCurvePeaks[] = {{5, L"peak_power_5s"}, {60, L"peak_power_1m"}, {300, L"peak_power_5m"}, {1200, L"peak_power_20m"}};
+} // namespace
 
-        for (FIT_UINT16 i = 0; i < (FIT_UINT16)mesg.GetNumFields(); i++) {
-            fit::Field *field = mesg.GetFieldByIndex(i);
-            // std::wcout << L"   Field" << i << " (" << field->GetName().c_str() << ") has " << field->GetNumValues()
-            // << L" value(s)\n";
-            PrintValues(*field);
-        }
+fit::DeveloperDataIdMesg qfit::developerDataId() {
+    fit::DeveloperDataIdMesg devIdMesg;
+    for (FIT_UINT8 i = 0; i < 16; i++) {
 
-        for (auto devField : mesg.GetDeveloperFields()) {
-            // std::wcout << L"   Developer Field(" << devField.GetName().c_str() << ") has " << devField.GetNumValues()
-            // << L" value(s)\n";
-            PrintValues(devField);
-        }
+        devIdMesg.SetApplicationId(i, i);
     }
+    devIdMesg.SetDeveloperDataIndex(0);
+    return devIdMesg;
+}
 
-    void OnMesg(fit::FileIdMesg &mesg) {
-        printf("File ID:\n");
-        if (mesg.IsTypeValid())
-            printf("   Type: %d\n", mesg.GetType());
-        if (mesg.IsManufacturerValid())
-            printf("   Manufacturer: %d\n", mesg.GetManufacturer());
-        if (mesg.IsProductValid())
-            printf("   Product: %d\n", mesg.GetProduct());
-        if (mesg.IsSerialNumberValid())
-            printf("   Serial Number: %u\n", mesg.GetSerialNumber());
-        if (mesg.IsNumberValid())
-            printf("   Number: %d\n", mesg.GetNumber());
+std::vector<fit::FieldDescriptionMesg> qfit::powerCurveFields() {
+    std::vector<fit::FieldDescriptionMesg> fields;
+    FIT_UINT8 number = 0;
+    for (const auto &peak : powerCurvePeaks) {
+        fit::FieldDescriptionMesg description;
+        description.SetDeveloperDataIndex(0);
+        description.SetFieldDefinitionNumber(number++);
+        description.SetFitBaseTypeId(FIT_FIT_BASE_TYPE_UINT16);
+        description.SetFieldName(0, peak.name);
+        description.SetUnits(0, L"watts");
+        description.SetNativeMesgNum(FIT_MESG_NUM_SESSION);
+        fields.push_back(description);
     }
+    return fields;
+}
 
-    void OnMesg(fit::UserProfileMesg &mesg) {
-        printf("User profile:\n");
-        if (mesg.IsFriendlyNameValid())
-            // std::wcout << L"   Friendly Name: " << mesg.GetFriendlyName().c_str() << L"\n";
-            if (mesg.GetGender() == FIT_GENDER_MALE)
-                printf("   Gender: Male\n");
-        if (mesg.GetGender() == FIT_GENDER_FEMALE)
-            printf("   Gender: Female\n");
-        if (mesg.IsAgeValid())
-            printf("   Age [years]: %d\n", mesg.GetAge());
-        if (mesg.IsWeightValid())
-            printf("   Weight [kg]: %0.2f\n", mesg.GetWeight());
+void qfit::setPowerCurve(fit::SessionMesg &sessionMesg, const PowerCurve &curve,
+                         const fit::DeveloperDataIdMesg &devIdMesg,
+                         const std::vector<fit::FieldDescriptionMesg> &fields) {
+    if (curve.best(1) < 0)
+        return;
+
+    sessionMesg.SetMaxPower((FIT_UINT16)curve.best(1));
+    for (size_t i = 0; i < fields.size(); i++) {
+        double peak = curve.best(powerCurvePeaks[i].seconds);
+        if (peak < 0)
+            continue;
+        fit::DeveloperField field(fields.at(i), devIdMesg);
+        field.SetUINT16Value((FIT_UINT16)peak);
+        sessionMesg.AddDeveloperField(field);
     }
+}
 
-    void OnMesg(fit::DeviceInfoMesg &mesg) {
-        printf("Device info:\n");
+void qfit::setSessionSport(fit::SessionMesg &sessionMesg, const SessionLine &last,
+                           bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport, double speed_avg,
+                           bool strava_virtual_activity) {
+    if (overrideSport != FIT_SPORT_INVALID) {
+        sessionMesg.SetSport(overrideSport);
+        sessionMesg.SetSubSport(FIT_SUB_SPORT_GENERIC);
+        qDebug() << "overriding FIT sport " << overrideSport;
+    } else if (type == bluetoothdevice::TREADMILL) {
+        sessionMesg.SetTotalStrides(last.stepCount);
 
-        if (mesg.IsTimestampValid())
-            printf("   Timestamp: %d\n", mesg.GetTimestamp());
+        if (speed_avg == 0 || speed_avg > 6.5)
+            sessionMesg.SetSport(FIT_SPORT_RUNNING);
+        else
+            sessionMesg.SetSport(FIT_SPORT_WALKING);
 
-        switch (mesg.GetBatteryStatus()) {
-        case FIT_BATTERY_STATUS_CRITICAL:
-            printf("   Battery status: Critical\n");
-            break;
-        case FIT_BATTERY_STATUS_GOOD:
-            printf("   Battery status: Good\n");
-            break;
-        case FIT_BATTERY_STATUS_LOW:
-            printf("   Battery status: Low\n");
-            break;
-        case FIT_BATTERY_STATUS_NEW:
-            printf("   Battery status: New\n");
-            break;
-        case FIT_BATTERY_STATUS_OK:
-            printf("   Battery status: OK\n");
-            break;
-        default:
-            printf("   Battery status: Invalid\n");
-            break;
+        if (strava_virtual_activity) {
+            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
+        } else {
+            sessionMesg.SetSubSport(FIT_SUB_SPORT_TREADMILL);
         }
-    }
+    } else if (type == bluetoothdevice::ELLIPTICAL) {
 
-    void OnMesg(fit::MonitoringMesg &mesg) {
-        printf("Monitoring:\n");
+        if (speed_avg == 0 || speed_avg > 6.5)
+            sessionMesg.SetSport(FIT_SPORT_RUNNING);
+        else
+            sessionMesg.SetSport(FIT_SPORT_WALKING);
 
-        if (mesg.IsTimestampValid()) {
-            printf("   Timestamp: %d\n", mesg.GetTimestamp());
+        if (strava_virtual_activity) {
+            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
+        } else {
+            sessionMesg.SetSubSport(FIT_SUB_SPORT_ELLIPTICAL);
         }
+    } else if (type == bluetoothdevice::ROWING) {
 
-        if (mesg.IsActivityTypeValid()) {
-            printf("   Activity type: %d\n", mesg.GetActivityType());
-        }
+        sessionMesg.SetSport(FIT_SPORT_ROWING);
+        sessionMesg.SetSubSport(FIT_SUB_SPORT_INDOOR_ROWING);
+        if (last.totalStrokes)
+            sessionMesg.SetTotalStrokes(last.totalStrokes);
+        if (last.avgStrokesRate)
+            sessionMesg.SetAvgStrokeCount(last.avgStrokesRate);
+        if (last.maxStrokesRate)
+            sessionMesg.SetMaxCadence(last.maxStrokesRate);
+        if (last.avgStrokesLength)
+            sessionMesg.SetAvgStrokeDistance(last.avgStrokesLength);
+    } else {
 
-        switch (mesg.GetActivityType()) // The Cycling field is dynamic
-        {
-        case FIT_ACTIVITY_TYPE_WALKING:
-        case FIT_ACTIVITY_TYPE_RUNNING: // Intentional fallthrough
-            if (mesg.IsStepsValid()) {
-                printf("   Steps: %d\n", mesg.GetSteps());
-            }
-            break;
-        case FIT_ACTIVITY_TYPE_CYCLING:
-        case FIT_ACTIVITY_TYPE_SWIMMING: // Intentional fallthrough
-            if (mesg.IsStrokesValid()) {
-                printf("Strokes: %d\n", mesg.GetStrokes());
-            }
-            break;
-        default:
-            if (mesg.IsCyclesValid()) {
-                printf("Cycles: %d\n", mesg.GetCycles());
-            }
-            break;
+        sessionMesg.SetSport(FIT_SPORT_CYCLING);
+        if (strava_virtual_activity) {
+            sessionMesg.SetSubSport(FIT_SUB_SPORT_VIRTUAL_ACTIVITY);
         }
     }
+}
 
-    static void PrintOverrideValues(const fit::Mesg &mesg, FIT_UINT8 fieldNum) {
-        std::vector<const fit::FieldBase *> fields = mesg.GetOverrideFields(fieldNum);
-        const fit::Profile::FIELD *profileField = fit::Profile::GetField(mesg.GetNum(), fieldNum);
-        FIT_BOOL namePrinted = FIT_FALSE;
+FIT_SPORT qfit::lapSport(bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport) {
+    if (overrideSport != FIT_SPORT_INVALID) {
 
-        for (const fit::FieldBase *field : fields) {
-            if (!namePrinted) {
-                printf("   %s:\n", profileField->name.c_str());
-                namePrinted = FIT_TRUE;
-            }
+        return FIT_SPORT_GENERIC;
+    } else if (type == bluetoothdevice::TREADMILL) {
 
-            if (FIT_NULL != dynamic_cast<const fit::Field *>(field)) {
-                // Native Field
-                printf("      native: ");
-            } else {
-                // Developer Field
-                printf("      override: ");
-            }
+        return FIT_SPORT_RUNNING;
+    } else if (type == bluetoothdevice::ELLIPTICAL) {
 
-            switch (field->GetType()) {
-            // Get float 64 values for numeric types to receive values that have
-            // their scale and offset properly applied.
-            case FIT_BASE_TYPE_ENUM:
-            case FIT_BASE_TYPE_BYTE:
-            case FIT_BASE_TYPE_SINT8:
-            case FIT_BASE_TYPE_UINT8:
-            case FIT_BASE_TYPE_SINT16:
-            case FIT_BASE_TYPE_UINT16:
-            case FIT_BASE_TYPE_SINT32:
-            case FIT_BASE_TYPE_UINT32:
-            case FIT_BASE_TYPE_SINT64:
-            case FIT_BASE_TYPE_UINT64:
-            case FIT_BASE_TYPE_UINT8Z:
-            case FIT_BASE_TYPE_UINT16Z:
-            case FIT_BASE_TYPE_UINT32Z:
-            case FIT_BASE_TYPE_UINT64Z:
-            case FIT_BASE_TYPE_FLOAT32:
-            case FIT_BASE_TYPE_FLOAT64:
-                printf("%f\n", field->GetFLOAT64Value());
-                break;
-            case FIT_BASE_TYPE_STRING:
-                printf("%ls\n", field->GetSTRINGValue().c_str());
-                break;
-            default:
-                break;
-            }
-        }
+        return FIT_SPORT_RUNNING;
+    } else {
+
+        return FIT_SPORT_CYCLING;
     }
+}
 
-    void OnMesg(fit::RecordMesg &record) override {
-        if (sessionOpening != nullptr) {
-            SessionLine s;
-            s.heart = record.GetHeartRate();
-            s.cadence = record.GetCadence();
-            s.distance = record.GetDistance() / 1000;
-            s.speed = record.GetSpeed() * 3.6;
-            s.watt = record.GetPower();
-            s.resistance = record.GetResistance();
-            s.calories = record.GetCalories();
-            s.instantaneousStrideLengthCM = record.GetStepLength() / 10;
-            s.verticalOscillationMM = record.GetVerticalOscillation();
-            s.groundContactMS = record.GetStanceTime();
-            s.coordinate.setAltitude(record.GetAltitude());
-            s.coordinate.setLatitude((record.GetPositionLat() * 180) / pow(2, 31));
-            s.coordinate.setLongitude((record.GetPositionLong() * 180) / pow(2, 31));
-            if (!s.coordinate.isValid()) {
-                s.elevationGain = record.GetAltitude();
-            }
-            s.time = QDateTime::fromSecsSinceEpoch(record.GetTimestamp());
-            sessionOpening->append(s);
-        }
+void qfit::setRecord(fit::RecordMesg &newRecord, const SessionLine &sl, double distance,
+                     bluetoothdevice::BLUETOOTH_TYPE type, bool powr_sensor_running_cadence_half_on_strava) {
+    newRecord.SetHeartRate(sl.heart);
+    uint8_t cad = sl.cadence;
+    if (powr_sensor_running_cadence_half_on_strava)
+        cad = cad / 2;
+    newRecord.SetCadence(cad);
+    newRecord.SetDistance(distance * 1000.0); // meters
+    newRecord.SetSpeed(sl.speed / 3.6);       // meter per second
+    newRecord.SetPower(sl.watt);
+    newRecord.SetResistance(sl.resistance);
+    newRecord.SetCalories(sl.calories);
+    if (type == bluetoothdevice::TREADMILL) {
+        newRecord.SetStepLength(sl.instantaneousStrideLengthCM * 10);
+        newRecord.SetVerticalOscillation(sl.verticalOscillationMM);
+        newRecord.SetStanceTime(sl.groundContactMS);
     }
 
-    void OnDeveloperFieldDescription(const fit::DeveloperFieldDescription &desc) override {
-        printf("New Developer Field Description\n");
-        printf("   App Version: %d\n", desc.GetApplicationVersion());
-        printf("   Field Number: %d\n", desc.GetFieldDefinitionNumber());
+    if (sl.coordinate.isValid()) {
+        newRecord.SetAltitude(sl.coordinate.altitude());
+        newRecord.SetPositionLat(pow(2, 31) * (sl.coordinate.latitude()) / 180.0);
+        newRecord.SetPositionLong(pow(2, 31) * (sl.coordinate.longitude()) / 180.0);
+    } else {
+        newRecord.SetAltitude(sl.elevationGain);
     }
-};
+}
 
 void qfit::open(const QString &filename, QList<SessionLine> *output) {
-    std::fstream file;
-    file.open(filename.toStdString(), std::ios::in);
-
-    if (!file.is_open()) {
-
-        std::system_error(errno, std::system_category(), "failed to open " + filename.toStdString());
-        qDebug() << "opened " << filename << errno;
-        printf("Error opening file ExampleActivity.fit\n");
+    fitrecords records;
+    if (!fitdecoder::decodeFile(filename, &records)) {
+        qDebug() << "open" << filename << "failed";
         return;
     }
 
-    fit::Decode decode;
-    std::istream &s = file;
-    fit::MesgBroadcaster mesgBroadcaster;
-    Listener listener;
-    listener.sessionOpening = output;
-    mesgBroadcaster.AddListener((fit::FileIdMesgListener &)listener);
-    mesgBroadcaster.AddListener((fit::UserProfileMesgListener &)listener);
-    mesgBroadcaster.AddListener((fit::MonitoringMesgListener &)listener);
-    mesgBroadcaster.AddListener((fit::DeviceInfoMesgListener &)listener);
-    mesgBroadcaster.AddListener((fit::RecordMesgListener &)listener);
-    mesgBroadcaster.AddListener((fit::MesgListener &)listener);
-    decode.Read(&s, &mesgBroadcaster, &mesgBroadcaster, &listener);
+    output->reserve(output->count() + records.count());
+    for (int i = 0; i < records.count(); i++) {
+        output->append(records.line(i));
+    }
 }
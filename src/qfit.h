@@ -2,8 +2,13 @@
 #define QFIT_H
 
 #include "devices/bluetoothdevice.h"
+#include "fit_developer_data_id_mesg.hpp"
+#include "fit_field_description_mesg.hpp"
 #include "fit_profile.hpp"
+#include "fit_record_mesg.hpp"
+#include "fit_session_mesg.hpp"
 #include "sessionline.h"
+#include "sessionstore.h"
 #include <QFile>
 #include <QGeoCoordinate>
 #include <QObject>
@@ -16,9 +21,29 @@ class qfit : public QObject {
     Q_OBJECT
   public:
     explicit qfit(QObject *parent = nullptr);
-    static void save(const QString &filename, QList<SessionLine> session, bluetoothdevice::BLUETOOTH_TYPE type,
+    static void save(const QString &filename, const SessionStore &session, bluetoothdevice::BLUETOOTH_TYPE type,
                      uint32_t processFlag = QFIT_PROCESS_NONE, FIT_SPORT overrideSport = FIT_SPORT_INVALID, QString workoutName = "", QString bluetooth_device_name = "");
     static void open(const QString &filename, QList<SessionLine>* output);
+
+    /**
+     * @brief Helpers shared by save() and qfitjournal, so that both produce the same messages.
+     */
+    static void setSessionSport(fit::SessionMesg &sessionMesg, const SessionLine &last,
+                                bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport, double speed_avg,
+                                bool strava_virtual_activity);
+    static FIT_SPORT lapSport(bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport);
+    static void setRecord(fit::RecordMesg &newRecord, const SessionLine &sl, double distance,
+                          bluetoothdevice::BLUETOOTH_TYPE type, bool powr_sensor_running_cadence_half_on_strava);
+    static fit::DeveloperDataIdMesg developerDataId();
+
+    /**
+     * @brief The max power and the peaks of the power curve (5s, 1m, 5m, 20m) go in the session message; the peaks are
+     * developer fields, so the descriptions returned by powerCurveFields() must be written before the session.
+     */
+    static std::vector<fit::FieldDescriptionMesg> powerCurveFields();
+    static void setPowerCurve(fit::SessionMesg &sessionMesg, const PowerCurve &curve,
+                              const fit::DeveloperDataIdMesg &devIdMesg,
+                              const std::vector<fit::FieldDescriptionMesg> &fields);
     
   signals:
 };
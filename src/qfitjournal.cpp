@@ -0,0 +1,497 @@
+#include "qfitjournal.h"
+#include "qdebugfixup.h"
+#include "qfit.h"
+#include "qzsettings.h"
+
+#include <QDebug>
+#include <QDir>
+#include <QRunnable>
+#include <QSettings>
+#include <QThreadPool>
+#include <cstring>
+
+#include "fit_activity_mesg.hpp"
+#include "fit_crc.hpp"
+#include "fit_date_time.hpp"
+#include "fit_event_mesg.hpp"
+#include "fit_file_id_mesg.hpp"
+#include "fit_record_mesg.hpp"
+#include "fit_session_mesg.hpp"
+
+namespace {
+
+// The FIT CRC is linear: feeding n zero bytes to a CRC state is a 16x16 matrix over GF(2), applied to the state.
+// As in zlib's crc32_combine, the matrix for n bytes is built by repeated squaring, in O(log n).
+quint16 gf2MatrixTimes(const quint16 *mat, quint16 vec) {
+    quint16 sum = 0;
+    for (int i = 0; vec; i++, vec >>= 1) {
+        if (vec & 1)
+            sum ^= mat[i];
+    }
+    return sum;
+}
+
+void gf2MatrixSquare(quint16 *square, const quint16 *mat) {
+    for (int i = 0; i < 16; i++)
+        square[i] = gf2MatrixTimes(mat, mat[i]);
+}
+
+/**
+ * @brief Length in bytes of the complete messages at the start of data, following the message definitions.
+ */
+quint32 completeMessagesLength(const uchar *data, quint32 length) {
+    int sizes[FIT_MAX_LOCAL_MESGS];
+    for (int i = 0; i < FIT_MAX_LOCAL_MESGS; i++)
+        sizes[i] = -1;
+
+    quint32 pos = 0;
+    while (pos < length) {
+        const uchar h = data[pos];
+        quint32 next;
+        if (h & FIT_HDR_TIME_REC_BIT) {
+            const int local = (h & FIT_HDR_TIME_TYPE_MASK) >> FIT_HDR_TIME_TYPE_SHIFT;
+            if (sizes[local] < 0)
+                break;
+            next = pos + 1 + sizes[local];
+        } else if (h & FIT_HDR_TYPE_DEF_BIT) {
+            // header, reserved, architecture, global message number (2), number of fields, then 3 bytes per field
+            if (pos + 6 > length || data[pos + 1] != 0 || data[pos + 2] > 1)
+                break;
+            const int fields = data[pos + 5];
+            next = pos + 6 + 3 * fields;
+            if (next > length)
+                break;
+            int size = 0;
+            for (int f = 0; f < fields; f++)
+                size += data[pos + 6 + 3 * f + 1];
+            if (h & FIT_HDR_DEV_FIELD_BIT) {
+                if (next + 1 > length)
+                    break;
+                const int devFields = data[next];
+                const quint32 devStart = next + 1;
+                next = devStart + 3 * devFields;
+                if (next > length)
+                    break;
+                for (int f = 0; f < devFields; f++)
+                    size += data[devStart + 3 * f + 1];
+            }
+            sizes[h & FIT_HDR_TYPE_MASK] = size;
+        } else {
+            const int local = h & FIT_HDR_TYPE_MASK;
+            if (sizes[local] < 0)
+                break;
+            next = pos + 1 + sizes[local];
+        }
+        if (next > length)
+            break;
+        pos = next;
+    }
+    return pos;
+}
+
+// repairs the journals of a directory that need it, away from the GUI thread
+class repairTask : public QRunnable {
+  public:
+    repairTask(const QString &directory, const QString &nameFilter, const QString &skip)
+        : directory(directory), nameFilter(nameFilter), skip(skip) {}
+
+    void run() override {
+        const QDir dir(directory);
+        const QStringList journals = dir.entryList(QStringList() << nameFilter, QDir::Files);
+        for (const QString &journal : journals) {
+            if (journal != skip && qfitjournal::needsRepair(dir.filePath(journal)))
+                qfitjournal::repair(dir.filePath(journal));
+        }
+    }
+
+  private:
+    QString directory;
+    QString nameFilter;
+    QString skip;
+};
+
+} // namespace
+
+qfitjournal::qfitjournal() { reset(); }
+
+qfitjournal::~qfitjournal() {
+    // every append() ends with a checkpoint, so the file is already valid
+    if (m_file.isOpen())
+        m_file.close();
+}
+
+quint16 qfitjournal::crcCombine(quint16 crcA, quint16 crcB, quint64 lengthB) {
+    quint16 odd[16];
+    quint16 even[16];
+
+    // one zero byte
+    for (int i = 0; i < 16; i++)
+        odd[i] = fit::CRC::Get16(1 << i, 0);
+
+    while (lengthB) {
+        if (lengthB & 1)
+            crcA = gf2MatrixTimes(odd, crcA);
+        lengthB >>= 1;
+        if (!lengthB)
+            break;
+        gf2MatrixSquare(even, odd);
+        memcpy(odd, even, sizeof(odd));
+    }
+    return crcA ^ crcB;
+}
+
+QByteArray qfitjournal::header(quint32 dataSize) {
+    FIT_FILE_HDR file_header;
+    file_header.header_size = FIT_FILE_HDR_SIZE;
+    file_header.profile_version = FIT_PROFILE_VERSION;
+    file_header.protocol_version = FIT_PROTOCOL_VERSION;
+    memcpy((FIT_UINT8 *)&file_header.data_type, ".FIT", 4);
+    file_header.data_size = dataSize;
+    file_header.crc = fit::CRC::Calc16(&file_header, FIT_STRUCT_OFFSET(crc, FIT_FILE_HDR));
+    return QByteArray((const char *)&file_header, FIT_FILE_HDR_SIZE);
+}
+
+void qfitjournal::reset() {
+    for (FIT_UINT8 i = 0; i < FIT_MAX_LOCAL_MESGS; ++i) {
+        m_lastMesgDefinition[i].SetNum(FIT_MESG_NUM_INVALID);
+        m_lastMesgDefinition[i].SetLocalNum(i);
+        m_lastMesgDefinition[i].ClearFields();
+    }
+    m_pending.str(std::string());
+    m_pending.clear();
+    m_dataSize = 0;
+    m_dataCrc = 0;
+
+    m_samples = 0;
+    m_started = false;
+    m_finalized = false;
+    m_date = 0;
+    m_firstRealTime = 0;
+    m_startingDistanceOffset = 0;
+    m_gpsData = false;
+    m_gpsMinAltitude = 99999;
+    m_gpsMaxAltitude = 0;
+    m_maxElevationGain = 0;
+    m_speedAcc = 0;
+    m_speedCount = 0;
+    m_lastLapTimer = 0;
+    m_lastLapOdometer = 0;
+    m_lapMesg = fit::LapMesg();
+}
+
+bool qfitjournal::open(const QString &filename, bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport,
+                       const QString &bluetooth_device_name) {
+    close();
+
+    QSettings settings;
+    m_stravaVirtualActivity =
+        settings.value(QZSettings::strava_virtual_activity, QZSettings::default_strava_virtual_activity).toBool();
+    m_halfCadence = settings
+                        .value(QZSettings::powr_sensor_running_cadence_half_on_strava,
+                               QZSettings::default_powr_sensor_running_cadence_half_on_strava)
+                        .toBool();
+    m_type = type;
+    m_overrideSport = overrideSport;
+    m_deviceName = bluetooth_device_name;
+
+    m_file.setFileName(filename);
+    if (!m_file.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        qDebug() << QStringLiteral("qfitjournal: unable to open") << filename << m_file.errorString();
+        return false;
+    }
+    return checkpoint();
+}
+
+void qfitjournal::close() {
+    if (m_file.isOpen())
+        m_file.close();
+    reset();
+}
+
+void qfitjournal::write(const fit::Mesg &mesg) {
+    fit::MesgDefinition mesgDefinition(mesg);
+    fit::MesgDefinition &last = m_lastMesgDefinition[mesg.GetLocalNum()];
+
+    if (!last.Supports(mesgDefinition)) {
+        mesgDefinition.Write(m_pending);
+        last = mesgDefinition;
+    }
+    mesg.Write(m_pending, &last);
+}
+
+void qfitjournal::writePreamble(const SessionStore &session, int firstRealIndex) {
+    fit::FileIdMesg fileIdMesg; // Every FIT file requires a File ID message
+    fileIdMesg.SetType(FIT_FILE_ACTIVITY);
+    if (m_deviceName.toUpper().startsWith(QStringLiteral("DOMYOS")))
+        fileIdMesg.SetManufacturer(FIT_MANUFACTURER_DECATHLON);
+    else
+        fileIdMesg.SetManufacturer(FIT_MANUFACTURER_DEVELOPMENT);
+    fileIdMesg.SetProduct(1);
+    fileIdMesg.SetSerialNumber(12345);
+    fileIdMesg.SetTimeCreated(m_firstRealTime - 631065600L);
+    write(fileIdMesg);
+
+    write(qfit::developerDataId());
+
+    fit::EventMesg eventMesg;
+    eventMesg.SetEvent(FIT_EVENT_TIMER);
+    eventMesg.SetEventType(FIT_EVENT_TYPE_START);
+    eventMesg.SetData(0);
+    eventMesg.SetEventGroup(0);
+    eventMesg.SetTimestamp(m_firstRealTime - 631065600L);
+    write(eventMesg);
+
+    m_date = fit::DateTime((time_t)session.time(0).toSecsSinceEpoch()).GetTimeStamp();
+
+    m_lapMesg.SetIntensity(FIT_INTENSITY_ACTIVE);
+    m_lapMesg.SetStartTime(m_date + firstRealIndex);
+    m_lapMesg.SetTimestamp(m_date + firstRealIndex);
+    m_lapMesg.SetEvent(FIT_EVENT_WORKOUT);
+    m_lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+    m_lapMesg.SetLapTrigger(FIT_LAP_TRIGGER_TIME);
+    m_lapMesg.SetTotalElapsedTime(0);
+    m_lapMesg.SetTotalTimerTime(0);
+    m_lapMesg.SetSport(qfit::lapSport(m_type, m_overrideSport));
+}
+
+void qfitjournal::encodeSample(const SessionStore &session, int i) {
+    if (!m_started) {
+        // like the firstRealIndex of qfit::save, the file starts with the first moving sample
+        if (!((session.speed()[i] > 0 && (m_type == bluetoothdevice::TREADMILL || m_type == bluetoothdevice::ELLIPTICAL)) ||
+              (session.cadence()[i] > 0 && (m_type == bluetoothdevice::BIKE || m_type == bluetoothdevice::ROWING))))
+            return;
+
+        m_started = true;
+        m_firstRealTime = session.time(i).toSecsSinceEpoch();
+        m_startingDistanceOffset = session.distance()[i];
+        writePreamble(session, i);
+    }
+
+    const SessionLine sl = session.at(i);
+    if (sl.coordinate.isValid()) {
+        m_gpsData = true;
+        if (m_gpsMinAltitude > sl.coordinate.altitude())
+            m_gpsMinAltitude = sl.coordinate.altitude();
+        if (m_gpsMaxAltitude < sl.coordinate.altitude())
+            m_gpsMaxAltitude = sl.coordinate.altitude();
+    }
+    if (m_maxElevationGain < sl.elevationGain)
+        m_maxElevationGain = sl.elevationGain;
+    if (sl.speed > 0) {
+        m_speedCount++;
+        m_speedAcc += sl.speed;
+    }
+
+    // see qfit::save: a record without GPS data in a GPS track would split the track
+    if (!sl.coordinate.isValid() && m_gpsData) {
+        return;
+    }
+
+    fit::RecordMesg newRecord;
+    qfit::setRecord(newRecord, sl, sl.distance - m_startingDistanceOffset, m_type, m_halfCadence);
+    newRecord.SetTimestamp(m_date + i);
+    write(newRecord);
+
+    if (sl.lapTrigger) {
+
+        m_lapMesg.SetTotalDistance((sl.distance - m_lastLapOdometer) * 1000.0); // meters
+        m_lapMesg.SetTotalElapsedTime(sl.elapsedTime - m_lastLapTimer);
+        m_lapMesg.SetTotalTimerTime(sl.elapsedTime - m_lastLapTimer);
+        m_lapMesg.SetEventType(FIT_EVENT_LAP);
+        m_lastLapTimer = sl.elapsedTime;
+        m_lastLapOdometer = sl.distance;
+
+        write(m_lapMesg);
+
+        m_lapMesg.SetStartTime(m_date + i);
+        m_lapMesg.SetTimestamp(m_date + i);
+        m_lapMesg.SetEvent(FIT_EVENT_WORKOUT);
+        m_lapMesg.SetEventType(FIT_EVENT_LAP);
+    }
+}
+
+bool qfitjournal::append(const SessionStore &session) {
+    if (!m_file.isOpen() || m_finalized)
+        return false;
+    if (session.count() < m_samples) {
+        qDebug() << QStringLiteral("qfitjournal: the session has been cleared, the journal needs to be reopened");
+        return false;
+    }
+
+    for (; m_samples < session.count(); m_samples++) {
+        encodeSample(session, m_samples);
+    }
+    return checkpoint();
+}
+
+bool qfitjournal::checkpoint() {
+    const std::string pending = m_pending.str();
+    m_pending.str(std::string());
+    m_pending.clear();
+
+    if (!pending.empty()) {
+        for (std::string::size_type i = 0; i < pending.size(); i++)
+            m_dataCrc = fit::CRC::Get16(m_dataCrc, (FIT_UINT8)pending[i]);
+
+        // the new messages overwrite the CRC of the previous checkpoint
+        if (!m_file.seek(FIT_FILE_HDR_SIZE + m_dataSize) ||
+            m_file.write(pending.data(), pending.size()) != (qint64)pending.size()) {
+            qDebug() << QStringLiteral("qfitjournal: write failed") << m_file.errorString();
+            return false;
+        }
+        m_dataSize += pending.size();
+        m_file.flush();
+    }
+
+    // CRC before header: a valid header always describes data followed by its CRC
+    const QByteArray fileHeader = header(m_dataSize);
+    const quint16 crc = crcCombine(fit::CRC::Calc16(fileHeader.constData(), FIT_FILE_HDR_SIZE), m_dataCrc, m_dataSize);
+    const char crcBytes[2] = {(char)(crc & 0xFF), (char)(crc >> 8)};
+    if (!m_file.seek(FIT_FILE_HDR_SIZE + m_dataSize) || m_file.write(crcBytes, 2) != 2) {
+        qDebug() << QStringLiteral("qfitjournal: write failed") << m_file.errorString();
+        return false;
+    }
+    m_file.flush();
+    if (!m_file.seek(0) || m_file.write(fileHeader) != FIT_FILE_HDR_SIZE) {
+        qDebug() << QStringLiteral("qfitjournal: write failed") << m_file.errorString();
+        return false;
+    }
+    return m_file.flush();
+}
+
+bool qfitjournal::finalize(const SessionStore &session) {
+    if (!append(session))
+        return false;
+
+    if (!m_started || session.isEmpty()) {
+        // no moving sample: nothing to summarize, the journal stays an empty activity
+        m_file.close();
+        m_finalized = true;
+        return true;
+    }
+
+    const SessionLine last = session.last();
+    double speed_avg = 0;
+    if (m_speedCount > 0)
+        speed_avg = m_speedAcc / ((double)m_speedCount);
+
+    m_lapMesg.SetTotalDistance((last.distance - m_lastLapOdometer) * 1000.0); // meters
+    m_lapMesg.SetTotalElapsedTime(last.elapsedTime - m_lastLapTimer);
+    m_lapMesg.SetTotalTimerTime(last.elapsedTime - m_lastLapTimer);
+    m_lapMesg.SetEvent(FIT_EVENT_LAP);
+    m_lapMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+    write(m_lapMesg);
+
+    fit::SessionMesg sessionMesg;
+    sessionMesg.SetTimestamp(m_firstRealTime - 631065600L);
+    sessionMesg.SetStartTime(m_firstRealTime - 631065600L);
+    sessionMesg.SetTotalElapsedTime(last.elapsedTime);
+    sessionMesg.SetTotalTimerTime(last.time.toSecsSinceEpoch() - m_firstRealTime);
+    sessionMesg.SetTotalDistance((last.distance - m_startingDistanceOffset) * 1000.0); // meters
+    sessionMesg.SetTotalCalories(last.calories);
+    sessionMesg.SetTotalMovingTime(last.elapsedTime);
+    sessionMesg.SetMinAltitude(m_gpsData ? m_gpsMinAltitude : 0);
+    sessionMesg.SetMaxAltitude(m_gpsData ? m_gpsMaxAltitude : m_maxElevationGain);
+    sessionMesg.SetEvent(FIT_EVENT_SESSION);
+    sessionMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+    sessionMesg.SetFirstLapIndex(0);
+    sessionMesg.SetTrigger(FIT_SESSION_TRIGGER_ACTIVITY_END);
+    sessionMesg.SetMessageIndex(FIT_MESSAGE_INDEX_RESERVED);
+    qfit::setSessionSport(sessionMesg, last, m_type, m_overrideSport, speed_avg, m_stravaVirtualActivity);
+    const std::vector<fit::FieldDescriptionMesg> powerCurveDescriptions = qfit::powerCurveFields();
+    for (const fit::FieldDescriptionMesg &description : powerCurveDescriptions) {
+        write(description);
+    }
+    qfit::setPowerCurve(sessionMesg, session.powerCurve(), qfit::developerDataId(), powerCurveDescriptions);
+    write(sessionMesg);
+
+    fit::ActivityMesg activityMesg;
+    activityMesg.SetTimestamp(m_firstRealTime - 631065600L);
+    activityMesg.SetTotalTimerTime(last.elapsedTime);
+    activityMesg.SetNumSessions(1);
+    activityMesg.SetType(FIT_ACTIVITY_MANUAL);
+    activityMesg.SetLocalTimestamp(fit::DateTime((time_t)last.time.toSecsSinceEpoch())
+                                       .GetTimeStamp()); // seconds since 00:00 Dec d31 1989 in local time zone
+    activityMesg.SetEvent(FIT_EVENT_ACTIVITY);
+    activityMesg.SetEventType(FIT_EVENT_TYPE_STOP);
+    write(activityMesg);
+
+    const bool ret = checkpoint();
+    m_file.close();
+    m_finalized = true;
+    return ret;
+}
+
+bool qfitjournal::needsRepair(const QString &filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    char bytes[FIT_FILE_HDR_SIZE];
+    if (file.read(bytes, FIT_FILE_HDR_SIZE) != FIT_FILE_HDR_SIZE) {
+        return false;
+    }
+    FIT_FILE_HDR file_header;
+    memcpy(&file_header, bytes, FIT_FILE_HDR_SIZE);
+    if (memcmp(file_header.data_type, ".FIT", 4) != 0) {
+        return false;
+    }
+
+    const bool headerValid =
+        file_header.header_size == FIT_FILE_HDR_SIZE &&
+        (file_header.crc == 0 ||
+         file_header.crc == fit::CRC::Calc16(&file_header, FIT_STRUCT_OFFSET(crc, FIT_FILE_HDR)));
+    return !headerValid || file.size() != (qint64)FIT_FILE_HDR_SIZE + file_header.data_size + 2;
+}
+
+void qfitjournal::repairInBackground(const QString &directory, const QString &nameFilter, const QString &skip) {
+    QThreadPool::globalInstance()->start(new repairTask(directory, nameFilter, skip));
+}
+
+bool qfitjournal::repair(const QString &filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadWrite)) {
+        return false;
+    }
+
+    const QByteArray content = file.readAll();
+    if (content.size() < FIT_FILE_HDR_SIZE) {
+        return false;
+    }
+
+    FIT_FILE_HDR file_header;
+    memcpy(&file_header, content.constData(), FIT_FILE_HDR_SIZE);
+    if (memcmp(file_header.data_type, ".FIT", 4) != 0) {
+        return false;
+    }
+
+    const uchar *data = (const uchar *)content.constData() + FIT_FILE_HDR_SIZE;
+    const quint32 available = content.size() - FIT_FILE_HDR_SIZE;
+    const bool headerValid =
+        file_header.header_size == FIT_FILE_HDR_SIZE &&
+        (file_header.crc == 0 ||
+         file_header.crc == fit::CRC::Calc16(&file_header, FIT_STRUCT_OFFSET(crc, FIT_FILE_HDR)));
+
+    quint32 dataSize;
+    if (headerValid && file_header.data_size <= available) {
+        // the last checkpoint
+        dataSize = file_header.data_size;
+        if (available == dataSize + 2 && fit::CRC::Calc16(content.constData(), content.size()) == 0) {
+            return true;
+        }
+    } else {
+        dataSize = completeMessagesLength(data, available);
+    }
+
+    qDebug() << QStringLiteral("qfitjournal: repairing") << filename << QStringLiteral("data size") << dataSize
+             << QStringLiteral("of") << available;
+
+    const QByteArray fileHeader = header(dataSize);
+    const quint16 crc = crcCombine(fit::CRC::Calc16(fileHeader.constData(), FIT_FILE_HDR_SIZE),
+                                   fit::CRC::Calc16(data, dataSize), dataSize);
+    const char crcBytes[2] = {(char)(crc & 0xFF), (char)(crc >> 8)};
+
+    return file.seek(0) && file.write(fileHeader) == FIT_FILE_HDR_SIZE && file.seek(FIT_FILE_HDR_SIZE + dataSize) &&
+           file.write(crcBytes, 2) == 2 && file.resize(FIT_FILE_HDR_SIZE + dataSize + 2);
+}
@@ -0,0 +1,127 @@
+#ifndef QFITJOURNAL_H
+#define QFITJOURNAL_H
+
+#include "devices/bluetoothdevice.h"
+#include "fit_lap_mesg.hpp"
+#include "fit_mesg_definition.hpp"
+#include "fit_profile.hpp"
+#include "sessionstore.h"
+#include <QFile>
+#include <QString>
+#include <sstream>
+
+/**
+ * @brief Append-only FIT writer for the workout backup.
+ * The file stays open for the whole workout: append() encodes only the samples recorded since the previous call and
+ * then checkpoints the file, i.e. rewrites the 14 bytes header with the new data size and the CRC after the data.
+ * The CRC of the records is kept incrementally, so a checkpoint costs the same at minute 1 and at hour 3.
+ * At every checkpoint the file is a valid FIT file with the records only; finalize() appends the last lap, the
+ * session and the activity messages, like qfit::save. A journal left behind by a crash can be fixed with repair().
+ *
+ * Differences from qfit::save, which sees the whole session at once: the distance noise processing isn't applied,
+ * and the records without GPS data are dropped only after the first one with GPS data.
+ */
+class qfitjournal {
+  public:
+    qfitjournal();
+    ~qfitjournal();
+    qfitjournal(const qfitjournal &) = delete;
+    qfitjournal &operator=(const qfitjournal &) = delete;
+
+    /**
+     * @brief Creates (or truncates) the journal file. Nothing is encoded until the first moving sample.
+     */
+    bool open(const QString &filename, bluetoothdevice::BLUETOOTH_TYPE type, FIT_SPORT overrideSport = FIT_SPORT_INVALID,
+              const QString &bluetooth_device_name = QString());
+    bool isOpen() const { return m_file.isOpen(); }
+    bool isFinalized() const { return m_finalized; }
+    QString fileName() const { return m_file.fileName(); }
+
+    /**
+     * @brief Number of session samples already consumed by the journal.
+     */
+    int samples() const { return m_samples; }
+
+    /**
+     * @brief Encodes the samples of the session added since the previous call and checkpoints the file.
+     * @return false on a write error.
+     */
+    bool append(const SessionStore &session);
+
+    /**
+     * @brief Appends the remaining samples and the summary messages, then closes the file.
+     */
+    bool finalize(const SessionStore &session);
+
+    /**
+     * @brief Closes the file without the summary messages (it remains a valid, records only, FIT file) and resets the
+     * journal, ready for open().
+     */
+    void close();
+
+    /**
+     * @brief Makes a journal interrupted by a crash a valid FIT file again: the data is cut at the last checkpoint,
+     * or at the last complete message if the header itself is damaged, and the CRC is rewritten.
+     * @return true if the file is a valid FIT file afterwards (including when nothing had to be done).
+     */
+    static bool repair(const QString &filename);
+
+    /**
+     * @brief Whether repair() has something to do, from the header only: a checkpoint writes the CRC before the
+     * header, so a valid header describing the whole file is a journal closed at a checkpoint.
+     */
+    static bool needsRepair(const QString &filename);
+
+    /**
+     * @brief repair() of the journals of directory matching nameFilter that need it, but skip, on a thread of the
+     * global pool.
+     */
+    static void repairInBackground(const QString &directory, const QString &nameFilter,
+                                   const QString &skip = QString());
+
+    /**
+     * @brief FIT CRC of (A + B), given the CRC of A, the CRC of B (computed from 0) and the length of B.
+     */
+    static quint16 crcCombine(quint16 crcA, quint16 crcB, quint64 lengthB);
+
+  private:
+    void reset();
+    void write(const fit::Mesg &mesg);
+    void writePreamble(const SessionStore &session, int firstRealIndex);
+    void encodeSample(const SessionStore &session, int i);
+    bool checkpoint();
+    static QByteArray header(quint32 dataSize);
+
+    QFile m_file;
+    bluetoothdevice::BLUETOOTH_TYPE m_type = bluetoothdevice::UNKNOWN;
+    FIT_SPORT m_overrideSport = FIT_SPORT_INVALID;
+    QString m_deviceName;
+    bool m_halfCadence = false;
+    bool m_stravaVirtualActivity = false;
+    bool m_finalized = false;
+
+    // encoder state
+    fit::MesgDefinition m_lastMesgDefinition[FIT_MAX_LOCAL_MESGS];
+    std::stringstream m_pending;
+    quint32 m_dataSize = 0;
+    // CRC of the data records only, computed from 0; combined with the header CRC at every checkpoint
+    quint16 m_dataCrc = 0;
+
+    // workout state, the incremental equivalent of the locals of qfit::save
+    int m_samples = 0;
+    bool m_started = false;
+    FIT_DATE_TIME m_date = 0;
+    qint64 m_firstRealTime = 0;
+    double m_startingDistanceOffset = 0;
+    bool m_gpsData = false;
+    double m_gpsMinAltitude = 99999;
+    double m_gpsMaxAltitude = 0;
+    double m_maxElevationGain = 0;
+    double m_speedAcc = 0;
+    int m_speedCount = 0;
+    uint32_t m_lastLapTimer = 0;
+    double m_lastLapOdometer = 0;
+    fit::LapMesg m_lapMesg;
+};
+
+#endif // QFITJOURNAL_H
@@ -717,8 +717,22 @@ const QString QZSettings::hop_sport_hs_090h_bike = QStringLiteral("hop_sport_hs_
 const QString QZSettings::zwift_play = QStringLiteral("zwift_play");
 const QString QZSettings::nordictrack_treadmill_x14i = QStringLiteral("nordictrack_treadmill_x14i");
 const QString QZSettings::zwift_api_poll = QStringLiteral("zwift_api_poll");
+const QString QZSettings::session_spill_to_disk = QStringLiteral("session_spill_to_disk");
+const QString QZSettings::tile_peak_power_5s_enabled = QStringLiteral("tile_peak_power_5s_enabled");
+const QString QZSettings::tile_peak_power_5s_order = QStringLiteral("tile_peak_power_5s_order");
+const QString QZSettings::tile_peak_power_1m_enabled = QStringLiteral("tile_peak_power_1m_enabled");
+const QString QZSettings::tile_peak_power_1m_order = QStringLiteral("tile_peak_power_1m_order");
+const QString QZSettings::tile_peak_power_5m_enabled = QStringLiteral("tile_peak_power_5m_enabled");
+const QString QZSettings::tile_peak_power_5m_order = QStringLiteral("tile_peak_power_5m_order");
+const QString QZSettings::tile_peak_power_20m_enabled = QStringLiteral("tile_peak_power_20m_enabled");
+const QString QZSettings::tile_peak_power_20m_order = QStringLiteral("tile_peak_power_20m_order");
+const QString QZSettings::log_max_file_size_mb = QStringLiteral("log_max_file_size_mb");
+const QString QZSettings::log_rotated_files = QStringLiteral("log_rotated_files");
+const QString QZSettings::log_compress_rotated = QStringLiteral("log_compress_rotated");
+const QString QZSettings::power_calibration_file = QStringLiteral("power_calibration_file");
+const QString QZSettings::default_power_calibration_file = QStringLiteral("");
 
-const uint32_t allSettingsCount = 604;
+const uint32_t allSettingsCount = 617;
 
 QVariant allSettings[allSettingsCount][2] = {
     {QZSettings::cryptoKeySettingsProfiles, QZSettings::default_cryptoKeySettingsProfiles},
@@ -1329,6 +1343,19 @@ QVariant allSettings[allSettingsCount][2] = {
     {QZSettings::zwift_play, QZSettings::default_zwift_play},
     {QZSettings::nordictrack_treadmill_x14i, QZSettings::default_nordictrack_treadmill_x14i},
     {QZSettings::zwift_api_poll, QZSettings::default_zwift_api_poll},
+    {QZSettings::session_spill_to_disk, QZSettings::default_session_spill_to_disk},
+    {QZSettings::tile_peak_power_5s_enabled, QZSettings::default_tile_peak_power_5s_enabled},
+    {QZSettings::tile_peak_power_5s_order, QZSettings::default_tile_peak_power_5s_order},
+    {QZSettings::tile_peak_power_1m_enabled, QZSettings::default_tile_peak_power_1m_enabled},
+    {QZSettings::tile_peak_power_1m_order, QZSettings::default_tile_peak_power_1m_order},
+    {QZSettings::tile_peak_power_5m_enabled, QZSettings::default_tile_peak_power_5m_enabled},
+    {QZSettings::tile_peak_power_5m_order, QZSettings::default_tile_peak_power_5m_order},
+    {QZSettings::tile_peak_power_20m_enabled, QZSettings::default_tile_peak_power_20m_enabled},
+    {QZSettings::tile_peak_power_20m_order, QZSettings::default_tile_peak_power_20m_order},
+    {QZSettings::log_max_file_size_mb, QZSettings::default_log_max_file_size_mb},
+    {QZSettings::log_rotated_files, QZSettings::default_log_rotated_files},
+    {QZSettings::log_compress_rotated, QZSettings::default_log_compress_rotated},
+    {QZSettings::power_calibration_file, QZSettings::default_power_calibration_file},
 };
 
 void QZSettings::qDebugAllSettings(bool showDefaults) {
@@ -2013,6 +2013,60 @@ class QZSettings {
     static const QString zwift_api_poll;
     static constexpr int default_zwift_api_poll = 5;
 
+    /**
+     *@brief Write the full chunks of the current workout to a memory mapped file instead of keeping them on the heap.
+     */
+    static const QString session_spill_to_disk;
+    static constexpr bool default_session_spill_to_disk = false;
+
+    static const QString tile_peak_power_5s_enabled;
+    static constexpr bool default_tile_peak_power_5s_enabled = false;
+
+    static const QString tile_peak_power_5s_order;
+    static constexpr int default_tile_peak_power_5s_order = 51;
+
+    static const QString tile_peak_power_1m_enabled;
+    static constexpr bool default_tile_peak_power_1m_enabled = false;
+
+    static const QString tile_peak_power_1m_order;
+    static constexpr int default_tile_peak_power_1m_order = 52;
+
+    static const QString tile_peak_power_5m_enabled;
+    static constexpr bool default_tile_peak_power_5m_enabled = false;
+
+    static const QString tile_peak_power_5m_order;
+    static constexpr int default_tile_peak_power_5m_order = 53;
+
+    static const QString tile_peak_power_20m_enabled;
+    static constexpr bool default_tile_peak_power_20m_enabled = false;
+
+    static const QString tile_peak_power_20m_order;
+    static constexpr int default_tile_peak_power_20m_order = 54;
+
+    /**
+     *@brief Size, in MB, at which the debug log is rotated. 0 disables the rotation.
+     */
+    static const QString log_max_file_size_mb;
+    static constexpr int default_log_max_file_size_mb = 50;
+
+    /**
+     *@brief Number of rotated debug logs kept.
+     */
+    static const QString log_rotated_files;
+    static constexpr int default_log_rotated_files = 4;
+
+    /**
+     *@brief Gzip the rotated debug logs.
+     */
+    static const QString log_compress_rotated;
+    static constexpr bool default_log_compress_rotated = true;
+
+    /**
+     *@brief CSV file of cadence,resistance,watts measures of the bike, replacing its power model for those levels.
+     */
+    static const QString power_calibration_file;
+    static const QString default_power_calibration_file;
+
     /**
      * @brief Write the QSettings values using the constants from this namespace.
      * @param showDefaults Optionally indicates if the default should be shown with the key.
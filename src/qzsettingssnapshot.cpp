@@ -0,0 +1,58 @@
+#include "qzsettingssnapshot.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QSettings>
+#include <QThread>
+
+bool QZSettingsValues::operator==(const QZSettingsValues &other) const {
+#define QZ_SETTINGS_SNAPSHOT_COMPARE(type, name, conv)                                                                 \
+    if (name != other.name)                                                                                            \
+        return false;
+    QZ_SETTINGS_SNAPSHOT_FIELDS(QZ_SETTINGS_SNAPSHOT_COMPARE)
+#undef QZ_SETTINGS_SNAPSHOT_COMPARE
+    return continuous_moving == other.continuous_moving;
+}
+
+QZSettingsSnapshot *QZSettingsSnapshot::instance() {
+    static QZSettingsSnapshot *s = new QZSettingsSnapshot();
+    return s;
+}
+
+QZSettingsSnapshot::QZSettingsSnapshot(QObject *parent) : QObject(parent) {
+    m_current.storeRelease(new QZSettingsValues());
+    reload();
+
+    QCoreApplication *app = QCoreApplication::instance();
+    if (app && QThread::currentThread() == app->thread()) {
+        m_pollTimer.setInterval(1000);
+        connect(&m_pollTimer, &QTimer::timeout, this, &QZSettingsSnapshot::reload);
+        m_pollTimer.start();
+    }
+}
+
+bool QZSettingsSnapshot::reload() {
+    QSettings settings;
+    QZSettingsValues *v = new QZSettingsValues();
+
+#define QZ_SETTINGS_SNAPSHOT_READ(type, name, conv)                                                                    \
+    v->name = settings.value(QZSettings::name, QZSettings::default_##name).conv();
+    QZ_SETTINGS_SNAPSHOT_FIELDS(QZ_SETTINGS_SNAPSHOT_READ)
+#undef QZ_SETTINGS_SNAPSHOT_READ
+
+    v->continuous_moving = settings.value(QZSettings::continuous_moving, true).toBool();
+    v->heart_rate_belt_disabled = v->heart_rate_belt_name.startsWith(QStringLiteral("Disabled"));
+    v->power_sensor_disabled = v->power_sensor_name.startsWith(QStringLiteral("Disabled"));
+    v->cadence_sensor_disabled = v->cadence_sensor_name.startsWith(QStringLiteral("Disabled"));
+
+    const QZSettingsValues *old = m_current.loadAcquire();
+    if (*old == *v) {
+        delete v;
+        return false;
+    }
+
+    m_current.storeRelease(v);
+    m_retired.push_back(old);
+    qDebug() << QStringLiteral("QZSettingsSnapshot: settings changed, snapshot") << m_retired.size() << "published";
+    emit changed();
+    return true;
+}
@@ -0,0 +1,116 @@
+#ifndef QZSETTINGSSNAPSHOT_H
+#define QZSETTINGSSNAPSHOT_H
+
+#include "qzsettings.h"
+
+#include <QAtomicPointer>
+#include <QObject>
+#include <QTimer>
+#include <vector>
+
+/**
+ * @brief Settings read on the telemetry hot path (every BLE notification, every virtual device tick).
+ * Each entry is (type, QZSettings key, QVariant conversion); the default comes from QZSettings::default_<key>.
+ * Add a key here before reading it from a per-sample code path.
+ */
+#define QZ_SETTINGS_SNAPSHOT_FIELDS(X)                                                                                 \
+    X(double, watt_gain, toDouble)                                                                                     \
+    X(double, watt_offset, toDouble)                                                                                   \
+    X(double, speed_gain, toDouble)                                                                                    \
+    X(double, speed_offset, toDouble)                                                                                  \
+    X(float, weight, toFloat)                                                                                          \
+    X(float, bike_weight, toFloat)                                                                                     \
+    X(float, rolling_resistance, toFloat)                                                                               \
+    X(double, peloton_gain, toDouble)                                                                                  \
+    X(double, peloton_offset, toDouble)                                                                                \
+    X(bool, tacx_neo2_peloton, toBool)                                                                                 \
+    X(bool, renpho_peloton_conversion_v2, toBool)                                                                      \
+    X(bool, renpho_bike_double_resistance, toBool)                                                                     \
+    X(bool, domyos_bike_500_profile_v1, toBool)                                                                        \
+    X(QString, echelon_watttable, toString)                                                                            \
+    X(QString, power_calibration_file, toString)                                                                       \
+    X(QString, heart_rate_belt_name, toString)                                                                         \
+    X(QString, power_sensor_name, toString)                                                                            \
+    X(QString, cadence_sensor_name, toString)                                                                          \
+    X(bool, power_sensor_as_bike, toBool)                                                                              \
+    X(bool, power_sensor_as_treadmill, toBool)                                                                         \
+    X(bool, instant_power_on_pause, toBool)                                                                            \
+    X(bool, heart_ignore_builtin, toBool)                                                                              \
+    X(bool, speed_power_based, toBool)                                                                                 \
+    X(bool, ant_heart, toBool)                                                                                         \
+    X(bool, virtual_device_rower, toBool)                                                                              \
+    X(bool, powr_sensor_running_cadence_double, toBool)                                                                \
+    X(bool, bike_cadence_sensor, toBool)                                                                               \
+    X(bool, battery_service, toBool)                                                                                   \
+    X(bool, bike_power_sensor, toBool)                                                                                 \
+    X(bool, virtual_device_onlyheart, toBool)                                                                          \
+    X(bool, virtual_device_echelon, toBool)                                                                            \
+    X(bool, virtual_device_ifit, toBool)                                                                               \
+    X(bool, zwift_erg, toBool)                                                                                         \
+    X(bool, run_cadence_sensor, toBool)                                                                                \
+    X(bool, bluetooth_relaxed, toBool)                                                                                 \
+    X(bool, bluetooth_30m_hangs, toBool)                                                                               \
+    X(bool, race_mode, toBool)                                                                                         \
+    X(bool, ios_peloton_workaround, toBool)                                                                            \
+    X(bool, horizon_treadmill_suspend_stats_pause, toBool)                                                             \
+    X(bool, log_debug, toBool)
+
+/**
+ * @brief Immutable, typed copy of the hot path settings. Field names match the QZSettings keys.
+ */
+struct QZSettingsValues {
+#define QZ_SETTINGS_SNAPSHOT_MEMBER(type, name, conv) type name = QZSettings::default_##name;
+    QZ_SETTINGS_SNAPSHOT_FIELDS(QZ_SETTINGS_SNAPSHOT_MEMBER)
+#undef QZ_SETTINGS_SNAPSHOT_MEMBER
+
+    // bluetoothdevice::update_metrics has always defaulted this one to true, not to QZSettings' default
+    bool continuous_moving = true;
+
+    // derived values, computed once per reload instead of per sample
+    bool heart_rate_belt_disabled = true;
+    bool power_sensor_disabled = true;
+    bool cadence_sensor_disabled = true;
+
+    bool operator==(const QZSettingsValues &other) const;
+    bool operator!=(const QZSettingsValues &other) const { return !(*this == other); }
+};
+
+/**
+ * @brief Publishes a QZSettingsValues snapshot built from the default QSettings.
+ * Readers call QZSettingsSnapshot::get(), which is a single atomic load: no QSettings, no QVariant, no lock.
+ * A new snapshot is published (pointer swap) only when a value actually changed, and changed() is emitted so that
+ * consumers caching derived values can refresh them. Replaced snapshots are retired, not deleted, because a reader
+ * on another thread may still hold a reference; settings change rarely, so this stays small. For the same reason the
+ * instance itself is never destroyed.
+ */
+class QZSettingsSnapshot : public QObject {
+    Q_OBJECT
+
+  public:
+    static QZSettingsSnapshot *instance();
+
+    /**
+     * @brief The current snapshot. The reference stays valid for the lifetime of the application.
+     */
+    static const QZSettingsValues &get() { return *instance()->m_current.loadAcquire(); }
+
+  public slots:
+    /**
+     * @brief Re-reads the hot path keys from QSettings and publishes them if anything changed.
+     * @return true if a new snapshot was published.
+     */
+    bool reload();
+
+  signals:
+    void changed();
+
+  private:
+    explicit QZSettingsSnapshot(QObject *parent = nullptr);
+
+    QAtomicPointer<const QZSettingsValues> m_current;
+    std::vector<const QZSettingsValues *> m_retired;
+    // QML (Qt.labs.settings) and the device drivers write QSettings directly, so poll at a low rate as well
+    QTimer m_pollTimer;
+};
+
+#endif // QZSETTINGSSNAPSHOT_H
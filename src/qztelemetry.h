@@ -0,0 +1,123 @@
+/*
+ * qztelemetry.h - the live telemetry segment of qdomyos-zwift.
+ *
+ * qdomyos-zwift keeps the last values of the connected device in qz-telemetry.bin, in its working directory: a
+ * fixed binary layout mapped in memory and updated in place every second and on every speed or inclination change.
+ * Readers map (or read) the file and copy the values with qz_telemetry_read(), which retries while an update is in
+ * progress, so a copy is never torn. This header has no other dependency than the C library: include it as is.
+ *
+ *     qz_telemetry t;
+ *     if (qz_telemetry_valid(segment, size) && qz_telemetry_read(segment, &t))
+ *         printf("%.1f km/h %.1f%%\n", t.speed_kmh, t.inclination_pct);
+ *
+ * The values are native endian. A layout older readers can't read changes QZ_TELEMETRY_VERSION; new fields are
+ * added at the end of qz_telemetry, and payload_size is how many bytes of it the writer fills.
+ */
+
+#ifndef QZTELEMETRY_H
+#define QZTELEMETRY_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#if defined(_M_ARM64)
+#define QZ_TELEMETRY_FENCE() __dmb(_ARM64_BARRIER_ISH)
+#elif defined(_M_ARM)
+#define QZ_TELEMETRY_FENCE() __dmb(_ARM_BARRIER_ISH)
+#else
+#define QZ_TELEMETRY_FENCE() _mm_mfence()
+#endif
+#else
+#define QZ_TELEMETRY_FENCE() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define QZ_TELEMETRY_FILE "qz-telemetry.bin"
+#define QZ_TELEMETRY_MAGIC 0x4d4c545aU /* "ZTLM" */
+#define QZ_TELEMETRY_VERSION 1
+
+/* device_type */
+#define QZ_TELEMETRY_UNKNOWN 0
+#define QZ_TELEMETRY_TREADMILL 1
+#define QZ_TELEMETRY_BIKE 2
+#define QZ_TELEMETRY_ROWING 3
+#define QZ_TELEMETRY_ELLIPTICAL 4
+
+/* flags */
+#define QZ_TELEMETRY_CONNECTED 0x1
+#define QZ_TELEMETRY_PAUSED 0x2
+
+typedef struct qz_telemetry {
+    int64_t updated_ms; /* when the values were published, ms since 1970-01-01 UTC */
+    uint32_t device_type;
+    uint32_t flags;
+    double speed_kmh;
+    double inclination_pct;
+    double heart_bpm;
+    double cadence_rpm;
+    double watts;
+    double resistance;
+    double peloton_resistance;
+    double distance_km;
+    double calories_kcal;
+    double elevation_gain_m;
+    double elapsed_s;
+    double moving_s;
+    double latitude; /* NaN without a position */
+    double longitude;
+    double altitude_m;
+} qz_telemetry;
+
+typedef struct qz_telemetry_segment {
+    uint32_t magic;
+    uint16_t version;
+    uint16_t header_size; /* offset of data */
+    uint32_t payload_size; /* sizeof(qz_telemetry) of the writer */
+    /* odd while the writer updates data, incremented twice by each update */
+    volatile uint32_t seq;
+    qz_telemetry data;
+} qz_telemetry_segment;
+
+/* whether the size bytes at segment are a telemetry segment this header can read */
+static inline int qz_telemetry_valid(const qz_telemetry_segment *segment, uint64_t size) {
+    return size >= sizeof(qz_telemetry_segment) && segment->magic == QZ_TELEMETRY_MAGIC &&
+           segment->version == QZ_TELEMETRY_VERSION && segment->header_size == offsetof(qz_telemetry_segment, data) &&
+           segment->payload_size >= sizeof(qz_telemetry);
+}
+
+/* copies the last values published to out; 0 if the writer kept updating them for all the attempts */
+static inline int qz_telemetry_read(const qz_telemetry_segment *segment, qz_telemetry *out) {
+    int attempt;
+    for (attempt = 0; attempt < 10000; attempt++) {
+        const uint32_t before = segment->seq;
+        QZ_TELEMETRY_FENCE();
+        if (before & 1)
+            continue;
+        memcpy(out, (const void *)&segment->data, sizeof(qz_telemetry));
+        QZ_TELEMETRY_FENCE();
+        if (segment->seq == before)
+            return 1;
+    }
+    return 0;
+}
+
+/* publishes in; one writer only */
+static inline void qz_telemetry_write(qz_telemetry_segment *segment, const qz_telemetry *in) {
+    segment->seq = segment->seq + 1;
+    QZ_TELEMETRY_FENCE();
+    memcpy((void *)&segment->data, in, sizeof(qz_telemetry));
+    QZ_TELEMETRY_FENCE();
+    segment->seq = segment->seq + 1;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* QZTELEMETRY_H */
@@ -0,0 +1,68 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <QtGlobal>
+#include <atomic>
+#include <cstring>
+#include <type_traits>
+
+/**
+ * @brief A value shared by one writer thread and any number of reader threads without a lock. The writer never
+ * waits; a reader copies the value and copies it again if the writer changed it meanwhile, so it never sees half of
+ * an update. Meant for small trivially copyable structs updated often, like the telemetry of a device.
+ * The value is kept as atomic words, so the copies are not data races.
+ */
+template <typename T> class seqlock {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock needs a trivially copyable type");
+
+  public:
+    seqlock() { store(T()); }
+    explicit seqlock(const T &value) { store(value); }
+    seqlock(const seqlock &) = delete;
+    seqlock &operator=(const seqlock &) = delete;
+
+    /**
+     * @brief Publish value. Only one thread may store.
+     */
+    void store(const T &value) {
+        quint64 w[WORDS] = {};
+        memcpy(w, &value, sizeof(T));
+        const quint32 s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (int i = 0; i < WORDS; i++)
+            words[i].store(w[i], std::memory_order_relaxed);
+        seq.store(s + 2, std::memory_order_release);
+    }
+
+    /**
+     * @brief The last value published.
+     */
+    T load() const {
+        quint64 w[WORDS];
+        quint32 before, after;
+        do {
+            before = seq.load(std::memory_order_acquire);
+            for (int i = 0; i < WORDS; i++)
+                w[i] = words[i].load(std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = seq.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        T value;
+        memcpy(&value, w, sizeof(T));
+        return value;
+    }
+
+    /**
+     * @brief Changes at every store(): a reader can tell if there is something new without copying the value.
+     */
+    quint32 version() const { return seq.load(std::memory_order_acquire); }
+
+  private:
+    static constexpr int WORDS = (sizeof(T) + sizeof(quint64) - 1) / sizeof(quint64);
+
+    std::atomic<quint32> seq{0};
+    std::atomic<quint64> words[WORDS];
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,150 @@
+#include "sessionstore.h"
+#include "qdebugfixup.h"
+
+#include <QDebug>
+#include <cmath>
+
+SessionStore::SessionStore() {}
+
+SessionStore::~SessionStore() { releaseChunks(); }
+
+void SessionStore::append(const SessionLine &line) {
+    if (m_count == m_chunks.count() * CHUNK_ROWS) {
+        m_chunks.append(new Chunk);
+        m_spilled.append(false);
+    }
+
+    Chunk *c = m_chunks.last();
+    const int i = m_count % CHUNK_ROWS;
+    c->speed[i] = line.speed;
+    c->inclination[i] = line.inclination;
+    c->distance[i] = line.distance;
+    c->watt[i] = line.watt;
+    c->resistance[i] = line.resistance;
+    c->peloton_resistance[i] = line.peloton_resistance;
+    c->heart[i] = line.heart;
+    c->pace[i] = line.pace;
+    c->cadence[i] = line.cadence;
+    c->timeMs[i] = line.time.isValid() ? line.time.toMSecsSinceEpoch() : INVALID_TIME;
+    c->calories[i] = line.calories;
+    c->elevationGain[i] = line.elevationGain;
+    c->elapsedTime[i] = line.elapsedTime;
+    c->lapTrigger[i] = line.lapTrigger;
+    c->totalStrokes[i] = line.totalStrokes;
+    c->avgStrokesRate[i] = line.avgStrokesRate;
+    c->maxStrokesRate[i] = line.maxStrokesRate;
+    c->avgStrokesLength[i] = line.avgStrokesLength;
+    if (line.coordinate.isValid()) {
+        c->latitude[i] = line.coordinate.latitude();
+        c->longitude[i] = line.coordinate.longitude();
+        c->altitude[i] = line.coordinate.altitude();
+    } else {
+        c->latitude[i] = NAN;
+        c->longitude[i] = NAN;
+        c->altitude[i] = NAN;
+    }
+    c->instantaneousStrideLengthCM[i] = line.instantaneousStrideLengthCM;
+    c->groundContactMS[i] = line.groundContactMS;
+    c->verticalOscillationMM[i] = line.verticalOscillationMM;
+    c->stepCount[i] = line.stepCount;
+    m_count++;
+    m_powerCurve.append(line.watt);
+
+    if (i == CHUNK_ROWS - 1 && m_spillFile.isOpen()) {
+        spill(m_chunks.count() - 1);
+    }
+}
+
+QDateTime SessionStore::time(int i) const {
+    qint64 ms = timeMs()[i];
+    if (ms == INVALID_TIME)
+        return QDateTime();
+    return QDateTime::fromMSecsSinceEpoch(ms);
+}
+
+QGeoCoordinate SessionStore::coordinate(int i) const {
+    const Chunk *c = m_chunks.at(i / CHUNK_ROWS);
+    const int o = i % CHUNK_ROWS;
+    if (std::isnan(c->latitude[o]) || std::isnan(c->longitude[o]))
+        return QGeoCoordinate();
+    if (std::isnan(c->altitude[o]))
+        return QGeoCoordinate(c->latitude[o], c->longitude[o]);
+    return QGeoCoordinate(c->latitude[o], c->longitude[o], c->altitude[o]);
+}
+
+SessionLine SessionStore::at(int i) const {
+    const Chunk *c = m_chunks.at(i / CHUNK_ROWS);
+    const int o = i % CHUNK_ROWS;
+    SessionLine l(c->speed[o], c->inclination[o], c->distance[o], c->watt[o], c->resistance[o],
+                  c->peloton_resistance[o], c->heart[o], c->pace[o], c->cadence[o], c->calories[o],
+                  c->elevationGain[o], c->elapsedTime[o], c->lapTrigger[o], c->totalStrokes[o], c->avgStrokesRate[o],
+                  c->maxStrokesRate[o], c->avgStrokesLength[o], coordinate(i), c->instantaneousStrideLengthCM[o],
+                  c->groundContactMS[o], c->verticalOscillationMM[o], c->stepCount[o], time(i));
+    return l;
+}
+
+void SessionStore::clear() {
+    releaseChunks();
+    m_count = 0;
+    m_powerCurve.clear();
+    if (m_spillFile.isOpen()) {
+        m_spillFile.resize(0);
+    }
+    m_spillFileChunks = 0;
+}
+
+void SessionStore::releaseChunks() {
+    for (int i = 0; i < m_chunks.count(); i++) {
+        if (m_spilled.at(i))
+            m_spillFile.unmap(reinterpret_cast<uchar *>(m_chunks.at(i)));
+        else
+            delete m_chunks.at(i);
+    }
+    m_chunks.clear();
+    m_spilled.clear();
+}
+
+bool SessionStore::setSpillFile(const QString &filename) {
+    if (m_spillFile.isOpen()) {
+        // the chunks already mapped point into the current file
+        return filename == m_spillFile.fileName();
+    }
+    if (filename.isEmpty())
+        return false;
+
+    m_spillFile.setFileName(filename);
+    if (!m_spillFile.open(QIODevice::ReadWrite | QIODevice::Truncate)) {
+        qDebug() << QStringLiteral("SessionStore: unable to open spill file") << filename << m_spillFile.errorString();
+        return false;
+    }
+    m_spillFileChunks = 0;
+
+    // full chunks recorded before spilling was enabled
+    for (int i = 0; i < m_chunks.count(); i++) {
+        if (!m_spilled.at(i) && (i + 1) * CHUNK_ROWS <= m_count)
+            spill(i);
+    }
+    return true;
+}
+
+void SessionStore::spill(int chunkIndex) {
+    const qint64 offset = (qint64)m_spillFileChunks * (qint64)sizeof(Chunk);
+    if (!m_spillFile.seek(offset) ||
+        m_spillFile.write(reinterpret_cast<const char *>(m_chunks.at(chunkIndex)), sizeof(Chunk)) !=
+            (qint64)sizeof(Chunk) ||
+        !m_spillFile.flush()) {
+        qDebug() << QStringLiteral("SessionStore: spill failed, keeping chunk in memory") << m_spillFile.errorString();
+        return;
+    }
+
+    uchar *mapped = m_spillFile.map(offset, sizeof(Chunk));
+    if (!mapped) {
+        qDebug() << QStringLiteral("SessionStore: map failed, keeping chunk in memory") << m_spillFile.errorString();
+        return;
+    }
+
+    delete m_chunks.at(chunkIndex);
+    m_chunks[chunkIndex] = reinterpret_cast<Chunk *>(mapped);
+    m_spilled[chunkIndex] = true;
+    m_spillFileChunks++;
+}
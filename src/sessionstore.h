@@ -0,0 +1,151 @@
+#ifndef SESSIONSTORE_H
+#define SESSIONSTORE_H
+
+#include "powercurve.h"
+#include "sessionline.h"
+
+#include <QFile>
+#include <QString>
+#include <QVector>
+#include <limits>
+#include <type_traits>
+
+/**
+ * @brief Channels recorded for every workout sample: (type, name). The names match the SessionLine members, except
+ * for the time (milliseconds since epoch) and the coordinate, split into latitude/longitude/altitude (NaN = invalid).
+ */
+#define SESSION_STORE_CHANNELS(X)                                                                                      \
+    X(double, speed)                                                                                                   \
+    X(int8_t, inclination)                                                                                             \
+    X(double, distance)                                                                                                \
+    X(uint16_t, watt)                                                                                                  \
+    X(resistance_t, resistance)                                                                                        \
+    X(int8_t, peloton_resistance)                                                                                      \
+    X(uint8_t, heart)                                                                                                  \
+    X(double, pace)                                                                                                    \
+    X(uint8_t, cadence)                                                                                                \
+    X(qint64, timeMs)                                                                                                  \
+    X(double, calories)                                                                                                \
+    X(double, elevationGain)                                                                                           \
+    X(uint32_t, elapsedTime)                                                                                           \
+    X(uint8_t, lapTrigger)                                                                                             \
+    X(uint32_t, totalStrokes)                                                                                          \
+    X(double, avgStrokesRate)                                                                                          \
+    X(double, maxStrokesRate)                                                                                          \
+    X(double, avgStrokesLength)                                                                                        \
+    X(double, latitude)                                                                                                \
+    X(double, longitude)                                                                                               \
+    X(double, altitude)                                                                                                \
+    X(double, instantaneousStrideLengthCM)                                                                             \
+    X(double, groundContactMS)                                                                                         \
+    X(double, verticalOscillationMM)                                                                                   \
+    X(double, stepCount)
+
+/**
+ * @brief Columnar workout session: one contiguous typed array per channel, in chunks of CHUNK_ROWS samples.
+ * Appending never moves the samples already recorded, and a SessionColumn reads a channel in place, chunk by chunk,
+ * without building SessionLine objects. With setSpillFile() every full chunk is written to disk and memory mapped
+ * back, so multi-hour sessions don't keep everything on the heap.
+ */
+class SessionStore {
+  public:
+    static constexpr int CHUNK_ROWS = 1024;
+
+    struct Chunk {
+#define SESSION_STORE_CHUNK_MEMBER(type, name) type name[CHUNK_ROWS];
+        SESSION_STORE_CHANNELS(SESSION_STORE_CHUNK_MEMBER)
+#undef SESSION_STORE_CHUNK_MEMBER
+    };
+    static_assert(std::is_trivially_copyable<Chunk>::value, "SessionStore chunks are written to disk as raw bytes");
+
+    /**
+     * @brief Read-only, zero-copy view of one channel.
+     * Use operator[] for random access, or segmentCount()/segment() to walk the contiguous arrays.
+     */
+    template <typename T> class SessionColumn {
+      public:
+        typedef T(Chunk::*Member)[CHUNK_ROWS];
+
+        SessionColumn(const SessionStore *store, Member member) : m_store(store), m_member(member) {}
+
+        int count() const { return m_store->count(); }
+        T operator[](int i) const { return (m_store->m_chunks.at(i / CHUNK_ROWS)->*m_member)[i % CHUNK_ROWS]; }
+        int segmentCount() const { return m_store->m_chunks.count(); }
+        const T *segment(int s, int *length) const {
+            *length = (s == m_store->m_chunks.count() - 1) ? m_store->m_count - (s * CHUNK_ROWS) : CHUNK_ROWS;
+            return m_store->m_chunks.at(s)->*m_member;
+        }
+
+        template <typename F> void forEach(F f) const {
+            for (int s = 0; s < segmentCount(); s++) {
+                int length;
+                const T *data = segment(s, &length);
+                for (int i = 0; i < length; i++)
+                    f(data[i]);
+            }
+        }
+
+      private:
+        const SessionStore *m_store;
+        Member m_member;
+    };
+
+    SessionStore();
+    ~SessionStore();
+    SessionStore(const SessionStore &) = delete;
+    SessionStore &operator=(const SessionStore &) = delete;
+
+    int count() const { return m_count; }
+    int size() const { return m_count; }
+    int length() const { return m_count; }
+    bool isEmpty() const { return m_count == 0; }
+
+    void append(const SessionLine &line);
+    void clear();
+
+    /**
+     * @brief Materializes a single sample. Prefer the column views when walking the whole session.
+     */
+    SessionLine at(int i) const;
+    SessionLine first() const { return at(0); }
+    SessionLine last() const { return at(m_count - 1); }
+    SessionLine constFirst() const { return at(0); }
+
+    QDateTime time(int i) const;
+    QGeoCoordinate coordinate(int i) const;
+
+#define SESSION_STORE_COLUMN_GETTER(type, name)                                                                        \
+    SessionColumn<type> name() const { return SessionColumn<type>(this, &Chunk::name); }
+    SESSION_STORE_CHANNELS(SESSION_STORE_COLUMN_GETTER)
+#undef SESSION_STORE_COLUMN_GETTER
+
+    /**
+     * @brief Spills every full chunk to the file specified and maps it back. Once enabled, spilling stays on for the
+     * lifetime of the store; clear() truncates the file.
+     * @param filename The spill file, truncated when opened.
+     * @return false if the file can't be opened; the store then keeps working in memory.
+     */
+    bool setSpillFile(const QString &filename);
+    int spilledChunks() const { return m_spillFileChunks; }
+
+    /**
+     * @brief Mean maximal power of the session, updated by append().
+     */
+    const PowerCurve &powerCurve() const { return m_powerCurve; }
+
+  private:
+    static constexpr qint64 INVALID_TIME = std::numeric_limits<qint64>::min();
+
+    void spill(int chunkIndex);
+    void releaseChunks();
+
+    QVector<Chunk *> m_chunks;
+    // m_spilled[i] is true if m_chunks[i] points into a mapping of m_spillFile
+    QVector<bool> m_spilled;
+    int m_count = 0;
+    QFile m_spillFile;
+    int m_spillFileChunks = 0;
+    PowerCurve m_powerCurve;
+};
+
+#endif // SESSIONSTORE_H
@@ -187,6 +187,14 @@ ScrollView {
         property int  tile_pace_last500m_order: 49
         property bool tile_target_pace_enabled: false
         property int  tile_target_pace_order: 50
+        property bool tile_peak_power_5s_enabled: false
+        property int  tile_peak_power_5s_order: 51
+        property bool tile_peak_power_1m_enabled: false
+        property int  tile_peak_power_1m_order: 52
+        property bool tile_peak_power_5m_enabled: false
+        property int  tile_peak_power_5m_order: 53
+        property bool tile_peak_power_20m_enabled: false
+        property int  tile_peak_power_20m_order: 54
     }
 
 
@@ -1491,6 +1499,134 @@ ScrollView {
             }
         }
 
+        AccordionCheckElement {
+            id: peakPower5sEnabledAccordion
+            title: qsTr("Best Power 5s")
+            linkedBoolSetting: "tile_peak_power_5s_enabled"
+            settings: settings
+            accordionContent: RowLayout {
+                spacing: 10
+                Label {
+                    id: labelpeakPower5sOrder
+                    text: qsTr("order index:")
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignRight
+                }
+                ComboBox {
+                    id: peakPower5sOrderTextField
+                    model: rootItem.tile_order
+                    displayText: settings.tile_peak_power_5s_order
+                    Layout.fillHeight: false
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onActivated: {
+                        displayText = peakPower5sOrderTextField.currentValue
+                     }
+                }
+                Button {
+                    id: okpeakPower5sOrderButton
+                    text: "OK"
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onClicked: {settings.tile_peak_power_5s_order = peakPower5sOrderTextField.displayText; toast.show("Setting saved!"); }
+                }
+            }
+        }
+
+        AccordionCheckElement {
+            id: peakPower1mEnabledAccordion
+            title: qsTr("Best Power 1min")
+            linkedBoolSetting: "tile_peak_power_1m_enabled"
+            settings: settings
+            accordionContent: RowLayout {
+                spacing: 10
+                Label {
+                    id: labelpeakPower1mOrder
+                    text: qsTr("order index:")
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignRight
+                }
+                ComboBox {
+                    id: peakPower1mOrderTextField
+                    model: rootItem.tile_order
+                    displayText: settings.tile_peak_power_1m_order
+                    Layout.fillHeight: false
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onActivated: {
+                        displayText = peakPower1mOrderTextField.currentValue
+                     }
+                }
+                Button {
+                    id: okpeakPower1mOrderButton
+                    text: "OK"
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onClicked: {settings.tile_peak_power_1m_order = peakPower1mOrderTextField.displayText; toast.show("Setting saved!"); }
+                }
+            }
+        }
+
+        AccordionCheckElement {
+            id: peakPower5mEnabledAccordion
+            title: qsTr("Best Power 5min")
+            linkedBoolSetting: "tile_peak_power_5m_enabled"
+            settings: settings
+            accordionContent: RowLayout {
+                spacing: 10
+                Label {
+                    id: labelpeakPower5mOrder
+                    text: qsTr("order index:")
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignRight
+                }
+                ComboBox {
+                    id: peakPower5mOrderTextField
+                    model: rootItem.tile_order
+                    displayText: settings.tile_peak_power_5m_order
+                    Layout.fillHeight: false
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onActivated: {
+                        displayText = peakPower5mOrderTextField.currentValue
+                     }
+                }
+                Button {
+                    id: okpeakPower5mOrderButton
+                    text: "OK"
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onClicked: {settings.tile_peak_power_5m_order = peakPower5mOrderTextField.displayText; toast.show("Setting saved!"); }
+                }
+            }
+        }
+
+        AccordionCheckElement {
+            id: peakPower20mEnabledAccordion
+            title: qsTr("Best Power 20min")
+            linkedBoolSetting: "tile_peak_power_20m_enabled"
+            settings: settings
+            accordionContent: RowLayout {
+                spacing: 10
+                Label {
+                    id: labelpeakPower20mOrder
+                    text: qsTr("order index:")
+                    Layout.fillWidth: true
+                    horizontalAlignment: Text.AlignRight
+                }
+                ComboBox {
+                    id: peakPower20mOrderTextField
+                    model: rootItem.tile_order
+                    displayText: settings.tile_peak_power_20m_order
+                    Layout.fillHeight: false
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onActivated: {
+                        displayText = peakPower20mOrderTextField.currentValue
+                     }
+                }
+                Button {
+                    id: okpeakPower20mOrderButton
+                    text: "OK"
+                    Layout.alignment: Qt.AlignRight | Qt.AlignVCenter
+                    onClicked: {settings.tile_peak_power_20m_order = peakPower20mOrderTextField.displayText; toast.show("Setting saved!"); }
+                }
+            }
+        }
+
         AccordionCheckElement {
             id: targetInclineEnabledAccordion
             title: qsTr("Target Incline")
@@ -904,6 +904,16 @@ import QtQuick.Dialogs 1.0
             property bool zwift_play: false
             property bool nordictrack_treadmill_x14i: false
             property int zwift_api_poll: 5
+
+            // from version 2.16.43
+            property bool tile_peak_power_5s_enabled: false
+            property int  tile_peak_power_5s_order: 51
+            property bool tile_peak_power_1m_enabled: false
+            property int  tile_peak_power_1m_order: 52
+            property bool tile_peak_power_5m_enabled: false
+            property int  tile_peak_power_5m_order: 53
+            property bool tile_peak_power_20m_enabled: false
+            property int  tile_peak_power_20m_order: 54
         }
 
         function paddingZeros(text, limit) {
@@ -0,0 +1,119 @@
+#include "telemetrysegment.h"
+
+#include <QDateTime>
+#include <QDebug>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+
+telemetrysegment::~telemetrysegment() { close(); }
+
+bool telemetrysegment::open(const QString &path) {
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << QStringLiteral("Open") << path << QStringLiteral("for writing failed");
+        return false;
+    }
+    const qint64 size = sizeof(qz_telemetry_segment);
+    const bool valid = file.size() == size;
+    if (!valid && !file.resize(size)) {
+        file.close();
+        return false;
+    }
+    uchar *map = file.map(0, size);
+    if (!map) {
+        file.close();
+        return false;
+    }
+    segment = reinterpret_cast<qz_telemetry_segment *>(map);
+
+    // a segment of another version, or left in the middle of an update, starts empty
+    if (!valid || !qz_telemetry_valid(segment, size) || (segment->seq & 1)) {
+        memset(map, 0, size);
+        segment->magic = QZ_TELEMETRY_MAGIC;
+        segment->version = QZ_TELEMETRY_VERSION;
+        segment->header_size = offsetof(qz_telemetry_segment, data);
+        segment->payload_size = sizeof(qz_telemetry);
+    }
+    return true;
+}
+
+void telemetrysegment::close() {
+    if (segment) {
+        file.unmap(reinterpret_cast<uchar *>(segment));
+        segment = nullptr;
+    }
+    if (file.isOpen())
+        file.close();
+}
+
+void telemetrysegment::publish(const qz_telemetry &values) {
+    if (!segment)
+        return;
+    if (values.updated_ms) {
+        qz_telemetry_write(segment, &values);
+        return;
+    }
+    qz_telemetry stamped = values;
+    stamped.updated_ms = QDateTime::currentMSecsSinceEpoch();
+    qz_telemetry_write(segment, &stamped);
+}
+
+bool telemetrysegment::last(qz_telemetry *values) const {
+    if (!segment || !qz_telemetry_read(segment, values))
+        return false;
+    return values->updated_ms != 0;
+}
+
+bool telemetrysegment::writeStatusFile(const QString &path, const qz_telemetry &values) {
+    const QString speed = QString::number(values.speed_kmh, 'f', 1);
+    const QString inclination = QString::number(values.inclination_pct, 'f', 1);
+    if (speed == statusFileSpeed && inclination == statusFileInclination)
+        return false;
+    if (statusFileTimer.isValid() && statusFileTimer.elapsed() < statusFileInterval)
+        return false;
+
+    QSaveFile log(path);
+    if (!log.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        qDebug() << QStringLiteral("Open status.xml for writing failed");
+        return false;
+    }
+    QXmlStreamWriter xml(&log);
+    xml.setAutoFormatting(true);
+    xml.setAutoFormattingIndent(1);
+    xml.writeStartElement(QStringLiteral("Gym"));
+    xml.writeAttribute(QStringLiteral("Updated"), QDateTime::currentDateTime().toString());
+    xml.writeEmptyElement(QStringLiteral("Treadmill"));
+    xml.writeAttribute(QStringLiteral("Speed"), speed);
+    xml.writeAttribute(QStringLiteral("Incline"), inclination);
+    xml.writeEndElement();
+    log.write("\n");
+    if (!log.commit()) {
+        qDebug() << QStringLiteral("Write status.xml failed") << log.errorString();
+        return false;
+    }
+    statusFileSpeed = speed;
+    statusFileInclination = inclination;
+    statusFileTimer.start();
+    return true;
+}
+
+bool telemetrysegment::readStatusFile(const QString &path, double *speed, double *inclination) {
+    QFile log(path);
+    if (!log.open(QIODevice::ReadOnly | QIODevice::Text))
+        return false;
+    QXmlStreamReader xml(&log);
+    while (xml.readNextStartElement()) {
+        if (xml.name() == QLatin1String("Gym"))
+            continue;
+        if (xml.name() == QLatin1String("Treadmill")) {
+            const QXmlStreamAttributes attributes = xml.attributes();
+            *speed = attributes.value(QStringLiteral("Speed")).toDouble();
+            *inclination = attributes.value(QStringLiteral("Incline")).toDouble();
+            return true;
+        }
+        xml.skipCurrentElement();
+    }
+    return false;
+}
@@ -0,0 +1,59 @@
+#ifndef TELEMETRYSEGMENT_H
+#define TELEMETRYSEGMENT_H
+
+#include "qztelemetry.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QString>
+
+/**
+ * @brief The writer of the live telemetry segment described in qztelemetry.h: a file mapped in memory, updated in
+ * place under a sequence counter so that readers polling it never copy half an update. The values stay in the file
+ * when the app quits, so the next run can read them back with last().
+ * It also writes the status.xml of the previous versions for the tools still reading it, at most every
+ * statusFileInterval ms and only when the speed or the inclination shown in it changed.
+ */
+class telemetrysegment {
+  public:
+    ~telemetrysegment();
+
+    /**
+     * @brief Map the segment at path, creating it if needed. A valid segment keeps its values.
+     */
+    bool open(const QString &path = QStringLiteral(QZ_TELEMETRY_FILE));
+    void close();
+    bool isOpen() const { return segment != nullptr; }
+
+    /**
+     * @brief Publish the values, updated_ms is set to now if 0.
+     */
+    void publish(const qz_telemetry &values);
+    /**
+     * @brief The values in the segment, published by this run or by the previous one. false if there are none.
+     */
+    bool last(qz_telemetry *values) const;
+
+    /**
+     * @brief Write the treadmill speed and inclination to the status.xml at path if they changed and the last write
+     * is older than statusFileInterval ms. The file is replaced at once, a reader never sees it half written.
+     * @return true if the file was written.
+     */
+    bool writeStatusFile(const QString &path, const qz_telemetry &values);
+    /**
+     * @brief The speed and inclination in the status.xml at path, false if there is none.
+     */
+    static bool readStatusFile(const QString &path, double *speed, double *inclination);
+
+    qint64 statusFileInterval = 2000;
+
+  private:
+    QFile file;
+    qz_telemetry_segment *segment = nullptr;
+
+    QElapsedTimer statusFileTimer;
+    QString statusFileSpeed;
+    QString statusFileInclination;
+};
+
+#endif // TELEMETRYSEGMENT_H
@@ -12,6 +12,29 @@ class TemplateInfoSender : public QObject {
     virtual ~TemplateInfoSender();
     virtual bool isRunning() const = 0;
     virtual bool send(const QString &data) = 0;
+    /**
+     * @brief Answers the client whose message is being processed (onDataReceived), all the clients by default.
+     */
+    virtual bool reply(const QString &data) { return send(data); }
+    /**
+     * @brief Moves the client whose message is being processed from the template output to the delta feed.
+     * @return false if the sender has no clients of its own.
+     */
+    virtual bool subscribeFeed(bool binary) {
+        Q_UNUSED(binary);
+        return false;
+    }
+    virtual bool hasFeedClients() const { return false; }
+    /**
+     * @brief Sends the delta of the tick, encoded once by the caller, to the feed clients.
+     * @param fields the new fields as a text message, for the binary clients (empty if none).
+     */
+    virtual bool sendFeed(const QByteArray &json, const QByteArray &binary, const QByteArray &fields) {
+        Q_UNUSED(json);
+        Q_UNUSED(binary);
+        Q_UNUSED(fields);
+        return false;
+    }
     bool init(const QString &script);
     void stop();
     bool update(QJSEngine *eng);
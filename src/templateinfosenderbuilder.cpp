@@ -67,11 +67,30 @@ void TemplateInfoSenderBuilder::onUpdateTimeout() {
     buildContext();
     QHash<QString, TemplateInfoSender *>::Iterator it;
     bool rv;
+    bool feedClients = false;
     for (it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
         rv = it.value()->update(engine);
         if (!rv) {
             qDebug() << QStringLiteral("Error updating") << it.key() << QStringLiteral("template");
         }
+        feedClients = feedClients || it.value()->hasFeedClients();
+    }
+    if (feedClients) {
+        // encoded once for all the clients
+        QByteArray json = feed.deltaJson();
+        QByteArray binary = feed.deltaBinary();
+        QByteArray fields;
+        QJsonObject newFields = feed.newFields();
+        if (!newFields.isEmpty()) {
+            QJsonObject main;
+            main[QStringLiteral("msg")] = QStringLiteral("workoutfields");
+            main[QStringLiteral("content")] = newFields;
+            fields = QJsonDocument(main).toJson(QJsonDocument::Compact);
+        }
+        for (it = templateInfoMap.begin(); it != templateInfoMap.end(); it++) {
+            if (it.value()->hasFeedClients())
+                it.value()->sendFeed(json, binary, fields);
+        }
     }
 }
 
@@ -229,12 +248,7 @@ TemplateInfoSender *TemplateInfoSenderBuilder::newTemplate(const QString &id, co
 
 void TemplateInfoSenderBuilder::reinit() { load(masterId, foldersToLook); }
 
-void TemplateInfoSenderBuilder::clearSessionArray() {
-    int len = sessionArray.count();
-    for (int i = 0; i < len; i++) {
-        sessionArray.removeAt(0);
-    }
-}
+void TemplateInfoSenderBuilder::clearSessionArray() { feed.clearHistory(); }
 
 void TemplateInfoSenderBuilder::start(bluetoothdevice *dev) {
     device = nullptr;
@@ -516,12 +530,35 @@ void TemplateInfoSenderBuilder::onAppendActivityDescription(const QJsonValue &ms
     tempSender->send(out.toJson());
 }
 
-void TemplateInfoSenderBuilder::onGetSessionArray(TemplateInfoSender *tempSender) {
+void TemplateInfoSenderBuilder::onGetSessionArray(const QJsonValue &msgContent, TemplateInfoSender *tempSender) {
     QJsonObject main;
-    main[QStringLiteral("content")] = sessionArray;
+    quint64 next = 0;
+    if (msgContent.isObject()) {
+        // one page: {cursor, limit}
+        QJsonObject content = msgContent.toObject();
+        quint64 cursor = (quint64)qMax(0.0, content[QStringLiteral("cursor")].toDouble());
+        main[QStringLiteral("content")] = feed.rows(cursor, content[QStringLiteral("limit")].toInt(600), &next);
+    } else {
+        main[QStringLiteral("content")] = feed.rows(0, 0, &next);
+    }
     main[QStringLiteral("msg")] = QStringLiteral("R_getsessionarray");
+    main[QStringLiteral("first")] = (qint64)feed.firstRow();
+    main[QStringLiteral("cursor")] = (qint64)next;
+    main[QStringLiteral("more")] = next < feed.endRow();
     QJsonDocument out(main);
-    tempSender->send(out.toJson());
+    tempSender->reply(out.toJson(QJsonDocument::Compact));
+}
+
+void TemplateInfoSenderBuilder::onSubscribeFeed(const QJsonValue &msgContent, TemplateInfoSender *tempSender) {
+    QJsonObject main;
+    bool binary = msgContent.toObject()[QStringLiteral("format")].toString() == QStringLiteral("binary");
+    if (tempSender->subscribeFeed(binary))
+        main[QStringLiteral("content")] = feed.snapshot();
+    else
+        main[QStringLiteral("content")] = QJsonValue();
+    main[QStringLiteral("msg")] = QStringLiteral("R_subscribefeed");
+    QJsonDocument out(main);
+    tempSender->reply(out.toJson(QJsonDocument::Compact));
 }
 
 void TemplateInfoSenderBuilder::onGetGPXBase64(TemplateInfoSender *tempSender) {
@@ -552,7 +589,7 @@ void TemplateInfoSenderBuilder::onNextInclination300Meters(TemplateInfoSender *t
     if (!device)
         return;
     QJsonObject main;
-    QList<MetersByInclination> ii = device->nextInclination300Meters();
+    QVector<MetersByInclination> ii = device->nextInclination300Meters();
     QString values = "";
     for (int i = 0; i < ii.length(); i++) {
         values += QString::number(ii.at(i).meters, 'g', 0) + "," + QString::number(ii.at(i).inclination, 'g', 1) + ",";
@@ -877,7 +914,10 @@ void TemplateInfoSenderBuilder::onDataReceived(const QByteArray &data) {
                     onAutoresistance(jsonObject[QStringLiteral("content")], sender);
                     return;
                 } else if (msg == QStringLiteral("getsessionarray")) {
-                    onGetSessionArray(sender);
+                    onGetSessionArray(jsonObject[QStringLiteral("content")], sender);
+                    return;
+                } else if (msg == QStringLiteral("subscribefeed")) {
+                    onSubscribeFeed(jsonObject[QStringLiteral("content")], sender);
                     return;
                 }
                 if (msg == QStringLiteral("start")) {
@@ -911,6 +951,7 @@ void TemplateInfoSenderBuilder::buildContext(bool forceReinit) {
     if (!glob.hasOwnProperty(QStringLiteral("workout")) || forceReinit) {
         obj = engine->newObject();
         glob.setProperty(QStringLiteral("workout"), obj);
+        workoutCreated = true;
     } else
         obj = glob.property(QStringLiteral("workout"));
 
@@ -944,14 +985,14 @@ void TemplateInfoSenderBuilder::buildContext(bool forceReinit) {
                 sett.setProperty(key, settLJ);
             }
         }
-        obj.setProperty(QStringLiteral("BIKE_TYPE"), (int)bluetoothdevice::BIKE);
-        obj.setProperty(QStringLiteral("ELLIPTICAL_TYPE"), (int)bluetoothdevice::ELLIPTICAL);
-        obj.setProperty(QStringLiteral("ROWING_TYPE"), (int)bluetoothdevice::ROWING);
-        obj.setProperty(QStringLiteral("TREADMILL_TYPE"), (int)bluetoothdevice::TREADMILL);
-        obj.setProperty(QStringLiteral("UNKNOWN_TYPE"), (int)bluetoothdevice::UNKNOWN);
+        setField(obj, QStringLiteral("BIKE_TYPE"), (int)bluetoothdevice::BIKE);
+        setField(obj, QStringLiteral("ELLIPTICAL_TYPE"), (int)bluetoothdevice::ELLIPTICAL);
+        setField(obj, QStringLiteral("ROWING_TYPE"), (int)bluetoothdevice::ROWING);
+        setField(obj, QStringLiteral("TREADMILL_TYPE"), (int)bluetoothdevice::TREADMILL);
+        setField(obj, QStringLiteral("UNKNOWN_TYPE"), (int)bluetoothdevice::UNKNOWN);
     }
     if (!device) {
-        obj.setProperty(QStringLiteral("deviceId"), QJSValue());
+        setField(obj, QStringLiteral("deviceId"), QJSValue());
     } else {
         QTime el = device->elapsedTime();
         QTime elLap = device->lapElapsedTime();
@@ -961,197 +1002,225 @@ void TemplateInfoSenderBuilder::buildContext(bool forceReinit) {
 
         metric dep;
 #ifdef Q_OS_IOS
-        obj.setProperty("deviceId", device->bluetoothDevice.deviceUuid().toString());
+        setField(obj, QStringLiteral("deviceId"), device->bluetoothDevice.deviceUuid().toString());
 #else
-        obj.setProperty(QStringLiteral("deviceId"), device->bluetoothDevice.address().toString());
+        setField(obj, QStringLiteral("deviceId"), device->bluetoothDevice.address().toString());
 #endif
-        obj.setProperty(QStringLiteral("deviceName"),
-                        (name = device->bluetoothDevice.name()).isEmpty() ? QString(QStringLiteral("N/A")) : name);
-        obj.setProperty(QStringLiteral("deviceRSSI"), device->bluetoothDevice.rssi());
-        obj.setProperty(QStringLiteral("deviceType"), (int)device->deviceType());
-        obj.setProperty(QStringLiteral("deviceConnected"), (bool)device->connected());
-        obj.setProperty(QStringLiteral("devicePaused"), (bool)device->isPaused());
-        obj.setProperty(QStringLiteral("elapsed_s"), el.second());
-        obj.setProperty(QStringLiteral("elapsed_m"), el.minute());
-        obj.setProperty(QStringLiteral("elapsed_h"), el.hour());
-        obj.setProperty(QStringLiteral("lapelapsed_s"), elLap.second());
-        obj.setProperty(QStringLiteral("lapelapsed_m"), elLap.minute());
-        obj.setProperty(QStringLiteral("lapelapsed_h"), elLap.hour());
+        setField(obj, QStringLiteral("deviceName"),
+                      (name = device->bluetoothDevice.name()).isEmpty() ? QString(QStringLiteral("N/A")) : name);
+        setField(obj, QStringLiteral("deviceRSSI"), device->bluetoothDevice.rssi());
+        setField(obj, QStringLiteral("deviceType"), (int)device->deviceType());
+        setField(obj, QStringLiteral("deviceConnected"), (bool)device->connected());
+        setField(obj, QStringLiteral("devicePaused"), (bool)device->isPaused());
+        setField(obj, QStringLiteral("elapsed_s"), el.second());
+        setField(obj, QStringLiteral("elapsed_m"), el.minute());
+        setField(obj, QStringLiteral("elapsed_h"), el.hour());
+        setField(obj, QStringLiteral("lapelapsed_s"), elLap.second());
+        setField(obj, QStringLiteral("lapelapsed_m"), elLap.minute());
+        setField(obj, QStringLiteral("lapelapsed_h"), elLap.hour());
         el = device->currentPace();
-        obj.setProperty(QStringLiteral("pace_s"), el.second());
-        obj.setProperty(QStringLiteral("pace_m"), el.minute());
-        obj.setProperty(QStringLiteral("pace_h"), el.hour());
-        obj.setProperty(QStringLiteral("pace_color"), homeform::singleton()->pace->valueFontColor());
+        setField(obj, QStringLiteral("pace_s"), el.second());
+        setField(obj, QStringLiteral("pace_m"), el.minute());
+        setField(obj, QStringLiteral("pace_h"), el.hour());
+        setField(obj, QStringLiteral("pace_color"), homeform::singleton()->pace->valueFontColor());
         el = device->averagePace();
-        obj.setProperty(QStringLiteral("avgpace_s"), el.second());
-        obj.setProperty(QStringLiteral("avgpace_m"), el.minute());
-        obj.setProperty(QStringLiteral("avgpace_h"), el.hour());
+        setField(obj, QStringLiteral("avgpace_s"), el.second());
+        setField(obj, QStringLiteral("avgpace_m"), el.minute());
+        setField(obj, QStringLiteral("avgpace_h"), el.hour());
         el = device->maxPace();
-        obj.setProperty(QStringLiteral("maxpace_s"), el.second());
-        obj.setProperty(QStringLiteral("maxpace_m"), el.minute());
-        obj.setProperty(QStringLiteral("maxpace_h"), el.hour());
+        setField(obj, QStringLiteral("maxpace_s"), el.second());
+        setField(obj, QStringLiteral("maxpace_m"), el.minute());
+        setField(obj, QStringLiteral("maxpace_h"), el.hour());
         el = device->movingTime();
-        obj.setProperty(QStringLiteral("moving_s"), el.second());
-        obj.setProperty(QStringLiteral("moving_m"), el.minute());
-        obj.setProperty(QStringLiteral("moving_h"), el.hour());
-        obj.setProperty(QStringLiteral("speed"), (dep = device->currentSpeed()).value());
-        obj.setProperty(QStringLiteral("speed_avg"), dep.average());
-        obj.setProperty(QStringLiteral("speed_color"), homeform::singleton()->speed->valueFontColor());
-        obj.setProperty(QStringLiteral("speed_lapavg"), dep.lapAverage());
-        obj.setProperty(QStringLiteral("speed_lapmax"), dep.lapMax());
-        obj.setProperty(QStringLiteral("calories"), device->calories().value());
-        obj.setProperty(QStringLiteral("distance"), device->odometer());
-        obj.setProperty(QStringLiteral("heart"), (dep = device->currentHeart()).value());
-        obj.setProperty(QStringLiteral("heart_color"), homeform::singleton()->heart->valueFontColor());
-        obj.setProperty(QStringLiteral("heart_avg"), dep.average());
-        obj.setProperty(QStringLiteral("heart_lapavg"), dep.lapAverage());
-        obj.setProperty(QStringLiteral("heart_max"), dep.max());
-        obj.setProperty(QStringLiteral("heart_lapmax"), dep.lapMax());
-        obj.setProperty(QStringLiteral("jouls"), device->jouls().value());
-        obj.setProperty(QStringLiteral("elevation"), device->elevationGain().value());
-        obj.setProperty(QStringLiteral("difficult"), device->difficult());
-        obj.setProperty(QStringLiteral("watts"), (dep = device->wattsMetric()).value());
-        obj.setProperty(QStringLiteral("watts_avg"), dep.average());
-        obj.setProperty(QStringLiteral("watts_color"), homeform::singleton()->watt->valueFontColor());
-        obj.setProperty(QStringLiteral("watts_lapavg"), dep.lapAverage());
-        obj.setProperty(QStringLiteral("watts_max"), dep.max());
-        obj.setProperty(QStringLiteral("watts_lapmax"), dep.lapMax());
-        obj.setProperty(QStringLiteral("kgwatts"), (dep = device->wattKg()).value());
-        obj.setProperty(QStringLiteral("kgwatts_avg"), dep.average());
-        obj.setProperty(QStringLiteral("kgwatts_max"), dep.max());
-        obj.setProperty(QStringLiteral("workoutName"), workoutName);
-        obj.setProperty(QStringLiteral("workoutStartDate"), workoutStartDate);
-        obj.setProperty(QStringLiteral("instructorName"), instructorName);
-        obj.setProperty(QStringLiteral("latitude"), device->currentCordinate().latitude());
-        obj.setProperty(QStringLiteral("longitude"), device->currentCordinate().longitude());
-        obj.setProperty(QStringLiteral("altitude"), device->currentCordinate().altitude());
-        obj.setProperty(QStringLiteral("peloton_offset"), pelotonOffset());
-        obj.setProperty(QStringLiteral("peloton_ask_start"), pelotonAskStart());
-        obj.setProperty(QStringLiteral("autoresistance"), homeform::singleton()->autoResistance());
+        setField(obj, QStringLiteral("moving_s"), el.second());
+        setField(obj, QStringLiteral("moving_m"), el.minute());
+        setField(obj, QStringLiteral("moving_h"), el.hour());
+        setField(obj, QStringLiteral("speed"), (dep = device->currentSpeed()).value());
+        setField(obj, QStringLiteral("speed_avg"), dep.average());
+        setField(obj, QStringLiteral("speed_color"), homeform::singleton()->speed->valueFontColor());
+        setField(obj, QStringLiteral("speed_lapavg"), dep.lapAverage());
+        setField(obj, QStringLiteral("speed_lapmax"), dep.lapMax());
+        setField(obj, QStringLiteral("calories"), device->calories().value());
+        setField(obj, QStringLiteral("distance"), device->odometer());
+        setField(obj, QStringLiteral("heart"), (dep = device->currentHeart()).value());
+        setField(obj, QStringLiteral("heart_color"), homeform::singleton()->heart->valueFontColor());
+        setField(obj, QStringLiteral("heart_avg"), dep.average());
+        setField(obj, QStringLiteral("heart_lapavg"), dep.lapAverage());
+        setField(obj, QStringLiteral("heart_max"), dep.max());
+        setField(obj, QStringLiteral("heart_lapmax"), dep.lapMax());
+        setField(obj, QStringLiteral("jouls"), device->jouls().value());
+        setField(obj, QStringLiteral("elevation"), device->elevationGain().value());
+        setField(obj, QStringLiteral("difficult"), device->difficult());
+        setField(obj, QStringLiteral("watts"), (dep = device->wattsMetric()).value());
+        setField(obj, QStringLiteral("watts_avg"), dep.average());
+        setField(obj, QStringLiteral("watts_color"), homeform::singleton()->watt->valueFontColor());
+        setField(obj, QStringLiteral("watts_lapavg"), dep.lapAverage());
+        setField(obj, QStringLiteral("watts_max"), dep.max());
+        setField(obj, QStringLiteral("watts_lapmax"), dep.lapMax());
+        // rolling averages of the samples of the last 3, 10 and 30 seconds
+        setField(obj, QStringLiteral("watts_3s"), dep.averageWindow(metric::WINDOW_3S));
+        setField(obj, QStringLiteral("watts_10s"), dep.averageWindow(metric::WINDOW_10S));
+        setField(obj, QStringLiteral("watts_30s"), dep.averageWindow(metric::WINDOW_30S));
+        setField(obj, QStringLiteral("kgwatts"), (dep = device->wattKg()).value());
+        setField(obj, QStringLiteral("kgwatts_avg"), dep.average());
+        setField(obj, QStringLiteral("kgwatts_max"), dep.max());
+        const PowerCurve &curve = homeform::singleton()->powerCurve();
+        setField(obj, QStringLiteral("watts_peak_5s"), curve.best(5));
+        setField(obj, QStringLiteral("watts_peak_1m"), curve.best(60));
+        setField(obj, QStringLiteral("watts_peak_5m"), curve.best(5 * 60));
+        setField(obj, QStringLiteral("watts_peak_20m"), curve.best(20 * 60));
+        // the whole curve, [[seconds, watts], ...], rebuilt only when it changes
+        if (forceReinit || !obj.hasOwnProperty(QStringLiteral("watts_curve")) ||
+            curve.version() != powerCurveVersion) {
+            const QVector<int> &durations = PowerCurve::durations();
+            QJSValue curveArray = engine->newArray();
+            quint32 n = 0;
+            for (int i = 0; i < durations.count() && durations.at(i) <= curve.count(); i++) {
+                QJSValue point = engine->newArray(2);
+                point.setProperty(0, durations.at(i));
+                point.setProperty(1, curve.bestAt(i));
+                curveArray.setProperty(n++, point);
+            }
+            obj.setProperty(QStringLiteral("watts_curve"), curveArray);
+            // not part of the session rows
+            QJsonArray curveJson;
+            for (int i = 0; i < durations.count() && durations.at(i) <= curve.count(); i++)
+                curveJson.append(QJsonArray({durations.at(i), curve.bestAt(i)}));
+            feed.set(feed.fieldId(QStringLiteral("watts_curve"), false), curveJson);
+            powerCurveVersion = curve.version();
+        }
+        setField(obj, QStringLiteral("workoutName"), workoutName);
+        setField(obj, QStringLiteral("workoutStartDate"), workoutStartDate);
+        setField(obj, QStringLiteral("instructorName"), instructorName);
+        setField(obj, QStringLiteral("latitude"), device->currentCordinate().latitude());
+        setField(obj, QStringLiteral("longitude"), device->currentCordinate().longitude());
+        setField(obj, QStringLiteral("altitude"), device->currentCordinate().altitude());
+        setField(obj, QStringLiteral("peloton_offset"), pelotonOffset());
+        setField(obj, QStringLiteral("peloton_ask_start"), pelotonAskStart());
+        setField(obj, QStringLiteral("autoresistance"), homeform::singleton()->autoResistance());
         if (homeform::singleton()->trainingProgram()) {
             el = homeform::singleton()->trainingProgram()->currentRowRemainingTime();
-            obj.setProperty(QStringLiteral("row_remaining_time_s"), el.second());
-            obj.setProperty(QStringLiteral("row_remaining_time_m"), el.minute());
-            obj.setProperty(QStringLiteral("row_remaining_time_h"), el.hour());
+            setField(obj, QStringLiteral("row_remaining_time_s"), el.second());
+            setField(obj, QStringLiteral("row_remaining_time_m"), el.minute());
+            setField(obj, QStringLiteral("row_remaining_time_h"), el.hour());
         } else {
-            obj.setProperty(QStringLiteral("row_remaining_time_s"), 0);
-            obj.setProperty(QStringLiteral("row_remaining_time_m"), 0);
-            obj.setProperty(QStringLiteral("row_remaining_time_h"), 0);
+            setField(obj, QStringLiteral("row_remaining_time_s"), 0);
+            setField(obj, QStringLiteral("row_remaining_time_m"), 0);
+            setField(obj, QStringLiteral("row_remaining_time_h"), 0);
         }
         if (homeform::singleton()->trainingProgram()) {
             el = homeform::singleton()->trainingProgram()->remainingTime();
-            obj.setProperty(QStringLiteral("remaining_time_s"), el.second());
-            obj.setProperty(QStringLiteral("remaining_time_m"), el.minute());
-            obj.setProperty(QStringLiteral("remaining_time_h"), el.hour());
+            setField(obj, QStringLiteral("remaining_time_s"), el.second());
+            setField(obj, QStringLiteral("remaining_time_m"), el.minute());
+            setField(obj, QStringLiteral("remaining_time_h"), el.hour());
         } else {
-            obj.setProperty(QStringLiteral("remaining_time_s"), 0);
-            obj.setProperty(QStringLiteral("remaining_time_m"), 0);
-            obj.setProperty(QStringLiteral("remaining_time_h"), 0);
+            setField(obj, QStringLiteral("remaining_time_s"), 0);
+            setField(obj, QStringLiteral("remaining_time_m"), 0);
+            setField(obj, QStringLiteral("remaining_time_h"), 0);
         }
-        obj.setProperty(
-            QStringLiteral("nickName"),
-            (nickName = settings.value(QZSettings::user_nickname, QZSettings::default_user_nickname).toString())
-                    .isEmpty()
-                ? QString(QStringLiteral("N/A"))
-                : nickName);
+        setField(obj, QStringLiteral("nickName"),
+                 (nickName = settings.value(QZSettings::user_nickname, QZSettings::default_user_nickname).toString())
+                         .isEmpty()
+                     ? QString(QStringLiteral("N/A"))
+                     : nickName);
         if (tp == bluetoothdevice::BIKE) {
-            obj.setProperty(QStringLiteral("gears"), ((bike *)device)->gears());
-            obj.setProperty(QStringLiteral("target_resistance"), ((bike *)device)->lastRequestedResistance().value());
-            obj.setProperty(QStringLiteral("target_peloton_resistance"),
-                            ((bike *)device)->lastRequestedPelotonResistance().value());
-            obj.setProperty(QStringLiteral("target_cadence"), ((bike *)device)->lastRequestedCadence().value());
-            obj.setProperty(QStringLiteral("target_power"), ((bike *)device)->lastRequestedPower().value());
-            obj.setProperty(QStringLiteral("power_zone"), ((bike *)device)->currentPowerZone().value());
-            obj.setProperty(QStringLiteral("power_zone_lapavg"), ((bike *)device)->currentPowerZone().lapAverage());
-            obj.setProperty(QStringLiteral("power_zone_lapmax"), ((bike *)device)->currentPowerZone().lapMax());
-            obj.setProperty(QStringLiteral("target_power_zone"), ((bike *)device)->targetPowerZone().value());
-            obj.setProperty(QStringLiteral("power_zone_color"), homeform::singleton()->ftp->valueFontColor());
-            obj.setProperty(QStringLiteral("peloton_resistance"),
-                            (dep = ((bike *)device)->pelotonResistance()).value());
-            obj.setProperty(QStringLiteral("peloton_resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("peloton_resistance_color"), homeform::singleton()->peloton_resistance->valueFontColor());
-            obj.setProperty(QStringLiteral("peloton_resistance_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("peloton_resistance_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("peloton_req_resistance"),
-                            (dep = ((bike *)device)->lastRequestedPelotonResistance()).value());
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((bike *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("cadence_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("resistance"), (dep = ((bike *)device)->currentResistance()).value());
-            obj.setProperty(QStringLiteral("resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("resistance_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("resistance_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("cranks"), ((bike *)device)->currentCrankRevolutions());
-            obj.setProperty(QStringLiteral("cranktime"), ((bike *)device)->lastCrankEventTime());
-            obj.setProperty(QStringLiteral("req_power"), (dep = ((bike *)device)->lastRequestedPower()).value());
-            obj.setProperty(QStringLiteral("req_cadence"), (dep = ((bike *)device)->lastRequestedCadence()).value());
-            obj.setProperty(QStringLiteral("req_resistance"),
-                            (dep = ((bike *)device)->lastRequestedResistance()).value());
+            setField(obj, QStringLiteral("gears"), ((bike *)device)->gears());
+            setField(obj, QStringLiteral("target_resistance"), ((bike *)device)->lastRequestedResistance().value());
+            setField(obj, QStringLiteral("target_peloton_resistance"),
+                          ((bike *)device)->lastRequestedPelotonResistance().value());
+            setField(obj, QStringLiteral("target_cadence"), ((bike *)device)->lastRequestedCadence().value());
+            setField(obj, QStringLiteral("target_power"), ((bike *)device)->lastRequestedPower().value());
+            setField(obj, QStringLiteral("power_zone"), ((bike *)device)->currentPowerZone().value());
+            setField(obj, QStringLiteral("power_zone_lapavg"), ((bike *)device)->currentPowerZone().lapAverage());
+            setField(obj, QStringLiteral("power_zone_lapmax"), ((bike *)device)->currentPowerZone().lapMax());
+            setField(obj, QStringLiteral("target_power_zone"), ((bike *)device)->targetPowerZone().value());
+            setField(obj, QStringLiteral("power_zone_color"), homeform::singleton()->ftp->valueFontColor());
+            setField(obj, QStringLiteral("peloton_resistance"),
+                          (dep = ((bike *)device)->pelotonResistance()).value());
+            setField(obj, QStringLiteral("peloton_resistance_avg"), dep.average());
+            setField(obj, QStringLiteral("peloton_resistance_color"), homeform::singleton()->peloton_resistance->valueFontColor());
+            setField(obj, QStringLiteral("peloton_resistance_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("peloton_resistance_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("peloton_req_resistance"),
+                          (dep = ((bike *)device)->lastRequestedPelotonResistance()).value());
+            setField(obj, QStringLiteral("cadence"), (dep = ((bike *)device)->currentCadence()).value());
+            setField(obj, QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
+            setField(obj, QStringLiteral("cadence_avg"), dep.average());
+            setField(obj, QStringLiteral("cadence_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("cadence_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("resistance"), (dep = ((bike *)device)->currentResistance()).value());
+            setField(obj, QStringLiteral("resistance_avg"), dep.average());
+            setField(obj, QStringLiteral("resistance_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("resistance_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("cranks"), ((bike *)device)->currentCrankRevolutions());
+            setField(obj, QStringLiteral("cranktime"), ((bike *)device)->lastCrankEventTime());
+            setField(obj, QStringLiteral("req_power"), (dep = ((bike *)device)->lastRequestedPower()).value());
+            setField(obj, QStringLiteral("req_cadence"), (dep = ((bike *)device)->lastRequestedCadence()).value());
+            setField(obj, QStringLiteral("req_resistance"),
+                          (dep = ((bike *)device)->lastRequestedResistance()).value());
         } else if (tp == bluetoothdevice::ROWING) {
-            obj.setProperty(QStringLiteral("gears"), ((rower *)device)->gears());
+            setField(obj, QStringLiteral("gears"), ((rower *)device)->gears());
             el = ((rower *)device)->lastRequestedPace();
-            obj.setProperty(QStringLiteral("target_speed"), ((rower *)device)->lastRequestedSpeed().value());
-            obj.setProperty(QStringLiteral("target_pace_s"), el.second());
-            obj.setProperty(QStringLiteral("target_pace_m"), el.minute());
-            obj.setProperty(QStringLiteral("target_pace_h"), el.hour());
-            obj.setProperty(QStringLiteral("peloton_resistance"),
-                            (dep = ((rower *)device)->pelotonResistance()).value());
-            obj.setProperty(QStringLiteral("peloton_resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((rower *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("cadence_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("target_speed"), ((rower *)device)->lastRequestedSpeed().value());
+            setField(obj, QStringLiteral("target_pace_s"), el.second());
+            setField(obj, QStringLiteral("target_pace_m"), el.minute());
+            setField(obj, QStringLiteral("target_pace_h"), el.hour());
+            setField(obj, QStringLiteral("peloton_resistance"),
+                          (dep = ((rower *)device)->pelotonResistance()).value());
+            setField(obj, QStringLiteral("peloton_resistance_avg"), dep.average());
+            setField(obj, QStringLiteral("cadence"), (dep = ((rower *)device)->currentCadence()).value());
+            setField(obj, QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
+            setField(obj, QStringLiteral("cadence_avg"), dep.average());
+            setField(obj, QStringLiteral("cadence_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("cadence_lapmax"), dep.lapMax());
 
             // use to preserve compatibility to dochart.js and floating.htm
-            obj.setProperty(QStringLiteral("req_cadence"), (dep = ((rower *)device)->lastRequestedCadence()).value());
-            obj.setProperty(QStringLiteral("target_cadence"), (dep = ((rower *)device)->lastRequestedCadence()).value());
+            setField(obj, QStringLiteral("req_cadence"), (dep = ((rower *)device)->lastRequestedCadence()).value());
+            setField(obj, QStringLiteral("target_cadence"), (dep = ((rower *)device)->lastRequestedCadence()).value());
             
-            obj.setProperty(QStringLiteral("resistance"), (dep = ((rower *)device)->currentResistance()).value());
-            obj.setProperty(QStringLiteral("resistance_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cranks"), ((rower *)device)->currentCrankRevolutions());
-            obj.setProperty(QStringLiteral("cranktime"), ((rower *)device)->lastCrankEventTime());
-            obj.setProperty(QStringLiteral("strokescount"), ((rower *)device)->currentStrokesCount().value());
-            obj.setProperty(QStringLiteral("strokeslength"), ((rower *)device)->currentStrokesLength().value());
+            setField(obj, QStringLiteral("resistance"), (dep = ((rower *)device)->currentResistance()).value());
+            setField(obj, QStringLiteral("resistance_avg"), dep.average());
+            setField(obj, QStringLiteral("cranks"), ((rower *)device)->currentCrankRevolutions());
+            setField(obj, QStringLiteral("cranktime"), ((rower *)device)->lastCrankEventTime());
+            setField(obj, QStringLiteral("strokescount"), ((rower *)device)->currentStrokesCount().value());
+            setField(obj, QStringLiteral("strokeslength"), ((rower *)device)->currentStrokesLength().value());
         } else if (tp == bluetoothdevice::TREADMILL) {
-            obj.setProperty(QStringLiteral("target_speed"), ((treadmill *)device)->lastRequestedSpeed().value());
+            setField(obj, QStringLiteral("target_speed"), ((treadmill *)device)->lastRequestedSpeed().value());
             el = ((treadmill *)device)->lastRequestedPace();
-            obj.setProperty(QStringLiteral("target_pace_s"), el.second());
-            obj.setProperty(QStringLiteral("target_pace_m"), el.minute());
-            obj.setProperty(QStringLiteral("target_pace_h"), el.hour());
-            obj.setProperty(QStringLiteral("target_inclination"),
-                            ((treadmill *)device)->lastRequestedInclination().value());
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((treadmill *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("cadence_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("inclination"), (dep = ((treadmill *)device)->currentInclination()).value());
-            obj.setProperty(QStringLiteral("inclination_avg"), dep.average());
-            obj.setProperty(QStringLiteral("inclination_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("inclination_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("stridelength"),
-                            (dep = ((treadmill *)device)->currentStrideLength()).value());
-            obj.setProperty(QStringLiteral("groundcontact"),
-                            (dep = ((treadmill *)device)->currentGroundContact()).value());
-            obj.setProperty(QStringLiteral("verticaloscillation"),
-                            (dep = ((treadmill *)device)->currentVerticalOscillation()).value());
+            setField(obj, QStringLiteral("target_pace_s"), el.second());
+            setField(obj, QStringLiteral("target_pace_m"), el.minute());
+            setField(obj, QStringLiteral("target_pace_h"), el.hour());
+            setField(obj, QStringLiteral("target_inclination"),
+                          ((treadmill *)device)->lastRequestedInclination().value());
+            setField(obj, QStringLiteral("cadence"), (dep = ((treadmill *)device)->currentCadence()).value());
+            setField(obj, QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
+            setField(obj, QStringLiteral("cadence_avg"), dep.average());
+            setField(obj, QStringLiteral("cadence_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("cadence_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("inclination"), (dep = ((treadmill *)device)->currentInclination()).value());
+            setField(obj, QStringLiteral("inclination_avg"), dep.average());
+            setField(obj, QStringLiteral("inclination_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("inclination_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("stridelength"),
+                          (dep = ((treadmill *)device)->currentStrideLength()).value());
+            setField(obj, QStringLiteral("groundcontact"),
+                          (dep = ((treadmill *)device)->currentGroundContact()).value());
+            setField(obj, QStringLiteral("verticaloscillation"),
+                          (dep = ((treadmill *)device)->currentVerticalOscillation()).value());
         } else if (tp == bluetoothdevice::ELLIPTICAL) {
-            obj.setProperty(QStringLiteral("cadence"), (dep = ((elliptical *)device)->currentCadence()).value());
-            obj.setProperty(QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
-            obj.setProperty(QStringLiteral("cadence_avg"), dep.average());
-            obj.setProperty(QStringLiteral("cadence_lapavg"), dep.lapAverage());
-            obj.setProperty(QStringLiteral("cadence_lapmax"), dep.lapMax());
-            obj.setProperty(QStringLiteral("inclination"),
-                            (dep = ((elliptical *)device)->currentInclination()).value());
-            obj.setProperty(QStringLiteral("inclination_avg"), dep.average());
-        }
-        if (!device->isPaused()) {
-            sessionArray.append(QJsonObject::fromVariantMap(obj.toVariant().toMap()));
+            setField(obj, QStringLiteral("cadence"), (dep = ((elliptical *)device)->currentCadence()).value());
+            setField(obj, QStringLiteral("cadence_color"), homeform::singleton()->cadence->valueFontColor());
+            setField(obj, QStringLiteral("cadence_avg"), dep.average());
+            setField(obj, QStringLiteral("cadence_lapavg"), dep.lapAverage());
+            setField(obj, QStringLiteral("cadence_lapmax"), dep.lapMax());
+            setField(obj, QStringLiteral("inclination"),
+                          (dep = ((elliptical *)device)->currentInclination()).value());
+            setField(obj, QStringLiteral("inclination_avg"), dep.average());
         }
     }
+    // the paused ticks aren't part of the session: their changes go with the next recorded row
+    feed.commit(device && !device->isPaused());
+    workoutCreated = false;
 }
 
 void TemplateInfoSenderBuilder::workoutEventStateChanged(bluetoothdevice::WORKOUT_EVENT_STATE state) {
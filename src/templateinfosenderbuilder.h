@@ -2,10 +2,12 @@
 #define TEMPLATEINFOSENDERBUILDER_H
 #include "devices/bluetoothdevice.h"
 #include "templateinfosender.h"
+#include "templatetelemetryfeed.h"
 #include <QHash>
 #include <QJSEngine>
 #include <QJsonArray>
 #include <QSettings>
+#include <type_traits>
 
 #define TEMPLATE_TYPE_TCPCLIENT QStringLiteral("TcpClient")
 #define TEMPLATE_TYPE_WEBSERVER QStringLiteral("WebServer")
@@ -49,7 +51,10 @@ class TemplateInfoSenderBuilder : public QObject {
     QTimer updateTimer;
     QString masterId;
     QStringList foldersToLook;
-    QJsonArray sessionArray;
+    // the workout values of every tick, with the history of the session
+    TemplateTelemetryFeed feed;
+    // the workout object was just created: all its properties must be set
+    bool workoutCreated = false;
     QHash<QString, QVariant> context;
     QJSEngine *engine = nullptr;
     TemplateInfoSenderBuilder(QObject *parent);
@@ -81,7 +86,8 @@ class TemplateInfoSenderBuilder : public QObject {
     void onLoadTrainingPrograms(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
     void onGetTrainingProgram(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
     void onAppendActivityDescription(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
-    void onGetSessionArray(TemplateInfoSender *tempSender);
+    void onGetSessionArray(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
+    void onSubscribeFeed(const QJsonValue &msgContent, TemplateInfoSender *tempSender);
     void onGetLatLon(TemplateInfoSender *tempSender);
     void onNextInclination300Meters(TemplateInfoSender *tempSender);
     void onGetGPXBase64(TemplateInfoSender *tempSender);
@@ -91,6 +97,26 @@ class TemplateInfoSenderBuilder : public QObject {
     QString workoutName = QStringLiteral("");
     QString workoutStartDate = QStringLiteral("");
     QString instructorName = QStringLiteral("");
+    // version of the power curve last copied into the context, see PowerCurve::version()
+    quint32 powerCurveVersion = 0;
+
+    static QJsonValue jsonOf(bool value) { return QJsonValue(value); }
+    static QJsonValue jsonOf(const QString &value) { return QJsonValue(value); }
+    static QJsonValue jsonOf(const QJSValue &value) {
+        return value.isUndefined() ? QJsonValue(QJsonValue::Undefined) : QJsonValue::fromVariant(value.toVariant());
+    }
+    template <typename T>
+    static typename std::enable_if<std::is_arithmetic<T>::value, QJsonValue>::type jsonOf(T value) {
+        return QJsonValue((double)value);
+    }
+    /**
+     * @brief Sets a field of the workout both in the feed and in the template object, which is only touched when the
+     * value changes.
+     */
+    template <typename T> void setField(QJSValue &obj, const QString &name, const T &value) {
+        if (feed.set(feed.fieldId(name), jsonOf(value)) || workoutCreated)
+            obj.setProperty(name, value);
+    }
   private slots:
     void onUpdateTimeout();
     void onDataReceived(const QByteArray &data);
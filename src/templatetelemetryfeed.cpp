@@ -0,0 +1,281 @@
+#include "templatetelemetryfeed.h"
+
+#include <QJsonDocument>
+#include <QtEndian>
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+static const QJsonValue undefinedValue(QJsonValue::Undefined);
+
+TemplateTelemetryFeed::TemplateTelemetryFeed(int historyCapacity) : capacity(qMax(1, historyCapacity)) {}
+
+int TemplateTelemetryFeed::fieldId(const QString &name, bool recorded) {
+    QHash<QString, int>::const_iterator it = ids.constFind(name);
+    if (it != ids.constEnd())
+        return it.value();
+    const int id = names.count();
+    names.append(name);
+    ids.insert(name, id);
+    recordedField.append(recorded);
+    current.append(undefinedValue);
+    tickDirty.resize(id + 1);
+    historyDirty.resize(id + 1);
+    return id;
+}
+
+const QJsonValue &TemplateTelemetryFeed::value(int id) const {
+    return id >= 0 && id < current.count() ? current.at(id) : undefinedValue;
+}
+
+void TemplateTelemetryFeed::markDirty(QBitArray &flags, QVector<int> &dirtyIds, int id) {
+    if (!flags.testBit(id)) {
+        flags.setBit(id);
+        dirtyIds.append(id);
+    }
+}
+
+bool TemplateTelemetryFeed::set(int id, const QJsonValue &value) {
+    if (id < 0 || id >= current.count())
+        return false;
+    QJsonValue &old = current[id];
+    if (old == value)
+        return false;
+    old = value;
+    markDirty(tickDirty, tickIds, id);
+    if (recordedField.at(id))
+        markDirty(historyDirty, historyIds, id);
+    return true;
+}
+
+quint32 TemplateTelemetryFeed::commit(bool record) {
+    tick++;
+    std::sort(tickIds.begin(), tickIds.end());
+    lastDelta.clear();
+    lastDelta.reserve(tickIds.count());
+    for (int id : qAsConst(tickIds)) {
+        lastDelta.append(qMakePair(id, current.at(id)));
+        tickDirty.clearBit(id);
+    }
+    tickIds.clear();
+    firstNewField = registeredAtCommit;
+    lastNewField = registeredAtCommit = names.count();
+
+    if (record) {
+        if (ring.isEmpty())
+            ring.resize(capacity);
+        historyRow &row = ring[(int)(recorded % capacity)];
+        if (recorded >= (quint64)capacity) {
+            // the oldest row leaves the ring: it becomes part of the base
+            apply(base, row.delta);
+        }
+        std::sort(historyIds.begin(), historyIds.end());
+        row.delta.clear();
+        row.delta.reserve(historyIds.count());
+        for (int id : qAsConst(historyIds)) {
+            row.delta.append(qMakePair(id, current.at(id)));
+            historyDirty.clearBit(id);
+        }
+        historyIds.clear();
+        row.keyframe.clear();
+        if (recorded % KEYFRAME_INTERVAL == KEYFRAME_INTERVAL - 1) {
+            row.keyframe = current;
+            // the fields left out of the history aren't part of the keyframes either
+            for (int i = 0; i < row.keyframe.count(); i++)
+                if (!recordedField.at(i))
+                    row.keyframe[i] = undefinedValue;
+        }
+        recorded++;
+    }
+    return tick;
+}
+
+QJsonObject TemplateTelemetryFeed::newFields() const {
+    QJsonObject fields;
+    for (int id = firstNewField; id < lastNewField; id++)
+        fields.insert(QString::number(id), names.at(id));
+    return fields;
+}
+
+QByteArray TemplateTelemetryFeed::deltaJson() const {
+    QJsonObject content;
+    for (const QPair<int, QJsonValue> &d : lastDelta)
+        content.insert(QString::number(d.first), d.second.isUndefined() ? QJsonValue() : d.second);
+    QJsonObject main;
+    main[QStringLiteral("msg")] = QStringLiteral("workoutdelta");
+    main[QStringLiteral("seq")] = (qint64)tick;
+    if (lastNewField > firstNewField)
+        main[QStringLiteral("fields")] = newFields();
+    main[QStringLiteral("content")] = content;
+    return QJsonDocument(main).toJson(QJsonDocument::Compact);
+}
+
+static void appendLE16(QByteArray &out, quint16 v) {
+    out.append((char)(v & 0xFF));
+    out.append((char)(v >> 8));
+}
+
+static void appendLE32(QByteArray &out, quint32 v) {
+    for (int i = 0; i < 4; i++)
+        out.append((char)((v >> (8 * i)) & 0xFF));
+}
+
+QByteArray TemplateTelemetryFeed::deltaBinary() const {
+    QByteArray out;
+    out.reserve(9 + lastDelta.count() * 12);
+    out.append('Q');
+    out.append((char)BINARY_VERSION);
+    appendLE32(out, tick);
+    appendLE16(out, (quint16)lastDelta.count());
+    for (const QPair<int, QJsonValue> &d : lastDelta) {
+        appendLE16(out, (quint16)d.first);
+        const QJsonValue &v = d.second;
+        if (v.isBool()) {
+            out.append((char)(v.toBool() ? BinaryTrue : BinaryFalse));
+        } else if (v.isDouble()) {
+            const double n = v.toDouble();
+            if (n == std::floor(n) && n >= -2147483648.0 && n <= 2147483647.0) {
+                out.append((char)BinaryInt);
+                appendLE32(out, (quint32)(qint32)n);
+            } else {
+                out.append((char)BinaryDouble);
+                quint64 bits;
+                memcpy(&bits, &n, sizeof(bits));
+                appendLE32(out, (quint32)(bits & 0xFFFFFFFFu));
+                appendLE32(out, (quint32)(bits >> 32));
+            }
+        } else if (v.isString()) {
+            const QByteArray utf8 = v.toString().toUtf8().left(0xFFFF);
+            out.append((char)BinaryString);
+            appendLE16(out, (quint16)utf8.size());
+            out.append(utf8);
+        } else {
+            // null, undefined, and arrays or objects, which only go through the JSON feed
+            out.append((char)BinaryNull);
+        }
+    }
+    return out;
+}
+
+QJsonValue TemplateTelemetryFeed::fromBinary(const QByteArray &frame, int &pos, bool &ok) {
+    ok = false;
+    if (pos >= frame.size())
+        return QJsonValue();
+    const uchar *p = reinterpret_cast<const uchar *>(frame.constData());
+    const quint8 type = p[pos++];
+    switch (type) {
+    case BinaryNull:
+        ok = true;
+        return QJsonValue();
+    case BinaryFalse:
+    case BinaryTrue:
+        ok = true;
+        return QJsonValue(type == BinaryTrue);
+    case BinaryInt:
+        if (pos + 4 > frame.size())
+            return QJsonValue();
+        ok = true;
+        pos += 4;
+        return QJsonValue((double)qFromLittleEndian<qint32>(p + pos - 4));
+    case BinaryDouble: {
+        if (pos + 8 > frame.size())
+            return QJsonValue();
+        const quint64 bits = qFromLittleEndian<quint64>(p + pos);
+        double n;
+        memcpy(&n, &bits, sizeof(n));
+        ok = true;
+        pos += 8;
+        return QJsonValue(n);
+    }
+    case BinaryString: {
+        if (pos + 2 > frame.size())
+            return QJsonValue();
+        const int len = qFromLittleEndian<quint16>(p + pos);
+        if (pos + 2 + len > frame.size())
+            return QJsonValue();
+        ok = true;
+        pos += 2 + len;
+        return QJsonValue(QString::fromUtf8(frame.constData() + pos - len, len));
+    }
+    default:
+        return QJsonValue();
+    }
+}
+
+QJsonObject TemplateTelemetryFeed::snapshot() const {
+    QJsonObject fields;
+    QJsonObject content;
+    for (int id = 0; id < names.count(); id++) {
+        fields.insert(QString::number(id), names.at(id));
+        if (!current.at(id).isUndefined())
+            content.insert(QString::number(id), current.at(id));
+    }
+    QJsonObject main;
+    main[QStringLiteral("seq")] = (qint64)tick;
+    main[QStringLiteral("fields")] = fields;
+    main[QStringLiteral("content")] = content;
+    return main;
+}
+
+void TemplateTelemetryFeed::clearHistory() {
+    ring.clear();
+    recorded = 0;
+    base.clear();
+    // the first row recorded from now on must carry the whole state
+    historyIds.clear();
+    historyDirty.fill(false);
+    for (int id = 0; id < current.count(); id++)
+        if (recordedField.at(id) && !current.at(id).isUndefined())
+            markDirty(historyDirty, historyIds, id);
+}
+
+void TemplateTelemetryFeed::apply(QVector<QJsonValue> &state, const deltaList &delta) {
+    for (const QPair<int, QJsonValue> &d : delta) {
+        if (d.first >= state.count())
+            state.resize(d.first + 1);
+        state[d.first] = d.second;
+    }
+}
+
+QJsonObject TemplateTelemetryFeed::toRow(const QVector<QJsonValue> &state) const {
+    QJsonObject row;
+    for (int id = 0; id < state.count(); id++) {
+        if (!state.at(id).isUndefined())
+            row.insert(names.at(id), state.at(id));
+    }
+    return row;
+}
+
+QJsonArray TemplateTelemetryFeed::rows(quint64 cursor, int limit, quint64 *next) const {
+    QJsonArray out;
+    const quint64 first = firstRow();
+    if (cursor < first)
+        cursor = first;
+    quint64 end = recorded;
+    if (limit > 0 && cursor + (quint64)limit < end)
+        end = cursor + limit;
+    if (next)
+        *next = qMax(cursor, end);
+    if (cursor >= end)
+        return out;
+
+    // the state before the row at cursor: the closest keyframe still in the ring, or the base
+    QVector<QJsonValue> state = base;
+    quint64 from = first;
+    if (cursor > 0) {
+        const quint64 lastBefore = cursor - 1;
+        // keyframes are on the rows KEYFRAME_INTERVAL - 1, 2 * KEYFRAME_INTERVAL - 1, ...
+        const quint64 keyframeRow = lastBefore - (lastBefore + 1) % KEYFRAME_INTERVAL;
+        if (keyframeRow <= lastBefore && keyframeRow >= first) {
+            state = ring.at((int)(keyframeRow % capacity)).keyframe;
+            from = keyframeRow + 1;
+        }
+    }
+    for (quint64 n = from; n < cursor; n++)
+        apply(state, ring.at((int)(n % capacity)).delta);
+    for (quint64 n = cursor; n < end; n++) {
+        apply(state, ring.at((int)(n % capacity)).delta);
+        out.append(toRow(state));
+    }
+    return out;
+}
@@ -0,0 +1,141 @@
+#ifndef TEMPLATETELEMETRYFEED_H
+#define TEMPLATETELEMETRYFEED_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+/**
+ * @brief The workout values published to the templates, as a feed of deltas.
+ * Every field gets a numeric id the first time it's set; ids are never reused, so a client that received the schema
+ * once only needs the new fields afterwards. Each tick (commit()) produces the delta of the fields whose value
+ * changed, encoded at most once per tick as JSON text or as a binary frame, whatever the number of clients.
+ * The recorded ticks are kept in a bounded history: the deltas in a ring, a keyframe (the whole row) every
+ * KEYFRAME_INTERVAL rows and the row preceding the oldest one, so any page of rows can be rebuilt by replaying at
+ * most KEYFRAME_INTERVAL deltas. Rows are addressed by a cursor, the index of the row since clearHistory(), which
+ * stays valid while the oldest rows are dropped.
+ *
+ * Binary frame (little endian): 'Q', version (1), seq (u32), count (u16), then count times
+ * id (u16), type (u8) and the value: 0 null, 1 false, 2 true, 3 f64, 4 i32, 5 string (u16 length + UTF-8).
+ */
+class TemplateTelemetryFeed {
+  public:
+    static constexpr int DEFAULT_HISTORY = 6 * 3600;
+    static constexpr int KEYFRAME_INTERVAL = 64;
+    static constexpr quint8 BINARY_VERSION = 1;
+
+    enum binaryType : quint8 { BinaryNull, BinaryFalse, BinaryTrue, BinaryDouble, BinaryInt, BinaryString };
+
+    explicit TemplateTelemetryFeed(int historyCapacity = DEFAULT_HISTORY);
+
+    /**
+     * @brief The id of the field, registering it the first time.
+     * @param recorded false for the fields left out of the history rows (e.g. big arrays changing often).
+     */
+    int fieldId(const QString &name, bool recorded = true);
+    int fieldCount() const { return names.count(); }
+    QString fieldName(int id) const { return names.value(id); }
+
+    /**
+     * @brief Sets the value of a field for the current tick.
+     * @return true if the value differs from the current one.
+     */
+    bool set(int id, const QJsonValue &value);
+    const QJsonValue &value(int id) const;
+
+    /**
+     * @brief Closes the tick: the changed fields become the delta of this tick.
+     * @param record true to append a row to the history (e.g. false while the workout is paused).
+     * @return the sequence number of the tick.
+     */
+    quint32 commit(bool record);
+    quint32 seq() const { return tick; }
+
+    /**
+     * @brief The changed fields of the last tick, by id.
+     */
+    const QVector<QPair<int, QJsonValue>> &delta() const { return lastDelta; }
+
+    /**
+     * @brief The fields registered during the last tick, {id: name}, empty if none.
+     */
+    QJsonObject newFields() const;
+
+    /**
+     * @brief {"msg": "workoutdelta", "seq", "fields" (only the new ones), "content": {id: value}}.
+     */
+    QByteArray deltaJson() const;
+    QByteArray deltaBinary() const;
+
+    /**
+     * @brief The whole current state, for a client joining the feed: {"seq", "fields": {id: name},
+     * "content": {id: value}}.
+     */
+    QJsonObject snapshot() const;
+
+    void clearHistory();
+    int historyCapacity() const { return capacity; }
+    /**
+     * @brief Cursor of the oldest row still in the history.
+     */
+    quint64 firstRow() const { return recorded > (quint64)capacity ? recorded - capacity : 0; }
+    /**
+     * @brief Cursor of the next row to be recorded.
+     */
+    quint64 endRow() const { return recorded; }
+
+    /**
+     * @brief Up to limit rows from the cursor specified (moved to firstRow() if the rows are gone), as objects
+     * {name: value}. A limit <= 0 means all the rows.
+     * @param next receives the cursor following the last row returned.
+     */
+    QJsonArray rows(quint64 cursor, int limit, quint64 *next = nullptr) const;
+
+    static QJsonValue fromBinary(const QByteArray &frame, int &pos, bool &ok);
+
+  private:
+    typedef QVector<QPair<int, QJsonValue>> deltaList;
+
+    struct historyRow {
+        deltaList delta;
+        // the whole row after this delta, only every KEYFRAME_INTERVAL rows
+        QVector<QJsonValue> keyframe;
+    };
+
+    static void apply(QVector<QJsonValue> &state, const deltaList &delta);
+    QJsonObject toRow(const QVector<QJsonValue> &state) const;
+    void markDirty(QBitArray &flags, QVector<int> &ids, int id);
+
+    QStringList names;
+    QHash<QString, int> ids;
+    QVector<bool> recordedField;
+    QVector<QJsonValue> current;
+
+    // changes since the last commit, and since the last recorded row
+    QBitArray tickDirty;
+    QVector<int> tickIds;
+    QBitArray historyDirty;
+    QVector<int> historyIds;
+    // fields registered before the last commit, and the ones registered during the last tick
+    int registeredAtCommit = 0;
+    int firstNewField = 0;
+    int lastNewField = 0;
+
+    quint32 tick = 0;
+    deltaList lastDelta;
+
+    int capacity;
+    QVector<historyRow> ring;
+    quint64 recorded = 0;
+    // the row before firstRow()
+    QVector<QJsonValue> base;
+};
+
+#endif // TEMPLATETELEMETRYFEED_H
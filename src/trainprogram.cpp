@@ -58,6 +58,8 @@ trainprogram::trainprogram(const QList<trainrow> &rows, bluetooth *b, QString *d
     if (rows.length() && !isnan(rows.at(0).latitude) && !isnan(rows.at(0).longitude) &&
         QTime(0, 0, 0).secsTo(rows.at(0).gpxElapsed) != 0 && !treadmill_force_speed && videoAvailable) {
         applySpeedFilter();
+    } else {
+        rebuildTimeline();
     }
 
     this->videoAvailable = videoAvailable;
@@ -174,20 +176,32 @@ void trainprogram::applySpeedFilter() {
     for (r = 0; r < rows.length(); r++) {
         rows[r].distance = newdistance.at(r);
     }
+    rebuildTimeline();
+}
+
+void trainprogram::rebuildTimeline() {
+    timeline.build(rows);
+    lookahead.build(rows);
+}
+
+const trainprogramtimeline &trainprogram::rowsTimeline() {
+    // rows is public: a change not followed by rebuildTimeline() shows up at least as a different row count
+    if (timeline.count() != rows.length())
+        rebuildTimeline();
+    return timeline;
+}
+
+trainprogramlookahead &trainprogram::rowsLookahead() {
+    if (lookahead.count() != rows.length())
+        rebuildTimeline();
+    return lookahead;
 }
 
 uint32_t trainprogram::calculateTimeForRow(int32_t row) {
     if (row >= rows.length())
         return 0;
 
-    if (rows.at(row).distance == -1)
-        return (rows.at(row).duration.second() + (rows.at(row).duration.minute() * 60) +
-                (rows.at(row).duration.hour() * 3600));
-    else {
-        if(rows.at(row).started.isValid() && rows.at(row).ended.isValid())
-            return rows.at(row).started.secsTo(rows.at(row).ended);
-    }
-    return 0;
+    return trainprogramtimeline::timeForRow(rows.at(row));
 }
 
 double trainprogram::calculateDistanceForRow(int32_t row) {
@@ -201,63 +215,13 @@ double trainprogram::calculateDistanceForRow(int32_t row) {
 }
 
 // meters, inclination
-QList<MetersByInclination> trainprogram::inclinationNext300Meters() {
-    int c = currentStep;
-    double km = 0;
-    QList<MetersByInclination> next300;
-
-    while (1) {
-        if (c < rows.length()) {
-            if (km > 0.3) {
-                return next300;
-            }
-            MetersByInclination p;
-            if (c == currentStep) {
-                p.meters = (rows.at(c).distance - currentStepDistance) * 1000.0;
-                km += (rows.at(c).distance - currentStepDistance);
-            } else {
-                p.meters = (rows.at(c).distance) * 1000.0;
-                km += (rows.at(c).distance);
-            }
-            p.inclination = rows.at(c).inclination;
-            next300.append(p);
-
-        } else {
-            return next300;
-        }
-        c++;
-    }
-    return next300;
+QVector<MetersByInclination> trainprogram::inclinationNext300Meters() {
+    return rowsLookahead().inclinationNext300Meters(currentStep, currentStepDistance);
 }
 
 // meters, inclination
-QList<MetersByInclination> trainprogram::avgInclinationNext300Meters() {
-    int c = currentStep;
-    double km = 0;
-    QList<MetersByInclination> next300;
-
-    while (1) {
-        if (c < rows.length()) {
-            if (km > 0.3) {
-                return next300;
-            }
-            MetersByInclination p;
-            if (c == currentStep) {
-                p.meters = (rows.at(c).distance - currentStepDistance) * 1000.0;
-                km += (rows.at(c).distance - currentStepDistance);
-            } else {
-                p.meters = (rows.at(c).distance) * 1000.0;
-                km += (rows.at(c).distance);
-            }
-            p.inclination = avgInclinationNext100Meters(c);
-            next300.append(p);
-
-        } else {
-            return next300;
-        }
-        c++;
-    }
-    return next300;
+QVector<MetersByInclination> trainprogram::avgInclinationNext300Meters() {
+    return rowsLookahead().avgInclinationNext300Meters(currentStep, currentStepDistance);
 }
 
 // speed in Km/h
@@ -368,152 +332,25 @@ double trainprogram::TimeRateFromGPX(double gpxsecs, double videosecs, double cu
 
 // Calculate the Median Inclination for a given Step. Median is built from the given Step -2 Steps and +2 Steps (5 Steps
 // in total)
-double trainprogram::medianInclination(int step) {
-    QList<double> inclinations;
-    inclinations.reserve(5);
-    if (rows.length() == 0)
-        return 0;
-    if ((step > 1) && (rows.length() > step - 2))
-        inclinations.append(rows.at(step - 2).inclination);
-    else
-        inclinations.append(0);
-    if ((step > 0) && (rows.length() > step - 1))
-        inclinations.append(rows.at(step - 1).inclination);
-    else
-        inclinations.append(0);
-    if (rows.length() > step)
-        inclinations.append(rows.at(step).inclination);
-    else
-        inclinations.append(0);
-    if (rows.length() > step + 1)
-        inclinations.append(rows.at(step + 1).inclination);
-    else
-        inclinations.append(0);
-    if (rows.length() > step + 2)
-        inclinations.append(rows.at(step + 2).inclination);
-    else
-        inclinations.append(0);
-    std::sort(inclinations.begin(), inclinations.end());
-    return (inclinations.at(2));
-}
+double trainprogram::medianInclination(int step) { return rowsLookahead().medianInclination(step); }
 
 // Calculates a weighted Inclination for a given Step. Inclination is calculated for the given Step + windowsize Steps
 // (7) The inclination for each Point needed goes through a Median Filter first to eliminate/minimize Errors in the
 // recorded elevation Data
-double trainprogram::weightedInclination(int step) {
-    int windowsize = 7;
-    int firststep = step;
-    double inc = 0;
-    double sumweights = 0;
-    double pointweight = 0;
-    if (rows.length() == 0)
-        return 0;
-    // Determine first and last possible Steps
-    if (firststep < 0)
-        firststep = 0;
-    int laststep = step + windowsize;
-    if (laststep >= rows.length()) {
-        firststep = rows.length() - 1 - (windowsize * 2);
-        if (firststep < 0)
-            firststep = 0;
-    }
-    // Loop through the determined Steps
-    for (int s = firststep; s <= laststep; s++) {
-        // Calculate the Weight used for the inclination
-        pointweight = ((((double)windowsize * 2.0) - 1.0) - ((s - firststep) * 2.0));
-        // Calculate the sum of weights
-        sumweights = (sumweights + pointweight);
-        // Calculate the sum of weighted median inclinations
-        inc = (inc + (medianInclination(s)) * pointweight);
-    }
-    // avoid a Division by 0
-    if (sumweights == 0)
-        return 0;
-    // Return the sum of weighted median inclinations / sum of all weights
-    return (inc / sumweights);
-}
+double trainprogram::weightedInclination(int step) { return rowsLookahead().weightedInclination(step); }
 
+// step is the current row
 double trainprogram::avgInclinationNext100Meters(int step) {
-    int c = step;
-    double km = 0;
-    double avg = 0;
-    int sum = 0;
-
-    while (1) {
-        if (c < rows.length()) {
-            if (km > 0.1) {
-                if (sum == 1) {
-                    return rows.at(currentStep).inclination;
-                }
-                return avg / (double)km;
-            }
-            if (c == currentStep)
-                km += (rows.at(c).distance - currentStepDistance);
-            else
-                km += (rows.at(c).distance);
-            avg += rows.at(c).inclination * rows.at(c).distance;
-            sum++;
-
-        } else {
-            if (sum == 1) {
-                return rows.at(currentStep).inclination;
-            }
-            return avg / (double)km;
-        }
-        c++;
-    }
-    if (sum == 1) {
-        return rows.at(currentStep).inclination;
-    }
-    return avg / (double)km;
+    return rowsLookahead().avgInclinationNext100Meters(step, currentStepDistance);
 }
 
-double trainprogram::avgAzimuthNext300Meters() {
-    int c = currentStep;
-    double km = 0;
-    double sinTotal = 0;
-    double cosTotal = 0;
-
-    if (!isnan(rows.at(c).latitude) && !isnan(rows.at(c).longitude)) {
-        while (1) {
-            if (c < rows.length()) {
-                if (km > 0.3) {
-                    double averageDirection = atan(sinTotal / cosTotal) * (180 / M_PI);
-
-                    if (cosTotal < 0) {
-                        averageDirection += 180;
-                    } else if (sinTotal < 0) {
-                        averageDirection += 360;
-                    }
-                    return averageDirection;
-                }
-
-                for (double i = 0; i < rows.at(c).distance; i += 0.001) {
-                    sinTotal += sin(rows.at(c).azimuth * (M_PI / 180));
-                    cosTotal += cos(rows.at(c).azimuth * (M_PI / 180));
-                }
-
-                km += rows.at(c).distance;
-
-            } else {
-                double averageDirection = atan(sinTotal / cosTotal) * (180 / M_PI);
-
-                if (cosTotal < 0) {
-                    averageDirection += 180;
-                } else if (sinTotal < 0) {
-                    averageDirection += 360;
-                }
-                return averageDirection;
-            }
-            c++;
-        }
-    }
-    return 0;
-}
+double trainprogram::avgAzimuthNext300Meters() { return rowsLookahead().avgAzimuthNext300Meters(currentStep); }
 
 void trainprogram::clearRows() {
     QMutexLocker(&this->schedulerMutex);
     rows.clear();
+    timeline.clear();
+    lookahead.clear();
 }
 
 void trainprogram::pelotonOCRprocessPendingDatagrams() {
@@ -602,100 +439,69 @@ void trainprogram::scheduler() {
         if(bluetoothManager->device() && (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL || bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL) &&
            settings.value(QZSettings::zwift_username, QZSettings::default_zwift_username).toString().length() > 0 && zwift_auth_token &&
            zwift_auth_token->access_token.length() > 0) {
-            if(!zwift_world) {
-                zwift_world = new World(1, zwift_auth_token->getAccessToken());
-                qDebug() << "creating zwift api world";
-            }
-            else {
-#ifdef Q_OS_IOS
-#ifndef IO_UNDER_QT
-                if(!h)
-                    h = new lockscreen();
-#endif
-#endif
-                if(zwift_player_id == -1) {
-                    QString id = zwift_world->player_id();
-                    QJsonParseError parseError;
-                    QJsonDocument document = QJsonDocument::fromJson(id.toLocal8Bit(), &parseError);
-                    QJsonObject ride = document.object();
-                    qDebug() << "zwift api player" << ride;
-                    zwift_player_id = ride[QStringLiteral("id")].toInt();
-                    emit zwiftLoginState(true);
-                } else {                    
-                    static int zwift_counter = 5;
-                    int timeout = settings.value(QZSettings::zwift_api_poll, QZSettings::default_zwift_api_poll).toInt();
-                    if(timeout < 5)
-                        timeout = 5;
-                    if(zwift_counter++ >= (timeout - 1)) {
-                        zwift_counter = 0;
-                        QByteArray bb = zwift_world->playerStatus(zwift_player_id);
-#ifdef Q_OS_IOS
-#ifndef IO_UNDER_QT
-                        h->zwift_api_decodemessage_player(bb.data(), bb.length());
-                        float alt = h->zwift_api_getaltitude();
-                        float distance = h->zwift_api_getdistance();
-#else
-                        float alt = 0;
-                        float distance = 0;
-#endif
-#elif defined(Q_OS_ANDROID)
-                        QAndroidJniEnvironment env;
-                        jbyteArray d = env->NewByteArray(bb.length());
-                        jbyte *b = env->GetByteArrayElements(d, 0);
-                        for (int i = 0; i < bb.length(); i++)
-                            b[i] = bb[i];
-                        env->SetByteArrayRegion(d, 0, bb.length(), b);
-
-                        QAndroidJniObject::callStaticMethod<void>(
-                            "org/cagnulen/qdomyoszwift/ZwiftAPI", "zwift_api_decodemessage_player", "([B)V", d);
-                        env->DeleteLocalRef(d);
-
-                        float alt = QAndroidJniObject::callStaticMethod<float>("org/cagnulen/qdomyoszwift/ZwiftAPI", "getAltitude", "()F");
-                        float distance = QAndroidJniObject::callStaticMethod<float>("org/cagnulen/qdomyoszwift/ZwiftAPI", "getDistance", "()F");
-#else
-                        float alt = 0;
-                        float distance = 0;
-#endif
-                        static float old_distance = 0;
-                        static float old_alt = 0;
-                        
-                        qDebug() << "zwift api incline1" << old_distance << old_alt << distance << alt;
-
-                        if(old_distance > 0) {
-                            float delta = distance - old_distance;
-                            float deltaA = alt - old_alt;
-                            float incline = (deltaA / delta);
-                            if(delta > 1) {
-                                bool zwift_negative_inclination_x2 =
-                                    settings.value(QZSettings::zwift_negative_inclination_x2, QZSettings::default_zwift_negative_inclination_x2)
-                                        .toBool();
-                                double offset =
-                                    settings.value(QZSettings::zwift_inclination_offset, QZSettings::default_zwift_inclination_offset).toDouble();
-                                double gain =
-                                    settings.value(QZSettings::zwift_inclination_gain, QZSettings::default_zwift_inclination_gain).toDouble();
-                                double grade = (incline * gain) + offset;  
-                                if (zwift_negative_inclination_x2 && incline < 0) {
-                                    grade = ((incline * 2.0) * gain) + offset;
-                                }                              
-                                bool zwift_api_autoinclination = settings.value(QZSettings::zwift_api_autoinclination, QZSettings::default_zwift_api_autoinclination).toBool();
-                                qDebug() << "zwift api incline" << incline << grade << delta << deltaA << zwift_api_autoinclination;
-                                if(zwift_api_autoinclination) {
-                                    if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL || 
-                                        (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL && ((elliptical*)bluetoothManager->device())->inclinationAvailableByHardware())) {
-                                        bluetoothManager->device()->changeInclination(grade, grade);
-                                    } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL && !((elliptical*)bluetoothManager->device())->inclinationAvailableByHardware()) {
-                                        QSettings settings;
-                                        double bikeResistanceOffset = settings.value(QZSettings::bike_resistance_offset, bikeResistanceOffset).toInt();
-                                        double bikeResistanceGain = settings.value(QZSettings::bike_resistance_gain_f, bikeResistanceGain).toDouble();
-
-                                        bluetoothManager->device()->changeResistance((resistance_t)(round(grade * bikeResistanceGain)) + bikeResistanceOffset + 1); // resistance start from 1
-                                    }
+            if(!zwift_relay) {
+                zwift_relay = new ZwiftRelay(1, this);
+                zwift_relay->setAccessToken(zwift_auth_token->getAccessToken());
+                connect(zwift_relay, &ZwiftRelay::loginState, this, &trainprogram::zwiftLoginState);
+                qDebug() << "creating zwift api relay";
+            }
+            if(!zwift_relay->hasPlayer()) {
+                zwift_relay->requestPlayer();
+            } else {
+                static int zwift_counter = 5;
+                int timeout = settings.value(QZSettings::zwift_api_poll, QZSettings::default_zwift_api_poll).toInt();
+                if(timeout < 5)
+                    timeout = 5;
+                if(zwift_counter++ >= (timeout - 1)) {
+                    zwift_counter = 0;
+                    // the answer is read from the mailbox by a next tick, the scheduler never waits for the relay
+                    if(!zwift_relay->poll())
+                        qDebug() << "zwift api relay busy" << zwift_relay->inFlight() << zwift_relay->latencyMs();
+                }
+
+                ZwiftPlayerState state;
+                if(zwift_relay->latest(&state, &zwift_state_version)) {
+                    float alt = state.altitude;
+                    float distance = state.distance;
+                    static float old_distance = 0;
+                    static float old_alt = 0;
+
+                    qDebug() << "zwift api incline1" << old_distance << old_alt << distance << alt << zwift_relay->latencyMs();
+
+                    if(old_distance > 0) {
+                        float delta = distance - old_distance;
+                        float deltaA = alt - old_alt;
+                        float incline = (deltaA / delta);
+                        if(delta > 1) {
+                            bool zwift_negative_inclination_x2 =
+                                settings.value(QZSettings::zwift_negative_inclination_x2, QZSettings::default_zwift_negative_inclination_x2)
+                                    .toBool();
+                            double offset =
+                                settings.value(QZSettings::zwift_inclination_offset, QZSettings::default_zwift_inclination_offset).toDouble();
+                            double gain =
+                                settings.value(QZSettings::zwift_inclination_gain, QZSettings::default_zwift_inclination_gain).toDouble();
+                            double grade = (incline * gain) + offset;  
+                            if (zwift_negative_inclination_x2 && incline < 0) {
+                                grade = ((incline * 2.0) * gain) + offset;
+                            }                              
+                            bool zwift_api_autoinclination = settings.value(QZSettings::zwift_api_autoinclination, QZSettings::default_zwift_api_autoinclination).toBool();
+                            qDebug() << "zwift api incline" << incline << grade << delta << deltaA << zwift_api_autoinclination;
+                            if(zwift_api_autoinclination) {
+                                if(bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL || 
+                                    (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL && ((elliptical*)bluetoothManager->device())->inclinationAvailableByHardware())) {
+                                    bluetoothManager->device()->changeInclination(grade, grade);
+                                } else if (bluetoothManager->device()->deviceType() == bluetoothdevice::ELLIPTICAL && !((elliptical*)bluetoothManager->device())->inclinationAvailableByHardware()) {
+                                    QSettings settings;
+                                    double bikeResistanceOffset = settings.value(QZSettings::bike_resistance_offset, bikeResistanceOffset).toInt();
+                                    double bikeResistanceGain = settings.value(QZSettings::bike_resistance_gain_f, bikeResistanceGain).toDouble();
+
+                                    bluetoothManager->device()->changeResistance((resistance_t)(round(grade * bikeResistanceGain)) + bikeResistanceOffset + 1); // resistance start from 1
                                 }
                             }
                         }
-                        old_distance = distance;
-                        old_alt = alt;
                     }
+                    old_distance = distance;
+                    old_alt = alt;
                 }
             }
         }
@@ -817,6 +623,7 @@ void trainprogram::scheduler() {
     // entry point
     if (ticks == 1 && currentStep == 0) {
         rows[currentStep].started = QDateTime::currentDateTime();
+        timeline.setRowTime(currentStep, calculateTimeForRow(currentStep));
         currentStepDistance = 0;
         lastOdometer = odometerFromTheDevice;
         if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
@@ -916,20 +723,9 @@ void trainprogram::scheduler() {
     qDebug() << QStringLiteral("trainprogram elapsed ") + QString::number(ticks) + QStringLiteral("current row len") +
                     QString::number(currentRowLen);
 
-    uint32_t calculatedLine;
-    uint32_t calculatedElapsedTime = 0;
-    for (calculatedLine = 0; calculatedLine < static_cast<uint32_t>(rows.length()); calculatedLine++) {
-
-        calculatedElapsedTime += calculateTimeForRow(calculatedLine);
-        
-        if (calculateDistanceForRow(calculatedLine) > 0 && calculatedLine > currentStep) {
-            break;
-        }
-
-        if (calculatedElapsedTime > static_cast<uint32_t>(ticks)) {
-            break;
-        }
-    }
+    // the row running at ticks, or the next distance row if it comes first
+    uint32_t calculatedLine = qMin(rowsTimeline().rowAt(static_cast<uint32_t>(ticks)),
+                                   rowsTimeline().nextDistanceRow(currentStep));
 
     bool distanceEvaluation = false;
     int sameIteration = 0;
@@ -952,6 +748,7 @@ void trainprogram::scheduler() {
                     lastOdometer -= (currentStepDistance - rows.at(currentStep).distance);
 
                 rows[currentStep].ended = QDateTime::currentDateTime();
+                timeline.setRowTime(currentStep, calculateTimeForRow(currentStep));
 
                 if (!distanceStep)
                     currentStep = calculatedLine;
@@ -959,6 +756,7 @@ void trainprogram::scheduler() {
                     currentStep++;
 
                 rows[currentStep].started = QDateTime::currentDateTime();
+                timeline.setRowTime(currentStep, calculateTimeForRow(currentStep));
 
                 currentStepDistance = 0;
                 if (bluetoothManager->device()->deviceType() == bluetoothdevice::TREADMILL) {
@@ -1469,34 +1267,23 @@ double trainprogram::currentTargetMets() {
 }
 
 QTime trainprogram::currentRowElapsedTime() {
-    uint32_t calculatedLine;
-    uint32_t calculatedElapsedTime = 0;
-
     if (rows.length() == 0)
         return QTime(0, 0, 0);
 
-    for (calculatedLine = 0; calculatedLine < static_cast<uint32_t>(rows.length()); calculatedLine++) {
-
-        uint32_t currentLine = calculateTimeForRow(calculatedLine);
-        calculatedElapsedTime += currentLine;
+    const trainprogramtimeline &t = rowsTimeline();
+    const int row = t.rowAt(static_cast<uint32_t>(ticks));
+    if (row < rows.length()) {
         uint32_t rampElapsed = 0;
-
-        if (calculatedElapsedTime > static_cast<uint32_t>(ticks)) {
-            if (rows.at(calculatedLine).rampElapsed != QTime(0, 0, 0)) {
-                rampElapsed = (rows.at(calculatedLine).rampElapsed.second() +
-                               (rows.at(calculatedLine).rampElapsed.minute() * 60) +
-                               (rows.at(calculatedLine).rampElapsed.hour() * 3600));
-            }
-            return QTime(0, 0, 0).addSecs(rampElapsed + ticks - (calculatedElapsedTime - currentLine));
+        if (rows.at(row).rampElapsed != QTime(0, 0, 0)) {
+            rampElapsed = (rows.at(row).rampElapsed.second() + (rows.at(row).rampElapsed.minute() * 60) +
+                           (rows.at(row).rampElapsed.hour() * 3600));
         }
+        return QTime(0, 0, 0).addSecs(rampElapsed + ticks - static_cast<uint32_t>(t.timeBefore(row)));
     }
     return QTime(0, 0, 0);
 }
 
 QTime trainprogram::currentRowRemainingTime() {
-    uint32_t calculatedLine;
-    uint32_t calculatedElapsedTime = 0;
-
     if (rows.length() == 0)
         return QTime(0, 0, 0);
 
@@ -1509,61 +1296,31 @@ QTime trainprogram::currentRowRemainingTime() {
         int hours = seconds / 3600;
         return QTime(hours, (seconds / 60) - (hours * 60), seconds % 60);
     } else {
-        for (calculatedLine = 0; calculatedLine < static_cast<uint32_t>(rows.length()); calculatedLine++) {
-
-            uint32_t currentLine = calculateTimeForRow(calculatedLine);
-            calculatedElapsedTime += currentLine;
-
-            if (calculatedElapsedTime > static_cast<uint32_t>(ticks)) {
-                if (rows.at(calculatedLine).rampDuration != QTime(0, 0, 0)) {
-                    calculatedElapsedTime += ((rows.at(calculatedLine).rampDuration.second() +
-                                               (rows.at(calculatedLine).rampDuration.minute() * 60) +
-                                               (rows.at(calculatedLine).rampDuration.hour() * 3600))) -
-                                             1;
-                }
-                int seconds = calculatedElapsedTime - ticks;
-                int hours = seconds / 3600;
-                return QTime(hours, (seconds / 60) - (hours * 60), seconds % 60);
-            }
+        const trainprogramtimeline &t = rowsTimeline();
+        const int row = t.rowAt(static_cast<uint32_t>(ticks));
+        if (row < rows.length()) {
+            uint32_t calculatedElapsedTime = static_cast<uint32_t>(t.timeBefore(row + 1));
+            if (rows.at(row).rampDuration != QTime(0, 0, 0)) {
+                calculatedElapsedTime += ((rows.at(row).rampDuration.second() +
+                                           (rows.at(row).rampDuration.minute() * 60) +
+                                           (rows.at(row).rampDuration.hour() * 3600))) -
+                                         1;
+            }
+            int seconds = calculatedElapsedTime - ticks;
+            int hours = seconds / 3600;
+            return QTime(hours, (seconds / 60) - (hours * 60), seconds % 60);
         }
     }
     return QTime(0, 0, 0);
 }
 
 QTime trainprogram::remainingTime() {
-    uint32_t calculatedLine;
-    uint32_t calculatedTotalTime = 0;
-
     if (rows.length() == 0)
         return QTime(0, 0, 0);
 
-    for (calculatedLine = 0; calculatedLine < static_cast<uint32_t>(rows.length()); calculatedLine++) {
-        calculatedTotalTime += calculateTimeForRow(calculatedLine);
-    }
-    return QTime(0, 0, 0).addSecs(calculatedTotalTime - ticks);
-}
-
-QTime trainprogram::duration() {
-
-    QTime total(0, 0, 0, 0);
-    for (const trainrow &row : qAsConst(rows)) {
-        total = total.addSecs((row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second());
-    }
-    return total;
+    return QTime(0, 0, 0).addSecs(static_cast<uint32_t>(rowsTimeline().totalTime()) - ticks);
 }
 
-double trainprogram::totalDistance() {
-
-    double distance = 0;
-    for (const trainrow &row : qAsConst(rows)) {
-        if (row.duration.hour() || row.duration.minute() || row.duration.second()) {
-            if (!row.forcespeed) {
+QTime trainprogram::duration() { return QTime(0, 0, 0, 0).addSecs((int)rowsTimeline().durationSeconds()); }
 
-                return -1;
-            }
-            distance += ((row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second()) *
-                        (row.speed / 3600);
-        }
-    }
-    return distance;
-}
+double trainprogram::totalDistance() { return rowsTimeline().totalDistance(); }
@@ -1,6 +1,8 @@
 #ifndef TRAINPROGRAM_H
 #define TRAINPROGRAM_H
 #include "bluetooth.h"
+#include "trainprogramlookahead.h"
+#include "trainprogramtimeline.h"
 #include <QGeoCoordinate>
 #include <QMutex>
 #include <QObject>
@@ -8,10 +10,6 @@
 #include <QTime>
 #include <QTimer>
 
-#ifdef Q_OS_IOS
-#include "ios/lockscreen.h"
-#endif
-
 #include "zwift-api/PlayerStateWrapper.h"
 #include "zwift-api/zwift_client_auth.h"
 
@@ -113,6 +111,11 @@ class trainprogram : public QObject {
     void scheduler(int tick);
 
     void applySpeedFilter();
+    /**
+     * @brief To be called after editing rows from outside, e.g. changing their speed: rebuilds the timeline and the
+     * look-ahead of the rows.
+     */
+    void rebuildTimeline();
 
   public slots:
     void onTapeStarted();
@@ -128,7 +131,7 @@ private slots:
     void changeSpeed(double speed);
     bool changeFanSpeed(uint8_t speed);
     void changeInclination(double grade, double inclination);
-    void changeNextInclination300Meters(QList<MetersByInclination>);
+    void changeNextInclination300Meters(QVector<MetersByInclination>);
     void changeResistance(resistance_t resistance);
     void changeRequestedPelotonResistance(int8_t resistance);
     void changeCadence(int16_t cadence);
@@ -142,12 +145,16 @@ private slots:
   private:
     mutable QRecursiveMutex schedulerMutex;
     double avgAzimuthNext300Meters();
-    QList<MetersByInclination> inclinationNext300Meters();
-    QList<MetersByInclination> avgInclinationNext300Meters();
+    QVector<MetersByInclination> inclinationNext300Meters();
+    QVector<MetersByInclination> avgInclinationNext300Meters();
     double avgInclinationNext100Meters(int step);
     uint32_t calculateTimeForRow(int32_t row);
     uint32_t calculateTimeForRowMergingRamps(int32_t row);
     double calculateDistanceForRow(int32_t row);
+    const trainprogramtimeline &rowsTimeline();
+    trainprogramtimeline timeline;
+    trainprogramlookahead &rowsLookahead();
+    trainprogramlookahead lookahead;
     bluetooth *bluetoothManager;
     bool started = false;
     int32_t ticks = 0;
@@ -167,12 +174,8 @@ private slots:
     void pelotonOCRcomputeTime(QString t);
     
     AuthToken* zwift_auth_token = nullptr;
-    World* zwift_world = nullptr;
-    int zwift_player_id = -1;
-    
-#ifdef Q_OS_IOS
-    lockscreen *h = 0;
-#endif
+    ZwiftRelay* zwift_relay = nullptr;
+    quint32 zwift_state_version = 0;
 
 };
 
@@ -0,0 +1,229 @@
+#include "trainprogramlookahead.h"
+#include "trainprogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+// the median of the row and of the 2 rows before and after, 0 for the ones out of the program
+static double medianAt(const QVector<double> &inclinations, int step) {
+    const int n = inclinations.count();
+    double window[5];
+    for (int k = 0; k < 5; k++) {
+        const int s = step - 2 + k;
+        window[k] = (s >= 0 && s < n) ? inclinations.at(s) : 0;
+    }
+    std::nth_element(window, window + 2, window + 5);
+    return window[2];
+}
+
+// the direction of the sum of the unit vectors
+static double averageDirection(double sinTotal, double cosTotal) {
+    double averageDirection = atan(sinTotal / cosTotal) * (180 / M_PI);
+
+    if (cosTotal < 0) {
+        averageDirection += 180;
+    } else if (sinTotal < 0) {
+        averageDirection += 360;
+    }
+    return averageDirection;
+}
+
+void trainprogramlookahead::clear() {
+    inclinations.clear();
+    distances.clear();
+    prefixDistance.clear();
+    prefixInclination.clear();
+    monotonic = true;
+    medians.clear();
+    weighted.clear();
+    avg100.clear();
+    end100.clear();
+    azimuth300.clear();
+    cursor100 = 0;
+    cursor300 = 0;
+}
+
+void trainprogramlookahead::build(const QList<trainrow> &rows) {
+    clear();
+    const int n = rows.count();
+    inclinations.resize(n);
+    distances.resize(n);
+    prefixDistance.resize(n + 1);
+    prefixInclination.resize(n + 1);
+    prefixDistance[0] = 0;
+    prefixInclination[0] = 0;
+    // the direction of a row counts once per meter
+    QVector<double> prefixSin(n + 1), prefixCos(n + 1);
+    QVector<int> prefixUnknownAzimuth(n + 1);
+    prefixSin[0] = 0;
+    prefixCos[0] = 0;
+    prefixUnknownAzimuth[0] = 0;
+    for (int i = 0; i < n; i++) {
+        const trainrow &row = rows.at(i);
+        inclinations[i] = row.inclination;
+        distances[i] = row.distance;
+        if (row.distance < 0)
+            monotonic = false;
+        prefixDistance[i + 1] = prefixDistance.at(i) + row.distance;
+        prefixInclination[i + 1] = prefixInclination.at(i) + row.inclination * row.distance;
+
+        int meters = 0;
+        for (double m = 0; m < row.distance; m += 0.001)
+            meters++;
+        // a row without a direction makes the direction of the windows including it unknown
+        const bool counted = meters && !std::isnan(row.azimuth);
+        prefixSin[i + 1] = prefixSin.at(i) + (counted ? meters * sin(row.azimuth * (M_PI / 180)) : 0);
+        prefixCos[i + 1] = prefixCos.at(i) + (counted ? meters * cos(row.azimuth * (M_PI / 180)) : 0);
+        prefixUnknownAzimuth[i + 1] = prefixUnknownAzimuth.at(i) + (meters && !counted ? 1 : 0);
+    }
+
+    medians.resize(n);
+    for (int i = 0; i < n; i++)
+        medians[i] = medianAt(inclinations, i);
+    weighted.resize(n);
+    for (int i = 0; i < n; i++)
+        weighted[i] = weightedAt(i);
+
+    avg100.resize(n);
+    end100.resize(n);
+    azimuth300.resize(n);
+    int cursor = 0, cursorAzimuth = 0;
+    for (int i = 0; i < n; i++) {
+        const int end = windowEnd(cursor, i, 0, 0.1);
+        end100[i] = end;
+        avg100[i] = averageInclination(i, end, distances.at(i) + (prefixDistance.at(end) - prefixDistance.at(i + 1)));
+
+        if (std::isnan(rows.at(i).latitude) || std::isnan(rows.at(i).longitude)) {
+            azimuth300[i] = 0;
+            continue;
+        }
+        const int endAzimuth = windowEnd(cursorAzimuth, i, 0, 0.3);
+        if (prefixUnknownAzimuth.at(endAzimuth) != prefixUnknownAzimuth.at(i))
+            azimuth300[i] = NAN;
+        else
+            azimuth300[i] = averageDirection(prefixSin.at(endAzimuth) - prefixSin.at(i),
+                                             prefixCos.at(endAzimuth) - prefixCos.at(i));
+    }
+}
+
+int trainprogramlookahead::windowEnd(int &cursor, int step, double stepDistance, double limit) const {
+    const int n = inclinations.count();
+    // the rows are added while less than limit km are covered
+    const double first = distances.at(step) - stepDistance;
+    auto ends = [&](int c) { return first + (prefixDistance.at(c) - prefixDistance.at(step + 1)) > limit; };
+    if (!monotonic) {
+        int c = step + 1;
+        while (c < n && !ends(c))
+            c++;
+        return c;
+    }
+    int c = qBound(step + 1, cursor, qMax(n, step + 1));
+    while (c - 1 > step && ends(c - 1))
+        c--;
+    while (c < n && !ends(c))
+        c++;
+    cursor = c;
+    return c;
+}
+
+double trainprogramlookahead::averageInclination(int step, int end, double km) const {
+    return (prefixInclination.at(end) - prefixInclination.at(step)) / km;
+}
+
+double trainprogramlookahead::medianInclination(int step) const {
+    if (inclinations.isEmpty())
+        return 0;
+    if (step >= 0 && step < medians.count())
+        return medians.at(step);
+    return medianAt(inclinations, step);
+}
+
+double trainprogramlookahead::weightedInclination(int step) const {
+    if (step >= 0 && step < weighted.count())
+        return weighted.at(step);
+    return weightedAt(step);
+}
+
+double trainprogramlookahead::weightedAt(int step) const {
+    int windowsize = 7;
+    int firststep = step;
+    double inc = 0;
+    double sumweights = 0;
+    double pointweight = 0;
+    if (inclinations.isEmpty())
+        return 0;
+    if (firststep < 0)
+        firststep = 0;
+    int laststep = step + windowsize;
+    if (laststep >= inclinations.count()) {
+        firststep = inclinations.count() - 1 - (windowsize * 2);
+        if (firststep < 0)
+            firststep = 0;
+    }
+    for (int s = firststep; s <= laststep; s++) {
+        pointweight = ((((double)windowsize * 2.0) - 1.0) - ((s - firststep) * 2.0));
+        sumweights = (sumweights + pointweight);
+        inc = (inc + (medianInclination(s)) * pointweight);
+    }
+    if (sumweights == 0)
+        return 0;
+    return (inc / sumweights);
+}
+
+double trainprogramlookahead::avgInclinationNext100Meters(int step, double stepDistance) {
+    if (step < 0 || step >= inclinations.count())
+        return NAN;
+    const int end = windowEnd(cursor100, step, stepDistance, 0.1);
+    if (end == step + 1)
+        return inclinations.at(step);
+    return averageInclination(step, end,
+                              distances.at(step) - stepDistance + (prefixDistance.at(end) - prefixDistance.at(step + 1)));
+}
+
+QVector<MetersByInclination> &trainprogramlookahead::previewBuffer() {
+    // the device holds the other one
+    QVector<MetersByInclination> &buffer = preview[nextPreview];
+    nextPreview ^= 1;
+    buffer.clear();
+    return buffer;
+}
+
+QVector<MetersByInclination> trainprogramlookahead::inclinationNext300Meters(int step, double stepDistance) {
+    QVector<MetersByInclination> &next300 = previewBuffer();
+    if (step < 0 || step >= inclinations.count())
+        return next300;
+    const int end = windowEnd(cursor300, step, stepDistance, 0.3);
+    for (int c = step; c < end; c++) {
+        MetersByInclination p;
+        p.meters = (c == step ? distances.at(c) - stepDistance : distances.at(c)) * 1000.0;
+        p.inclination = inclinations.at(c);
+        next300.append(p);
+    }
+    return next300;
+}
+
+QVector<MetersByInclination> trainprogramlookahead::avgInclinationNext300Meters(int step, double stepDistance) {
+    QVector<MetersByInclination> &next300 = previewBuffer();
+    if (step < 0 || step >= inclinations.count())
+        return next300;
+    const int end = windowEnd(cursor300, step, stepDistance, 0.3);
+    for (int c = step; c < end; c++) {
+        MetersByInclination p;
+        if (c == step) {
+            p.meters = (distances.at(c) - stepDistance) * 1000.0;
+            p.inclination = avgInclinationNext100Meters(step, stepDistance);
+        } else {
+            p.meters = distances.at(c) * 1000.0;
+            // a row longer than 100 m: the inclination of the current row, as the walk from the row did
+            p.inclination = end100.at(c) == c + 1 ? inclinations.at(step) : avg100.at(c);
+        }
+        next300.append(p);
+    }
+    return next300;
+}
+
+double trainprogramlookahead::avgAzimuthNext300Meters(int step) const {
+    if (step < 0 || step >= azimuth300.count())
+        return 0;
+    return azimuth300.at(step);
+}
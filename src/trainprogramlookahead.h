@@ -0,0 +1,83 @@
+#ifndef TRAINPROGRAMLOOKAHEAD_H
+#define TRAINPROGRAMLOOKAHEAD_H
+
+#include "devices/bluetoothdevice.h"
+#include <QList>
+#include <QVector>
+
+class trainrow;
+
+/**
+ * @brief The look-ahead of a GPX program: the inclination of the next 100 m, the preview of the next 300 m and the
+ * direction of the next 300 m, with the same results the train program got walking the rows forward every tick.
+ * What depends only on the rows (the median and weighted inclinations, the average inclination of the 100 m after
+ * each row, the direction of the 300 m after each row) is computed once when the rows are loaded or edited. What
+ * depends on the distance covered in the current row is a window over the cumulative distance whose end follows
+ * the distance of the workout, so each tick moves it by the few rows the device covered.
+ * The preview is filled in one of two buffers in turn: the device keeps the last one, the other one is no longer
+ * shared and is filled again in place.
+ */
+class trainprogramlookahead {
+  public:
+    void build(const QList<trainrow> &rows);
+    void clear();
+    int count() const { return inclinations.count(); }
+
+    /**
+     * @brief The median of the inclinations of the 5 rows around step, 0 for the rows out of the program.
+     */
+    double medianInclination(int step) const;
+    /**
+     * @brief The average of the median inclinations of the rows after step, the nearest the heaviest.
+     */
+    double weightedInclination(int step) const;
+
+    /**
+     * @brief The inclination of the next 100 m, from the current row when stepDistance km of it are covered.
+     */
+    double avgInclinationNext100Meters(int step, double stepDistance);
+    /**
+     * @brief The rows of the next 300 m from the current row: meters and inclination.
+     */
+    QVector<MetersByInclination> inclinationNext300Meters(int step, double stepDistance);
+    /**
+     * @brief The rows of the next 300 m from the current row: meters and the inclination of the 100 m after each one.
+     */
+    QVector<MetersByInclination> avgInclinationNext300Meters(int step, double stepDistance);
+    /**
+     * @brief The average direction of the 300 m after the row, 0 if the row has no position.
+     */
+    double avgAzimuthNext300Meters(int step) const;
+
+  private:
+    /**
+     * @brief The first row after step starting more than limit km after the first stepDistance km of step, count()
+     * if none. cursor is the end found the last time, the search starts from there.
+     */
+    int windowEnd(int &cursor, int step, double stepDistance, double limit) const;
+    double averageInclination(int step, int end, double km) const;
+    double weightedAt(int step) const;
+    QVector<MetersByInclination> &previewBuffer();
+
+    QVector<double> inclinations;
+    QVector<double> distances;
+    // cumulative distance and inclination by distance of the rows before each row
+    QVector<double> prefixDistance;
+    QVector<double> prefixInclination;
+    // the distances only grow: the windows can move forward and back instead of walking from the current row
+    bool monotonic = true;
+
+    QVector<double> medians;
+    QVector<double> weighted;
+    // the average inclination of the 100 m after each row, for the rows ahead of the current one
+    QVector<double> avg100;
+    QVector<int> end100;
+    QVector<double> azimuth300;
+
+    int cursor100 = 0;
+    int cursor300 = 0;
+    QVector<MetersByInclination> preview[2];
+    int nextPreview = 0;
+};
+
+#endif // TRAINPROGRAMLOOKAHEAD_H
@@ -0,0 +1,115 @@
+#include "trainprogramtimeline.h"
+#include "trainprogram.h"
+
+#include <algorithm>
+#include <cmath>
+
+quint32 trainprogramtimeline::timeForRow(const trainrow &row) {
+    if (row.distance == -1)
+        return (row.duration.second() + (row.duration.minute() * 60) + (row.duration.hour() * 3600));
+    else if (row.started.isValid() && row.ended.isValid())
+        return row.started.secsTo(row.ended);
+    return 0;
+}
+
+void trainprogramtimeline::clear() {
+    times.clear();
+    tree.clear();
+    treeMask = 0;
+    distances.clear();
+    nextDistance.clear();
+    duration = 0;
+    distance = 0;
+}
+
+void trainprogramtimeline::build(const QList<trainrow> &rows) {
+    clear();
+    const int n = rows.count();
+    times.resize(n);
+    tree.fill(0, n + 1);
+    distances.resize(n + 1);
+    nextDistance.resize(n);
+    distances[0] = 0;
+    bool unforced = false;
+    for (int i = 0; i < n; i++) {
+        const trainrow &row = rows.at(i);
+        times[i] = timeForRow(row);
+        // linear construction of the tree: each node adds itself to its parent
+        tree[i + 1] += times.at(i);
+        const int parent = (i + 1) + ((i + 1) & -(i + 1));
+        if (parent <= n)
+            tree[parent] += tree.at(i + 1);
+
+        distances[i + 1] = distances.at(i) + (row.distance == -1 ? 0 : llround(row.distance * 1000000.0));
+
+        const int seconds = (row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second();
+        duration += seconds;
+        if (seconds) {
+            if (!row.forcespeed)
+                unforced = true;
+            else if (!unforced)
+                distance += seconds * (row.speed / 3600);
+        }
+    }
+    if (unforced)
+        distance = -1;
+    int next = n;
+    for (int i = n - 1; i >= 0; i--) {
+        nextDistance[i] = next;
+        if (rows.at(i).distance > 0)
+            next = i;
+    }
+    treeMask = 1;
+    while (treeMask * 2 <= n)
+        treeMask *= 2;
+    if (!n)
+        treeMask = 0;
+}
+
+void trainprogramtimeline::setRowTime(int row, quint32 seconds) {
+    if (row < 0 || row >= times.count() || times.at(row) == seconds)
+        return;
+    const qint64 delta = (qint64)seconds - times.at(row);
+    times[row] = seconds;
+    for (int i = row + 1; i < tree.count(); i += i & -i)
+        tree[i] += delta;
+}
+
+qint64 trainprogramtimeline::timeBefore(int row) const {
+    qint64 sum = 0;
+    for (int i = qMin(row, times.count()); i > 0; i -= i & -i)
+        sum += tree.at(i);
+    return sum;
+}
+
+int trainprogramtimeline::rowAt(qint64 seconds) const {
+    // the longest prefix not ending after seconds: the row following it is the one running
+    int pos = 0;
+    qint64 sum = 0;
+    for (int step = treeMask; step > 0; step /= 2) {
+        const int next = pos + step;
+        if (next < tree.count() && sum + tree.at(next) <= seconds) {
+            pos = next;
+            sum += tree.at(next);
+        }
+    }
+    return pos;
+}
+
+int trainprogramtimeline::nextDistanceRow(int row) const {
+    return row >= 0 && row < nextDistance.count() ? nextDistance.at(row) : times.count();
+}
+
+qint64 trainprogramtimeline::distanceBefore(int row) const {
+    if (distances.isEmpty())
+        return 0;
+    return distances.at(qBound(0, row, distances.count() - 1));
+}
+
+int trainprogramtimeline::rowAtDistance(qint64 millimeters) const {
+    if (distances.isEmpty())
+        return 0;
+    // the first row ending after the distance
+    QVector<qint64>::const_iterator it = std::upper_bound(distances.constBegin() + 1, distances.constEnd(), millimeters);
+    return (int)(it - (distances.constBegin() + 1));
+}
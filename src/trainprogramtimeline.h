@@ -0,0 +1,76 @@
+#ifndef TRAINPROGRAMTIMELINE_H
+#define TRAINPROGRAMTIMELINE_H
+
+#include <QList>
+#include <QVector>
+
+class trainrow;
+
+/**
+ * @brief Index of the rows of a train program by time and distance, built once when the rows are loaded or edited,
+ * so the elapsed and remaining time of the program are binary searches instead of scans of all the rows (a GPX
+ * program has one row per track point).
+ * The time of a distance row is only known once the row is over (started and ended are stamped during the workout),
+ * so the cumulative time is kept in a Fenwick tree: a row is updated and the row at a given time found in O(log n).
+ * The cumulative distance, the duration and the total distance only change with the rows and are plain arrays.
+ */
+class trainprogramtimeline {
+  public:
+    void build(const QList<trainrow> &rows);
+    void clear();
+    int count() const { return times.count(); }
+
+    /**
+     * @brief The seconds of a row: its duration, or the time between started and ended for a distance row.
+     */
+    static quint32 timeForRow(const trainrow &row);
+    quint32 rowTime(int row) const { return row >= 0 && row < times.count() ? times.at(row) : 0; }
+    /**
+     * @brief Updates the seconds of a row, e.g. when it's stamped as ended.
+     */
+    void setRowTime(int row, quint32 seconds);
+
+    /**
+     * @brief Seconds of the rows before row.
+     */
+    qint64 timeBefore(int row) const;
+    qint64 totalTime() const { return timeBefore(times.count()); }
+    /**
+     * @brief The row being run at the time specified: the first row ending after it, count() if the program is over.
+     */
+    int rowAt(qint64 seconds) const;
+
+    /**
+     * @brief The first row after row with a distance, count() if none.
+     */
+    int nextDistanceRow(int row) const;
+    /**
+     * @brief Millimeters of the rows before row.
+     */
+    qint64 distanceBefore(int row) const;
+    /**
+     * @brief The row at the distance specified from the start, count() if past the end.
+     */
+    int rowAtDistance(qint64 millimeters) const;
+
+    /**
+     * @brief Sum of the durations of the rows, in seconds.
+     */
+    qint64 durationSeconds() const { return duration; }
+    /**
+     * @brief Km of the rows with a duration and a forced speed, -1 if a row with a duration has no forced speed.
+     */
+    double totalDistance() const { return distance; }
+
+  private:
+    QVector<quint32> times;
+    // Fenwick tree of times, 1-based
+    QVector<qint64> tree;
+    int treeMask = 0;
+    QVector<qint64> distances;
+    QVector<int> nextDistance;
+    qint64 duration = 0;
+    double distance = 0;
+};
+
+#endif // TRAINPROGRAMTIMELINE_H
@@ -1,13 +1,11 @@
 #include "virtualdevices/virtualbike.h"
 #include "devices/bike.h"
+#include "qzsettingssnapshot.h"
 
 #include <QDataStream>
 #include <QMetaEnum>
 #include <QSettings>
 #include <QtMath>
-#include <chrono>
-
-using namespace std::chrono_literals;
 
 virtualbike::virtualbike(bluetoothdevice *t, bool noWriteResistance, bool noHeartService, uint8_t bikeResistanceOffset,
                          double bikeResistanceGain) {
@@ -30,8 +28,9 @@ virtualbike::virtualbike(bluetoothdevice *t, bool noWriteResistance, bool noHear
     bool ifit = settings.value(QZSettings::virtual_device_ifit, QZSettings::default_virtual_device_ifit).toBool();
     bool garmin_bluetooth_compatibility = settings.value(QZSettings::garmin_bluetooth_compatibility, QZSettings::default_garmin_bluetooth_compatibility).toBool();
 
+    notifications = new CharacteristicNotificationScheduler(Bike, this);
     if (settings.value(QZSettings::dircon_yes, QZSettings::default_dircon_yes).toBool()) {
-        dirconManager = new DirconManager(Bike, bikeResistanceOffset, bikeResistanceGain, this);
+        dirconManager = new DirconManager(Bike, bikeResistanceOffset, bikeResistanceGain, notifications, this);
         connect(dirconManager, SIGNAL(changeInclination(double, double)), this,
                 SIGNAL(changeInclination(double, double)));
         connect(dirconManager, SIGNAL(ftmsCharacteristicChanged(QLowEnergyCharacteristic, QByteArray)), this,
@@ -41,11 +40,11 @@ virtualbike::virtualbike(bluetoothdevice *t, bool noWriteResistance, bool noHear
     }
     if (!settings.value(QZSettings::virtual_device_bluetooth, QZSettings::default_virtual_device_bluetooth).toBool())
         return;
-    notif2AD2 = new CharacteristicNotifier2AD2(Bike, this);
+    notifications->add(new CharacteristicNotifier2AD2(Bike));
+    notifications->add(new CharacteristicNotifier2A63(Bike));
+    notifications->add(new CharacteristicNotifier2A37(Bike));
+    notifications->add(new CharacteristicNotifier2A5B(Bike));
     notif2AD9 = new CharacteristicNotifier2AD9(Bike, this);
-    notif2A63 = new CharacteristicNotifier2A63(Bike, this);
-    notif2A37 = new CharacteristicNotifier2A37(Bike, this);
-    notif2A5B = new CharacteristicNotifier2A5B(Bike, this);
     writeP2AD9 = new CharacteristicWriteProcessor2AD9(bikeResistanceGain, bikeResistanceOffset, Bike, notif2AD9, this);
     connect(writeP2AD9, SIGNAL(changeInclination(double, double)), this, SIGNAL(changeInclination(double, double)));
     Q_UNUSED(noWriteResistance)
@@ -444,11 +443,9 @@ virtualbike::virtualbike(bluetoothdevice *t, bool noWriteResistance, bool noHear
     }
 
     //! [Provide Heartbeat]
-    QObject::connect(&bikeTimer, &QTimer::timeout, this, &virtualbike::bikeProvider);
-    if (settings.value(QZSettings::race_mode, QZSettings::default_race_mode).toBool())
-        bikeTimer.start(100ms);
-    else
-        bikeTimer.start(1s);
+    QObject::connect(notifications, &CharacteristicNotificationScheduler::notificationsReady, this,
+                     &virtualbike::bikeProvider);
+    notifications->start();
 
     //! [Provide Heartbeat]
     QObject::connect(leController, &QLowEnergyController::disconnected, this, &virtualbike::reconnect);
@@ -988,18 +985,18 @@ void virtualbike::reconnect() {
     leController->startAdvertising(pars, advertisingData, advertisingData);
 }
 
-void virtualbike::bikeProvider() {
+void virtualbike::bikeProvider(const CharacteristicNotificationBatch &batch) {
 
-    QSettings settings;
-    bool cadence = settings.value(QZSettings::bike_cadence_sensor, QZSettings::default_bike_cadence_sensor).toBool();
-    bool battery = settings.value(QZSettings::battery_service, QZSettings::default_battery_service).toBool();
-    bool power = settings.value(QZSettings::bike_power_sensor, QZSettings::default_bike_power_sensor).toBool();
-    bool heart_only =
-        settings.value(QZSettings::virtual_device_onlyheart, QZSettings::default_virtual_device_onlyheart).toBool();
-    bool echelon =
-        settings.value(QZSettings::virtual_device_echelon, QZSettings::default_virtual_device_echelon).toBool();
-    bool ifit = settings.value(QZSettings::virtual_device_ifit, QZSettings::default_virtual_device_ifit).toBool();
-    bool erg_mode = settings.value(QZSettings::zwift_erg, QZSettings::default_zwift_erg).toBool();
+    // the connection checks, the logs and what isn't a measurement keep the pace of the heartbeat
+    const bool heartbeat = batch.heartbeat();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool cadence = settings.bike_cadence_sensor;
+    bool battery = settings.battery_service;
+    bool power = settings.bike_power_sensor;
+    bool heart_only = settings.virtual_device_onlyheart;
+    bool echelon = settings.virtual_device_echelon;
+    bool ifit = settings.virtual_device_ifit;
+    bool erg_mode = settings.zwift_erg;
 
     double normalizeWattage = Bike->wattsMetric().value();
     if (normalizeWattage < 0)
@@ -1010,10 +1007,13 @@ void virtualbike::bikeProvider() {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     if (h) {
+        if (!heartbeat)
+            return;
         // really connected to a device
         if (h->virtualbike_updateFTMS(normalizeSpeed, (char)Bike->currentResistance().value(),
                                       (uint16_t)Bike->currentCadence().value() * 2, (uint16_t)normalizeWattage,
                                       Bike->currentCrankRevolutions(), Bike->lastCrankEventTime())) {
+            Bike->telemetryForwarded();
             h->virtualbike_setHeartRate(Bike->currentHeart().value());
 
             uint8_t ftms_message[255];
@@ -1042,25 +1042,27 @@ void virtualbike::bikeProvider() {
     Q_UNUSED(erg_mode);
 #endif
 
-    qDebug() << QStringLiteral("bikeProvider") << whenLastFTMSFrameReceived()
-             << (qint64)(whenLastFTMSFrameReceived() + ((qint64)2000)) << erg_mode;
-    // zwift with the last update, seems to sending power request only when it actually wants to change it
-    // so i need to keep this on to the bike
-    if (whenLastFTMSFrameReceived() > 0 &&
-        (QDateTime::currentMSecsSinceEpoch() > (qint64)(whenLastFTMSFrameReceived() + ((qint64)2000))) && erg_mode) {
-        qDebug() << QStringLiteral("zwift is not sending the power anymore, let's continue with the last value");
-        writeP2AD9->changePower(((bike *)Bike)->lastRequestedPower().value());
+    if (heartbeat) {
+        qDebug() << QStringLiteral("bikeProvider") << whenLastFTMSFrameReceived()
+                 << (qint64)(whenLastFTMSFrameReceived() + ((qint64)2000)) << erg_mode;
+        // zwift with the last update, seems to sending power request only when it actually wants to change it
+        // so i need to keep this on to the bike
+        if (whenLastFTMSFrameReceived() > 0 &&
+            (QDateTime::currentMSecsSinceEpoch() > (qint64)(whenLastFTMSFrameReceived() + ((qint64)2000))) &&
+            erg_mode) {
+            qDebug() << QStringLiteral("zwift is not sending the power anymore, let's continue with the last value");
+            writeP2AD9->changePower(((bike *)Bike)->lastRequestedPower().value());
+        }
     }
 
     if (leController->state() != QLowEnergyController::ConnectedState) {
-        qDebug() << QStringLiteral("virtual bike bluetooth not connected");
+        if (heartbeat)
+            qDebug() << QStringLiteral("virtual bike bluetooth not connected");
 
         return;
-    } else {
-        bool bluetooth_relaxed =
-            settings.value(QZSettings::bluetooth_relaxed, QZSettings::default_bluetooth_relaxed).toBool();
-        bool bluetooth_30m_hangs =
-            settings.value(QZSettings::bluetooth_30m_hangs, QZSettings::default_bluetooth_30m_hangs).toBool();
+    } else if (heartbeat) {
+        bool bluetooth_relaxed = settings.bluetooth_relaxed;
+        bool bluetooth_30m_hangs = settings.bluetooth_30m_hangs;
         if (bluetooth_relaxed) {
 
             leController->stopAdvertising();
@@ -1078,13 +1080,13 @@ void virtualbike::bikeProvider() {
         qDebug() << QStringLiteral("virtual bike connected");
     }
 
-    QByteArray value;
+    const QByteArray *value;
 
     if (!echelon && !ifit) {
         if (!heart_only) {
             if (!cadence && !power) {
-                value.clear();
-                if (notif2AD2->notify(value) == CN_OK) {
+                value = batch.find(0x2AD2);
+                if (value) {
                     if (!serviceFIT) {
                         qDebug() << QStringLiteral("serviceFIT not available");
 
@@ -1099,11 +1101,13 @@ void virtualbike::bikeProvider() {
 
                         return;
                     }
-                    writeCharacteristic(serviceFIT, characteristic, value);
+                    writeCharacteristic(serviceFIT, characteristic, *value);
+                    notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                    Bike->telemetryForwarded();
                 }
             } else if (power) {
-                value.clear();
-                if (notif2A63->notify(value) == CN_OK) {
+                value = batch.find(0x2A63);
+                if (value) {
 
                     if (!service) {
                         qDebug() << QStringLiteral("service not available");
@@ -1119,11 +1123,13 @@ void virtualbike::bikeProvider() {
 
                         return;
                     }
-                    writeCharacteristic(service, characteristic, value);
+                    writeCharacteristic(service, characteristic, *value);
+                    notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                    Bike->telemetryForwarded();
                 }
             } else {
-                value.clear();
-                if (notif2A5B->notify(value) == CN_OK) {
+                value = batch.find(0x2A5B);
+                if (value) {
 
                     if (!service) {
                         qDebug() << QStringLiteral("service not available");
@@ -1139,11 +1145,13 @@ void virtualbike::bikeProvider() {
 
                         return;
                     }
-                    writeCharacteristic(service, characteristic, value);
+                    writeCharacteristic(service, characteristic, *value);
+                    notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                    Bike->telemetryForwarded();
                 }
             }
         }
-    } else if (ifit) {
+    } else if (ifit && heartbeat) {
         // timeout di 500 ms
         qDebug() << QStringLiteral("iFit Last Frame") << iFit_TSLastFrame;
         if (iFit_TSLastFrame != 0 && iFit_TSLastFrame + 500 < QDateTime::currentMSecsSinceEpoch()) {
@@ -1157,7 +1165,7 @@ void virtualbike::bikeProvider() {
             characteristicChanged(characteristic, copy);
 */
         }
-    } else {
+    } else if (!ifit && heartbeat) {
 
         if (echelonInitDone) {
             echelonWriteStatus();
@@ -1169,7 +1177,7 @@ void virtualbike::bikeProvider() {
     // Q_ASSERT(characteristic.isValid());
     // service->readCharacteristic(characteristic);
 
-    if (battery) {
+    if (battery && heartbeat) {
         if (!serviceBattery) {
             qDebug() << QStringLiteral("serviceBattery not available");
 
@@ -1196,8 +1204,8 @@ void virtualbike::bikeProvider() {
             return;
         }
 
-        QByteArray valueHR;
-        if (notif2A37->notify(valueHR) == CN_OK) {
+        const QByteArray *valueHR = batch.find(0x2A37);
+        if (valueHR) {
             QLowEnergyCharacteristic characteristicHR = serviceHR->characteristic(QBluetoothUuid::HeartRateMeasurement);
 
             Q_ASSERT(characteristicHR.isValid());
@@ -1206,7 +1214,8 @@ void virtualbike::bikeProvider() {
 
                 return;
             }
-            writeCharacteristic(serviceHR, characteristicHR, valueHR);
+            writeCharacteristic(serviceHR, characteristicHR, *valueHR);
+            notifications->delivered(QStringLiteral("bluetooth"), 1, valueHR->size());
         }
     }
 }
@@ -25,6 +25,7 @@
 #ifdef Q_OS_IOS
 #include "ios/lockscreen.h"
 #endif
+#include "characteristics/characteristicnotificationscheduler.h"
 #include "devices/dircon/dirconmanager.h"
 #include "virtualdevices/virtualdevice.h"
 
@@ -57,14 +58,11 @@ class virtualbike : public virtualdevice {
     QLowEnergyServiceData serviceData;
     QLowEnergyServiceData serviceDataChanged;
     QLowEnergyServiceData serviceEchelon;
-    QTimer bikeTimer;
     bluetoothdevice *Bike;
+    // the notifications of the bluetooth peripheral and of Dircon
+    CharacteristicNotificationScheduler *notifications = 0;
     CharacteristicWriteProcessor2AD9 *writeP2AD9 = 0;
-    CharacteristicNotifier2AD2 *notif2AD2 = 0;
     CharacteristicNotifier2AD9 *notif2AD9 = 0;
-    CharacteristicNotifier2A63 *notif2A63 = 0;
-    CharacteristicNotifier2A37 *notif2A37 = 0;
-    CharacteristicNotifier2A5B *notif2A5B = 0;
 
     qint64 lastFTMSFrameReceived = 0;
     qint64 lastDirconFTMSFrameReceived = 0;
@@ -98,7 +96,7 @@ class virtualbike : public virtualdevice {
   private slots:
     void dirconFtmsCharacteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
     void characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
-    void bikeProvider();
+    void bikeProvider(const CharacteristicNotificationBatch &batch);
     void reconnect();
     void error(QLowEnergyController::Error newError);
 };
@@ -1,14 +1,14 @@
 #include "virtualdevices/virtualrower.h"
 #include "qsettings.h"
+#include "characteristics/characteristicnotifier2a37.h"
+#include "characteristics/characteristicnotifier2ad1.h"
 #include "rower.h"
+#include "qzsettingssnapshot.h"
 
 #include <QDataStream>
 #include <QMetaEnum>
 #include <QSettings>
 #include <QtMath>
-#include <chrono>
-
-using namespace std::chrono_literals;
 
 virtualrower::virtualrower(bluetoothdevice *t, bool noWriteResistance, bool noHeartService) {
     Rower = t;
@@ -175,11 +175,12 @@ virtualrower::virtualrower(bluetoothdevice *t, bool noWriteResistance, bool noHe
     }
 
     //! [Provide Heartbeat]
-    QObject::connect(&rowerTimer, &QTimer::timeout, this, &virtualrower::rowerProvider);
-    if (settings.value(QZSettings::race_mode, QZSettings::default_race_mode).toBool())
-        rowerTimer.start(100ms);
-    else
-        rowerTimer.start(1s);
+    notifications = new CharacteristicNotificationScheduler(Rower, this);
+    notifications->add(new CharacteristicNotifier2AD1(Rower));
+    notifications->add(new CharacteristicNotifier2A37(Rower));
+    QObject::connect(notifications, &CharacteristicNotificationScheduler::notificationsReady, this,
+                     &virtualrower::rowerProvider);
+    notifications->start();
 
     //! [Provide Heartbeat]
     QObject::connect(leController, &QLowEnergyController::disconnected, this, &virtualrower::reconnect);
@@ -307,11 +308,12 @@ void virtualrower::reconnect() {
     leController->startAdvertising(pars, advertisingData, advertisingData);
 }
 
-void virtualrower::rowerProvider() {
+void virtualrower::rowerProvider(const CharacteristicNotificationBatch &batch) {
 
-    QSettings settings;
-    bool heart_only =
-        settings.value(QZSettings::virtual_device_onlyheart, QZSettings::default_virtual_device_onlyheart).toBool();
+    // the connection checks and the logs keep the pace of the heartbeat
+    const bool heartbeat = batch.heartbeat();
+    const QZSettingsValues &settings = QZSettingsSnapshot::get();
+    bool heart_only = settings.virtual_device_onlyheart;
 
     double normalizeWattage = Rower->wattsMetric().value();
     if (normalizeWattage < 0)
@@ -322,12 +324,15 @@ void virtualrower::rowerProvider() {
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
     if (h) {
+        if (!heartbeat)
+            return;
         // really connected to a device
         if (h->virtualrower_updateFTMS(
                 normalizeSpeed, (char)Rower->currentResistance().value(), (uint16_t)Rower->currentCadence().value() * 2,
                 (uint16_t)normalizeWattage, Rower->currentCrankRevolutions(), Rower->lastCrankEventTime(),
                 ((rower *)Rower)->currentStrokesCount().value(), Rower->odometer() * 1000, Rower->calories().value(),
                 QTime(0, 0, 0).secsTo(((rower *)Rower)->currentPace()))) {
+            Rower->telemetryForwarded();
             h->virtualrower_setHeartRate(Rower->currentHeart().value());
 
             uint8_t ftms_message[255];
@@ -354,14 +359,13 @@ void virtualrower::rowerProvider() {
 #endif
 
     if (leController->state() != QLowEnergyController::ConnectedState) {
-        qDebug() << QStringLiteral("virtual rower not connected");
+        if (heartbeat)
+            qDebug() << QStringLiteral("virtual rower not connected");
 
         return;
-    } else {
-        bool bluetooth_relaxed =
-            settings.value(QZSettings::bluetooth_relaxed, QZSettings::default_bluetooth_relaxed).toBool();
-        bool bluetooth_30m_hangs =
-            settings.value(QZSettings::bluetooth_30m_hangs, QZSettings::default_bluetooth_30m_hangs).toBool();
+    } else if (heartbeat) {
+        bool bluetooth_relaxed = settings.bluetooth_relaxed;
+        bool bluetooth_30m_hangs = settings.bluetooth_30m_hangs;
         if (bluetooth_relaxed) {
 
             leController->stopAdvertising();
@@ -379,37 +383,9 @@ void virtualrower::rowerProvider() {
         qDebug() << QStringLiteral("virtual rower connected");
     }
 
-    QByteArray value;
-
-    if (!heart_only) {
-
-        value.append((char)0x2C);
-        value.append((char)0x03);
-
-        value.append((char)((uint8_t)(Rower->currentCadence().value() * 2) & 0xFF)); // Stroke Rate
-
-        value.append((char)((uint16_t)(((rower *)Rower)->currentStrokesCount().value()) & 0xFF));        // Stroke Count
-        value.append((char)(((uint16_t)(((rower *)Rower)->currentStrokesCount().value()) >> 8) & 0xFF)); // Stroke Count
-
-        value.append((char)(((uint16_t)(((rower *)Rower)->odometer() * 1000.0)) & 0xFF));       // Distance
-        value.append((char)(((uint16_t)(((rower *)Rower)->odometer() * 1000.0) >> 8) & 0xFF));  // Distance
-        value.append((char)(((uint16_t)(((rower *)Rower)->odometer() * 1000.0) >> 16) & 0xFF)); // Distance
-
-        value.append((char)(((uint16_t)QTime(0, 0, 0).secsTo(((rower *)Rower)->currentPace())) & 0xFF));      // pace
-        value.append((char)(((uint16_t)QTime(0, 0, 0).secsTo(((rower *)Rower)->currentPace())) >> 8) & 0xFF); // pace
-
-        value.append((char)(((uint16_t)Rower->wattsMetric().value()) & 0xFF));      // watts
-        value.append((char)(((uint16_t)Rower->wattsMetric().value()) >> 8) & 0xFF); // watts
-
-        value.append((char)((uint16_t)(Rower->calories().value()) & 0xFF));        // calories
-        value.append((char)(((uint16_t)(Rower->calories().value()) >> 8) & 0xFF)); // calories
-        value.append((char)((uint16_t)(Rower->calories().value()) & 0xFF));        // calories
-        value.append((char)(((uint16_t)(Rower->calories().value()) >> 8) & 0xFF)); // calories
-        value.append((char)((uint16_t)(Rower->calories().value()) & 0xFF));        // calories
-
-        value.append(char(Rower->currentHeart().value())); // Actual value.
-        value.append((char)0);                             // Bkool FTMS protocol HRM offset 1280 fix
+    const QByteArray *value = batch.find(0x2AD1);
 
+    if (!heart_only && value) {
         if (!serviceFIT) {
             qDebug() << QStringLiteral("serviceFIT not available");
 
@@ -428,7 +404,9 @@ void virtualrower::rowerProvider() {
 
             return;
         }
-        writeCharacteristic(serviceFIT, characteristic, value);
+        writeCharacteristic(serviceFIT, characteristic, *value);
+        notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+        Rower->telemetryForwarded();
     }
     // characteristic
     //        = service->characteristic((QBluetoothUuid::CharacteristicType)0x2AD9); // Fitness Machine Control Point
@@ -442,18 +420,20 @@ void virtualrower::rowerProvider() {
             return;
         }
 
-        QByteArray valueHR;
-        valueHR.append(char(0));                                   // Flags that specify the format of the value.
-        valueHR.append(char(Rower->metrics_override_heartrate())); // Actual value.
-        QLowEnergyCharacteristic characteristicHR = serviceHR->characteristic(QBluetoothUuid::HeartRateMeasurement);
+        const QByteArray *valueHR = batch.find(0x2A37);
+        if (valueHR) {
+            QLowEnergyCharacteristic characteristicHR =
+                serviceHR->characteristic(QBluetoothUuid::HeartRateMeasurement);
 
-        Q_ASSERT(characteristicHR.isValid());
-        if (leController->state() != QLowEnergyController::ConnectedState) {
-            qDebug() << QStringLiteral("virtual rower not connected");
+            Q_ASSERT(characteristicHR.isValid());
+            if (leController->state() != QLowEnergyController::ConnectedState) {
+                qDebug() << QStringLiteral("virtual rower not connected");
 
-            return;
+                return;
+            }
+            writeCharacteristic(serviceHR, characteristicHR, *valueHR);
+            notifications->delivered(QStringLiteral("bluetooth"), 1, valueHR->size());
         }
-        writeCharacteristic(serviceHR, characteristicHR, valueHR);
     }
 }
 
@@ -25,6 +25,7 @@
 #ifdef Q_OS_IOS
 #include "ios/lockscreen.h"
 #endif
+#include "characteristics/characteristicnotificationscheduler.h"
 #include "devices/bluetoothdevice.h"
 #include "virtualdevice.h"
 
@@ -43,8 +44,8 @@ class virtualrower : public virtualdevice {
     QLowEnergyAdvertisingData advertisingData;
     QLowEnergyServiceData serviceDataHR;
     QLowEnergyServiceData serviceDataFIT;
-    QTimer rowerTimer;
     bluetoothdevice *Rower;
+    CharacteristicNotificationScheduler *notifications = 0;
 
     uint16_t lastWheelTime = 0;
     uint32_t wheelRevs = 0;
@@ -64,7 +65,7 @@ class virtualrower : public virtualdevice {
     
   private slots:
     void characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
-    void rowerProvider();
+    void rowerProvider(const CharacteristicNotificationBatch &batch);
     void reconnect();
     void error(QLowEnergyController::Error newError);
 };
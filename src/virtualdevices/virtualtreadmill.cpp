@@ -1,9 +1,7 @@
 #include "virtualdevices/virtualtreadmill.h"
+#include "qzsettingssnapshot.h"
 #include <QSettings>
 #include <QtMath>
-#include <chrono>
-
-using namespace std::chrono_literals;
 
 virtualtreadmill::virtualtreadmill(bluetoothdevice *t, bool noHeartService) {
     QSettings settings;
@@ -14,8 +12,9 @@ virtualtreadmill::virtualtreadmill(bluetoothdevice *t, bool noHeartService) {
     double bikeResistanceGain =
         settings.value(QZSettings::bike_resistance_gain_f, QZSettings::default_bike_resistance_gain_f).toDouble();
     this->noHeartService = noHeartService;
+    notifications = new CharacteristicNotificationScheduler(t, this);
     if (settings.value(QZSettings::dircon_yes, QZSettings::default_dircon_yes).toBool()) {
-        dirconManager = new DirconManager(t, bikeResistanceOffset, bikeResistanceGain, this);
+        dirconManager = new DirconManager(t, bikeResistanceOffset, bikeResistanceGain, notifications, this);
         connect(dirconManager, SIGNAL(changeInclination(double, double)), this,
                 SIGNAL(changeInclination(double, double)));
         connect(dirconManager, SIGNAL(changeInclination(double, double)), this,
@@ -26,10 +25,10 @@ virtualtreadmill::virtualtreadmill(bluetoothdevice *t, bool noHeartService) {
     if (!settings.value(QZSettings::virtual_device_bluetooth, QZSettings::default_virtual_device_bluetooth).toBool())
         return;
     notif2AD9 = new CharacteristicNotifier2AD9(t, this);
-    notif2AD2 = new CharacteristicNotifier2AD2(t, this);
-    notif2ACD = new CharacteristicNotifier2ACD(t, this);
-    notif2A53 = new CharacteristicNotifier2A53(t, this);
-    notif2A37 = new CharacteristicNotifier2A37(t, this);
+    notifications->add(new CharacteristicNotifier2AD2(t));
+    notifications->add(new CharacteristicNotifier2ACD(t));
+    notifications->add(new CharacteristicNotifier2A53(t));
+    notifications->add(new CharacteristicNotifier2A37(t));
     writeP2AD9 = new CharacteristicWriteProcessor2AD9(bikeResistanceGain, bikeResistanceOffset, t, notif2AD9, this);
     connect(writeP2AD9, SIGNAL(changeInclination(double, double)), this, SIGNAL(changeInclination(double, double)));
     connect(writeP2AD9, SIGNAL(slopeChanged()), this, SLOT(slopeChanged()));
@@ -256,11 +255,9 @@ virtualtreadmill::virtualtreadmill(bluetoothdevice *t, bool noHeartService) {
         QObject::connect(leController, &QLowEnergyController::disconnected, this, &virtualtreadmill::reconnect);
     }
     //! [Provide Heartbeat]
-    QObject::connect(&treadmillTimer, &QTimer::timeout, this, &virtualtreadmill::treadmillProvider);
-    if (settings.value(QZSettings::race_mode, QZSettings::default_race_mode).toBool())
-        treadmillTimer.start(100ms);
-    else
-        treadmillTimer.start(1s);
+    QObject::connect(notifications, &CharacteristicNotificationScheduler::notificationsReady, this,
+                     &virtualtreadmill::treadmillProvider);
+    notifications->start();
 }
 
 void virtualtreadmill::characteristicChanged(const QLowEnergyCharacteristic &characteristic,
@@ -330,15 +327,19 @@ void virtualtreadmill::reconnect() {
     }
 }
 
-void virtualtreadmill::treadmillProvider() {
+void virtualtreadmill::treadmillProvider(const CharacteristicNotificationBatch &batch) {
     const uint64_t slopeTimeoutSecs = 30;
-    QSettings settings;
+    // the connection checks and the logs keep the pace of the heartbeat
+    const bool heartbeat = batch.heartbeat();
 
     if ((uint64_t)QDateTime::currentSecsSinceEpoch() > lastSlopeChanged + slopeTimeoutSecs)
         m_autoInclinationEnabled = false;
 
 #ifdef Q_OS_IOS
 #ifndef IO_UNDER_QT
+    if (h && !heartbeat)
+        return;
+    QSettings settings;
     bool double_cadence = settings
                               .value(QZSettings::powr_sensor_running_cadence_double,
                                      QZSettings::default_powr_sensor_running_cadence_double)
@@ -354,6 +355,7 @@ void virtualtreadmill::treadmillProvider() {
                 normalizeSpeed, 0, (uint16_t)((treadmill *)treadMill)->currentCadence().value() * cadence_multiplier,
                 (uint16_t)((treadmill *)treadMill)->wattsMetric().value(),
                 treadMill->currentInclination().value() * 10, (uint64_t)(((treadmill *)treadMill)->odometer() * 1000.0))) {
+            treadMill->telemetryForwarded();
             h->virtualtreadmill_setHeartRate(((treadmill *)treadMill)->currentHeart().value());
             lastSlopeChanged = h->virtualtreadmill_lastChangeCurrentSlope();
             if ((uint64_t)QDateTime::currentSecsSinceEpoch() < lastSlopeChanged + slopeTimeoutSecs)
@@ -365,23 +367,22 @@ void virtualtreadmill::treadmillProvider() {
 #endif
 
     if (leController->state() != QLowEnergyController::ConnectedState) {
-        qDebug() << QStringLiteral("virtualtreadmill connection error");
+        if (heartbeat)
+            qDebug() << QStringLiteral("virtualtreadmill connection error");
         return;
-    } else {
-        QSettings settings;
-        bool bluetooth_relaxed =
-            settings.value(QZSettings::bluetooth_relaxed, QZSettings::default_bluetooth_relaxed).toBool();
+    } else if (heartbeat) {
+        bool bluetooth_relaxed = QZSettingsSnapshot::get().bluetooth_relaxed;
         if (bluetooth_relaxed) {
             leController->stopAdvertising();
         }
     }
 
-    QByteArray value;
+    const QByteArray *value;
 
     if (ftmsServiceEnable()) {
         if (ftmsTreadmillEnable()) {
-            value.clear();
-            if (notif2ACD->notify(value) == CN_OK) {
+            value = batch.find(0x2ACD);
+            if (value) {
                 if (!serviceFTMS) {
                     qDebug() << QStringLiteral("service not available");
 
@@ -397,14 +398,16 @@ void virtualtreadmill::treadmillProvider() {
                     return;
                 }
                 try {
-                    serviceFTMS->writeCharacteristic(characteristic, value); // Potentially causes notification.
+                    serviceFTMS->writeCharacteristic(characteristic, *value); // Potentially causes notification.
+                    notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                    treadMill->telemetryForwarded();
                 } catch (...) {
                     qDebug() << QStringLiteral("virtualtreadmill error!");
                 }
             }
         }
-        value.clear();
-        if (notif2AD2->notify(value) == CN_OK) {
+        value = batch.find(0x2AD2);
+        if (value) {
             if (!serviceFTMS) {
                 qDebug() << QStringLiteral("serviceFIT not available");
 
@@ -420,15 +423,17 @@ void virtualtreadmill::treadmillProvider() {
                 return;
             }
             try {
-                serviceFTMS->writeCharacteristic(characteristic, value); // Potentially causes notification.
+                serviceFTMS->writeCharacteristic(characteristic, *value); // Potentially causes notification.
+                notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                treadMill->telemetryForwarded();
             } catch (...) {
                 qDebug() << QStringLiteral("virtualtreadmill error!");
             }
         }
     }
     if (RSCEnable()) {
-        value.clear();
-        if (notif2A53->notify(value) == CN_OK) {
+        value = batch.find(0x2A53);
+        if (value) {
             if (!serviceRSC) {
                 qDebug() << QStringLiteral("serviceFIT not available");
 
@@ -444,7 +449,9 @@ void virtualtreadmill::treadmillProvider() {
                 return;
             }
             try {
-                serviceRSC->writeCharacteristic(characteristic, value); // Potentially causes notification.
+                serviceRSC->writeCharacteristic(characteristic, *value); // Potentially causes notification.
+                notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
+                treadMill->telemetryForwarded();
             } catch (...) {
                 qDebug() << QStringLiteral("virtualtreadmill error!");
             }
@@ -457,8 +464,8 @@ void virtualtreadmill::treadmillProvider() {
     // service->readCharacteristic(characteristic);
 
     if (noHeartService == false) {
-        value.clear();
-        if (notif2A53->notify(value) == CN_OK) {
+        value = batch.find(0x2A37);
+        if (value) {
             if (!serviceHR) {
                 qDebug() << QStringLiteral("serviceFIT not available");
 
@@ -474,7 +481,8 @@ void virtualtreadmill::treadmillProvider() {
                 return;
             }
             try {
-                serviceHR->writeCharacteristic(characteristic, value); // Potentially causes notification.
+                serviceHR->writeCharacteristic(characteristic, *value); // Potentially causes notification.
+                notifications->delivered(QStringLiteral("bluetooth"), 1, value->size());
             } catch (...) {
                 qDebug() << QStringLiteral("virtualtreadmill error!");
             }
@@ -499,8 +507,7 @@ bool virtualtreadmill::connected() {
 // Android>9 RSC   |               |                     |           |  X  |
 
 bool virtualtreadmill::ftmsServiceEnable() {
-    QSettings settings;
-    bool cadence = settings.value(QZSettings::run_cadence_sensor, QZSettings::default_run_cadence_sensor).toBool();
+    bool cadence = QZSettingsSnapshot::get().run_cadence_sensor;
     if (!cadence)
         return true;
     if (noHeartService == false)
@@ -509,16 +516,14 @@ bool virtualtreadmill::ftmsServiceEnable() {
 }
 
 bool virtualtreadmill::ftmsTreadmillEnable() {
-    QSettings settings;
-    bool cadence = settings.value(QZSettings::run_cadence_sensor, QZSettings::default_run_cadence_sensor).toBool();
+    bool cadence = QZSettingsSnapshot::get().run_cadence_sensor;
     if (!cadence)
         return true;
     return false;
 }
 
 bool virtualtreadmill::RSCEnable() {
-    QSettings settings;
-    bool cadence = settings.value(QZSettings::run_cadence_sensor, QZSettings::default_run_cadence_sensor).toBool();
+    bool cadence = QZSettingsSnapshot::get().run_cadence_sensor;
     if (cadence)
         return true;
     return false;
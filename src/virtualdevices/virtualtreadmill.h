@@ -26,6 +26,7 @@
 #include <QtCore/qscopedpointer.h>
 #include <QtCore/qtimer.h>
 #include "treadmill.h"
+#include "characteristics/characteristicnotificationscheduler.h"
 #include "devices/dircon/dirconmanager.h"
 #include "virtualdevice.h"
 
@@ -45,17 +46,14 @@ class virtualtreadmill : public virtualdevice {
     QLowEnergyServiceData serviceDataFTMS;
     QLowEnergyServiceData serviceDataRSC;
     QLowEnergyServiceData serviceDataHR;
-    QTimer treadmillTimer;
     bluetoothdevice *treadMill;
+    // the notifications of the bluetooth peripheral and of Dircon
+    CharacteristicNotificationScheduler *notifications = 0;
 
     uint64_t lastSlopeChanged = 0;
 
     CharacteristicWriteProcessor2AD9 *writeP2AD9 = 0;
-    CharacteristicNotifier2AD2 *notif2AD2 = 0;
     CharacteristicNotifier2AD9 *notif2AD9 = 0;
-    CharacteristicNotifier2A53 *notif2A53 = 0;
-    CharacteristicNotifier2ACD *notif2ACD = 0;
-    CharacteristicNotifier2A37 *notif2A37 = 0;
     DirconManager *dirconManager = 0;
 
     bool noHeartService = false;
@@ -77,7 +75,7 @@ class virtualtreadmill : public virtualdevice {
 
   private slots:
     void characteristicChanged(const QLowEnergyCharacteristic &characteristic, const QByteArray &newValue);
-    void treadmillProvider();
+    void treadmillProvider(const CharacteristicNotificationBatch &batch);
     void reconnect();
     void slopeChanged();
     void dirconChangedInclination(double grade, double percentage);
@@ -47,6 +47,8 @@ bool WebServerInfoSender::send(const QString &data) {
     if (isRunning() && !data.isEmpty()) {
         bool rv = true, oldrv = false;
         for (QWebSocket *client : sendToClients) {
+            if (feedClients.contains(client))
+                continue;
             rv = client->sendTextMessage(data) > 0;
             if (!oldrv)
                 oldrv = rv;
@@ -56,6 +58,41 @@ bool WebServerInfoSender::send(const QString &data) {
         return false;
 }
 
+bool WebServerInfoSender::reply(const QString &data) {
+    if (!currentClient)
+        return send(data);
+    return isRunning() && !data.isEmpty() && currentClient->sendTextMessage(data) > 0;
+}
+
+bool WebServerInfoSender::subscribeFeed(bool binary) {
+    if (!currentClient)
+        return false;
+    feedClients.insert(currentClient, binary);
+    return true;
+}
+
+bool WebServerInfoSender::hasFeedClients() const { return !feedClients.isEmpty(); }
+
+bool WebServerInfoSender::sendFeed(const QByteArray &json, const QByteArray &binary, const QByteArray &fields) {
+    if (!isRunning())
+        return false;
+    bool rv = false;
+    QString text;
+    QHash<QWebSocket *, bool>::const_iterator i = feedClients.constBegin();
+    for (; i != feedClients.constEnd(); ++i) {
+        if (i.value()) {
+            if (!fields.isEmpty())
+                i.key()->sendTextMessage(QString::fromUtf8(fields));
+            rv = i.key()->sendBinaryMessage(binary) > 0 || rv;
+        } else {
+            if (text.isEmpty())
+                text = QString::fromUtf8(json);
+            rv = i.key()->sendTextMessage(text) > 0 || rv;
+        }
+    }
+    return rv;
+}
+
 void WebServerInfoSender::innerStop() {
     if (innerTcpServer) {
         if (isRunning())
@@ -63,6 +100,8 @@ void WebServerInfoSender::innerStop() {
         httpServer->deleteLater();
         clients.clear();
         sendToClients.clear();
+        feedClients.clear();
+        currentClient = 0;
         reply2Req.clear();
         innerTcpServer = 0;
         httpServer = 0;
@@ -172,7 +211,9 @@ void WebServerInfoSender::processTextMessage(QString message) {
         pClient->sendTextMessage(message);
     }*/
     //qDebug() << QStringLiteral("Message received:") << message;
+    currentClient = qobject_cast<QWebSocket *>(sender());
     emit onDataReceived(message.toUtf8());
+    currentClient = 0;
 }
 
 void WebServerInfoSender::processFetcherRequest(QString data) {
@@ -241,6 +282,9 @@ void WebServerInfoSender::socketDisconnected() {
     qDebug() << QStringLiteral("socketDisconnected:") << pClient;
     if (pClient) {
         clients.removeAll(pClient);
+        feedClients.remove(pClient);
+        if (currentClient == pClient)
+            currentClient = 0;
         if (!sendToClients.removeAll(pClient)) {
             QMutableHashIterator<QNetworkReply *, QPair<QJsonObject, QWebSocket *>> i(reply2Req);
             while (i.hasNext()) {
@@ -261,5 +305,7 @@ void WebServerInfoSender::processBinaryMessage(QByteArray message) {
         pClient->sendBinaryMessage(message);
     }*/
     //qDebug() << QStringLiteral("Binary Message received:") << message.toHex();
+    currentClient = qobject_cast<QWebSocket *>(sender());
     emit onDataReceived(message);
+    currentClient = 0;
 }
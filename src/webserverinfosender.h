@@ -23,6 +23,10 @@ class WebServerInfoSender : public TemplateInfoSender {
     virtual ~WebServerInfoSender();
     virtual bool isRunning() const;
     virtual bool send(const QString &data);
+    virtual bool reply(const QString &data);
+    virtual bool subscribeFeed(bool binary);
+    virtual bool hasFeedClients() const;
+    virtual bool sendFeed(const QByteArray &json, const QByteArray &binary, const QByteArray &fields);
 
   private:
     QHttpServer *httpServer = 0;
@@ -39,6 +43,10 @@ class WebServerInfoSender : public TemplateInfoSender {
     QList<QWebSocket *> clients;
     QNetworkAccessManager *fetcher = 0;
     QList<QWebSocket *> sendToClients;
+    // clients of the delta feed (true for the binary frames): they don't get the template output anymore
+    QHash<QWebSocket *, bool> feedClients;
+    // the client whose message is being processed
+    QWebSocket *currentClient = 0;
     QHash<QString, QString> relative2Absolute;
     QHash<QNetworkReply *, QPair<QJsonObject, QWebSocket *>> reply2Req;
   private slots:
@@ -0,0 +1,340 @@
+#include "workouthistory.h"
+#include "powercurve.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QThreadPool>
+#include <algorithm>
+
+const int workoutsummary::peakDurations[workoutsummary::PEAKS] = {5, 60, 300, 1200};
+
+namespace {
+
+const quint32 CACHE_MAGIC = 0x48575a51; // "QZWH"
+const quint32 CACHE_VERSION = 1;
+
+// a longer gap between two records is a pause: it counts as this many seconds, not more
+const qint64 maxRecordGap = 10;
+
+void writeSummary(QDataStream &out, const workoutsummary &s) {
+    out << s.fileName << s.modified << s.size << qint32(s.records) << s.startMs << s.sport << s.elapsed << s.distance
+        << s.calories << s.avgWatt << s.maxWatt << s.avgHeart << s.maxHeart << s.avgCadence;
+    for (double peak : s.peaks)
+        out << peak;
+    for (double zone : s.heartZones)
+        out << zone;
+}
+
+void readSummary(QDataStream &in, workoutsummary *s) {
+    qint32 records;
+    in >> s->fileName >> s->modified >> s->size >> records >> s->startMs >> s->sport >> s->elapsed >> s->distance >>
+        s->calories >> s->avgWatt >> s->maxWatt >> s->avgHeart >> s->maxHeart >> s->avgCadence;
+    s->records = records;
+    for (double &peak : s->peaks)
+        in >> peak;
+    for (double &zone : s->heartZones)
+        in >> zone;
+}
+
+// decodes and summarizes one file on a thread of the pool, into a slot nobody else touches until waitForDone()
+class summaryTask : public QRunnable {
+  public:
+    summaryTask(const QString &path, const QVector<double> &zones, workoutsummary *summary)
+        : path(path), zones(zones), summary(summary) {}
+
+    void run() override {
+        fitrecords records;
+        if (!fitdecoder::decodeFile(path, &records))
+            qDebug() << QStringLiteral("workouthistory: can't decode") << path;
+        workoutsummary s = workouthistory::summarize(records, zones);
+        s.fileName = summary->fileName;
+        s.modified = summary->modified;
+        s.size = summary->size;
+        *summary = s;
+    }
+
+  private:
+    QString path;
+    QVector<double> zones;
+    workoutsummary *summary;
+};
+
+class refreshTask : public QRunnable {
+  public:
+    refreshTask(workouthistory *history, QAtomicInt *running) : history(history), running(running) {}
+
+    void run() override {
+        int decoded = 0;
+        for (;;) {
+            decoded += history->refresh();
+            if (running->testAndSetOrdered(1, 0))
+                break;
+            // refreshInBackground() while refreshing: a workout saved after the scan, once more
+            running->storeRelease(1);
+        }
+        emit history->refreshed(decoded);
+    }
+
+  private:
+    workouthistory *history;
+    QAtomicInt *running;
+};
+
+} // namespace
+
+workouthistory::workouthistory(const QString &directory, const QString &cacheFile, QObject *parent)
+    : QObject(parent), dir(directory), cache(cacheFile) {
+    if (cache.isEmpty()) {
+        const QByteArray key =
+            QCryptographicHash::hash(QDir(dir).absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+        cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/history/") +
+                QString::fromLatin1(key) + QStringLiteral(".qzhistory");
+    }
+    backgroundPool.setMaxThreadCount(1);
+}
+
+workouthistory::~workouthistory() { backgroundPool.waitForDone(); }
+
+void workouthistory::setHeartRateZones(const QVector<double> &bounds) {
+    QMutexLocker locker(&mutex);
+    if (bounds == zones)
+        return;
+    zones = bounds;
+    // the zone times of the summaries are of the old bounds
+    summaries.clear();
+}
+
+QVector<double> workouthistory::heartRateZones(double maxHeartRate, const QVector<double> &percentages) {
+    QVector<double> bounds;
+    bounds.reserve(percentages.count());
+    for (double percentage : percentages)
+        bounds.append(maxHeartRate * percentage / 100.0);
+    return bounds;
+}
+
+bool workouthistory::loadCache() {
+    QFile file(cache);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic, version;
+    QVector<double> cachedZones;
+    quint32 count;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+        return false;
+    in >> cachedZones >> count;
+    if (in.status() != QDataStream::Ok)
+        return false;
+    {
+        QMutexLocker locker(&mutex);
+        if (cachedZones != zones)
+            return false;
+    }
+
+    QHash<QString, workoutsummary> loaded;
+    loaded.reserve(qMin<quint32>(count, 65536));
+    for (quint32 i = 0; i < count; i++) {
+        workoutsummary s;
+        readSummary(in, &s);
+        if (in.status() != QDataStream::Ok)
+            return false;
+        loaded.insert(s.fileName, s);
+    }
+    QMutexLocker locker(&mutex);
+    if (cachedZones != zones)
+        return false;
+    summaries.swap(loaded);
+    return true;
+}
+
+bool workouthistory::saveCache() const {
+    QDir().mkpath(QFileInfo(cache).absolutePath());
+    QSaveFile file(cache);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    {
+        QMutexLocker locker(&mutex);
+        out << CACHE_MAGIC << CACHE_VERSION << zones << quint32(summaries.count());
+        for (const workoutsummary &s : summaries)
+            writeSummary(out, s);
+    }
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+int workouthistory::refresh() {
+    QMutexLocker refreshing(&refreshMutex);
+    if (!cacheLoaded) {
+        loadCache();
+        cacheLoaded = true;
+    }
+
+    int decoded = 0;
+    bool changed = !QFile::exists(cache);
+    for (;;) {
+        QVector<double> bounds;
+        QHash<QString, workoutsummary> known;
+        {
+            QMutexLocker locker(&mutex);
+            bounds = zones;
+            known = summaries;
+        }
+        int count = 0;
+        QHash<QString, workoutsummary> current = scan(bounds, known, &count);
+        decoded += count;
+        changed = changed || count > 0 || current.count() != known.count();
+
+        QMutexLocker locker(&mutex);
+        // setHeartRateZones() while decoding: these zone times are of the old bounds, again with the new ones
+        if (bounds == zones) {
+            summaries.swap(current);
+            break;
+        }
+    }
+    if (changed && !saveCache())
+        qDebug() << QStringLiteral("workouthistory: can't write") << cache;
+    return decoded;
+}
+
+QHash<QString, workoutsummary> workouthistory::scan(const QVector<double> &bounds,
+                                                    const QHash<QString, workoutsummary> &known, int *count) const {
+    const QFileInfoList files = QDir(dir).entryInfoList(QStringList() << QStringLiteral("*.fit"), QDir::Files);
+    QHash<QString, workoutsummary> current;
+    current.reserve(files.count());
+    QVector<workoutsummary> decoded;
+    QStringList paths;
+    for (const QFileInfo &info : files) {
+        // the journal of the workout in progress, not a workout yet
+        if (info.fileName().startsWith(QStringLiteral("QZ-backup-")))
+            continue;
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        auto cached = known.constFind(info.fileName());
+        if (cached != known.constEnd() && cached->modified == modified && cached->size == info.size()) {
+            current.insert(info.fileName(), *cached);
+            continue;
+        }
+        workoutsummary s;
+        s.fileName = info.fileName();
+        s.modified = modified;
+        s.size = info.size();
+        decoded.append(s);
+        paths.append(info.absoluteFilePath());
+    }
+
+    // the slots don't move while the tasks fill them
+    if (!decoded.isEmpty()) {
+        QThreadPool pool;
+        if (maxThreads > 0)
+            pool.setMaxThreadCount(maxThreads);
+        for (int i = 0; i < decoded.count(); i++)
+            pool.start(new summaryTask(paths.at(i), bounds, &decoded[i]));
+        pool.waitForDone();
+    }
+    for (const workoutsummary &s : qAsConst(decoded))
+        current.insert(s.fileName, s);
+    *count = decoded.count();
+    return current;
+}
+
+void workouthistory::refreshInBackground() {
+    if (!background.testAndSetOrdered(0, 1)) {
+        background.testAndSetOrdered(1, 2);
+        return;
+    }
+    backgroundPool.start(new refreshTask(this, &background));
+}
+
+QList<workoutsummary> workouthistory::workouts() const {
+    QList<workoutsummary> list;
+    {
+        QMutexLocker locker(&mutex);
+        list.reserve(summaries.count());
+        for (const workoutsummary &s : summaries) {
+            if (s.records)
+                list.append(s);
+        }
+    }
+    std::sort(list.begin(), list.end(), [](const workoutsummary &a, const workoutsummary &b) {
+        return a.startMs != b.startMs ? a.startMs > b.startMs : a.fileName < b.fileName;
+    });
+    return list;
+}
+
+bool workouthistory::find(const QString &fileName, workoutsummary *summary) const {
+    QMutexLocker locker(&mutex);
+    auto it = summaries.constFind(fileName);
+    if (it == summaries.constEnd())
+        return false;
+    if (summary)
+        *summary = it.value();
+    return true;
+}
+
+workoutsummary workouthistory::summarize(const fitrecords &records, const QVector<double> &heartZoneBounds) {
+    workoutsummary s;
+    const int n = records.count();
+    s.records = n;
+    s.sport = records.sport;
+    if (!n)
+        return s;
+    s.startMs = records.timeMs(0);
+    s.elapsed = qMax<qint64>(0, (qint64)records.timestamp.at(n - 1) - records.timestamp.at(0));
+
+    // the power curve and the zones need one sample per second: a record holds its values until the next one
+    PowerCurve curve;
+    double wattSeconds = 0, heartSeconds = 0, cadenceSeconds = 0;
+    double seconds = 0, heartTime = 0, cadenceTime = 0;
+    for (int i = 0; i < n; i++) {
+        qint64 duration = 1;
+        if (i > 0) {
+            const qint64 dt = (qint64)records.timestamp.at(i) - records.timestamp.at(i - 1);
+            duration = dt <= 0 ? 0 : qMin(dt, maxRecordGap);
+        }
+        const double watt = records.watt(i);
+        const double heart = records.heartRate(i);
+        const double cadence = records.cadenceRpm(i);
+        s.distance = qMax(s.distance, records.distanceKm(i));
+        s.calories = qMax(s.calories, records.kcal(i));
+        s.maxWatt = qMax(s.maxWatt, watt);
+        s.maxHeart = qMax(s.maxHeart, heart);
+
+        for (qint64 k = 0; k < duration; k++)
+            curve.append(watt);
+        wattSeconds += watt * duration;
+        seconds += duration;
+        if (heart > 0) {
+            heartSeconds += heart * duration;
+            heartTime += duration;
+            const int zone =
+                std::upper_bound(heartZoneBounds.constBegin(), heartZoneBounds.constEnd(), heart) -
+                heartZoneBounds.constBegin();
+            if (!heartZoneBounds.isEmpty())
+                s.heartZones[qMin(zone, workoutsummary::HEART_ZONES - 1)] += duration;
+        }
+        if (cadence > 0) {
+            cadenceSeconds += cadence * duration;
+            cadenceTime += duration;
+        }
+    }
+    s.avgWatt = seconds > 0 ? wattSeconds / seconds : 0;
+    s.avgHeart = heartTime > 0 ? heartSeconds / heartTime : 0;
+    s.avgCadence = cadenceTime > 0 ? cadenceSeconds / cadenceTime : 0;
+    for (int k = 0; k < workoutsummary::PEAKS; k++)
+        s.peaks[k] = curve.best(workoutsummary::peakDurations[k]);
+    return s;
+}
@@ -0,0 +1,134 @@
+#ifndef WORKOUTHISTORY_H
+#define WORKOUTHISTORY_H
+
+#include "fitdecoder.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief What the history shows of a workout, computed once from the records of its FIT file.
+ */
+struct workoutsummary {
+    static const int PEAKS = 4;
+    static const int HEART_ZONES = 5;
+    // durations of peaks, in seconds
+    static const int peakDurations[PEAKS];
+
+    // relative to the directory of the history
+    QString fileName;
+    // of the file when it was summarized, ms since epoch
+    qint64 modified = 0;
+    qint64 size = 0;
+
+    // 0 if the file has no record
+    int records = 0;
+    qint64 startMs = 0;
+    // FIT_SPORT
+    quint8 sport = 0xFF;
+    // seconds, from the first record to the last one
+    double elapsed = 0;
+    double distance = 0;
+    double calories = 0;
+    double avgWatt = 0;
+    double maxWatt = 0;
+    double avgHeart = 0;
+    double maxHeart = 0;
+    double avgCadence = 0;
+    // best average power over peakDurations, -1 if the workout is shorter
+    double peaks[PEAKS] = {-1, -1, -1, -1};
+    // seconds spent in each heart rate zone
+    double heartZones[HEART_ZONES] = {0, 0, 0, 0, 0};
+};
+
+/**
+ * @brief Index of the FIT files saved in a directory (the writable app dir), for the history and summary screens.
+ * Every file is decoded once: its summary is kept in a cache file with the size and the modification time of the
+ * file, and refresh() only decodes the files that are new or changed since, in parallel on a thread pool. A history
+ * of thousands of workouts is then a single read of the cache. refresh() can run on a background thread while the GUI
+ * thread reads the summaries.
+ */
+class workouthistory : public QObject {
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The index of the *.fit files in directory, cached in cacheFile (by default in the cache directory).
+     */
+    explicit workouthistory(const QString &directory, const QString &cacheFile = QString(), QObject *parent = nullptr);
+    ~workouthistory() override;
+
+    /**
+     * @brief The upper bounds of the first 4 heart rate zones, in bpm, ascending. Changing them summarizes all the
+     * files again at the next refresh().
+     */
+    void setHeartRateZones(const QVector<double> &bounds);
+    /**
+     * @brief The zones bounds of homeform: percentages of the max heart rate.
+     */
+    static QVector<double> heartRateZones(double maxHeartRate, const QVector<double> &percentages);
+
+    void setMaxThreads(int threads) { maxThreads = threads; }
+
+    /**
+     * @brief Load the cache if not done yet, summarize the files new or changed, drop the ones deleted and save the
+     * cache if anything changed. A setHeartRateZones() meanwhile summarizes the files again with the new zones.
+     * @return the number of files decoded.
+     */
+    int refresh();
+    /**
+     * @brief refresh() on a thread of its own, refreshed() when done. If one is already running, it refreshes once
+     * more before refreshed().
+     */
+    void refreshInBackground();
+    bool isRefreshing() const { return background.loadAcquire() != 0; }
+
+    /**
+     * @brief The workouts with at least a record, the newest first.
+     */
+    QList<workoutsummary> workouts() const;
+    /**
+     * @brief The summary of the index for a file name of the directory; summary can be nullptr.
+     */
+    bool find(const QString &fileName, workoutsummary *summary) const;
+
+    /**
+     * @brief The summary of the records of a workout.
+     */
+    static workoutsummary summarize(const fitrecords &records, const QVector<double> &heartZoneBounds);
+
+    QString directory() const { return dir; }
+    QString cacheFileName() const { return cache; }
+
+  signals:
+    void refreshed(int decoded);
+
+  private:
+    bool loadCache();
+    bool saveCache() const;
+    // the summaries of the files of the directory with the zones bounds, decoding the ones not in known; count of the
+    // ones decoded
+    QHash<QString, workoutsummary> scan(const QVector<double> &bounds, const QHash<QString, workoutsummary> &known,
+                                        int *count) const;
+
+    QString dir;
+    QString cache;
+    QVector<double> zones;
+    int maxThreads = 0;
+    bool cacheLoaded = false;
+    QHash<QString, workoutsummary> summaries;
+    // summaries and zones, between refresh() and the readers
+    mutable QMutex mutex;
+    // one refresh() at a time
+    QMutex refreshMutex;
+    QAtomicInt background;
+    QThreadPool backgroundPool;
+};
+
+#endif // WORKOUTHISTORY_H
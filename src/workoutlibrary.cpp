@@ -0,0 +1,360 @@
+#include "workoutlibrary.h"
+#include "zwiftworkout.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QDirIterator>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QtMath>
+#include <algorithm>
+
+namespace {
+
+const quint32 CACHE_MAGIC = 0x4c575a51; // "QZWL"
+const quint32 CACHE_VERSION = 1;
+
+void writeSummary(QDataStream &out, const trainprogramsummary &s) {
+    out << s.fileName << s.modified << s.size << qint32(s.rows) << qint32(s.seconds) << s.distance << s.avgPower
+        << s.maxPower << s.normalizedPower << s.intensityFactor << s.tss << s.description << s.tags << s.byDistance
+        << s.power << s.inclination;
+}
+
+void readSummary(QDataStream &in, trainprogramsummary *s) {
+    qint32 rows, seconds;
+    in >> s->fileName >> s->modified >> s->size >> rows >> seconds >> s->distance >> s->avgPower >> s->maxPower >>
+        s->normalizedPower >> s->intensityFactor >> s->tss >> s->description >> s->tags >> s->byDistance >> s->power >>
+        s->inclination;
+    s->rows = rows;
+    s->seconds = seconds;
+}
+
+int rowSeconds(const trainrow &row) {
+    return qMax(0, (row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second());
+}
+
+// adds value over [from, to) to the profile buckets it overlaps, total being the length of the whole profile
+void accumulate(QVector<double> &sums, double from, double to, double total, double value) {
+    const int n = sums.count();
+    const double width = total / n;
+    for (int b = qMin(n - 1, (int)(from / width)); from < to && b < n; b++) {
+        const double end = b == n - 1 ? to : qMin(to, (b + 1) * width);
+        if (end > from)
+            sums[b] += value * (end - from);
+        from = qMax(from, end);
+    }
+}
+
+QVector<float> profile(const QVector<double> &sums, double total) {
+    QVector<float> points;
+    points.reserve(sums.count());
+    const double width = total / sums.count();
+    for (double sum : sums)
+        points.append((float)(sum / width));
+    return points;
+}
+
+// parses and summarizes one file on a thread of the pool, into a slot nobody else touches until waitForDone()
+class summaryTask : public QRunnable {
+  public:
+    summaryTask(const QString &path, double ftp, trainprogramsummary *summary)
+        : path(path), ftp(ftp), summary(summary) {}
+
+    void run() override {
+        trainprogramsummary s = workoutlibrary::summarizeFile(path, QFileInfo(path).suffix(), ftp);
+        if (!s.rows)
+            qDebug() << QStringLiteral("workoutlibrary: nothing in") << path;
+        s.fileName = summary->fileName;
+        s.modified = summary->modified;
+        s.size = summary->size;
+        *summary = s;
+    }
+
+  private:
+    QString path;
+    double ftp;
+    trainprogramsummary *summary;
+};
+
+class refreshTask : public QRunnable {
+  public:
+    refreshTask(workoutlibrary *library, QAtomicInt *running) : library(library), running(running) {}
+
+    void run() override {
+        const int parsed = library->refresh();
+        running->storeRelease(0);
+        emit library->refreshed(parsed);
+    }
+
+  private:
+    workoutlibrary *library;
+    QAtomicInt *running;
+};
+
+} // namespace
+
+workoutlibrary::workoutlibrary(const QString &directory, const QString &cacheFile, QObject *parent)
+    : QObject(parent), dir(directory), cache(cacheFile) {
+    if (cache.isEmpty()) {
+        const QByteArray key =
+            QCryptographicHash::hash(QDir(dir).absolutePath().toUtf8(), QCryptographicHash::Sha1).toHex();
+        cache = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/library/") +
+                QString::fromLatin1(key) + QStringLiteral(".qzlibrary");
+    }
+    backgroundPool.setMaxThreadCount(1);
+}
+
+workoutlibrary::~workoutlibrary() { backgroundPool.waitForDone(); }
+
+QStringList workoutlibrary::nameFilters() {
+    return QStringList() << QStringLiteral("*.xml") << QStringLiteral("*.zwo");
+}
+
+void workoutlibrary::setFtp(double ftp) {
+    QMutexLocker locker(&mutex);
+    if (ftp == m_ftp)
+        return;
+    m_ftp = ftp;
+    // the watts of the .zwo files and the intensity factors are of the old ftp
+    summaries.clear();
+}
+
+double workoutlibrary::ftp() const {
+    QMutexLocker locker(&mutex);
+    return m_ftp;
+}
+
+bool workoutlibrary::loadCache() {
+    QFile file(cache);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    in.setVersion(QDataStream::Qt_5_9);
+    quint32 magic, version;
+    double cachedFtp;
+    quint32 count;
+    in >> magic >> version;
+    if (in.status() != QDataStream::Ok || magic != CACHE_MAGIC || version != CACHE_VERSION)
+        return false;
+    in >> cachedFtp >> count;
+    if (in.status() != QDataStream::Ok || cachedFtp != ftp())
+        return false;
+
+    QHash<QString, trainprogramsummary> loaded;
+    loaded.reserve(qMin<quint32>(count, 65536));
+    for (quint32 i = 0; i < count; i++) {
+        trainprogramsummary s;
+        readSummary(in, &s);
+        if (in.status() != QDataStream::Ok)
+            return false;
+        loaded.insert(s.fileName, s);
+    }
+    QMutexLocker locker(&mutex);
+    if (cachedFtp != m_ftp)
+        return false;
+    summaries.swap(loaded);
+    return true;
+}
+
+bool workoutlibrary::saveCache() const {
+    QDir().mkpath(QFileInfo(cache).absolutePath());
+    QSaveFile file(cache);
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+    QDataStream out(&file);
+    out.setVersion(QDataStream::Qt_5_9);
+    {
+        QMutexLocker locker(&mutex);
+        out << CACHE_MAGIC << CACHE_VERSION << m_ftp << quint32(summaries.count());
+        for (const trainprogramsummary &s : summaries)
+            writeSummary(out, s);
+    }
+    if (out.status() != QDataStream::Ok) {
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
+
+int workoutlibrary::refresh() {
+    QMutexLocker refreshing(&refreshMutex);
+    if (!cacheLoaded) {
+        loadCache();
+        cacheLoaded = true;
+    }
+
+    int parsed = 0;
+    bool changed = !QFile::exists(cache);
+    for (;;) {
+        double ftp;
+        QHash<QString, trainprogramsummary> known;
+        {
+            QMutexLocker locker(&mutex);
+            ftp = m_ftp;
+            known = summaries;
+        }
+        int count = 0;
+        QHash<QString, trainprogramsummary> current = scan(ftp, known, &count);
+        parsed += count;
+        changed = changed || count > 0 || current.count() != known.count();
+
+        QMutexLocker locker(&mutex);
+        // setFtp() while parsing: these summaries are of the old ftp, again with the new one
+        if (ftp == m_ftp) {
+            summaries.swap(current);
+            break;
+        }
+    }
+    if (changed && !saveCache())
+        qDebug() << QStringLiteral("workoutlibrary: can't write") << cache;
+    return parsed;
+}
+
+QHash<QString, trainprogramsummary> workoutlibrary::scan(double ftp, const QHash<QString, trainprogramsummary> &known,
+                                                         int *count) const {
+    const QDir root(dir);
+    QHash<QString, trainprogramsummary> current;
+    QVector<trainprogramsummary> parsed;
+    QStringList paths;
+    QDirIterator it(dir, nameFilters(), QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        const QString fileName = root.relativeFilePath(info.absoluteFilePath());
+        const qint64 modified = info.lastModified().toMSecsSinceEpoch();
+        auto cached = known.constFind(fileName);
+        if (cached != known.constEnd() && cached->modified == modified && cached->size == info.size()) {
+            current.insert(fileName, *cached);
+            continue;
+        }
+        trainprogramsummary s;
+        s.fileName = fileName;
+        s.modified = modified;
+        s.size = info.size();
+        parsed.append(s);
+        paths.append(info.absoluteFilePath());
+    }
+
+    // the slots don't move while the tasks fill them
+    if (!parsed.isEmpty()) {
+        QThreadPool pool;
+        if (maxThreads > 0)
+            pool.setMaxThreadCount(maxThreads);
+        for (int i = 0; i < parsed.count(); i++)
+            pool.start(new summaryTask(paths.at(i), ftp, &parsed[i]));
+        pool.waitForDone();
+    }
+    for (const trainprogramsummary &s : qAsConst(parsed))
+        current.insert(s.fileName, s);
+    *count = parsed.count();
+    return current;
+}
+
+void workoutlibrary::refreshInBackground() {
+    if (!background.testAndSetOrdered(0, 1))
+        return;
+    backgroundPool.start(new refreshTask(this, &background));
+}
+
+QList<trainprogramsummary> workoutlibrary::workouts() const {
+    QList<trainprogramsummary> list;
+    {
+        QMutexLocker locker(&mutex);
+        list.reserve(summaries.count());
+        for (const trainprogramsummary &s : summaries) {
+            if (s.rows)
+                list.append(s);
+        }
+    }
+    std::sort(list.begin(), list.end(), [](const trainprogramsummary &a, const trainprogramsummary &b) {
+        return a.fileName < b.fileName;
+    });
+    return list;
+}
+
+bool workoutlibrary::find(const QString &fileName, trainprogramsummary *summary) const {
+    QMutexLocker locker(&mutex);
+    auto it = summaries.constFind(fileName);
+    if (it == summaries.constEnd())
+        return false;
+    if (summary)
+        *summary = it.value();
+    return true;
+}
+
+trainprogramsummary workoutlibrary::summary(const QString &path, const QString &extension) const {
+    const QFileInfo info(path);
+    const QString fileName = QDir(dir).relativeFilePath(info.absoluteFilePath());
+    trainprogramsummary s;
+    if (find(fileName, &s) && s.modified == info.lastModified().toMSecsSinceEpoch() && s.size == info.size())
+        return s;
+
+    s = summarizeFile(path, extension.isEmpty() ? info.suffix() : extension, ftp());
+    s.fileName = fileName.startsWith(QStringLiteral("..")) ? info.fileName() : fileName;
+    s.modified = info.lastModified().toMSecsSinceEpoch();
+    s.size = info.size();
+    return s;
+}
+
+trainprogramsummary workoutlibrary::summarize(const QList<trainrow> &rows, double ftp) {
+    trainprogramsummary s;
+    s.rows = rows.count();
+    double distance = 0;
+    for (const trainrow &row : rows) {
+        s.seconds += rowSeconds(row);
+        if (row.distance > 0)
+            distance += row.distance;
+        s.maxPower = qMax(s.maxPower, (double)row.power);
+    }
+    s.distance = distance;
+    // the rows of a program by distance have no duration
+    s.byDistance = s.seconds == 0 && distance > 0;
+    const double total = s.byDistance ? distance : s.seconds;
+    if (total <= 0)
+        return s;
+
+    QVector<double> watts(trainprogramsummary::PROFILE_POINTS, 0);
+    QVector<double> grades(trainprogramsummary::PROFILE_POINTS, 0);
+    double position = 0, wattSum = 0, watt4Sum = 0;
+    for (const trainrow &row : rows) {
+        const double length = s.byDistance ? qMax(0.0, row.distance) : rowSeconds(row);
+        if (length <= 0)
+            continue;
+        // -1: no power target, -200: no inclination
+        const double watt = qMax(0, row.power);
+        const double grade = row.inclination > -200 ? row.inclination : 0;
+        accumulate(watts, position, position + length, total, watt);
+        accumulate(grades, position, position + length, total, grade);
+        wattSum += watt * length;
+        watt4Sum += qPow(watt, 4) * length;
+        position += length;
+    }
+    s.power = profile(watts, total);
+    s.inclination = profile(grades, total);
+    s.avgPower = wattSum / total;
+    s.normalizedPower = qPow(watt4Sum / total, 0.25);
+    if (ftp > 0 && s.normalizedPower > 0) {
+        s.intensityFactor = s.normalizedPower / ftp;
+        s.tss = s.seconds / 3600.0 * s.intensityFactor * s.intensityFactor * 100.0;
+    }
+    return s;
+}
+
+trainprogramsummary workoutlibrary::summarizeFile(const QString &path, const QString &extension, double ftp) {
+    const QString ext = extension.toUpper();
+    if (ext == QStringLiteral("ZWO")) {
+        QString description, tags;
+        const QList<trainrow> rows = zwiftworkout::load(path, &description, &tags);
+        trainprogramsummary s = summarize(rows, ftp);
+        s.description = description;
+        s.tags = tags;
+        return s;
+    }
+    return summarize(trainprogram::loadXML(path), ftp);
+}
@@ -0,0 +1,142 @@
+#ifndef WORKOUTLIBRARY_H
+#define WORKOUTLIBRARY_H
+
+#include "trainprogram.h"
+
+#include <QAtomicInt>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+#include <QThreadPool>
+#include <QVector>
+
+/**
+ * @brief What the training program picker shows of a workout, computed once from its rows.
+ */
+struct trainprogramsummary {
+    // points of the profiles, whatever the length of the workout
+    static const int PROFILE_POINTS = 200;
+
+    // relative to the directory of the library
+    QString fileName;
+    // of the file when it was summarized, ms since epoch
+    qint64 modified = 0;
+    qint64 size = 0;
+
+    // 0 if the file can't be read
+    int rows = 0;
+    // of the rows with a duration
+    int seconds = 0;
+    // km
+    double distance = 0;
+    double avgPower = 0;
+    double maxPower = 0;
+    // estimated from the targets: the fourth power mean of the rows, which are steps
+    double normalizedPower = 0;
+    // 0 without a power target or an ftp
+    double intensityFactor = 0;
+    double tss = 0;
+    QString description;
+    QString tags;
+    // the profiles split the distance instead of the duration: programs by distance
+    bool byDistance = false;
+    // averages over PROFILE_POINTS equal parts of the workout, empty without rows
+    QVector<float> power;
+    QVector<float> inclination;
+};
+
+/**
+ * @brief Index of the training programs (*.xml, *.zwo) of a directory and of its subdirectories, for the training
+ * program picker. Every file is parsed once: its summary is kept in a cache file with the size and the modification
+ * time of the file, and refresh() only parses the files that are new or changed since, in parallel on a thread pool. A pack of hundreds of workouts is then listed and previewed from a single read
+ * of the cache. The summaries are in watts of the ftp the library has: changing it summarizes the files again.
+ * refresh() can run on a background thread while the GUI thread reads the summaries.
+ */
+class workoutlibrary : public QObject {
+    Q_OBJECT
+
+  public:
+    /**
+     * @brief The index of the files in directory, cached in cacheFile (by default in the cache directory).
+     */
+    explicit workoutlibrary(const QString &directory, const QString &cacheFile = QString(), QObject *parent = nullptr);
+    ~workoutlibrary() override;
+
+    static QStringList nameFilters();
+
+    /**
+     * @brief The ftp of the power targets of the .zwo files (QZSettings::ftp when they're parsed) and of the
+     * intensity factor.
+     */
+    void setFtp(double ftp);
+    double ftp() const;
+
+    void setMaxThreads(int threads) { maxThreads = threads; }
+
+    /**
+     * @brief Load the cache if not done yet, summarize the files new or changed, drop the ones deleted and save the
+     * cache if anything changed. A setFtp() meanwhile summarizes the files again with the new ftp.
+     * @return the number of files parsed.
+     */
+    int refresh();
+    /**
+     * @brief refresh() on a thread of its own, refreshed() when done; nothing if one is already running.
+     */
+    void refreshInBackground();
+    bool isRefreshing() const { return background.loadAcquire() != 0; }
+
+    /**
+     * @brief The workouts with at least a row, by file name.
+     */
+    QList<trainprogramsummary> workouts() const;
+    /**
+     * @brief The summary of the index for a file name relative to the directory; summary can be nullptr.
+     */
+    bool find(const QString &fileName, trainprogramsummary *summary) const;
+
+    /**
+     * @brief The summary of a file, from the index when it's still the one of the file, parsed otherwise (a file
+     * outside of the directory too). extension is the one of the file name if empty.
+     */
+    trainprogramsummary summary(const QString &path, const QString &extension = QString()) const;
+
+    /**
+     * @brief The summary of the rows of a program.
+     */
+    static trainprogramsummary summarize(const QList<trainrow> &rows, double ftp);
+    /**
+     * @brief Parses and summarizes a file, by its extension.
+     */
+    static trainprogramsummary summarizeFile(const QString &path, const QString &extension, double ftp);
+
+    QString directory() const { return dir; }
+    QString cacheFileName() const { return cache; }
+
+  signals:
+    void refreshed(int parsed);
+
+  private:
+    bool loadCache();
+    bool saveCache() const;
+    // the summaries of the files in the directory at ftp, parsing the ones not in known; count of the ones parsed
+    QHash<QString, trainprogramsummary> scan(double ftp, const QHash<QString, trainprogramsummary> &known,
+                                             int *count) const;
+
+    QString dir;
+    QString cache;
+    double m_ftp = 0;
+    int maxThreads = 0;
+    bool cacheLoaded = false;
+    QHash<QString, trainprogramsummary> summaries;
+    // summaries and m_ftp, between refresh() and the readers
+    mutable QMutex mutex;
+    // one refresh() at a time
+    QMutex refreshMutex;
+    QAtomicInt background;
+    QThreadPool backgroundPool;
+};
+
+#endif // WORKOUTLIBRARY_H
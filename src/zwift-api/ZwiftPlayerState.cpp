@@ -0,0 +1,162 @@
+#include "ZwiftPlayerState.h"
+
+#include <cstring>
+
+namespace {
+
+enum WireType { VARINT = 0, FIXED64 = 1, LENGTH_DELIMITED = 2, FIXED32 = 5 };
+
+bool readVarint(const unsigned char *&p, const unsigned char *end, quint64 *value) {
+    quint64 v = 0;
+    // 10 bytes at most for 64 bits
+    for (int shift = 0; shift < 70 && p < end; shift += 7) {
+        const unsigned char b = *p++;
+        v |= (quint64)(b & 0x7F) << shift;
+        if (!(b & 0x80)) {
+            *value = v;
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+bool ZwiftPlayerState::decode(const char *data, int size) {
+    *this = ZwiftPlayerState();
+    const unsigned char *p = (const unsigned char *)data;
+    const unsigned char *end = p + size;
+    while (p < end) {
+        quint64 key;
+        if (!readVarint(p, end, &key))
+            return false;
+        const int field = (int)(key >> 3);
+        const int wire = (int)(key & 7);
+
+        quint64 v = 0;
+        quint32 f = 0;
+        switch (wire) {
+        case VARINT:
+            if (!readVarint(p, end, &v))
+                return false;
+            break;
+        case FIXED64:
+            if (end - p < 8)
+                return false;
+            p += 8;
+            continue;
+        case LENGTH_DELIMITED:
+            if (!readVarint(p, end, &v) || v > (quint64)(end - p))
+                return false;
+            p += v;
+            continue;
+        case FIXED32:
+            if (end - p < 4)
+                return false;
+            // little endian on the wire
+            f = (quint32)p[0] | ((quint32)p[1] << 8) | ((quint32)p[2] << 16) | ((quint32)p[3] << 24);
+            p += 4;
+            break;
+        default:
+            // the groups are not in the message
+            return false;
+        }
+
+        // an int32 is sign extended to 64 bits on the wire, truncating gives it back
+        const qint32 i32 = (qint32)(quint32)v;
+        const qint64 i64 = (qint64)v;
+        float fl;
+        memcpy(&fl, &f, sizeof(fl));
+        if (wire == FIXED32) {
+            switch (field) {
+            case 25:
+                x = fl;
+                break;
+            case 26:
+                altitude = fl;
+                break;
+            case 27:
+                y = fl;
+                break;
+            default:
+                break;
+            }
+            continue;
+        }
+
+        switch (field) {
+        case 1:
+            id = i32;
+            break;
+        case 2:
+            worldTime = i64;
+            break;
+        case 3:
+            distance = i32;
+            break;
+        case 4:
+            roadTime = i32;
+            break;
+        case 5:
+            laps = i32;
+            break;
+        case 6:
+            speed = i32;
+            break;
+        case 8:
+            roadPosition = i32;
+            break;
+        case 9:
+            cadenceUHz = i32;
+            break;
+        case 11:
+            heartrate = i32;
+            break;
+        case 12:
+            power = i32;
+            break;
+        case 13:
+            heading = i64;
+            break;
+        case 14:
+            lean = i32;
+            break;
+        case 15:
+            climbing = i32;
+            break;
+        case 16:
+            time = i32;
+            break;
+        case 19:
+            f19 = i32;
+            break;
+        case 20:
+            f20 = i32;
+            break;
+        case 21:
+            progress = i32;
+            break;
+        case 22:
+            customisationId = i64;
+            break;
+        case 23:
+            justWatching = i32;
+            break;
+        case 24:
+            calories = i32;
+            break;
+        case 28:
+            watchingRiderId = i32;
+            break;
+        case 29:
+            groupId = i32;
+            break;
+        case 31:
+            sport = i64;
+            break;
+        default:
+            break;
+        }
+    }
+    return true;
+}
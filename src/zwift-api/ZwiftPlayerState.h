@@ -0,0 +1,47 @@
+#ifndef ZWIFTPLAYERSTATE_H
+#define ZWIFTPLAYERSTATE_H
+
+#include <QtGlobal>
+
+/**
+ * @brief The PlayerState message of zwift_messages.proto, decoded straight from the protobuf wire format without
+ * the protobuf runtime. Plain values only, so it can be published as is in a seqlock.
+ */
+struct ZwiftPlayerState {
+    qint32 id = 0;
+    qint64 worldTime = 0;
+    qint32 distance = 0;
+    qint32 roadTime = 0;
+    qint32 laps = 0;
+    qint32 speed = 0;
+    qint32 roadPosition = 0;
+    qint32 cadenceUHz = 0;
+    qint32 heartrate = 0;
+    qint32 power = 0;
+    qint64 heading = 0;
+    qint32 lean = 0;
+    qint32 climbing = 0;
+    qint32 time = 0;
+    qint32 f19 = 0;
+    qint32 f20 = 0;
+    qint32 progress = 0;
+    qint64 customisationId = 0;
+    qint32 justWatching = 0;
+    qint32 calories = 0;
+    float x = 0;
+    float altitude = 0;
+    float y = 0;
+    qint32 watchingRiderId = 0;
+    qint32 groupId = 0;
+    qint64 sport = 0;
+
+    /**
+     * @brief Decodes a PlayerState, the fields missing are 0 and the unknown ones skipped. False when the message is
+     * truncated or malformed.
+     */
+    bool decode(const char *data, int size);
+
+    int cadence() const { return (int)(((qint64)cadenceUHz * 60) / 1000000); }
+};
+
+#endif // ZWIFTPLAYERSTATE_H
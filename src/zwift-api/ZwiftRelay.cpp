@@ -0,0 +1,96 @@
+#include "ZwiftRelay.h"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSharedPointer>
+#include <QUrl>
+
+ZwiftRelay::ZwiftRelay(int worldId, QObject *parent) : QObject(parent), worldId(worldId) {
+    emptyVersion = mailbox.version();
+}
+
+QNetworkReply *ZwiftRelay::get(const QString &path, const QByteArray &accept) {
+    const QUrl url(baseUrl + path);
+    if (!connected) {
+        // the handshake now, not with the first poll
+        connected = true;
+        if (url.scheme() == QStringLiteral("https"))
+            manager.connectToHostEncrypted(url.host(), url.port(443));
+        else
+            manager.connectToHost(url.host(), url.port(80));
+    }
+
+    QNetworkRequest request(url);
+    request.setRawHeader("Accept", accept);
+    request.setRawHeader("Authorization", "Bearer " + accessToken.toUtf8());
+    request.setRawHeader("Connection", "keep-alive");
+    request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+    return manager.get(request);
+}
+
+void ZwiftRelay::requestPlayer() {
+    if (playerRequested || hasPlayer())
+        return;
+    playerRequested = true;
+
+    QNetworkReply *reply = get(QStringLiteral("/api/profiles/me"), "application/json");
+    connect(reply, &QNetworkReply::finished, this, [this, reply]() {
+        reply->deleteLater();
+        playerRequested = false;
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << "zwift relay profile error" << reply->errorString();
+            emit loginState(false);
+            return;
+        }
+        const QJsonObject profile = QJsonDocument::fromJson(reply->readAll()).object();
+        qDebug() << "zwift api player" << profile[QStringLiteral("id")];
+        playerId = profile[QStringLiteral("id")].toInt(-1);
+        emit loginState(hasPlayer());
+    });
+}
+
+bool ZwiftRelay::poll() {
+    if (!hasPlayer() || inFlightCount >= maxInFlight)
+        return false;
+    inFlightCount++;
+
+    QSharedPointer<QElapsedTimer> clock(new QElapsedTimer);
+    clock->start();
+    QNetworkReply *reply = get(QStringLiteral("/relay/worlds/") + QString::number(worldId) +
+                                   QStringLiteral("/players/") + QString::number(playerId),
+                               "application/x-protobuf-lite");
+    connect(reply, &QNetworkReply::finished, this, [this, reply, clock]() {
+        reply->deleteLater();
+        inFlightCount--;
+        lastLatencyMs = clock->elapsed();
+        if (reply->error() != QNetworkReply::NoError) {
+            qDebug() << "zwift relay error" << reply->errorString();
+            return;
+        }
+        const QByteArray buffer = reply->readAll();
+        ZwiftPlayerState state;
+        if (!state.decode(buffer.constData(), buffer.size())) {
+            qDebug() << "zwift relay: not a player state" << buffer.toHex(' ');
+            return;
+        }
+        // an answer overtaken by a newer one
+        if (state.worldTime < lastWorldTime)
+            return;
+        lastWorldTime = state.worldTime;
+        mailbox.store(state);
+        emit playerStateReceived();
+    });
+    return true;
+}
+
+bool ZwiftRelay::latest(ZwiftPlayerState *state, quint32 *version) const {
+    const quint32 v = mailbox.version();
+    if (v == emptyVersion || v == *version)
+        return false;
+    *state = mailbox.load();
+    // a store between the two reads: the next call sees it again, not a problem
+    *version = v;
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef ZWIFTRELAY_H
+#define ZWIFTRELAY_H
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QObject>
+#include <QString>
+
+#include "seqlock.h"
+#include "zwift-api/ZwiftPlayerState.h"
+
+/**
+ * @brief Asynchronous client of the Zwift relay: nothing waits for the network. The requests go on one kept alive,
+ * pipelined connection, and the last PlayerState received is left in a mailbox the scheduler reads at its own pace,
+ * whatever the time the relay takes to answer.
+ */
+class ZwiftRelay : public QObject {
+    Q_OBJECT
+
+  public:
+    explicit ZwiftRelay(int worldId = 1, QObject *parent = nullptr);
+
+    /**
+     * @brief The relay, e.g. a local one for the tests.
+     */
+    void setBaseUrl(const QString &url) { baseUrl = url; }
+    void setAccessToken(const QString &token) { accessToken = token; }
+    /**
+     * @brief The player states asked and not answered yet beyond which a poll is dropped: a slow relay doesn't pile
+     * up requests.
+     */
+    void setMaxInFlight(int max) { maxInFlight = max; }
+
+    /**
+     * @brief Asks the profile of the user for the player id, once: loginState() tells when it's known.
+     */
+    void requestPlayer();
+    bool hasPlayer() const { return playerId != -1; }
+    int player() const { return playerId; }
+
+    /**
+     * @brief Asks the state of the player, returns at once: the answer goes in the mailbox. False when dropped.
+     */
+    bool poll();
+    int inFlight() const { return inFlightCount; }
+
+    /**
+     * @brief The last state received, only if it's newer than the one of version, updated. Never waits.
+     */
+    bool latest(ZwiftPlayerState *state, quint32 *version) const;
+    /**
+     * @brief The time between the last state asked and its answer.
+     */
+    qint64 latencyMs() const { return lastLatencyMs; }
+
+  signals:
+    void loginState(bool ok);
+    void playerStateReceived();
+
+  private:
+    QNetworkAccessManager manager;
+    QString baseUrl = QStringLiteral("https://us-or-rly101.zwift.com");
+    QString accessToken;
+    int worldId;
+    int playerId = -1;
+    bool playerRequested = false;
+    bool connected = false;
+    int inFlightCount = 0;
+    int maxInFlight = 2;
+    qint64 lastWorldTime = -1;
+    qint64 lastLatencyMs = -1;
+    seqlock<ZwiftPlayerState> mailbox;
+    // the version of the mailbox before the first state
+    quint32 emptyVersion = 0;
+
+    QNetworkReply *get(const QString &path, const QByteArray &accept);
+};
+
+#endif // ZWIFTRELAY_H
@@ -0,0 +1,168 @@
+#include "bluetoothdevicematchertestsuite.h"
+#include "bluetoothdevicematcher.h"
+#include "devices/yesoulbike/yesoulbike.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QRegularExpression>
+#include <QSet>
+
+static const QBluetoothUuid matcherTestUuid{QStringLiteral("b8f79bac-32e5-11ed-a261-0242ac120002")};
+
+static QStringList unrelatedNames() {
+    return QStringList() << QStringLiteral("iPhone") << QStringLiteral("Galaxy Buds2 (4F2A)")
+                         << QStringLiteral("Apple Watch") << QStringLiteral("JBL Flip 5") << QStringLiteral("Mi Band 6")
+                         << QStringLiteral("[TV] Samsung Q60") << QStringLiteral("Polar H10 8A1B2C3D")
+                         << QStringLiteral("Fenix 7") << QStringLiteral("LE-Bose QC35") << QStringLiteral("")
+                         << QStringLiteral("Pixel 7") << QStringLiteral("WH-1000XM4") << QStringLiteral("GoPro 1234")
+                         << QStringLiteral("Tile") << QStringLiteral("OnePlus Buds") << QStringLiteral("Kindle");
+}
+
+template <typename T>
+static void appendNames(QStringList &names) {
+    T testData;
+    names << testData.get_deviceNames() << testData.get_failingDeviceNames();
+}
+
+template <typename... Ts>
+static QStringList corpus(testing::Types<Ts...> *) {
+    QStringList names;
+    // expands to one appendNames<T>() call per test data type, in order
+    int expand[] = {0, (appendNames<Ts>(names), 0)...};
+    Q_UNUSED(expand)
+    return names;
+}
+
+// the shape of the previous discovery chain: every rule compared in turn, on an upper case copy of the name
+static int linearMatch(const QString &name) {
+    const QVector<bluetoothdevicematcher::rule> &rules = bluetoothdevicematcher::rules();
+    for (int i = 0; i < rules.count(); i++) {
+        const QString pattern = QString::fromLatin1(rules.at(i).name);
+        bool matched = false;
+        switch (rules.at(i).cmp) {
+        case bluetoothdevicematcher::StartsWith:
+            matched = name.startsWith(pattern);
+            break;
+        case bluetoothdevicematcher::StartsWithIgnoreCase:
+            matched = name.toUpper().startsWith(pattern.toUpper());
+            break;
+        case bluetoothdevicematcher::ExactIgnoreCase:
+            matched = !name.toUpper().compare(pattern.toUpper());
+            break;
+        case bluetoothdevicematcher::ContainsIgnoreCase:
+            matched = name.toUpper().contains(pattern.toUpper());
+            break;
+        }
+        if (matched)
+            return i;
+    }
+    return -1;
+}
+
+template <typename T>
+void BluetoothDeviceMatcherTestSuite<T>::SetUp() {
+    if (this->typeParam.get_isAbstract())
+        GTEST_SKIP() << "Device is abstract: " << this->typeParam.get_testName();
+    this->testSettings.activate();
+}
+
+template <typename T>
+void BluetoothDeviceMatcherTestSuite<T>::test_validNamesAreCandidates() {
+    BluetoothDeviceTestData &testData = this->typeParam;
+
+    DeviceDiscoveryInfo defaultDiscoveryInfo(true);
+    std::vector<DeviceDiscoveryInfo> configurations = testData.get_configurations(defaultDiscoveryInfo, true);
+    if (configurations.size() == 0)
+        configurations.push_back(defaultDiscoveryInfo);
+
+    for (const DeviceDiscoveryInfo &discoveryInfo : configurations) {
+        this->testSettings.loadFrom(discoveryInfo);
+        const bluetoothdevicematcher::settingsRules rules =
+            bluetoothdevicematcher::settingsRules::fromSettings(this->testSettings.qsettings);
+        for (const QString &deviceName : testData.get_deviceNames()) {
+            const QBluetoothDeviceInfo deviceInfo = testData.get_bluetoothDeviceInfo(matcherTestUuid, deviceName);
+            EXPECT_TRUE(bluetoothdevicematcher::isCandidate(deviceInfo, rules))
+                << "Name rejected by the matcher for " << testData.get_testName() << ": "
+                << deviceName.toStdString();
+        }
+    }
+}
+
+void BluetoothDeviceMatcherBenchmark::test_unrelatedNamesRejected() {
+    const bluetoothdevicematcher::settingsRules rules;
+    for (const QString &name : unrelatedNames()) {
+        EXPECT_FALSE(bluetoothdevicematcher::isCandidate(name, rules)) << name.toStdString();
+        EXPECT_EQ(-1, linearMatch(name)) << name.toStdString();
+    }
+    // settings driven rules
+    bluetoothdevicematcher::settingsRules configured;
+    configured.prefixes << QStringLiteral("Wahoo CADENCE");
+    configured.namesIgnoreCase << QStringLiteral("My Bike");
+    EXPECT_TRUE(bluetoothdevicematcher::isCandidate(QStringLiteral("Wahoo CADENCE 1A2B"), configured));
+    EXPECT_FALSE(bluetoothdevicematcher::isCandidate(QStringLiteral("WAHOO CADENCE 1A2B"), configured));
+    EXPECT_TRUE(bluetoothdevicematcher::isCandidate(QStringLiteral("my bike"), configured));
+    EXPECT_FALSE(bluetoothdevicematcher::isCandidate(QStringLiteral("my bike 2"), configured));
+    configured.anyDevice = true;
+    EXPECT_TRUE(bluetoothdevicematcher::isCandidate(QStringLiteral("iPhone"), configured));
+}
+
+void BluetoothDeviceMatcherBenchmark::test_rulesMatchChain() {
+    QFile source(QStringLiteral(QZ_SOURCE_DIR "/devices/bluetooth.cpp"));
+    ASSERT_TRUE(source.open(QIODevice::ReadOnly | QIODevice::Text)) << source.fileName().toStdString();
+    const QString text = QString::fromUtf8(source.readAll());
+    const int begin = text.indexOf(QStringLiteral("void bluetooth::deviceDiscovered("));
+    const int end = text.indexOf(QStringLiteral("void bluetooth::connectedAndDiscovered("));
+    ASSERT_GE(begin, 0);
+    ASSERT_GT(end, begin);
+    const QString chain = text.mid(begin, end - begin);
+
+    // the names compared to the device name, negative conditions included: they're refinements of a listed name
+    static const QRegularExpression comparison(
+        QStringLiteral("b\\.name\\(\\)(?:\\.toUpper\\(\\))?\\.(?:startsWith|contains|compare)\\(\\s*"
+                       "(?:QStringLiteral\\(|QLatin1String\\()?\\s*\"([^\"]*)\""));
+    QSet<QString> names;
+    QRegularExpressionMatchIterator it = comparison.globalMatch(chain);
+    while (it.hasNext())
+        names.insert(it.next().captured(1));
+    if (chain.contains(QStringLiteral("b.name().startsWith(yesoulbike::bluetoothName)")))
+        names.insert(QString::fromLatin1(yesoulbike::bluetoothName));
+    ASSERT_GT(names.count(), 100);
+
+    for (const QString &name : names)
+        EXPECT_GE(bluetoothdevicematcher::match(name), 0) << "Name of the chain missing from rules(): "
+                                                          << name.toStdString();
+    for (const bluetoothdevicematcher::rule &rule : bluetoothdevicematcher::rules())
+        EXPECT_TRUE(names.contains(QString::fromLatin1(rule.name)))
+            << "Rule not in the chain: " << rule.name;
+}
+
+void BluetoothDeviceMatcherBenchmark::test_benchmark() {
+    QStringList names = corpus(static_cast<BluetoothDeviceTestDataTypes *>(nullptr));
+    names << unrelatedNames();
+    ASSERT_GT(names.count(), 100);
+
+    // same answer (match or not) as the linear scan for every name
+    for (const QString &name : names)
+        EXPECT_EQ(linearMatch(name) >= 0, bluetoothdevicematcher::match(name) >= 0) << name.toStdString();
+
+    const int rounds = 20;
+    QElapsedTimer timer;
+    int found = 0;
+    timer.start();
+    for (int r = 0; r < rounds; r++)
+        for (const QString &name : names)
+            found += linearMatch(name) >= 0;
+    const qint64 linearNs = timer.nsecsElapsed();
+
+    timer.restart();
+    for (int r = 0; r < rounds; r++)
+        for (const QString &name : names)
+            found -= bluetoothdevicematcher::match(name) >= 0;
+    const qint64 indexedNs = timer.nsecsElapsed();
+    EXPECT_EQ(0, found);
+
+    const qint64 lookups = (qint64)rounds * names.count();
+    RecordProperty("names", names.count());
+    RecordProperty("linear_ns_per_name", (int)(linearNs / lookups));
+    RecordProperty("indexed_ns_per_name", (int)(indexedNs / lookups));
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+#include "gtest/gtest.h"
+#include "devices.h"
+
+#include "Tools/testsettings.h"
+
+/**
+ * @brief Checks bluetoothdevicematcher against the names of the BluetoothDeviceTestData corpora: the matcher must
+ * accept every name the discovery chain recognises, otherwise the device would never be connected.
+ */
+template <typename T>
+class BluetoothDeviceMatcherTestSuite : public testing::Test {
+
+protected:
+    T typeParam;
+
+    /**
+     * @brief Manages the QSettings used during the tests, separate from QSettings stored in the system generally.
+     */
+    TestSettings testSettings;
+
+public:
+    BluetoothDeviceMatcherTestSuite() : testSettings("Roberto Viola", "QDomyos-Zwift Testing") {}
+
+    // Sets up the test fixture.
+    void SetUp() override;
+
+    /**
+     * @brief Test that every valid name is a candidate, in every configuration enabling the device.
+     */
+    void test_validNamesAreCandidates();
+};
+
+TYPED_TEST_SUITE(BluetoothDeviceMatcherTestSuite, BluetoothDeviceTestDataTypes);
+
+TYPED_TEST(BluetoothDeviceMatcherTestSuite, TestValidNamesAreCandidates) {
+    this->test_validNamesAreCandidates();
+}
+
+class BluetoothDeviceMatcherBenchmark : public testing::Test {
+public:
+    /**
+     * @brief Test that names of other bluetooth devices (phones, headphones, watches) are rejected.
+     */
+    void test_unrelatedNamesRejected();
+
+    /**
+     * @brief Test that rules() and the discovery chain of bluetooth.cpp agree: every name the chain compares the
+     * device name to is matched, and every rule is a name of the chain.
+     */
+    void test_rulesMatchChain();
+
+    /**
+     * @brief Time the matcher against a linear scan of the rules, the shape of the previous discovery chain, over
+     * the names of every BluetoothDeviceTestData plus unrelated names. Both must agree. The times per name go to
+     * the XML report.
+     */
+    void test_benchmark();
+};
+
+TEST_F(BluetoothDeviceMatcherBenchmark, TestUnrelatedNamesRejected) {
+    this->test_unrelatedNamesRejected();
+}
+
+TEST_F(BluetoothDeviceMatcherBenchmark, TestRulesMatchChain) {
+    this->test_rulesMatchChain();
+}
+
+TEST_F(BluetoothDeviceMatcherBenchmark, TestBenchmark) {
+    this->test_benchmark();
+}
@@ -0,0 +1,196 @@
+#include "computrainertestsuite.h"
+
+#include <QElapsedTimer>
+#include <QThread>
+#include <atomic>
+#include <functional>
+#include <string>
+#include <thread>
+#include "Tools/computraineremulator.h"
+#include "latencyhistogram.h"
+#include "seqlock.h"
+
+namespace {
+
+struct sample {
+    qint64 sequence;
+    qint64 negated;
+    double values[6];
+};
+
+bool waitFor(const std::function<bool()> &condition, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs)
+            return false;
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+double power(Computrainer &ct) {
+    double power, heartRate, cadence, speed, RRC;
+    bool calibration;
+    int buttons, status;
+    uint8_t ss[24];
+    ct.getTelemetry(power, heartRate, cadence, speed, RRC, calibration, buttons, ss, status);
+    return power;
+}
+
+} // namespace
+
+ComputrainerTestSuite::ComputrainerTestSuite()
+{
+
+}
+
+void ComputrainerTestSuite::test_seqlock() {
+    seqlock<sample> shared;
+    EXPECT_EQ(0, shared.load().sequence);
+
+    const qint64 updates = 200000;
+    std::atomic<bool> done(false);
+    std::thread writer([&]() {
+        for (qint64 i = 1; i <= updates; i++) {
+            sample s;
+            s.sequence = i;
+            s.negated = -i;
+            for (int k = 0; k < 6; k++)
+                s.values[k] = i * k;
+            shared.store(s);
+        }
+        done = true;
+    });
+
+    int torn = 0, reads = 0;
+    qint64 last = 0;
+    bool ordered = true;
+    while (!done) {
+        const sample s = shared.load();
+        reads++;
+        bool whole = s.negated == -s.sequence;
+        for (int k = 0; k < 6; k++)
+            whole = whole && s.values[k] == s.sequence * k;
+        if (!whole)
+            torn++;
+        if (s.sequence < last)
+            ordered = false;
+        last = s.sequence;
+    }
+    writer.join();
+
+    EXPECT_GT(reads, 0);
+    EXPECT_EQ(0, torn);
+    EXPECT_TRUE(ordered);
+    EXPECT_EQ(updates, shared.load().sequence);
+}
+
+void ComputrainerTestSuite::test_histogram() {
+    // every latency is in the bucket of its bounds, the buckets are contiguous
+    for (qint64 us = 0; us < 1000000; us += 1 + us / 100) {
+        const int b = latencyhistogram::bucket(us);
+        EXPECT_LE(latencyhistogram::lowerBound(b), us);
+        EXPECT_GT(latencyhistogram::lowerBound(b + 1), us);
+    }
+    for (int b = 0; b < latencyhistogram::BUCKETS - 1; b++)
+        EXPECT_EQ(b, latencyhistogram::bucket(latencyhistogram::lowerBound(b)));
+
+    latencyhistogram h;
+    EXPECT_EQ(0, h.percentile(50));
+    for (int ms = 1; ms <= 1000; ms++)
+        h.record(ms * 1000);
+    EXPECT_EQ(1000u, h.count());
+    EXPECT_EQ(1000000, h.max());
+    EXPECT_DOUBLE_EQ(500500, h.mean());
+    // the upper bound of the bucket, within 25%
+    EXPECT_GE(h.percentile(50), 500000);
+    EXPECT_LE(h.percentile(50), 625000);
+    EXPECT_GE(h.percentile(99), 990000);
+    EXPECT_LE(h.percentile(99), 1000000);
+    EXPECT_EQ(1000000, h.percentile(100));
+
+    h.reset();
+    EXPECT_EQ(0u, h.count());
+}
+
+void ComputrainerTestSuite::test_emulator() {
+#ifdef CT_POLL
+    ComputrainerEmulator emulator;
+    ASSERT_TRUE(emulator.open());
+    emulator.setMessageInterval(5000);
+
+    Computrainer ct(nullptr, emulator.deviceName());
+    EXPECT_TRUE(ct.discover(emulator.deviceName()));
+    EXPECT_TRUE(emulator.greeted());
+
+    ct.setMode(CT_ERGOMODE, 150);
+    ct.start();
+    EXPECT_TRUE(waitFor([&]() { return power(ct) == 150; }, 3000));
+    EXPECT_EQ(150, emulator.load());
+    EXPECT_TRUE(waitFor([&]() { return ct.isHRConnected() && ct.isCADConnected(); }, 3000));
+
+    double watts, heartRate, cadence, speed, RRC;
+    bool calibration;
+    int buttons, status;
+    uint8_t ss[24];
+    EXPECT_TRUE(waitFor(
+        [&]() {
+            ct.getTelemetry(watts, heartRate, cadence, speed, RRC, calibration, buttons, ss, status);
+            return cadence == 90 && heartRate == 120 && speed > 0;
+        },
+        3000));
+    EXPECT_NEAR(30, speed, 0.1);
+    EXPECT_EQ(CT_RUNNING, status);
+
+    // a new load is sent at once and its latency measured
+    ct.setLoad(250);
+    EXPECT_TRUE(waitFor([&]() { return power(ct) == 250; }, 3000));
+    EXPECT_EQ(250, emulator.load());
+    EXPECT_TRUE(waitFor([&]() { return ct.loadLatency().count() == 1; }, 1000));
+
+    ct.setMode(CT_SSMODE);
+    ct.setGradient(-3.5);
+    EXPECT_TRUE(waitFor([&]() { return emulator.mode() == CT_SSMODE && emulator.gradient() == -3.5; }, 3000));
+    // 100 + 25 * gradient, rounded
+    EXPECT_TRUE(waitFor([&]() { return power(ct) == 13; }, 3000));
+
+    ct.stop();
+    EXPECT_TRUE(ct.wait(3000));
+#endif
+}
+
+void ComputrainerTestSuite::test_benchmark() {
+#ifdef CT_POLL
+    const struct {
+        int interval;
+        int steps;
+    } runs[] = {{29167, 20}, {1000, 200}};
+
+    for (const auto &run : runs) {
+        ComputrainerEmulator emulator;
+        ASSERT_TRUE(emulator.open());
+        emulator.setMessageInterval(run.interval);
+
+        Computrainer ct(nullptr, emulator.deviceName());
+        ct.setMode(CT_ERGOMODE, 100);
+        ct.start();
+        ASSERT_TRUE(waitFor([&]() { return power(ct) == 100; }, 3000));
+
+        for (int i = 0; i < run.steps; i++) {
+            const int load = i % 2 ? 150 : 250;
+            ct.setLoad(load);
+            EXPECT_TRUE(waitFor([&]() { return power(ct) == load; }, 3000));
+        }
+        EXPECT_TRUE(waitFor([&]() { return ct.loadLatency().count() == (quint64)run.steps; }, 1000));
+        // keyed by the interval of the messages, in us
+        const std::string interval = std::to_string(run.interval);
+        RecordProperty("load_latency_p50_us_" + interval, (int)ct.loadLatency().percentile(50));
+        RecordProperty("load_latency_p99_us_" + interval, (int)ct.loadLatency().percentile(99));
+        RecordProperty("load_latency_max_us_" + interval, (int)ct.loadLatency().max());
+
+        ct.stop();
+        EXPECT_TRUE(ct.wait(3000));
+    }
+#endif
+}
@@ -0,0 +1,49 @@
+#ifndef COMPUTRAINERTESTSUITE_H
+#define COMPUTRAINERTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class ComputrainerTestSuite: public testing::Test {
+
+public:
+    ComputrainerTestSuite();
+
+    /**
+     * @brief Test that a reader never gets half of an update of a seqlock, while the writer updates it in a loop
+     */
+    void test_seqlock();
+
+    /**
+     * @brief Test the buckets and the percentiles of the latency histogram
+     */
+    void test_histogram();
+
+    /**
+     * @brief Test the driver against the emulator: discovery, telemetry, ERGOMODE load and SSMODE gradient
+     */
+    void test_emulator();
+
+    /**
+     * @brief Measure the latency from a load set to the power measured reaching it, at 2400 baud and faster; the
+     * percentiles are properties of the test
+     */
+    void test_benchmark();
+};
+
+TEST_F(ComputrainerTestSuite, TestSeqlock) {
+    this->test_seqlock();
+}
+
+TEST_F(ComputrainerTestSuite, TestHistogram) {
+    this->test_histogram();
+}
+
+TEST_F(ComputrainerTestSuite, TestEmulator) {
+    this->test_emulator();
+}
+
+TEST_F(ComputrainerTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // COMPUTRAINERTESTSUITE_H
@@ -0,0 +1,159 @@
+#include "csafetestsuite.h"
+
+#include <QByteArray>
+#include "devices/csaferower/csafe.h"
+
+static QByteArray encode(const csafeframe &frame) {
+    quint8 out[csafe::MAX_REPORT];
+    const int size = frame.encode(out, sizeof(out));
+    return QByteArray((const char *)out, size);
+}
+
+static QByteArray report(const char *hex, int size) {
+    QByteArray r = QByteArray::fromHex(hex);
+    r.append(QByteArray(size - r.size(), 0));
+    return r;
+}
+
+static bool read(const QByteArray &r, csaferesponse *response) {
+    return csaferesponse::read((const quint8 *)r.constData(), r.size(), response);
+}
+
+CsafeTestSuite::CsafeTestSuite()
+{
+
+}
+
+void CsafeTestSuite::test_encode() {
+    // the poll of csaferowerThread: the PM commands in a SETUSERCFG1 wrapper, a 63 bytes report for the response
+    csafeframe poll;
+    poll.add(csafe::PM_GET_WORKTIME)
+        .add(csafe::PM_GET_WORKDISTANCE)
+        .add(csafe::GETCADENCE)
+        .add(csafe::GETPOWER)
+        .add(csafe::GETCALORIES)
+        .add(csafe::GETHRCUR);
+    EXPECT_EQ(report("04f11a02a0a3a7b4a3b01bf2", 63), encode(poll));
+    EXPECT_EQ(49, poll.maxResponse());
+
+    // long commands, little endian arguments, a wrapper closed by a short command
+    csafeframe set;
+    set.add(csafe::SETPOWER, 300, 0x58).add(csafe::PM_SET_SPLITDURATION, 0, 500).add(csafe::GETSTATUS);
+    EXPECT_EQ(report("01f134032c01581a07050500f4010000802af2", 21), encode(set));
+
+    csafeframe stroke;
+    stroke.add(csafe::PM_GET_STROKESTATE).add(csafe::PM_GET_DRAGFACTOR);
+    EXPECT_EQ(report("01f11a02bfc166f2", 21), encode(stroke));
+
+    // the frame doesn't change between two encodings, and clear() starts over
+    EXPECT_EQ(encode(stroke), encode(stroke));
+    stroke.clear();
+    stroke.add(csafe::PM_GET_STROKESTATE).add(csafe::PM_GET_DRAGFACTOR);
+    EXPECT_EQ(report("01f11a02bfc166f2", 21), encode(stroke));
+
+    // a buffer too small
+    quint8 small[20];
+    EXPECT_EQ(0, poll.encode(small, sizeof(small)));
+}
+
+void CsafeTestSuite::test_stuffing() {
+    csafeframe calories;
+    calories.add(csafe::SETCALORIES, 0x01F1);
+    EXPECT_EQ(report("01f12302f30101d1f2", 21), encode(calories));
+
+    // the checksum is 0xF2 here: sent as it is, it would end the frame early
+    csafeframe checksum;
+    checksum.add(csafe::SETCALORIES, 0xC310);
+    EXPECT_EQ(report("01f1230210c3f302f2", 21), encode(checksum));
+
+    // 40 long commands don't fit in a report
+    csafeframe tooLong;
+    for (int i = 0; i < 40; i++)
+        tooLong.add(csafe::SETPOWER, 0xF0F0, 0xF1);
+    EXPECT_EQ(QByteArray(), encode(tooLong));
+}
+
+void CsafeTestSuite::test_replay() {
+    csaferesponse response;
+
+    // the answer of a PM5 to the poll: work time 1234.56 s, 2500 m, 28 spm, 243 W (stuffed), 258 kcal, 151 bpm
+    ASSERT_TRUE(read(report("04f1051a0ea00540e2010000a305c409000024a7031c0054b403f3030058a3020201b001972cf2", 63),
+                     &response));
+    EXPECT_EQ(5, response.status);
+    EXPECT_TRUE(response.has(csafe::PM_GET_WORKTIME));
+    EXPECT_EQ(123456u, response.value(csafe::PM_GET_WORKTIME));
+    EXPECT_EQ(0u, response.value(csafe::PM_GET_WORKTIME, 1));
+    EXPECT_EQ(2500u, response.value(csafe::PM_GET_WORKDISTANCE));
+    EXPECT_EQ(0x24u, response.value(csafe::PM_GET_WORKDISTANCE, 1));
+    EXPECT_EQ(28u, response.value(csafe::GETCADENCE));
+    EXPECT_EQ(0x54u, response.value(csafe::GETCADENCE, 1));
+    EXPECT_EQ(243u, response.value(csafe::GETPOWER));
+    EXPECT_EQ(0x58u, response.value(csafe::GETPOWER, 1));
+    EXPECT_EQ(258u, response.value(csafe::GETCALORIES));
+    EXPECT_EQ(151u, response.value(csafe::GETHRCUR));
+    // same ids outside the wrapper are other commands
+    EXPECT_FALSE(response.has(csafe::GETTWORK));
+    EXPECT_FALSE(response.has(csafe::PM_GET_DRAGFACTOR));
+    EXPECT_EQ(0u, response.value(csafe::PM_GET_DRAGFACTOR));
+
+    // a PM3 extended frame, with addresses, and ASCII values
+    ASSERT_TRUE(read(QByteArray::fromHex("02f0000101910701050203003412940934333031323334353619f2"), &response));
+    EXPECT_EQ(1, response.status);
+    EXPECT_EQ(1u, response.value(csafe::GETVERSION, 0));
+    EXPECT_EQ(5u, response.value(csafe::GETVERSION, 1));
+    EXPECT_EQ(2u, response.value(csafe::GETVERSION, 2));
+    EXPECT_EQ(3u, response.value(csafe::GETVERSION, 3));
+    EXPECT_EQ(0x1234u, response.value(csafe::GETVERSION, 4));
+    char serial[16];
+    const int length = response.text(csafe::GETSERIAL, 0, serial, sizeof(serial));
+    EXPECT_EQ(QByteArray("430123456"), QByteArray(serial, length));
+    EXPECT_EQ(0u, response.value(csafe::GETSERIAL));
+
+    // stroke state and drag factor, the stroke phase poll
+    ASSERT_TRUE(read(report("01f1091a06bf0102c1017811f2", 21), &response));
+    EXPECT_EQ(9, response.status);
+    EXPECT_EQ(2u, response.value(csafe::PM_GET_STROKESTATE));
+    EXPECT_EQ(120u, response.value(csafe::PM_GET_DRAGFACTOR));
+    EXPECT_FALSE(response.has(csafe::GETPOWER));
+}
+
+void CsafeTestSuite::test_invalid() {
+    csaferesponse response;
+    const QByteArray good = report("01f1091a06bf0102c1017811f2", 21);
+    ASSERT_TRUE(read(good, &response));
+
+    // checksum
+    QByteArray damaged = good;
+    damaged[7] = 0x03;
+    EXPECT_FALSE(read(damaged, &response));
+    EXPECT_EQ(0u, response.received);
+
+    // no start flag, no stop flag, nothing
+    EXPECT_FALSE(read(report("01091a06bf0102c1017811f2", 21), &response));
+    EXPECT_FALSE(read(QByteArray::fromHex("01f1091a06bf0102c1017811"), &response));
+    EXPECT_FALSE(read(QByteArray(), &response));
+    EXPECT_FALSE(read(QByteArray(21, 0), &response));
+
+    // a value longer than the frame: the commands before it are kept
+    ASSERT_TRUE(read(QByteArray::fromHex("01f109b0019ab4099ff2"), &response));
+    EXPECT_EQ(0x9Au, response.value(csafe::GETHRCUR));
+    EXPECT_FALSE(response.has(csafe::GETPOWER));
+}
+
+void CsafeTestSuite::test_poll() {
+    // the poll of csaferowerThread and a PM5 answer to it
+    const QByteArray answer =
+        report("04f1051a0ea00540e2010000a305c409000024a7031c0054b403f3030058a3020201b001972cf2", 63);
+    csafeframe poll;
+    poll.add(csafe::PM_GET_WORKTIME)
+        .add(csafe::PM_GET_WORKDISTANCE)
+        .add(csafe::GETCADENCE)
+        .add(csafe::GETPOWER)
+        .add(csafe::GETCALORIES)
+        .add(csafe::GETHRCUR);
+    quint8 out[csafe::MAX_REPORT];
+    EXPECT_EQ(63, poll.encode(out, sizeof(out)));
+    csaferesponse response;
+    ASSERT_TRUE(read(answer, &response));
+    EXPECT_EQ(243u, response.value(csafe::GETPOWER));
+}
@@ -0,0 +1,57 @@
+#ifndef CSAFETESTSUITE_H
+#define CSAFETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class CsafeTestSuite: public testing::Test {
+
+public:
+    CsafeTestSuite();
+
+    /**
+     * @brief Test that the frames are the ones the QStringList codec sent, wrappers and long commands included
+     */
+    void test_encode();
+
+    /**
+     * @brief Test that the bytes F0-F3 are stuffed, the checksum too, and that a frame too long is refused
+     */
+    void test_stuffing();
+
+    /**
+     * @brief Test the decoding of PM3/PM5 responses: wrapped PM values, stuffed bytes, extended frames, ASCII values
+     */
+    void test_replay();
+
+    /**
+     * @brief Test that damaged or incomplete responses are rejected
+     */
+    void test_invalid();
+
+    /**
+     * @brief Test the report of the poll of the rower and the decoding of its answer
+     */
+    void test_poll();
+};
+
+TEST_F(CsafeTestSuite, TestEncode) {
+    this->test_encode();
+}
+
+TEST_F(CsafeTestSuite, TestStuffing) {
+    this->test_stuffing();
+}
+
+TEST_F(CsafeTestSuite, TestReplay) {
+    this->test_replay();
+}
+
+TEST_F(CsafeTestSuite, TestInvalid) {
+    this->test_invalid();
+}
+
+TEST_F(CsafeTestSuite, TestPoll) {
+    this->test_poll();
+}
+
+#endif // CSAFETESTSUITE_H
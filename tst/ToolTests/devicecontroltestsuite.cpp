@@ -0,0 +1,298 @@
+#include "devicecontroltestsuite.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "Tools/testapplication.h"
+#include "devices/bike.h"
+#include "devices/devicecontrolqueue.h"
+#include "metric.h"
+
+namespace {
+
+// a bike recording the targets it gets instead of sending them
+class controlledbike : public bike {
+  public:
+    void changeResistance(resistance_t res) override { apply(devicecommand::RESISTANCE, res); }
+    void changePower(int32_t power) override { apply(devicecommand::POWER, power); }
+    void changeInclination(double grade, double percentage) override {
+        Q_UNUSED(percentage);
+        apply(devicecommand::INCLINATION, grade);
+    }
+    void workoutEventStateChanged(bluetoothdevice::WORKOUT_EVENT_STATE state) override {
+        if (QThread::currentThread() != thread())
+            offThread++;
+        lastEvent = state;
+    }
+
+    // the same value in every metric, so a torn snapshot shows
+    void set(double value) {
+        Speed.setValue(value, false);
+        Cadence.setValue(value, false);
+        Resistance.setValue(value, false);
+        m_watt.setValue(value, false);
+    }
+    void publish(double value) {
+        set(value);
+        publishTelemetry();
+    }
+
+    std::atomic<int> applied{0};
+    std::atomic<int> offThread{0};
+    std::atomic<qint64> appliedNs{0};
+    std::atomic<double> last[devicecommand::KINDS] = {{0}, {0}, {0}};
+    std::atomic<int> lastEvent{-1};
+
+  private:
+    void apply(devicecommand::kind_t kind, double value) {
+        if (QThread::currentThread() != thread())
+            offThread++;
+        last[kind] = value;
+        appliedNs = metric::monotonicNs();
+        applied++;
+    }
+};
+
+// a thread of its own for a device, like a device driven off the GUI thread
+class devicethread {
+  public:
+    explicit devicethread(bluetoothdevice *device) : device(device) {
+        thread.start();
+        device->moveToThread(&thread);
+    }
+    ~devicethread() {
+        release();
+        thread.quit();
+        thread.wait();
+    }
+
+    QThread *get() { return &thread; }
+
+    // back to the GUI thread, from the thread of the device
+    void release() {
+        if (device->thread() != &thread)
+            return;
+        QThread *gui = QCoreApplication::instance()->thread();
+        QMetaObject::invokeMethod(
+            device, [this, gui]() { device->moveToThread(gui); }, Qt::BlockingQueuedConnection);
+    }
+
+  private:
+    bluetoothdevice *device;
+    QThread thread;
+};
+
+} // namespace
+
+DeviceControlTestSuite::DeviceControlTestSuite()
+{
+
+}
+
+void DeviceControlTestSuite::test_queue() {
+    devicecontrolqueue queue;
+    EXPECT_TRUE(queue.push(devicecommand::resistance(5)));
+    EXPECT_FALSE(queue.push(devicecommand::power(150)));
+    EXPECT_FALSE(queue.push(devicecommand::resistance(7)));
+    EXPECT_FALSE(queue.push(devicecommand::inclination(2.5, 3)));
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_EQ(queue.superseded(), 1u);
+
+    // the newer resistance took the place of the older one
+    devicecommand commands[devicecommand::KINDS];
+    ASSERT_EQ(queue.take(commands), 3);
+    EXPECT_EQ(commands[0].kind, devicecommand::RESISTANCE);
+    EXPECT_EQ(commands[0].value, 7);
+    EXPECT_EQ(commands[1].kind, devicecommand::POWER);
+    EXPECT_EQ(commands[1].value, 150);
+    EXPECT_EQ(commands[2].kind, devicecommand::INCLINATION);
+    EXPECT_EQ(commands[2].value, 2.5);
+    EXPECT_EQ(commands[2].percentage, 3);
+
+    // empty again: the next command wakes the consumer up
+    EXPECT_EQ(queue.size(), 0);
+    EXPECT_EQ(queue.take(commands), 0);
+    EXPECT_TRUE(queue.push(devicecommand::power(200)));
+    EXPECT_FALSE(queue.push(devicecommand::power(210)));
+    EXPECT_EQ(queue.superseded(), 2u);
+}
+
+void DeviceControlTestSuite::test_producers() {
+    const int count = 100000;
+    devicecontrolqueue queue;
+    std::atomic<int> running{devicecommand::KINDS};
+
+    std::vector<std::thread> producers;
+    for (int kind = 0; kind < devicecommand::KINDS; kind++) {
+        producers.emplace_back([&queue, &running, kind, count]() {
+            for (int i = 1; i <= count; i++) {
+                if (kind == devicecommand::RESISTANCE)
+                    queue.push(devicecommand::resistance(i));
+                else if (kind == devicecommand::POWER)
+                    queue.push(devicecommand::power(i));
+                else
+                    queue.push(devicecommand::inclination(i, i));
+            }
+            running--;
+        });
+    }
+
+    // the targets of a kind only go forward, and the last one always arrives
+    double last[devicecommand::KINDS] = {0, 0, 0};
+    quint64 taken = 0;
+    int backwards = 0;
+    devicecommand commands[devicecommand::KINDS];
+    while (true) {
+        const bool done = running == 0;
+        const int n = queue.take(commands);
+        for (int i = 0; i < n; i++) {
+            if (commands[i].value <= last[commands[i].kind])
+                backwards++;
+            last[commands[i].kind] = commands[i].value;
+        }
+        taken += n;
+        if (done && n == 0)
+            break;
+        std::this_thread::yield();
+    }
+    for (auto &producer : producers)
+        producer.join();
+
+    EXPECT_EQ(backwards, 0);
+    for (int kind = 0; kind < devicecommand::KINDS; kind++)
+        EXPECT_EQ(last[kind], count) << kind;
+    EXPECT_EQ(taken + queue.superseded(), (quint64)count * devicecommand::KINDS);
+}
+
+void DeviceControlTestSuite::test_control() {
+    ensureApplication();
+    std::unique_ptr<controlledbike> device(new controlledbike());
+
+    // on the thread of the caller the target is applied at once
+    device->requestControl(devicecommand::resistance(3));
+    EXPECT_EQ(device->applied.load(), 1);
+    EXPECT_EQ(device->last[devicecommand::RESISTANCE].load(), 3);
+
+    devicethread thread(device.get());
+    ASSERT_EQ(device->thread(), thread.get());
+
+    // a burst of targets: the device keeps up with the last one of each kind
+    for (int i = 1; i <= 1000; i++) {
+        device->requestControl(devicecommand::resistance(i % 32));
+        device->requestControl(devicecommand::power(i));
+        device->requestControl(devicecommand::inclination(i / 10.0, i / 10.0));
+    }
+    EXPECT_TRUE(spinUntil([&device]() {
+        return device->last[devicecommand::POWER] == 1000 && device->last[devicecommand::INCLINATION] == 100 &&
+               device->last[devicecommand::RESISTANCE] == 1000 % 32;
+    }));
+    EXPECT_EQ(device->offThread.load(), 0);
+    EXPECT_LE(device->applied.load(), 3001);
+
+    thread.release();
+    EXPECT_EQ(device->thread(), QCoreApplication::instance()->thread());
+    device->requestControl(devicecommand::power(50));
+    EXPECT_EQ(device->last[devicecommand::POWER].load(), 50);
+    EXPECT_EQ(device->offThread.load(), 0);
+}
+
+void DeviceControlTestSuite::test_snapshot() {
+    ensureApplication();
+    std::unique_ptr<controlledbike> device(new controlledbike());
+
+    // the thread of the device reads the live values, published or not
+    device->set(42);
+    EXPECT_EQ(device->telemetry().speed, 42);
+    EXPECT_EQ(device->telemetry().watts, 42);
+
+    devicethread thread(device.get());
+    ASSERT_EQ(device->thread(), thread.get());
+
+    const int updates = 20000;
+    std::atomic<bool> done{false};
+    controlledbike *d = device.get();
+    QMetaObject::invokeMethod(
+        d,
+        [d, &done, updates]() {
+            for (int i = 1; i <= updates; i++)
+                d->publish(i);
+            done = true;
+        },
+        Qt::QueuedConnection);
+
+    int torn = 0;
+    int backwards = 0;
+    double previous = 0;
+    while (!done) {
+        const devicetelemetry telemetry = device->telemetry();
+        if (telemetry.speed != telemetry.cadence || telemetry.speed != telemetry.watts ||
+            telemetry.speed != telemetry.resistance)
+            torn++;
+        if (telemetry.speed < previous)
+            backwards++;
+        previous = telemetry.speed;
+    }
+    EXPECT_EQ(torn, 0);
+    EXPECT_EQ(backwards, 0);
+    EXPECT_EQ(device->telemetry().speed, updates);
+    EXPECT_GT(device->telemetry().publishedNs, 0);
+
+    thread.release();
+    EXPECT_EQ(device->thread(), QCoreApplication::instance()->thread());
+}
+
+void DeviceControlTestSuite::test_latency() {
+    ensureApplication();
+    std::unique_ptr<controlledbike> device(new controlledbike());
+
+    // one sample for each notification forwarded, none for the values sent again
+    device->publish(100);
+    device->telemetryForwarded();
+    EXPECT_EQ(device->forwardingLatency().count(), 1u);
+    device->telemetryForwarded();
+    EXPECT_EQ(device->forwardingLatency().count(), 1u);
+    device->publish(101);
+    device->telemetryForwarded();
+    EXPECT_EQ(device->forwardingLatency().count(), 2u);
+    EXPECT_LT(device->forwardingLatency().max(), 1000000);
+
+    // from a target of the GUI thread to the device on its own thread: applied after it was sent
+    devicethread thread(device.get());
+    for (int i = 1; i <= 100; i++) {
+        const int applied = device->applied;
+        const qint64 sent = metric::monotonicNs();
+        device->requestControl(devicecommand::power(i));
+        ASSERT_TRUE(spinUntil([&device, applied]() { return device->applied > applied; }));
+        EXPECT_GE(device->appliedNs.load(), sent);
+        EXPECT_EQ(device->last[devicecommand::POWER].load(), i);
+    }
+    EXPECT_EQ(device->offThread.load(), 0);
+
+    thread.release();
+}
+
+void DeviceControlTestSuite::test_queuedArguments() {
+    ensureApplication();
+    std::unique_ptr<controlledbike> device(new controlledbike());
+    devicethread thread(device.get());
+    ASSERT_EQ(device->thread(), thread.get());
+
+    // the slots trainprogram and homeform connect to the device, queued once it's on the thread
+    QVector<MetersByInclination> next;
+    next.append({100, 2.5});
+    next.append({200, -1});
+    EXPECT_TRUE(QMetaObject::invokeMethod(device.get(), "changeNextInclination300Meters", Qt::QueuedConnection,
+                                          Q_ARG(QVector<MetersByInclination>, next)));
+    EXPECT_TRUE(QMetaObject::invokeMethod(device.get(), "workoutEventStateChanged", Qt::QueuedConnection,
+                                          Q_ARG(bluetoothdevice::WORKOUT_EVENT_STATE, bluetoothdevice::PAUSED)));
+    EXPECT_TRUE(spinUntil([&device]() {
+        return device->lastEvent == bluetoothdevice::PAUSED && device->nextInclination300Meters().size() == 2;
+    }));
+    EXPECT_EQ(device->nextInclination300Meters().at(1).inclination, -1);
+    EXPECT_EQ(device->offThread.load(), 0);
+
+    thread.release();
+}
@@ -0,0 +1,67 @@
+#ifndef DEVICECONTROLTESTSUITE_H
+#define DEVICECONTROLTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class DeviceControlTestSuite: public testing::Test {
+
+public:
+    DeviceControlTestSuite();
+
+    /**
+     * @brief Test the control queue: one command for each kind, the newest kept in place, the wake up of the consumer
+     */
+    void test_queue();
+
+    /**
+     * @brief Test a producer for each kind against a consumer: nothing lost, nothing reordered, the last target taken
+     */
+    void test_producers();
+
+    /**
+     * @brief Test that a device on another thread applies the targets of the GUI thread on its own thread
+     */
+    void test_control();
+
+    /**
+     * @brief Test that the GUI thread never reads a half published snapshot of a device on another thread
+     */
+    void test_snapshot();
+
+    /**
+     * @brief Test the forwarding latency recorded for a virtual device, and the targets of the GUI thread applied in
+     * order on another thread
+     */
+    void test_latency();
+
+    /**
+     * @brief Test that the arguments of the queued slots of a device on another thread reach it
+     */
+    void test_queuedArguments();
+};
+
+TEST_F(DeviceControlTestSuite, TestQueue) {
+    this->test_queue();
+}
+
+TEST_F(DeviceControlTestSuite, TestProducers) {
+    this->test_producers();
+}
+
+TEST_F(DeviceControlTestSuite, TestControl) {
+    this->test_control();
+}
+
+TEST_F(DeviceControlTestSuite, TestSnapshot) {
+    this->test_snapshot();
+}
+
+TEST_F(DeviceControlTestSuite, TestLatency) {
+    this->test_latency();
+}
+
+TEST_F(DeviceControlTestSuite, TestQueuedArguments) {
+    this->test_queuedArguments();
+}
+
+#endif // DEVICECONTROLTESTSUITE_H
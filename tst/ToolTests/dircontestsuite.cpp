@@ -0,0 +1,234 @@
+#include "dircontestsuite.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include <QTextStream>
+#include "Tools/dirconloopbackclient.h"
+#include "Tools/testsettings.h"
+#include "devices/dircon/dirconframebuffer.h"
+#include "devices/dircon/dirconpacket.h"
+#include "devices/dircon/dirconprocessor.h"
+#include "qzsettings.h"
+
+// what a client sends on connection: discovery, a read, a subscription, a write
+static QList<QByteArray> sessionFrames() {
+    QList<QByteArray> frames;
+    quint8 seq = 1;
+    frames.append(DirconLoopbackClient::request(DPKT_MSGID_DISCOVER_SERVICES, seq++));
+    frames.append(DirconLoopbackClient::request(DPKT_MSGID_DISCOVER_CHARACTERISTICS, seq++, 0x1826));
+    frames.append(DirconLoopbackClient::request(DPKT_MSGID_READ_CHARACTERISTIC, seq++, 0x2ACC));
+    frames.append(DirconLoopbackClient::request(DPKT_MSGID_ENABLE_CHARACTERISTIC_NOTIFICATIONS, seq++, 0x2AD2,
+                                                QByteArray(1, 1)));
+    frames.append(DirconLoopbackClient::request(DPKT_MSGID_WRITE_CHARACTERISTIC, seq++, 0x2AD9,
+                                                QByteArray::fromHex("0500")));
+    return frames;
+}
+
+static QString describe(int rv, const DirconPacket &pkt) { return QString::number(rv) + QStringLiteral(" ") + QString(pkt); }
+
+DirconTestSuite::DirconTestSuite()
+{
+
+}
+
+void DirconTestSuite::test_parseChunked() {
+    QByteArray stream;
+    int good = 0;
+    for (int i = 0; i < 200; i++) {
+        const QList<QByteArray> frames = sessionFrames();
+        for (const QByteArray &frame : frames) {
+            stream.append(frame);
+            good++;
+        }
+        if (i % 7 == 3) {
+            // a write too short to have a uuid: skipped, without losing the frames that follow
+            stream.append(QByteArray::fromHex("0104000000036162"));
+            stream.append('c');
+        }
+    }
+
+    // reference: one frame at a time from the whole buffer
+    QStringList expected;
+    int pos = 0;
+    while (pos < stream.size()) {
+        DirconPacket pkt;
+        const int rv = pkt.parse(stream.mid(pos), 0);
+        ASSERT_NE(DPKT_PARSE_WAIT, rv);
+        expected.append(describe(rv, pkt));
+        pos += rv > 0 ? rv : DPKT_PARSE_ERROR - rv;
+    }
+
+    // chunks of every size into a buffer small enough to be compacted and grown, one pooled packet
+    const int chunks[] = {1, 2, 5, 6, 7, 23, 64, 1000};
+    for (int chunk : chunks) {
+        DirconFrameBuffer buffer(16);
+        DirconPacket pkt;
+        QStringList parsed;
+        int parsedGood = 0;
+        for (int offset = 0; offset < stream.size(); offset += chunk) {
+            buffer.append(stream.constData() + offset, qMin(chunk, stream.size() - offset));
+            while (true) {
+                const int rv = pkt.parse(buffer.data(), buffer.size(), 0);
+                if (rv == DPKT_PARSE_WAIT)
+                    break;
+                parsed.append(describe(rv, pkt));
+                if (rv > 0)
+                    parsedGood++;
+                buffer.consume(rv > 0 ? rv : DPKT_PARSE_ERROR - rv);
+            }
+        }
+        EXPECT_TRUE(buffer.isEmpty()) << "chunk " << chunk;
+        EXPECT_EQ(good, parsedGood) << "chunk " << chunk;
+        ASSERT_EQ(expected.count(), parsed.count()) << "chunk " << chunk;
+        for (int i = 0; i < expected.count(); i++)
+            ASSERT_EQ(expected.at(i).toStdString(), parsed.at(i).toStdString()) << "chunk " << chunk << " frame " << i;
+    }
+}
+
+void DirconTestSuite::test_encode() {
+    QList<DirconPacket> responses;
+    DirconPacket p;
+    p.Identifier = DPKT_MSGID_DISCOVER_SERVICES;
+    p.uuids << 0x1826 << 0x1818;
+    responses.append(p);
+    p.reset();
+    p.Identifier = DPKT_MSGID_DISCOVER_CHARACTERISTICS;
+    p.uuid = 0x1826;
+    p.uuids << 0x2ACC << 0x2AD2;
+    p.additional_data = QByteArray::fromHex("0104");
+    responses.append(p);
+    p.reset();
+    p.Identifier = DPKT_MSGID_READ_CHARACTERISTIC;
+    p.uuid = 0x2ACC;
+    p.additional_data = QByteArray::fromHex("8314000000e00000");
+    responses.append(p);
+    p.reset();
+    p.Identifier = DPKT_MSGID_ENABLE_CHARACTERISTIC_NOTIFICATIONS;
+    p.uuid = 0x2AD2;
+    responses.append(p);
+    p.reset();
+    p.Identifier = DPKT_MSGID_READ_CHARACTERISTIC;
+    p.ResponseCode = DPKT_RESPCODE_CHARACTERISTIC_NOT_FOUND;
+    responses.append(p);
+
+    QByteArray out("xy");
+    for (DirconPacket &r : responses) {
+        DirconPacket copy = r;
+        const QByteArray whole = copy.encode(42);
+        out.resize(2);
+        EXPECT_EQ(whole.size(), r.encode(42, out));
+        EXPECT_EQ(whole, out.mid(2));
+    }
+
+    // notifications: the same bytes as an encoded packet, back to back in the frames of a tick
+    const QByteArray power = QByteArray::fromHex("4400fa0050");
+    const QByteArray hr = QByteArray::fromHex("0096");
+    DirconNotificationFrames frames;
+    frames.add(0x2AD2, power);
+    frames.add(0x2A37, hr);
+    ASSERT_EQ(2, frames.count());
+    QByteArray all;
+    const quint16 uuids[] = {0x2AD2, 0x2A37};
+    const QByteArray values[] = {power, hr};
+    for (int i = 0; i < 2; i++) {
+        DirconPacket n;
+        n.Identifier = DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION;
+        n.uuid = uuids[i];
+        n.additional_data = values[i];
+        const QByteArray encoded = n.encode(0);
+        QByteArray single;
+        DirconPacket::encodeNotification(uuids[i], values[i], single);
+        EXPECT_EQ(encoded, single);
+        EXPECT_EQ(uuids[i], frames.uuid(i));
+        EXPECT_EQ(encoded, QByteArray(frames.frame(i), frames.frameSize(i)));
+        all.append(encoded);
+    }
+    EXPECT_EQ(all, frames.data());
+    frames.clear();
+    EXPECT_EQ(0, frames.count());
+    EXPECT_TRUE(frames.data().isEmpty());
+}
+
+void DirconTestSuite::test_loopback() {
+    if (!QCoreApplication::instance()) {
+        static int argc = 1;
+        static char name[] = "qdomyos-zwift-tests";
+        static char *argv[] = {name, nullptr};
+        new QCoreApplication(argc, argv);
+    }
+
+    // the clients only get the notifications they subscribed to
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("DirconTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::wahoo_rgt_dircon, true);
+    settings.activate();
+
+    DirconProcessorService *service = new DirconProcessorService(QStringLiteral("CYCLING_POWER"), 0x1826, 0);
+    service->chars.append(new DirconProcessorCharacteristic(0x2ACC, DPKT_CHAR_PROP_FLAG_READ,
+                                                            QByteArray::fromHex("8314000000e00000"), nullptr, service));
+    service->chars.append(new DirconProcessorCharacteristic(0x2AD2, DPKT_CHAR_PROP_FLAG_NOTIFY, QByteArray(), nullptr,
+                                                            service));
+    service->chars.append(new DirconProcessorCharacteristic(0x2A63, DPKT_CHAR_PROP_FLAG_NOTIFY, QByteArray(), nullptr,
+                                                            service));
+    DirconProcessor processor(QList<DirconProcessorService *>() << service, QStringLiteral("Test Dircon"), 0,
+                              QStringLiteral("1234"), QStringLiteral("00:11:22:33:44:55"));
+    ASSERT_TRUE(processor.initServer());
+    ASSERT_NE(0, (int)processor.port());
+
+    DirconLoopbackClient client;
+    ASSERT_TRUE(client.connectToServer(processor.port()));
+    EXPECT_EQ(1, processor.clientCount());
+
+    // the session, as recorded by the debug log of the processor, with lines split anywhere
+    QList<QByteArray> session = sessionFrames();
+    QByteArray stream;
+    for (const QByteArray &frame : qAsConst(session))
+        stream.append(frame);
+    QTemporaryFile log;
+    ASSERT_TRUE(log.open());
+    {
+        QTextStream out(&log);
+        for (int pos = 0; pos < stream.size(); pos += 11)
+            out << "Debug: Data available for uuid  \"Test Dircon\" : \"" << stream.mid(pos, 11).toHex() << "\"\n";
+    }
+    log.close();
+    const QList<QByteArray> replayed = DirconLoopbackClient::framesFromLog(log.fileName());
+    ASSERT_EQ(session, replayed);
+
+    // every request gets its response; the write is to a characteristic the service doesn't have
+    ASSERT_EQ(session.count(), client.replay(replayed));
+    EXPECT_EQ(1, client.errors());
+    EXPECT_EQ(session.count(), client.latencies().count());
+
+    // the power notification goes out every tick, the one not subscribed never
+    const int ticks = 5000;
+    DirconNotificationFrames frames;
+    QByteArray value;
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < ticks; i++) {
+        frames.clear();
+        value = QByteArray::fromHex("44000000");
+        value[2] = (char)(i & 0xFF);
+        frames.add(0x2AD2, value);
+        frames.add(0x2A63, value);
+        EXPECT_TRUE(processor.sendCharacteristicNotifications(frames));
+        if (i % 100 == 99)
+            QCoreApplication::processEvents();
+    }
+    EXPECT_TRUE(client.waitNotifications(ticks));
+    const qint64 elapsedNs = timer.nsecsElapsed();
+    DirconLoopbackClient::spin(20);
+    EXPECT_EQ(ticks, client.notifications());
+
+    EXPECT_LE(client.latencyPercentile(0.5), client.latencyPercentile(0.99));
+    RecordProperty("latency_p50_us", (int)(client.latencyPercentile(0.5) / 1000));
+    RecordProperty("latency_p99_us", (int)(client.latencyPercentile(0.99) / 1000));
+    RecordProperty("notification_bytes", (int)client.notificationBytes());
+    RecordProperty("notifications_ms", (int)(elapsedNs / 1000000));
+
+    client.disconnectFromServer();
+    EXPECT_EQ(0, processor.clientCount());
+    settings.deactivate();
+}
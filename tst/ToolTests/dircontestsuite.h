@@ -0,0 +1,41 @@
+#ifndef DIRCONTESTSUITE_H
+#define DIRCONTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class DirconTestSuite: public testing::Test {
+
+public:
+    DirconTestSuite();
+
+    /**
+     * @brief Test that the frames parsed in place, received in chunks of any size, are the same as the frames
+     * parsed one by one from a whole buffer, including the resync after a broken frame
+     */
+    void test_parseChunked();
+
+    /**
+     * @brief Test that the appending encoder and the notification frames produce the bytes of the previous encoder
+     */
+    void test_encode();
+
+    /**
+     * @brief Test a session with a processor over the loopback interface, recording the response latency and the
+     * notification throughput in the XML report
+     */
+    void test_loopback();
+};
+
+TEST_F(DirconTestSuite, TestParseChunked) {
+    this->test_parseChunked();
+}
+
+TEST_F(DirconTestSuite, TestEncode) {
+    this->test_encode();
+}
+
+TEST_F(DirconTestSuite, TestLoopback) {
+    this->test_loopback();
+}
+
+#endif // DIRCONTESTSUITE_H
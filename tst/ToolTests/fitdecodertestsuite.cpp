@@ -0,0 +1,136 @@
+#include "fitdecodertestsuite.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QTemporaryDir>
+#include <cmath>
+#include <fstream>
+#include "fit_decode.hpp"
+#include "fit_mesg_broadcaster.hpp"
+#include "fitdecoder.h"
+#include "qfit.h"
+
+namespace {
+
+// how qfit::open read the records before fitdecoder
+class recordListener : public fit::RecordMesgListener {
+  public:
+    std::vector<fit::RecordMesg> records;
+    void OnMesg(fit::RecordMesg &mesg) override { records.push_back(mesg); }
+};
+
+std::vector<fit::RecordMesg> sdkRecords(const QString &filename) {
+    std::fstream file(filename.toStdString(), std::ios::in | std::ios::binary);
+    fit::Decode decode;
+    fit::MesgBroadcaster broadcaster;
+    recordListener listener;
+    broadcaster.AddListener((fit::RecordMesgListener &)listener);
+    decode.Read(&file, &broadcaster, &broadcaster, nullptr);
+    return listener.records;
+}
+
+QString saveWorkout(const QTemporaryDir &dir, int samples) {
+    const QString filename = dir.filePath(QStringLiteral("workout.fit"));
+    const QDateTime start = QDateTime::currentDateTime();
+    SessionStore session;
+    for (int i = 0; i < samples; i++) {
+        const uint8_t heart = i % 7 == 0 ? 0 : 100 + i % 60;
+        session.append(SessionLine(20.0 + (i % 30) * 0.1, 0, i * 0.0058, 120 + (i * 7) % 230, 10, 20, heart, 0,
+                                   70 + i % 25, i * 0.21, 0, i, (i % 300) == 0, 0, 0, 0, 0, QGeoCoordinate(), 0, 0,
+                                   0, 0, start.addSecs(i)));
+    }
+    qfit::save(filename, session, bluetoothdevice::BIKE);
+    return filename;
+}
+
+} // namespace
+
+FitDecoderTestSuite::FitDecoderTestSuite()
+{
+
+}
+
+void FitDecoderTestSuite::test_savedWorkout() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = saveWorkout(dir, 1800);
+
+    const std::vector<fit::RecordMesg> expected = sdkRecords(filename);
+    fitrecords records;
+    ASSERT_TRUE(fitdecoder::decodeFile(filename, &records));
+    ASSERT_EQ((int)expected.size(), records.count());
+    ASSERT_GT(records.count(), 0);
+    EXPECT_EQ(FIT_SPORT_CYCLING, records.sport);
+
+    for (int i = 0; i < records.count(); i++) {
+        fit::RecordMesg r = expected.at(i);
+        EXPECT_EQ(r.GetTimestamp(), records.timestamp.at(i));
+        EXPECT_EQ(r.IsPowerValid() ? r.GetPower() : 0, records.watt(i));
+        EXPECT_EQ(r.IsHeartRateValid() ? r.GetHeartRate() : 0, records.heartRate(i));
+        EXPECT_EQ(r.IsCadenceValid() ? r.GetCadence() : 0, records.cadenceRpm(i));
+        if (r.IsSpeedValid())
+            EXPECT_NEAR(r.GetSpeed() * 3.6, records.speedKmh(i), 1e-3);
+        if (r.IsDistanceValid())
+            EXPECT_NEAR(r.GetDistance() / 1000.0, records.distanceKm(i), 1e-6);
+        EXPECT_TRUE(std::isnan(records.latitudeDegrees(i)));
+    }
+
+    // the FIT timestamps are seconds since 1989-12-31
+    EXPECT_NEAR(QDateTime::currentMSecsSinceEpoch(), records.timeMs(0), 60 * 60 * 1000);
+}
+
+void FitDecoderTestSuite::test_messageHeaders() {
+    QByteArray data;
+    const unsigned char header[] = {14, 0x20, 0, 0, 0, 0, 0, 0, '.', 'F', 'I', 'T', 0, 0};
+    data.append(reinterpret_cast<const char *>(header), sizeof(header));
+    const unsigned char messages[] = {
+        // local 0, big endian record: timestamp, power, and a 3 bytes developer field
+        0x60, 0, 1, 0, 20, 2, 253, 4, 0x86, 7, 2, 0x84, 1, 0, 3, 0,
+        0x00, 0x00, 0x00, 0x10, 0x1E, 0x01, 0x2C, 9, 9, 9,
+        // local 1, little endian record: power only
+        0x41, 0, 0, 20, 0, 1, 7, 2, 0x84,
+        // compressed timestamp, offset 1: the 5 bits rolled over
+        0x80 | 0x20 | 0x01, 100, 0,
+        // compressed timestamp, offset 31
+        0x80 | 0x20 | 0x1F, 200, 0};
+    data.append(reinterpret_cast<const char *>(messages), sizeof(messages));
+    data[4] = (char)sizeof(messages);
+
+    fitrecords records;
+    ASSERT_TRUE(fitdecoder::decode(reinterpret_cast<const uchar *>(data.constData()), data.size(), &records));
+    ASSERT_EQ(3, records.count());
+    EXPECT_EQ(0x101Eu, records.timestamp.at(0));
+    EXPECT_EQ(0x1021u, records.timestamp.at(1));
+    EXPECT_EQ(0x103Fu, records.timestamp.at(2));
+    EXPECT_EQ(300, records.watt(0));
+    EXPECT_EQ(100, records.watt(1));
+    EXPECT_EQ(200, records.watt(2));
+    EXPECT_EQ(0, records.heartRate(0));
+}
+
+void FitDecoderTestSuite::test_truncated() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QFile file(saveWorkout(dir, 600));
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+
+    fitrecords complete;
+    ASSERT_TRUE(fitdecoder::decode(reinterpret_cast<const uchar *>(content.constData()), content.size(), &complete));
+
+    int previous = 0;
+    for (int length = 14; length <= content.size(); length += 97) {
+        fitrecords records;
+        ASSERT_TRUE(fitdecoder::decode(reinterpret_cast<const uchar *>(content.constData()), length, &records));
+        EXPECT_GE(records.count(), previous);
+        EXPECT_LE(records.count(), complete.count());
+        for (int i = 0; i < records.count(); i++)
+            EXPECT_EQ(complete.timestamp.at(i), records.timestamp.at(i));
+        previous = records.count();
+    }
+
+    fitrecords records;
+    const QByteArray text("<gpx></gpx>, not a FIT file");
+    EXPECT_FALSE(fitdecoder::decode(reinterpret_cast<const uchar *>(text.constData()), text.size(), &records));
+    EXPECT_EQ(0, records.count());
+}
@@ -0,0 +1,39 @@
+#ifndef FITDECODERTESTSUITE_H
+#define FITDECODERTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class FitDecoderTestSuite: public testing::Test {
+
+public:
+    FitDecoderTestSuite();
+
+    /**
+     * @brief Test that the records of a file saved by qfit are the ones the FIT SDK decodes from it
+     */
+    void test_savedWorkout();
+
+    /**
+     * @brief Test that compressed timestamp headers, big endian definitions and developer fields are decoded
+     */
+    void test_messageHeaders();
+
+    /**
+     * @brief Test that a truncated file gives the records before the truncation, and that other data is rejected
+     */
+    void test_truncated();
+};
+
+TEST_F(FitDecoderTestSuite, TestSavedWorkout) {
+    this->test_savedWorkout();
+}
+
+TEST_F(FitDecoderTestSuite, TestMessageHeaders) {
+    this->test_messageHeaders();
+}
+
+TEST_F(FitDecoderTestSuite, TestTruncated) {
+    this->test_truncated();
+}
+
+#endif // FITDECODERTESTSUITE_H
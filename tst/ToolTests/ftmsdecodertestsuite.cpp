@@ -0,0 +1,312 @@
+#include "ftmsdecodertestsuite.h"
+
+#include <QElapsedTimer>
+#include <QString>
+#include <vector>
+#include "ftmsdecoder.h"
+
+static QByteArray packet(std::initializer_list<int> bytes) {
+    QByteArray p;
+    for (int b : bytes)
+        p.append((char)(quint8)b);
+    return p;
+}
+
+// size in bytes of each field, by characteristic, in the order of the specification
+struct fieldSpec {
+    int bit;
+    bool inverted;
+    ftmsdecoder::field field;
+    int size;
+};
+
+static std::vector<fieldSpec> specOf(ftmsdecoder::characteristic type) {
+    switch (type) {
+    case ftmsdecoder::IndoorBikeData:
+        return {{0, true, ftmsdecoder::InstantSpeed, 2}, {1, false, ftmsdecoder::AverageSpeed, 2},
+                {2, false, ftmsdecoder::InstantCadence, 2}, {3, false, ftmsdecoder::AverageCadence, 2},
+                {4, false, ftmsdecoder::TotalDistance, 3}, {5, false, ftmsdecoder::ResistanceLevel, 2},
+                {6, false, ftmsdecoder::InstantPower, 2}, {7, false, ftmsdecoder::AveragePower, 2},
+                {8, false, ftmsdecoder::TotalEnergy, 2}, {8, false, ftmsdecoder::EnergyPerHour, 2},
+                {8, false, ftmsdecoder::EnergyPerMinute, 1}, {9, false, ftmsdecoder::HeartRate, 1},
+                {10, false, ftmsdecoder::MetabolicEquivalent, 1}, {11, false, ftmsdecoder::ElapsedTime, 2},
+                {12, false, ftmsdecoder::RemainingTime, 2}};
+    case ftmsdecoder::TreadmillData:
+        return {{0, true, ftmsdecoder::InstantSpeed, 2}, {1, false, ftmsdecoder::AverageSpeed, 2},
+                {2, false, ftmsdecoder::TotalDistance, 3}, {3, false, ftmsdecoder::Inclination, 2},
+                {3, false, ftmsdecoder::RampAngle, 2}, {4, false, ftmsdecoder::PositiveElevationGain, 2},
+                {4, false, ftmsdecoder::NegativeElevationGain, 2}, {5, false, ftmsdecoder::InstantPace, 1},
+                {6, false, ftmsdecoder::AveragePace, 1}, {7, false, ftmsdecoder::TotalEnergy, 2},
+                {7, false, ftmsdecoder::EnergyPerHour, 2}, {7, false, ftmsdecoder::EnergyPerMinute, 1},
+                {8, false, ftmsdecoder::HeartRate, 1}, {9, false, ftmsdecoder::MetabolicEquivalent, 1},
+                {10, false, ftmsdecoder::ElapsedTime, 2}, {11, false, ftmsdecoder::RemainingTime, 2},
+                {12, false, ftmsdecoder::ForceOnBelt, 2}, {12, false, ftmsdecoder::PowerOutput, 2}};
+    case ftmsdecoder::RowerData:
+        return {{0, true, ftmsdecoder::StrokeRate, 1}, {0, true, ftmsdecoder::StrokeCount, 2},
+                {1, false, ftmsdecoder::AverageStrokeRate, 1}, {2, false, ftmsdecoder::TotalDistance, 3},
+                {3, false, ftmsdecoder::InstantPace, 2}, {4, false, ftmsdecoder::AveragePace, 2},
+                {5, false, ftmsdecoder::InstantPower, 2}, {6, false, ftmsdecoder::AveragePower, 2},
+                {7, false, ftmsdecoder::ResistanceLevel, 2}, {8, false, ftmsdecoder::TotalEnergy, 2},
+                {8, false, ftmsdecoder::EnergyPerHour, 2}, {8, false, ftmsdecoder::EnergyPerMinute, 1},
+                {9, false, ftmsdecoder::HeartRate, 1}, {10, false, ftmsdecoder::MetabolicEquivalent, 1},
+                {11, false, ftmsdecoder::ElapsedTime, 2}, {12, false, ftmsdecoder::RemainingTime, 2}};
+    default:
+        return {{0, true, ftmsdecoder::InstantSpeed, 2}, {1, false, ftmsdecoder::AverageSpeed, 2},
+                {2, false, ftmsdecoder::TotalDistance, 3}, {3, false, ftmsdecoder::StepRate, 2},
+                {3, false, ftmsdecoder::AverageStepRate, 2}, {4, false, ftmsdecoder::StrideCount, 2},
+                {5, false, ftmsdecoder::PositiveElevationGain, 2}, {5, false, ftmsdecoder::NegativeElevationGain, 2},
+                {6, false, ftmsdecoder::Inclination, 2}, {6, false, ftmsdecoder::RampAngle, 2},
+                {7, false, ftmsdecoder::ResistanceLevel, 2}, {8, false, ftmsdecoder::InstantPower, 2},
+                {9, false, ftmsdecoder::AveragePower, 2}, {10, false, ftmsdecoder::TotalEnergy, 2},
+                {10, false, ftmsdecoder::EnergyPerHour, 2}, {10, false, ftmsdecoder::EnergyPerMinute, 1},
+                {11, false, ftmsdecoder::HeartRate, 1}, {12, false, ftmsdecoder::MetabolicEquivalent, 1},
+                {13, false, ftmsdecoder::ElapsedTime, 2}, {14, false, ftmsdecoder::RemainingTime, 2}};
+    }
+}
+
+// the Indoor Bike Data parser of ftmsbike before the decoder: QByteArray::at() per byte, a string per field
+static double legacyIndoorBikeData(const QByteArray &newValue, QString &log) {
+    union flags {
+        struct {
+            uint16_t moreData : 1;
+            uint16_t avgSpeed : 1;
+            uint16_t instantCadence : 1;
+            uint16_t avgCadence : 1;
+            uint16_t totDistance : 1;
+            uint16_t resistanceLvl : 1;
+            uint16_t instantPower : 1;
+            uint16_t avgPower : 1;
+            uint16_t expEnergy : 1;
+            uint16_t heartRate : 1;
+            uint16_t spare : 6;
+        };
+        uint16_t word_flags;
+    };
+    flags Flags;
+    Flags.word_flags = ((quint8)newValue.at(1) << 8) | (quint8)newValue.at(0);
+    int index = 2;
+    double total = 0;
+    auto u16 = [&](int i) {
+        return (double)(((uint16_t)((uint8_t)newValue.at(i + 1)) << 8) | (uint16_t)((uint8_t)newValue.at(i)));
+    };
+    if (!Flags.moreData) {
+        double speed = u16(index) / 100.0;
+        index += 2;
+        log = QStringLiteral("Current Speed: ") + QString::number(speed);
+        total += speed;
+    }
+    if (Flags.instantCadence) {
+        double cadence = u16(index) / 2.0;
+        index += 2;
+        log = QStringLiteral("Current Cadence: ") + QString::number(cadence);
+        total += cadence;
+    }
+    if (Flags.resistanceLvl) {
+        double resistance = u16(index);
+        index += 2;
+        log = QStringLiteral("Current Resistance: ") + QString::number(resistance);
+        total += resistance;
+    }
+    if (Flags.instantPower) {
+        double watt = u16(index);
+        index += 2;
+        log = QStringLiteral("Current Watt: ") + QString::number(watt);
+        total += watt;
+    }
+    if (Flags.heartRate && newValue.length() > index) {
+        double heart = (uint8_t)newValue.at(index);
+        log = QStringLiteral("Current Heart: ") + QString::number(heart);
+        total += heart;
+    }
+    log = QStringLiteral("Current Distance: ") + QString::number(total);
+    log = QStringLiteral("Current KCal: ") + QString::number(total);
+    return total;
+}
+
+FtmsDecoderTestSuite::FtmsDecoderTestSuite() {}
+
+void FtmsDecoderTestSuite::test_indoorBikeData() {
+    // speed 25.6 km/h, cadence 90 rpm, resistance 12, power 250 W, heart 140 bpm
+    const QByteArray p = packet({0x64, 0x02, 0x00, 0x0A, 0xB4, 0x00, 0x0C, 0x00, 0xFA, 0x00, 0x8C});
+    ftmsdecoder::data d;
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::IndoorBikeData, p.constData(), p.length(), d));
+    EXPECT_EQ(0x0264u, d.flags);
+    EXPECT_FALSE(d.truncated);
+    EXPECT_EQ(p.length(), (int)d.length);
+    EXPECT_NEAR(25.6, d.value(ftmsdecoder::InstantSpeed), 1e-9);
+    EXPECT_NEAR(90.0, d.value(ftmsdecoder::InstantCadence), 1e-9);
+    EXPECT_EQ(180, d.rawValue(ftmsdecoder::InstantCadence));
+    EXPECT_EQ(12, d.rawValue(ftmsdecoder::ResistanceLevel));
+    EXPECT_EQ(250, d.rawValue(ftmsdecoder::InstantPower));
+    EXPECT_EQ(140, d.rawValue(ftmsdecoder::HeartRate));
+    EXPECT_FALSE(d.has(ftmsdecoder::AverageSpeed));
+    EXPECT_FALSE(d.has(ftmsdecoder::TotalEnergy));
+    EXPECT_EQ(0, d.rawValue(ftmsdecoder::TotalEnergy));
+
+    // more data set: no speed
+    const QByteArray more = packet({0x41, 0x00, 0x2C, 0x01});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::IndoorBikeData, more.constData(), more.length(), d));
+    EXPECT_FALSE(d.has(ftmsdecoder::InstantSpeed));
+    EXPECT_EQ(300, d.rawValue(ftmsdecoder::InstantPower));
+
+    const QString text = ftmsdecoder::toString(d);
+    EXPECT_TRUE(text.contains(QStringLiteral("Watt: 300"))) << text.toStdString();
+}
+
+void FtmsDecoderTestSuite::test_signedFieldsAndFlags() {
+    // average power (bit 7, the high bit of the first byte) and a negative instant power
+    const QByteArray p = packet({0xC1, 0x00, 0xFD, 0xFF, 0x10, 0x00});
+    ftmsdecoder::data d;
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::IndoorBikeData, p.constData(), p.length(), d));
+    EXPECT_EQ(0x00C1u, d.flags);
+    EXPECT_EQ(-3, d.rawValue(ftmsdecoder::InstantPower));
+    EXPECT_EQ(16, d.rawValue(ftmsdecoder::AveragePower));
+    EXPECT_FALSE(d.has(ftmsdecoder::HeartRate));
+    EXPECT_FALSE(d.truncated);
+
+    // inclination -2.5 %
+    const QByteArray t = packet({0x08, 0x00, 0xE8, 0x03, 0xE7, 0xFF, 0x00, 0x00});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::TreadmillData, t.constData(), t.length(), d));
+    EXPECT_NEAR(10.0, d.value(ftmsdecoder::InstantSpeed), 1e-9);
+    EXPECT_NEAR(-2.5, d.value(ftmsdecoder::Inclination), 1e-9);
+    EXPECT_TRUE(d.has(ftmsdecoder::RampAngle));
+
+    // unsigned 24 bits distance
+    const QByteArray r = packet({0x05, 0x00, 0xFF, 0xFF, 0xFF});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::RowerData, r.constData(), r.length(), d));
+    EXPECT_EQ(0xFFFFFF, d.rawValue(ftmsdecoder::TotalDistance));
+}
+
+void FtmsDecoderTestSuite::test_otherCharacteristics() {
+    ftmsdecoder::data d;
+
+    // treadmill: speed 12 km/h, distance 1500 m, energy 80 kcal (+ per hour, per minute), heart 150
+    const QByteArray t = packet({0x84, 0x01, 0xB0, 0x04, 0xDC, 0x05, 0x00, 0x50, 0x00, 0x20, 0x03, 0x0E, 0x96});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::TreadmillData, t.constData(), t.length(), d));
+    EXPECT_NEAR(12.0, d.value(ftmsdecoder::InstantSpeed), 1e-9);
+    EXPECT_EQ(1500, d.rawValue(ftmsdecoder::TotalDistance));
+    EXPECT_EQ(80, d.rawValue(ftmsdecoder::TotalEnergy));
+    EXPECT_EQ(800, d.rawValue(ftmsdecoder::EnergyPerHour));
+    EXPECT_EQ(14, d.rawValue(ftmsdecoder::EnergyPerMinute));
+    EXPECT_EQ(150, d.rawValue(ftmsdecoder::HeartRate));
+    EXPECT_EQ(t.length(), (int)d.length);
+
+    // rower: stroke rate 28 spm, 300 strokes, pace 120 s/500m, power 180 W
+    const QByteArray r = packet({0x28, 0x00, 0x38, 0x2C, 0x01, 0x78, 0x00, 0xB4, 0x00});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::RowerData, r.constData(), r.length(), d));
+    EXPECT_NEAR(28.0, d.value(ftmsdecoder::StrokeRate), 1e-9);
+    EXPECT_EQ(300, d.rawValue(ftmsdecoder::StrokeCount));
+    EXPECT_EQ(120, d.rawValue(ftmsdecoder::InstantPace));
+    EXPECT_EQ(180, d.rawValue(ftmsdecoder::InstantPower));
+
+    // cross trainer: 3 bytes of flags, speed, step rate + average, resistance 4.5, power 95 W
+    const QByteArray c = packet({0x88, 0x01, 0x00, 0xD0, 0x07, 0x3C, 0x00, 0x38, 0x00, 0x2D, 0x00, 0x5F, 0x00});
+    ASSERT_TRUE(ftmsdecoder::decode(ftmsdecoder::CrossTrainerData, c.constData(), c.length(), d));
+    EXPECT_EQ(0x000188u, d.flags);
+    EXPECT_NEAR(20.0, d.value(ftmsdecoder::InstantSpeed), 1e-9);
+    EXPECT_EQ(60, d.rawValue(ftmsdecoder::StepRate));
+    EXPECT_EQ(56, d.rawValue(ftmsdecoder::AverageStepRate));
+    EXPECT_NEAR(4.5, d.value(ftmsdecoder::ResistanceLevel), 1e-9);
+    EXPECT_EQ(95, d.rawValue(ftmsdecoder::InstantPower));
+    EXPECT_EQ(c.length(), (int)d.length);
+}
+
+void FtmsDecoderTestSuite::test_truncatedAndUuid() {
+    ftmsdecoder::data d;
+    // power and heart flagged, the heart byte is missing
+    const QByteArray p = packet({0x40, 0x02, 0x10, 0x00, 0x2C, 0x01});
+    ASSERT_TRUE(ftmsdecoder::decode(QBluetoothUuid((quint16)0x2AD2), p, d));
+    EXPECT_EQ(ftmsdecoder::IndoorBikeData, d.type);
+    EXPECT_TRUE(d.truncated);
+    EXPECT_EQ(300, d.rawValue(ftmsdecoder::InstantPower));
+    EXPECT_FALSE(d.has(ftmsdecoder::HeartRate));
+    EXPECT_EQ(6, (int)d.length);
+
+    const QByteArray shortPacket = packet({0x00});
+    EXPECT_FALSE(ftmsdecoder::decode(QBluetoothUuid((quint16)0x2AD2), shortPacket, d));
+    EXPECT_FALSE(ftmsdecoder::decode(QBluetoothUuid((quint16)0x2A37), p, d));
+
+    EXPECT_EQ(ftmsdecoder::TreadmillData, ftmsdecoder::fromUuid(QBluetoothUuid((quint16)0x2ACD)));
+    EXPECT_EQ(ftmsdecoder::RowerData, ftmsdecoder::fromUuid(QBluetoothUuid((quint16)0x2AD1)));
+    EXPECT_EQ(ftmsdecoder::CrossTrainerData, ftmsdecoder::fromUuid(QBluetoothUuid((quint16)0x2ACE)));
+    EXPECT_EQ(ftmsdecoder::CharacteristicCount,
+              ftmsdecoder::fromUuid(QBluetoothUuid(QStringLiteral("0000fff1-0000-1000-8000-00805f9b34fb"))));
+}
+
+void FtmsDecoderTestSuite::test_fuzz() {
+    quint32 seed = 20240611;
+    auto next = [&seed]() {
+        seed = seed * 1664525u + 1013904223u;
+        return seed >> 8;
+    };
+
+    for (int t = 0; t < ftmsdecoder::CharacteristicCount; t++) {
+        const ftmsdecoder::characteristic type = (ftmsdecoder::characteristic)t;
+        const std::vector<fieldSpec> spec = specOf(type);
+        for (int i = 0; i < 50000; i++) {
+            // exactly sized heap buffer, so an address sanitizer build catches a read past the packet
+            const int length = next() % 48;
+            std::vector<char> bytes(length);
+            for (int b = 0; b < length; b++)
+                bytes[b] = (char)next();
+
+            ftmsdecoder::data d;
+            const bool ok = ftmsdecoder::decode(type, bytes.data(), length, d);
+            const int flagBytes = type == ftmsdecoder::CrossTrainerData ? 3 : 2;
+            ASSERT_EQ(length >= flagBytes, ok);
+            if (!ok)
+                continue;
+            ASSERT_LE((int)d.length, length);
+
+            // walk the reference layout: every field must be present exactly when its flag says so and it fits
+            int index = flagBytes;
+            bool truncated = false;
+            quint32 expected = 0;
+            for (const fieldSpec &f : spec) {
+                const bool flagged = (((d.flags >> f.bit) & 1) != 0) != f.inverted;
+                if (!flagged)
+                    continue;
+                if (index + f.size > length) {
+                    truncated = true;
+                    break;
+                }
+                expected |= 1u << f.field;
+                index += f.size;
+            }
+            ASSERT_EQ(expected, d.present) << "type " << t << " iteration " << i;
+            ASSERT_EQ(truncated, d.truncated);
+            ASSERT_EQ(index, (int)d.length);
+        }
+    }
+}
+
+void FtmsDecoderTestSuite::test_benchmark() {
+    // a typical trainer packet: speed, cadence, resistance, power, heart
+    const QByteArray p = packet({0x64, 0x02, 0x00, 0x0A, 0xB4, 0x00, 0x0C, 0x00, 0xFA, 0x00, 0x8C});
+    const int packets = 200000;
+    QElapsedTimer timer;
+
+    QString log;
+    double legacyTotal = 0;
+    timer.start();
+    for (int i = 0; i < packets; i++)
+        legacyTotal += legacyIndoorBikeData(p, log);
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    double total = 0;
+    timer.restart();
+    for (int i = 0; i < packets; i++) {
+        ftmsdecoder::data d;
+        ftmsdecoder::decode(ftmsdecoder::IndoorBikeData, p.constData(), p.length(), d);
+        total += d.value(ftmsdecoder::InstantSpeed) + d.value(ftmsdecoder::InstantCadence) +
+                 d.value(ftmsdecoder::ResistanceLevel) + d.value(ftmsdecoder::InstantPower) +
+                 d.value(ftmsdecoder::HeartRate);
+    }
+    const qint64 decoderNs = timer.nsecsElapsed();
+
+    // the same fields as the parser the devices had: 25.6 + 90 + 12 + 250 + 140 per packet
+    EXPECT_NEAR(517.6, legacyIndoorBikeData(p, log), 1e-9);
+    EXPECT_NEAR(legacyTotal, total, 1e-6 * legacyTotal);
+    RecordProperty("legacy_ns_per_packet", (int)(legacyNs / packets));
+    RecordProperty("decoder_ns_per_packet", (int)(decoderNs / packets));
+}
@@ -0,0 +1,70 @@
+#ifndef FTMSDECODERTESTSUITE_H
+#define FTMSDECODERTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class FtmsDecoderTestSuite: public testing::Test {
+
+public:
+    FtmsDecoderTestSuite();
+
+    /**
+     * @brief Test that an Indoor Bike Data packet is decoded with the resolution of each field
+     */
+    void test_indoorBikeData();
+
+    /**
+     * @brief Test that the signed fields are sign extended and that a flag in the high bit of a byte doesn't set the
+     * other flags
+     */
+    void test_signedFieldsAndFlags();
+
+    /**
+     * @brief Test the Treadmill Data, Rower Data and Cross Trainer Data layouts, including the fields sharing a flag
+     */
+    void test_otherCharacteristics();
+
+    /**
+     * @brief Test that a truncated packet keeps the fields before the missing bytes and that the uuid selects the
+     * layout
+     */
+    void test_truncatedAndUuid();
+
+    /**
+     * @brief Decode random packets of random lengths: the decoder must never read past the packet and the fields
+     * decoded must match the flags
+     */
+    void test_fuzz();
+
+    /**
+     * @brief Compare the cost of a packet decoded field by field with QByteArray::at() and a debug string per field,
+     * as the device parsers did, against the table driven decoder; both must agree, the costs are in the XML report
+     */
+    void test_benchmark();
+};
+
+TEST_F(FtmsDecoderTestSuite, TestIndoorBikeData) {
+    this->test_indoorBikeData();
+}
+
+TEST_F(FtmsDecoderTestSuite, TestSignedFieldsAndFlags) {
+    this->test_signedFieldsAndFlags();
+}
+
+TEST_F(FtmsDecoderTestSuite, TestOtherCharacteristics) {
+    this->test_otherCharacteristics();
+}
+
+TEST_F(FtmsDecoderTestSuite, TestTruncatedAndUuid) {
+    this->test_truncatedAndUuid();
+}
+
+TEST_F(FtmsDecoderTestSuite, TestFuzz) {
+    this->test_fuzz();
+}
+
+TEST_F(FtmsDecoderTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // FTMSDECODERTESTSUITE_H
@@ -0,0 +1,316 @@
+#include "gpxroutetestsuite.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDomDocument>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGeoCoordinate>
+#include <QTemporaryDir>
+#include <random>
+#include "gpxroute.h"
+
+static const QDateTime routeStart(QDate(2022, 6, 5), QTime(7, 30, 0), Qt::UTC);
+
+// a random walk a few meters per point, with the oddities of the files around: points without time or elevation,
+// fractional seconds, time zones, extensions
+static QByteArray randomGpx(std::mt19937 &rng, int count) {
+    QByteArray gpx;
+    gpx.reserve(count * 200);
+    gpx += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+           "<gpx version=\"1.1\" creator=\"test\" xmlns=\"http://www.topografix.com/GPX/1/1\">\n"
+           "<metadata><name>route</name><Video>https://example.com/route.mp4</Video></metadata>\n"
+           "<trk><name>route</name><trkseg>\n";
+    double lat = 45.0, lon = 9.0, ele = 200.0;
+    for (int i = 0; i < count; i++) {
+        // the same position twice now and then: a zero length segment
+        if (rng() % 50) {
+            lat += ((int)(rng() % 1001) - 500) * 0.00000005;
+            lon += ((int)(rng() % 1001) - 300) * 0.00000005;
+            ele += ((int)(rng() % 201) - 100) * 0.01;
+        }
+        gpx += "<trkpt lat=\"" + QByteArray::number(lat, 'f', 7) + "\" lon=\"" + QByteArray::number(lon, 'f', 7) +
+               "\">";
+        if (rng() % 20)
+            gpx += "<ele>" + QByteArray::number(ele, 'f', 2) + "</ele>";
+        const QDateTime t = routeStart.addMSecs(i * 1000 + (rng() % 4 == 0 ? (qint64)(rng() % 1000) : 0));
+        switch (rng() % 10) {
+        case 0:
+            break;
+        case 1:
+            gpx += "<time>" + t.toOffsetFromUtc(7200).toString(Qt::ISODateWithMs).toLatin1() + "</time>";
+            break;
+        case 2:
+            gpx += "<time>" + t.toOffsetFromUtc(-5 * 3600 - 1800).toString(Qt::ISODate).toLatin1() + "</time>";
+            break;
+        default:
+            gpx += "<time>" + t.toString(Qt::ISODateWithMs).toLatin1() + "</time>";
+            break;
+        }
+        if (rng() % 3 == 0)
+            gpx += "<extensions><power>" + QByteArray::number((int)(rng() % 400)) + "</power></extensions>";
+        gpx += "</trkpt>\n";
+    }
+    gpx += "</trkseg></trk></gpx>\n";
+    return gpx;
+}
+
+static void writeFile(const QString &fileName, const QByteArray &content) {
+    QFile f(fileName);
+    ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+    f.write(content);
+}
+
+// what gpx::open did before the route: a DOM and a QGeoCoordinate per point
+struct domPoint {
+    QDateTime time;
+    QGeoCoordinate p;
+};
+
+static QList<domPoint> domParse(const QByteArray &content) {
+    QList<domPoint> points;
+    QDomDocument doc;
+    doc.setContent(content);
+    QDomNodeList list = doc.elementsByTagName(QStringLiteral("trkpt"));
+    for (int i = 0; i < list.size(); i++) {
+        QDomNode point = list.item(i);
+        QDomNamedNodeMap att = point.attributes();
+        domPoint g;
+        g.time = QDateTime::fromString(point.firstChildElement(QStringLiteral("time")).text(), Qt::ISODate);
+        g.p.setAltitude(point.firstChildElement(QStringLiteral("ele")).text().toDouble());
+        g.p.setLatitude(att.namedItem(QStringLiteral("lat")).nodeValue().toDouble());
+        g.p.setLongitude(att.namedItem(QStringLiteral("lon")).nodeValue().toDouble());
+        points.append(g);
+    }
+    return points;
+}
+
+static void compare(const QList<domPoint> &expected, const gpxroute &route) {
+    ASSERT_EQ(expected.count(), route.count());
+    double total = 0;
+    for (int i = 0; i < expected.count(); i++) {
+        const domPoint &e = expected.at(i);
+        ASSERT_EQ(e.p.latitude(), route.latitude(i)) << "point " << i;
+        ASSERT_EQ(e.p.longitude(), route.longitude(i)) << "point " << i;
+        ASSERT_EQ((float)e.p.altitude(), route.elevation(i)) << "point " << i;
+        if (e.time.isValid())
+            ASSERT_EQ(e.time.toMSecsSinceEpoch(), route.time(i)) << "point " << i;
+        else
+            ASSERT_EQ(gpxroute::INVALID_TIME, route.time(i)) << "point " << i;
+        if (i == 0)
+            continue;
+
+        const domPoint &prev = expected.at(i - 1);
+        EXPECT_EQ(prev.time.secsTo(e.time), route.secsTo(i - 1, i)) << "point " << i;
+        EXPECT_EQ(expected.constFirst().time.secsTo(e.time), route.secsTo(0, i)) << "point " << i;
+        const double d = prev.p.distanceTo(e.p);
+        total += d;
+        EXPECT_NEAR(d, route.segmentDistance(i), 1e-9) << "point " << i;
+        EXPECT_NEAR(total, route.distance(i), 1e-6) << "point " << i;
+        if (d != 0) {
+            EXPECT_NEAR(prev.p.azimuthTo(e.p), route.azimuth(i), 1e-3) << "point " << i;
+            EXPECT_NEAR((e.p.altitude() - prev.p.altitude()) / d * 100, route.grade(i), 1e-2) << "point " << i;
+        } else {
+            EXPECT_EQ(0, route.grade(i));
+        }
+    }
+}
+
+GpxRouteTestSuite::GpxRouteTestSuite()
+{
+
+}
+
+void GpxRouteTestSuite::test_parse() {
+    std::mt19937 rng(7);
+    const QByteArray content = randomGpx(rng, 3000);
+    QBuffer buffer;
+    buffer.setData(content);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    gpxroute route;
+    ASSERT_TRUE(route.parse(&buffer));
+    EXPECT_FALSE(route.isFromCache());
+    EXPECT_EQ(QStringLiteral("https://example.com/route.mp4"), route.videoUrl());
+    compare(domParse(content), route);
+
+    // the distances and the azimuths of points far apart, and of invalid ones
+    for (int i = 0; i < 1000; i++) {
+        const QGeoCoordinate a(((int)(rng() % 18000) - 9000) / 100.0, ((int)(rng() % 36000) - 18000) / 100.0);
+        const QGeoCoordinate b(((int)(rng() % 18000) - 9000) / 100.0, ((int)(rng() % 36000) - 18000) / 100.0);
+        EXPECT_NEAR(a.distanceTo(b),
+                    gpxroute::distanceBetween(a.latitude(), a.longitude(), b.latitude(), b.longitude()), 1e-6);
+        EXPECT_NEAR(a.azimuthTo(b), gpxroute::azimuthBetween(a.latitude(), a.longitude(), b.latitude(), b.longitude()),
+                    1e-9);
+    }
+    EXPECT_EQ(0, gpxroute::distanceBetween(NAN, 9, 45, 9));
+    EXPECT_EQ(0, gpxroute::distanceBetween(45, 9, 91, 9));
+
+    // a truncated file: the points before the error are kept
+    QBuffer truncated;
+    truncated.setData(content.left(content.size() / 2));
+    ASSERT_TRUE(truncated.open(QIODevice::ReadOnly));
+    EXPECT_TRUE(route.parse(&truncated));
+    EXPECT_GT(route.count(), 0);
+
+    QBuffer empty;
+    ASSERT_TRUE(empty.open(QIODevice::ReadOnly));
+    EXPECT_FALSE(route.parse(&empty));
+    EXPECT_EQ(0, route.count());
+}
+
+void GpxRouteTestSuite::test_time() {
+    const QStringList times = {
+        QStringLiteral("2020-10-10T10:54:45Z"),
+        QStringLiteral("2020-10-10T10:54:45.1Z"),
+        QStringLiteral("2020-10-10T10:54:45.123Z"),
+        QStringLiteral("2020-10-10T10:54:45.123456Z"),
+        QStringLiteral("2020-10-10T10:54:45.9996Z"),
+        QStringLiteral("2020-10-10T10:54:45+02:00"),
+        QStringLiteral("2020-10-10T10:54:45.5-05:30"),
+        QStringLiteral("2020-10-10T00:10:00+0100"),
+        QStringLiteral("2024-02-29T23:59:59Z"),
+        QStringLiteral("1969-12-31T23:59:59Z"),
+        QStringLiteral("2020-10-10T10:54:45"),
+        QStringLiteral("2020-10-10T10:54Z"),
+        QStringLiteral("2020-10-10"),
+        QStringLiteral(" 2020-10-10T10:54:45Z "),
+        QStringLiteral("2023-02-29T10:54:45Z"),
+        QStringLiteral("2020-10-10T24:00:00Z"),
+        QStringLiteral("not a time"),
+        QString(),
+    };
+    for (const QString &t : times) {
+        const QDateTime expected = QDateTime::fromString(t, Qt::ISODate);
+        EXPECT_EQ(expected.isValid() ? expected.toMSecsSinceEpoch() : gpxroute::INVALID_TIME, gpxroute::parseTime(t))
+            << t.toStdString();
+    }
+
+    std::mt19937 rng(11);
+    for (int i = 0; i < 10000; i++) {
+        const QDateTime t = QDateTime::fromMSecsSinceEpoch((qint64)(rng() % 2000000000) * 1000 + rng() % 1000, Qt::UTC)
+                                .toOffsetFromUtc(((int)(rng() % 49) - 24) * 1800);
+        const QString text = t.toString(rng() % 2 ? Qt::ISODateWithMs : Qt::ISODate);
+        ASSERT_EQ(QDateTime::fromString(text, Qt::ISODate).toMSecsSinceEpoch(), gpxroute::parseTime(text))
+            << text.toStdString();
+    }
+}
+
+void GpxRouteTestSuite::test_tcx() {
+    const QByteArray tcx =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<TrainingCenterDatabase xmlns=\"http://www.garmin.com/xmlschemas/TrainingCenterDatabase/v2\">\n"
+        "<Activities><Activity Sport=\"Biking\"><Id>2022-06-05T07:30:00Z</Id>\n"
+        "<Lap StartTime=\"2022-06-05T07:30:00Z\"><Track>\n"
+        "<Trackpoint><Time>2022-06-05T07:30:00Z</Time><Position><LatitudeDegrees>45.0000000</LatitudeDegrees>"
+        "<LongitudeDegrees>9.0000000</LongitudeDegrees></Position><AltitudeMeters>200.5</AltitudeMeters>"
+        "<HeartRateBpm><Value>120</Value></HeartRateBpm></Trackpoint>\n"
+        "<Trackpoint><Time>2022-06-05T07:30:01Z</Time><HeartRateBpm><Value>121</Value></HeartRateBpm></Trackpoint>\n"
+        "<Trackpoint><Time>2022-06-05T07:30:02Z</Time><Position><LatitudeDegrees>45.0001000</LatitudeDegrees>"
+        "<LongitudeDegrees>9.0001000</LongitudeDegrees></Position><AltitudeMeters>201.5</AltitudeMeters>"
+        "<Extensions><TPX><Watts>200</Watts></TPX></Extensions></Trackpoint>\n"
+        "</Track></Lap></Activity></Activities></TrainingCenterDatabase>\n";
+    QBuffer buffer;
+    buffer.setData(tcx);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    gpxroute route;
+    ASSERT_TRUE(route.parse(&buffer));
+    // the point without a position is skipped
+    ASSERT_EQ(2, route.count());
+    EXPECT_EQ(45.0001, route.latitude(1));
+    EXPECT_EQ(9.0001, route.longitude(1));
+    EXPECT_EQ(201.5f, route.elevation(1));
+    EXPECT_EQ(routeStart.toMSecsSinceEpoch(), route.time(0));
+    EXPECT_EQ(2, route.secsTo(0, 1));
+    const QGeoCoordinate a(45.0, 9.0), b(45.0001, 9.0001);
+    EXPECT_NEAR(a.distanceTo(b), route.distance(1), 1e-9);
+    EXPECT_NEAR(a.azimuthTo(b), route.azimuth(1), 1e-3);
+    EXPECT_NEAR(1.0 / a.distanceTo(b) * 100, route.grade(1), 1e-4);
+}
+
+void GpxRouteTestSuite::test_cache() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("route.gpx"));
+    std::mt19937 rng(13);
+    const QByteArray content = randomGpx(rng, 2000);
+    writeFile(fileName, content);
+    const QList<domPoint> expected = domParse(content);
+
+    gpxroute route;
+    ASSERT_TRUE(route.open(fileName));
+    EXPECT_FALSE(route.isFromCache());
+    const QString cacheFileName = gpxroute::cacheFileNames(fileName).first();
+    EXPECT_TRUE(QFile::exists(cacheFileName));
+
+    gpxroute cached;
+    ASSERT_TRUE(cached.open(fileName));
+    EXPECT_TRUE(cached.isFromCache());
+    EXPECT_EQ(route.videoUrl(), cached.videoUrl());
+    compare(expected, cached);
+    for (int i = 0; i < route.count(); i++) {
+        ASSERT_EQ(route.distance(i), cached.distance(i));
+        ASSERT_EQ(route.grade(i), cached.grade(i));
+        ASSERT_EQ(route.azimuth(i), cached.azimuth(i));
+    }
+
+    // the route is edited: the cache is stale
+    const QByteArray edited = randomGpx(rng, 500);
+    writeFile(fileName, edited);
+    ASSERT_TRUE(cached.open(fileName));
+    EXPECT_FALSE(cached.isFromCache());
+    compare(domParse(edited), cached);
+    ASSERT_TRUE(cached.open(fileName));
+    EXPECT_TRUE(cached.isFromCache());
+    EXPECT_EQ(500, cached.count());
+
+    // a broken cache is parsed again
+    QFile broken(cacheFileName);
+    ASSERT_TRUE(broken.open(QIODevice::ReadWrite));
+    ASSERT_TRUE(broken.resize(broken.size() - 4));
+    broken.close();
+    ASSERT_TRUE(cached.open(fileName));
+    EXPECT_FALSE(cached.isFromCache());
+    EXPECT_EQ(500, cached.count());
+
+    cached.clear();
+    EXPECT_EQ(0, cached.count());
+    EXPECT_FALSE(cached.isFromCache());
+    EXPECT_FALSE(cached.open(dir.filePath(QStringLiteral("missing.gpx"))));
+}
+
+void GpxRouteTestSuite::test_benchmark() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString fileName = dir.filePath(QStringLiteral("long.gpx"));
+    std::mt19937 rng(17);
+    const int count = 50000;
+    writeFile(fileName, randomGpx(rng, count));
+
+    QElapsedTimer timer;
+    timer.start();
+    QFile input(fileName);
+    ASSERT_TRUE(input.open(QIODevice::ReadOnly));
+    const QList<domPoint> dom = domParse(input.readAll());
+    double domDistance = 0;
+    for (int i = 1; i < dom.count(); i++)
+        domDistance += dom.at(i - 1).p.distanceTo(dom.at(i).p);
+    const qint64 domMs = timer.elapsed();
+
+    timer.restart();
+    gpxroute route;
+    ASSERT_TRUE(route.open(fileName));
+    const qint64 streamMs = timer.elapsed();
+    ASSERT_FALSE(route.isFromCache());
+
+    timer.restart();
+    gpxroute cached;
+    ASSERT_TRUE(cached.open(fileName));
+    const qint64 cacheMs = timer.elapsed();
+    ASSERT_TRUE(cached.isFromCache());
+
+    ASSERT_EQ(count, cached.count());
+    EXPECT_NEAR(domDistance, cached.distance(count - 1), 1e-3);
+    RecordProperty("dom_ms", (int)domMs);
+    RecordProperty("stream_ms", (int)streamMs);
+    RecordProperty("cache_ms", (int)cacheMs);
+}
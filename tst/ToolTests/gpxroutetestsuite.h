@@ -0,0 +1,57 @@
+#ifndef GPXROUTETESTSUITE_H
+#define GPXROUTETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class GpxRouteTestSuite: public testing::Test {
+
+public:
+    GpxRouteTestSuite();
+
+    /**
+     * @brief Test that the streamed points and their geometry match a DOM parse with QGeoCoordinate
+     */
+    void test_parse();
+
+    /**
+     * @brief Test that the times are the ones of QDateTime::fromString with Qt::ISODate
+     */
+    void test_time();
+
+    /**
+     * @brief Test the track points of a TCX activity
+     */
+    void test_tcx();
+
+    /**
+     * @brief Test that the cache gives back the parsed route and is dropped when the file changes
+     */
+    void test_cache();
+
+    /**
+     * @brief Compare the DOM parse, the stream parse and the cache on a long route, timings in the XML report
+     */
+    void test_benchmark();
+};
+
+TEST_F(GpxRouteTestSuite, TestParse) {
+    this->test_parse();
+}
+
+TEST_F(GpxRouteTestSuite, TestTime) {
+    this->test_time();
+}
+
+TEST_F(GpxRouteTestSuite, TestTcx) {
+    this->test_tcx();
+}
+
+TEST_F(GpxRouteTestSuite, TestCache) {
+    this->test_cache();
+}
+
+TEST_F(GpxRouteTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // GPXROUTETESTSUITE_H
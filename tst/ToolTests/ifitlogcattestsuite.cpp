@@ -0,0 +1,372 @@
+#include "ifitlogcattestsuite.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <QThread>
+#include <functional>
+#include <vector>
+#include "Tools/ifitlogcatreplay.h"
+#include "Tools/testsettings.h"
+#include "devices/ifitlogcat.h"
+#include "devices/nordictrackifitadbbike/nordictrackifitadbbike.h"
+#include "devices/nordictrackifitadbtreadmill/nordictrackifitadbtreadmill.h"
+#include "qzsettings.h"
+
+namespace {
+
+struct update {
+    ifitlogcatparser::event e;
+    double value;
+    bool operator==(const update &other) const { return e == other.e && value == other.value; }
+};
+
+QByteArray line(int ms, const char *tag, const QByteArray &message, bool crlf = false) {
+    char time[32];
+    snprintf(time, sizeof(time), "10-18 %02d:%02d:%02d.%03d", 12 + ms / 3600000, ms / 60000 % 60, ms / 1000 % 60,
+             ms % 1000);
+    return QByteArray(time) + "  1576  1609 I " + tag + ": " + message + (crlf ? "\r\n" : "\n");
+}
+
+// a change of the workout, last gets its value as written
+QByteArray change(int ms, const char *keyword, double value, ifitlogcatparser::event e, double *last,
+                  bool crlf = false) {
+    const QByteArray number = QByteArray::number(value);
+    last[e] = number.toDouble();
+    return line(ms, "FitPro", QByteArray(keyword) + " " + number, crlf);
+}
+
+/**
+ * @brief A capture like the console writes it, a line every 10ms: mostly the lines of the other apps, and the events
+ * of a workout every second. last gets the last value of each event.
+ */
+QByteArray capture(int seconds, double *last) {
+    QByteArray out;
+    for (int ms = 0; ms < seconds * 1000; ms += 10) {
+        const int s = ms / 1000;
+        switch (ms % 1000) {
+        case 0:
+            out += change(ms, "Changed KPH", 8 + (s % 20) * 0.1, ifitlogcatparser::KPH, last);
+            break;
+        case 100:
+            out += change(ms, "Changed Grade", (s % 7) - 2.5, ifitlogcatparser::GRADE, last, true);
+            break;
+        case 200:
+            out += change(ms, "Changed Watts", 150 + s % 50, ifitlogcatparser::WATTS, last);
+            break;
+        case 300:
+            out += change(ms, "Changed RPM", 80 + s % 15, ifitlogcatparser::RPM, last);
+            break;
+        case 400:
+            out += change(ms, "Changed Resistance", 1 + s % 24, ifitlogcatparser::RESISTANCE, last);
+            break;
+        case 500:
+            out += line(ms, "HeartRateManager",
+                        "HeartRateDataUpdate source BLE zone 2 average 120 bpm " + QByteArray::number(100 + s % 60) +
+                            " max 180");
+            last[ifitlogcatparser::HEART_RATE] = 100 + s % 60;
+            break;
+        default:
+            out += line(ms, "ActivityManager",
+                        "Process com.ifit.standalone (pid 1576) has changed its state, KPH display refreshed",
+                        ms % 30 == 0);
+            break;
+        }
+    }
+    return out;
+}
+
+std::vector<update> changesOf(const QByteArray &capture) {
+    std::vector<update> changes;
+    for (const QByteArray &l : capture.split('\n')) {
+        update c;
+        if (ifitlogcatparser::parseLine(l.constData(), l.size(), &c.e, &c.value))
+            changes.push_back(c);
+    }
+    return changes;
+}
+
+void collect(ifitlogcatparser &parser, std::vector<update> &changes) {
+    const quint32 events = parser.take();
+    for (int e = 0; e < ifitlogcatparser::EVENT_COUNT; e++) {
+        if (ifitlogcatparser::has(events, (ifitlogcatparser::event)e))
+            changes.push_back({(ifitlogcatparser::event)e, parser.value((ifitlogcatparser::event)e)});
+    }
+}
+
+bool waitFor(const std::function<bool()> &condition, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!condition()) {
+        if (timer.elapsed() > timeoutMs)
+            return false;
+        QThread::msleep(1);
+    }
+    return true;
+}
+
+} // namespace
+
+IfitLogcatTestSuite::IfitLogcatTestSuite()
+{
+
+}
+
+void IfitLogcatTestSuite::test_parser() {
+    const struct {
+        const char *line;
+        bool found;
+        ifitlogcatparser::event e;
+        double value;
+    } lines[] = {
+        {"10-18 12:00:00.000  1576  1609 I FitPro: Changed KPH 12.5", true, ifitlogcatparser::KPH, 12.5},
+        {"10-18 12:00:00.000  1576  1609 I FitPro: Changed Grade -3\r", true, ifitlogcatparser::GRADE, -3},
+        {"Changed Watts 210", true, ifitlogcatparser::WATTS, 210},
+        {"I FitPro: Changed RPM 92 ", true, ifitlogcatparser::RPM, 92},
+        {"I FitPro: Changed CurrentGear 7", true, ifitlogcatparser::CURRENT_GEAR, 7},
+        {"I FitPro: Changed Resistance 14", true, ifitlogcatparser::RESISTANCE, 14},
+        {"10-18 12:00:00.000  1576  1609 I HRM: HeartRateDataUpdate source BLE zone 2 average 120 bpm 131 max 180",
+         true, ifitlogcatparser::HEART_RATE, 131},
+        // the heart rate is the 15th field, with more spaces than one between the fields
+        {"10-18   12:00:00.000  1576  1609 I HRM:  HeartRateDataUpdate source BLE zone 2 average 120 bpm  99", true,
+         ifitlogcatparser::HEART_RATE, 99},
+        // a value that's not a number is not a change, the last value is kept
+        {"I FitPro: Changed KPH", false, ifitlogcatparser::KPH, 0},
+        {"I FitPro: Changed KPH n/a", false, ifitlogcatparser::KPH, 0},
+        {"I HRM: HeartRateDataUpdate source BLE", false, ifitlogcatparser::HEART_RATE, 0},
+        {"I FitPro: Changed Speed 12", false, ifitlogcatparser::KPH, 0},
+        {"I FitPro: changed kph 12", false, ifitlogcatparser::KPH, 0},
+        {"I FitPro: \xc3\xa8 Changed \xc3\xa8 KPH 12", false, ifitlogcatparser::KPH, 0},
+        {"", false, ifitlogcatparser::KPH, 0},
+    };
+    for (const auto &l : lines) {
+        ifitlogcatparser::event e = ifitlogcatparser::EVENT_COUNT;
+        double value = 0;
+        EXPECT_EQ(l.found, ifitlogcatparser::parseLine(l.line, (int)strlen(l.line), &e, &value)) << l.line;
+        if (l.found) {
+            EXPECT_EQ(l.e, e) << l.line;
+            EXPECT_DOUBLE_EQ(l.value, value) << l.line;
+        }
+    }
+
+    // the last value of each event
+    ifitlogcatparser parser;
+    parser.feed(QByteArray("Changed KPH 5\nChanged KPH 6\nChanged Grade 1\nChanged KPH x\n"));
+    quint32 events = parser.take();
+    EXPECT_TRUE(ifitlogcatparser::has(events, ifitlogcatparser::KPH));
+    EXPECT_TRUE(ifitlogcatparser::has(events, ifitlogcatparser::GRADE));
+    EXPECT_FALSE(ifitlogcatparser::has(events, ifitlogcatparser::WATTS));
+    EXPECT_DOUBLE_EQ(6, parser.value(ifitlogcatparser::KPH));
+    EXPECT_DOUBLE_EQ(1, parser.value(ifitlogcatparser::GRADE));
+    EXPECT_EQ(0u, parser.take());
+    EXPECT_EQ(4u, parser.lines());
+
+    // the line not ended is kept until its line feed, or finish()
+    parser.feed(QByteArray("Changed Watts 1"));
+    EXPECT_EQ(0u, parser.take());
+    parser.feed(QByteArray("80"));
+    parser.finish();
+    EXPECT_EQ(1u << ifitlogcatparser::WATTS, parser.take());
+    EXPECT_DOUBLE_EQ(180, parser.value(ifitlogcatparser::WATTS));
+
+    // a line too long is dropped, whatever it has, and the next one is parsed
+    QByteArray tooLong(ifitlogcatparser::MAX_LINE, 'x');
+    parser.feed(tooLong.left(100));
+    parser.feed(tooLong.mid(100) + " Changed KPH 20");
+    parser.feed(QByteArray(" more\nChanged KPH 7\n"));
+    EXPECT_EQ(1u << ifitlogcatparser::KPH, parser.take());
+    EXPECT_DOUBLE_EQ(7, parser.value(ifitlogcatparser::KPH));
+    parser.feed(tooLong + "Changed KPH 21\nChanged Grade 2\n");
+    EXPECT_EQ(1u << ifitlogcatparser::GRADE, parser.take());
+    EXPECT_DOUBLE_EQ(7, parser.value(ifitlogcatparser::KPH));
+
+    parser.clear();
+    EXPECT_EQ(0u, parser.lines());
+    EXPECT_DOUBLE_EQ(0, parser.value(ifitlogcatparser::KPH));
+}
+
+void IfitLogcatTestSuite::test_chunks() {
+    double last[ifitlogcatparser::EVENT_COUNT] = {};
+    const QByteArray data = capture(30, last);
+    const std::vector<update> expected = changesOf(data);
+    ASSERT_EQ((size_t)30 * 6, expected.size());
+
+    // a byte at a time: a line at most is completed by each one
+    {
+        ifitlogcatparser parser;
+        std::vector<update> changes;
+        for (int i = 0; i < data.size(); i++) {
+            parser.feed(data.constData() + i, 1);
+            collect(parser, changes);
+        }
+        EXPECT_TRUE(expected == changes);
+        EXPECT_EQ((quint64)data.count('\n'), parser.lines());
+    }
+
+    // split in two anywhere in the first lines
+    for (int split = 0; split < 400; split++) {
+        ifitlogcatparser parser;
+        parser.feed(data.constData(), split);
+        parser.feed(data.constData() + split, data.size() - split);
+        EXPECT_EQ((quint64)data.count('\n'), parser.lines());
+        for (int e = 0; e < ifitlogcatparser::EVENT_COUNT; e++)
+            EXPECT_DOUBLE_EQ(last[e], parser.value((ifitlogcatparser::event)e));
+    }
+
+    // chunks of random sizes, like the reads of adb
+    for (quint32 seed = 1; seed <= 10; seed++) {
+        IfitLogcatReplay replay(data);
+        replay.setChunkSize(1, 1500, seed);
+        ifitlogcatparser parser;
+        const int chunks = replay.replay([&parser](const QByteArray &chunk) { parser.feed(chunk); });
+        EXPECT_GT(chunks, 1);
+        EXPECT_EQ((quint64)data.count('\n'), parser.lines());
+        for (int e = 0; e < ifitlogcatparser::EVENT_COUNT; e++)
+            EXPECT_DOUBLE_EQ(last[e], parser.value((ifitlogcatparser::event)e));
+    }
+
+    EXPECT_EQ(12 * 3600000LL + 61234, IfitLogcatReplay::timestamp("10-18 12:01:01.234  1576", 24));
+    EXPECT_EQ(-1, IfitLogcatReplay::timestamp("--------- beginning of main", 27));
+}
+
+void IfitLogcatTestSuite::test_replay() {
+    if (!QCoreApplication::instance()) {
+        static int argc = 1;
+        static char name[] = "qdomyos-zwift-tests";
+        static char *argv[] = {name, nullptr};
+        new QCoreApplication(argc, argv);
+    }
+
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("IfitLogcatTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::virtual_device_enabled, false);
+    settings.activate();
+
+    double last[ifitlogcatparser::EVENT_COUNT] = {};
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    QFile file(dir.filePath(QStringLiteral("logcat.txt")));
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(capture(20, last));
+    file.close();
+
+    IfitLogcatReplay replay;
+    ASSERT_TRUE(replay.load(file.fileName()));
+    replay.setChunkSize(1, 700);
+
+    // 2 seconds of capture at 20x: at least 100ms
+    {
+        IfitLogcatReplay paced(replay.capture().left(replay.capture().indexOf("12:00:02.000")));
+        paced.setSpeed(20);
+        QElapsedTimer timer;
+        timer.start();
+        ifitlogcatparser parser;
+        paced.replay([&parser](const QByteArray &chunk) { parser.feed(chunk); });
+        EXPECT_GE(timer.elapsed(), 90);
+        EXPECT_DOUBLE_EQ(8.1, parser.value(ifitlogcatparser::KPH));
+    }
+
+    {
+        nordictrackifitadbtreadmill treadmill(false, false);
+        replay.replay([&treadmill](const QByteArray &chunk) { treadmill.logcat(chunk); });
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::KPH], treadmill.currentSpeed().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::GRADE], treadmill.currentInclination().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::HEART_RATE], treadmill.currentHeart().value());
+    }
+
+    {
+        nordictrackifitadbbike bike(false, false, 0, 1);
+        replay.replay([&bike](const QByteArray &chunk) { bike.logcat(chunk); });
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::KPH], bike.currentSpeed().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::GRADE], bike.currentInclination().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::RPM], bike.currentCadence().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::WATTS], bike.wattsMetric().value());
+        EXPECT_DOUBLE_EQ(last[ifitlogcatparser::RESISTANCE], bike.currentResistance().value());
+        EXPECT_DOUBLE_EQ((100 / 32) * last[ifitlogcatparser::RESISTANCE], bike.pelotonResistance().value());
+
+        // once the bike has gears, they are its resistance
+        bike.logcat(line(20000, "FitPro", "Changed CurrentGear 9"));
+        bike.logcat(line(20010, "FitPro", "Changed Resistance 3"));
+        EXPECT_DOUBLE_EQ(9, bike.currentResistance().value());
+        EXPECT_DOUBLE_EQ((100 / 32) * 3, bike.pelotonResistance().value());
+    }
+}
+
+void IfitLogcatTestSuite::test_shell() {
+#if defined(Q_OS_UNIX) && !defined(Q_OS_IOS)
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString output = dir.filePath(QStringLiteral("commands.txt"));
+    auto lines = [&output]() {
+        QFile file(output);
+        return file.open(QIODevice::ReadOnly) ? file.readAll().count('\n') : 0;
+    };
+
+    // sh in place of adb shell
+    ifitadbshell shell(QStringLiteral("sh"), QStringList());
+    EXPECT_EQ(0, shell.starts());
+    for (int i = 0; i < 5; i++)
+        EXPECT_TRUE(shell.send("echo input swipe 100 " + QString::number(i) + " >> " + output));
+    EXPECT_TRUE(waitFor([&]() { return lines() == 5; }, 3000));
+    EXPECT_EQ(1, shell.starts());
+
+    // adb exits, the next command starts it again
+    EXPECT_TRUE(shell.send(QStringLiteral("exit")));
+    QThread::msleep(200);
+    EXPECT_TRUE(shell.send("echo input swipe 100 5 >> " + output));
+    EXPECT_TRUE(waitFor([&]() { return lines() == 6; }, 3000));
+    EXPECT_EQ(2, shell.starts());
+    shell.close();
+
+    ifitadbshell missing(QStringLiteral("qdomyos-zwift-no-such-adb"), QStringList());
+    EXPECT_FALSE(missing.send(QStringLiteral("input swipe 0 0 0 0 200")));
+#endif
+}
+
+void IfitLogcatTestSuite::test_benchmark() {
+    double last[ifitlogcatparser::EVENT_COUNT] = {};
+    const QByteArray data = capture(600, last);
+    const int rounds = 5;
+
+    QElapsedTimer timer;
+    timer.start();
+    double parsed = 0;
+    for (int r = 0; r < rounds; r++) {
+        ifitlogcatparser parser;
+        IfitLogcatReplay replay(data);
+        replay.setChunkSize(1, 4096, r + 1);
+        replay.replay([&parser](const QByteArray &chunk) { parser.feed(chunk); });
+        parsed += parser.value(ifitlogcatparser::KPH);
+    }
+    const qint64 automaton = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    // what the devices did: the lines split in a list, each one searched for each keyword, the value split again
+    static const char *const keywords[] = {"Changed KPH", "Changed Grade", "Changed Watts", "Changed RPM",
+                                           "Changed CurrentGear", "Changed Resistance", "HeartRateDataUpdate"};
+    timer.restart();
+    double split = 0;
+    for (int r = 0; r < rounds; r++) {
+        double kph = 0;
+        const QStringList lines = QString::fromLocal8Bit(data).split('\n');
+        for (const QString &l : lines) {
+            for (const char *keyword : keywords) {
+                if (l.contains(QLatin1String(keyword))) {
+                    if (keyword == keywords[0])
+                        kph = l.split(' ').last().toDouble();
+                    break;
+                }
+            }
+        }
+        split += kph;
+    }
+    const qint64 splitting = qMax<qint64>(1, timer.nsecsElapsed() / 1000);
+
+    EXPECT_DOUBLE_EQ(split, parsed);
+    // bytes per us: MB/s
+    const qint64 bytes = (qint64)data.size() * rounds;
+    RecordProperty("bytes", (int)bytes);
+    RecordProperty("automaton_mb_per_s", (int)(bytes / automaton));
+    RecordProperty("split_mb_per_s", (int)(bytes / splitting));
+}
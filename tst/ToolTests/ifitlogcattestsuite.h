@@ -0,0 +1,58 @@
+#ifndef IFITLOGCATTESTSUITE_H
+#define IFITLOGCATTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class IfitLogcatTestSuite: public testing::Test {
+
+public:
+    IfitLogcatTestSuite();
+
+    /**
+     * @brief Test the events and the values found in single lines, the lines to ignore and the ones too long
+     */
+    void test_parser();
+
+    /**
+     * @brief Test that a capture split anywhere, down to single bytes, gives the same events as its whole lines
+     */
+    void test_chunks();
+
+    /**
+     * @brief Test a capture replayed in random chunks through the treadmill and the bike
+     */
+    void test_replay();
+
+    /**
+     * @brief Test that the adb shell session runs the commands in one process, started again once it exits
+     */
+    void test_shell();
+
+    /**
+     * @brief Measure the throughput of the parser against splitting the lines and searching each keyword, into the
+     * XML report
+     */
+    void test_benchmark();
+};
+
+TEST_F(IfitLogcatTestSuite, TestParser) {
+    this->test_parser();
+}
+
+TEST_F(IfitLogcatTestSuite, TestChunks) {
+    this->test_chunks();
+}
+
+TEST_F(IfitLogcatTestSuite, TestReplay) {
+    this->test_replay();
+}
+
+TEST_F(IfitLogcatTestSuite, TestShell) {
+    this->test_shell();
+}
+
+TEST_F(IfitLogcatTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // IFITLOGCATTESTSUITE_H
@@ -0,0 +1,225 @@
+#include "logwritertestsuite.h"
+
+#include <QFile>
+#include <QStringList>
+#include <QTemporaryDir>
+#include <thread>
+#include <vector>
+#include "logwriter.h"
+
+static QStringList readLines(const QString &filename) {
+    QFile f(filename);
+    if (!f.open(QIODevice::ReadOnly))
+        return QStringList();
+    return QString::fromLocal8Bit(f.readAll()).split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+}
+
+static void log(LogWriter &writer, const QString &msg) {
+    QMessageLogContext context("logwritertestsuite.cpp", 1, "log", "default");
+    writer.enqueue(QtDebugMsg, context, msg);
+}
+
+static quint32 le32(const QByteArray &data, int offset) {
+    return (quint8)data.at(offset) | ((quint8)data.at(offset + 1) << 8) | ((quint8)data.at(offset + 2) << 16) |
+           ((quint32)(quint8)data.at(offset + 3) << 24);
+}
+
+// inflates a gzip member with qUncompress, rebuilding the zlib framing around its deflate data: the zlib trailer is
+// the adler32 of the uncompressed data, so the expected content is needed
+static QByteArray gunzip(const QByteArray &gz, const QByteArray &expected) {
+    const quint32 size = le32(gz, gz.size() - 4);
+    QByteArray zlib;
+    zlib.append((char)(size >> 24)).append((char)(size >> 16)).append((char)(size >> 8)).append((char)size);
+    zlib.append('\x78').append('\x9c').append(gz.mid(10, gz.size() - 18));
+    quint32 a = 1, b = 0;
+    for (char c : expected) {
+        a = (a + (quint8)c) % 65521;
+        b = (b + a) % 65521;
+    }
+    const quint32 adler = (b << 16) | a;
+    zlib.append((char)(adler >> 24)).append((char)(adler >> 16)).append((char)(adler >> 8)).append((char)adler);
+    return qUncompress(zlib);
+}
+
+static quint32 referenceCrc32(const QByteArray &data) {
+    quint32 crc = 0xFFFFFFFFu;
+    for (char c : data) {
+        crc ^= (quint8)c;
+        for (int k = 0; k < 8; k++)
+            crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+LogWriterTestSuite::LogWriterTestSuite()
+{
+
+}
+
+void LogWriterTestSuite::test_producers() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.path() + QStringLiteral("/producers.log");
+
+    LogWriter writer;
+    LogWriter::Options options;
+    ASSERT_TRUE(writer.open(filename, options));
+
+    const int threads = 4;
+    const int lines = 2000;
+    std::vector<std::thread> producers;
+    for (int t = 0; t < threads; t++) {
+        producers.emplace_back([&writer, t, lines]() {
+            for (int i = 0; i < lines; i++)
+                log(writer, QStringLiteral("T%1 L%2").arg(t).arg(i));
+        });
+    }
+    for (auto &p : producers)
+        p.join();
+    writer.stop();
+
+    EXPECT_EQ(0u, writer.dropped());
+    const QStringList written = readLines(filename);
+    ASSERT_EQ(threads * lines, written.count());
+    std::vector<int> next(threads, 0);
+    for (const QString &line : written) {
+        ASSERT_TRUE(line.contains(QStringLiteral("Debug: logwritertestsuite.cpp log T")));
+        const QStringList parts = line.split(QLatin1Char(' '));
+        const int t = parts.at(parts.count() - 2).mid(1).toInt();
+        const int i = parts.last().mid(1).toInt();
+        EXPECT_EQ(next[t], i);
+        next[t] = i + 1;
+    }
+}
+
+void LogWriterTestSuite::test_rotation() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.path() + QStringLiteral("/rotation.log");
+    EXPECT_EQ(dir.path() + QStringLiteral("/rotation.1.log"), LogWriter::rotatedFileName(filename, 1));
+
+    LogWriter writer;
+    LogWriter::Options options;
+    options.maxFileSize = 4096;
+    options.maxRotatedFiles = 2;
+    ASSERT_TRUE(writer.open(filename, options));
+    for (int i = 0; i < 2000; i++)
+        log(writer, QStringLiteral("rotation line %1 ").arg(i) + QString(40, QLatin1Char('x')));
+    writer.stop();
+
+    EXPECT_LE(QFile(filename).size(), 2 * LogWriter::FLUSH_BYTES);
+    EXPECT_TRUE(QFile::exists(LogWriter::rotatedFileName(filename, 1)));
+    EXPECT_TRUE(QFile::exists(LogWriter::rotatedFileName(filename, 2)));
+    EXPECT_FALSE(QFile::exists(LogWriter::rotatedFileName(filename, 3)));
+
+    // the most recent rotated file ends right before the first line of the current one
+    const QStringList rotated = readLines(LogWriter::rotatedFileName(filename, 1));
+    const QStringList current = readLines(filename);
+    ASSERT_FALSE(rotated.isEmpty());
+    ASSERT_FALSE(current.isEmpty());
+    const QString marker = QStringLiteral("rotation line ");
+    const int lastRotated = rotated.last().section(marker, 1).section(QLatin1Char(' '), 0, 0).toInt();
+    const int firstCurrent = current.first().section(marker, 1).section(QLatin1Char(' '), 0, 0).toInt();
+    EXPECT_EQ(lastRotated + 1, firstCurrent);
+
+    // compressed rotation
+    const QString compressedName = dir.path() + QStringLiteral("/compressed.log");
+    LogWriter compressed;
+    options.compressRotated = true;
+    ASSERT_TRUE(compressed.open(compressedName, options));
+    for (int i = 0; i < 2000; i++)
+        log(compressed, QStringLiteral("rotation line %1 ").arg(i) + QString(40, QLatin1Char('x')));
+    compressed.stop();
+
+    const QString gzName = LogWriter::rotatedFileName(compressedName, 1) + QStringLiteral(".gz");
+    EXPECT_FALSE(QFile::exists(LogWriter::rotatedFileName(compressedName, 1)));
+    QFile gz(gzName);
+    ASSERT_TRUE(gz.open(QIODevice::ReadOnly));
+    const QByteArray gzData = gz.readAll();
+    ASSERT_GT(gzData.size(), 18);
+    EXPECT_EQ('\x1f', gzData.at(0));
+    EXPECT_EQ('\x8b', gzData.at(1));
+    EXPECT_GT(le32(gzData, gzData.size() - 4), (quint32)gzData.size());
+    EXPECT_TRUE(QFile::exists(LogWriter::rotatedFileName(compressedName, 2) + QStringLiteral(".gz")));
+}
+
+void LogWriterTestSuite::test_dropPolicy() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.path() + QStringLiteral("/drop.log");
+
+    LogWriter writer;
+    LogWriter::Options options;
+    options.capacity = 8;
+    ASSERT_TRUE(writer.open(filename, options));
+    const int total = 5000;
+    int accepted = 0;
+    for (int i = 0; i < total; i++) {
+        QMessageLogContext context("logwritertestsuite.cpp", 1, "drop", "default");
+        if (writer.enqueue(QtDebugMsg, context, QStringLiteral("drop %1").arg(i)))
+            accepted++;
+    }
+    writer.stop();
+
+    EXPECT_EQ((quint64)total, writer.written() + writer.dropped());
+    EXPECT_EQ((quint64)accepted, writer.written());
+    // every drop is reported in the log, possibly over several lines
+    quint64 reported = 0;
+    int lines = 0;
+    for (const QString &line : readLines(filename)) {
+        if (line.contains(QStringLiteral("log lines dropped")))
+            reported += line.section(QStringLiteral("LogWriter "), 1).section(QLatin1Char(' '), 0, 0).toULongLong();
+        else
+            lines++;
+    }
+    EXPECT_EQ(writer.dropped(), reported);
+    EXPECT_EQ(accepted, lines);
+
+    // after stop() the lines are written synchronously
+    log(writer, QStringLiteral("after stop"));
+    EXPECT_TRUE(readLines(filename).last().endsWith(QStringLiteral("after stop")));
+}
+
+void LogWriterTestSuite::test_gzip() {
+    QByteArray data;
+    for (int i = 0; i < 1000; i++)
+        data.append(QByteArray::number(i * 7919)).append('\n');
+
+    const QByteArray gz = LogWriter::gzip(data);
+    ASSERT_GT(gz.size(), 18);
+    EXPECT_EQ('\x1f', gz.at(0));
+    EXPECT_EQ('\x8b', gz.at(1));
+    EXPECT_EQ(8, gz.at(2));
+    EXPECT_LT(gz.size(), data.size());
+    EXPECT_EQ(referenceCrc32(data), le32(gz, gz.size() - 8));
+    EXPECT_EQ((quint32)data.size(), le32(gz, gz.size() - 4));
+    EXPECT_EQ(data, gunzip(gz, data));
+}
+
+void LogWriterTestSuite::test_gzipFile() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString from = dir.path() + QStringLiteral("/big.log");
+    const QString to = from + QStringLiteral(".gz");
+    QByteArray data;
+    for (int i = 0; i < 3000; i++)
+        data.append(QByteArray::number(i * 7919)).append('\n');
+    {
+        QFile f(from);
+        ASSERT_TRUE(f.open(QIODevice::WriteOnly));
+        f.write(data);
+    }
+
+    // a member per chunk of the file, the last one shorter
+    const int chunk = 4096;
+    ASSERT_TRUE(LogWriter::gzipFile(from, to, chunk));
+    QByteArray expected;
+    for (int pos = 0; pos < data.size(); pos += chunk)
+        expected.append(LogWriter::gzip(data.mid(pos, chunk)));
+    QFile gz(to);
+    ASSERT_TRUE(gz.open(QIODevice::ReadOnly));
+    EXPECT_EQ(expected, gz.readAll());
+    EXPECT_GT(data.size() % chunk, 0);
+
+    EXPECT_FALSE(LogWriter::gzipFile(dir.path() + QStringLiteral("/missing.log"), to, chunk));
+}
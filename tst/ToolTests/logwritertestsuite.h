@@ -0,0 +1,57 @@
+#ifndef LOGWRITERTESTSUITE_H
+#define LOGWRITERTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class LogWriterTestSuite: public testing::Test {
+
+public:
+    LogWriterTestSuite();
+
+    /**
+     * @brief Test that the lines of several producer threads are all written, each thread's in order
+     */
+    void test_producers();
+
+    /**
+     * @brief Test that the log is rotated at the maximum size, keeping the configured number of gzipped files
+     */
+    void test_rotation();
+
+    /**
+     * @brief Test that a full queue drops lines, counts them, and reports them in the log
+     */
+    void test_dropPolicy();
+
+    /**
+     * @brief Test that the gzip output is a valid gzip member of the input
+     */
+    void test_gzip();
+
+    /**
+     * @brief Test that a file is compressed a chunk at a time, in a gzip member per chunk
+     */
+    void test_gzipFile();
+};
+
+TEST_F(LogWriterTestSuite, TestProducers) {
+    this->test_producers();
+}
+
+TEST_F(LogWriterTestSuite, TestRotation) {
+    this->test_rotation();
+}
+
+TEST_F(LogWriterTestSuite, TestDropPolicy) {
+    this->test_dropPolicy();
+}
+
+TEST_F(LogWriterTestSuite, TestGzip) {
+    this->test_gzip();
+}
+
+TEST_F(LogWriterTestSuite, TestGzipFile) {
+    this->test_gzipFile();
+}
+
+#endif // LOGWRITERTESTSUITE_H
@@ -0,0 +1,112 @@
+#include "metrictestsuite.h"
+
+#include <QThread>
+#include "metric.h"
+
+MetricTestSuite::MetricTestSuite()
+{
+
+}
+
+void MetricTestSuite::test_windowExpiry() {
+    metric m;
+    m.setWindowDuration(metric::WINDOW_3S, 100);
+    m.setValue(100, false);
+    m.setValue(200, false);
+    EXPECT_DOUBLE_EQ(150, m.averageWindow(metric::WINDOW_3S));
+
+    // the window ends at the last sample: the first two expire when the third comes
+    QThread::msleep(250);
+    EXPECT_DOUBLE_EQ(150, m.averageWindow(metric::WINDOW_3S));
+    m.setValue(600, false);
+    EXPECT_DOUBLE_EQ(600, m.averageWindow(metric::WINDOW_3S));
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_5S));
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_30S));
+    EXPECT_DOUBLE_EQ(300, m.average5s());
+
+    // zeros aren't samples
+    m.setValue(0, false);
+    EXPECT_DOUBLE_EQ(600, m.averageWindow(metric::WINDOW_3S));
+
+    m.clear(false);
+    for (int w = 0; w < metric::WINDOW_COUNT; w++)
+        EXPECT_DOUBLE_EQ(0, m.averageWindow((metric::_metric_window)w));
+    EXPECT_DOUBLE_EQ(0, m.averageWindow(metric::WINDOW_COUNT));
+}
+
+void MetricTestSuite::test_windowDuration() {
+    metric m;
+    m.setValue(100, false);
+    m.setValue(200, false);
+    QThread::msleep(250);
+    m.setValue(600, false);
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_10S));
+
+    // shorter: the samples kept older than the window leave it, longer: they come back
+    m.setWindowDuration(metric::WINDOW_10S, 100);
+    EXPECT_DOUBLE_EQ(600, m.averageWindow(metric::WINDOW_10S));
+    m.setWindowDuration(metric::WINDOW_10S, 60000);
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_10S));
+    // the other windows don't change
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_3S));
+
+    // not a duration, not a window
+    m.setWindowDuration(metric::WINDOW_10S, 0);
+    m.setWindowDuration(metric::WINDOW_COUNT, 100);
+    EXPECT_DOUBLE_EQ(300, m.averageWindow(metric::WINDOW_10S));
+
+    // a window set before the first sample
+    metric empty;
+    empty.setWindowDuration(metric::WINDOW_30S, 100);
+    EXPECT_DOUBLE_EQ(0, empty.averageWindow(metric::WINDOW_30S));
+    empty.setValue(50, false);
+    EXPECT_DOUBLE_EQ(50, empty.averageWindow(metric::WINDOW_30S));
+}
+
+void MetricTestSuite::test_runningSums() {
+    // a sample every few microseconds: every window holds the whole ring, which wraps 12 times
+    metric m;
+    const int samples = metric::RING_CAPACITY * 12 + 7;
+    for (int i = 1; i <= samples; i++) {
+        m.setValue(i % 97 + 0.25, false);
+        if (i % 101 && i != samples)
+            continue;
+        const int kept = qMin(i, (int)metric::RING_CAPACITY);
+        double sum = 0;
+        for (int k = i - kept + 1; k <= i; k++)
+            sum += k % 97 + 0.25;
+        for (int w = 0; w < metric::WINDOW_COUNT; w++)
+            ASSERT_NEAR(sum / kept, m.averageWindow((metric::_metric_window)w), 1e-9) << "sample " << i;
+        double last5 = 0;
+        for (int k = i - qMin(i, 5) + 1; k <= i; k++)
+            last5 += k % 97 + 0.25;
+        ASSERT_NEAR(last5 / qMin(i, 5), m.average5s(), 1e-9) << "sample " << i;
+    }
+    EXPECT_EQ(metric::RING_CAPACITY, m.allocatedSamples());
+}
+
+void MetricTestSuite::test_allocation() {
+    metric m;
+    EXPECT_EQ(0, m.allocatedSamples());
+    m.setValue(0, false);
+    EXPECT_EQ(0, m.allocatedSamples());
+    const metric before = m;
+
+    m.setValue(10, false);
+    EXPECT_EQ(metric::RING_CAPACITY, m.allocatedSamples());
+    EXPECT_EQ(0, before.allocatedSamples());
+    EXPECT_DOUBLE_EQ(0, before.averageWindow(metric::WINDOW_3S));
+
+    // a copy reads the same samples, and keeps them when the original goes on
+    const metric copy = m;
+    EXPECT_EQ(metric::RING_CAPACITY, copy.allocatedSamples());
+    m.setValue(30, false);
+    EXPECT_DOUBLE_EQ(20, m.averageWindow(metric::WINDOW_3S));
+    EXPECT_DOUBLE_EQ(10, copy.averageWindow(metric::WINDOW_3S));
+
+    // clear() keeps the ring for the next samples
+    m.clear(false);
+    EXPECT_EQ(metric::RING_CAPACITY, m.allocatedSamples());
+    m.setValue(40, false);
+    EXPECT_DOUBLE_EQ(40, m.averageWindow(metric::WINDOW_3S));
+}
@@ -0,0 +1,48 @@
+#ifndef METRICTESTSUITE_H
+#define METRICTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class MetricTestSuite: public testing::Test {
+
+public:
+    MetricTestSuite();
+
+    /**
+     * @brief Test that the samples older than a window, by the steady clock, leave its average
+     */
+    void test_windowExpiry();
+
+    /**
+     * @brief Test that changing the duration of a window recomputes it from the samples kept
+     */
+    void test_windowDuration();
+
+    /**
+     * @brief Test that the running sums match the samples of the ring after it wrapped many times
+     */
+    void test_runningSums();
+
+    /**
+     * @brief Test that the ring is allocated at the first sample and shared by the copies until they change
+     */
+    void test_allocation();
+};
+
+TEST_F(MetricTestSuite, TestWindowExpiry) {
+    this->test_windowExpiry();
+}
+
+TEST_F(MetricTestSuite, TestWindowDuration) {
+    this->test_windowDuration();
+}
+
+TEST_F(MetricTestSuite, TestRunningSums) {
+    this->test_runningSums();
+}
+
+TEST_F(MetricTestSuite, TestAllocation) {
+    this->test_allocation();
+}
+
+#endif // METRICTESTSUITE_H
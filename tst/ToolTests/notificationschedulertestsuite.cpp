@@ -0,0 +1,250 @@
+#include "notificationschedulertestsuite.h"
+
+#include <QPointer>
+#include <memory>
+#include "Tools/testapplication.h"
+#include "Tools/testsettings.h"
+#include "characteristics/characteristicnotificationscheduler.h"
+#include "characteristics/characteristicnotifier2a37.h"
+#include "characteristics/characteristicnotifier2ad2.h"
+#include "devices/bike.h"
+#include "qzsettings.h"
+#include "qzsettingssnapshot.h"
+
+namespace {
+
+// a bike publishing the values the test gives it
+class publishingbike : public bike {
+  public:
+    void publish(double watts) {
+        m_watt.setValue(watts, false);
+        Cadence.setValue(80, false);
+        publishTelemetry();
+    }
+};
+
+// the power of the device in a byte, with the encodes counted
+class countingnotifier : public CharacteristicNotifier {
+    bluetoothdevice *device;
+
+  public:
+    countingnotifier(quint16 uuid, bluetoothdevice *device) : CharacteristicNotifier(uuid), device(device) {}
+    int notify(QByteArray &out) override {
+        encodes++;
+        if (invalid)
+            return CN_INVALID;
+        out.append((char)((int)device->wattsMetric().value() & 0xFF));
+        return CN_OK;
+    }
+    int encodes = 0;
+    bool invalid = false;
+};
+
+// the payloads of a characteristic in the batches of the ticks from 0 to durationMs
+int sentDuring(CharacteristicNotificationScheduler &scheduler, quint16 uuid, qint64 fromMs, qint64 durationMs,
+               int stepMs, publishingbike *device = nullptr, int *heartbeats = nullptr) {
+    int sent = 0;
+    for (qint64 now = fromMs; now < fromMs + durationMs; now += stepMs) {
+        if (device)
+            device->publish(100 + now / stepMs);
+        const CharacteristicNotificationBatch &batch = scheduler.process(now);
+        if (batch.find(uuid))
+            sent++;
+        if (heartbeats && batch.heartbeat())
+            (*heartbeats)++;
+    }
+    return sent;
+}
+
+} // namespace
+
+NotificationSchedulerTestSuite::NotificationSchedulerTestSuite()
+{
+
+}
+
+void NotificationSchedulerTestSuite::test_rates() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("NotificationSchedulerTestSuite"));
+    settings.qsettings.clear();
+    settings.activate();
+
+    std::unique_ptr<publishingbike> device(new publishingbike());
+    device->publish(100);
+    CharacteristicNotificationScheduler scheduler(device.get());
+    EXPECT_EQ(scheduler.tickMs(), 250);
+    EXPECT_EQ(scheduler.heartbeatMs(), 1000);
+    scheduler.add(new countingnotifier(0x2AD2, device.get()));
+    scheduler.add(new countingnotifier(0x2ACC, device.get()));
+
+    // a new power at every tick: 4 notifications per second, the feature and the heartbeat once per second
+    int heartbeats = 0;
+    EXPECT_EQ(sentDuring(scheduler, 0x2AD2, 0, 3000, 250, device.get(), &heartbeats), 12);
+    EXPECT_EQ(heartbeats, 3);
+    scheduler.setRate(0x2AD2, 250, 1000);
+    EXPECT_EQ(sentDuring(scheduler, 0x2ACC, 3000, 3000, 250, device.get()), 3);
+
+    // a late timer: a tick is on time within half a tick
+    EXPECT_EQ(sentDuring(scheduler, 0x2AD2, 6010, 3000, 250, device.get()), 12);
+
+    // in race mode the pace of the old timers
+    settings.qsettings.setValue(QZSettings::race_mode, true);
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+    CharacteristicNotificationScheduler race(device.get());
+    EXPECT_EQ(race.tickMs(), 100);
+    EXPECT_EQ(race.heartbeatMs(), 100);
+    race.add(new countingnotifier(0x2AD2, device.get()));
+    heartbeats = 0;
+    EXPECT_EQ(sentDuring(race, 0x2AD2, 0, 1000, 100, device.get(), &heartbeats), 10);
+    EXPECT_EQ(heartbeats, 10);
+}
+
+void NotificationSchedulerTestSuite::test_unchanged() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("NotificationSchedulerTestSuite"));
+    settings.qsettings.clear();
+    settings.activate();
+    std::unique_ptr<publishingbike> device(new publishingbike());
+    device->publish(100);
+    CharacteristicNotificationScheduler scheduler(device.get());
+    countingnotifier *notifier = new countingnotifier(0x2AD2, device.get());
+    scheduler.add(notifier);
+
+    // no new values: encoded and sent at the keep alive only
+    EXPECT_EQ(sentDuring(scheduler, 0x2AD2, 0, 3000, scheduler.tickMs()), 3);
+    EXPECT_EQ(notifier->encodes, 3);
+    EXPECT_EQ(scheduler.stats(0x2AD2).idle, 9u);
+
+    // new values, the same payload: encoded at every tick, sent at the keep alive only
+    int sent = 0;
+    for (qint64 now = 3000; now < 6000; now += scheduler.tickMs()) {
+        device->publish(100);
+        if (scheduler.process(now).find(0x2AD2))
+            sent++;
+    }
+    EXPECT_EQ(sent, 3);
+    EXPECT_EQ(notifier->encodes, 15);
+    EXPECT_EQ(scheduler.stats(0x2AD2).unchanged, 9u);
+
+    // a change is sent at the next tick
+    device->publish(120);
+    EXPECT_NE(scheduler.process(6000).find(0x2AD2), nullptr);
+    device->publish(121);
+    const QByteArray *value = scheduler.process(6000 + scheduler.tickMs()).find(0x2AD2);
+    ASSERT_NE(value, nullptr);
+    EXPECT_EQ((uchar)value->at(0), 121);
+    EXPECT_EQ(scheduler.stats(0x2AD2).sent, 8u);
+}
+
+void NotificationSchedulerTestSuite::test_shared() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("NotificationSchedulerTestSuite"));
+    settings.qsettings.clear();
+    settings.activate();
+    std::unique_ptr<publishingbike> device(new publishingbike());
+    device->publish(100);
+    CharacteristicNotificationScheduler scheduler(device.get());
+
+    // the notifier of the second transport is dropped, the first one encodes for both
+    countingnotifier *first = new countingnotifier(0x2AD2, device.get());
+    QPointer<countingnotifier> second = new countingnotifier(0x2AD2, device.get());
+    scheduler.add(first);
+    scheduler.add(second);
+    EXPECT_TRUE(second.isNull());
+    EXPECT_TRUE(scheduler.contains(0x2AD2));
+    EXPECT_FALSE(scheduler.contains(0x2A37));
+
+    // every slot gets the same payload, encoded once
+    int received = 0;
+    const QByteArray *payloads[2] = {nullptr, nullptr};
+    for (int i = 0; i < 2; i++) {
+        QObject::connect(&scheduler, &CharacteristicNotificationScheduler::notificationsReady,
+                         [&received, &payloads, i](const CharacteristicNotificationBatch &batch) {
+                             payloads[i] = batch.find(0x2AD2);
+                             received++;
+                         });
+    }
+    const CharacteristicNotificationBatch &batch = scheduler.process(0);
+    emit scheduler.notificationsReady(batch);
+    EXPECT_EQ(received, 2);
+    ASSERT_NE(payloads[0], nullptr);
+    EXPECT_EQ(payloads[0], payloads[1]);
+    EXPECT_EQ(first->encodes, 1);
+
+    // a notifier without a value doesn't slow the others down and is tried again at the keep alive
+    countingnotifier *invalid = new countingnotifier(0x2AD9, device.get());
+    invalid->invalid = true;
+    scheduler.add(invalid);
+    int sent = 0;
+    for (qint64 now = 250; now < 3250; now += 250) {
+        device->publish(100 + now);
+        const CharacteristicNotificationBatch &b = scheduler.process(now);
+        EXPECT_EQ(b.find(0x2AD9), nullptr);
+        if (b.find(0x2AD2))
+            sent++;
+    }
+    EXPECT_EQ(sent, 12);
+    EXPECT_EQ(invalid->encodes, 3);
+}
+
+void NotificationSchedulerTestSuite::test_clients() {
+    ensureApplication();
+    std::unique_ptr<publishingbike> device(new publishingbike());
+    CharacteristicNotificationScheduler scheduler(device.get());
+    EXPECT_TRUE(scheduler.clients().isEmpty());
+
+    scheduler.delivered(QStringLiteral("bluetooth"), 2, 30);
+    scheduler.delivered(QStringLiteral("dircon 192.168.1.2:36866"), 3, 60);
+    scheduler.delivered(QStringLiteral("bluetooth"), 1, 19);
+    ASSERT_EQ(scheduler.clients().count(), 2);
+    const NotificationClientStats bluetooth = scheduler.clients().value(QStringLiteral("bluetooth"));
+    EXPECT_EQ(bluetooth.notifications, 3u);
+    EXPECT_EQ(bluetooth.bytes, 49u);
+    EXPECT_GT(bluetooth.lastNs, 0);
+    EXPECT_EQ(scheduler.clients().value(QStringLiteral("dircon 192.168.1.2:36866")).bytes, 60u);
+
+    // a characteristic not scheduled has no statistics
+    EXPECT_EQ(scheduler.stats(0x2A63).encodes, 0u);
+}
+
+void NotificationSchedulerTestSuite::test_hour() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("NotificationSchedulerTestSuite"));
+    settings.qsettings.clear();
+    settings.activate();
+    std::unique_ptr<publishingbike> device(new publishingbike());
+    device->publish(100);
+    const int seconds = 3600;
+    const int transports = 2;
+
+    // before: a timer for each transport at 1 Hz, every characteristic encoded by each of them
+    CharacteristicNotifier2AD2 notif2AD2(device.get());
+    CharacteristicNotifier2A37 notif2A37(device.get());
+    QByteArray value;
+    quint64 before = 0;
+    for (int s = 0; s < seconds; s++) {
+        device->publish(100 + (s % 10));
+        for (int t = 0; t < transports; t++) {
+            value.clear();
+            before += notif2AD2.notify(value) == CN_OK;
+            value.clear();
+            before += notif2A37.notify(value) == CN_OK;
+        }
+    }
+
+    // after: one scheduler at 4 Hz for both, a new power every second and a constant heart rate
+    CharacteristicNotificationScheduler scheduler(device.get());
+    scheduler.add(new CharacteristicNotifier2AD2(device.get()));
+    scheduler.add(new CharacteristicNotifier2A37(device.get()));
+    quint64 sent = 0;
+    for (qint64 now = 0; now < seconds * 1000; now += scheduler.tickMs()) {
+        if (now % 1000 == 0)
+            device->publish(100 + ((now / 1000) % 10));
+        sent += scheduler.process(now).count();
+    }
+    const quint64 after = scheduler.stats(0x2AD2).encodes + scheduler.stats(0x2A37).encodes;
+
+    EXPECT_LT(after, before);
+    EXPECT_EQ(scheduler.stats(0x2A37).sent, (quint64)seconds);
+    EXPECT_EQ(sent, scheduler.stats(0x2AD2).sent + scheduler.stats(0x2A37).sent);
+}
@@ -0,0 +1,61 @@
+#ifndef NOTIFICATIONSCHEDULERTESTSUITE_H
+#define NOTIFICATIONSCHEDULERTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class NotificationSchedulerTestSuite: public testing::Test {
+
+public:
+    NotificationSchedulerTestSuite();
+
+    /**
+     * @brief Test the rates: 4 notifications per second for a changing power, the static characteristics and the
+     * heartbeat once per second
+     */
+    void test_rates();
+
+    /**
+     * @brief Test that nothing is encoded without new values from the device, and nothing sent when the payload is
+     * the same, except at the keep alive
+     */
+    void test_unchanged();
+
+    /**
+     * @brief Test that a characteristic is encoded once for all the transports, and that a notifier without a value
+     * is tried again at the keep alive
+     */
+    void test_shared();
+
+    /**
+     * @brief Test the statistics of the clients of the transports
+     */
+    void test_clients();
+
+    /**
+     * @brief Test an hour of a ride: fewer encodes than a timer with an encode for each transport, and the heart rate
+     * sent every second
+     */
+    void test_hour();
+};
+
+TEST_F(NotificationSchedulerTestSuite, TestRates) {
+    this->test_rates();
+}
+
+TEST_F(NotificationSchedulerTestSuite, TestUnchanged) {
+    this->test_unchanged();
+}
+
+TEST_F(NotificationSchedulerTestSuite, TestShared) {
+    this->test_shared();
+}
+
+TEST_F(NotificationSchedulerTestSuite, TestClients) {
+    this->test_clients();
+}
+
+TEST_F(NotificationSchedulerTestSuite, TestHour) {
+    this->test_hour();
+}
+
+#endif // NOTIFICATIONSCHEDULERTESTSUITE_H
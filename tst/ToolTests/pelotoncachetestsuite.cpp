@@ -0,0 +1,297 @@
+#include "pelotoncachetestsuite.h"
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTemporaryDir>
+#include <QThread>
+#include "pelotoncache.h"
+
+namespace {
+
+QByteArray ridePayload(int cues, int seed) {
+    QJsonArray instructor_cues;
+    for (int i = 0; i < cues; i++) {
+        QJsonObject cue;
+        cue[QStringLiteral("offsets")] =
+            QJsonObject{{QStringLiteral("start"), i * 30}, {QStringLiteral("end"), i * 30 + 29}};
+        cue[QStringLiteral("resistance_range")] = QJsonObject{{QStringLiteral("lower"), 30 + (i + seed) % 20},
+                                                              {QStringLiteral("upper"), 40 + (i + seed) % 20}};
+        cue[QStringLiteral("cadence_range")] =
+            QJsonObject{{QStringLiteral("lower"), 80 + i % 10}, {QStringLiteral("upper"), 90 + i % 10}};
+        instructor_cues.append(cue);
+    }
+    QJsonObject ride;
+    ride[QStringLiteral("instructor_cues")] = instructor_cues;
+    return QJsonDocument(ride).toJson(QJsonDocument::Compact);
+}
+
+// the walk of peloton::ride_onfinish, without a device
+QList<trainrow> convert(const QByteArray &payload) {
+    QList<trainrow> rows;
+    const QJsonArray cues = QJsonDocument::fromJson(payload).object()[QStringLiteral("instructor_cues")].toArray();
+    for (int i = 0; i < cues.count(); i++) {
+        const QJsonObject cue = cues.at(i).toObject();
+        const QJsonObject offsets = cue[QStringLiteral("offsets")].toObject();
+        const QJsonObject resistance = cue[QStringLiteral("resistance_range")].toObject();
+        const QJsonObject cadence = cue[QStringLiteral("cadence_range")].toObject();
+        trainrow r;
+        r.lower_requested_peloton_resistance = resistance[QStringLiteral("lower")].toInt();
+        r.upper_requested_peloton_resistance = resistance[QStringLiteral("upper")].toInt();
+        r.average_requested_peloton_resistance =
+            (r.lower_requested_peloton_resistance + r.upper_requested_peloton_resistance) / 2;
+        r.lower_cadence = cadence[QStringLiteral("lower")].toInt();
+        r.upper_cadence = cadence[QStringLiteral("upper")].toInt();
+        r.average_cadence = (r.lower_cadence + r.upper_cadence) / 2;
+        r.requested_peloton_resistance = r.lower_requested_peloton_resistance;
+        r.cadence = r.lower_cadence;
+        r.duration = QTime(0, 0, 0).addSecs(offsets[QStringLiteral("end")].toInt() -
+                                            offsets[QStringLiteral("start")].toInt() + (i ? 1 : 0));
+        rows.append(r);
+    }
+    return rows;
+}
+
+void expectSameRows(const QList<trainrow> &expected, const QList<trainrow> &actual) {
+    ASSERT_EQ(expected.count(), actual.count());
+    for (int i = 0; i < expected.count(); i++) {
+        const trainrow &e = expected.at(i);
+        const trainrow &a = actual.at(i);
+        EXPECT_EQ(e.duration, a.duration);
+        EXPECT_EQ(e.started, a.started);
+        EXPECT_DOUBLE_EQ(e.speed, a.speed);
+        EXPECT_DOUBLE_EQ(e.inclination, a.inclination);
+        EXPECT_EQ(e.resistance, a.resistance);
+        EXPECT_EQ(e.average_resistance, a.average_resistance);
+        EXPECT_EQ(e.requested_peloton_resistance, a.requested_peloton_resistance);
+        EXPECT_EQ(e.upper_requested_peloton_resistance, a.upper_requested_peloton_resistance);
+        EXPECT_EQ(e.pace_intensity, a.pace_intensity);
+        EXPECT_EQ(e.cadence, a.cadence);
+        EXPECT_EQ(e.upper_cadence, a.upper_cadence);
+        EXPECT_EQ(e.forcespeed, a.forcespeed);
+        EXPECT_EQ(e.power, a.power);
+        EXPECT_EQ(e.rampDuration, a.rampDuration);
+        EXPECT_EQ(e.rampElapsed, a.rampElapsed);
+        EXPECT_EQ(qIsNaN(e.latitude), qIsNaN(a.latitude));
+    }
+}
+
+int countFiles(const QString &dir) { return QDir(dir).entryList(QDir::Files).count(); }
+
+} // namespace
+
+PelotonCacheTestSuite::PelotonCacheTestSuite()
+{
+
+}
+
+void PelotonCacheTestSuite::test_payloads() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QByteArray ride = ridePayload(10, 0);
+    const QByteArray instructor = QByteArrayLiteral("{\"name\":\"Matt Wilpers\"}");
+
+    {
+        pelotoncache cache(dir.path());
+        QByteArray data;
+        EXPECT_FALSE(cache.payload(QStringLiteral("ride/1"), &data));
+        EXPECT_FALSE(cache.contains(QStringLiteral("ride/1")));
+
+        EXPECT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+        EXPECT_TRUE(cache.setPayload(QStringLiteral("instructor/1"), instructor));
+        // the same content under another key
+        EXPECT_TRUE(cache.setPayload(QStringLiteral("performance/1"), ride));
+        EXPECT_EQ(3, cache.count());
+        EXPECT_EQ(2, countFiles(dir.path() + QStringLiteral("/objects")));
+
+        EXPECT_TRUE(cache.payload(QStringLiteral("ride/1"), &data));
+        EXPECT_EQ(ride, data);
+    }
+
+    // another run of the app
+    pelotoncache cache(dir.path());
+    EXPECT_EQ(3, cache.count());
+    QByteArray data;
+    EXPECT_TRUE(cache.payload(QStringLiteral("instructor/1"), &data));
+    EXPECT_EQ(instructor, data);
+    EXPECT_TRUE(cache.payload(QStringLiteral("performance/1"), &data));
+    EXPECT_EQ(ride, data);
+
+    // the same payload again doesn't write anything
+    const QDateTime modified = QFileInfo(dir.path() + QStringLiteral("/index.dat")).lastModified();
+    QThread::msleep(20);
+    EXPECT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+    EXPECT_EQ(modified, QFileInfo(dir.path() + QStringLiteral("/index.dat")).lastModified());
+
+    // a payload changing
+    const QByteArray changed = ridePayload(10, 1);
+    EXPECT_TRUE(cache.setPayload(QStringLiteral("ride/1"), changed));
+    EXPECT_TRUE(cache.payload(QStringLiteral("ride/1"), &data));
+    EXPECT_EQ(changed, data);
+    EXPECT_TRUE(cache.payload(QStringLiteral("performance/1"), &data));
+    EXPECT_EQ(ride, data);
+}
+
+void PelotonCacheTestSuite::test_trainrows() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    pelotoncache cache(dir.path());
+    const QByteArray ride = ridePayload(20, 0);
+    const QByteArray bike = QByteArrayLiteral("bike, lower");
+    const QByteArray treadmill = QByteArrayLiteral("treadmill, lower");
+
+    QList<trainrow> rows = convert(ride);
+    // every kind of field
+    rows[0].started = QDateTime(QDate(2026, 10, 18), QTime(7, 30), Qt::UTC);
+    rows[1].speed = 10.5;
+    rows[1].inclination = -2.5;
+    rows[1].forcespeed = true;
+    rows[2].power = 250;
+    rows[2].rampDuration = QTime(0, 1, 10);
+    rows[2].rampElapsed = QTime(0, 0, 5);
+    rows[3].pace_intensity = 3;
+    rows[3].latitude = 45.5;
+
+    QList<trainrow> read;
+    // not without the payload they come from
+    EXPECT_FALSE(cache.setTrainrows(QStringLiteral("ride/1"), bike, rows));
+    EXPECT_FALSE(cache.trainrows(QStringLiteral("ride/1"), bike, &read));
+
+    ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+    EXPECT_FALSE(cache.trainrows(QStringLiteral("ride/1"), bike, &read));
+    ASSERT_TRUE(cache.setTrainrows(QStringLiteral("ride/1"), bike, rows));
+    ASSERT_TRUE(cache.trainrows(QStringLiteral("ride/1"), bike, &read));
+    expectSameRows(rows, read);
+
+    // another device, or other settings
+    EXPECT_FALSE(cache.trainrows(QStringLiteral("ride/1"), treadmill, &read));
+
+    // the class changed since
+    ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ridePayload(20, 1)));
+    EXPECT_FALSE(cache.trainrows(QStringLiteral("ride/1"), bike, &read));
+
+    // and back: the rows of the first content are still there
+    ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+    EXPECT_TRUE(cache.trainrows(QStringLiteral("ride/1"), bike, &read));
+
+    // empty
+    ASSERT_TRUE(cache.setTrainrows(QStringLiteral("ride/1"), treadmill, QList<trainrow>()));
+    EXPECT_TRUE(cache.trainrows(QStringLiteral("ride/1"), treadmill, &read));
+    EXPECT_TRUE(read.isEmpty());
+}
+
+void PelotonCacheTestSuite::test_corrupt() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QByteArray ride = ridePayload(20, 0);
+    const QList<trainrow> rows = convert(ride);
+    const QByteArray context = QByteArrayLiteral("bike");
+
+    {
+        pelotoncache cache(dir.path());
+        ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+        ASSERT_TRUE(cache.setTrainrows(QStringLiteral("ride/1"), context, rows));
+    }
+
+    // truncated rows
+    const QString rowsDir = dir.path() + QStringLiteral("/rows");
+    const QString rowsFile = rowsDir + QLatin1Char('/') + QDir(rowsDir).entryList(QDir::Files).first();
+    QFile file(rowsFile);
+    ASSERT_TRUE(file.open(QIODevice::ReadOnly));
+    const QByteArray content = file.readAll();
+    file.close();
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    file.write(content.left(content.size() / 2));
+    file.close();
+
+    pelotoncache cache(dir.path());
+    QList<trainrow> read;
+    EXPECT_FALSE(cache.trainrows(QStringLiteral("ride/1"), context, &read));
+
+    // a payload changed on disk
+    QFile object(dir.path() + QStringLiteral("/objects/") + QString::fromLatin1(pelotoncache::hash(ride)) +
+                 QStringLiteral(".json"));
+    ASSERT_TRUE(object.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    object.write(ride.left(100));
+    object.close();
+    QByteArray data;
+    EXPECT_FALSE(cache.payload(QStringLiteral("ride/1"), &data));
+    EXPECT_FALSE(cache.contains(QStringLiteral("ride/1")));
+
+    // downloaded again
+    EXPECT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+    EXPECT_TRUE(cache.payload(QStringLiteral("ride/1"), &data));
+    EXPECT_EQ(ride, data);
+
+    // a damaged index is an empty cache
+    QFile index(dir.path() + QStringLiteral("/index.dat"));
+    ASSERT_TRUE(index.open(QIODevice::WriteOnly | QIODevice::Truncate));
+    index.write("garbage");
+    index.close();
+    pelotoncache empty(dir.path());
+    EXPECT_EQ(0, empty.count());
+    EXPECT_FALSE(empty.payload(QStringLiteral("ride/1"), &data));
+}
+
+void PelotonCacheTestSuite::test_prune() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    pelotoncache cache(dir.path());
+    cache.setMaxEntries(3);
+
+    for (int i = 0; i < 3; i++) {
+        const QString key = QStringLiteral("ride/") + QString::number(i);
+        ASSERT_TRUE(cache.setPayload(key, ridePayload(5, i)));
+        ASSERT_TRUE(cache.setTrainrows(key, QByteArrayLiteral("bike"), convert(ridePayload(5, i))));
+        QThread::msleep(5);
+    }
+    EXPECT_EQ(0, cache.prune());
+
+    // ride/0 is used again, ride/1 is now the oldest
+    QByteArray data;
+    ASSERT_TRUE(cache.payload(QStringLiteral("ride/0"), &data));
+    QThread::msleep(5);
+    ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/3"), ridePayload(5, 3)));
+
+    EXPECT_EQ(3, cache.count());
+    EXPECT_FALSE(cache.contains(QStringLiteral("ride/1")));
+    EXPECT_TRUE(cache.contains(QStringLiteral("ride/0")));
+    EXPECT_TRUE(cache.contains(QStringLiteral("ride/2")));
+    EXPECT_TRUE(cache.contains(QStringLiteral("ride/3")));
+    EXPECT_EQ(3, countFiles(dir.path() + QStringLiteral("/objects")));
+    EXPECT_EQ(2, countFiles(dir.path() + QStringLiteral("/rows")));
+
+    // files nothing points at
+    QFile stray(dir.path() + QStringLiteral("/objects/") + QString::fromLatin1(pelotoncache::hash("stray")) +
+                QStringLiteral(".json"));
+    ASSERT_TRUE(stray.open(QIODevice::WriteOnly));
+    stray.write("stray");
+    stray.close();
+    EXPECT_EQ(1, cache.prune());
+    EXPECT_FALSE(stray.exists());
+
+    pelotoncache reloaded(dir.path());
+    EXPECT_EQ(3, reloaded.count());
+    EXPECT_FALSE(reloaded.contains(QStringLiteral("ride/1")));
+}
+
+void PelotonCacheTestSuite::test_longClass() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    pelotoncache cache(dir.path());
+    // a 45 minutes class with a cue every 10 seconds
+    const QByteArray ride = ridePayload(270, 0);
+    const QByteArray context = QByteArrayLiteral("bike");
+    ASSERT_TRUE(cache.setPayload(QStringLiteral("ride/1"), ride));
+    ASSERT_TRUE(cache.setTrainrows(QStringLiteral("ride/1"), context, convert(ride)));
+
+    // read back as many times as the class is opened
+    for (int i = 0; i < 3; i++) {
+        QList<trainrow> rows;
+        ASSERT_TRUE(cache.trainrows(QStringLiteral("ride/1"), context, &rows));
+        expectSameRows(convert(ride), rows);
+    }
+}
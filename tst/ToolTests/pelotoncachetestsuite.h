@@ -0,0 +1,57 @@
+#ifndef PELOTONCACHETESTSUITE_H
+#define PELOTONCACHETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class PelotonCacheTestSuite: public testing::Test {
+
+public:
+    PelotonCacheTestSuite();
+
+    /**
+     * @brief Test that the payloads are found by key, stored once by content, and found again by another instance
+     */
+    void test_payloads();
+
+    /**
+     * @brief Test that the trainrows are read back as written, and missed when the payload or the context changes
+     */
+    void test_trainrows();
+
+    /**
+     * @brief Test that the damaged files and index are missed, not read
+     */
+    void test_corrupt();
+
+    /**
+     * @brief Test that the keys used the longest time ago are removed with the files nothing points at anymore
+     */
+    void test_prune();
+
+    /**
+     * @brief Test that the trainrows of a long class are read back as converted from its JSON
+     */
+    void test_longClass();
+};
+
+TEST_F(PelotonCacheTestSuite, TestPayloads) {
+    this->test_payloads();
+}
+
+TEST_F(PelotonCacheTestSuite, TestTrainrows) {
+    this->test_trainrows();
+}
+
+TEST_F(PelotonCacheTestSuite, TestCorrupt) {
+    this->test_corrupt();
+}
+
+TEST_F(PelotonCacheTestSuite, TestPrune) {
+    this->test_prune();
+}
+
+TEST_F(PelotonCacheTestSuite, TestLongClass) {
+    this->test_longClass();
+}
+
+#endif // PELOTONCACHETESTSUITE_H
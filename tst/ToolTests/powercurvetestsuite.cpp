@@ -0,0 +1,174 @@
+#include "powercurvetestsuite.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QList>
+#include <algorithm>
+#include "powercurve.h"
+#include "sessionstore.h"
+
+// deterministic, bursty power trace
+static QVector<double> powerTrace(int seconds) {
+    QVector<double> watts;
+    quint32 seed = 12345;
+    for (int i = 0; i < seconds; i++) {
+        seed = seed * 1103515245u + 12345u;
+        double w = 150 + (seed >> 16) % 100;
+        if ((i / 90) % 7 == 3)
+            w += 250;
+        watts.append(w);
+    }
+    return watts;
+}
+
+static double bruteForce(const QVector<double> &watts, int seconds) {
+    if (seconds > watts.count())
+        return -1;
+    double best = -1;
+    for (int start = 0; start + seconds <= watts.count(); start++) {
+        double total = 0;
+        for (int i = start; i < start + seconds; i++)
+            total += watts.at(i);
+        best = std::max(best, total / seconds);
+    }
+    return best;
+}
+
+// the sort based implementation metric::powerPeak used before the incremental curve
+static double legacyPowerPeak(const SessionStore *session, int seconds) {
+    struct IntervalBest {
+        double avg;
+        int64_t start;
+        int64_t stop;
+    };
+    if (session->count() == 0)
+        return -1;
+    if ((uint32_t)seconds > session->last().elapsedTime)
+        return -1;
+
+    const SessionStore::SessionColumn<uint16_t> watt = session->watt();
+    const SessionStore::SessionColumn<uint32_t> elapsed = session->elapsedTime();
+    QList<IntervalBest> bests;
+    QList<int> window;
+    double total = 0.0;
+    for (int i = 0; i < session->count(); i++) {
+        total += watt[i];
+        window.append(i);
+        double duration = elapsed[window.last()] - elapsed[window.first()];
+        if (duration >= seconds) {
+            IntervalBest b;
+            b.start = elapsed[window.first()];
+            b.stop = elapsed[window.last()];
+            b.avg = total / duration;
+            bests.append(b);
+            total -= watt[window.first()];
+            window.removeFirst();
+        }
+    }
+    std::sort(bests.begin(), bests.end(),
+              [](const IntervalBest &a, const IntervalBest &b) { return a.avg > b.avg; });
+    return bests.isEmpty() ? 0 : bests.first().avg;
+}
+
+PowerCurveTestSuite::PowerCurveTestSuite()
+{
+
+}
+
+void PowerCurveTestSuite::test_exact() {
+    const QVector<double> watts = powerTrace(1500);
+    PowerCurve curve;
+    for (double w : watts)
+        curve.append(w);
+
+    const QVector<int> &durations = PowerCurve::durations();
+    for (int i = 0; i < durations.count(); i++) {
+        const int seconds = durations.at(i);
+        if (seconds > 1300 && seconds % 300)
+            continue; // keep the brute force reasonably fast
+        EXPECT_NEAR(bruteForce(watts, seconds), curve.bestAt(i), 1e-6) << "duration " << seconds;
+        EXPECT_EQ(curve.bestAt(i), curve.best(seconds));
+    }
+}
+
+void PowerCurveTestSuite::test_shortWorkout() {
+    PowerCurve curve;
+    EXPECT_EQ(-1, curve.best(1));
+    for (int i = 0; i < 30; i++)
+        curve.append(200);
+    EXPECT_EQ(30, curve.count());
+    EXPECT_EQ(200, curve.best(30));
+    EXPECT_EQ(-1, curve.best(31));
+    EXPECT_EQ(-1, curve.best(0));
+
+    const quint32 version = curve.version();
+    curve.append(100);
+    EXPECT_EQ(version, curve.version()) << "no value improved";
+    curve.append(400);
+    EXPECT_NE(version, curve.version());
+
+    curve.clear();
+    EXPECT_EQ(0, curve.count());
+    EXPECT_EQ(-1, curve.best(1));
+}
+
+void PowerCurveTestSuite::test_offGrid() {
+    const QVector<double> watts = powerTrace(900);
+    PowerCurve curve;
+    for (double w : watts)
+        curve.append(w);
+
+    // 127 is between the 125 and 130 grid points
+    EXPECT_DOUBLE_EQ(curve.best(125) + (curve.best(130) - curve.best(125)) * 2 / 5, curve.best(127));
+    EXPECT_LE(curve.best(127), curve.best(125));
+    EXPECT_GE(curve.best(127), curve.best(130));
+
+    // a workout shorter than the longer grid point: the shorter one only
+    PowerCurve shorter;
+    for (int i = 0; i < 127; i++)
+        shorter.append(watts.at(i));
+    EXPECT_EQ(shorter.best(125), shorter.best(127));
+    EXPECT_GE(shorter.best(127), bruteForce(watts.mid(0, 127), 127));
+}
+
+void PowerCurveTestSuite::test_benchmark() {
+    const int seconds = 4 * 3600;
+    const QVector<double> watts = powerTrace(seconds);
+    const QDateTime start = QDateTime::currentDateTime();
+    SessionStore session;
+    for (int i = 0; i < seconds; i++) {
+        session.append(SessionLine(30, 0, i * 0.008, (uint16_t)watts.at(i), 10, 30, 130, 2, 90, i * 0.2, 0, i,
+                                   false, 0, 0, 0, 0, QGeoCoordinate(), 0, 0, 0, 0, start.addSecs(i)));
+    }
+    const int tiles[] = {5, 60, 5 * 60, 20 * 60};
+
+    QElapsedTimer timer;
+    timer.start();
+    double legacy = 0;
+    for (int t : tiles)
+        legacy += legacyPowerPeak(&session, t);
+    const qint64 legacyNs = timer.nsecsElapsed();
+
+    timer.restart();
+    double incremental = 0;
+    for (int t : tiles)
+        incremental += session.powerCurve().best(t);
+    const qint64 incrementalNs = timer.nsecsElapsed();
+
+    timer.restart();
+    PowerCurve rebuilt;
+    for (double w : watts)
+        rebuilt.append(w);
+    const qint64 appendNs = timer.nsecsElapsed();
+
+    RecordProperty("legacy_us_per_refresh", (int)(legacyNs / 1000));
+    RecordProperty("incremental_us_per_refresh", (int)(incrementalNs / 1000));
+    RecordProperty("ns_per_appended_sample", (int)(appendNs / seconds));
+
+    // the legacy windows sum one sample more than their duration, so they can only overestimate
+    EXPECT_GE(legacy, incremental);
+    for (int t : tiles) {
+        EXPECT_NEAR(bruteForce(watts, t), session.powerCurve().best(t), 1e-6);
+        EXPECT_DOUBLE_EQ(session.powerCurve().best(t), rebuilt.best(t));
+    }
+}
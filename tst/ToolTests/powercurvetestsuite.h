@@ -0,0 +1,50 @@
+#ifndef POWERCURVETESTSUITE_H
+#define POWERCURVETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class PowerCurveTestSuite: public testing::Test {
+
+public:
+    PowerCurveTestSuite();
+
+    /**
+     * @brief Test that every grid duration matches a brute force sliding window over the same samples
+     */
+    void test_exact();
+
+    /**
+     * @brief Test that durations longer than the workout return -1, and that clear() resets the curve
+     */
+    void test_shortWorkout();
+
+    /**
+     * @brief Test that off grid durations are interpolated between the grid durations around them
+     */
+    void test_offGrid();
+
+    /**
+     * @brief Compare the cost of the 4 peak power tiles on a 4 hours session: the sort based
+     * implementation previously used by metric::powerPeak against the incremental curve. The timings are properties
+     * of the test in the XML report
+     */
+    void test_benchmark();
+};
+
+TEST_F(PowerCurveTestSuite, TestExact) {
+    this->test_exact();
+}
+
+TEST_F(PowerCurveTestSuite, TestShortWorkout) {
+    this->test_shortWorkout();
+}
+
+TEST_F(PowerCurveTestSuite, TestOffGrid) {
+    this->test_offGrid();
+}
+
+TEST_F(PowerCurveTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // POWERCURVETESTSUITE_H
@@ -0,0 +1,339 @@
+#include "powersurfacetestsuite.h"
+
+#include <QBuffer>
+#include <algorithm>
+#include <cmath>
+#include <memory>
+#include "Tools/testapplication.h"
+#include "Tools/testsettings.h"
+#include "devices/bkoolbike/bkoolbike.h"
+#include "devices/computrainerbike/computrainerbike.h"
+#include "devices/domyosbike/domyosbike.h"
+#include "devices/echelonconnectsport/echelonconnectsport.h"
+#include "devices/echelonrower/echelonrower.h"
+#include "devices/fitplusbike/fitplusbike.h"
+#include "devices/ftmsbike/ftmsbike.h"
+#include "devices/horizongr7bike/horizongr7bike.h"
+#include "devices/keepbike/keepbike.h"
+#include "devices/mcfbike/mcfbike.h"
+#include "devices/nordictrackifitadbbike/nordictrackifitadbbike.h"
+#include "devices/pafersbike/pafersbike.h"
+#include "devices/powersurface.h"
+#include "devices/proformbike/proformbike.h"
+#include "devices/proformtelnetbike/proformtelnetbike.h"
+#include "devices/proformwifibike/proformwifibike.h"
+#include "devices/renphobike/renphobike.h"
+#include "devices/smartrowrower/smartrowrower.h"
+#include "devices/solebike/solebike.h"
+#include "devices/sportstechbike/sportstechbike.h"
+#include "devices/tacxneo2/tacxneo2.h"
+#include "devices/trxappgateusbbike/trxappgateusbbike.h"
+#include "devices/ultrasportbike/ultrasportbike.h"
+#include "qzsettings.h"
+#include "qzsettingssnapshot.h"
+
+namespace {
+
+// a trainer getting harder with every level
+double rising(double resistance, double cadence) { return cadence * (1.5 * resistance + 2); }
+
+// a bike with less power per level
+double gentle(double resistance, double cadence) { return cadence * (0.2 * resistance + 0.5); }
+
+// a fit bending down after the level 10
+double bending(double resistance, double cadence) { return cadence * resistance * (20 - resistance) / 10.0; }
+
+// the scan of the drivers: the lowest level r where w(r) <= power <= w(r + 1)
+int scan(const std::function<double(double)> &w, int min, int max, double power, bool strict = false) {
+    for (int i = min; i < max; i++) {
+        if (w(i) <= power && (strict ? w(i + 1) > power : w(i + 1) >= power))
+            return i;
+    }
+    if (power < w(min))
+        return min;
+    else
+        return max;
+}
+
+// bike or rower: the table of the power model of the driver, over its levels
+template <typename T> void expectTable(T *b, const QString &name, int minResistance = 1) {
+    const powersurface &surface = b->powerSurface();
+    ASSERT_FALSE(surface.isEmpty()) << name.toStdString();
+    EXPECT_EQ(minResistance, surface.minResistance()) << name.toStdString();
+    for (int c = 40; c <= 120; c += 10) {
+        double envelope = 0;
+        for (int r = surface.minResistance(); r <= surface.maxResistance(); r++) {
+            envelope = std::max(envelope, b->wattsFromResistance(r, c));
+            EXPECT_NEAR(envelope, surface.watts(r, c), 1e-6) << name.toStdString() << " r=" << r << " c=" << c;
+        }
+    }
+}
+
+// the table of the Peloton conversion of the driver, over its levels
+template <typename T> void expectPelotonMap(T *b, const QString &name, int minResistance = 1) {
+    const pelotonmap &map = b->pelotonMap();
+    ASSERT_FALSE(map.isEmpty()) << name.toStdString();
+    EXPECT_EQ(minResistance, map.minResistance()) << name.toStdString();
+    double envelope = 0;
+    for (int r = map.minResistance(); r <= map.maxResistance(); r++) {
+        envelope = r == map.minResistance() ? b->bikeResistanceToPeloton(r)
+                                            : std::max(envelope, b->bikeResistanceToPeloton(r));
+        EXPECT_NEAR(envelope, map.peloton(r), 1e-6) << name.toStdString() << " r=" << r;
+    }
+}
+
+// the drivers returning the level of the map: the scan they had
+void expectPelotonResistance(bike *b, const QString &name, int minResistance, bool strict) {
+    const auto w = [b](double r) { return b->bikeResistanceToPeloton(r); };
+    for (int p = 0; p <= 100; p++) {
+        EXPECT_EQ(scan(w, minResistance, b->maxResistance(), p, strict), b->pelotonToBikeResistance(p))
+            << name.toStdString() << " peloton=" << p;
+    }
+}
+
+} // namespace
+
+PowerSurfaceTestSuite::PowerSurfaceTestSuite()
+{
+
+}
+
+void PowerSurfaceTestSuite::test_watts() {
+    powersurface surface;
+    EXPECT_TRUE(surface.isEmpty());
+    EXPECT_EQ(0, surface.watts(5, 80));
+
+    surface.build(1, 32, rising);
+    EXPECT_FALSE(surface.isEmpty());
+    EXPECT_EQ(1, surface.minResistance());
+    EXPECT_EQ(32, surface.maxResistance());
+    for (int r = 1; r <= 32; r++) {
+        for (int c = 0; c <= powersurface::maxCadence; c += 7)
+            EXPECT_DOUBLE_EQ(rising(r, c), surface.watts(r, c));
+    }
+    // between the levels and the cadences
+    EXPECT_DOUBLE_EQ((rising(4, 80) + rising(5, 80)) / 2, surface.watts(4.5, 80));
+    EXPECT_DOUBLE_EQ((rising(4, 80) + rising(4, 81)) / 2, surface.watts(4, 80.5));
+    // clamped to the table
+    EXPECT_DOUBLE_EQ(rising(1, 80), surface.watts(-3, 80));
+    EXPECT_DOUBLE_EQ(rising(32, 80), surface.watts(40, 80));
+    EXPECT_DOUBLE_EQ(rising(5, powersurface::maxCadence), surface.watts(5, 250));
+
+    // the power stays at its peak after the fit bends down
+    surface.build(1, 20, bending);
+    for (int r = 1; r <= 20; r++)
+        EXPECT_DOUBLE_EQ(bending(std::min(r, 10), 90), surface.watts(r, 90));
+
+    // negative fits are no power, not a wrapped uint16_t
+    surface.build(0, 10, [](double resistance, double cadence) { return cadence * resistance - 100; });
+    EXPECT_EQ(0, surface.watts(0, 50));
+    EXPECT_EQ(0, surface.watts(2, 50));
+    EXPECT_DOUBLE_EQ(50, surface.watts(3, 50));
+
+    surface.clear();
+    EXPECT_TRUE(surface.isEmpty());
+}
+
+void PowerSurfaceTestSuite::test_resistance() {
+    powersurface surface;
+    EXPECT_EQ(0, surface.resistance(100, 80));
+
+    surface.build(1, 32, rising);
+    for (int c = 1; c <= powersurface::maxCadence; c += 3) {
+        const auto w = [c](double r) { return rising(r, c); };
+        for (int power = 0; power <= 2000; power += 5) {
+            ASSERT_EQ(scan(w, 1, 32, power), surface.resistance(power, c)) << "power=" << power << " c=" << c;
+
+            // the power of the exact resistance is the one requested, within the table
+            const double exact = surface.exactResistance(power, c);
+            EXPECT_GE(exact, 1);
+            EXPECT_LE(exact, 32);
+            if (power >= w(1) && power <= w(32))
+                EXPECT_NEAR(power, surface.watts(exact, c), 1e-6);
+        }
+    }
+
+    // the levels of a bent fit beyond its peak are never chosen below the peak
+    surface.build(1, 20, bending);
+    EXPECT_EQ(9, surface.resistance(bending(9.5, 90), 90));
+    EXPECT_EQ(20, surface.resistance(bending(10, 90) + 1, 90));
+}
+
+void PowerSurfaceTestSuite::test_pelotonMap() {
+    const auto toPeloton = [](double resistance) {
+        // the conversion of keepbike
+        const double p = (pow(resistance, 3) * 0.0097) - (0.4972 * pow(resistance, 2)) + (10.126 * resistance) - 37.08;
+        return p < 0 ? 0 : p;
+    };
+
+    pelotonmap map;
+    EXPECT_TRUE(map.isEmpty());
+    map.build(1, 36, toPeloton);
+    EXPECT_EQ(1, map.minResistance());
+    EXPECT_EQ(36, map.maxResistance());
+    EXPECT_DOUBLE_EQ(toPeloton(20), map.peloton(20));
+    EXPECT_DOUBLE_EQ(toPeloton(36), map.peloton(50));
+
+    for (int p = -10; p <= 150; p++) {
+        EXPECT_EQ(scan(toPeloton, 1, 36, p), map.resistance(p)) << "peloton=" << p;
+        EXPECT_EQ(scan(toPeloton, 1, 36, p, true), map.resistance(p, true)) << "peloton=" << p;
+    }
+
+    // the levels of tacxneo2 and bkoolbike start from 0
+    map.build(0, 10, [](double resistance) { return resistance * 10; });
+    EXPECT_EQ(2, map.resistance(30));
+    EXPECT_EQ(3, map.resistance(30, true));
+    EXPECT_EQ(2, map.resistance(29, true));
+    EXPECT_EQ(0, map.resistance(-5));
+    EXPECT_EQ(10, map.resistance(200));
+
+    map.clear();
+    EXPECT_TRUE(map.isEmpty());
+}
+
+void PowerSurfaceTestSuite::test_calibration() {
+    powersurface surface;
+    surface.build(1, 10, gentle);
+
+    QByteArray csv("cadence,resistance,watts\n"
+                   "60,5,100\n"
+                   "90,5.2,160\n"
+                   "75,20,300\n"      // no such level
+                   "not,a,measure\n"
+                   "80,3\n");
+    QBuffer buffer(&csv);
+    ASSERT_TRUE(buffer.open(QIODevice::ReadOnly));
+    EXPECT_EQ(2, surface.importCalibration(&buffer));
+
+    // along the cadence between the measures, proportional outside of them
+    EXPECT_DOUBLE_EQ(100, surface.watts(5, 60));
+    EXPECT_DOUBLE_EQ(130, surface.watts(5, 75));
+    EXPECT_DOUBLE_EQ(160, surface.watts(5, 90));
+    EXPECT_DOUBLE_EQ(50, surface.watts(5, 30));
+    EXPECT_NEAR(160.0 * 120 / 90, surface.watts(5, 120), 1e-9);
+    EXPECT_EQ(0, surface.watts(5, 0));
+
+    // the other levels keep the model, raised to the measures when below them
+    EXPECT_DOUBLE_EQ(gentle(4, 60), surface.watts(4, 60));
+    EXPECT_DOUBLE_EQ(160, surface.watts(6, 90));
+    EXPECT_DOUBLE_EQ(gentle(7, 90), surface.watts(7, 90));
+    EXPECT_EQ(4, surface.resistance(120, 75));
+
+    // nothing to read
+    QByteArray empty("cadence,resistance,watts\n");
+    QBuffer emptyBuffer(&empty);
+    ASSERT_TRUE(emptyBuffer.open(QIODevice::ReadOnly));
+    EXPECT_EQ(0, surface.importCalibration(&emptyBuffer));
+    EXPECT_EQ(0, surface.importCalibration(QStringLiteral("/nonexistent/calibration.csv")));
+}
+
+void PowerSurfaceTestSuite::test_drivers() {
+    ensureApplication();
+
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("PowerSurfaceTestSuite"));
+    settings.qsettings.clear();
+    // the drivers of the network trainers create it in their constructor
+    settings.qsettings.setValue(QZSettings::virtual_device_enabled, false);
+    settings.activate();
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+
+    std::unique_ptr<domyosbike> domyos(new domyosbike());
+    expectTable(domyos.get(), QStringLiteral("domyosbike"));
+    std::unique_ptr<fitplusbike> fitplus(new fitplusbike(false, false, 0, 1));
+    expectTable(fitplus.get(), QStringLiteral("fitplusbike"));
+    std::unique_ptr<ftmsbike> ftms(new ftmsbike(false, false, 0, 1));
+    expectTable(ftms.get(), QStringLiteral("ftmsbike"));
+
+    // the 500 profile of domyos is a different model: the table follows the settings
+    const double v2 = domyos->powerSurface().watts(10, 80);
+    settings.qsettings.setValue(QZSettings::domyos_bike_500_profile_v1, true);
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+    expectTable(domyos.get(), QStringLiteral("domyosbike 500"));
+    EXPECT_NE(v2, domyos->powerSurface().watts(10, 80));
+
+    std::unique_ptr<keepbike> keep(new keepbike(false, false, 0, 1));
+    std::unique_ptr<solebike> sole(new solebike(false, false, 0, 1));
+    std::unique_ptr<ultrasportbike> ultrasport(new ultrasportbike(false, false, 0, 1));
+    for (bike *b : std::initializer_list<bike *>{keep.get(), sole.get(), ultrasport.get()}) {
+        const auto w = [b](double r) { return b->bikeResistanceToPeloton(r); };
+        for (int p = 0; p <= 100; p++)
+            EXPECT_EQ(scan(w, 1, b->maxResistance(), p), b->pelotonToBikeResistance(p)) << "peloton=" << p;
+    }
+
+    std::unique_ptr<echelonconnectsport> echelon(new echelonconnectsport(false, false, 0, 1));
+    expectTable(echelon.get(), QStringLiteral("echelonconnectsport"));
+    expectPelotonMap(echelon.get(), QStringLiteral("echelonconnectsport"));
+    expectPelotonResistance(echelon.get(), QStringLiteral("echelonconnectsport"), 1, true);
+
+    std::unique_ptr<proformbike> proform(new proformbike(false, false, 0, 1));
+    expectTable(proform.get(), QStringLiteral("proformbike"));
+    std::unique_ptr<proformtelnetbike> proformTelnet(new proformtelnetbike(false, false, 0, 1));
+    expectTable(proformTelnet.get(), QStringLiteral("proformtelnetbike"));
+    std::unique_ptr<proformwifibike> proformWifi(new proformwifibike(false, false, 0, 1));
+    expectTable(proformWifi.get(), QStringLiteral("proformwifibike"));
+    // not deleted: the thread of its serial port may still be giving up on the port
+    computrainerbike *computrainer = new computrainerbike(false, false, 0, 1);
+    expectTable(computrainer, QStringLiteral("computrainerbike"));
+
+    std::unique_ptr<tacxneo2> tacx(new tacxneo2(false, false));
+    expectPelotonMap(tacx.get(), QStringLiteral("tacxneo2"), 0);
+    expectPelotonResistance(tacx.get(), QStringLiteral("tacxneo2"), 0, true);
+    std::unique_ptr<bkoolbike> bkool(new bkoolbike(false, false));
+    expectPelotonMap(bkool.get(), QStringLiteral("bkoolbike"), 0);
+    expectPelotonResistance(bkool.get(), QStringLiteral("bkoolbike"), 0, false);
+
+    std::unique_ptr<mcfbike> mcf(new mcfbike(false, false, 0, 1));
+    expectTable(mcf.get(), QStringLiteral("mcfbike"));
+    expectPelotonMap(mcf.get(), QStringLiteral("mcfbike"));
+    expectPelotonResistance(mcf.get(), QStringLiteral("mcfbike"), 1, false);
+    std::unique_ptr<pafersbike> pafers(new pafersbike(false, false, 0, 1));
+    expectTable(pafers.get(), QStringLiteral("pafersbike"));
+    expectPelotonMap(pafers.get(), QStringLiteral("pafersbike"));
+    expectPelotonResistance(pafers.get(), QStringLiteral("pafersbike"), 1, false);
+
+    std::unique_ptr<renphobike> renpho(new renphobike(false, false));
+    expectPelotonMap(renpho.get(), QStringLiteral("renphobike"));
+    std::unique_ptr<horizongr7bike> horizon(new horizongr7bike(false, false, 0, 1));
+    expectPelotonMap(horizon.get(), QStringLiteral("horizongr7bike"));
+
+    std::unique_ptr<sportstechbike> sportstech(new sportstechbike(false, false));
+    expectTable(sportstech.get(), QStringLiteral("sportstechbike"));
+    std::unique_ptr<trxappgateusbbike> trxappgateusb(new trxappgateusbbike(false, false, 0, 1));
+    expectTable(trxappgateusb.get(), QStringLiteral("trxappgateusbbike"));
+    // the levels are the inclinations of the s22i, from 0
+    std::unique_ptr<nordictrackifitadbbike> nordictrack(new nordictrackifitadbbike(false, false, 0, 1));
+    expectTable(nordictrack.get(), QStringLiteral("nordictrackifitadbbike"), 0);
+
+    std::unique_ptr<echelonrower> echelonRower(new echelonrower(false, false, 0, 1));
+    expectTable(echelonRower.get(), QStringLiteral("echelonrower"));
+    expectPelotonMap(echelonRower.get(), QStringLiteral("echelonrower"));
+    // the power of smartrow is the one measured: only its Peloton conversion is tabulated
+    std::unique_ptr<smartrowrower> smartrow(new smartrowrower(false, false, 0, 1));
+    expectPelotonMap(smartrow.get(), QStringLiteral("smartrowrower"));
+}
+
+void PowerSurfaceTestSuite::test_wattGain() {
+    ensureApplication();
+
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("PowerSurfaceTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::watt_gain, 2);
+    settings.qsettings.setValue(QZSettings::watt_offset, 10);
+    settings.activate();
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+
+    std::unique_ptr<proformbike> proform(new proformbike(false, false, 0, 1));
+    proform->cadenceSensor(80);
+    // the scan of the driver applied the gain and the offset to the model
+    const auto w = [&proform](double r) { return proform->wattsFromResistance(r, 80) * 2 + 10; };
+    for (int power = 0; power <= 1200; power += 3)
+        EXPECT_EQ(scan(w, 1, 16, power), proform->resistanceFromPowerRequest(power)) << "power=" << power;
+
+    // every level at the offset: the lowest up to it, the highest above
+    settings.qsettings.setValue(QZSettings::watt_gain, 0);
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+    EXPECT_EQ(1, proform->resistanceFromPowerRequest(0));
+    EXPECT_EQ(1, proform->resistanceFromPowerRequest(10));
+    EXPECT_EQ(16, proform->resistanceFromPowerRequest(11));
+    EXPECT_EQ(16, proform->resistanceFromPowerRequest(500));
+}
@@ -0,0 +1,68 @@
+#ifndef POWERSURFACETESTSUITE_H
+#define POWERSURFACETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class PowerSurfaceTestSuite: public testing::Test {
+
+public:
+    PowerSurfaceTestSuite();
+
+    /**
+     * @brief Test the tabulated watts: the levels and the cadences, the interpolation between them, the monotone
+     * envelope and the negative powers of the fits
+     */
+    void test_watts();
+
+    /**
+     * @brief Test that the binary search finds the resistance the linear scans of the drivers found, for every power
+     * and cadence
+     */
+    void test_resistance();
+
+    /**
+     * @brief Test the Peloton maps against the scans of the drivers, with <= and with <
+     */
+    void test_pelotonMap();
+
+    /**
+     * @brief Test the import of a calibration CSV over the levels it measures
+     */
+    void test_calibration();
+
+    /**
+     * @brief Test that the tables of every converted driver hold its power model and its Peloton conversion
+     */
+    void test_drivers();
+
+    /**
+     * @brief Test the power requests of a driver with the watt gain and offset of the user, a gain of 0 included
+     */
+    void test_wattGain();
+};
+
+TEST_F(PowerSurfaceTestSuite, TestWatts) {
+    this->test_watts();
+}
+
+TEST_F(PowerSurfaceTestSuite, TestResistance) {
+    this->test_resistance();
+}
+
+TEST_F(PowerSurfaceTestSuite, TestPelotonMap) {
+    this->test_pelotonMap();
+}
+
+TEST_F(PowerSurfaceTestSuite, TestCalibration) {
+    this->test_calibration();
+}
+
+TEST_F(PowerSurfaceTestSuite, TestDrivers) {
+    this->test_drivers();
+}
+
+TEST_F(PowerSurfaceTestSuite, TestWattGain) {
+    this->test_wattGain();
+}
+
+#endif // POWERSURFACETESTSUITE_H
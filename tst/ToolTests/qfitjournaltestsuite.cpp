@@ -0,0 +1,182 @@
+#include "qfitjournaltestsuite.h"
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <QThreadPool>
+#include <fstream>
+#include "fit_crc.hpp"
+#include "fit_decode.hpp"
+#include "qfitjournal.h"
+
+static void appendSamples(SessionStore &session, int from, int to, const QDateTime &start) {
+    for (int i = from; i < to; i++) {
+        // the first 5 samples are still, the journal starts with the first moving one
+        const uint8_t cadence = i < 5 ? 0 : 80 + i % 10;
+        session.append(SessionLine(25.0, 0, i * 0.007, 150 + i % 50, 10, 20, 120, 0, cadence, i * 0.2, 0, i,
+                                   (i % 120) == 0, 0, 0, 0, 0, QGeoCoordinate(), 0, 0, 0, 0, start.addSecs(i)));
+    }
+}
+
+static bool isValidFit(const QString &filename) {
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    const QByteArray content = file.readAll();
+    if (content.size() < 16 || fit::CRC::Calc16(content.constData(), content.size()) != 0)
+        return false;
+
+    std::ifstream stream(filename.toStdString(), std::ios::in | std::ios::binary);
+    fit::Decode decode;
+    return decode.CheckIntegrity(stream);
+}
+
+QFitJournalTestSuite::QFitJournalTestSuite()
+{
+
+}
+
+void QFitJournalTestSuite::test_crcCombine() {
+    QByteArray a, b;
+    for (int i = 0; i < 14; i++)
+        a.append((char)(i * 37 + 11));
+    for (int i = 0; i < 5000; i++)
+        b.append((char)(i * 13 + i / 7));
+
+    const FIT_UINT16 expected = fit::CRC::Calc16((a + b).constData(), a.size() + b.size());
+    const quint16 combined = qfitjournal::crcCombine(fit::CRC::Calc16(a.constData(), a.size()),
+                                                     fit::CRC::Calc16(b.constData(), b.size()), b.size());
+    EXPECT_EQ(expected, combined);
+    EXPECT_EQ(fit::CRC::Calc16(a.constData(), a.size()),
+              qfitjournal::crcCombine(fit::CRC::Calc16(a.constData(), a.size()), 0, 0));
+}
+
+void QFitJournalTestSuite::test_checkpoints() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.filePath(QStringLiteral("journal.fit"));
+    const QDateTime start = QDateTime::currentDateTime();
+
+    SessionStore session;
+    qfitjournal journal;
+    ASSERT_TRUE(journal.open(filename, bluetoothdevice::BIKE));
+    EXPECT_TRUE(isValidFit(filename));
+
+    qint64 previousSize = QFileInfo(filename).size();
+    for (int step = 0; step < 5; step++) {
+        appendSamples(session, step * 60, (step + 1) * 60, start);
+        ASSERT_TRUE(journal.append(session));
+        EXPECT_EQ(session.count(), journal.samples());
+        EXPECT_TRUE(isValidFit(filename));
+
+        const qint64 size = QFileInfo(filename).size();
+        EXPECT_GT(size, previousSize);
+        previousSize = size;
+    }
+
+    ASSERT_TRUE(journal.finalize(session));
+    EXPECT_TRUE(journal.isFinalized());
+    EXPECT_FALSE(journal.isOpen());
+    EXPECT_TRUE(isValidFit(filename));
+    EXPECT_GT(QFileInfo(filename).size(), previousSize);
+}
+
+void QFitJournalTestSuite::test_repair() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString filename = dir.filePath(QStringLiteral("journal.fit"));
+    const QDateTime start = QDateTime::currentDateTime();
+
+    SessionStore session;
+    appendSamples(session, 0, 300, start);
+    {
+        qfitjournal journal;
+        ASSERT_TRUE(journal.open(filename, bluetoothdevice::BIKE));
+        ASSERT_TRUE(journal.append(session));
+    }
+    const qint64 checkpointSize = QFileInfo(filename).size();
+
+    // a valid journal is left as it is
+    EXPECT_FALSE(qfitjournal::needsRepair(filename));
+    EXPECT_TRUE(qfitjournal::repair(filename));
+    EXPECT_EQ(checkpointSize, QFileInfo(filename).size());
+
+    // crash in the middle of an append: part of a message over the CRC, header not updated yet
+    {
+        QFile file(filename);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.seek(checkpointSize - 2);
+        file.write(QByteArray(9, (char)0x03));
+    }
+    EXPECT_FALSE(isValidFit(filename));
+    EXPECT_TRUE(qfitjournal::needsRepair(filename));
+    EXPECT_TRUE(qfitjournal::repair(filename));
+    EXPECT_TRUE(isValidFit(filename));
+    EXPECT_FALSE(qfitjournal::needsRepair(filename));
+    EXPECT_EQ(checkpointSize, QFileInfo(filename).size());
+
+    // damaged header: the data is cut at the last complete message
+    {
+        QFile file(filename);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.seek(4);
+        file.write(QByteArray(4, (char)0xFF));
+    }
+    EXPECT_FALSE(isValidFit(filename));
+    EXPECT_TRUE(qfitjournal::needsRepair(filename));
+    EXPECT_TRUE(qfitjournal::repair(filename));
+    EXPECT_TRUE(isValidFit(filename));
+    EXPECT_EQ(checkpointSize, QFileInfo(filename).size());
+
+    // not a FIT file: nothing to repair
+    const QString notes = dir.filePath(QStringLiteral("notes.fit"));
+    {
+        QFile file(notes);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write("not a journal at all");
+    }
+    EXPECT_FALSE(qfitjournal::needsRepair(notes));
+}
+
+void QFitJournalTestSuite::test_repairInBackground() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QDateTime start = QDateTime::currentDateTime();
+    SessionStore session;
+    appendSamples(session, 0, 120, start);
+
+    // a finalized journal, two interrupted in the middle of an append, one of them still being written
+    qint64 sizes[3];
+    for (int i = 0; i < 3; i++) {
+        const QString filename = dir.filePath(QStringLiteral("QZ-backup-%1.fit").arg(i));
+        qfitjournal journal;
+        ASSERT_TRUE(journal.open(filename, bluetoothdevice::BIKE));
+        ASSERT_TRUE(journal.append(session));
+        if (i == 0) {
+            ASSERT_TRUE(journal.finalize(session));
+            sizes[i] = QFileInfo(filename).size();
+            continue;
+        }
+        journal.close();
+        sizes[i] = QFileInfo(filename).size();
+        QFile file(filename);
+        ASSERT_TRUE(file.open(QIODevice::ReadWrite));
+        file.seek(sizes[i] - 2);
+        file.write(QByteArray(9, (char)0x03));
+    }
+    const QDateTime finalizedModified = QFileInfo(dir.filePath(QStringLiteral("QZ-backup-0.fit"))).lastModified();
+
+    qfitjournal::repairInBackground(dir.path(), QStringLiteral("QZ-backup-*.fit"), QStringLiteral("QZ-backup-2.fit"));
+    QThreadPool::globalInstance()->waitForDone();
+
+    EXPECT_TRUE(isValidFit(dir.filePath(QStringLiteral("QZ-backup-0.fit"))));
+    EXPECT_EQ(sizes[0], QFileInfo(dir.filePath(QStringLiteral("QZ-backup-0.fit"))).size());
+    EXPECT_EQ(finalizedModified, QFileInfo(dir.filePath(QStringLiteral("QZ-backup-0.fit"))).lastModified());
+    EXPECT_TRUE(isValidFit(dir.filePath(QStringLiteral("QZ-backup-1.fit"))));
+    EXPECT_EQ(sizes[1], QFileInfo(dir.filePath(QStringLiteral("QZ-backup-1.fit"))).size());
+    // the journal of this session isn't touched
+    EXPECT_FALSE(isValidFit(dir.filePath(QStringLiteral("QZ-backup-2.fit"))));
+    EXPECT_EQ(sizes[2] + 7, QFileInfo(dir.filePath(QStringLiteral("QZ-backup-2.fit"))).size());
+}
@@ -0,0 +1,48 @@
+#ifndef QFITJOURNALTESTSUITE_H
+#define QFITJOURNALTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class QFitJournalTestSuite: public testing::Test {
+
+public:
+    QFitJournalTestSuite();
+
+    /**
+     * @brief Test that combining the CRCs of two blocks gives the CRC of the concatenation
+     */
+    void test_crcCombine();
+
+    /**
+     * @brief Test that the journal is a valid FIT file after every checkpoint and after finalize()
+     */
+    void test_checkpoints();
+
+    /**
+     * @brief Test that a journal interrupted in the middle of an append, or with a damaged header, is repaired
+     */
+    void test_repair();
+
+    /**
+     * @brief Test that only the journals of a directory left open are repaired, on the thread pool
+     */
+    void test_repairInBackground();
+};
+
+TEST_F(QFitJournalTestSuite, TestCrcCombine) {
+    this->test_crcCombine();
+}
+
+TEST_F(QFitJournalTestSuite, TestCheckpoints) {
+    this->test_checkpoints();
+}
+
+TEST_F(QFitJournalTestSuite, TestRepair) {
+    this->test_repair();
+}
+
+TEST_F(QFitJournalTestSuite, TestRepairInBackground) {
+    this->test_repairInBackground();
+}
+
+#endif // QFITJOURNALTESTSUITE_H
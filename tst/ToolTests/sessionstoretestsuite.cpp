@@ -0,0 +1,114 @@
+#include "sessionstoretestsuite.h"
+
+#include <QDateTime>
+#include <QTemporaryDir>
+#include "sessionstore.h"
+
+static SessionLine sampleLine(int i, const QDateTime &start) {
+    QGeoCoordinate coordinate;
+    if (i % 3)
+        coordinate = QGeoCoordinate(45.0 + i * 0.0001, 9.0 + i * 0.0001, 100.0 + i % 50);
+    return SessionLine(i % 40, i % 15, i * 0.01, i % 500, i % 32, i % 100, 60 + i % 120, 5.0 + i % 7, i % 110,
+                       i * 0.1, i % 200, i, (i % 600) == 0, i * 2, 20.5, 30.5, 8.25, coordinate, 110.0, 250.0, 80.0,
+                       i * 1.5, start.addSecs(i));
+}
+
+static void expectSameLine(const SessionLine &expected, const SessionLine &actual) {
+    EXPECT_EQ(expected.speed, actual.speed);
+    EXPECT_EQ(expected.inclination, actual.inclination);
+    EXPECT_EQ(expected.distance, actual.distance);
+    EXPECT_EQ(expected.watt, actual.watt);
+    EXPECT_EQ(expected.resistance, actual.resistance);
+    EXPECT_EQ(expected.peloton_resistance, actual.peloton_resistance);
+    EXPECT_EQ(expected.heart, actual.heart);
+    EXPECT_EQ(expected.cadence, actual.cadence);
+    EXPECT_EQ(expected.time, actual.time);
+    EXPECT_EQ(expected.calories, actual.calories);
+    EXPECT_EQ(expected.elapsedTime, actual.elapsedTime);
+    EXPECT_EQ(expected.lapTrigger, actual.lapTrigger);
+    EXPECT_EQ(expected.totalStrokes, actual.totalStrokes);
+    EXPECT_EQ(expected.coordinate, actual.coordinate);
+    EXPECT_EQ(expected.stepCount, actual.stepCount);
+}
+
+SessionStoreTestSuite::SessionStoreTestSuite()
+{
+
+}
+
+void SessionStoreTestSuite::test_roundTrip() {
+    const int rows = SessionStore::CHUNK_ROWS;
+    const QDateTime start = QDateTime::currentDateTime();
+    SessionStore store;
+    EXPECT_TRUE(store.isEmpty());
+
+    for (int i = 0; i < rows * 2 + 10; i++)
+        store.append(sampleLine(i, start));
+
+    ASSERT_EQ(rows * 2 + 10, store.count());
+    for (int i = 0; i < store.count(); i++)
+        expectSameLine(sampleLine(i, start), store.at(i));
+
+    // invalid coordinates and times are kept invalid
+    EXPECT_FALSE(store.coordinate(0).isValid());
+    EXPECT_TRUE(store.coordinate(1).isValid());
+    SessionLine noTime = sampleLine(1, start);
+    noTime.time = QDateTime();
+    store.append(noTime);
+    EXPECT_FALSE(store.last().time.isValid());
+}
+
+void SessionStoreTestSuite::test_columns() {
+    const int rows = SessionStore::CHUNK_ROWS;
+    const QDateTime start = QDateTime::currentDateTime();
+    SessionStore store;
+    for (int i = 0; i < rows + rows / 2; i++)
+        store.append(sampleLine(i, start));
+
+    SessionStore::SessionColumn<uint16_t> watt = store.watt();
+    EXPECT_EQ(2, watt.segmentCount());
+
+    int index = 0;
+    for (int s = 0; s < watt.segmentCount(); s++) {
+        int length = 0;
+        const uint16_t *data = watt.segment(s, &length);
+        for (int i = 0; i < length; i++, index++)
+            EXPECT_EQ(sampleLine(index, start).watt, data[i]);
+    }
+    EXPECT_EQ(store.count(), index);
+
+    double sum = 0;
+    store.distance().forEach([&sum](double d) { sum += d; });
+    double expected = 0;
+    for (int i = 0; i < store.count(); i++)
+        expected += store.distance()[i];
+    EXPECT_EQ(expected, sum);
+}
+
+void SessionStoreTestSuite::test_spill() {
+    const int rows = SessionStore::CHUNK_ROWS;
+    const QDateTime start = QDateTime::currentDateTime();
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+
+    SessionStore store;
+    // a full chunk recorded before spilling is enabled is spilled as well
+    for (int i = 0; i < rows; i++)
+        store.append(sampleLine(i, start));
+    ASSERT_TRUE(store.setSpillFile(dir.filePath(QStringLiteral("session.spill"))));
+    EXPECT_EQ(1, store.spilledChunks());
+
+    for (int i = rows; i < rows * 3 + 5; i++)
+        store.append(sampleLine(i, start));
+    EXPECT_EQ(3, store.spilledChunks());
+
+    for (int i = 0; i < store.count(); i++)
+        expectSameLine(sampleLine(i, start), store.at(i));
+
+    store.clear();
+    EXPECT_TRUE(store.isEmpty());
+    EXPECT_EQ(0, store.spilledChunks());
+
+    store.append(sampleLine(7, start));
+    expectSameLine(sampleLine(7, start), store.first());
+}
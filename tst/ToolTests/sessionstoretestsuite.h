@@ -0,0 +1,39 @@
+#ifndef SESSIONSTORETESTSUITE_H
+#define SESSIONSTORETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class SessionStoreTestSuite: public testing::Test {
+
+public:
+    SessionStoreTestSuite();
+
+    /**
+     * @brief Test that the samples read back are the ones appended, across chunk boundaries
+     */
+    void test_roundTrip();
+
+    /**
+     * @brief Test that walking a column segment by segment visits every sample once, in order
+     */
+    void test_columns();
+
+    /**
+     * @brief Test that spilled chunks read back the same as in memory ones, and that clear() resets the store
+     */
+    void test_spill();
+};
+
+TEST_F(SessionStoreTestSuite, TestRoundTrip) {
+    this->test_roundTrip();
+}
+
+TEST_F(SessionStoreTestSuite, TestColumns) {
+    this->test_columns();
+}
+
+TEST_F(SessionStoreTestSuite, TestSpill) {
+    this->test_spill();
+}
+
+#endif // SESSIONSTORETESTSUITE_H
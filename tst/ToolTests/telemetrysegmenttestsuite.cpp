@@ -0,0 +1,146 @@
+#include "telemetrysegmenttestsuite.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryDir>
+#include <atomic>
+#include <thread>
+#include "telemetrysegment.h"
+
+static qz_telemetry sample(double value) {
+    qz_telemetry values;
+    memset(&values, 0, sizeof(values));
+    values.updated_ms = 1000 + (qint64)value;
+    values.device_type = QZ_TELEMETRY_TREADMILL;
+    values.flags = QZ_TELEMETRY_CONNECTED;
+    // every double of the sample is the same, a torn copy has two
+    double *fields = &values.speed_kmh;
+    for (size_t i = 0; i < (sizeof(qz_telemetry) - offsetof(qz_telemetry, speed_kmh)) / sizeof(double); i++)
+        fields[i] = value;
+    return values;
+}
+
+// the segment as an external reader sees it: its own mapping of the file
+class segmentReader {
+  public:
+    explicit segmentReader(const QString &path) : file(path) {
+        if (file.open(QIODevice::ReadOnly))
+            map = file.map(0, file.size());
+    }
+    bool read(qz_telemetry *values) {
+        const qz_telemetry_segment *segment = reinterpret_cast<const qz_telemetry_segment *>(map);
+        return map && qz_telemetry_valid(segment, file.size()) && qz_telemetry_read(segment, values);
+    }
+
+  private:
+    QFile file;
+    uchar *map = nullptr;
+};
+
+TelemetrySegmentTestSuite::TelemetrySegmentTestSuite()
+{
+
+}
+
+void TelemetrySegmentTestSuite::test_publish() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath(QStringLiteral(QZ_TELEMETRY_FILE));
+    {
+        telemetrysegment segment;
+        ASSERT_TRUE(segment.open(path));
+        qz_telemetry values;
+        EXPECT_FALSE(segment.last(&values));
+
+        segment.publish(sample(12.5));
+        segmentReader reader(path);
+        ASSERT_TRUE(reader.read(&values));
+        EXPECT_EQ(12.5, values.speed_kmh);
+        EXPECT_EQ(12.5, values.altitude_m);
+        EXPECT_EQ((uint32_t)QZ_TELEMETRY_TREADMILL, values.device_type);
+
+        segment.publish(sample(13));
+        ASSERT_TRUE(reader.read(&values));
+        EXPECT_EQ(13, values.inclination_pct);
+    }
+
+    // the next run
+    telemetrysegment segment;
+    ASSERT_TRUE(segment.open(path));
+    qz_telemetry values;
+    ASSERT_TRUE(segment.last(&values));
+    EXPECT_EQ(13, values.speed_kmh);
+    segment.close();
+
+    // another layout
+    QFile file(path);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+    file.write(QByteArray(40, 'x'));
+    file.close();
+    ASSERT_TRUE(segment.open(path));
+    EXPECT_FALSE(segment.last(&values));
+    EXPECT_EQ((qint64)sizeof(qz_telemetry_segment), QFileInfo(path).size());
+}
+
+void TelemetrySegmentTestSuite::test_concurrentRead() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath(QStringLiteral(QZ_TELEMETRY_FILE));
+    telemetrysegment segment;
+    ASSERT_TRUE(segment.open(path));
+    segment.publish(sample(0));
+
+    std::atomic<bool> stop(false);
+    std::thread writer([&]() {
+        for (int i = 1; !stop; i++)
+            segment.publish(sample(i));
+    });
+
+    segmentReader reader(path);
+    int torn = 0, read = 0;
+    for (int i = 0; i < 200000; i++) {
+        qz_telemetry values;
+        if (!reader.read(&values))
+            continue;
+        read++;
+        const double *fields = &values.speed_kmh;
+        for (size_t f = 0; f < (sizeof(qz_telemetry) - offsetof(qz_telemetry, speed_kmh)) / sizeof(double); f++) {
+            if (fields[f] != values.speed_kmh || values.updated_ms != 1000 + (qint64)values.speed_kmh) {
+                torn++;
+                break;
+            }
+        }
+    }
+    stop = true;
+    writer.join();
+
+    EXPECT_GT(read, 0);
+    EXPECT_EQ(0, torn);
+}
+
+void TelemetrySegmentTestSuite::test_statusFile() {
+    QTemporaryDir dir;
+    const QString path = dir.filePath(QStringLiteral("status.xml"));
+    telemetrysegment segment;
+    segment.statusFileInterval = 60000;
+
+    qz_telemetry values = sample(0);
+    values.speed_kmh = 10.04;
+    values.inclination_pct = 2;
+    EXPECT_TRUE(segment.writeStatusFile(path, values));
+    double speed = 0, inclination = 0;
+    ASSERT_TRUE(telemetrysegment::readStatusFile(path, &speed, &inclination));
+    EXPECT_EQ(10.0, speed);
+    EXPECT_EQ(2.0, inclination);
+
+    // the same text, then a change before the interval
+    values.speed_kmh = 10.01;
+    EXPECT_FALSE(segment.writeStatusFile(path, values));
+    values.speed_kmh = 11;
+    EXPECT_FALSE(segment.writeStatusFile(path, values));
+
+    segment.statusFileInterval = 0;
+    EXPECT_TRUE(segment.writeStatusFile(path, values));
+    ASSERT_TRUE(telemetrysegment::readStatusFile(path, &speed, &inclination));
+    EXPECT_EQ(11.0, speed);
+
+    EXPECT_FALSE(telemetrysegment::readStatusFile(dir.filePath(QStringLiteral("missing.xml")), &speed, &inclination));
+}
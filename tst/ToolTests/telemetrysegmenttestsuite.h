@@ -0,0 +1,41 @@
+#ifndef TELEMETRYSEGMENTTESTSUITE_H
+#define TELEMETRYSEGMENTTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class TelemetrySegmentTestSuite: public testing::Test {
+
+public:
+    TelemetrySegmentTestSuite();
+
+    /**
+     * @brief Test that the values published are read back through another mapping of the file, and by the next
+     * run, and that a file of another layout is reset
+     */
+    void test_publish();
+
+    /**
+     * @brief Test that a reader copying the values while the writer updates them never gets half an update
+     */
+    void test_concurrentRead();
+
+    /**
+     * @brief Test that status.xml is written only when the values shown change and the interval elapsed, and that
+     * it is read back
+     */
+    void test_statusFile();
+};
+
+TEST_F(TelemetrySegmentTestSuite, TestPublish) {
+    this->test_publish();
+}
+
+TEST_F(TelemetrySegmentTestSuite, TestConcurrentRead) {
+    this->test_concurrentRead();
+}
+
+TEST_F(TelemetrySegmentTestSuite, TestStatusFile) {
+    this->test_statusFile();
+}
+
+#endif // TELEMETRYSEGMENTTESTSUITE_H
@@ -0,0 +1,211 @@
+#include "templatetelemetryfeedtestsuite.h"
+
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QtEndian>
+#include "templatetelemetryfeed.h"
+
+static const char *const workoutFields[] = {"elapsed_s", "watts", "heart", "cadence", "speed", "deviceName"};
+
+// one tick of a simulated workout: some fields change every second, some rarely, one never
+static void setTick(TemplateTelemetryFeed &feed, int i) {
+    feed.set(feed.fieldId(QStringLiteral("elapsed_s")), i % 60);
+    feed.set(feed.fieldId(QStringLiteral("watts")), 150 + (i * 7) % 90);
+    feed.set(feed.fieldId(QStringLiteral("heart")), 120 + i / 30);
+    feed.set(feed.fieldId(QStringLiteral("cadence")), 80 + (i / 5) % 10);
+    feed.set(feed.fieldId(QStringLiteral("speed")), 25.5 + (i % 4) * 0.25);
+    feed.set(feed.fieldId(QStringLiteral("deviceName")), QStringLiteral("FTMS bike"));
+}
+
+static QJsonObject expectedRow(int i) {
+    QJsonObject row;
+    row[QStringLiteral("elapsed_s")] = i % 60;
+    row[QStringLiteral("watts")] = 150 + (i * 7) % 90;
+    row[QStringLiteral("heart")] = 120 + i / 30;
+    row[QStringLiteral("cadence")] = 80 + (i / 5) % 10;
+    row[QStringLiteral("speed")] = 25.5 + (i % 4) * 0.25;
+    row[QStringLiteral("deviceName")] = QStringLiteral("FTMS bike");
+    return row;
+}
+
+TemplateTelemetryFeedTestSuite::TemplateTelemetryFeedTestSuite()
+{
+
+}
+
+void TemplateTelemetryFeedTestSuite::test_delta() {
+    TemplateTelemetryFeed feed;
+    setTick(feed, 0);
+    feed.commit(true);
+
+    QJsonObject first = QJsonDocument::fromJson(feed.deltaJson()).object();
+    EXPECT_EQ(QStringLiteral("workoutdelta"), first[QStringLiteral("msg")].toString());
+    EXPECT_EQ(1, first[QStringLiteral("seq")].toInt());
+    EXPECT_EQ((int)(sizeof(workoutFields) / sizeof(workoutFields[0])), first[QStringLiteral("fields")].toObject().count());
+    EXPECT_EQ((int)(sizeof(workoutFields) / sizeof(workoutFields[0])), first[QStringLiteral("content")].toObject().count());
+
+    // tick 1: elapsed_s, watts and speed change
+    setTick(feed, 1);
+    feed.commit(true);
+    QJsonObject second = QJsonDocument::fromJson(feed.deltaJson()).object();
+    EXPECT_FALSE(second.contains(QStringLiteral("fields")));
+    QJsonObject content = second[QStringLiteral("content")].toObject();
+    EXPECT_EQ(3, content.count());
+    EXPECT_EQ(1, content[QString::number(feed.fieldId(QStringLiteral("elapsed_s")))].toInt());
+    EXPECT_EQ(157, content[QString::number(feed.fieldId(QStringLiteral("watts")))].toInt());
+    EXPECT_FALSE(content.contains(QString::number(feed.fieldId(QStringLiteral("deviceName")))));
+
+    // a field appearing later is announced with its tick only
+    setTick(feed, 2);
+    feed.set(feed.fieldId(QStringLiteral("gears")), 3);
+    feed.commit(true);
+    QJsonObject fields = QJsonDocument::fromJson(feed.deltaJson()).object()[QStringLiteral("fields")].toObject();
+    ASSERT_EQ(1, fields.count());
+    EXPECT_EQ(QStringLiteral("gears"), fields.begin().value().toString());
+    setTick(feed, 3);
+    feed.commit(true);
+    EXPECT_TRUE(feed.newFields().isEmpty());
+
+    // nothing changed: empty delta
+    feed.commit(true);
+    EXPECT_TRUE(feed.delta().isEmpty());
+
+    // the snapshot is the whole current state
+    QJsonObject snapshot = feed.snapshot();
+    EXPECT_EQ(feed.fieldCount(), snapshot[QStringLiteral("fields")].toObject().count());
+    EXPECT_EQ(3, snapshot[QStringLiteral("content")].toObject()[QString::number(feed.fieldId(QStringLiteral("elapsed_s")))].toInt());
+}
+
+void TemplateTelemetryFeedTestSuite::test_rows() {
+    const int capacity = 5 * TemplateTelemetryFeed::KEYFRAME_INTERVAL + 7;
+    const int ticks = 3 * capacity + 11;
+    TemplateTelemetryFeed feed(capacity);
+    for (int i = 0; i < ticks; i++) {
+        setTick(feed, i);
+        feed.commit(true);
+    }
+    ASSERT_EQ((quint64)ticks, feed.endRow());
+    ASSERT_EQ((quint64)(ticks - capacity), feed.firstRow());
+
+    // every page size, including the ones not aligned with the keyframes
+    const int limits[] = {1, 7, TemplateTelemetryFeed::KEYFRAME_INTERVAL, 100, 0};
+    for (int limit : limits) {
+        quint64 cursor = 0;
+        int expected = ticks - capacity;
+        while (cursor < feed.endRow()) {
+            quint64 next = 0;
+            QJsonArray page = feed.rows(cursor, limit, &next);
+            ASSERT_FALSE(page.isEmpty());
+            for (const QJsonValue &row : page) {
+                EXPECT_EQ(expectedRow(expected), row.toObject()) << "limit " << limit << " row " << expected;
+                expected++;
+            }
+            ASSERT_GT(next, cursor);
+            cursor = next;
+        }
+        EXPECT_EQ(ticks, expected);
+    }
+
+    // a cursor past the end returns nothing
+    quint64 next = 0;
+    EXPECT_TRUE(feed.rows(feed.endRow(), 10, &next).isEmpty());
+    EXPECT_EQ(feed.endRow(), next);
+
+    feed.clearHistory();
+    EXPECT_EQ(0u, feed.endRow());
+    EXPECT_TRUE(feed.rows(0, 0).isEmpty());
+    // the first row after a clear carries the whole state, even the fields not changed since
+    feed.commit(true);
+    QJsonArray rows = feed.rows(0, 0);
+    ASSERT_EQ(1, rows.count());
+    EXPECT_EQ(expectedRow(ticks - 1), rows.at(0).toObject());
+}
+
+void TemplateTelemetryFeedTestSuite::test_unrecorded() {
+    TemplateTelemetryFeed feed;
+    const int curve = feed.fieldId(QStringLiteral("watts_curve"), false);
+    setTick(feed, 0);
+    feed.set(curve, QJsonArray({QJsonArray({5, 300})}));
+    feed.commit(true);
+    // paused: the delta goes to the clients, not to the history
+    setTick(feed, 1);
+    feed.commit(false);
+    EXPECT_EQ(3, feed.delta().count());
+    EXPECT_EQ(1u, feed.endRow());
+    setTick(feed, 2);
+    feed.commit(false);
+    // resumed: the row has all the changes since the last recorded one
+    setTick(feed, 3);
+    feed.commit(true);
+    QJsonArray rows = feed.rows(0, 0);
+    ASSERT_EQ(2, rows.count());
+    EXPECT_EQ(expectedRow(0), rows.at(0).toObject());
+    EXPECT_EQ(expectedRow(3), rows.at(1).toObject());
+    EXPECT_FALSE(rows.at(1).toObject().contains(QStringLiteral("watts_curve")));
+    EXPECT_TRUE(feed.snapshot()[QStringLiteral("content")].toObject().contains(QString::number(curve)));
+}
+
+void TemplateTelemetryFeedTestSuite::test_binary() {
+    TemplateTelemetryFeed feed;
+    setTick(feed, 5);
+    feed.set(feed.fieldId(QStringLiteral("devicePaused")), false);
+    feed.set(feed.fieldId(QStringLiteral("connected")), true);
+    feed.set(feed.fieldId(QStringLiteral("deviceId")), QJsonValue(QJsonValue::Undefined));
+    feed.set(feed.fieldId(QStringLiteral("distance")), -0.125);
+    feed.set(feed.fieldId(QStringLiteral("cranks")), 3000000000.0);
+    feed.commit(true);
+
+    const QByteArray frame = feed.deltaBinary();
+    ASSERT_GE(frame.size(), 8);
+    EXPECT_EQ('Q', frame.at(0));
+    EXPECT_EQ((int)TemplateTelemetryFeed::BINARY_VERSION, (int)(quint8)frame.at(1));
+    const uchar *p = reinterpret_cast<const uchar *>(frame.constData());
+    EXPECT_EQ(feed.seq(), qFromLittleEndian<quint32>(p + 2));
+    const int count = qFromLittleEndian<quint16>(p + 6);
+    ASSERT_EQ(feed.delta().count(), count);
+
+    QJsonObject json = QJsonDocument::fromJson(feed.deltaJson()).object()[QStringLiteral("content")].toObject();
+    int pos = 8;
+    for (int i = 0; i < count; i++) {
+        ASSERT_LE(pos + 2, frame.size());
+        const int id = qFromLittleEndian<quint16>(p + pos);
+        pos += 2;
+        bool ok = false;
+        QJsonValue v = TemplateTelemetryFeed::fromBinary(frame, pos, ok);
+        ASSERT_TRUE(ok);
+        EXPECT_EQ(json[QString::number(id)], v) << feed.fieldName(id).toStdString();
+    }
+    EXPECT_EQ(frame.size(), pos);
+
+    // the last value is the f64 of cranks: one byte short, it's rejected
+    int last = frame.size() - 9;
+    bool ok = true;
+    TemplateTelemetryFeed::fromBinary(frame.left(frame.size() - 1), last, ok);
+    EXPECT_FALSE(ok);
+}
+
+void TemplateTelemetryFeedTestSuite::test_deltaSize() {
+    const int ticks = 2 * 3600;
+    const int extraFields = 100;
+    TemplateTelemetryFeed feed;
+    qint64 rowBytes = 0, deltaBytes = 0, binaryBytes = 0;
+
+    for (int i = 0; i < ticks; i++) {
+        QJsonObject row = expectedRow(i);
+        // the rest of a workout object: fields that rarely change
+        for (int f = 0; f < extraFields; f++)
+            row[QStringLiteral("field_%1").arg(f)] = (i / 600) + f;
+        rowBytes += QJsonDocument(row).toJson(QJsonDocument::Compact).size();
+
+        for (QJsonObject::const_iterator it = row.constBegin(); it != row.constEnd(); ++it)
+            feed.set(feed.fieldId(it.key()), it.value());
+        feed.commit(true);
+        deltaBytes += feed.deltaJson().size();
+        binaryBytes += feed.deltaBinary().size();
+    }
+
+    // most ticks only change a few fields
+    EXPECT_LT(deltaBytes * 4, rowBytes);
+    EXPECT_LT(binaryBytes, deltaBytes);
+}
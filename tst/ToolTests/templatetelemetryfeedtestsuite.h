@@ -0,0 +1,57 @@
+#ifndef TEMPLATETELEMETRYFEEDTESTSUITE_H
+#define TEMPLATETELEMETRYFEEDTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class TemplateTelemetryFeedTestSuite: public testing::Test {
+
+public:
+    TemplateTelemetryFeedTestSuite();
+
+    /**
+     * @brief Test that a tick's delta only has the fields that changed, and that new fields are announced once
+     */
+    void test_delta();
+
+    /**
+     * @brief Test that the paged rows are the same as replaying every tick, across keyframes and dropped rows
+     */
+    void test_rows();
+
+    /**
+     * @brief Test that the changes of the ticks not recorded go with the next recorded row
+     */
+    void test_unrecorded();
+
+    /**
+     * @brief Test that the binary frame decodes back to the JSON delta
+     */
+    void test_binary();
+
+    /**
+     * @brief Test that over a session the deltas are smaller than the rows, and the binary frames than the JSON ones
+     */
+    void test_deltaSize();
+};
+
+TEST_F(TemplateTelemetryFeedTestSuite, TestDelta) {
+    this->test_delta();
+}
+
+TEST_F(TemplateTelemetryFeedTestSuite, TestRows) {
+    this->test_rows();
+}
+
+TEST_F(TemplateTelemetryFeedTestSuite, TestUnrecorded) {
+    this->test_unrecorded();
+}
+
+TEST_F(TemplateTelemetryFeedTestSuite, TestBinary) {
+    this->test_binary();
+}
+
+TEST_F(TemplateTelemetryFeedTestSuite, TestDeltaSize) {
+    this->test_deltaSize();
+}
+
+#endif // TEMPLATETELEMETRYFEEDTESTSUITE_H
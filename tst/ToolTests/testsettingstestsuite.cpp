@@ -2,6 +2,7 @@
 
 #include <QCoreApplication>
 #include "qzsettings.h"
+#include "qzsettingssnapshot.h"
 #include "Tools/testsettings.h"
 
 
@@ -86,4 +87,39 @@ void TestSettingsTestSuite::test_destructor(){
     EXPECT_EQ(QCoreApplication::applicationName(), originalAppName);
 }
 
+void TestSettingsTestSuite::test_snapshot(){
+    QCoreApplication::setOrganizationName("Original Org Name");
+    QCoreApplication::setApplicationName("Original App Name");
 
+    TestSettings testSettings("Test Org Name", "Test App Name");
+    testSettings.qsettings.clear();
+    testSettings.qsettings.setValue(QZSettings::watt_gain, 1.5);
+    testSettings.qsettings.setValue(QZSettings::power_sensor_name, "My Power Meter");
+
+    int changes = 0;
+    QMetaObject::Connection connection =
+        QObject::connect(QZSettingsSnapshot::instance(), &QZSettingsSnapshot::changed, [&changes]() { changes++; });
+
+    testSettings.activate();
+    EXPECT_EQ(QZSettingsSnapshot::get().watt_gain, 1.5);
+    EXPECT_EQ(QZSettingsSnapshot::get().power_sensor_name, QStringLiteral("My Power Meter"));
+    EXPECT_FALSE(QZSettingsSnapshot::get().power_sensor_disabled);
+    EXPECT_EQ(QZSettingsSnapshot::get().weight, static_cast<float>(QZSettings::default_weight));
+    EXPECT_EQ(changes, 1);
+
+    // a reload without any change must not publish a new snapshot
+    const QZSettingsValues *before = &QZSettingsSnapshot::get();
+    EXPECT_FALSE(QZSettingsSnapshot::instance()->reload());
+    EXPECT_EQ(before, &QZSettingsSnapshot::get());
+
+    testSettings.qsettings.setValue(QZSettings::watt_gain, 2.0);
+    EXPECT_TRUE(QZSettingsSnapshot::instance()->reload());
+    EXPECT_EQ(QZSettingsSnapshot::get().watt_gain, 2.0);
+    // the previous snapshot is still readable
+    EXPECT_EQ(before->watt_gain, 1.5);
+    EXPECT_EQ(changes, 2);
+
+    testSettings.qsettings.clear();
+    testSettings.deactivate();
+    QObject::disconnect(connection);
+}
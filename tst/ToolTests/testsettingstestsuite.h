@@ -23,6 +23,11 @@ public:
      * @brief Test that the destructor restores the original state of the QCoreApplication
      */
     void test_destructor();
+
+    /**
+     * @brief Test that activating the test settings is reflected in the QZSettingsSnapshot
+     */
+    void test_snapshot();
 };
 
 TEST_F(TestSettingsTestSuite, TestTestSettings) {
@@ -33,4 +38,8 @@ TEST_F(TestSettingsTestSuite, TestDestructor) {
     this->test_destructor();
 }
 
+TEST_F(TestSettingsTestSuite, TestSnapshot) {
+    this->test_snapshot();
+}
+
 #endif // TESTSETTINGSTESTSUITE_H
@@ -0,0 +1,123 @@
+#include "tiletestsuite.h"
+
+#include <random>
+#include "homeform.h"
+
+static DataObject *newTile() {
+    return new DataObject(QStringLiteral("Speed (km/h)"), QStringLiteral("icons/icons/speed.png"),
+                          QStringLiteral("0.0"), false, QStringLiteral("speed"), 48, 16);
+}
+
+TileTestSuite::TileTestSuite()
+{
+
+}
+
+void TileTestSuite::test_noRepeatedEmit() {
+    QScopedPointer<DataObject> tile(newTile());
+    int values = 0, secondLines = 0, colors = 0, gridIds = 0;
+    QObject::connect(tile.data(), &DataObject::valueChanged, [&](QString) { values++; });
+    QObject::connect(tile.data(), &DataObject::secondLineChanged, [&](QString) { secondLines++; });
+    QObject::connect(tile.data(), &DataObject::valueFontColorChanged, [&](QString) { colors++; });
+    QObject::connect(tile.data(), &DataObject::gridIdChanged, [&](int) { gridIds++; });
+
+    for (int i = 0; i < 3; i++) {
+        tile->setValue(QStringLiteral("12.3"));
+        tile->setSecondLine(QStringLiteral("AVG: 10.0 MAX: 15.2"));
+        tile->setValueFontColor(QStringLiteral("red"));
+        tile->setGridId(4);
+    }
+    EXPECT_EQ(1, values);
+    EXPECT_EQ(1, secondLines);
+    EXPECT_EQ(1, colors);
+    EXPECT_EQ(1, gridIds);
+
+    tile->setValue(QStringLiteral("12.4"));
+    EXPECT_EQ(2, values);
+}
+
+void TileTestSuite::test_numbers() {
+    QScopedPointer<DataObject> tile(newTile());
+    tile->setShown(true);
+    quint32 tick = 1;
+    int values = 0;
+    QObject::connect(tile.data(), &DataObject::valueChanged, [&](QString) { values++; });
+
+    std::mt19937 rng(13);
+    for (int i = 0; i < 200000; i++) {
+        const int decimals = rng() % 3;
+        double value;
+        switch (rng() % 3) {
+        case 0:
+            // the halves
+            value = ((int)(rng() % 2000) - 1000) / 2.0 / (decimals == 0 ? 1 : decimals == 1 ? 10 : 100);
+            break;
+        case 1:
+            value = ((int)(rng() % 2000000) - 1000000) / 1000.0;
+            break;
+        default:
+            value = -((double)(rng() % 1000)) / 100000.0;
+        }
+        tile->beginRefresh(tick++);
+        tile->setValueNumber(value, decimals);
+        ASSERT_EQ(QString::number(value, 'f', decimals), tile->value()) << value << " " << decimals;
+        const double avg = value / 3, max = value * 2;
+        tile->setSecondLineNumbers(QStringLiteral("AVG: %1 MAX: %2"), decimals, avg, max);
+        ASSERT_EQ(QStringLiteral("AVG: ") + QString::number(avg, 'f', decimals) + QStringLiteral(" MAX: ") +
+                      QString::number(max, 'f', decimals),
+                  tile->secondLine());
+    }
+
+    // below the digits shown: nothing to format
+    tile->beginRefresh(tick++);
+    tile->setValueNumber(42.31, 1);
+    values = 0;
+    for (int i = 0; i < 10; i++) {
+        tile->beginRefresh(tick++);
+        tile->setValueNumber(42.31 + i * 0.001, 1);
+    }
+    EXPECT_EQ(0, values);
+    EXPECT_EQ(QStringLiteral("42.3"), tile->value());
+
+    // a text set in between is replaced by the number again
+    tile->setValue(QStringLiteral("-"));
+    tile->beginRefresh(tick++);
+    tile->setValueNumber(42.31, 1);
+    EXPECT_EQ(QStringLiteral("42.3"), tile->value());
+    tile->beginRefresh(tick++);
+    tile->setValueNumbers(QStringLiteral("Z%1"), 0, 3);
+    EXPECT_EQ(QStringLiteral("Z3"), tile->value());
+}
+
+void TileTestSuite::test_refresh() {
+    QScopedPointer<DataObject> tile(newTile());
+    quint32 tick = 1;
+
+    // out of the layout
+    tile->beginRefresh(tick++);
+    EXPECT_FALSE(tile->due());
+    tile->setValueNumber(10, 0);
+    EXPECT_EQ(QStringLiteral("0.0"), tile->value());
+
+    tile->setShown(true);
+    tile->beginRefresh(tick++);
+    EXPECT_TRUE(tile->due());
+    tile->setValueNumber(10, 0);
+    EXPECT_EQ(QStringLiteral("10"), tile->value());
+
+    tile->setRefreshInterval(5);
+    int refreshed = 0;
+    for (int i = 0; i < 20; i++) {
+        tile->beginRefresh(tick++);
+        if (tile->due())
+            refreshed++;
+    }
+    EXPECT_EQ(4, refreshed);
+
+    // removed and added again: refreshed on the next update
+    tile->setShown(false);
+    EXPECT_FALSE(tile->due());
+    tile->setShown(true);
+    tile->beginRefresh(tick++);
+    EXPECT_TRUE(tile->due());
+}
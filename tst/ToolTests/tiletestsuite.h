@@ -0,0 +1,41 @@
+#ifndef TILETESTSUITE_H
+#define TILETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class TileTestSuite: public testing::Test {
+
+public:
+    TileTestSuite();
+
+    /**
+     * @brief Test that setting the same value, second line, color or layout again emits nothing
+     */
+    void test_noRepeatedEmit();
+
+    /**
+     * @brief Test that the numbers are shown as QString::number(value, 'f', decimals) would, also on the halves and
+     * on the negative zeros, and that a number changed below the digits shown is not formatted again
+     */
+    void test_numbers();
+
+    /**
+     * @brief Test that a tile out of the layout is not refreshed, is refreshed as soon as it is added again, and
+     * that a tile with a refresh interval is refreshed every interval updates
+     */
+    void test_refresh();
+};
+
+TEST_F(TileTestSuite, TestNoRepeatedEmit) {
+    this->test_noRepeatedEmit();
+}
+
+TEST_F(TileTestSuite, TestNumbers) {
+    this->test_numbers();
+}
+
+TEST_F(TileTestSuite, TestRefresh) {
+    this->test_refresh();
+}
+
+#endif // TILETESTSUITE_H
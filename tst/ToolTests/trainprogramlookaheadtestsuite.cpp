@@ -0,0 +1,251 @@
+#include "trainprogramlookaheadtestsuite.h"
+
+#include <algorithm>
+#include <random>
+#include "trainprogram.h"
+#include "trainprogramlookahead.h"
+
+// what the train program did before the look-ahead: walks of the rows from the current one
+class rowsWalk {
+  public:
+    QList<trainrow> rows;
+    int currentStep = 0;
+    double currentStepDistance = 0;
+
+    QVector<MetersByInclination> inclinationNext300Meters(bool average) {
+        int c = currentStep;
+        double km = 0;
+        QVector<MetersByInclination> next300;
+        while (c < rows.length() && km <= 0.3) {
+            MetersByInclination p;
+            if (c == currentStep) {
+                p.meters = (rows.at(c).distance - currentStepDistance) * 1000.0;
+                km += (rows.at(c).distance - currentStepDistance);
+            } else {
+                p.meters = (rows.at(c).distance) * 1000.0;
+                km += (rows.at(c).distance);
+            }
+            p.inclination = average ? avgInclinationNext100Meters(c) : rows.at(c).inclination;
+            next300.append(p);
+            c++;
+        }
+        return next300;
+    }
+
+    double medianInclination(int step) {
+        QList<double> inclinations;
+        if (rows.length() == 0)
+            return 0;
+        for (int s = step - 2; s <= step + 2; s++)
+            inclinations.append(s >= 0 && s < rows.length() ? rows.at(s).inclination : 0);
+        std::sort(inclinations.begin(), inclinations.end());
+        return inclinations.at(2);
+    }
+
+    double weightedInclination(int step) {
+        const int windowsize = 7;
+        int firststep = step;
+        double inc = 0;
+        double sumweights = 0;
+        if (rows.length() == 0)
+            return 0;
+        if (firststep < 0)
+            firststep = 0;
+        const int laststep = step + windowsize;
+        if (laststep >= rows.length()) {
+            firststep = rows.length() - 1 - (windowsize * 2);
+            if (firststep < 0)
+                firststep = 0;
+        }
+        for (int s = firststep; s <= laststep; s++) {
+            const double pointweight = ((((double)windowsize * 2.0) - 1.0) - ((s - firststep) * 2.0));
+            sumweights += pointweight;
+            inc += medianInclination(s) * pointweight;
+        }
+        if (sumweights == 0)
+            return 0;
+        return inc / sumweights;
+    }
+
+    double avgInclinationNext100Meters(int step) {
+        int c = step;
+        double km = 0;
+        double avg = 0;
+        int sum = 0;
+        while (c < rows.length() && km <= 0.1) {
+            if (c == currentStep)
+                km += (rows.at(c).distance - currentStepDistance);
+            else
+                km += (rows.at(c).distance);
+            avg += rows.at(c).inclination * rows.at(c).distance;
+            sum++;
+            c++;
+        }
+        if (sum == 1)
+            return rows.at(currentStep).inclination;
+        return avg / km;
+    }
+
+    double avgAzimuthNext300Meters() {
+        int c = currentStep;
+        double km = 0;
+        double sinTotal = 0;
+        double cosTotal = 0;
+        if (std::isnan(rows.at(c).latitude) || std::isnan(rows.at(c).longitude))
+            return 0;
+        while (c < rows.length() && km <= 0.3) {
+            for (double i = 0; i < rows.at(c).distance; i += 0.001) {
+                sinTotal += sin(rows.at(c).azimuth * (M_PI / 180));
+                cosTotal += cos(rows.at(c).azimuth * (M_PI / 180));
+            }
+            km += rows.at(c).distance;
+            c++;
+        }
+        double averageDirection = atan(sinTotal / cosTotal) * (180 / M_PI);
+        if (cosTotal < 0)
+            averageDirection += 180;
+        else if (sinTotal < 0)
+            averageDirection += 360;
+        return averageDirection;
+    }
+};
+
+// track points a few meters apart, a long straight now and then, some without a position or a direction; mixed
+// adds rows without a distance
+static QList<trainrow> randomRoute(std::mt19937 &rng, int count, bool mixed) {
+    QList<trainrow> rows;
+    for (int i = 0; i < count; i++) {
+        trainrow r;
+        if (mixed && rng() % 10 == 0)
+            r.distance = -1;
+        else
+            r.distance = (1 + rng() % 4000) / 1000000.0 * (rng() % 20 == 0 ? 100 : 1);
+        r.inclination = ((int)(rng() % 400) - 200) / 10.0;
+        if (rng() % 30) {
+            r.latitude = 45.0;
+            r.longitude = 9.0;
+        }
+        if (rng() % 50)
+            r.azimuth = (rng() % 36000) / 100.0;
+        rows.append(r);
+    }
+    return rows;
+}
+
+static void expectSame(double expected, double actual, double tolerance) {
+    if (std::isnan(expected))
+        EXPECT_TRUE(std::isnan(actual));
+    else
+        EXPECT_NEAR(expected, actual, tolerance * (1 + fabs(expected)));
+}
+
+static void expectSame(const QVector<MetersByInclination> &expected, const QVector<MetersByInclination> &actual) {
+    ASSERT_EQ(expected.count(), actual.count());
+    for (int i = 0; i < expected.count(); i++) {
+        EXPECT_NEAR(expected.at(i).meters, actual.at(i).meters, 1e-9);
+        expectSame(expected.at(i).inclination, actual.at(i).inclination, 1e-6);
+    }
+}
+
+TrainProgramLookaheadTestSuite::TrainProgramLookaheadTestSuite()
+{
+
+}
+
+void TrainProgramLookaheadTestSuite::test_filters() {
+    std::mt19937 rng(3);
+    for (int count : {0, 1, 3, 14, 15, 16, 500}) {
+        rowsWalk walk;
+        walk.rows = randomRoute(rng, count, false);
+        trainprogramlookahead lookahead;
+        lookahead.build(walk.rows);
+        ASSERT_EQ(count, lookahead.count());
+        for (int step = 0; step < count + 10; step++) {
+            EXPECT_EQ(walk.medianInclination(step), lookahead.medianInclination(step)) << "step " << step;
+            EXPECT_NEAR(walk.weightedInclination(step), lookahead.weightedInclination(step), 1e-9) << "step " << step;
+        }
+    }
+}
+
+void TrainProgramLookaheadTestSuite::test_window() {
+    std::mt19937 rng(5);
+    for (int round = 0; round < 10; round++) {
+        rowsWalk walk;
+        const int count = 200 + rng() % 800;
+        walk.rows = randomRoute(rng, count, round % 5 == 4);
+        trainprogramlookahead lookahead;
+        lookahead.build(walk.rows);
+
+        // the route is ridden: the distance of the row grows past its end, then the next row starts
+        for (int step = 0; step < count; step++) {
+            walk.currentStep = step;
+            const double distance = walk.rows.at(step).distance > 0 ? walk.rows.at(step).distance : 0.002;
+            for (double covered = rng() % 3 ? 0 : distance / 2; covered <= distance * 1.2;
+                 covered += distance / (1 + rng() % 4)) {
+                walk.currentStepDistance = covered;
+                expectSame(walk.avgInclinationNext100Meters(step), lookahead.avgInclinationNext100Meters(step, covered),
+                           1e-6);
+                expectSame(walk.inclinationNext300Meters(false), lookahead.inclinationNext300Meters(step, covered));
+                expectSame(walk.inclinationNext300Meters(true), lookahead.avgInclinationNext300Meters(step, covered));
+            }
+            expectSame(walk.avgAzimuthNext300Meters(), lookahead.avgAzimuthNext300Meters(step), 1e-6);
+        }
+
+        // back to the start, as when the program restarts
+        walk.currentStep = 0;
+        walk.currentStepDistance = 0;
+        expectSame(walk.inclinationNext300Meters(false), lookahead.inclinationNext300Meters(0, 0));
+    }
+}
+
+void TrainProgramLookaheadTestSuite::test_previewBuffer() {
+    std::mt19937 rng(7);
+    trainprogramlookahead lookahead;
+    lookahead.build(randomRoute(rng, 1000, false));
+
+    // the device keeps the last preview
+    QVector<MetersByInclination> device;
+    const MetersByInclination *data[4];
+    for (int i = 0; i < 4; i++) {
+        device = lookahead.inclinationNext300Meters(100, 0);
+        data[i] = device.constData();
+    }
+    EXPECT_NE(data[0], data[1]);
+    EXPECT_EQ(data[0], data[2]);
+    EXPECT_EQ(data[1], data[3]);
+
+    EXPECT_TRUE(lookahead.inclinationNext300Meters(1000, 0).isEmpty());
+    lookahead.clear();
+    EXPECT_EQ(0, lookahead.count());
+    EXPECT_TRUE(lookahead.avgInclinationNext300Meters(0, 0).isEmpty());
+    EXPECT_EQ(0, lookahead.avgAzimuthNext300Meters(0));
+}
+
+void TrainProgramLookaheadTestSuite::test_longRoute() {
+    // a 120 km GPX route, a track point every 1.2 m
+    const int count = 100000;
+    std::mt19937 rng(11);
+    rowsWalk walk;
+    for (int i = 0; i < count; i++) {
+        trainrow r;
+        r.distance = 0.0012;
+        r.inclination = ((int)(rng() % 200) - 100) / 10.0;
+        r.latitude = 45.0 + i * 0.00001;
+        r.longitude = 9.0;
+        r.azimuth = (rng() % 36000) / 100.0;
+        walk.rows.append(r);
+    }
+    trainprogramlookahead lookahead;
+    lookahead.build(walk.rows);
+
+    // what a tick asks at 30 km/h: the 100 m inclination, the 300 m preview and direction
+    for (int t = 0; t < 2000; t++) {
+        walk.currentStep = t * 7;
+        walk.currentStepDistance = 0.0006;
+        expectSame(walk.avgInclinationNext100Meters(walk.currentStep),
+                   lookahead.avgInclinationNext100Meters(walk.currentStep, 0.0006), 1e-6);
+        expectSame(walk.inclinationNext300Meters(true),
+                   lookahead.avgInclinationNext300Meters(walk.currentStep, 0.0006));
+        expectSame(walk.avgAzimuthNext300Meters(), lookahead.avgAzimuthNext300Meters(walk.currentStep), 1e-6);
+    }
+}
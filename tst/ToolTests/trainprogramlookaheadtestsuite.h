@@ -0,0 +1,49 @@
+#ifndef TRAINPROGRAMLOOKAHEADTESTSUITE_H
+#define TRAINPROGRAMLOOKAHEADTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class TrainProgramLookaheadTestSuite: public testing::Test {
+
+public:
+    TrainProgramLookaheadTestSuite();
+
+    /**
+     * @brief Test that the median and weighted inclinations match the filters computed from the rows
+     */
+    void test_filters();
+
+    /**
+     * @brief Test the 100 m inclination, the 300 m previews and the 300 m direction against a walk of the rows
+     * while a route is ridden
+     */
+    void test_window();
+
+    /**
+     * @brief Test that the preview is filled in place once the device holds the other buffer
+     */
+    void test_previewBuffer();
+
+    /**
+     * @brief Test the look-ahead of the ticks of a ride against the walks of the rows on a long GPX program
+     */
+    void test_longRoute();
+};
+
+TEST_F(TrainProgramLookaheadTestSuite, TestFilters) {
+    this->test_filters();
+}
+
+TEST_F(TrainProgramLookaheadTestSuite, TestWindow) {
+    this->test_window();
+}
+
+TEST_F(TrainProgramLookaheadTestSuite, TestPreviewBuffer) {
+    this->test_previewBuffer();
+}
+
+TEST_F(TrainProgramLookaheadTestSuite, TestLongRoute) {
+    this->test_longRoute();
+}
+
+#endif // TRAINPROGRAMLOOKAHEADTESTSUITE_H
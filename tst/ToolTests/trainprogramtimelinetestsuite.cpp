@@ -0,0 +1,197 @@
+#include "trainprogramtimelinetestsuite.h"
+
+#include <QElapsedTimer>
+#include <random>
+#include "trainprogram.h"
+#include "trainprogramtimeline.h"
+
+static const QDateTime workoutStart(QDate(2023, 1, 1), QTime(8, 0, 0));
+
+// what the train program did before the timeline: a scan from the first row
+static int scanRowAt(const QList<trainrow> &rows, quint32 ticks, quint32 *start) {
+    quint32 elapsed = 0;
+    for (int i = 0; i < rows.count(); i++) {
+        const quint32 t = trainprogramtimeline::timeForRow(rows.at(i));
+        elapsed += t;
+        if (elapsed > ticks) {
+            *start = elapsed - t;
+            return i;
+        }
+    }
+    *start = elapsed;
+    return rows.count();
+}
+
+// workout rows, ramps, and distance rows stamped or not yet
+static QList<trainrow> randomRows(std::mt19937 &rng, int count) {
+    QList<trainrow> rows;
+    for (int i = 0; i < count; i++) {
+        trainrow r;
+        switch (rng() % 4) {
+        case 0:
+            r.distance = 0.1 + (rng() % 1000) / 1000.0;
+            if (rng() % 2) {
+                r.started = workoutStart.addSecs(rng() % 3600);
+                r.ended = r.started.addSecs(rng() % 120);
+            }
+            break;
+        case 1:
+            r.duration = QTime(0, 0, 0).addSecs(1);
+            r.rampDuration = QTime(0, 0, 0).addSecs(rng() % 30);
+            r.rampElapsed = QTime(0, 0, 0).addSecs(rng() % 30);
+            break;
+        default:
+            // zero length rows too
+            r.duration = QTime(0, 0, 0).addSecs(rng() % 600);
+            break;
+        }
+        r.speed = rng() % 20;
+        r.forcespeed = true;
+        rows.append(r);
+    }
+    return rows;
+}
+
+TrainProgramTimelineTestSuite::TrainProgramTimelineTestSuite()
+{
+
+}
+
+void TrainProgramTimelineTestSuite::test_time() {
+    std::mt19937 rng(3);
+    QList<trainrow> rows = randomRows(rng, 500);
+    trainprogramtimeline timeline;
+    timeline.build(rows);
+    ASSERT_EQ(rows.count(), timeline.count());
+
+    for (int round = 0; round < 3; round++) {
+        quint32 total = 0;
+        for (const trainrow &r : qAsConst(rows))
+            total += trainprogramtimeline::timeForRow(r);
+        EXPECT_EQ((qint64)total, timeline.totalTime());
+
+        for (quint32 ticks = 0; ticks <= total + 2; ticks++) {
+            quint32 start = 0;
+            const int row = scanRowAt(rows, ticks, &start);
+            ASSERT_EQ(row, timeline.rowAt(ticks)) << "ticks " << ticks;
+            EXPECT_EQ((qint64)start, timeline.timeBefore(row));
+        }
+        // the negative ticks of the scheduler, as unsigned
+        EXPECT_EQ(rows.count(), timeline.rowAt(static_cast<uint32_t>(-5)));
+
+        // the workout goes on: some distance rows are stamped, as the scheduler does
+        for (int i = 0; i < rows.count(); i++) {
+            if (rows.at(i).distance > 0 && rng() % 3 == 0) {
+                rows[i].started = workoutStart.addSecs(rng() % 3600);
+                rows[i].ended = rows.at(i).started.addSecs(rng() % 300);
+                timeline.setRowTime(i, trainprogramtimeline::timeForRow(rows.at(i)));
+            }
+        }
+    }
+
+    timeline.clear();
+    EXPECT_EQ(0, timeline.count());
+    EXPECT_EQ(0, timeline.rowAt(10));
+    EXPECT_EQ(0, timeline.totalTime());
+}
+
+void TrainProgramTimelineTestSuite::test_distance() {
+    std::mt19937 rng(5);
+    QList<trainrow> rows = randomRows(rng, 300);
+    trainprogramtimeline timeline;
+    timeline.build(rows);
+
+    qint64 millimeters = 0;
+    for (int i = 0; i < rows.count(); i++) {
+        EXPECT_EQ(millimeters, timeline.distanceBefore(i));
+        if (rows.at(i).distance != -1)
+            millimeters += llround(rows.at(i).distance * 1000000.0);
+
+        int next = i + 1;
+        while (next < rows.count() && rows.at(next).distance <= 0)
+            next++;
+        EXPECT_EQ(next, timeline.nextDistanceRow(i));
+    }
+    EXPECT_EQ(millimeters, timeline.distanceBefore(rows.count()));
+    for (qint64 d = 0; d < millimeters + 1000; d += 7919) {
+        int expected = 0;
+        while (expected < rows.count() && timeline.distanceBefore(expected + 1) <= d)
+            expected++;
+        ASSERT_EQ(expected, timeline.rowAtDistance(d)) << "distance " << d;
+    }
+
+    // the duration and the total distance of trainprogram before the timeline
+    QTime duration(0, 0, 0, 0);
+    double distance = 0;
+    for (const trainrow &row : qAsConst(rows)) {
+        const int seconds = (row.duration.hour() * 3600) + (row.duration.minute() * 60) + row.duration.second();
+        duration = duration.addSecs(seconds);
+        if (seconds)
+            distance += seconds * (row.speed / 3600);
+    }
+    EXPECT_EQ(duration, QTime(0, 0, 0, 0).addSecs((int)timeline.durationSeconds()));
+    EXPECT_EQ(distance, timeline.totalDistance());
+
+    // a row with a duration and no forced speed: no distance
+    rows[rows.count() / 2].duration = QTime(0, 1, 0);
+    rows[rows.count() / 2].forcespeed = false;
+    timeline.build(rows);
+    EXPECT_EQ(-1, timeline.totalDistance());
+}
+
+void TrainProgramTimelineTestSuite::test_benchmark() {
+    // a 120 km GPX route: a row every 1.2 m, each one stamped once it's over
+    const int count = 100000;
+    QList<trainrow> rows;
+    rows.reserve(count);
+    for (int i = 0; i < count; i++) {
+        trainrow r;
+        r.distance = 0.0012;
+        r.latitude = 45.0 + i * 0.00001;
+        r.longitude = 9.0;
+        if (i < count / 2) {
+            r.started = workoutStart.addSecs(i / 4);
+            r.ended = workoutStart.addSecs((i + 1) / 4);
+        }
+        rows.append(r);
+    }
+    trainprogramtimeline timeline;
+    QElapsedTimer timer;
+    timer.start();
+    timeline.build(rows);
+    const qint64 buildNs = timer.nsecsElapsed();
+
+    // what the home page asks every second: elapsed and remaining time of the row, remaining time, duration
+    const int queries = 200;
+    const quint32 ticks = (count / 2) / 4 - 10;
+    qint64 scanTotal = 0;
+    timer.restart();
+    for (int q = 0; q < queries; q++) {
+        for (int k = 0; k < 3; k++) {
+            quint32 start = 0;
+            scanTotal += scanRowAt(rows, ticks + q, &start) + start;
+        }
+        QTime duration(0, 0, 0, 0);
+        for (const trainrow &row : qAsConst(rows))
+            duration = duration.addSecs((row.duration.hour() * 3600) + (row.duration.minute() * 60) +
+                                        row.duration.second());
+        scanTotal += QTime(0, 0, 0).secsTo(duration);
+    }
+    const qint64 scanNs = timer.nsecsElapsed();
+
+    qint64 indexTotal = 0;
+    timer.restart();
+    for (int q = 0; q < queries; q++) {
+        for (int k = 0; k < 3; k++) {
+            const int row = timeline.rowAt(ticks + q);
+            indexTotal += row + timeline.timeBefore(row);
+        }
+        indexTotal += timeline.durationSeconds();
+    }
+    const qint64 indexNs = timer.nsecsElapsed();
+
+    EXPECT_EQ(scanTotal, indexTotal);
+    RecordProperty("build_us", (int)(buildNs / 1000));
+    RecordProperty("scan_us_per_second", (int)(scanNs / queries / 1000));
+    RecordProperty("index_ns_per_second", (int)(indexNs / queries));
+}
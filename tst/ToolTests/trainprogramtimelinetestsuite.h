@@ -0,0 +1,41 @@
+#ifndef TRAINPROGRAMTIMELINETESTSUITE_H
+#define TRAINPROGRAMTIMELINETESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class TrainProgramTimelineTestSuite: public testing::Test {
+
+public:
+    TrainProgramTimelineTestSuite();
+
+    /**
+     * @brief Test that the row at a time and the time before it match a scan of the rows, before and after rows
+     * are stamped during the workout
+     */
+    void test_time();
+
+    /**
+     * @brief Test the distance queries, the duration and the total distance against a scan of the rows
+     */
+    void test_distance();
+
+    /**
+     * @brief Compare the queries of the home page every second with the scans on a long GPX program; the timings are
+     * properties of the test
+     */
+    void test_benchmark();
+};
+
+TEST_F(TrainProgramTimelineTestSuite, TestTime) {
+    this->test_time();
+}
+
+TEST_F(TrainProgramTimelineTestSuite, TestDistance) {
+    this->test_distance();
+}
+
+TEST_F(TrainProgramTimelineTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // TRAINPROGRAMTIMELINETESTSUITE_H
@@ -0,0 +1,223 @@
+#include "workouthistorytestsuite.h"
+
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QTemporaryDir>
+#include "Tools/testapplication.h"
+#include "qfit.h"
+#include "workouthistory.h"
+
+static void saveWorkout(const QString &filename, const QDateTime &start, int seconds, uint16_t watt) {
+    SessionStore session;
+    for (int i = 0; i < seconds; i++) {
+        session.append(SessionLine(25.0, 0, i * 0.007, watt + i % 20, 10, 20, 110 + (i * 50) / seconds, 0, 85,
+                                   i * 0.2, 0, i, (i % 300) == 0, 0, 0, 0, 0, QGeoCoordinate(), 0, 0, 0, 0,
+                                   start.addSecs(i)));
+    }
+    qfit::save(filename, session, bluetoothdevice::BIKE);
+}
+
+static void appendRecord(fitrecords &records, quint32 timestamp, quint16 power, quint8 heart) {
+    records.timestamp.append(timestamp);
+    records.latitude.append(0x7FFFFFFF);
+    records.longitude.append(0x7FFFFFFF);
+    records.altitude.append(0xFFFFFFFF);
+    records.distance.append(timestamp * 500);
+    records.speed.append(5000);
+    records.power.append(power);
+    records.calories.append(timestamp / 10);
+    records.stepLength.append(0xFFFF);
+    records.verticalOscillation.append(0xFFFF);
+    records.stanceTime.append(0xFFFF);
+    records.heart.append(heart);
+    records.cadence.append(90);
+    records.resistance.append(0xFF);
+}
+
+WorkoutHistoryTestSuite::WorkoutHistoryTestSuite()
+{
+
+}
+
+void WorkoutHistoryTestSuite::test_summarize() {
+    fitrecords records;
+    // 10 minutes at 200 W and 120 bpm, 10 minutes at 300 W and 160 bpm, a 5 minutes pause, 1 minute at 400 W
+    for (quint32 t = 0; t < 600; t++)
+        appendRecord(records, t, 200, 120);
+    for (quint32 t = 600; t < 1200; t++)
+        appendRecord(records, t, 300, 160);
+    for (quint32 t = 1500; t < 1560; t++)
+        appendRecord(records, t, 400, 0xFF);
+    records.sport = FIT_SPORT_CYCLING;
+
+    const workoutsummary s = workouthistory::summarize(records, QVector<double>() << 100 << 130 << 150 << 170);
+    EXPECT_EQ(records.count(), s.records);
+    EXPECT_EQ(FIT_SPORT_CYCLING, s.sport);
+    EXPECT_DOUBLE_EQ(1559, s.elapsed);
+    EXPECT_DOUBLE_EQ(1559 * 0.005, s.distance);
+    EXPECT_DOUBLE_EQ(155, s.calories);
+    EXPECT_DOUBLE_EQ(400, s.maxWatt);
+    EXPECT_DOUBLE_EQ(160, s.maxHeart);
+    EXPECT_DOUBLE_EQ(90, s.avgCadence);
+
+    // the pause counts 10 seconds at the power of the record after it
+    EXPECT_DOUBLE_EQ((600 * 200.0 + 600 * 300.0 + 69 * 400.0) / 1269.0, s.avgWatt);
+    EXPECT_DOUBLE_EQ(400, s.peaks[0]);
+    EXPECT_DOUBLE_EQ(400, s.peaks[1]);
+    EXPECT_DOUBLE_EQ((231 * 300.0 + 69 * 400.0) / 300.0, s.peaks[2]);
+    EXPECT_DOUBLE_EQ((531 * 200.0 + 600 * 300.0 + 69 * 400.0) / 1200.0, s.peaks[3]);
+
+    EXPECT_DOUBLE_EQ(0, s.heartZones[0]);
+    EXPECT_DOUBLE_EQ(600, s.heartZones[1]);
+    EXPECT_DOUBLE_EQ(0, s.heartZones[2]);
+    EXPECT_DOUBLE_EQ(600, s.heartZones[3]);
+    EXPECT_DOUBLE_EQ(0, s.heartZones[4]);
+    EXPECT_DOUBLE_EQ(140, s.avgHeart);
+
+    const workoutsummary empty = workouthistory::summarize(fitrecords(), QVector<double>());
+    EXPECT_EQ(0, empty.records);
+    EXPECT_DOUBLE_EQ(-1, empty.peaks[0]);
+}
+
+void WorkoutHistoryTestSuite::test_incrementalRefresh() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("cache/history.qzhistory"));
+    const QDateTime start = QDateTime::currentDateTime().addDays(-10);
+    for (int i = 0; i < 4; i++)
+        saveWorkout(dir.filePath(QStringLiteral("workout%1.fit").arg(i)), start.addDays(i), 900, 150 + i * 10);
+    saveWorkout(dir.filePath(QStringLiteral("QZ-backup-in-progress.fit")), start, 60, 100);
+    QFile notFit(dir.filePath(QStringLiteral("broken.fit")));
+    ASSERT_TRUE(notFit.open(QIODevice::WriteOnly));
+    notFit.write("not a FIT file");
+    notFit.close();
+
+    {
+        workouthistory history(dir.path(), cache);
+        EXPECT_EQ(5, history.refresh());
+        EXPECT_EQ(0, history.refresh());
+        const QList<workoutsummary> workouts = history.workouts();
+        ASSERT_EQ(4, workouts.count());
+        // the newest first
+        EXPECT_EQ(QStringLiteral("workout3.fit"), workouts.at(0).fileName);
+        EXPECT_EQ(QStringLiteral("workout0.fit"), workouts.at(3).fileName);
+        EXPECT_GT(workouts.at(0).avgWatt, workouts.at(3).avgWatt);
+        workoutsummary broken;
+        ASSERT_TRUE(history.find(QStringLiteral("broken.fit"), &broken));
+        EXPECT_EQ(0, broken.records);
+        EXPECT_FALSE(history.find(QStringLiteral("QZ-backup-in-progress.fit"), nullptr));
+    }
+    EXPECT_TRUE(QFile::exists(cache));
+
+    // another run reads the cache, decodes only what changed and forgets the deleted files
+    workouthistory history(dir.path(), cache);
+    EXPECT_EQ(0, history.refresh());
+    EXPECT_EQ(4, history.workouts().count());
+    workoutsummary s;
+    ASSERT_TRUE(history.find(QStringLiteral("workout1.fit"), &s));
+    const double peak = s.peaks[2];
+
+    saveWorkout(dir.filePath(QStringLiteral("workout1.fit")), start.addDays(1), 1800, 250);
+    saveWorkout(dir.filePath(QStringLiteral("workout4.fit")), start.addDays(4), 240, 150);
+    ASSERT_TRUE(QFile::remove(dir.filePath(QStringLiteral("workout2.fit"))));
+    EXPECT_EQ(2, history.refresh());
+    EXPECT_EQ(4, history.workouts().count());
+    EXPECT_FALSE(history.find(QStringLiteral("workout2.fit"), nullptr));
+    ASSERT_TRUE(history.find(QStringLiteral("workout1.fit"), &s));
+    EXPECT_GT(s.peaks[2], peak);
+    ASSERT_TRUE(history.find(QStringLiteral("workout4.fit"), &s));
+    EXPECT_DOUBLE_EQ(-1, s.peaks[2]);
+
+    workouthistory reloaded(dir.path(), cache);
+    EXPECT_EQ(0, reloaded.refresh());
+    EXPECT_EQ(4, reloaded.workouts().count());
+}
+
+void WorkoutHistoryTestSuite::test_heartRateZones() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("history.qzhistory"));
+    saveWorkout(dir.filePath(QStringLiteral("workout.fit")), QDateTime::currentDateTime(), 600, 200);
+
+    const QVector<double> percentages = QVector<double>() << 50 << 60 << 70 << 80;
+    workouthistory history(dir.path(), cache);
+    history.setHeartRateZones(workouthistory::heartRateZones(200, percentages));
+    EXPECT_EQ(1, history.refresh());
+    workoutsummary s;
+    ASSERT_TRUE(history.find(QStringLiteral("workout.fit"), &s));
+    double total = 0;
+    for (double zone : s.heartZones)
+        total += zone;
+    EXPECT_NEAR(600, total, 5);
+
+    history.setHeartRateZones(workouthistory::heartRateZones(200, percentages));
+    EXPECT_EQ(0, history.refresh());
+    history.setHeartRateZones(workouthistory::heartRateZones(180, percentages));
+    EXPECT_EQ(1, history.refresh());
+
+    // the cache is of the zones it was written with
+    workouthistory other(dir.path(), cache);
+    other.setHeartRateZones(workouthistory::heartRateZones(180, percentages));
+    EXPECT_EQ(0, other.refresh());
+    workouthistory defaults(dir.path(), cache);
+    EXPECT_EQ(1, defaults.refresh());
+}
+
+void WorkoutHistoryTestSuite::test_background() {
+    ensureApplication();
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("history.qzhistory"));
+    const int files = 20;
+    const QDateTime start = QDateTime::currentDateTime().addDays(-files);
+    for (int i = 0; i < files; i++)
+        saveWorkout(dir.filePath(QStringLiteral("workout%1.fit").arg(i)), start.addDays(i), 1800, 180);
+
+    const QVector<double> percentages = QVector<double>() << 50 << 60 << 70 << 80;
+    workouthistory history(dir.path(), cache);
+    history.setHeartRateZones(workouthistory::heartRateZones(200, percentages));
+    int refreshed = 0;
+    QObject::connect(&history, &workouthistory::refreshed, [&refreshed](int) { refreshed++; });
+    history.refreshInBackground();
+    // the zones change while the files are decoded: the history ends with the new ones
+    history.setHeartRateZones(workouthistory::heartRateZones(120, percentages));
+    while (history.isRefreshing())
+        EXPECT_LE(history.workouts().count(), files);
+    EXPECT_TRUE(spinUntil([&refreshed]() { return refreshed > 0; }, 10000));
+    EXPECT_EQ(files, history.workouts().count());
+
+    // heart 110 to 160 bpm: at a max of 120 it's over the last bound (96 bpm) the whole workout
+    workoutsummary s;
+    ASSERT_TRUE(history.find(QStringLiteral("workout0.fit"), &s));
+    EXPECT_NEAR(1800, s.heartZones[workoutsummary::HEART_ZONES - 1], 5);
+
+    workouthistory cached(dir.path(), cache);
+    cached.setHeartRateZones(workouthistory::heartRateZones(120, percentages));
+    EXPECT_EQ(0, cached.refresh());
+}
+
+void WorkoutHistoryTestSuite::test_benchmark() {
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("history.qzhistory"));
+    const int files = 40;
+    const QDateTime start = QDateTime::currentDateTime().addDays(-files);
+    for (int i = 0; i < files; i++)
+        saveWorkout(dir.filePath(QStringLiteral("workout%1.fit").arg(i)), start.addDays(i), 3600, 180);
+
+    QElapsedTimer timer;
+    timer.start();
+    workouthistory scan(dir.path(), cache);
+    EXPECT_EQ(files, scan.refresh());
+    const qint64 scanMs = timer.elapsed();
+
+    timer.restart();
+    workouthistory cached(dir.path(), cache);
+    EXPECT_EQ(0, cached.refresh());
+    const qint64 cachedMs = timer.elapsed();
+    EXPECT_EQ(files, cached.workouts().count());
+
+    RecordProperty("scan_ms", (int)scanMs);
+    RecordProperty("cache_ms", (int)cachedMs);
+}
@@ -0,0 +1,57 @@
+#ifndef WORKOUTHISTORYTESTSUITE_H
+#define WORKOUTHISTORYTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class WorkoutHistoryTestSuite: public testing::Test {
+
+public:
+    WorkoutHistoryTestSuite();
+
+    /**
+     * @brief Test the totals, the power peaks and the heart rate zone times of a summary
+     */
+    void test_summarize();
+
+    /**
+     * @brief Test that refresh() only decodes the files new or changed since the cache was written
+     */
+    void test_incrementalRefresh();
+
+    /**
+     * @brief Test that changing the heart rate zones summarizes the files again
+     */
+    void test_heartRateZones();
+
+    /**
+     * @brief Test the refresh on a background thread, with the zones changed while it runs
+     */
+    void test_background();
+
+    /**
+     * @brief Compare a first scan of many workouts with a refresh from the cache, recording both times in the report
+     */
+    void test_benchmark();
+};
+
+TEST_F(WorkoutHistoryTestSuite, TestSummarize) {
+    this->test_summarize();
+}
+
+TEST_F(WorkoutHistoryTestSuite, TestIncrementalRefresh) {
+    this->test_incrementalRefresh();
+}
+
+TEST_F(WorkoutHistoryTestSuite, TestHeartRateZones) {
+    this->test_heartRateZones();
+}
+
+TEST_F(WorkoutHistoryTestSuite, TestBackground) {
+    this->test_background();
+}
+
+TEST_F(WorkoutHistoryTestSuite, TestBenchmark) {
+    this->test_benchmark();
+}
+
+#endif // WORKOUTHISTORYTESTSUITE_H
@@ -0,0 +1,297 @@
+#include "workoutlibrarytestsuite.h"
+
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QtMath>
+#include "Tools/testapplication.h"
+#include "Tools/testsettings.h"
+#include "qzsettings.h"
+#include "workoutlibrary.h"
+#include "zwiftworkout.h"
+
+namespace {
+
+void writeFile(const QString &fileName, const QByteArray &content) {
+    QFile f(fileName);
+    f.open(QIODevice::WriteOnly);
+    f.write(content);
+}
+
+trainrow row(int seconds, int power, double inclination = -200) {
+    trainrow r;
+    r.duration = QTime(0, 0, 0).addSecs(seconds);
+    r.power = power;
+    r.inclination = inclination;
+    return r;
+}
+
+// a warm up, intervals and a cool down of about an hour
+QByteArray zwo(int variant) {
+    QByteArray xml = "<?xml version=\"1.0\" ?>\n<workout_file>\n<name>Intervals " + QByteArray::number(variant) +
+                     "</name>\n<description>Intervals at 120% FTP</description>\n<sportType>bike</sportType>\n"
+                     "<tags><tag name=\"INTERVALS\"/></tags>\n<workout>\n"
+                     "<Warmup Duration=\"300\" PowerLow=\"0.5\" PowerHigh=\"0.75\"/>\n";
+    xml += "<IntervalsT Repeat=\"" + QByteArray::number(6 + variant % 4) +
+           "\" OnDuration=\"120\" OffDuration=\"180\" OnPower=\"1.2\" OffPower=\"0.6\"/>\n";
+    xml += "<SteadyState Duration=\"900\" Power=\"0.85\"/>\n"
+           "<Cooldown Duration=\"300\" PowerLow=\"0.7\" PowerHigh=\"0.4\"/>\n</workout>\n</workout_file>\n";
+    return xml;
+}
+
+// the parsers log every row
+void silence(QtMsgType, const QMessageLogContext &, const QString &) {}
+
+} // namespace
+
+WorkoutLibraryTestSuite::WorkoutLibraryTestSuite()
+{
+
+}
+
+void WorkoutLibraryTestSuite::test_summarize() {
+    // 10 minutes at 100 W, 10 minutes at 200 W up a 5% grade, a row without a duration
+    QList<trainrow> rows;
+    rows << row(600, 100, 0) << row(600, 200, 5) << row(0, 300);
+    const trainprogramsummary s = workoutlibrary::summarize(rows, 200);
+    EXPECT_EQ(3, s.rows);
+    EXPECT_EQ(1200, s.seconds);
+    EXPECT_FALSE(s.byDistance);
+    EXPECT_DOUBLE_EQ(300, s.maxPower);
+    EXPECT_DOUBLE_EQ(150, s.avgPower);
+    const double np = qPow((qPow(100, 4) + qPow(200, 4)) / 2, 0.25);
+    EXPECT_NEAR(np, s.normalizedPower, 1e-9);
+    EXPECT_NEAR(np / 200, s.intensityFactor, 1e-9);
+    EXPECT_NEAR(1200 / 3600.0 * (np / 200) * (np / 200) * 100, s.tss, 1e-9);
+
+    ASSERT_EQ(trainprogramsummary::PROFILE_POINTS, s.power.count());
+    ASSERT_EQ(trainprogramsummary::PROFILE_POINTS, s.inclination.count());
+    EXPECT_FLOAT_EQ(100, s.power.first());
+    EXPECT_FLOAT_EQ(100, s.power.at(99));
+    EXPECT_FLOAT_EQ(200, s.power.at(100));
+    EXPECT_FLOAT_EQ(200, s.power.last());
+    EXPECT_FLOAT_EQ(0, s.inclination.at(50));
+    EXPECT_FLOAT_EQ(5, s.inclination.at(150));
+
+    // rows shorter than a point of the profile: the points average what they overlap
+    QList<trainrow> sprints;
+    sprints << row(1, 0) << row(1, 300) << row(1, 0);
+    const trainprogramsummary sprint = workoutlibrary::summarize(sprints, 0);
+    EXPECT_NEAR(100, sprint.power.at(66), 1e-3);
+    EXPECT_FLOAT_EQ(300, sprint.power.at(100));
+    EXPECT_NEAR(100, sprint.power.at(133), 1e-3);
+    double sum = 0;
+    for (float watt : sprint.power)
+        sum += watt;
+    EXPECT_NEAR(100, sum / sprint.power.count(), 1e-3);
+    // no ftp, no intensity
+    EXPECT_DOUBLE_EQ(0, sprint.intensityFactor);
+    EXPECT_DOUBLE_EQ(0, sprint.tss);
+
+    // a program by distance: the profile is along the distance, no duration and no TSS
+    QList<trainrow> road;
+    trainrow r;
+    r.distance = 1;
+    r.power = 150;
+    road << r;
+    r.distance = 2;
+    r.inclination = 3;
+    road << r;
+    const trainprogramsummary byDistance = workoutlibrary::summarize(road, 200);
+    EXPECT_TRUE(byDistance.byDistance);
+    EXPECT_DOUBLE_EQ(3, byDistance.distance);
+    EXPECT_EQ(0, byDistance.seconds);
+    EXPECT_FLOAT_EQ(150, byDistance.power.first());
+    EXPECT_FLOAT_EQ(0, byDistance.inclination.first());
+    EXPECT_FLOAT_EQ(3, byDistance.inclination.last());
+    EXPECT_DOUBLE_EQ(0, byDistance.tss);
+
+    const trainprogramsummary empty = workoutlibrary::summarize(QList<trainrow>(), 200);
+    EXPECT_EQ(0, empty.rows);
+    EXPECT_TRUE(empty.power.isEmpty());
+}
+
+void WorkoutLibraryTestSuite::test_incrementalRefresh() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("WorkoutLibraryTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::ftp, 250);
+    settings.activate();
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("library.qzlibrary"));
+    QDir(dir.path()).mkpath(QStringLiteral("pack"));
+    writeFile(dir.filePath(QStringLiteral("pack/intervals.zwo")), zwo(0));
+    QList<trainrow> rows;
+    rows << row(600, 150) << row(600, 200, 2);
+    ASSERT_TRUE(trainprogram::saveXML(dir.filePath(QStringLiteral("program.xml")), rows));
+    writeFile(dir.filePath(QStringLiteral("notes.txt")), "not a workout");
+
+    workoutlibrary library(dir.path(), cache);
+    library.setFtp(250);
+    EXPECT_EQ(2, library.refresh());
+    EXPECT_EQ(2, library.workouts().count());
+    EXPECT_EQ(QStringLiteral("pack/intervals.zwo"), library.workouts().first().fileName);
+
+    // the same as parsing the file on click
+    trainprogramsummary s;
+    ASSERT_TRUE(library.find(QStringLiteral("pack/intervals.zwo"), &s));
+    QString description, tags;
+    const trainprogramsummary loaded = workoutlibrary::summarize(
+        zwiftworkout::load(dir.filePath(QStringLiteral("pack/intervals.zwo")), &description, &tags), 250);
+    EXPECT_EQ(loaded.rows, s.rows);
+    EXPECT_EQ(300 + 6 * 300 + 900 + 300, s.seconds);
+    EXPECT_NEAR(300, s.maxPower, 1);
+    EXPECT_DOUBLE_EQ(loaded.tss, s.tss);
+    EXPECT_GT(s.tss, 0);
+    EXPECT_EQ(loaded.power, s.power);
+    EXPECT_EQ(QStringLiteral("Intervals at 120% FTP"), s.description);
+    EXPECT_TRUE(s.tags.contains(QStringLiteral("#INTERVALS")));
+
+    ASSERT_TRUE(library.find(QStringLiteral("program.xml"), &s));
+    EXPECT_EQ(1200, s.seconds);
+    EXPECT_DOUBLE_EQ(175, s.avgPower);
+    EXPECT_FLOAT_EQ(2, s.inclination.last());
+
+    EXPECT_FALSE(library.find(QStringLiteral("notes.txt"), nullptr));
+
+    // nothing changed: nothing parsed, by this library or by a new one reading the cache
+    EXPECT_EQ(0, library.refresh());
+    workoutlibrary cached(dir.path(), cache);
+    cached.setFtp(250);
+    EXPECT_EQ(0, cached.refresh());
+    EXPECT_EQ(2, cached.workouts().count());
+    ASSERT_TRUE(cached.find(QStringLiteral("pack/intervals.zwo"), &s));
+    EXPECT_EQ(loaded.power, s.power);
+    EXPECT_EQ(QStringLiteral("Intervals at 120% FTP"), s.description);
+
+    // a program changed, a workout deleted
+    rows << row(300, 100);
+    ASSERT_TRUE(trainprogram::saveXML(dir.filePath(QStringLiteral("program.xml")), rows));
+    EXPECT_TRUE(QFile::remove(dir.filePath(QStringLiteral("pack/intervals.zwo"))));
+    EXPECT_EQ(1, cached.refresh());
+    EXPECT_EQ(1, cached.workouts().count());
+    EXPECT_FALSE(cached.find(QStringLiteral("pack/intervals.zwo"), nullptr));
+    ASSERT_TRUE(cached.find(QStringLiteral("program.xml"), &s));
+    EXPECT_EQ(1500, s.seconds);
+
+    // a preview: from the index if it's up to date, parsed otherwise
+    EXPECT_EQ(1500, cached.summary(dir.filePath(QStringLiteral("program.xml"))).seconds);
+    QTemporaryDir other;
+    ASSERT_TRUE(other.isValid());
+    writeFile(other.filePath(QStringLiteral("elsewhere.zwo")), zwo(1));
+    const trainprogramsummary elsewhere = cached.summary(other.filePath(QStringLiteral("elsewhere.zwo")));
+    EXPECT_EQ(QStringLiteral("elsewhere.zwo"), elsewhere.fileName);
+    EXPECT_EQ(300 + 7 * 300 + 900 + 300, elsewhere.seconds);
+}
+
+void WorkoutLibraryTestSuite::test_ftp() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("WorkoutLibraryTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::ftp, 200);
+    settings.activate();
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("library.qzlibrary"));
+    writeFile(dir.filePath(QStringLiteral("a.zwo")), zwo(0));
+    writeFile(dir.filePath(QStringLiteral("b.zwo")), zwo(1));
+
+    workoutlibrary library(dir.path(), cache);
+    library.setFtp(200);
+    EXPECT_EQ(2, library.refresh());
+    trainprogramsummary s;
+    ASSERT_TRUE(library.find(QStringLiteral("a.zwo"), &s));
+    EXPECT_NEAR(240, s.maxPower, 1);
+    const double intensity = s.intensityFactor;
+
+    // the watts of a .zwo follow the ftp, the intensity doesn't (but for the watts rounded down)
+    settings.qsettings.setValue(QZSettings::ftp, 300);
+    library.setFtp(300);
+    EXPECT_FALSE(library.find(QStringLiteral("a.zwo"), nullptr));
+    EXPECT_EQ(2, library.refresh());
+    ASSERT_TRUE(library.find(QStringLiteral("a.zwo"), &s));
+    EXPECT_NEAR(360, s.maxPower, 1);
+    EXPECT_NEAR(intensity, s.intensityFactor, 0.01);
+
+    // the cache of another ftp isn't used
+    workoutlibrary other(dir.path(), cache);
+    other.setFtp(200);
+    settings.qsettings.setValue(QZSettings::ftp, 200);
+    EXPECT_EQ(2, other.refresh());
+    workoutlibrary same(dir.path(), cache);
+    same.setFtp(200);
+    EXPECT_EQ(0, same.refresh());
+}
+
+void WorkoutLibraryTestSuite::test_background() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("WorkoutLibraryTestSuite"));
+    settings.qsettings.clear();
+    settings.activate();
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    for (int i = 0; i < 10; i++)
+        writeFile(dir.filePath(QStringLiteral("workout%1.zwo").arg(i)), zwo(i));
+
+    workoutlibrary library(dir.path(), dir.filePath(QStringLiteral("library.qzlibrary")));
+    library.setFtp(200);
+    int refreshed = 0, parsed = -1;
+    QObject::connect(&library, &workoutlibrary::refreshed, [&refreshed, &parsed](int n) {
+        if (!refreshed++)
+            parsed = n;
+    });
+    library.refreshInBackground();
+    EXPECT_TRUE(spinUntil([&refreshed]() { return refreshed > 0; }, 10000));
+    EXPECT_EQ(10, parsed);
+    EXPECT_FALSE(library.isRefreshing());
+    EXPECT_EQ(10, library.workouts().count());
+
+    // the GUI thread reads the index while it's refreshed
+    writeFile(dir.filePath(QStringLiteral("new.zwo")), zwo(3));
+    library.refreshInBackground();
+    while (library.isRefreshing())
+        EXPECT_GE(library.workouts().count(), 10);
+    EXPECT_TRUE(spinUntil([&refreshed]() { return refreshed > 1; }, 10000));
+    EXPECT_TRUE(library.find(QStringLiteral("new.zwo"), nullptr));
+}
+
+void WorkoutLibraryTestSuite::test_ftpDuringRefresh() {
+    ensureApplication();
+    TestSettings settings(QStringLiteral("Roberto Viola"), QStringLiteral("WorkoutLibraryTestSuite"));
+    settings.qsettings.clear();
+    settings.qsettings.setValue(QZSettings::ftp, 300);
+    settings.activate();
+
+    QTemporaryDir dir;
+    ASSERT_TRUE(dir.isValid());
+    const QString cache = dir.filePath(QStringLiteral("library.qzlibrary"));
+    const int files = 300;
+    for (int i = 0; i < files; i++)
+        writeFile(dir.filePath(QStringLiteral("workout%1.zwo").arg(i)), zwo(i));
+
+    const QtMessageHandler handler = qInstallMessageHandler(silence);
+    workoutlibrary library(dir.path(), cache);
+    library.setFtp(200);
+    int refreshed = 0;
+    QObject::connect(&library, &workoutlibrary::refreshed, [&refreshed](int) { refreshed++; });
+    library.refreshInBackground();
+    // the ftp of the settings changes while the pack is parsed
+    library.setFtp(300);
+    EXPECT_TRUE(spinUntil([&refreshed]() { return refreshed > 0; }, 10000));
+    qInstallMessageHandler(handler);
+
+    // the index is filled, in watts of the new ftp, and so is the cache
+    EXPECT_FALSE(library.isRefreshing());
+    EXPECT_EQ(files, library.workouts().count());
+    trainprogramsummary s;
+    ASSERT_TRUE(library.find(QStringLiteral("workout0.zwo"), &s));
+    EXPECT_NEAR(360, s.maxPower, 1);
+    workoutlibrary cached(dir.path(), cache);
+    cached.setFtp(300);
+    EXPECT_EQ(0, cached.refresh());
+    EXPECT_EQ(files, cached.workouts().count());
+}
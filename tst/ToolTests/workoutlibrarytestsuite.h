@@ -0,0 +1,57 @@
+#ifndef WORKOUTLIBRARYTESTSUITE_H
+#define WORKOUTLIBRARYTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class WorkoutLibraryTestSuite: public testing::Test {
+
+public:
+    WorkoutLibraryTestSuite();
+
+    /**
+     * @brief Test the duration, the power, the intensity factor, the TSS and the profiles of a summary
+     */
+    void test_summarize();
+
+    /**
+     * @brief Test that refresh() only parses the programs new or changed since the cache was written
+     */
+    void test_incrementalRefresh();
+
+    /**
+     * @brief Test that changing the ftp summarizes the files again
+     */
+    void test_ftp();
+
+    /**
+     * @brief Test the refresh on a background thread
+     */
+    void test_background();
+
+    /**
+     * @brief Test that changing the ftp during a background refresh still fills the index, with the new ftp
+     */
+    void test_ftpDuringRefresh();
+};
+
+TEST_F(WorkoutLibraryTestSuite, TestSummarize) {
+    this->test_summarize();
+}
+
+TEST_F(WorkoutLibraryTestSuite, TestIncrementalRefresh) {
+    this->test_incrementalRefresh();
+}
+
+TEST_F(WorkoutLibraryTestSuite, TestFtp) {
+    this->test_ftp();
+}
+
+TEST_F(WorkoutLibraryTestSuite, TestBackground) {
+    this->test_background();
+}
+
+TEST_F(WorkoutLibraryTestSuite, TestFtpDuringRefresh) {
+    this->test_ftpDuringRefresh();
+}
+
+#endif // WORKOUTLIBRARYTESTSUITE_H
@@ -0,0 +1,215 @@
+#include "zwiftrelaytestsuite.h"
+
+#include <QElapsedTimer>
+#include <QTemporaryFile>
+#include "Tools/testapplication.h"
+#include "Tools/zwiftrelaymock.h"
+#include "zwift-api/ZwiftRelay.h"
+
+namespace {
+
+// a ride up a 5% climb, a state every 5 seconds
+QList<QByteArray> climb(int count) {
+    QList<QByteArray> states;
+    for (int i = 0; i < count; i++) {
+        ZwiftPlayerState s;
+        s.id = 1234;
+        s.worldTime = 1000000 + i * 5000;
+        s.distance = 10000 + i * 40;
+        s.altitude = 9000 + i * 40 * 5;
+        s.speed = 8000000;
+        s.power = 250;
+        s.f19 = 0x03000004;
+        states.append(ZwiftRelayMock::encode(s));
+    }
+    return states;
+}
+
+} // namespace
+
+ZwiftRelayTestSuite::ZwiftRelayTestSuite()
+{
+
+}
+
+void ZwiftRelayTestSuite::test_decode() {
+    ZwiftPlayerState s;
+    s.id = 1234;
+    s.worldTime = 0x123456789ALL;
+    s.distance = 42195;
+    s.roadTime = 5000;
+    s.laps = 2;
+    s.speed = 35000000;
+    s.roadPosition = -120;
+    s.cadenceUHz = 1500000;
+    s.heartrate = 150;
+    s.power = 275;
+    s.heading = -3141592;
+    s.lean = -5;
+    s.climbing = 300;
+    s.time = 3600;
+    s.f19 = 0x0403000C;
+    s.f20 = 0x12345;
+    s.progress = 77;
+    s.customisationId = 0x7FFFFFFFFFLL;
+    s.justWatching = 1;
+    s.calories = 900;
+    s.x = -1234.5f;
+    s.altitude = 9123.25f;
+    s.y = 55.5f;
+    s.watchingRiderId = 99;
+    s.groupId = 7;
+    s.sport = 1;
+    const QByteArray encoded = ZwiftRelayMock::encode(s);
+
+    ZwiftPlayerState d;
+    ASSERT_TRUE(d.decode(encoded.constData(), encoded.size()));
+    EXPECT_EQ(s.id, d.id);
+    EXPECT_EQ(s.worldTime, d.worldTime);
+    EXPECT_EQ(s.distance, d.distance);
+    EXPECT_EQ(s.roadTime, d.roadTime);
+    EXPECT_EQ(s.laps, d.laps);
+    EXPECT_EQ(s.speed, d.speed);
+    EXPECT_EQ(s.roadPosition, d.roadPosition);
+    EXPECT_EQ(s.cadenceUHz, d.cadenceUHz);
+    EXPECT_EQ(90, d.cadence());
+    EXPECT_EQ(s.heartrate, d.heartrate);
+    EXPECT_EQ(s.power, d.power);
+    EXPECT_EQ(s.heading, d.heading);
+    EXPECT_EQ(s.lean, d.lean);
+    EXPECT_EQ(s.climbing, d.climbing);
+    EXPECT_EQ(s.time, d.time);
+    EXPECT_EQ(s.f19, d.f19);
+    EXPECT_EQ(s.f20, d.f20);
+    EXPECT_EQ(s.progress, d.progress);
+    EXPECT_EQ(s.customisationId, d.customisationId);
+    EXPECT_EQ(s.justWatching, d.justWatching);
+    EXPECT_EQ(s.calories, d.calories);
+    EXPECT_FLOAT_EQ(s.x, d.x);
+    EXPECT_FLOAT_EQ(s.altitude, d.altitude);
+    EXPECT_FLOAT_EQ(s.y, d.y);
+    EXPECT_EQ(s.watchingRiderId, d.watchingRiderId);
+    EXPECT_EQ(s.groupId, d.groupId);
+    EXPECT_EQ(s.sport, d.sport);
+
+    // fields of a newer relay, of every wire type, are skipped
+    QByteArray extended = encoded;
+    extended.append(QByteArray::fromHex("b80296d205"));             // 39: varint
+    extended.append(QByteArray::fromHex("c10201020304050607 08"));  // 40: fixed64
+    extended.append(QByteArray::fromHex("ca0203616263"));           // 41: "abc"
+    extended.append(QByteArray::fromHex("d50201020304"));           // 42: fixed32
+    ASSERT_TRUE(d.decode(extended.constData(), extended.size()));
+    EXPECT_EQ(s.power, d.power);
+    EXPECT_FLOAT_EQ(s.altitude, d.altitude);
+
+    // an empty message is all zeros
+    ASSERT_TRUE(d.decode("", 0));
+    EXPECT_EQ(0, d.power);
+    EXPECT_FLOAT_EQ(0, d.altitude);
+
+    // cut anywhere in a field
+    int truncated = 0;
+    for (int size = 1; size < encoded.size(); size++) {
+        ZwiftPlayerState t;
+        if (!t.decode(encoded.constData(), size))
+            truncated++;
+    }
+    EXPECT_GT(truncated, 0);
+    const QByteArray cut = encoded.left(encoded.size() - 1);
+    EXPECT_FALSE(d.decode(cut.constData(), cut.size()));
+    const QByteArray group = QByteArray::fromHex("0b");
+    EXPECT_FALSE(d.decode(group.constData(), group.size()));
+}
+
+void ZwiftRelayTestSuite::test_replay() {
+    ensureApplication();
+
+    // the recording, as written by a capture of the relay
+    const QList<QByteArray> recorded = climb(20);
+    QTemporaryFile file;
+    ASSERT_TRUE(file.open());
+    file.write(ZwiftRelayMock::delimited(recorded));
+    file.close();
+
+    ZwiftRelayMock mock(1234);
+    ASSERT_TRUE(mock.load(file.fileName()));
+    ASSERT_EQ(recorded, ZwiftRelayMock::split(ZwiftRelayMock::delimited(recorded)));
+    ASSERT_TRUE(mock.listen());
+
+    ZwiftRelay relay(1);
+    relay.setBaseUrl(mock.baseUrl());
+    relay.setAccessToken(QStringLiteral("token"));
+
+    ZwiftPlayerState state;
+    quint32 version = 0;
+    EXPECT_FALSE(relay.poll());
+    EXPECT_FALSE(relay.latest(&state, &version));
+
+    bool logged = false;
+    QObject::connect(&relay, &ZwiftRelay::loginState, [&logged](bool ok) { logged = ok; });
+    relay.requestPlayer();
+    ASSERT_TRUE(spinUntil([&logged]() { return logged; }));
+    EXPECT_EQ(1234, relay.player());
+    EXPECT_EQ(QByteArray("Bearer token"), mock.authorization());
+
+    for (int i = 0; i < recorded.count(); i++) {
+        ASSERT_TRUE(relay.poll());
+        ASSERT_TRUE(spinUntil([&]() { return relay.latest(&state, &version); }));
+        ZwiftPlayerState expected;
+        expected.decode(recorded.at(i).constData(), recorded.at(i).size());
+        EXPECT_EQ(expected.worldTime, state.worldTime);
+        EXPECT_EQ(expected.distance, state.distance);
+        EXPECT_FLOAT_EQ(expected.altitude, state.altitude);
+        // nothing new until the next answer
+        EXPECT_FALSE(relay.latest(&state, &version));
+    }
+    EXPECT_EQ(recorded.count(), mock.statesSent());
+    EXPECT_EQ(recorded.count() + 1, mock.requests());
+    // one connection for all of them
+    EXPECT_EQ(1, mock.connections());
+
+    // the incline of the scheduler
+    ZwiftPlayerState first, last;
+    first.decode(recorded.first().constData(), recorded.first().size());
+    last.decode(recorded.last().constData(), recorded.last().size());
+    EXPECT_FLOAT_EQ(5.0f, (last.altitude - first.altitude) / (last.distance - first.distance));
+}
+
+void ZwiftRelayTestSuite::test_slow() {
+    ensureApplication();
+
+    ZwiftRelayMock mock(1234);
+    mock.setStates(climb(10));
+    ASSERT_TRUE(mock.listen());
+
+    ZwiftRelay relay(1);
+    relay.setBaseUrl(mock.baseUrl());
+    relay.setMaxInFlight(2);
+    bool logged = false;
+    QObject::connect(&relay, &ZwiftRelay::loginState, [&logged](bool ok) { logged = ok; });
+    relay.requestPlayer();
+    ASSERT_TRUE(spinUntil([&logged]() { return logged; }));
+
+    // a relay taking 300 ms to answer: the polls of the scheduler still return at once
+    mock.setDelay(300);
+    QElapsedTimer timer;
+    timer.start();
+    EXPECT_TRUE(relay.poll());
+    EXPECT_TRUE(relay.poll());
+    EXPECT_FALSE(relay.poll());
+    const qint64 pollMs = timer.elapsed();
+    EXPECT_LT(pollMs, 100);
+    EXPECT_EQ(2, relay.inFlight());
+
+    ZwiftPlayerState state;
+    quint32 version = 0;
+    EXPECT_FALSE(relay.latest(&state, &version));
+    ASSERT_TRUE(spinUntil([&relay]() { return relay.inFlight() == 0; }));
+    EXPECT_GE(timer.elapsed(), 300);
+    EXPECT_GE(relay.latencyMs(), 300);
+
+    // the newest of the answers
+    ASSERT_TRUE(relay.latest(&state, &version));
+    EXPECT_EQ(1000000 + 5000, state.worldTime);
+    EXPECT_LE(mock.connections(), 2);
+}
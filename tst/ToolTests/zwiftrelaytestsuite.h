@@ -0,0 +1,39 @@
+#ifndef ZWIFTRELAYTESTSUITE_H
+#define ZWIFTRELAYTESTSUITE_H
+
+#include "gtest/gtest.h"
+
+class ZwiftRelayTestSuite: public testing::Test {
+
+public:
+    ZwiftRelayTestSuite();
+
+    /**
+     * @brief Test the decoding of PlayerState messages: every field, negative values, unknown fields, truncation
+     */
+    void test_decode();
+
+    /**
+     * @brief Test a recorded stream replayed by the mock relay through one kept alive connection into the mailbox
+     */
+    void test_replay();
+
+    /**
+     * @brief Test that polling a slow relay returns at once, and that the polls beyond the ones in flight are dropped
+     */
+    void test_slow();
+};
+
+TEST_F(ZwiftRelayTestSuite, TestDecode) {
+    this->test_decode();
+}
+
+TEST_F(ZwiftRelayTestSuite, TestReplay) {
+    this->test_replay();
+}
+
+TEST_F(ZwiftRelayTestSuite, TestSlow) {
+    this->test_slow();
+}
+
+#endif // ZWIFTRELAYTESTSUITE_H
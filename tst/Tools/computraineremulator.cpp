@@ -0,0 +1,154 @@
+#include "computraineremulator.h"
+
+#ifdef CT_POLL
+
+#include <QElapsedTimer>
+#include <cmath>
+#include <cstring>
+
+ComputrainerEmulator::ComputrainerEmulator(QObject *parent) : QThread(parent) {}
+
+ComputrainerEmulator::~ComputrainerEmulator() {
+    stop();
+    if (master != -1)
+        close(master);
+}
+
+bool ComputrainerEmulator::open() {
+    master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if (master == -1 || grantpt(master) == -1 || unlockpt(master) == -1)
+        return false;
+    const char *name = ptsname(master);
+    if (!name)
+        return false;
+    slaveName = QString::fromLatin1(name);
+
+    // raw until Computrainer sets the port up: nothing echoed back
+    struct termios settings;
+    tcgetattr(master, &settings);
+    cfmakeraw(&settings);
+    tcsetattr(master, TCSANOW, &settings);
+
+    running = true;
+    start();
+    return true;
+}
+
+void ComputrainerEmulator::stop() {
+    running = false;
+    wait();
+}
+
+QByteArray ComputrainerEmulator::message(int type, int value) {
+    QByteArray m(7, 0);
+    m[4] = (char)((type << 3) | ((value >> 9) & 7));
+    m[5] = (char)((value >> 1) & 127);
+    m[6] = (char)(128 | ((value >> 8) & 1) << 1 | (value & 1));
+    return m;
+}
+
+void ComputrainerEmulator::send(const QByteArray &bytes) {
+    // the slave may be closed, between discover() and start(): what is lost is lost
+    if (write(master, bytes.constData(), bytes.size()) == -1)
+        return;
+}
+
+void ComputrainerEmulator::command(const uint8_t *packet) {
+    const int value = (packet[4] & 7) << 9 | (packet[6] & 2) << 7 | packet[5] << 1 | (packet[6] & 1);
+    if (packet[3] == 0x0A && (packet[4] & 0x78) == 0x40) {
+        currentMode = CT_ERGOMODE;
+        currentLoad = value;
+        commandCount++;
+    } else if (packet[3] == 0x16 && (packet[4] & 0x78) == 0x08) {
+        currentMode = CT_SSMODE;
+        // a negative gradient is the complement of its absolute value
+        currentGradient = (value & 2048 ? -((~value) & 2047) : value) / 10.0;
+        commandCount++;
+    }
+}
+
+void ComputrainerEmulator::received(const char *bytes, int size) {
+    pending.append(bytes, size);
+    const int hello = pending.indexOf("RacerMate");
+    if (hello != -1) {
+        pending.remove(0, hello + 9);
+        greeting = true;
+        send(QByteArray("LinkUp"));
+    }
+
+    // 7 byte packets, the last byte has the sync bit
+    int k = 0;
+    while (pending.size() - k >= 7) {
+        const uint8_t *packet = (const uint8_t *)pending.constData() + k;
+        if (packet[6] & 128) {
+            command(packet);
+            k += 7;
+        } else {
+            k++;
+        }
+    }
+    pending.remove(0, k);
+}
+
+void ComputrainerEmulator::run() {
+    static const int types[] = {CT_POWER, CT_SPEED, CT_POWER, CT_HEARTRATE, CT_POWER, CT_CADENCE, CT_POWER, CT_SENSOR};
+    const int typeCount = sizeof(types) / sizeof(types[0]);
+    QElapsedTimer clock;
+    clock.start();
+    qint64 next = 0, last = 0;
+    int typeIndex = 0;
+    char rx[256];
+
+    while (running) {
+        const qint64 now = clock.nsecsElapsed() / 1000;
+        struct pollfd fd = {master, POLLIN, 0};
+        const int timeout = commandCount ? (int)qBound<qint64>(0, (next - now + 999) / 1000, 10) : 10;
+        if (poll(&fd, 1, timeout) > 0) {
+            if (fd.revents & POLLIN) {
+                const int n = read(master, rx, sizeof(rx));
+                if (n > 0)
+                    received(rx, n);
+            } else {
+                // the slave is closed
+                QThread::msleep(1);
+            }
+        }
+
+        // nothing before the first command, the greeting must come alone
+        const qint64 t = clock.nsecsElapsed() / 1000;
+        if (!commandCount || t < next)
+            continue;
+
+        // the brake tends to the load
+        const double target = currentMode == CT_ERGOMODE ? currentLoad.load() : 100 + 25 * currentGradient;
+        const double dt = (t - last) / 1000.0;
+        power = responseMs > 0 ? target + (power - target) * std::exp(-dt / responseMs) : target;
+        last = t;
+
+        const int type = types[typeIndex++ % typeCount];
+        int value = 0;
+        switch (type) {
+        case CT_POWER:
+            value = qBound(0, (int)std::lround(power), 4095);
+            break;
+        case CT_SPEED:
+            // the inverse of the conversion of Computrainer, kph * 1000 * 10 / 9 / 36
+            value = qBound(0, (int)std::lround(riderSpeed * 10000.0 / 324.0), 4095);
+            break;
+        case CT_HEARTRATE:
+            value = riderHeartRate;
+            break;
+        case CT_CADENCE:
+            value = riderCadence;
+            break;
+        case CT_SENSOR:
+            value = 2048 | 1024;
+            break;
+        }
+        send(message(type, value));
+        messageCount++;
+        next = qMax(next + interval, t);
+    }
+}
+
+#endif // CT_POLL
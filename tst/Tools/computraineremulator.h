@@ -0,0 +1,86 @@
+#ifndef COMPUTRAINEREMULATOR_H
+#define COMPUTRAINEREMULATOR_H
+
+#include "devices/computrainerbike/Computrainer.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QThread>
+#include <atomic>
+
+#ifdef CT_POLL
+
+/**
+ * @brief A Computrainer on a pseudo-terminal: Computrainer opens deviceName() as its serial port. It answers the
+ * "RacerMate" greeting, decodes the commands (load in ERGOMODE, gradient in SSMODE) and, once the first command is
+ * received, sends a telemetry message every messageInterval, a power message every other one. The power tends to
+ * the load with the time constant of setResponseTime(), like the brake of a trainer with a rider at a steady cadence.
+ */
+class ComputrainerEmulator : public QThread {
+  public:
+    explicit ComputrainerEmulator(QObject *parent = nullptr);
+    ~ComputrainerEmulator() override;
+
+    /**
+     * @brief Opens the pseudo-terminal and starts the thread.
+     */
+    bool open();
+    void stop();
+    QString deviceName() const { return slaveName; }
+
+    /**
+     * @brief The time between two messages, in microseconds: 29167 at 2400 baud like the real one.
+     */
+    void setMessageInterval(int us) { interval = us; }
+    /**
+     * @brief The time constant of the power, in milliseconds, 0 for a power that is the load at once.
+     */
+    void setResponseTime(int ms) { responseMs = ms; }
+    void setRider(int cadence, int heartRate, double speed) {
+        riderCadence = cadence;
+        riderHeartRate = heartRate;
+        riderSpeed = speed;
+    }
+
+    bool greeted() const { return greeting; }
+    int commands() const { return commandCount; }
+    int messages() const { return messageCount; }
+    int mode() const { return currentMode; }
+    int load() const { return currentLoad; }
+    double gradient() const { return currentGradient; }
+
+    /**
+     * @brief The 7 bytes of a telemetry message, as unpacked by Computrainer.
+     */
+    static QByteArray message(int type, int value);
+
+  protected:
+    void run() override;
+
+  private:
+    void received(const char *bytes, int size);
+    void command(const uint8_t *packet);
+    void send(const QByteArray &bytes);
+
+    int master = -1;
+    QString slaveName;
+    QByteArray pending;
+    double power = 0;
+
+    std::atomic<bool> running{false};
+    std::atomic<bool> greeting{false};
+    std::atomic<int> interval{29167};
+    std::atomic<int> responseMs{0};
+    std::atomic<int> riderCadence{90};
+    std::atomic<int> riderHeartRate{120};
+    std::atomic<double> riderSpeed{30};
+    std::atomic<int> commandCount{0};
+    std::atomic<int> messageCount{0};
+    std::atomic<int> currentMode{0};
+    std::atomic<int> currentLoad{0};
+    std::atomic<double> currentGradient{0};
+};
+
+#endif // CT_POLL
+
+#endif // COMPUTRAINEREMULATOR_H
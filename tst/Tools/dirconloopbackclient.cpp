@@ -0,0 +1,139 @@
+#include "dirconloopbackclient.h"
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QHostAddress>
+#include <QRegularExpression>
+#include <QTextStream>
+#include <algorithm>
+#include "devices/dircon/dirconpacket.h"
+
+DirconLoopbackClient::DirconLoopbackClient(QObject *parent) : QObject(parent) {
+    connect(&socket, SIGNAL(readyRead()), this, SLOT(dataAvailable()));
+    clock.start();
+}
+
+bool DirconLoopbackClient::connectToServer(quint16 port, int timeoutMs) {
+    socket.connectToHost(QHostAddress(QHostAddress::LocalHost), port);
+    QElapsedTimer timer;
+    timer.start();
+    while (socket.state() != QAbstractSocket::ConnectedState && timer.elapsed() < timeoutMs)
+        spin(1);
+    // the server gets the connection in its own slot
+    spin(10);
+    return socket.state() == QAbstractSocket::ConnectedState;
+}
+
+void DirconLoopbackClient::disconnectFromServer() {
+    socket.disconnectFromHost();
+    spin(10);
+}
+
+void DirconLoopbackClient::spin(int ms) {
+    QElapsedTimer timer;
+    timer.start();
+    do {
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    } while (timer.elapsed() < ms);
+}
+
+QByteArray DirconLoopbackClient::request(quint8 identifier, quint8 seq, quint16 uuid, const QByteArray &data) {
+    DirconPacket pkt;
+    pkt.isRequest = true;
+    pkt.Identifier = identifier;
+    pkt.uuid = uuid;
+    pkt.additional_data = data;
+    return pkt.encode(seq);
+}
+
+QList<QByteArray> DirconLoopbackClient::splitFrames(const QByteArray &stream) {
+    QList<QByteArray> frames;
+    int pos = 0;
+    while (stream.size() - pos >= DPKT_MESSAGE_HEADER_LENGTH) {
+        const int len = (((quint8)stream.at(pos + 4)) << 8) | ((quint8)stream.at(pos + 5));
+        if (stream.size() - pos < DPKT_MESSAGE_HEADER_LENGTH + len)
+            break;
+        frames.append(stream.mid(pos, DPKT_MESSAGE_HEADER_LENGTH + len));
+        pos += DPKT_MESSAGE_HEADER_LENGTH + len;
+    }
+    return frames;
+}
+
+QList<QByteArray> DirconLoopbackClient::framesFromLog(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text))
+        return QList<QByteArray>();
+    static const QRegularExpression line(QStringLiteral("Data available for uuid.*:\\s*\"?([0-9a-fA-F]+)\"?\\s*$"));
+    QByteArray stream;
+    QTextStream in(&file);
+    while (!in.atEnd()) {
+        QRegularExpressionMatch m = line.match(in.readLine());
+        if (m.hasMatch())
+            stream.append(QByteArray::fromHex(m.captured(1).toLatin1()));
+    }
+    return splitFrames(stream);
+}
+
+int DirconLoopbackClient::replay(const QList<QByteArray> &frames, int timeoutMs) {
+    const int before = responseCount;
+    for (const QByteArray &frame : frames) {
+        if (frame.size() < DPKT_MESSAGE_HEADER_LENGTH)
+            continue;
+        const quint8 seq = (quint8)frame.at(2);
+        const int expected = responseCount + 1;
+        pending.insert(seq, clock.nsecsElapsed());
+        socket.write(frame);
+        QElapsedTimer timer;
+        timer.start();
+        while (responseCount < expected && timer.elapsed() < timeoutMs)
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+        if (responseCount < expected)
+            break;
+    }
+    return responseCount - before;
+}
+
+bool DirconLoopbackClient::waitNotifications(int count, int timeoutMs) {
+    QElapsedTimer timer;
+    timer.start();
+    while (notificationCount < count && timer.elapsed() < timeoutMs)
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 1);
+    return notificationCount >= count;
+}
+
+qint64 DirconLoopbackClient::latencyPercentile(double p) const {
+    if (latencyNs.isEmpty())
+        return 0;
+    QVector<qint64> sorted = latencyNs;
+    std::sort(sorted.begin(), sorted.end());
+    const int i = qBound(0, (int)(p * (sorted.count() - 1) + 0.5), sorted.count() - 1);
+    return sorted.at(i);
+}
+
+void DirconLoopbackClient::dataAvailable() {
+    const qint64 now = clock.nsecsElapsed();
+    received.append(socket.readAll());
+    int pos = 0;
+    while (received.size() - pos >= DPKT_MESSAGE_HEADER_LENGTH) {
+        const int len = (((quint8)received.at(pos + 4)) << 8) | ((quint8)received.at(pos + 5));
+        if (received.size() - pos < DPKT_MESSAGE_HEADER_LENGTH + len)
+            break;
+        const quint8 identifier = (quint8)received.at(pos + 1);
+        const quint8 seq = (quint8)received.at(pos + 2);
+        if (identifier == DPKT_MSGID_UNSOLICITED_CHARACTERISTIC_NOTIFICATION) {
+            notificationCount++;
+            notificationByteCount += DPKT_MESSAGE_HEADER_LENGTH + len;
+        } else {
+            if ((quint8)received.at(pos + 3) != DPKT_RESPCODE_SUCCESS_REQUEST)
+                errorCount++;
+            QHash<quint8, qint64>::iterator it = pending.find(seq);
+            if (it != pending.end()) {
+                latencyNs.append(now - it.value());
+                pending.erase(it);
+            }
+            responseCount++;
+        }
+        pos += DPKT_MESSAGE_HEADER_LENGTH + len;
+    }
+    received.remove(0, pos);
+}
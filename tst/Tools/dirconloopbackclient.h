@@ -0,0 +1,82 @@
+#ifndef DIRCONLOOPBACKCLIENT_H
+#define DIRCONLOOPBACKCLIENT_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTcpSocket>
+#include <QVector>
+
+/**
+ * @brief A Dircon client for a DirconProcessor on the loopback interface, driving the event loop of the thread
+ * while it waits (the processor must live in the same thread). It replays the request frames of a session,
+ * measuring the time to the response of each one, and counts the notifications received meanwhile.
+ */
+class DirconLoopbackClient : public QObject {
+    Q_OBJECT
+  public:
+    explicit DirconLoopbackClient(QObject *parent = nullptr);
+
+    bool connectToServer(quint16 port, int timeoutMs = 3000);
+    void disconnectFromServer();
+
+    /**
+     * @brief A request frame as a Dircon client (e.g. Zwift) sends it.
+     */
+    static QByteArray request(quint8 identifier, quint8 seq, quint16 uuid = 0, const QByteArray &data = QByteArray());
+
+    /**
+     * @brief The client to server byte stream of a session recorded in a debug log, from the lines
+     * "Data available for uuid <name> : <hex>", split in frames.
+     */
+    static QList<QByteArray> framesFromLog(const QString &fileName);
+
+    /**
+     * @brief Splits a byte stream in frames, dropping the incomplete frame at the end if any.
+     */
+    static QList<QByteArray> splitFrames(const QByteArray &stream);
+
+    /**
+     * @brief Sends the frames one by one, waiting for the response to each one before sending the next.
+     * @return the number of responses received.
+     */
+    int replay(const QList<QByteArray> &frames, int timeoutMs = 3000);
+
+    /**
+     * @brief Runs the event loop until count notifications in total have been received.
+     */
+    bool waitNotifications(int count, int timeoutMs = 3000);
+
+    /**
+     * @brief Runs the event loop for the time specified.
+     */
+    static void spin(int ms);
+
+    /**
+     * @brief Time from each request written to its response, in nanoseconds.
+     */
+    const QVector<qint64> &latencies() const { return latencyNs; }
+    qint64 latencyPercentile(double p) const;
+    int notifications() const { return notificationCount; }
+    qint64 notificationBytes() const { return notificationByteCount; }
+    int errors() const { return errorCount; }
+
+  private slots:
+    void dataAvailable();
+
+  private:
+    QTcpSocket socket;
+    QByteArray received;
+    QElapsedTimer clock;
+    // sequence number -> time the request was written
+    QHash<quint8, qint64> pending;
+    QVector<qint64> latencyNs;
+    int responseCount = 0;
+    int notificationCount = 0;
+    qint64 notificationByteCount = 0;
+    int errorCount = 0;
+};
+
+#endif // DIRCONLOOPBACKCLIENT_H
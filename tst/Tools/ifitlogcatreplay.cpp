@@ -0,0 +1,78 @@
+#include "ifitlogcatreplay.h"
+
+#include <QElapsedTimer>
+#include <QFile>
+#include <QThread>
+#include <cstring>
+#include <random>
+
+IfitLogcatReplay::IfitLogcatReplay(const QByteArray &capture) : data(capture) {}
+
+bool IfitLogcatReplay::load(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    data = file.readAll();
+    return true;
+}
+
+qint64 IfitLogcatReplay::timestamp(const char *line, int size) {
+    // "10-18 12:34:56.789"
+    static const char format[] = "00-00 00:00:00.000";
+    const int length = sizeof(format) - 1;
+    if (size < length)
+        return -1;
+    for (int i = 0; i < length; i++) {
+        const bool digit = line[i] >= '0' && line[i] <= '9';
+        if (format[i] == '0' ? !digit : line[i] != format[i])
+            return -1;
+    }
+    auto number = [line](int at, int digits) {
+        int n = 0;
+        for (int i = 0; i < digits; i++)
+            n = n * 10 + (line[at + i] - '0');
+        return n;
+    };
+    return ((number(6, 2) * 60 + number(9, 2)) * 60 + number(12, 2)) * 1000LL + number(15, 3);
+}
+
+int IfitLogcatReplay::replay(const std::function<void(const QByteArray &)> &sink) const {
+    std::mt19937 random(seed);
+    std::uniform_int_distribution<int> chunkSize(minChunk, maxChunk);
+    QElapsedTimer clock;
+    clock.start();
+    qint64 first = -1;
+    int chunks = 0;
+
+    const char *begin = data.constData();
+    const int size = data.size();
+    int position = 0;
+    while (position < size) {
+        const int length = qMin(chunkSize(random), size - position);
+
+        if (speed > 0) {
+            // the time of the last line starting in the chunk
+            qint64 time = -1;
+            for (int i = position; i < position + length; i++) {
+                if (i == 0 || begin[i - 1] == '\n') {
+                    const char *lf = (const char *)memchr(begin + i, '\n', size - i);
+                    const qint64 t = timestamp(begin + i, (int)(lf ? lf - begin : size) - i);
+                    if (t != -1)
+                        time = t;
+                }
+            }
+            if (time != -1) {
+                if (first == -1)
+                    first = time;
+                const qint64 due = (qint64)((time - first) / speed);
+                if (due > clock.elapsed())
+                    QThread::msleep(due - clock.elapsed());
+            }
+        }
+
+        sink(QByteArray::fromRawData(begin + position, length));
+        position += length;
+        chunks++;
+    }
+    return chunks;
+}
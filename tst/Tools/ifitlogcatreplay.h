@@ -0,0 +1,55 @@
+#ifndef IFITLOGCATREPLAY_H
+#define IFITLOGCATREPLAY_H
+
+#include <QByteArray>
+#include <QString>
+#include <functional>
+
+/**
+ * @brief Replays a logcat capture of an iFit console (adb logcat, threadtime format) to a device or a parser, in
+ * chunks of random sizes like the reads of adb: the lines are split anywhere. The chunks are delivered at the pace of
+ * the timestamps of the capture, accelerated by setSpeed(), or as fast as possible.
+ */
+class IfitLogcatReplay {
+  public:
+    explicit IfitLogcatReplay(const QByteArray &capture = QByteArray());
+
+    /**
+     * @brief Loads the capture from a file.
+     */
+    bool load(const QString &fileName);
+    const QByteArray &capture() const { return data; }
+
+    /**
+     * @brief The sizes of the chunks, random between minimum and maximum, the same ones for the same seed.
+     */
+    void setChunkSize(int minimum, int maximum, quint32 seed = 1) {
+        minChunk = minimum;
+        maxChunk = maximum;
+        this->seed = seed;
+    }
+    /**
+     * @brief How faster than the capture it is replayed, 0 for as fast as possible.
+     */
+    void setSpeed(double factor) { speed = factor; }
+
+    /**
+     * @brief Delivers the capture to sink, returns the number of chunks. A chunk is not copied, it's only valid
+     * during the call.
+     */
+    int replay(const std::function<void(const QByteArray &)> &sink) const;
+
+    /**
+     * @brief The time of a line of logcat, "MM-DD HH:MM:SS.mmm ...", in milliseconds since midnight, -1 without it.
+     */
+    static qint64 timestamp(const char *line, int size);
+
+  private:
+    QByteArray data;
+    int minChunk = 1;
+    int maxChunk = 4096;
+    quint32 seed = 1;
+    double speed = 0;
+};
+
+#endif // IFITLOGCATREPLAY_H
@@ -0,0 +1,10 @@
+#include "testapplication.h"
+
+void ensureApplication() {
+    if (!QCoreApplication::instance()) {
+        static int argc = 1;
+        static char name[] = "qdomyos-zwift-tests";
+        static char *argv[] = {name, nullptr};
+        new QCoreApplication(argc, argv);
+    }
+}
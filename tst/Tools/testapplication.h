@@ -0,0 +1,28 @@
+#ifndef TESTAPPLICATION_H
+#define TESTAPPLICATION_H
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+
+/**
+ * @brief Creates the QCoreApplication of the tests if there isn't one yet, for the code needing an event loop: timers,
+ * queued signals, objects living on other threads.
+ */
+void ensureApplication();
+
+/**
+ * @brief Runs the event loop until done() returns true.
+ * @return false if it didn't within timeoutMs.
+ */
+template <typename F> bool spinUntil(F done, int timeoutMs = 3000) {
+    QElapsedTimer timer;
+    timer.start();
+    while (!done()) {
+        if (timer.elapsed() > timeoutMs)
+            return false;
+        QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+    }
+    return true;
+}
+
+#endif // TESTAPPLICATION_H
@@ -1,4 +1,5 @@
 #include "testsettings.h"
+#include "qzsettingssnapshot.h"
 
 void TestSettings::activate() {
     if(this->active) return;
@@ -10,6 +11,7 @@ void TestSettings::activate() {
     QCoreApplication::setOrganizationName(this->qsettings.organizationName());
 
     this->active = true;
+    QZSettingsSnapshot::instance()->reload();
 }
 
 void TestSettings::deactivate() {
@@ -19,9 +21,14 @@ void TestSettings::deactivate() {
     QCoreApplication::setOrganizationName(this->orgName);
 
     this->active = false;
+    QZSettingsSnapshot::instance()->reload();
 }
 
-void TestSettings::loadFrom(const DeviceDiscoveryInfo &info, bool clear){ info.setValues(this->qsettings, clear);}
+void TestSettings::loadFrom(const DeviceDiscoveryInfo &info, bool clear){
+    info.setValues(this->qsettings, clear);
+    if(this->active)
+        QZSettingsSnapshot::instance()->reload();
+}
 
 TestSettings::~TestSettings() {
     this->deactivate();
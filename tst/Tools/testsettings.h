@@ -12,6 +12,8 @@
  * in the system. It also makes the stored QSettings object the default by setting the QCoreApplication's
  * organisation and application names to those of the QSettings object. The original values
  * are restored by calling the deactivate() function or on object destruction.
+ * Activating, deactivating and loading values also reloads the QZSettingsSnapshot, so code reading the
+ * hot path snapshot sees the test configuration.
  */
 class TestSettings
 {
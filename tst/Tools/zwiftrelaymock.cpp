@@ -0,0 +1,193 @@
+#include "zwiftrelaymock.h"
+
+#include <QFile>
+#include <QHostAddress>
+#include <QTcpSocket>
+#include <QTimer>
+#include <cstring>
+
+namespace {
+
+void writeVarint(QByteArray &out, quint64 v) {
+    while (v >= 0x80) {
+        out.append((char)((v & 0x7F) | 0x80));
+        v >>= 7;
+    }
+    out.append((char)v);
+}
+
+void writeInt(QByteArray &out, int field, qint64 v) {
+    if (!v)
+        return;
+    writeVarint(out, (quint64)field << 3);
+    // negative values take 10 bytes, like the int32 of the relay
+    writeVarint(out, (quint64)v);
+}
+
+void writeFloat(QByteArray &out, int field, float v) {
+    if (v == 0)
+        return;
+    writeVarint(out, ((quint64)field << 3) | 5);
+    quint32 bits;
+    memcpy(&bits, &v, sizeof(bits));
+    for (int i = 0; i < 4; i++)
+        out.append((char)((bits >> (8 * i)) & 0xFF));
+}
+
+} // namespace
+
+ZwiftRelayMock::ZwiftRelayMock(int playerId, QObject *parent) : QObject(parent), playerId(playerId) {
+    connect(&server, &QTcpServer::newConnection, this, &ZwiftRelayMock::newConnection);
+    clock.start();
+}
+
+bool ZwiftRelayMock::listen() { return server.listen(QHostAddress::LocalHost); }
+
+QString ZwiftRelayMock::baseUrl() const {
+    return QStringLiteral("http://127.0.0.1:") + QString::number(server.serverPort());
+}
+
+QByteArray ZwiftRelayMock::encode(const ZwiftPlayerState &s) {
+    QByteArray out;
+    writeInt(out, 1, s.id);
+    writeInt(out, 2, s.worldTime);
+    writeInt(out, 3, s.distance);
+    writeInt(out, 4, s.roadTime);
+    writeInt(out, 5, s.laps);
+    writeInt(out, 6, s.speed);
+    writeInt(out, 8, s.roadPosition);
+    writeInt(out, 9, s.cadenceUHz);
+    writeInt(out, 11, s.heartrate);
+    writeInt(out, 12, s.power);
+    writeInt(out, 13, s.heading);
+    writeInt(out, 14, s.lean);
+    writeInt(out, 15, s.climbing);
+    writeInt(out, 16, s.time);
+    writeInt(out, 19, s.f19);
+    writeInt(out, 20, s.f20);
+    writeInt(out, 21, s.progress);
+    writeInt(out, 22, s.customisationId);
+    writeInt(out, 23, s.justWatching);
+    writeInt(out, 24, s.calories);
+    writeFloat(out, 25, s.x);
+    writeFloat(out, 26, s.altitude);
+    writeFloat(out, 27, s.y);
+    writeInt(out, 28, s.watchingRiderId);
+    writeInt(out, 29, s.groupId);
+    writeInt(out, 31, s.sport);
+    return out;
+}
+
+QByteArray ZwiftRelayMock::delimited(const QList<QByteArray> &states) {
+    QByteArray out;
+    for (const QByteArray &s : states) {
+        writeVarint(out, s.size());
+        out.append(s);
+    }
+    return out;
+}
+
+QList<QByteArray> ZwiftRelayMock::split(const QByteArray &delimited) {
+    QList<QByteArray> states;
+    int p = 0;
+    while (p < delimited.size()) {
+        quint64 size = 0;
+        int shift = 0;
+        while (p < delimited.size() && shift < 64) {
+            const unsigned char b = delimited.at(p++);
+            size |= (quint64)(b & 0x7F) << shift;
+            shift += 7;
+            if (!(b & 0x80))
+                break;
+        }
+        // a message cut at the end of the recording
+        if (size > (quint64)(delimited.size() - p))
+            break;
+        states.append(delimited.mid(p, (int)size));
+        p += (int)size;
+    }
+    return states;
+}
+
+bool ZwiftRelayMock::load(const QString &fileName) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    states = split(file.readAll());
+    return !states.isEmpty();
+}
+
+void ZwiftRelayMock::newConnection() {
+    while (QTcpSocket *socket = server.nextPendingConnection()) {
+        connectionCount++;
+        connectionsBySocket.insert(socket, connection());
+        connect(socket, &QTcpSocket::readyRead, this, [this, socket]() { readRequests(socket); });
+        connect(socket, &QTcpSocket::disconnected, this, [this, socket]() {
+            connectionsBySocket.remove(socket);
+            socket->deleteLater();
+        });
+    }
+}
+
+QByteArray ZwiftRelayMock::answer(const QByteArray &path) {
+    QByteArray body;
+    QByteArray type;
+    QByteArray status = "200 OK";
+    if (path == "/api/profiles/me") {
+        body = "{\"id\":" + QByteArray::number(playerId) + ",\"firstName\":\"Test\"}";
+        type = "application/json";
+    } else if (path.endsWith("/players/" + QByteArray::number(playerId)) && !states.isEmpty()) {
+        body = states.at(qMin(stateIndex, states.count() - 1));
+        stateIndex++;
+        type = "application/x-protobuf-lite";
+    } else {
+        status = "404 Not Found";
+        type = "text/plain";
+    }
+    return "HTTP/1.1 " + status + "\r\nContent-Type: " + type + "\r\nContent-Length: " +
+           QByteArray::number(body.size()) + "\r\nConnection: keep-alive\r\n\r\n" + body;
+}
+
+void ZwiftRelayMock::readRequests(QTcpSocket *socket) {
+    auto c = connectionsBySocket.find(socket);
+    if (c == connectionsBySocket.end())
+        return;
+    c->buffer.append(socket->readAll());
+
+    int end;
+    while ((end = c->buffer.indexOf("\r\n\r\n")) != -1) {
+        const QByteArray head = c->buffer.left(end);
+        const QList<QByteArray> lines = head.split('\n');
+        int contentLength = 0;
+        for (const QByteArray &line : lines) {
+            const QByteArray l = line.trimmed();
+            if (l.toLower().startsWith("content-length:"))
+                contentLength = l.mid(15).trimmed().toInt();
+            else if (l.toLower().startsWith("authorization:"))
+                lastAuthorization = l.mid(14).trimmed();
+        }
+        if (c->buffer.size() < end + 4 + contentLength)
+            return;
+        c->buffer.remove(0, end + 4 + contentLength);
+
+        const QList<QByteArray> request = lines.first().trimmed().split(' ');
+        requestCount++;
+        response r;
+        r.due = clock.elapsed() + delayMs;
+        r.data = answer(request.value(1));
+        c->queue.append(r);
+        pipelined = qMax(pipelined, c->queue.count());
+        QTimer::singleShot(delayMs, this, [this, socket]() { flush(socket); });
+    }
+}
+
+void ZwiftRelayMock::flush(QTcpSocket *socket) {
+    auto c = connectionsBySocket.find(socket);
+    if (c == connectionsBySocket.end())
+        return;
+    // in the order of the requests, whatever the timers
+    while (!c->queue.isEmpty() && c->queue.first().due <= clock.elapsed())
+        socket->write(c->queue.takeFirst().data);
+    if (!c->queue.isEmpty())
+        QTimer::singleShot(1, this, [this, socket]() { flush(socket); });
+}
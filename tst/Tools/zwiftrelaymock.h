@@ -0,0 +1,85 @@
+#ifndef ZWIFTRELAYMOCK_H
+#define ZWIFTRELAYMOCK_H
+
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QTcpServer>
+
+#include "zwift-api/ZwiftPlayerState.h"
+
+class QTcpSocket;
+
+/**
+ * @brief A Zwift relay on the loopback interface: answers the profile of the user and replays a recorded stream of
+ * PlayerState messages, one for each request of the state of the player, the last one again once at the end.
+ * HTTP/1.1 with keep-alive and pipelining, the answers can be delayed to simulate a slow relay.
+ */
+class ZwiftRelayMock : public QObject {
+    Q_OBJECT
+  public:
+    explicit ZwiftRelayMock(int playerId = 1234, QObject *parent = nullptr);
+
+    bool listen();
+    QString baseUrl() const;
+
+    /**
+     * @brief The stream to replay, one message after the other.
+     */
+    void setStates(const QList<QByteArray> &states) { this->states = states; }
+    /**
+     * @brief Loads a recorded stream: each message preceded by its size as a varint, like writeDelimitedTo().
+     */
+    bool load(const QString &fileName);
+    static QList<QByteArray> split(const QByteArray &delimited);
+    static QByteArray delimited(const QList<QByteArray> &states);
+
+    /**
+     * @brief Encodes a PlayerState the way the relay does, the fields at 0 omitted.
+     */
+    static QByteArray encode(const ZwiftPlayerState &state);
+
+    void setDelay(int ms) { delayMs = ms; }
+
+    int connections() const { return connectionCount; }
+    int requests() const { return requestCount; }
+    int statesSent() const { return stateIndex; }
+    /**
+     * @brief The most requests received on a connection before the first one was answered.
+     */
+    int maxPipelined() const { return pipelined; }
+    const QByteArray &authorization() const { return lastAuthorization; }
+
+  private slots:
+    void newConnection();
+
+  private:
+    struct response {
+        qint64 due;
+        QByteArray data;
+    };
+    struct connection {
+        QByteArray buffer;
+        QList<response> queue;
+    };
+
+    QTcpServer server;
+    QHash<QTcpSocket *, connection> connectionsBySocket;
+    QList<QByteArray> states;
+    QElapsedTimer clock;
+    int playerId;
+    int delayMs = 0;
+    int connectionCount = 0;
+    int requestCount = 0;
+    int stateIndex = 0;
+    int pipelined = 0;
+    QByteArray lastAuthorization;
+
+    void readRequests(QTcpSocket *socket);
+    void flush(QTcpSocket *socket);
+    QByteArray answer(const QByteArray &path);
+};
+
+#endif // ZWIFTRELAYMOCK_H
@@ -5,7 +5,7 @@ include(gtest_dependency.pri)
 
 TEMPLATE = app
 
-CONFIG += console c++11
+CONFIG += console c++17
 CONFIG -= app_bundle
 CONFIG += thread
 CONFIG += androidextras
@@ -18,12 +18,42 @@ SOURCES += \
         Devices/SnodeBike/snodebiketestdata.cpp \
         Devices/StagesBike/stagesbiketestdata.cpp \
         Devices/TrxAppGateUSBTreadmill/trxappgateusbtreadmilltestdata.cpp \
+        Devices/bluetoothdevicematchertestsuite.cpp \
         Devices/bluetoothdevicetestdata.cpp \
         Devices/bluetoothdevicetestsuite.cpp \
         Devices/bluetoothsignalreceiver.cpp \
         Devices/devicediscoveryinfo.cpp \
+        ToolTests/computrainertestsuite.cpp \
+        ToolTests/csafetestsuite.cpp \
+        ToolTests/devicecontroltestsuite.cpp \
+        ToolTests/dircontestsuite.cpp \
+        ToolTests/fitdecodertestsuite.cpp \
+        ToolTests/ftmsdecodertestsuite.cpp \
+        ToolTests/gpxroutetestsuite.cpp \
+        ToolTests/ifitlogcattestsuite.cpp \
+        ToolTests/logwritertestsuite.cpp \
+        ToolTests/metrictestsuite.cpp \
+        ToolTests/notificationschedulertestsuite.cpp \
+        ToolTests/pelotoncachetestsuite.cpp \
+        ToolTests/powercurvetestsuite.cpp \
+        ToolTests/powersurfacetestsuite.cpp \
+        ToolTests/qfitjournaltestsuite.cpp \
+        ToolTests/sessionstoretestsuite.cpp \
+        ToolTests/telemetrysegmenttestsuite.cpp \
+        ToolTests/templatetelemetryfeedtestsuite.cpp \
         ToolTests/testsettingstestsuite.cpp \
+        ToolTests/tiletestsuite.cpp \
+        ToolTests/trainprogramlookaheadtestsuite.cpp \
+        ToolTests/trainprogramtimelinetestsuite.cpp \
+        ToolTests/workouthistorytestsuite.cpp \
+        ToolTests/workoutlibrarytestsuite.cpp \
+        ToolTests/zwiftrelaytestsuite.cpp \
+        Tools/computraineremulator.cpp \
+        Tools/dirconloopbackclient.cpp \
+        Tools/ifitlogcatreplay.cpp \
+        Tools/testapplication.cpp \
         Tools/testsettings.cpp \
+        Tools/zwiftrelaymock.cpp \
         main.cpp
 
 # Avoid the "File too big" error building in Windows. This has happened when a template class is used with Google Test / typed tests
@@ -34,8 +64,11 @@ win32:CONFIG(release, debug|release): LIBS += -L$$OUT_PWD/../src/release/ -lqdom
 else:win32:CONFIG(debug, debug|release): LIBS += -L$$OUT_PWD/../src/debug/ -lqdomyos-zwift
 else:unix: LIBS += -L$$OUT_PWD/../src/ -lqdomyos-zwift
 
-INCLUDEPATH += $$PWD/../src $$PWD/../src/devices
-DEPENDPATH += $$PWD/../src $$PWD/../src/devices
+INCLUDEPATH += $$PWD/../src $$PWD/../src/devices $$PWD/../src/fit-sdk
+DEPENDPATH += $$PWD/../src $$PWD/../src/devices $$PWD/../src/fit-sdk
+
+# sources read by the tests that check a table against the code it mirrors
+DEFINES += QZ_SOURCE_DIR=\\\"$$PWD/../src\\\"
 
 win32-g++:CONFIG(release, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../src/release/libqdomyos-zwift.a
 else:win32-g++:CONFIG(debug, debug|release): PRE_TARGETDEPS += $$OUT_PWD/../src/debug/libqdomyos-zwift.a
@@ -128,6 +161,7 @@ HEADERS += \
     Devices/WahooKickrSnapBike/wahookickrsnapbiketestdata.h \
     Devices/YesoulBike/yesoulbiketestdata.h \
     Devices/ZiproTreadmill/ziprotreadmilltestdata.h \
+    Devices/bluetoothdevicematchertestsuite.h \
     Devices/bluetoothdevicetestdata.h \
     Devices/bluetoothdevicetestsuite.h \
     Devices/bluetoothsignalreceiver.h \
@@ -136,5 +170,34 @@ HEADERS += \
     Devices/iConceptBike/iconceptbiketestdata.h \
     Devices/iConceptElliptical/iconceptellipticaltestdata.h \
     Devices/YpooElliptical/ypooellipticaltestdata.h \
+    ToolTests/computrainertestsuite.h \
+    ToolTests/csafetestsuite.h \
+    ToolTests/devicecontroltestsuite.h \
+    ToolTests/dircontestsuite.h \
+    ToolTests/fitdecodertestsuite.h \
+    ToolTests/ftmsdecodertestsuite.h \
+    ToolTests/gpxroutetestsuite.h \
+    ToolTests/ifitlogcattestsuite.h \
+    ToolTests/logwritertestsuite.h \
+    ToolTests/metrictestsuite.h \
+    ToolTests/notificationschedulertestsuite.h \
+    ToolTests/pelotoncachetestsuite.h \
+    ToolTests/powercurvetestsuite.h \
+    ToolTests/powersurfacetestsuite.h \
+    ToolTests/qfitjournaltestsuite.h \
+    ToolTests/sessionstoretestsuite.h \
+    ToolTests/telemetrysegmenttestsuite.h \
+    ToolTests/templatetelemetryfeedtestsuite.h \
     ToolTests/testsettingstestsuite.h \
-    Tools/testsettings.h
+    ToolTests/tiletestsuite.h \
+    ToolTests/trainprogramlookaheadtestsuite.h \
+    ToolTests/trainprogramtimelinetestsuite.h \
+    ToolTests/workouthistorytestsuite.h \
+    ToolTests/workoutlibrarytestsuite.h \
+    ToolTests/zwiftrelaytestsuite.h \
+    Tools/computraineremulator.h \
+    Tools/dirconloopbackclient.h \
+    Tools/ifitlogcatreplay.h \
+    Tools/testapplication.h \
+    Tools/testsettings.h \
+    Tools/zwiftrelaymock.h